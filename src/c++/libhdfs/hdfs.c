@@ -19,6 +19,9 @@
 #include "hdfs.h"
 #include "hdfsJniHelper.h"
 
+#include <unistd.h>
+#include <sys/time.h>
+
 
 /* Some frequently used Java paths */
 #define HADOOP_CONF     "org/apache/hadoop/conf/Configuration"
@@ -65,6 +68,21 @@ typedef struct
  * @param jFile: The local reference of java.lang.Object object
  * @return None.
  */
+static void readaheadStop(hdfsFile f);
+
+/**
+ * Native coalescing buffer for small writes, hung off
+ * hdfsFile_internal::writebuf. Not thread-safe, like the rest of the
+ * per-file write path.
+ */
+struct hdfsWriteBuffer {
+    char *data;
+    tSize size;
+    tSize used;
+};
+
+static int writeBufferFlush(JNIEnv *env, hdfsFile f);
+
 static void destroyLocalReference(JNIEnv *env, jobject jObject)
 {
   if (jObject)
@@ -163,7 +181,293 @@ hdfsFS hdfsConnect(const char* host, tPort port) {
 }
 
 
+/**
+ * Background JVM warmup. The thread runs getJNIEnv, which creates the
+ * JVM under jvmMutex exactly as a real caller would, and then resolves
+ * the classes the FileSystem stack touches first so their loading and
+ * static initialization happen off the first request too. The thread
+ * exits when done; its JNIEnv destructor detaches it from the JVM.
+ */
+static void* prewarmThread(void *arg)
+{
+    static const char *hotClasses[] = {
+        HADOOP_CONF, HADOOP_PATH, HADOOP_FS, HADOOP_DFS,
+        HADOOP_ISTRM, HADOOP_OSTRM, HADOOP_STAT, NULL
+    };
+    int i;
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+        //nothing is poisoned: the first real call retries synchronously
+        return NULL;
+    }
+    for (i = 0; hotClasses[i] != NULL; i++) {
+        if (globalClassReference(hotClasses[i], env) == NULL) {
+            (*env)->ExceptionClear(env);
+        }
+    }
+    return NULL;
+}
+
+static void prewarmStart(void)
+{
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, prewarmThread, NULL) == 0) {
+        pthread_detach(thread);
+    }
+}
+
+void hdfsPrewarm(void)
+{
+    static pthread_once_t prewarmOnce = PTHREAD_ONCE_INIT;
+    pthread_once(&prewarmOnce, prewarmStart);
+}
+
+
+/**
+ * Opt-in per-operation statistics, shared by every connection in the
+ * process. One mutex guards the table; the update is a handful of adds
+ * and is dwarfed by the JNI crossing it measures.
+ */
+static int statsMode = 0;
+static hdfsOpStats opStats[HDFS_STAT_NUM_OPS];
+static pthread_mutex_t statsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *statsOpNames[HDFS_STAT_NUM_OPS] = {
+    "open", "read", "pread", "write", "stat"
+};
+
+//the current wall clock in microseconds, or 0 when stats are off
+static uint64_t statsBegin(void)
+{
+    struct timeval tv;
+    if (statsMode == 0) {
+        return 0;
+    }
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+}
+
+static void statsRecord(hdfsStatOp op, uint64_t start, int64_t bytes,
+                        int failed)
+{
+    struct timeval tv;
+    uint64_t elapsed;
+    int bucket = 0;
+
+    if (start == 0 || statsMode == 0) {
+        return;
+    }
+    gettimeofday(&tv, NULL);
+    elapsed = (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec - start;
+    while (bucket < HDFS_STATS_BUCKETS - 1 &&
+            ((uint64_t)1 << bucket) < elapsed) {
+        bucket++;
+    }
+    pthread_mutex_lock(&statsMutex);
+    opStats[op].count++;
+    if (failed) {
+        opStats[op].errors++;
+    }
+    else if (bytes > 0) {
+        opStats[op].bytes += bytes;
+    }
+    opStats[op].totalMicros += elapsed;
+    if (elapsed > opStats[op].maxMicros) {
+        opStats[op].maxMicros = elapsed;
+    }
+    opStats[op].latencyBuckets[bucket]++;
+    pthread_mutex_unlock(&statsMutex);
+}
+
+//called with statsMutex held
+static void statsDump(FILE *out)
+{
+    int op, bucket;
+    for (op = 0; op < HDFS_STAT_NUM_OPS; op++) {
+        const hdfsOpStats *s = &opStats[op];
+        if (s->count == 0) {
+            continue;
+        }
+        fprintf(out, "libhdfs %s: %llu calls, %llu errors, %llu bytes, "
+                "%llu us total, %llu us max\n", statsOpNames[op],
+                (unsigned long long)s->count, (unsigned long long)s->errors,
+                (unsigned long long)s->bytes,
+                (unsigned long long)s->totalMicros,
+                (unsigned long long)s->maxMicros);
+        for (bucket = 0; bucket < HDFS_STATS_BUCKETS; bucket++) {
+            if (s->latencyBuckets[bucket] != 0) {
+                fprintf(out, "  <= %llu us: %llu\n",
+                        (unsigned long long)((uint64_t)1 << bucket),
+                        (unsigned long long)s->latencyBuckets[bucket]);
+            }
+        }
+    }
+}
+
+void hdfsSetStatsCollection(int mode)
+{
+    statsMode = mode;
+}
+
+int hdfsGetStats(hdfsOpStats *stats, int numOps)
+{
+    int copied = numOps < HDFS_STAT_NUM_OPS ? numOps : HDFS_STAT_NUM_OPS;
+    if (stats == NULL || copied < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_mutex_lock(&statsMutex);
+    memcpy(stats, opStats, copied * sizeof(hdfsOpStats));
+    pthread_mutex_unlock(&statsMutex);
+    return copied;
+}
+
+void hdfsResetStats(void)
+{
+    pthread_mutex_lock(&statsMutex);
+    memset(opStats, 0, sizeof(opStats));
+    pthread_mutex_unlock(&statsMutex);
+}
+
+
+/**
+ * One cached FileSystem connection, keyed by (host, port, user).
+ * Handles are handed out refcounted; an entry whose count drops to
+ * zero lingers for FS_CACHE_IDLE_SECONDS before the underlying
+ * FileSystem is really closed, so short-lived callers stop paying the
+ * connection setup and its burst of NameNode RPCs.
+ */
+struct fsCacheEntry {
+    char *host;
+    char *user;
+    tPort port;
+    hdfsFS fs;
+    int refs;
+    time_t lastUse;
+    struct fsCacheEntry *next;
+};
+
+static struct fsCacheEntry *fsCache = NULL;
+static pthread_mutex_t fsCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define FS_CACHE_IDLE_SECONDS 60
+
+static hdfsFS hdfsConnectInternal(const char* host, tPort port,
+        const char *user, const char **groups, int groups_size);
+static int hdfsDisconnectInternal(hdfsFS fs);
+
+static int fsCacheKeyMatch(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+//close cached connections that have sat unreferenced too long;
+//called with fsCacheMutex held
+static void fsCacheEvictIdle(void)
+{
+    time_t now = time(NULL);
+    struct fsCacheEntry **link = &fsCache;
+    while (*link != NULL) {
+        struct fsCacheEntry *e = *link;
+        if (e->refs == 0 && now - e->lastUse >= FS_CACHE_IDLE_SECONDS) {
+            *link = e->next;
+            hdfsDisconnectInternal(e->fs);
+            free(e->host);
+            free(e->user);
+            free(e);
+        }
+        else {
+            link = &e->next;
+        }
+    }
+}
+
 hdfsFS hdfsConnectAsUser(const char* host, tPort port, const char *user , const char **groups, int groups_size )
+{
+    struct fsCacheEntry *e;
+    hdfsFS fs;
+
+    pthread_mutex_lock(&fsCacheMutex);
+    fsCacheEvictIdle();
+    for (e = fsCache; e != NULL; e = e->next) {
+        if (e->port == port && fsCacheKeyMatch(e->host, host) &&
+                fsCacheKeyMatch(e->user, user)) {
+            e->refs++;
+            fs = e->fs;
+            pthread_mutex_unlock(&fsCacheMutex);
+            return fs;
+        }
+    }
+
+    fs = hdfsConnectInternal(host, port, user, groups, groups_size);
+    if (fs == NULL) {
+        pthread_mutex_unlock(&fsCacheMutex);
+        return NULL;
+    }
+    e = calloc(1, sizeof(struct fsCacheEntry));
+    if (e != NULL) {
+        e->host = (host != NULL) ? strdup(host) : NULL;
+        e->user = (user != NULL) ? strdup(user) : NULL;
+        if ((host != NULL && e->host == NULL) ||
+                (user != NULL && e->user == NULL)) {
+            //hand the handle out uncached rather than under a bad key
+            free(e->host);
+            free(e->user);
+            free(e);
+        }
+        else {
+            e->port = port;
+            e->fs = fs;
+            e->refs = 1;
+            e->next = fsCache;
+            fsCache = e;
+        }
+    }
+    pthread_mutex_unlock(&fsCacheMutex);
+    return fs;
+}
+
+int hdfsDisconnect(hdfsFS fs)
+{
+    struct fsCacheEntry *e;
+
+    if (fs == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (statsMode == 2) {
+        pthread_mutex_lock(&statsMutex);
+        statsDump(stderr);
+        pthread_mutex_unlock(&statsMutex);
+    }
+
+    pthread_mutex_lock(&fsCacheMutex);
+    for (e = fsCache; e != NULL; e = e->next) {
+        if (e->fs == fs) {
+            if (e->refs > 0) {
+                e->refs--;
+            }
+            if (e->refs == 0) {
+                //linger: someone may reconnect before the idle timeout
+                e->lastUse = time(NULL);
+            }
+            fsCacheEvictIdle();
+            pthread_mutex_unlock(&fsCacheMutex);
+            return 0;
+        }
+    }
+    pthread_mutex_unlock(&fsCacheMutex);
+
+    //not a cached handle, close it for real
+    return hdfsDisconnectInternal(fs);
+}
+
+
+static hdfsFS hdfsConnectInternal(const char* host, tPort port, const char *user , const char **groups, int groups_size )
 {
     // JAVA EQUIVALENT:
     //  FileSystem fs = FileSystem.get(new Configuration());
@@ -346,7 +650,7 @@ hdfsFS hdfsConnectAsUser(const char* host, tPort port, const char *user , const
 
 
 
-int hdfsDisconnect(hdfsFS fs)
+static int hdfsDisconnectInternal(hdfsFS fs)
 {
     // JAVA EQUIVALENT:
     //  fs.close()
@@ -385,7 +689,78 @@ int hdfsDisconnect(hdfsFS fs)
 
 
 
-hdfsFile hdfsOpenFile(hdfsFS fs, const char* path, int flags, 
+/**
+ * Short-circuit local reads. While enabled, input files whose
+ * FileSystem is backed by local disk are additionally opened with a
+ * plain file descriptor, and reads are served with read/pread on it —
+ * no JNI, no stream copy. Files that cannot be opened natively (wrong
+ * scheme, permissions) silently keep the normal Java path. Note that
+ * short-circuited reads bypass the checksum layer, like block reads
+ * from a DataNode's own disk.
+ */
+static volatile int shortCircuitEnabled = 0;
+
+void hdfsSetShortCircuitLocalRead(int enable)
+{
+    shortCircuitEnabled = enable;
+}
+
+//is this FileSystem backed by local disk (URI scheme "file")?
+static int fsIsLocal(JNIEnv *env, jobject jFS)
+{
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    int local = 0;
+
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "getUri", "()Ljava/net/URI;") != 0 || jVal.l == NULL) {
+        (*env)->ExceptionClear(env);
+        return 0;
+    }
+    jobject jUri = jVal.l;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jUri, JAVA_NET_URI,
+                     "getScheme", "()Ljava/lang/String;") == 0 &&
+            jVal.l != NULL) {
+        jstring jScheme = jVal.l;
+        const char *scheme = (*env)->GetStringUTFChars(env, jScheme, NULL);
+        if (scheme != NULL) {
+            local = (strcmp(scheme, "file") == 0);
+            (*env)->ReleaseStringUTFChars(env, jScheme, scheme);
+        }
+        destroyLocalReference(env, jScheme);
+    }
+    else {
+        (*env)->ExceptionClear(env);
+    }
+    destroyLocalReference(env, jUri);
+    return local;
+}
+
+//open the raw file behind a local path for reading; -1 when the
+//replica cannot be read directly and the Java path must be used
+static int shortCircuitOpen(JNIEnv *env, jobject jFS, const char* path)
+{
+    if (!fsIsLocal(env, jFS)) {
+        return -1;
+    }
+
+    //strip the scheme and authority if the caller passed a full URI
+    const char *raw = path;
+    if (strncmp(raw, "file:", 5) == 0) {
+        raw += 5;
+        if (raw[0] == '/' && raw[1] == '/') {
+            const char *slash = strchr(raw + 2, '/');
+            if (slash == NULL) {
+                return -1;
+            }
+            raw = slash;
+        }
+    }
+
+    return open(raw, O_RDONLY);
+}
+
+static hdfsFile hdfsOpenFileInternal(hdfsFS fs, const char* path, int flags,
                       int bufferSize, short replication, tSize blockSize)
 {
     /*
@@ -533,6 +908,14 @@ hdfsFile hdfsOpenFile(hdfsFS fs, const char* path, int flags,
     }
     file->file = (*env)->NewGlobalRef(env, jVal.l);
     file->type = (((flags & O_WRONLY) == 0) ? INPUT : OUTPUT);
+    file->readahead = NULL;
+    file->writebuf = NULL;
+    file->localFd = -1;
+
+    //Try to short-circuit reads straight to local disk
+    if (shortCircuitEnabled && file->type == INPUT) {
+        file->localFd = shortCircuitOpen(env, jFS, path);
+    }
 
     destroyLocalReference(env, jVal.l);
 
@@ -550,6 +933,18 @@ hdfsFile hdfsOpenFile(hdfsFS fs, const char* path, int flags,
 
 
 
+hdfsFile hdfsOpenFile(hdfsFS fs, const char* path, int flags,
+                      int bufferSize, short replication, tSize blockSize)
+{
+    uint64_t start = statsBegin();
+    hdfsFile f = hdfsOpenFileInternal(fs, path, flags, bufferSize,
+                                      replication, blockSize);
+    statsRecord(HDFS_STAT_OPEN, start, 0, f == NULL);
+    return f;
+}
+
+
+
 int hdfsCloseFile(hdfsFS fs, hdfsFile file)
 {
     // JAVA EQUIVALENT:
@@ -575,8 +970,30 @@ int hdfsCloseFile(hdfsFS fs, hdfsFile file)
         return -1;
     }
 
+    //Stop the prefetch thread before the stream goes away
+    if (file->readahead != NULL) {
+        readaheadStop(file);
+    }
+
+    //Release the short-circuit descriptor
+    if (file->localFd >= 0) {
+        close(file->localFd);
+        file->localFd = -1;
+    }
+
+    //Drain any buffered writes before closing
+    if (file->writebuf != NULL) {
+        struct hdfsWriteBuffer *wb = file->writebuf;
+        if (writeBufferFlush(env, file) != 0) {
+            return -1;
+        }
+        file->writebuf = NULL;
+        free(wb->data);
+        free(wb);
+    }
+
     //The interface whose 'close' method to be called
-    const char* interface = (file->type == INPUT) ? 
+    const char* interface = (file->type == INPUT) ?
         HADOOP_ISTRM : HADOOP_OSTRM;
   
     if (invokeMethod(env, NULL, &jExc, INSTANCE, jStream, interface,
@@ -624,7 +1041,261 @@ int hdfsExists(hdfsFS fs, const char *path)
 
 
 
-tSize hdfsRead(hdfsFS fs, hdfsFile f, void* buffer, tSize length)
+/**
+ * One prefetched extent. Buffers are tagged with the absolute file
+ * offset their bytes came from, so a stale buffer is never wrong,
+ * only useless; that keeps invalidation after a seek best-effort.
+ */
+struct raBuffer {
+    char *data;
+    tOffset offset;
+    tSize length;
+    int valid;      //data holds length bytes from offset
+    int filling;    //the prefetch thread is reading into it
+};
+
+/**
+ * Per-file readahead state, hung off hdfsFile_internal::readahead.
+ * The prefetch thread fills buffers with positional reads while
+ * hdfsRead serves the reader from the tracked position, so the
+ * underlying Java stream's own position is not consulted while
+ * readahead is enabled.
+ */
+struct hdfsReadahead {
+    hdfsFS fs;
+    hdfsFile file;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int shutdown;
+    tSize bufferSize;
+    int bufferCount;
+    struct raBuffer *buffers;
+    tOffset position;    //the reader's current offset
+    tOffset nextOffset;  //where the next prefetch starts
+    tOffset eofAt;       //offset that hit EOF, or -1
+};
+
+static void* readaheadWorker(void *arg)
+{
+    struct hdfsReadahead *ra = arg;
+    pthread_mutex_lock(&ra->mutex);
+    while (!ra->shutdown) {
+        //claim a buffer that is free or already behind the reader
+        struct raBuffer *slot = NULL;
+        int i;
+        if (ra->eofAt < 0 || ra->nextOffset < ra->eofAt) {
+            for (i = 0; i < ra->bufferCount; i++) {
+                struct raBuffer *b = &ra->buffers[i];
+                if (!b->filling &&
+                        (!b->valid || b->offset + b->length <= ra->position)) {
+                    slot = b;
+                    break;
+                }
+            }
+        }
+        if (slot == NULL) {
+            pthread_cond_wait(&ra->cond, &ra->mutex);
+            continue;
+        }
+        slot->offset = ra->nextOffset;
+        slot->valid = 0;
+        slot->filling = 1;
+        ra->nextOffset += ra->bufferSize;
+        pthread_mutex_unlock(&ra->mutex);
+
+        tSize n = hdfsPread(ra->fs, ra->file, slot->offset, slot->data,
+                            ra->bufferSize);
+
+        pthread_mutex_lock(&ra->mutex);
+        slot->filling = 0;
+        if (n > 0) {
+            slot->length = n;
+            slot->valid = 1;
+        }
+        else {
+            //EOF or error: stop prefetching until the reader moves
+            if (ra->eofAt < 0 || slot->offset < ra->eofAt) {
+                ra->eofAt = slot->offset;
+            }
+        }
+        pthread_cond_broadcast(&ra->cond);
+    }
+    pthread_mutex_unlock(&ra->mutex);
+    return NULL;
+}
+
+static tSize readaheadRead(hdfsFS fs, hdfsFile f, void *buffer, tSize length)
+{
+    struct hdfsReadahead *ra = f->readahead;
+    tSize done = -1;
+
+    pthread_mutex_lock(&ra->mutex);
+    while (1) {
+        //serve from a buffer covering the current position
+        struct raBuffer *hit = NULL;
+        struct raBuffer *pending = NULL;
+        int i;
+        for (i = 0; i < ra->bufferCount; i++) {
+            struct raBuffer *b = &ra->buffers[i];
+            if (b->valid && b->offset <= ra->position &&
+                    ra->position < b->offset + b->length) {
+                hit = b;
+                break;
+            }
+            if (b->filling && b->offset <= ra->position &&
+                    ra->position < b->offset + (tOffset)ra->bufferSize) {
+                pending = b;
+            }
+        }
+        if (hit != NULL) {
+            tSize avail = hit->offset + hit->length - ra->position;
+            done = (length < avail) ? length : avail;
+            memcpy(buffer, hit->data + (ra->position - hit->offset), done);
+            ra->position += done;
+            if (ra->position >= hit->offset + hit->length) {
+                hit->valid = 0;
+                pthread_cond_broadcast(&ra->cond);
+            }
+            break;
+        }
+        if (ra->eofAt >= 0 && ra->position >= ra->eofAt) {
+            done = 0;
+            break;
+        }
+        if (pending != NULL) {
+            //the prefetch thread is already fetching these bytes
+            pthread_cond_wait(&ra->cond, &ra->mutex);
+            continue;
+        }
+        //miss: first read, or the caller broke the sequential pattern
+        {
+            tOffset position = ra->position;
+            pthread_mutex_unlock(&ra->mutex);
+            tSize n = hdfsPread(fs, f, position, buffer, length);
+            pthread_mutex_lock(&ra->mutex);
+            if (n > 0) {
+                ra->position = position + n;
+            }
+            ra->nextOffset = position + (n > 0 ? n : 0);
+            ra->eofAt = -1;
+            pthread_cond_broadcast(&ra->cond);
+            done = n;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ra->mutex);
+    if (done >= 0) {
+        errno = 0;
+    }
+    return done;
+}
+
+static void readaheadStop(hdfsFile f)
+{
+    struct hdfsReadahead *ra = f->readahead;
+    int i;
+    if (ra == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ra->mutex);
+    ra->shutdown = 1;
+    pthread_cond_broadcast(&ra->cond);
+    pthread_mutex_unlock(&ra->mutex);
+    pthread_join(ra->thread, NULL);
+    for (i = 0; i < ra->bufferCount; i++) {
+        free(ra->buffers[i].data);
+    }
+    free(ra->buffers);
+    pthread_cond_destroy(&ra->cond);
+    pthread_mutex_destroy(&ra->mutex);
+    f->readahead = NULL;
+    free(ra);
+}
+
+int hdfsFileSetReadahead(hdfsFS fs, hdfsFile f, tSize bufferSize,
+                         int bufferCount)
+{
+    struct hdfsReadahead *ra;
+    int i;
+
+    //Sanity check
+    if (!f || f->type != INPUT) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (f->readahead != NULL) {
+        //re-sync the Java stream before tearing the old state down
+        tOffset position = ((struct hdfsReadahead*)f->readahead)->position;
+        readaheadStop(f);
+        if (hdfsSeek(fs, f, position) != 0) {
+            return -1;
+        }
+    }
+    if (bufferSize == 0) {
+        return 0;
+    }
+    if (bufferCount <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ra = calloc(1, sizeof(struct hdfsReadahead));
+    if (ra == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ra->fs = fs;
+    ra->file = f;
+    ra->bufferSize = bufferSize;
+    ra->bufferCount = bufferCount;
+    ra->position = hdfsTell(fs, f);
+    if (ra->position < 0) {
+        free(ra);
+        return -1;
+    }
+    ra->nextOffset = ra->position;
+    ra->eofAt = -1;
+    ra->buffers = calloc(bufferCount, sizeof(struct raBuffer));
+    if (ra->buffers == NULL) {
+        free(ra);
+        errno = ENOMEM;
+        return -1;
+    }
+    for (i = 0; i < bufferCount; i++) {
+        ra->buffers[i].data = malloc(bufferSize);
+        if (ra->buffers[i].data == NULL) {
+            while (i > 0) {
+                free(ra->buffers[--i].data);
+            }
+            free(ra->buffers);
+            free(ra);
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+    pthread_mutex_init(&ra->mutex, NULL);
+    pthread_cond_init(&ra->cond, NULL);
+    if (pthread_create(&ra->thread, NULL, readaheadWorker, ra) != 0) {
+        for (i = 0; i < bufferCount; i++) {
+            free(ra->buffers[i].data);
+        }
+        free(ra->buffers);
+        pthread_cond_destroy(&ra->cond);
+        pthread_mutex_destroy(&ra->mutex);
+        free(ra);
+        errno = EAGAIN;
+        return -1;
+    }
+    f->readahead = ra;
+    return 0;
+}
+
+
+
+static tSize hdfsReadInternal(hdfsFS fs, hdfsFile f, void* buffer,
+                              tSize length)
 {
     // JAVA EQUIVALENT:
     //  byte [] bR = new byte[length];
@@ -658,6 +1329,21 @@ tSize hdfsRead(hdfsFS fs, hdfsFile f, void* buffer, tSize length)
         return -1;
     }
 
+    //Short-circuit: read the local file directly
+    if (f->localFd >= 0) {
+        ssize_t n = read(f->localFd, buffer, length);
+        if (n < 0) {
+            return -1;
+        }
+        errno = 0;
+        return (tSize)n;
+    }
+
+    //Serve from the prefetch buffers when readahead is on
+    if (f->readahead != NULL) {
+        return readaheadRead(fs, f, buffer, length);
+    }
+
     //Read the requisite bytes
     jbRarray = (*env)->NewByteArray(env, length);
     if (invokeMethod(env, &jVal, &jExc, INSTANCE, jInputStream, HADOOP_ISTRM,
@@ -687,7 +1373,17 @@ tSize hdfsRead(hdfsFS fs, hdfsFile f, void* buffer, tSize length)
 
 
   
-tSize hdfsPread(hdfsFS fs, hdfsFile f, tOffset position,
+tSize hdfsRead(hdfsFS fs, hdfsFile f, void* buffer, tSize length)
+{
+    uint64_t start = statsBegin();
+    tSize n = hdfsReadInternal(fs, f, buffer, length);
+    statsRecord(HDFS_STAT_READ, start, n, n < 0);
+    return n;
+}
+
+
+
+static tSize hdfsPreadInternal(hdfsFS fs, hdfsFile f, tOffset position,
                 void* buffer, tSize length)
 {
     // JAVA EQUIVALENT:
@@ -722,6 +1418,16 @@ tSize hdfsPread(hdfsFS fs, hdfsFile f, tOffset position,
         return -1;
     }
 
+    //Short-circuit: pread the local file directly
+    if (f->localFd >= 0) {
+        ssize_t n = pread(f->localFd, buffer, length, position);
+        if (n < 0) {
+            return -1;
+        }
+        errno = 0;
+        return (tSize)n;
+    }
+
     //Read the requisite bytes
     jbRarray = (*env)->NewByteArray(env, length);
     if (invokeMethod(env, &jVal, &jExc, INSTANCE, jInputStream, HADOOP_ISTRM,
@@ -750,70 +1456,52 @@ tSize hdfsPread(hdfsFS fs, hdfsFile f, tOffset position,
 
 
 
-tSize hdfsWrite(hdfsFS fs, hdfsFile f, const void* buffer, tSize length)
+tSize hdfsPread(hdfsFS fs, hdfsFile f, tOffset position,
+                void* buffer, tSize length)
 {
-    // JAVA EQUIVALENT
-    // byte b[] = str.getBytes();
-    // fso.write(b);
+    uint64_t start = statsBegin();
+    tSize n = hdfsPreadInternal(fs, f, position, buffer, length);
+    statsRecord(HDFS_STAT_PREAD, start, n, n < 0);
+    return n;
+}
 
-    //Get the JNIEnv* corresponding to current thread
-    JNIEnv* env = getJNIEnv();
-    if (env == NULL) {
-      errno = EINTERNAL;
-      return -1;
-    }
 
-    //Parameters
-    jobject jOutputStream = (jobject)(f ? f->file : 0);
-    jbyteArray jbWarray;
-
-    //Caught exception
-    jthrowable jExc = NULL;
-
-    //Sanity check
-    if (!f || f->type == UNINITIALIZED) {
-        errno = EBADF;
-        return -1;
-    }
-    
-    if (length < 0) {
-    	errno = EINVAL;
-    	return -1;
-    }
 
-    //Error checking... make sure that this file is 'writable'
-    if (f->type != OUTPUT) {
-        fprintf(stderr, "Cannot write into a non-OutputStream object!\n");
-        errno = EINVAL;
-        return -1;
-    }
+/**
+ * Whether FSDataInputStream has the ByteBuffer read methods. -1 means
+ * not probed yet; probing races are harmless because every thread
+ * computes the same answer.
+ */
+static volatile int directReadSupported = -1;
+static volatile int directPreadSupported = -1;
 
-    // 'length' equals 'zero' is a valid use-case according to Posix!
-    if (length != 0) {
-        //Write the requisite bytes into the file
-        jbWarray = (*env)->NewByteArray(env, length);
-        (*env)->SetByteArrayRegion(env, jbWarray, 0, length, buffer);
-        if (invokeMethod(env, NULL, &jExc, INSTANCE, jOutputStream,
-                         HADOOP_OSTRM, "write",
-                         "([B)V", jbWarray) != 0) {
-            errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                       "FSDataOutputStream::write");
-            length = -1;
+static int directReadProbe(JNIEnv *env, const char *signature,
+                           volatile int *supported)
+{
+    if (*supported == -1) {
+        jclass cls = globalClassReference(HADOOP_ISTRM, env);
+        if (cls == NULL) {
+            (*env)->ExceptionClear(env);
+            return 0;
+        }
+        jmethodID mid = (*env)->GetMethodID(env, cls, "read", signature);
+        if (mid == NULL) {
+            //this stream predates ByteBuffer reads
+            (*env)->ExceptionClear(env);
+            *supported = 0;
+        }
+        else {
+            *supported = 1;
         }
-        destroyLocalReference(env, jbWarray);
     }
-
-    //Return no. of bytes succesfully written (libc way)
-    //i.e. 'length' itself! ;-)
-    return length;
+    return *supported;
 }
 
-
-
-int hdfsSeek(hdfsFS fs, hdfsFile f, tOffset desiredPos) 
+tSize hdfsReadDirect(hdfsFS fs, hdfsFile f, void* buffer, tSize length)
 {
-    // JAVA EQUIVALENT
-    //  fis.seek(pos);
+    // JAVA EQUIVALENT:
+    //  ByteBuffer bb = ...; // wraps the caller's buffer
+    //  fis.read(bb);
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -823,33 +1511,74 @@ int hdfsSeek(hdfsFS fs, hdfsFile f, tOffset desiredPos)
     }
 
     //Parameters
-    jobject jInputStream = (jobject)(f ? f->file : 0);
+    jobject jInputStream = (jobject)(f ? f->file : NULL);
 
-    //Caught exception
+    jobject jbb;
+    jint noReadBytes = 0;
+    jvalue jVal;
     jthrowable jExc = NULL;
 
     //Sanity check
-    if (!f || f->type != INPUT) {
+    if (!f || f->type == UNINITIALIZED) {
         errno = EBADF;
         return -1;
     }
 
-    if (invokeMethod(env, NULL, &jExc, INSTANCE, jInputStream, HADOOP_ISTRM,
-                     "seek", "(J)V", desiredPos) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FSDataInputStream::seek");
+    //Error checking... make sure that this file is 'readable'
+    if (f->type != INPUT) {
+        fprintf(stderr, "Cannot read from a non-InputStream object!\n");
+        errno = EINVAL;
         return -1;
     }
 
-    return 0;
+    //Short-circuit reads already land in the caller's buffer
+    if (f->localFd >= 0) {
+        return hdfsRead(fs, f, buffer, length);
+    }
+
+    if (!directReadProbe(env, "(Ljava/nio/ByteBuffer;)I",
+                         &directReadSupported)) {
+        return hdfsRead(fs, f, buffer, length);
+    }
+
+    //Have the stream write straight into the caller's buffer
+    jbb = (*env)->NewDirectByteBuffer(env, buffer, length);
+    if (jbb == NULL) {
+        //JVM without direct buffer support
+        (*env)->ExceptionClear(env);
+        return hdfsRead(fs, f, buffer, length);
+    }
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jInputStream, HADOOP_ISTRM,
+                     "read", "(Ljava/nio/ByteBuffer;)I", jbb) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FSDataInputStream::read");
+        noReadBytes = -1;
+    }
+    else {
+        noReadBytes = jVal.i;
+        if (noReadBytes < 0) {
+            //This is a valid case: there aren't any bytes left to read!
+            if (noReadBytes < -1) {
+              fprintf(stderr, "WARN: FSDataInputStream.read returned invalid return code - libhdfs returning EOF, i.e., 0: %d\n", noReadBytes);
+            }
+            noReadBytes = 0;
+        }
+        errno = 0;
+    }
+
+    destroyLocalReference(env, jbb);
+
+    return noReadBytes;
 }
 
 
 
-tOffset hdfsTell(hdfsFS fs, hdfsFile f)
+tSize hdfsPreadDirect(hdfsFS fs, hdfsFile f, tOffset position,
+                      void* buffer, tSize length)
 {
-    // JAVA EQUIVALENT
-    //  pos = f.getPos();
+    // JAVA EQUIVALENT:
+    //  ByteBuffer bb = ...; // wraps the caller's buffer
+    //  fis.read(pos, bb);
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -859,7 +1588,12 @@ tOffset hdfsTell(hdfsFS fs, hdfsFile f)
     }
 
     //Parameters
-    jobject jStream = (jobject)(f ? f->file : 0);
+    jobject jInputStream = (jobject)(f ? f->file : NULL);
+
+    jobject jbb;
+    jint noReadBytes = 0;
+    jvalue jVal;
+    jthrowable jExc = NULL;
 
     //Sanity check
     if (!f || f->type == UNINITIALIZED) {
@@ -867,176 +1601,390 @@ tOffset hdfsTell(hdfsFS fs, hdfsFile f)
         return -1;
     }
 
-    const char* interface = (f->type == INPUT) ?
-        HADOOP_ISTRM : HADOOP_OSTRM;
+    //Error checking... make sure that this file is 'readable'
+    if (f->type != INPUT) {
+        fprintf(stderr, "Cannot read from a non-InputStream object!\n");
+        errno = EINVAL;
+        return -1;
+    }
 
-    jlong currentPos  = -1;
-    jvalue jVal;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStream,
-                     interface, "getPos", "()J") != 0) {
+    //Short-circuit reads already land in the caller's buffer
+    if (f->localFd >= 0) {
+        return hdfsPread(fs, f, position, buffer, length);
+    }
+
+    if (!directReadProbe(env, "(JLjava/nio/ByteBuffer;)I",
+                         &directPreadSupported)) {
+        return hdfsPread(fs, f, position, buffer, length);
+    }
+
+    //Have the stream write straight into the caller's buffer
+    jbb = (*env)->NewDirectByteBuffer(env, buffer, length);
+    if (jbb == NULL) {
+        //JVM without direct buffer support
+        (*env)->ExceptionClear(env);
+        return hdfsPread(fs, f, position, buffer, length);
+    }
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jInputStream, HADOOP_ISTRM,
+                     "read", "(JLjava/nio/ByteBuffer;)I", position, jbb) != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FSDataInputStream::getPos");
-        return -1;
+                                   "FSDataInputStream::read");
+        noReadBytes = -1;
+    }
+    else {
+        noReadBytes = jVal.i;
+        if (noReadBytes < 0) {
+            //This is a valid case: there aren't any bytes left to read!
+            if (noReadBytes < -1) {
+              fprintf(stderr, "WARN: FSDataInputStream.read returned invalid return code - libhdfs returning EOF, i.e., 0: %d\n", noReadBytes);
+            }
+            noReadBytes = 0;
+        }
+        errno = 0;
     }
-    currentPos = jVal.j;
 
-    return (tOffset)currentPos;
+    destroyLocalReference(env, jbb);
+
+    return noReadBytes;
 }
 
 
 
-int hdfsFlush(hdfsFS fs, hdfsFile f) 
+/**
+ * One queued asynchronous read. The same node moves from the pending
+ * list to the done list once a worker has filled in result/error.
+ */
+struct asyncRequest {
+    int ticket;
+    hdfsFile file;
+    tOffset position;
+    void* buffer;
+    tSize length;
+    void* userData;
+    tSize result;
+    int error;
+    struct asyncRequest *next;
+};
+
+/**
+ * A pool of worker threads draining a pending queue of positional
+ * reads into a completion queue. The workers are the only threads
+ * that touch JNI: they attach to the JVM once and stay attached, so
+ * submitters and pollers never cross into Java at all.
+ */
+struct hdfsAsyncReaderInternal {
+    hdfsFS fs;
+    pthread_mutex_t mutex;
+    pthread_cond_t pendingCond;
+    pthread_cond_t doneCond;
+    struct asyncRequest *pendingHead;
+    struct asyncRequest *pendingTail;
+    struct asyncRequest *doneHead;
+    struct asyncRequest *doneTail;
+    int inFlight;
+    int nextTicket;
+    int shutdown;
+    int numThreads;
+    pthread_t *threads;
+};
+
+static void* asyncReaderWorker(void *arg)
 {
-    // JAVA EQUIVALENT
-    //  fos.flush();
+    struct hdfsAsyncReaderInternal *ar = arg;
 
-    //Get the JNIEnv* corresponding to current thread
-    JNIEnv* env = getJNIEnv();
-    if (env == NULL) {
-      errno = EINTERNAL;
-      return -1;
+    for (;;) {
+        pthread_mutex_lock(&ar->mutex);
+        while (!ar->shutdown && ar->pendingHead == NULL) {
+            pthread_cond_wait(&ar->pendingCond, &ar->mutex);
+        }
+        if (ar->pendingHead == NULL) {
+            //shutdown with the queue drained
+            pthread_mutex_unlock(&ar->mutex);
+            break;
+        }
+        struct asyncRequest *req = ar->pendingHead;
+        ar->pendingHead = req->next;
+        if (ar->pendingHead == NULL) {
+            ar->pendingTail = NULL;
+        }
+        pthread_mutex_unlock(&ar->mutex);
+
+        //The actual JNI crossing happens on this thread
+        tSize n = hdfsPread(ar->fs, req->file, req->position,
+                            req->buffer, req->length);
+        req->result = n;
+        req->error = (n < 0) ? errno : 0;
+        req->next = NULL;
+
+        pthread_mutex_lock(&ar->mutex);
+        if (ar->doneTail != NULL) {
+            ar->doneTail->next = req;
+        }
+        else {
+            ar->doneHead = req;
+        }
+        ar->doneTail = req;
+        pthread_cond_signal(&ar->doneCond);
+        pthread_mutex_unlock(&ar->mutex);
     }
+    return NULL;
+}
 
-    //Parameters
-    jobject jOutputStream = (jobject)(f ? f->file : 0);
-
-    //Caught exception
-    jthrowable jExc = NULL;
+hdfsAsyncReader hdfsAsyncReaderCreate(hdfsFS fs, int numThreads)
+{
+    int i;
 
-    //Sanity check
-    if (!f || f->type != OUTPUT) {
-        errno = EBADF;
-        return -1;
+    if (numThreads < 1) {
+        errno = EINVAL;
+        return NULL;
     }
 
-    if (invokeMethod(env, NULL, &jExc, INSTANCE, jOutputStream, 
-                     HADOOP_OSTRM, "flush", "()V") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FSDataInputStream::flush");
-        return -1;
+    struct hdfsAsyncReaderInternal *ar =
+        calloc(1, sizeof(struct hdfsAsyncReaderInternal));
+    if (ar == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    ar->threads = calloc(numThreads, sizeof(pthread_t));
+    if (ar->threads == NULL) {
+        free(ar);
+        errno = ENOMEM;
+        return NULL;
     }
 
-    return 0;
-}
+    ar->fs = fs;
+    pthread_mutex_init(&ar->mutex, NULL);
+    pthread_cond_init(&ar->pendingCond, NULL);
+    pthread_cond_init(&ar->doneCond, NULL);
 
+    for (i = 0; i < numThreads; ++i) {
+        if (pthread_create(&ar->threads[i], NULL, asyncReaderWorker, ar)) {
+            ar->numThreads = i;
+            hdfsAsyncReaderDestroy(ar);
+            errno = EAGAIN;
+            return NULL;
+        }
+    }
+    ar->numThreads = numThreads;
 
+    return ar;
+}
 
-int hdfsAvailable(hdfsFS fs, hdfsFile f)
+int hdfsPreadAsync(hdfsAsyncReader reader, hdfsFile f, tOffset position,
+                   void* buffer, tSize length, void* userData)
 {
-    // JAVA EQUIVALENT
-    //  fis.available();
+    struct hdfsAsyncReaderInternal *ar = reader;
 
-    //Get the JNIEnv* corresponding to current thread
-    JNIEnv* env = getJNIEnv();
-    if (env == NULL) {
-      errno = EINTERNAL;
-      return -1;
+    if (ar == NULL || f == NULL || f->type != INPUT) {
+        errno = EBADF;
+        return -1;
     }
 
-    //Parameters
-    jobject jInputStream = (jobject)(f ? f->file : 0);
-
-    //Caught exception
-    jthrowable jExc = NULL;
-
-    //Sanity check
-    if (!f || f->type != INPUT) {
-        errno = EBADF;
+    struct asyncRequest *req = calloc(1, sizeof(struct asyncRequest));
+    if (req == NULL) {
+        errno = ENOMEM;
         return -1;
     }
+    req->file = f;
+    req->position = position;
+    req->buffer = buffer;
+    req->length = length;
+    req->userData = userData;
 
-    jint available = -1;
-    jvalue jVal;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jInputStream, 
-                     HADOOP_ISTRM, "available", "()I") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FSDataInputStream::available");
+    pthread_mutex_lock(&ar->mutex);
+    if (ar->shutdown) {
+        pthread_mutex_unlock(&ar->mutex);
+        free(req);
+        errno = EBADF;
         return -1;
     }
-    available = jVal.i;
+    req->ticket = ar->nextTicket++;
+    if (ar->pendingTail != NULL) {
+        ar->pendingTail->next = req;
+    }
+    else {
+        ar->pendingHead = req;
+    }
+    ar->pendingTail = req;
+    ar->inFlight++;
+    pthread_cond_signal(&ar->pendingCond);
+    int ticket = req->ticket;
+    pthread_mutex_unlock(&ar->mutex);
 
-    return available;
+    return ticket;
 }
 
-
-
-int hdfsCopy(hdfsFS srcFS, const char* src, hdfsFS dstFS, const char* dst)
+int hdfsAsyncWait(hdfsAsyncReader reader, hdfsAsyncResult* result,
+                  int timeoutMs)
 {
-    //JAVA EQUIVALENT
-    //  FileUtil::copy(srcFS, srcPath, dstFS, dstPath,
-    //                 deleteSource = false, conf)
+    struct hdfsAsyncReaderInternal *ar = reader;
 
-    //Get the JNIEnv* corresponding to current thread
-    JNIEnv* env = getJNIEnv();
-    if (env == NULL) {
-      errno = EINTERNAL;
-      return -1;
+    if (ar == NULL || result == NULL) {
+        errno = EINVAL;
+        return -1;
     }
 
-    //Parameters
-    jobject jSrcFS = (jobject)srcFS;
-    jobject jDstFS = (jobject)dstFS;
-    jobject jSrcPath = NULL;
-    jobject jDstPath = NULL;
+    struct timespec deadline;
+    if (timeoutMs > 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += (long)(timeoutMs % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
 
-    jSrcPath = constructNewObjectOfPath(env, src);
-    if (jSrcPath == NULL) {
-        return -1;
+    pthread_mutex_lock(&ar->mutex);
+    while (ar->doneHead == NULL) {
+        if (ar->inFlight == 0 || timeoutMs == 0) {
+            //nothing outstanding, or the caller is only polling
+            pthread_mutex_unlock(&ar->mutex);
+            return 0;
+        }
+        if (timeoutMs < 0) {
+            pthread_cond_wait(&ar->doneCond, &ar->mutex);
+        }
+        else if (pthread_cond_timedwait(&ar->doneCond, &ar->mutex,
+                                        &deadline) == ETIMEDOUT) {
+            pthread_mutex_unlock(&ar->mutex);
+            return 0;
+        }
     }
 
-    jDstPath = constructNewObjectOfPath(env, dst);
-    if (jDstPath == NULL) {
-        destroyLocalReference(env, jSrcPath);
-        return -1;
+    struct asyncRequest *req = ar->doneHead;
+    ar->doneHead = req->next;
+    if (ar->doneHead == NULL) {
+        ar->doneTail = NULL;
     }
+    ar->inFlight--;
+    pthread_mutex_unlock(&ar->mutex);
 
-    int retval = 0;
+    result->ticket = req->ticket;
+    result->bytesRead = req->result;
+    result->error = req->error;
+    result->userData = req->userData;
+    free(req);
+    return 1;
+}
 
-    //Create the org.apache.hadoop.conf.Configuration object
-    jobject jConfiguration =
-        constructNewObjectOfClass(env, NULL, HADOOP_CONF, "()V");
-    if (jConfiguration == NULL) {
-        fprintf(stderr, "Can't construct instance of class "
-                "org.apache.hadoop.conf.Configuration\n");
-        errno = EINTERNAL;
-        destroyLocalReference(env, jSrcPath);
-        destroyLocalReference(env, jDstPath);
+int hdfsAsyncReaderDestroy(hdfsAsyncReader reader)
+{
+    struct hdfsAsyncReaderInternal *ar = reader;
+    struct asyncRequest *req;
+    int i;
+
+    if (ar == NULL) {
+        errno = EBADF;
         return -1;
     }
 
-    //FileUtil::copy
-    jboolean deleteSource = 0; //Only copy
-    jvalue jVal;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, STATIC, 
-                     NULL, "org/apache/hadoop/fs/FileUtil", "copy",
-                     "(Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;ZLorg/apache/hadoop/conf/Configuration;)Z",
-                     jSrcFS, jSrcPath, jDstFS, jDstPath, deleteSource, 
-                     jConfiguration) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileUtil::copy");
-        retval = -1;
-        goto done;
+    pthread_mutex_lock(&ar->mutex);
+    ar->shutdown = 1;
+    pthread_cond_broadcast(&ar->pendingCond);
+    pthread_mutex_unlock(&ar->mutex);
+
+    //workers finish whatever is still pending before exiting
+    for (i = 0; i < ar->numThreads; ++i) {
+        pthread_join(ar->threads[i], NULL);
     }
 
-    done:
+    while (ar->doneHead != NULL) {
+        req = ar->doneHead;
+        ar->doneHead = req->next;
+        free(req);
+    }
 
-    //Delete unnecessary local references
-    destroyLocalReference(env, jConfiguration);
-    destroyLocalReference(env, jSrcPath);
-    destroyLocalReference(env, jDstPath);
-  
-    return retval;
+    pthread_mutex_destroy(&ar->mutex);
+    pthread_cond_destroy(&ar->pendingCond);
+    pthread_cond_destroy(&ar->doneCond);
+    free(ar->threads);
+    free(ar);
+    return 0;
 }
 
 
 
-int hdfsMove(hdfsFS srcFS, const char* src, hdfsFS dstFS, const char* dst)
+/**
+ * The raw JNI write, shared by the direct, buffered and vectored
+ * paths.
+ */
+static tSize hdfsWriteInternal(JNIEnv *env, hdfsFile f, const void* buffer,
+                               tSize length)
 {
-    //JAVA EQUIVALENT
-    //  FileUtil::copy(srcFS, srcPath, dstFS, dstPath,
-    //                 deleteSource = true, conf)
+    jobject jOutputStream = (jobject)f->file;
+    jbyteArray jbWarray;
+    jthrowable jExc = NULL;
+
+    // 'length' equals 'zero' is a valid use-case according to Posix!
+    if (length != 0) {
+        //Write the requisite bytes into the file
+        jbWarray = (*env)->NewByteArray(env, length);
+        (*env)->SetByteArrayRegion(env, jbWarray, 0, length, buffer);
+        if (invokeMethod(env, NULL, &jExc, INSTANCE, jOutputStream,
+                         HADOOP_OSTRM, "write",
+                         "([B)V", jbWarray) != 0) {
+            errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                       "FSDataOutputStream::write");
+            length = -1;
+        }
+        destroyLocalReference(env, jbWarray);
+    }
+
+    //Return no. of bytes succesfully written (libc way)
+    //i.e. 'length' itself! ;-)
+    return length;
+}
+
+static int writeBufferFlush(JNIEnv *env, hdfsFile f)
+{
+    struct hdfsWriteBuffer *wb = f->writebuf;
+    if (wb == NULL || wb->used == 0) {
+        return 0;
+    }
+    if (hdfsWriteInternal(env, f, wb->data, wb->used) < 0) {
+        return -1;
+    }
+    wb->used = 0;
+    return 0;
+}
+
+static tSize writeBuffered(JNIEnv *env, hdfsFile f, const void* buffer,
+                           tSize length)
+{
+    struct hdfsWriteBuffer *wb = f->writebuf;
+    const char *cur = buffer;
+    tSize remaining = length;
+
+    while (remaining > 0) {
+        if (wb->used == 0 && remaining >= wb->size) {
+            //large writes go through without the extra copy
+            if (hdfsWriteInternal(env, f, cur, remaining) < 0) {
+                return -1;
+            }
+            break;
+        }
+        tSize room = wb->size - wb->used;
+        tSize chunk = (remaining < room) ? remaining : room;
+        memcpy(wb->data + wb->used, cur, chunk);
+        wb->used += chunk;
+        cur += chunk;
+        remaining -= chunk;
+        if (wb->used == wb->size) {
+            if (writeBufferFlush(env, f) != 0) {
+                return -1;
+            }
+        }
+    }
+    return length;
+}
+
+static tSize hdfsWriteImpl(hdfsFS fs, hdfsFile f, const void* buffer,
+                           tSize length)
+{
+    // JAVA EQUIVALENT
+    // byte b[] = str.getBytes();
+    // fso.write(b);
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1045,72 +1993,104 @@ int hdfsMove(hdfsFS srcFS, const char* src, hdfsFS dstFS, const char* dst)
       return -1;
     }
 
+    //Sanity check
+    if (!f || f->type == UNINITIALIZED) {
+        errno = EBADF;
+        return -1;
+    }
 
-    //Parameters
-    jobject jSrcFS = (jobject)srcFS;
-    jobject jDstFS = (jobject)dstFS;
-
-    jobject jSrcPath = NULL;
-    jobject jDstPath = NULL;
+    if (length < 0) {
+    	errno = EINVAL;
+    	return -1;
+    }
 
-    jSrcPath = constructNewObjectOfPath(env, src);
-    if (jSrcPath == NULL) {
+    //Error checking... make sure that this file is 'writable'
+    if (f->type != OUTPUT) {
+        fprintf(stderr, "Cannot write into a non-OutputStream object!\n");
+        errno = EINVAL;
         return -1;
     }
 
-    jDstPath = constructNewObjectOfPath(env, dst);
-    if (jDstPath == NULL) {
-        destroyLocalReference(env, jSrcPath);
-        return -1;
+    //Coalesce small writes natively when buffering is on
+    if (f->writebuf != NULL) {
+        return writeBuffered(env, f, buffer, length);
     }
 
-    int retval = 0;
+    return hdfsWriteInternal(env, f, buffer, length);
+}
 
-    //Create the org.apache.hadoop.conf.Configuration object
-    jobject jConfiguration =
-        constructNewObjectOfClass(env, NULL, HADOOP_CONF, "()V");
-    if (jConfiguration == NULL) {
-        fprintf(stderr, "Can't construct instance of class "
-                "org.apache.hadoop.conf.Configuration\n");
-        errno = EINTERNAL;
-        destroyLocalReference(env, jSrcPath);
-        destroyLocalReference(env, jDstPath);
+
+
+tSize hdfsWrite(hdfsFS fs, hdfsFile f, const void* buffer, tSize length)
+{
+    uint64_t start = statsBegin();
+    tSize n = hdfsWriteImpl(fs, f, buffer, length);
+    statsRecord(HDFS_STAT_WRITE, start, n, n < 0);
+    return n;
+}
+
+
+
+tSize hdfsWritev(hdfsFS fs, hdfsFile f, const struct iovec* iov, int iovcnt)
+{
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    //Sanity check
+    if (!f || f->type != OUTPUT) {
+        errno = EBADF;
         return -1;
     }
 
-    //FileUtil::copy
-    jboolean deleteSource = 1; //Delete src after copy
-    jvalue jVal;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, STATIC, NULL,
-                     "org/apache/hadoop/fs/FileUtil", "copy",
-                "(Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;ZLorg/apache/hadoop/conf/Configuration;)Z",
-                     jSrcFS, jSrcPath, jDstFS, jDstPath, deleteSource, 
-                     jConfiguration) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileUtil::copy(move)");
-        retval = -1;
-        goto done;
+    if (iovcnt < 0 || (iovcnt > 0 && iov == NULL)) {
+        errno = EINVAL;
+        return -1;
     }
 
-    done:
+    tSize total = 0;
+    int i;
+    for (i = 0; i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+    if (total == 0) {
+        return 0;
+    }
 
-    //Delete unnecessary local references
-    destroyLocalReference(env, jConfiguration);
-    destroyLocalReference(env, jSrcPath);
-    destroyLocalReference(env, jDstPath);
-  
-    return retval;
+    //With buffering on, the segments coalesce in the write buffer
+    if (f->writebuf != NULL) {
+        for (i = 0; i < iovcnt; i++) {
+            if (writeBuffered(env, f, iov[i].iov_base,
+                              iov[i].iov_len) < 0) {
+                return -1;
+            }
+        }
+        return total;
+    }
+
+    //Gather natively so the stream sees one write
+    char *gathered = malloc(total);
+    if (gathered == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    tSize offset = 0;
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(gathered + offset, iov[i].iov_base, iov[i].iov_len);
+        offset += iov[i].iov_len;
+    }
+    tSize written = hdfsWriteInternal(env, f, gathered, total);
+    free(gathered);
+    return written;
 }
 
 
 
-int hdfsDelete(hdfsFS fs, const char* path, int recursive)
+int hdfsFileSetWriteBuffer(hdfsFS fs, hdfsFile f, tSize bufferSize)
 {
-    // JAVA EQUIVALENT:
-    //  File f = new File(path);
-    //  bool retval = fs.delete(f);
-
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
     if (env == NULL) {
@@ -1118,40 +2098,52 @@ int hdfsDelete(hdfsFS fs, const char* path, int recursive)
       return -1;
     }
 
-    jobject jFS = (jobject)fs;
-
-    //Create an object of java.io.File
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
+    //Sanity check
+    if (!f || f->type != OUTPUT) {
+        errno = EBADF;
         return -1;
     }
 
-    //Delete the file
-    jvalue jVal;
-    jthrowable jExc = NULL;
-    jboolean jRecursive = recursive;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "delete", "(Lorg/apache/hadoop/fs/Path;Z)Z",
-                     jPath, jRecursive) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::delete");
+    if (bufferSize < 0) {
+        errno = EINVAL;
         return -1;
     }
 
-    //Delete unnecessary local references
-    destroyLocalReference(env, jPath);
+    if (f->writebuf != NULL) {
+        struct hdfsWriteBuffer *wb = f->writebuf;
+        if (writeBufferFlush(env, f) != 0) {
+            return -1;
+        }
+        f->writebuf = NULL;
+        free(wb->data);
+        free(wb);
+    }
+    if (bufferSize == 0) {
+        return 0;
+    }
 
-    return (jVal.z) ? 0 : -1;
+    struct hdfsWriteBuffer *wb = calloc(1, sizeof(struct hdfsWriteBuffer));
+    if (wb == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    wb->data = malloc(bufferSize);
+    if (wb->data == NULL) {
+        free(wb);
+        errno = ENOMEM;
+        return -1;
+    }
+    wb->size = bufferSize;
+    f->writebuf = wb;
+    return 0;
 }
 
 
 
-int hdfsRename(hdfsFS fs, const char* oldPath, const char* newPath)
+int hdfsSeek(hdfsFS fs, hdfsFile f, tOffset desiredPos) 
 {
-    // JAVA EQUIVALENT:
-    //  Path old = new Path(oldPath);
-    //  Path new = new Path(newPath);
-    //  fs.rename(old, new);
+    // JAVA EQUIVALENT
+    //  fis.seek(pos);
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1160,104 +2152,112 @@ int hdfsRename(hdfsFS fs, const char* oldPath, const char* newPath)
       return -1;
     }
 
-    jobject jFS = (jobject)fs;
+    //Parameters
+    jobject jInputStream = (jobject)(f ? f->file : 0);
 
-    //Create objects of org.apache.hadoop.fs.Path
-    jobject jOldPath = NULL;
-    jobject jNewPath = NULL;
+    //Caught exception
+    jthrowable jExc = NULL;
 
-    jOldPath = constructNewObjectOfPath(env, oldPath);
-    if (jOldPath == NULL) {
+    //Sanity check
+    if (!f || f->type != INPUT) {
+        errno = EBADF;
         return -1;
     }
 
-    jNewPath = constructNewObjectOfPath(env, newPath);
-    if (jNewPath == NULL) {
-        destroyLocalReference(env, jOldPath);
-        return -1;
+    //Short-circuit: only the local descriptor's offset matters
+    if (f->localFd >= 0) {
+        if (lseek(f->localFd, desiredPos, SEEK_SET) == (off_t)-1) {
+            return -1;
+        }
+        return 0;
     }
 
-    //Rename the file
-    jvalue jVal;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS, "rename",
-                     JMETHOD2(JPARAM(HADOOP_PATH), JPARAM(HADOOP_PATH), "Z"),
-                     jOldPath, jNewPath) != 0) {
+    if (invokeMethod(env, NULL, &jExc, INSTANCE, jInputStream, HADOOP_ISTRM,
+                     "seek", "(J)V", desiredPos) != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::rename");
+                                   "FSDataInputStream::seek");
         return -1;
     }
 
-    //Delete unnecessary local references
-    destroyLocalReference(env, jOldPath);
-    destroyLocalReference(env, jNewPath);
+    //Restart the prefetch from the new offset
+    if (f->readahead != NULL) {
+        struct hdfsReadahead *ra = f->readahead;
+        pthread_mutex_lock(&ra->mutex);
+        ra->position = desiredPos;
+        ra->nextOffset = desiredPos;
+        ra->eofAt = -1;
+        pthread_cond_broadcast(&ra->cond);
+        pthread_mutex_unlock(&ra->mutex);
+    }
 
-    return (jVal.z) ? 0 : -1;
+    return 0;
 }
 
 
 
-char* hdfsGetWorkingDirectory(hdfsFS fs, char* buffer, size_t bufferSize)
+tOffset hdfsTell(hdfsFS fs, hdfsFile f)
 {
-    // JAVA EQUIVALENT:
-    //  Path p = fs.getWorkingDirectory(); 
-    //  return p.toString()
+    // JAVA EQUIVALENT
+    //  pos = f.getPos();
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
     if (env == NULL) {
       errno = EINTERNAL;
-      return NULL;
+      return -1;
     }
 
-    jobject jFS = (jobject)fs;
-    jobject jPath = NULL;
-    jvalue jVal;
-    jthrowable jExc = NULL;
+    //Parameters
+    jobject jStream = (jobject)(f ? f->file : 0);
 
-    //FileSystem::getWorkingDirectory()
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS,
-                     HADOOP_FS, "getWorkingDirectory",
-                     "()Lorg/apache/hadoop/fs/Path;") != 0 ||
-        jVal.l == NULL) {
-        errno = errnoFromException(jExc, env, "FileSystem::"
-                                   "getWorkingDirectory");
-        return NULL;
+    //Sanity check
+    if (!f || f->type == UNINITIALIZED) {
+        errno = EBADF;
+        return -1;
     }
-    jPath = jVal.l;
 
-    //Path::toString()
-    jstring jPathString;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jPath, 
-                     "org/apache/hadoop/fs/Path", "toString",
-                     "()Ljava/lang/String;") != 0) { 
-        errno = errnoFromException(jExc, env, "Path::toString");
-        destroyLocalReference(env, jPath);
-        return NULL;
+    //Short-circuit: the local descriptor's offset is the position
+    if (f->localFd >= 0) {
+        return (tOffset)lseek(f->localFd, 0, SEEK_CUR);
     }
-    jPathString = jVal.l;
 
-    const char *jPathChars = (const char*)
-        ((*env)->GetStringUTFChars(env, jPathString, NULL));
+    //With readahead on, the native side tracks the position
+    if (f->readahead != NULL) {
+        struct hdfsReadahead *ra = f->readahead;
+        pthread_mutex_lock(&ra->mutex);
+        tOffset position = ra->position;
+        pthread_mutex_unlock(&ra->mutex);
+        return position;
+    }
 
-    //Copy to user-provided buffer
-    strncpy(buffer, jPathChars, bufferSize);
+    const char* interface = (f->type == INPUT) ?
+        HADOOP_ISTRM : HADOOP_OSTRM;
 
-    //Delete unnecessary local references
-    (*env)->ReleaseStringUTFChars(env, jPathString, jPathChars);
+    jlong currentPos  = -1;
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStream,
+                     interface, "getPos", "()J") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FSDataInputStream::getPos");
+        return -1;
+    }
+    currentPos = jVal.j;
 
-    destroyLocalReference(env, jPathString);
-    destroyLocalReference(env, jPath);
+    //Bytes still in the native write buffer count as written
+    if (f->type == OUTPUT && f->writebuf != NULL) {
+        currentPos += ((struct hdfsWriteBuffer*)f->writebuf)->used;
+    }
 
-    return buffer;
+    return (tOffset)currentPos;
 }
 
 
 
-int hdfsSetWorkingDirectory(hdfsFS fs, const char* path)
+int hdfsFlush(hdfsFS fs, hdfsFile f) 
 {
-    // JAVA EQUIVALENT:
-    //  fs.setWorkingDirectory(Path(path)); 
+    // JAVA EQUIVALENT
+    //  fos.flush();
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1266,37 +2266,39 @@ int hdfsSetWorkingDirectory(hdfsFS fs, const char* path)
       return -1;
     }
 
-    jobject jFS = (jobject)fs;
-    int retval = 0;
+    //Parameters
+    jobject jOutputStream = (jobject)(f ? f->file : 0);
+
+    //Caught exception
     jthrowable jExc = NULL;
 
-    //Create an object of org.apache.hadoop.fs.Path
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
+    //Sanity check
+    if (!f || f->type != OUTPUT) {
+        errno = EBADF;
         return -1;
     }
 
-    //FileSystem::setWorkingDirectory()
-    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "setWorkingDirectory", 
-                     "(Lorg/apache/hadoop/fs/Path;)V", jPath) != 0) {
-        errno = errnoFromException(jExc, env, "FileSystem::"
-                                   "setWorkingDirectory");
-        retval = -1;
+    //Push buffered writes down to the stream first
+    if (writeBufferFlush(env, f) != 0) {
+        return -1;
     }
 
-    //Delete unnecessary local references
-    destroyLocalReference(env, jPath);
+    if (invokeMethod(env, NULL, &jExc, INSTANCE, jOutputStream, 
+                     HADOOP_OSTRM, "flush", "()V") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FSDataInputStream::flush");
+        return -1;
+    }
 
-    return retval;
+    return 0;
 }
 
 
 
-int hdfsCreateDirectory(hdfsFS fs, const char* path)
+int hdfsAvailable(hdfsFS fs, hdfsFile f)
 {
-    // JAVA EQUIVALENT:
-    //  fs.mkdirs(new Path(path));
+    // JAVA EQUIVALENT
+    //  fis.available();
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1305,39 +2307,38 @@ int hdfsCreateDirectory(hdfsFS fs, const char* path)
       return -1;
     }
 
-    jobject jFS = (jobject)fs;
+    //Parameters
+    jobject jInputStream = (jobject)(f ? f->file : 0);
 
-    //Create an object of org.apache.hadoop.fs.Path
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
+    //Caught exception
+    jthrowable jExc = NULL;
+
+    //Sanity check
+    if (!f || f->type != INPUT) {
+        errno = EBADF;
         return -1;
     }
 
-    //Create the directory
+    jint available = -1;
     jvalue jVal;
-    jVal.z = 0;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "mkdirs", "(Lorg/apache/hadoop/fs/Path;)Z",
-                     jPath) != 0) {
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jInputStream, 
+                     HADOOP_ISTRM, "available", "()I") != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::mkdirs");
-        goto done;
+                                   "FSDataInputStream::available");
+        return -1;
     }
+    available = jVal.i;
 
- done:
-
-    //Delete unnecessary local references
-    destroyLocalReference(env, jPath);
-
-    return (jVal.z) ? 0 : -1;
+    return available;
 }
 
 
-int hdfsSetReplication(hdfsFS fs, const char* path, int16_t replication)
+
+int hdfsCopy(hdfsFS srcFS, const char* src, hdfsFS dstFS, const char* dst)
 {
-    // JAVA EQUIVALENT:
-    //  fs.setReplication(new Path(path), replication);
+    //JAVA EQUIVALENT
+    //  FileUtil::copy(srcFS, srcPath, dstFS, dstPath,
+    //                 deleteSource = false, conf)
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1346,323 +2347,421 @@ int hdfsSetReplication(hdfsFS fs, const char* path, int16_t replication)
       return -1;
     }
 
-    jobject jFS = (jobject)fs;
+    //Parameters
+    jobject jSrcFS = (jobject)srcFS;
+    jobject jDstFS = (jobject)dstFS;
+    jobject jSrcPath = NULL;
+    jobject jDstPath = NULL;
 
-    //Create an object of org.apache.hadoop.fs.Path
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
+    jSrcPath = constructNewObjectOfPath(env, src);
+    if (jSrcPath == NULL) {
         return -1;
     }
 
-    //Create the directory
+    jDstPath = constructNewObjectOfPath(env, dst);
+    if (jDstPath == NULL) {
+        destroyLocalReference(env, jSrcPath);
+        return -1;
+    }
+
+    int retval = 0;
+
+    //Create the org.apache.hadoop.conf.Configuration object
+    jobject jConfiguration =
+        constructNewObjectOfClass(env, NULL, HADOOP_CONF, "()V");
+    if (jConfiguration == NULL) {
+        fprintf(stderr, "Can't construct instance of class "
+                "org.apache.hadoop.conf.Configuration\n");
+        errno = EINTERNAL;
+        destroyLocalReference(env, jSrcPath);
+        destroyLocalReference(env, jDstPath);
+        return -1;
+    }
+
+    //FileUtil::copy
+    jboolean deleteSource = 0; //Only copy
     jvalue jVal;
     jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "setReplication", "(Lorg/apache/hadoop/fs/Path;S)Z",
-                     jPath, replication) != 0) {
+    if (invokeMethod(env, &jVal, &jExc, STATIC, 
+                     NULL, "org/apache/hadoop/fs/FileUtil", "copy",
+                     "(Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;ZLorg/apache/hadoop/conf/Configuration;)Z",
+                     jSrcFS, jSrcPath, jDstFS, jDstPath, deleteSource, 
+                     jConfiguration) != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::setReplication");
+                                   "FileUtil::copy");
+        retval = -1;
         goto done;
     }
 
- done:
+    done:
 
     //Delete unnecessary local references
-    destroyLocalReference(env, jPath);
-
-    return (jVal.z) ? 0 : -1;
+    destroyLocalReference(env, jConfiguration);
+    destroyLocalReference(env, jSrcPath);
+    destroyLocalReference(env, jDstPath);
+  
+    return retval;
 }
 
-int hdfsChown(hdfsFS fs, const char* path, const char *owner, const char *group)
-{
-    // JAVA EQUIVALENT:
-    //  fs.setOwner(path, owner, group)
 
-    //Get the JNIEnv* corresponding to current thread
-    JNIEnv* env = getJNIEnv();
-    if (env == NULL) {
-      errno = EINTERNAL;
-      return -1;
-    }
 
-    if (owner == NULL && group == NULL) {
-      fprintf(stderr, "Both owner and group cannot be null in chown");
-      errno = EINVAL;
-      return -1;
-    }
+#define COPY_BUFFER_SIZE 65536
 
-    jobject jFS = (jobject)fs;
+/**
+ * One file to copy, queued up by the enumeration pass.
+ */
+struct copyTask {
+    char *src;
+    char *dst;
+    struct copyTask *next;
+};
 
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
+/**
+ * Shared state of one parallel copy: the task queue the workers
+ * drain, aggregate byte counters for progress and throttling, and
+ * the first failure. Files are the unit of parallelism — an HDFS
+ * output stream only appends, so one file cannot be written by
+ * several streams and reassembled natively.
+ */
+struct copyJob {
+    hdfsFS srcFS;
+    hdfsFS dstFS;
+    struct copyTask *head;
+    pthread_mutex_t mutex;
+    tOffset totalBytes;
+    tOffset copiedBytes;
+    long long startMicros;
+    tOffset bytesPerSec;
+    hdfsCopyProgress progress;
+    void *progressContext;
+    int failed;
+};
+
+static long long copyNowMicros(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+//walk the source tree: directories are created on the destination
+//right away, files become tasks for the workers
+static int copyEnumerate(struct copyJob *job, const char* src,
+                         const char* dst)
+{
+    hdfsFileInfo *info = hdfsGetPathInfo(job->srcFS, src);
+    if (info == NULL) {
         return -1;
     }
 
-    jstring jOwnerString = (*env)->NewStringUTF(env, owner); 
-    jstring jGroupString = (*env)->NewStringUTF(env, group); 
-
-    //Create the directory
     int ret = 0;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "setOwner", JMETHOD3(JPARAM(HADOOP_PATH), JPARAM(JAVA_STRING), JPARAM(JAVA_STRING), JAVA_VOID),
-                     jPath, jOwnerString, jGroupString) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::setOwner");
-        ret = -1;
-        goto done;
+    if (info->mKind == kObjectKindDirectory) {
+        if (hdfsCreateDirectory(job->dstFS, dst)) {
+            ret = -1;
+        }
+        else {
+            int numEntries = 0;
+            hdfsFileInfo *children =
+                hdfsListDirectory(job->srcFS, src, &numEntries);
+            if (children == NULL && numEntries != 0) {
+                ret = -1;
+            }
+            int i;
+            for (i = 0; children != NULL && ret == 0 && i < numEntries;
+                    ++i) {
+                const char *base = strrchr(children[i].mName, '/');
+                base = (base != NULL) ? base + 1 : children[i].mName;
+                size_t srcLen = strlen(src) + strlen(base) + 2;
+                size_t dstLen = strlen(dst) + strlen(base) + 2;
+                char *childSrc = malloc(srcLen);
+                char *childDst = malloc(dstLen);
+                if (childSrc == NULL || childDst == NULL) {
+                    errno = ENOMEM;
+                    ret = -1;
+                }
+                else {
+                    snprintf(childSrc, srcLen, "%s/%s", src, base);
+                    snprintf(childDst, dstLen, "%s/%s", dst, base);
+                    ret = copyEnumerate(job, childSrc, childDst);
+                }
+                free(childSrc);
+                free(childDst);
+            }
+            if (children != NULL) {
+                hdfsFreeFileInfo(children, numEntries);
+            }
+        }
+    }
+    else {
+        struct copyTask *t = calloc(1, sizeof(struct copyTask));
+        if (t == NULL) {
+            errno = ENOMEM;
+            ret = -1;
+        }
+        else {
+            t->src = strdup(src);
+            t->dst = strdup(dst);
+            if (t->src == NULL || t->dst == NULL) {
+                free(t->src);
+                free(t->dst);
+                free(t);
+                errno = ENOMEM;
+                ret = -1;
+            }
+            else {
+                t->next = job->head;
+                job->head = t;
+                job->totalBytes += info->mSize;
+            }
+        }
     }
 
- done:
-    destroyLocalReference(env, jPath);
-    destroyLocalReference(env, jOwnerString);
-    destroyLocalReference(env, jGroupString);
-
+    hdfsFreeFileInfo(info, 1);
     return ret;
 }
 
-int hdfsChmod(hdfsFS fs, const char* path, short mode)
+//sleep long enough to keep the aggregate rate under the cap
+static void copyThrottle(struct copyJob *job, tOffset copied)
 {
-    // JAVA EQUIVALENT:
-    //  fs.setPermission(path, FsPermission)
-
-    //Get the JNIEnv* corresponding to current thread
-    JNIEnv* env = getJNIEnv();
-    if (env == NULL) {
-      errno = EINTERNAL;
-      return -1;
+    if (job->bytesPerSec <= 0) {
+        return;
     }
+    long long expected = copied * 1000000LL / job->bytesPerSec;
+    long long elapsed = copyNowMicros() - job->startMicros;
+    if (expected > elapsed) {
+        long long excess = expected - elapsed;
+        usleep((excess > 1000000LL) ? 1000000 : (unsigned int)excess);
+    }
+}
 
-    jobject jFS = (jobject)fs;
-
-    // construct jPerm = FsPermission.createImmutable(short mode);
+static int copyOneFile(struct copyJob *job, struct copyTask *t,
+                       char *buffer)
+{
+    hdfsFile srcFile = hdfsOpenFile(job->srcFS, t->src, O_RDONLY, 0, 0, 0);
+    if (srcFile == NULL) {
+        return -1;
+    }
+    hdfsFile dstFile = hdfsOpenFile(job->dstFS, t->dst, O_WRONLY, 0, 0, 0);
+    if (dstFile == NULL) {
+        hdfsCloseFile(job->srcFS, srcFile);
+        return -1;
+    }
 
-    jshort jmode = mode;
+    int ret = 0;
+    for (;;) {
+        tSize n = hdfsRead(job->srcFS, srcFile, buffer, COPY_BUFFER_SIZE);
+        if (n < 0) {
+            ret = -1;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (hdfsWrite(job->dstFS, dstFile, buffer, n) != n) {
+            ret = -1;
+            break;
+        }
 
-    jobject jPermObj =
-      constructNewObjectOfClass(env, NULL, HADOOP_FSPERM,"(S)V",jmode);
-    if (jPermObj == NULL) {
-      return -2;
-    }
+        pthread_mutex_lock(&job->mutex);
+        job->copiedBytes += n;
+        tOffset copied = job->copiedBytes;
+        tOffset total = job->totalBytes;
+        pthread_mutex_unlock(&job->mutex);
 
-    //Create an object of org.apache.hadoop.fs.Path
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
-      return -3;
+        if (job->progress != NULL) {
+            job->progress(t->src, copied, total, job->progressContext);
+        }
+        copyThrottle(job, copied);
     }
 
-    //Create the directory
-    int ret = 0;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "setPermission", JMETHOD2(JPARAM(HADOOP_PATH), JPARAM(HADOOP_FSPERM), JAVA_VOID),
-                     jPath, jPermObj) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::setPermission");
+    if (hdfsCloseFile(job->srcFS, srcFile) != 0) {
         ret = -1;
-        goto done;
     }
+    if (hdfsCloseFile(job->dstFS, dstFile) != 0) {
+        ret = -1;
+    }
+    return ret;
+}
 
- done:
-    destroyLocalReference(env, jPath);
-    destroyLocalReference(env, jPermObj);
+static void* copyWorker(void *arg)
+{
+    struct copyJob *job = arg;
 
-    return ret;
+    char *buffer = malloc(COPY_BUFFER_SIZE);
+    if (buffer == NULL) {
+        pthread_mutex_lock(&job->mutex);
+        job->failed = 1;
+        pthread_mutex_unlock(&job->mutex);
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&job->mutex);
+        if (job->failed || job->head == NULL) {
+            pthread_mutex_unlock(&job->mutex);
+            break;
+        }
+        struct copyTask *t = job->head;
+        job->head = t->next;
+        pthread_mutex_unlock(&job->mutex);
+
+        if (copyOneFile(job, t, buffer) != 0) {
+            pthread_mutex_lock(&job->mutex);
+            job->failed = 1;
+            pthread_mutex_unlock(&job->mutex);
+        }
+        free(t->src);
+        free(t->dst);
+        free(t);
+    }
+
+    free(buffer);
+    return NULL;
 }
 
-int hdfsUtime(hdfsFS fs, const char* path, tTime mtime, tTime atime)
+int hdfsCopyParallel(hdfsFS srcFS, const char* src, hdfsFS dstFS,
+                     const char* dst, int numThreads, tOffset bytesPerSec,
+                     hdfsCopyProgress progress, void* progressContext)
 {
-    // JAVA EQUIVALENT:
-    //  fs.setTimes(src, mtime, atime)
+    int i;
 
-    //Get the JNIEnv* corresponding to current thread
-    JNIEnv* env = getJNIEnv();
-    if (env == NULL) {
-      errno = EINTERNAL;
-      return -1;
+    if (numThreads < 1) {
+        errno = EINVAL;
+        return -1;
     }
 
-    jobject jFS = (jobject)fs;
+    struct copyJob job;
+    memset(&job, 0, sizeof(job));
+    job.srcFS = srcFS;
+    job.dstFS = dstFS;
+    job.bytesPerSec = bytesPerSec;
+    job.progress = progress;
+    job.progressContext = progressContext;
+    pthread_mutex_init(&job.mutex, NULL);
 
-    //Create an object of org.apache.hadoop.fs.Path
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
-      fprintf(stderr, "could not construct path object\n");
-      return -2;
+    if (copyEnumerate(&job, src, dst) != 0) {
+        job.failed = 1;
     }
 
-    jlong jmtime = mtime * (jlong)1000;
-    jlong jatime = atime * (jlong)1000;
+    if (!job.failed && job.head != NULL) {
+        pthread_t *threads = calloc(numThreads, sizeof(pthread_t));
+        if (threads == NULL) {
+            job.failed = 1;
+            errno = ENOMEM;
+        }
+        else {
+            job.startMicros = copyNowMicros();
+            int started = 0;
+            for (i = 0; i < numThreads; ++i) {
+                if (pthread_create(&threads[i], NULL, copyWorker, &job)) {
+                    break;
+                }
+                started++;
+            }
+            if (started == 0) {
+                job.failed = 1;
+                errno = EAGAIN;
+            }
+            for (i = 0; i < started; ++i) {
+                pthread_join(threads[i], NULL);
+            }
+            free(threads);
+        }
+    }
 
-    int ret = 0;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "setTimes", JMETHOD3(JPARAM(HADOOP_PATH), "J", "J", JAVA_VOID),
-                     jPath, jmtime, jatime) != 0) {
-      fprintf(stderr, "call to setTime failed\n");
-      errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                 "FileSystem::setTimes");
-      ret = -1;
-      goto done;
+    //free tasks a failure left behind
+    while (job.head != NULL) {
+        struct copyTask *t = job.head;
+        job.head = t->next;
+        free(t->src);
+        free(t->dst);
+        free(t);
     }
+    pthread_mutex_destroy(&job.mutex);
 
- done:
-    destroyLocalReference(env, jPath);
-    return ret;
+    return job.failed ? -1 : 0;
 }
 
 
 
-
-char***
-hdfsGetHosts(hdfsFS fs, const char* path, tOffset start, tOffset length)
+int hdfsMove(hdfsFS srcFS, const char* src, hdfsFS dstFS, const char* dst)
 {
-    // JAVA EQUIVALENT:
-    //  fs.getFileBlockLoctions(new Path(path), start, length);
+    //JAVA EQUIVALENT
+    //  FileUtil::copy(srcFS, srcPath, dstFS, dstPath,
+    //                 deleteSource = true, conf)
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
     if (env == NULL) {
       errno = EINTERNAL;
-      return NULL;
+      return -1;
     }
 
-    jobject jFS = (jobject)fs;
 
-    //Create an object of org.apache.hadoop.fs.Path
-    jobject jPath = constructNewObjectOfPath(env, path);
-    if (jPath == NULL) {
-        return NULL;
-    }
+    //Parameters
+    jobject jSrcFS = (jobject)srcFS;
+    jobject jDstFS = (jobject)dstFS;
 
-    jvalue jFSVal;
-    jthrowable jFSExc = NULL;
-    if (invokeMethod(env, &jFSVal, &jFSExc, INSTANCE, jFS,
-                     HADOOP_FS, "getFileStatus", 
-                     "(Lorg/apache/hadoop/fs/Path;)"
-                     "Lorg/apache/hadoop/fs/FileStatus;",
-                     jPath) != 0) {
-        errno = errnoFromException(jFSExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::getFileStatus");
-        destroyLocalReference(env, jPath);
-        return NULL;
+    jobject jSrcPath = NULL;
+    jobject jDstPath = NULL;
+
+    jSrcPath = constructNewObjectOfPath(env, src);
+    if (jSrcPath == NULL) {
+        return -1;
     }
-    jobject jFileStatus = jFSVal.l;
 
-    //org.apache.hadoop.fs.FileSystem::getFileBlockLocations
-    char*** blockHosts = NULL;
-    jobjectArray jBlockLocations;;
-    jvalue jVal;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS,
-                     HADOOP_FS, "getFileBlockLocations", 
-                     "(Lorg/apache/hadoop/fs/FileStatus;JJ)"
-                     "[Lorg/apache/hadoop/fs/BlockLocation;",
-                     jFileStatus, start, length) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::getFileBlockLocations");
-        destroyLocalReference(env, jPath);
-        destroyLocalReference(env, jFileStatus);
-        return NULL;
+    jDstPath = constructNewObjectOfPath(env, dst);
+    if (jDstPath == NULL) {
+        destroyLocalReference(env, jSrcPath);
+        return -1;
     }
-    jBlockLocations = jVal.l;
 
-    //Figure out no of entries in jBlockLocations
-    //Allocate memory and add NULL at the end
-    jsize jNumFileBlocks = (*env)->GetArrayLength(env, jBlockLocations);
+    int retval = 0;
 
-    blockHosts = malloc(sizeof(char**) * (jNumFileBlocks+1));
-    if (blockHosts == NULL) {
-        errno = ENOMEM;
-        goto done;
+    //Create the org.apache.hadoop.conf.Configuration object
+    jobject jConfiguration =
+        constructNewObjectOfClass(env, NULL, HADOOP_CONF, "()V");
+    if (jConfiguration == NULL) {
+        fprintf(stderr, "Can't construct instance of class "
+                "org.apache.hadoop.conf.Configuration\n");
+        errno = EINTERNAL;
+        destroyLocalReference(env, jSrcPath);
+        destroyLocalReference(env, jDstPath);
+        return -1;
     }
-    blockHosts[jNumFileBlocks] = NULL;
-    if (jNumFileBlocks == 0) {
-        errno = 0;
+
+    //FileUtil::copy
+    jboolean deleteSource = 1; //Delete src after copy
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, STATIC, NULL,
+                     "org/apache/hadoop/fs/FileUtil", "copy",
+                "(Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;Lorg/apache/hadoop/fs/FileSystem;Lorg/apache/hadoop/fs/Path;ZLorg/apache/hadoop/conf/Configuration;)Z",
+                     jSrcFS, jSrcPath, jDstFS, jDstPath, deleteSource, 
+                     jConfiguration) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileUtil::copy(move)");
+        retval = -1;
         goto done;
     }
 
-    //Now parse each block to get hostnames
-    int i = 0;
-    for (i=0; i < jNumFileBlocks; ++i) {
-        jobject jFileBlock =
-            (*env)->GetObjectArrayElement(env, jBlockLocations, i);
-        
-        jvalue jVal;
-        jobjectArray jFileBlockHosts;
-        if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFileBlock, HADOOP_BLK_LOC,
-                         "getHosts", "()[Ljava/lang/String;") ||
-                jVal.l == NULL) {
-            errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                       "BlockLocation::getHosts");
-            destroyLocalReference(env, jPath);
-            destroyLocalReference(env, jFileStatus);
-            destroyLocalReference(env, jBlockLocations);
-            return NULL;
-        }
-        
-        jFileBlockHosts = jVal.l;
-        //Figure out no of hosts in jFileBlockHosts
-        //Allocate memory and add NULL at the end
-        jsize jNumBlockHosts = (*env)->GetArrayLength(env, jFileBlockHosts);
-        blockHosts[i] = malloc(sizeof(char*) * (jNumBlockHosts+1));
-        if (blockHosts[i] == NULL) {
-            int x = 0;
-            for (x=0; x < i; ++x) {
-                free(blockHosts[x]);
-            }
-            free(blockHosts);
-            errno = ENOMEM;
-            goto done;
-        }
-        blockHosts[i][jNumBlockHosts] = NULL;
-
-        //Now parse each hostname
-        int j = 0;
-        const char *hostName;
-        for (j=0; j < jNumBlockHosts; ++j) {
-            jstring jHost =
-                (*env)->GetObjectArrayElement(env, jFileBlockHosts, j);
-           
-            hostName =
-                (const char*)((*env)->GetStringUTFChars(env, jHost, NULL));
-            blockHosts[i][j] = strdup(hostName);
-
-            (*env)->ReleaseStringUTFChars(env, jHost, hostName);
-            destroyLocalReference(env, jHost);
-        }
-
-        destroyLocalReference(env, jFileBlockHosts);
-    }
-  
     done:
 
     //Delete unnecessary local references
-    destroyLocalReference(env, jPath);
-    destroyLocalReference(env, jFileStatus);
-    destroyLocalReference(env, jBlockLocations);
-
-    return blockHosts;
+    destroyLocalReference(env, jConfiguration);
+    destroyLocalReference(env, jSrcPath);
+    destroyLocalReference(env, jDstPath);
+  
+    return retval;
 }
 
 
-void hdfsFreeHosts(char ***blockHosts)
-{
-    int i, j;
-    for (i=0; blockHosts[i]; i++) {
-        for (j=0; blockHosts[i][j]; j++) {
-            free(blockHosts[i][j]);
-        }
-        free(blockHosts[i]);
-    }
-    free(blockHosts);
-}
-
 
-tOffset hdfsGetDefaultBlockSize(hdfsFS fs)
+int hdfsDelete(hdfsFS fs, const char* path, int recursive)
 {
     // JAVA EQUIVALENT:
-    //  fs.getDefaultBlockSize();
+    //  File f = new File(path);
+    //  bool retval = fs.delete(f);
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1673,28 +2772,38 @@ tOffset hdfsGetDefaultBlockSize(hdfsFS fs)
 
     jobject jFS = (jobject)fs;
 
-    //FileSystem::getDefaultBlockSize()
-    tOffset blockSize = -1;
+    //Create an object of java.io.File
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+        return -1;
+    }
+
+    //Delete the file
     jvalue jVal;
     jthrowable jExc = NULL;
+    jboolean jRecursive = recursive;
     if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "getDefaultBlockSize", "()J") != 0) {
+                     "delete", "(Lorg/apache/hadoop/fs/Path;Z)Z",
+                     jPath, jRecursive) != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::getDefaultBlockSize");
+                                   "FileSystem::delete");
         return -1;
     }
-    blockSize = jVal.j;
-
-    return blockSize;
-}
 
+    //Delete unnecessary local references
+    destroyLocalReference(env, jPath);
+
+    return (jVal.z) ? 0 : -1;
+}
 
 
-tOffset hdfsGetCapacity(hdfsFS fs)
+
+int hdfsRename(hdfsFS fs, const char* oldPath, const char* newPath)
 {
     // JAVA EQUIVALENT:
-    //  FsStatus fss = fs.getStatus();
-    //  return Fss.getCapacity();
+    //  Path old = new Path(oldPath);
+    //  Path new = new Path(newPath);
+    //  fs.rename(old, new);
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1705,250 +2814,1528 @@ tOffset hdfsGetCapacity(hdfsFS fs)
 
     jobject jFS = (jobject)fs;
 
-    //FileSystem::getStatus
-    jvalue  jVal;
-    jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "getStatus", "()Lorg/apache/hadoop/fs/FsStatus;") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::getStatus");
+    //Create objects of org.apache.hadoop.fs.Path
+    jobject jOldPath = NULL;
+    jobject jNewPath = NULL;
+
+    jOldPath = constructNewObjectOfPath(env, oldPath);
+    if (jOldPath == NULL) {
         return -1;
     }
-    jobject fss = (jobject)jVal.l;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, fss, HADOOP_FSSTATUS,
-                     "getCapacity", "()J") != 0) {
+
+    jNewPath = constructNewObjectOfPath(env, newPath);
+    if (jNewPath == NULL) {
+        destroyLocalReference(env, jOldPath);
+        return -1;
+    }
+
+    //Rename the file
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS, "rename",
+                     JMETHOD2(JPARAM(HADOOP_PATH), JPARAM(HADOOP_PATH), "Z"),
+                     jOldPath, jNewPath) != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FsStatus::getCapacity");
+                                   "FileSystem::rename");
         return -1;
     }
-    return jVal.j;
+
+    //Delete unnecessary local references
+    destroyLocalReference(env, jOldPath);
+    destroyLocalReference(env, jNewPath);
+
+    return (jVal.z) ? 0 : -1;
 }
 
 
-  
-tOffset hdfsGetUsed(hdfsFS fs)
+
+char* hdfsGetWorkingDirectory(hdfsFS fs, char* buffer, size_t bufferSize)
 {
     // JAVA EQUIVALENT:
-    //  FsStatus fss = fs.getStatus();
-    //  return Fss.getUsed();
+    //  Path p = fs.getWorkingDirectory(); 
+    //  return p.toString()
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
     if (env == NULL) {
       errno = EINTERNAL;
-      return -1;
+      return NULL;
     }
 
     jobject jFS = (jobject)fs;
+    jobject jPath = NULL;
+    jvalue jVal;
+    jthrowable jExc = NULL;
 
-    //FileSystem::getStatus
-    jvalue  jVal;
+    //FileSystem::getWorkingDirectory()
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS,
+                     HADOOP_FS, "getWorkingDirectory",
+                     "()Lorg/apache/hadoop/fs/Path;") != 0 ||
+        jVal.l == NULL) {
+        errno = errnoFromException(jExc, env, "FileSystem::"
+                                   "getWorkingDirectory");
+        return NULL;
+    }
+    jPath = jVal.l;
+
+    //Path::toString()
+    jstring jPathString;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jPath, 
+                     "org/apache/hadoop/fs/Path", "toString",
+                     "()Ljava/lang/String;") != 0) { 
+        errno = errnoFromException(jExc, env, "Path::toString");
+        destroyLocalReference(env, jPath);
+        return NULL;
+    }
+    jPathString = jVal.l;
+
+    const char *jPathChars = (const char*)
+        ((*env)->GetStringUTFChars(env, jPathString, NULL));
+
+    //Copy to user-provided buffer
+    strncpy(buffer, jPathChars, bufferSize);
+
+    //Delete unnecessary local references
+    (*env)->ReleaseStringUTFChars(env, jPathString, jPathChars);
+
+    destroyLocalReference(env, jPathString);
+    destroyLocalReference(env, jPath);
+
+    return buffer;
+}
+
+
+
+int hdfsSetWorkingDirectory(hdfsFS fs, const char* path)
+{
+    // JAVA EQUIVALENT:
+    //  fs.setWorkingDirectory(Path(path)); 
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+    int retval = 0;
     jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "getStatus", "()Lorg/apache/hadoop/fs/FsStatus;") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::getStatus");
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
         return -1;
     }
-    jobject fss = (jobject)jVal.l;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, fss, HADOOP_FSSTATUS,
-                     "getUsed", "()J") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FsStatus::getUsed");
-        return -1;
+
+    //FileSystem::setWorkingDirectory()
+    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "setWorkingDirectory", 
+                     "(Lorg/apache/hadoop/fs/Path;)V", jPath) != 0) {
+        errno = errnoFromException(jExc, env, "FileSystem::"
+                                   "setWorkingDirectory");
+        retval = -1;
     }
-    return jVal.j;
 
+    //Delete unnecessary local references
+    destroyLocalReference(env, jPath);
+
+    return retval;
 }
 
 
- 
-static int
-getFileInfoFromStat(JNIEnv *env, jobject jStat, hdfsFileInfo *fileInfo)
+
+int hdfsCreateDirectory(hdfsFS fs, const char* path)
 {
+    // JAVA EQUIVALENT:
+    //  fs.mkdirs(new Path(path));
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+        return -1;
+    }
+
+    //Create the directory
     jvalue jVal;
+    jVal.z = 0;
     jthrowable jExc = NULL;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
-                     HADOOP_STAT, "isDir", "()Z") != 0) {
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "mkdirs", "(Lorg/apache/hadoop/fs/Path;)Z",
+                     jPath) != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileStatus::isDir");
-        return -1;
+                                   "FileSystem::mkdirs");
+        goto done;
     }
-    fileInfo->mKind = jVal.z ? kObjectKindDirectory : kObjectKindFile;
 
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
-                     HADOOP_STAT, "getReplication", "()S") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileStatus::getReplication");
-        return -1;
+ done:
+
+    //Delete unnecessary local references
+    destroyLocalReference(env, jPath);
+
+    return (jVal.z) ? 0 : -1;
+}
+
+
+int hdfsSetReplication(hdfsFS fs, const char* path, int16_t replication)
+{
+    // JAVA EQUIVALENT:
+    //  fs.setReplication(new Path(path), replication);
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
     }
-    fileInfo->mReplication = jVal.s;
 
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
-                     HADOOP_STAT, "getBlockSize", "()J") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileStatus::getBlockSize");
+    jobject jFS = (jobject)fs;
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
         return -1;
     }
-    fileInfo->mBlockSize = jVal.j;
 
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
-                     HADOOP_STAT, "getModificationTime", "()J") != 0) {
+    //Create the directory
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "setReplication", "(Lorg/apache/hadoop/fs/Path;S)Z",
+                     jPath, replication) != 0) {
         errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileStatus::getModificationTime");
-        return -1;
+                                   "FileSystem::setReplication");
+        goto done;
     }
-    fileInfo->mLastMod = (tTime) (jVal.j / 1000);
 
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
-                     HADOOP_STAT, "getAccessTime", "()J") != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileStatus::getAccessTime");
-        return -1;
+ done:
+
+    //Delete unnecessary local references
+    destroyLocalReference(env, jPath);
+
+    return (jVal.z) ? 0 : -1;
+}
+
+int hdfsChown(hdfsFS fs, const char* path, const char *owner, const char *group)
+{
+    // JAVA EQUIVALENT:
+    //  fs.setOwner(path, owner, group)
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
     }
-    fileInfo->mLastAccess = (tTime) (jVal.j / 1000);
 
+    if (owner == NULL && group == NULL) {
+      fprintf(stderr, "Both owner and group cannot be null in chown");
+      errno = EINVAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+        return -1;
+    }
+
+    jstring jOwnerString = (*env)->NewStringUTF(env, owner); 
+    jstring jGroupString = (*env)->NewStringUTF(env, group); 
+
+    //Create the directory
+    int ret = 0;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "setOwner", JMETHOD3(JPARAM(HADOOP_PATH), JPARAM(JAVA_STRING), JPARAM(JAVA_STRING), JAVA_VOID),
+                     jPath, jOwnerString, jGroupString) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::setOwner");
+        ret = -1;
+        goto done;
+    }
+
+ done:
+    destroyLocalReference(env, jPath);
+    destroyLocalReference(env, jOwnerString);
+    destroyLocalReference(env, jGroupString);
+
+    return ret;
+}
+
+int hdfsChmod(hdfsFS fs, const char* path, short mode)
+{
+    // JAVA EQUIVALENT:
+    //  fs.setPermission(path, FsPermission)
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    // construct jPerm = FsPermission.createImmutable(short mode);
+
+    jshort jmode = mode;
+
+    jobject jPermObj =
+      constructNewObjectOfClass(env, NULL, HADOOP_FSPERM,"(S)V",jmode);
+    if (jPermObj == NULL) {
+      return -2;
+    }
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+      return -3;
+    }
+
+    //Create the directory
+    int ret = 0;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "setPermission", JMETHOD2(JPARAM(HADOOP_PATH), JPARAM(HADOOP_FSPERM), JAVA_VOID),
+                     jPath, jPermObj) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::setPermission");
+        ret = -1;
+        goto done;
+    }
+
+ done:
+    destroyLocalReference(env, jPath);
+    destroyLocalReference(env, jPermObj);
+
+    return ret;
+}
+
+int hdfsUtime(hdfsFS fs, const char* path, tTime mtime, tTime atime)
+{
+    // JAVA EQUIVALENT:
+    //  fs.setTimes(src, mtime, atime)
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+      fprintf(stderr, "could not construct path object\n");
+      return -2;
+    }
+
+    jlong jmtime = mtime * (jlong)1000;
+    jlong jatime = atime * (jlong)1000;
+
+    int ret = 0;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, NULL, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "setTimes", JMETHOD3(JPARAM(HADOOP_PATH), "J", "J", JAVA_VOID),
+                     jPath, jmtime, jatime) != 0) {
+      fprintf(stderr, "call to setTime failed\n");
+      errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                 "FileSystem::setTimes");
+      ret = -1;
+      goto done;
+    }
+
+ done:
+    destroyLocalReference(env, jPath);
+    return ret;
+}
+
+
+
+
+/**
+ * One cached getFileBlockLocations answer. Entries are keyed by
+ * (fs, path, start, length) and served as deep copies until they are
+ * older than hostCacheTTLSeconds, so schedulers asking about the same
+ * hot files over and over stop hammering the NameNode. The cache is
+ * off by default (TTL 0); callers opt in with hdfsSetHostCacheTTL.
+ */
+struct hostCacheEntry {
+    hdfsFS fs;
+    char *path;
+    tOffset start;
+    tOffset length;
+    char ***hosts;
+    time_t fetched;
+    struct hostCacheEntry *next;
+};
+
+static struct hostCacheEntry *hostCache = NULL;
+static pthread_mutex_t hostCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static int hostCacheTTLSeconds = 0;
+
+//deep-copy a NULL-terminated blocks-hosts array; freed with hdfsFreeHosts
+static char*** hostsCopy(char ***hosts)
+{
+    int numBlocks = 0;
+    int i, j;
+    while (hosts[numBlocks] != NULL) {
+        numBlocks++;
+    }
+
+    char ***copy = calloc(numBlocks + 1, sizeof(char**));
+    if (copy == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    for (i = 0; i < numBlocks; ++i) {
+        int numHosts = 0;
+        while (hosts[i][numHosts] != NULL) {
+            numHosts++;
+        }
+        copy[i] = calloc(numHosts + 1, sizeof(char*));
+        if (copy[i] == NULL) {
+            hdfsFreeHosts(copy);
+            errno = ENOMEM;
+            return NULL;
+        }
+        for (j = 0; j < numHosts; ++j) {
+            copy[i][j] = strdup(hosts[i][j]);
+            if (copy[i][j] == NULL) {
+                hdfsFreeHosts(copy);
+                errno = ENOMEM;
+                return NULL;
+            }
+        }
+    }
+    return copy;
+}
+
+//look up a range, expiring stale entries along the way; returns a
+//copy the caller owns or NULL. Called with hostCacheMutex held.
+static char*** hostCacheLookup(hdfsFS fs, const char* path,
+                               tOffset start, tOffset length)
+{
+    time_t now = time(NULL);
+    struct hostCacheEntry **link = &hostCache;
+    char ***hosts = NULL;
+
+    while (*link != NULL) {
+        struct hostCacheEntry *e = *link;
+        if (now - e->fetched >= hostCacheTTLSeconds) {
+            *link = e->next;
+            hdfsFreeHosts(e->hosts);
+            free(e->path);
+            free(e);
+            continue;
+        }
+        if (hosts == NULL && e->fs == fs && e->start == start &&
+                e->length == length && strcmp(e->path, path) == 0) {
+            hosts = hostsCopy(e->hosts);
+        }
+        link = &e->next;
+    }
+    return hosts;
+}
+
+//remember an answer; allocation failure just means it goes uncached.
+//Called with hostCacheMutex held.
+static void hostCacheStore(hdfsFS fs, const char* path,
+                           tOffset start, tOffset length, char ***hosts)
+{
+    struct hostCacheEntry *e = calloc(1, sizeof(struct hostCacheEntry));
+    if (e == NULL) {
+        return;
+    }
+    e->path = strdup(path);
+    e->hosts = hostsCopy(hosts);
+    if (e->path == NULL || e->hosts == NULL) {
+        if (e->hosts != NULL) {
+            hdfsFreeHosts(e->hosts);
+        }
+        free(e->path);
+        free(e);
+        return;
+    }
+    e->fs = fs;
+    e->start = start;
+    e->length = length;
+    e->fetched = time(NULL);
+    e->next = hostCache;
+    hostCache = e;
+}
+
+//drop entries for one path, or every entry when path is NULL.
+//Called with hostCacheMutex held.
+static void hostCachePurge(const char* path)
+{
+    struct hostCacheEntry **link = &hostCache;
+    while (*link != NULL) {
+        struct hostCacheEntry *e = *link;
+        if (path == NULL || strcmp(e->path, path) == 0) {
+            *link = e->next;
+            hdfsFreeHosts(e->hosts);
+            free(e->path);
+            free(e);
+        }
+        else {
+            link = &e->next;
+        }
+    }
+}
+
+void hdfsSetHostCacheTTL(int ttlSeconds)
+{
+    pthread_mutex_lock(&hostCacheMutex);
+    hostCacheTTLSeconds = (ttlSeconds > 0) ? ttlSeconds : 0;
+    if (hostCacheTTLSeconds == 0) {
+        hostCachePurge(NULL);
+    }
+    pthread_mutex_unlock(&hostCacheMutex);
+}
+
+void hdfsHostCacheInvalidate(const char* path)
+{
+    pthread_mutex_lock(&hostCacheMutex);
+    hostCachePurge(path);
+    pthread_mutex_unlock(&hostCacheMutex);
+}
+
+//fetch and parse the block locations for one range of an already
+//resolved FileStatus
+static char***
+getHostsFromStatus(JNIEnv *env, jobject jFS, jobject jFileStatus,
+                   tOffset start, tOffset length)
+{
+    //org.apache.hadoop.fs.FileSystem::getFileBlockLocations
+    char*** blockHosts = NULL;
+    jobjectArray jBlockLocations;
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS,
+                     HADOOP_FS, "getFileBlockLocations",
+                     "(Lorg/apache/hadoop/fs/FileStatus;JJ)"
+                     "[Lorg/apache/hadoop/fs/BlockLocation;",
+                     jFileStatus, start, length) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::getFileBlockLocations");
+        return NULL;
+    }
+    jBlockLocations = jVal.l;
+
+    //Figure out no of entries in jBlockLocations
+    //Allocate memory and add NULL at the end
+    jsize jNumFileBlocks = (*env)->GetArrayLength(env, jBlockLocations);
+
+    blockHosts = calloc(jNumFileBlocks+1, sizeof(char**));
+    if (blockHosts == NULL) {
+        errno = ENOMEM;
+        goto done;
+    }
+    if (jNumFileBlocks == 0) {
+        errno = 0;
+        goto done;
+    }
+
+    //Now parse each block to get hostnames
+    int i = 0;
+    for (i=0; i < jNumFileBlocks; ++i) {
+        jobject jFileBlock =
+            (*env)->GetObjectArrayElement(env, jBlockLocations, i);
+
+        jvalue jVal;
+        jobjectArray jFileBlockHosts;
+        if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFileBlock, HADOOP_BLK_LOC,
+                         "getHosts", "()[Ljava/lang/String;") ||
+                jVal.l == NULL) {
+            errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                       "BlockLocation::getHosts");
+            destroyLocalReference(env, jFileBlock);
+            hdfsFreeHosts(blockHosts);
+            blockHosts = NULL;
+            goto done;
+        }
+
+        jFileBlockHosts = jVal.l;
+        //Figure out no of hosts in jFileBlockHosts
+        //Allocate memory and add NULL at the end
+        jsize jNumBlockHosts = (*env)->GetArrayLength(env, jFileBlockHosts);
+        blockHosts[i] = calloc(jNumBlockHosts+1, sizeof(char*));
+        if (blockHosts[i] == NULL) {
+            destroyLocalReference(env, jFileBlockHosts);
+            destroyLocalReference(env, jFileBlock);
+            hdfsFreeHosts(blockHosts);
+            blockHosts = NULL;
+            errno = ENOMEM;
+            goto done;
+        }
+
+        //Now parse each hostname
+        int j = 0;
+        const char *hostName;
+        for (j=0; j < jNumBlockHosts; ++j) {
+            jstring jHost =
+                (*env)->GetObjectArrayElement(env, jFileBlockHosts, j);
+
+            hostName =
+                (const char*)((*env)->GetStringUTFChars(env, jHost, NULL));
+            blockHosts[i][j] = strdup(hostName);
+
+            (*env)->ReleaseStringUTFChars(env, jHost, hostName);
+            destroyLocalReference(env, jHost);
+        }
+
+        destroyLocalReference(env, jFileBlockHosts);
+        destroyLocalReference(env, jFileBlock);
+    }
+
+    done:
+
+    //Delete unnecessary local references
+    destroyLocalReference(env, jBlockLocations);
+
+    return blockHosts;
+}
+
+char***
+hdfsGetHosts(hdfsFS fs, const char* path, tOffset start, tOffset length)
+{
+    // JAVA EQUIVALENT:
+    //  fs.getFileBlockLoctions(new Path(path), start, length);
+
+    char*** blockHosts = NULL;
+
+    if (hostCacheTTLSeconds > 0) {
+        pthread_mutex_lock(&hostCacheMutex);
+        blockHosts = hostCacheLookup(fs, path, start, length);
+        pthread_mutex_unlock(&hostCacheMutex);
+        if (blockHosts != NULL) {
+            return blockHosts;
+        }
+    }
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return NULL;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+        return NULL;
+    }
+
+    jvalue jFSVal;
+    jthrowable jFSExc = NULL;
+    if (invokeMethod(env, &jFSVal, &jFSExc, INSTANCE, jFS,
+                     HADOOP_FS, "getFileStatus",
+                     "(Lorg/apache/hadoop/fs/Path;)"
+                     "Lorg/apache/hadoop/fs/FileStatus;",
+                     jPath) != 0) {
+        errno = errnoFromException(jFSExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::getFileStatus");
+        destroyLocalReference(env, jPath);
+        return NULL;
+    }
+    jobject jFileStatus = jFSVal.l;
+
+    blockHosts = getHostsFromStatus(env, jFS, jFileStatus, start, length);
+
+    //Delete unnecessary local references
+    destroyLocalReference(env, jPath);
+    destroyLocalReference(env, jFileStatus);
+
+    if (blockHosts != NULL && hostCacheTTLSeconds > 0) {
+        pthread_mutex_lock(&hostCacheMutex);
+        hostCacheStore(fs, path, start, length, blockHosts);
+        pthread_mutex_unlock(&hostCacheMutex);
+    }
+
+    return blockHosts;
+}
+
+
+char**** hdfsGetHostsBatch(hdfsFS fs, const char* path,
+                           const tOffset* starts, const tOffset* lengths,
+                           int numRanges)
+{
+    char ****results;
+    int i;
+    int missing = 0;
+
+    if (numRanges < 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    results = calloc(numRanges, sizeof(char***));
+    if (results == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    //Serve whatever the cache can answer first
+    if (hostCacheTTLSeconds > 0) {
+        pthread_mutex_lock(&hostCacheMutex);
+        for (i = 0; i < numRanges; ++i) {
+            results[i] = hostCacheLookup(fs, path, starts[i], lengths[i]);
+        }
+        pthread_mutex_unlock(&hostCacheMutex);
+    }
+    for (i = 0; i < numRanges; ++i) {
+        if (results[i] == NULL) {
+            missing++;
+        }
+    }
+    if (missing == 0) {
+        return results;
+    }
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      hdfsFreeHostsBatch(results, numRanges);
+      errno = EINTERNAL;
+      return NULL;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+        hdfsFreeHostsBatch(results, numRanges);
+        return NULL;
+    }
+
+    //Resolve the FileStatus once for every missing range
+    jvalue jFSVal;
+    jthrowable jFSExc = NULL;
+    if (invokeMethod(env, &jFSVal, &jFSExc, INSTANCE, jFS,
+                     HADOOP_FS, "getFileStatus",
+                     "(Lorg/apache/hadoop/fs/Path;)"
+                     "Lorg/apache/hadoop/fs/FileStatus;",
+                     jPath) != 0) {
+        errno = errnoFromException(jFSExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::getFileStatus");
+        destroyLocalReference(env, jPath);
+        hdfsFreeHostsBatch(results, numRanges);
+        return NULL;
+    }
+    jobject jFileStatus = jFSVal.l;
+
+    for (i = 0; i < numRanges; ++i) {
+        if (results[i] != NULL) {
+            continue;
+        }
+        results[i] = getHostsFromStatus(env, jFS, jFileStatus,
+                                        starts[i], lengths[i]);
+        if (results[i] == NULL) {
+            destroyLocalReference(env, jPath);
+            destroyLocalReference(env, jFileStatus);
+            hdfsFreeHostsBatch(results, numRanges);
+            return NULL;
+        }
+        if (hostCacheTTLSeconds > 0) {
+            pthread_mutex_lock(&hostCacheMutex);
+            hostCacheStore(fs, path, starts[i], lengths[i], results[i]);
+            pthread_mutex_unlock(&hostCacheMutex);
+        }
+    }
+
+    //Delete unnecessary local references
+    destroyLocalReference(env, jPath);
+    destroyLocalReference(env, jFileStatus);
+
+    return results;
+}
+
+
+void hdfsFreeHostsBatch(char ****blockHostsBatch, int numRanges)
+{
+    int i;
+    for (i = 0; i < numRanges; ++i) {
+        if (blockHostsBatch[i]) {
+            hdfsFreeHosts(blockHostsBatch[i]);
+        }
+    }
+    free(blockHostsBatch);
+}
+
+
+void hdfsFreeHosts(char ***blockHosts)
+{
+    int i, j;
+    for (i=0; blockHosts[i]; i++) {
+        for (j=0; blockHosts[i][j]; j++) {
+            free(blockHosts[i][j]);
+        }
+        free(blockHosts[i]);
+    }
+    free(blockHosts);
+}
+
+
+tOffset hdfsGetDefaultBlockSize(hdfsFS fs)
+{
+    // JAVA EQUIVALENT:
+    //  fs.getDefaultBlockSize();
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //FileSystem::getDefaultBlockSize()
+    tOffset blockSize = -1;
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "getDefaultBlockSize", "()J") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::getDefaultBlockSize");
+        return -1;
+    }
+    blockSize = jVal.j;
+
+    return blockSize;
+}
+
+
+
+tOffset hdfsGetCapacity(hdfsFS fs)
+{
+    // JAVA EQUIVALENT:
+    //  FsStatus fss = fs.getStatus();
+    //  return Fss.getCapacity();
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //FileSystem::getStatus
+    jvalue  jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "getStatus", "()Lorg/apache/hadoop/fs/FsStatus;") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::getStatus");
+        return -1;
+    }
+    jobject fss = (jobject)jVal.l;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, fss, HADOOP_FSSTATUS,
+                     "getCapacity", "()J") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FsStatus::getCapacity");
+        return -1;
+    }
+    return jVal.j;
+}
+
+
+  
+tOffset hdfsGetUsed(hdfsFS fs)
+{
+    // JAVA EQUIVALENT:
+    //  FsStatus fss = fs.getStatus();
+    //  return Fss.getUsed();
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //FileSystem::getStatus
+    jvalue  jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "getStatus", "()Lorg/apache/hadoop/fs/FsStatus;") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::getStatus");
+        return -1;
+    }
+    jobject fss = (jobject)jVal.l;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, fss, HADOOP_FSSTATUS,
+                     "getUsed", "()J") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FsStatus::getUsed");
+        return -1;
+    }
+    return jVal.j;
+
+}
+
+
+ 
+static int
+getFileInfoFromStat(JNIEnv *env, jobject jStat, hdfsFileInfo *fileInfo)
+{
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
+                     HADOOP_STAT, "isDir", "()Z") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileStatus::isDir");
+        return -1;
+    }
+    fileInfo->mKind = jVal.z ? kObjectKindDirectory : kObjectKindFile;
+
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
+                     HADOOP_STAT, "getReplication", "()S") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileStatus::getReplication");
+        return -1;
+    }
+    fileInfo->mReplication = jVal.s;
+
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
+                     HADOOP_STAT, "getBlockSize", "()J") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileStatus::getBlockSize");
+        return -1;
+    }
+    fileInfo->mBlockSize = jVal.j;
+
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
+                     HADOOP_STAT, "getModificationTime", "()J") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileStatus::getModificationTime");
+        return -1;
+    }
+    fileInfo->mLastMod = (tTime) (jVal.j / 1000);
+
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
+                     HADOOP_STAT, "getAccessTime", "()J") != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileStatus::getAccessTime");
+        return -1;
+    }
+    fileInfo->mLastAccess = (tTime) (jVal.j / 1000);
+
+
+    if (fileInfo->mKind == kObjectKindFile) {
+        if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
+                         HADOOP_STAT, "getLen", "()J") != 0) {
+            errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                       "FileStatus::getLen");
+            return -1;
+        }
+        fileInfo->mSize = jVal.j;
+    }
+
+    jobject jPath;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
+                     "getPath", "()Lorg/apache/hadoop/fs/Path;") ||
+            jVal.l == NULL) { 
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "Path::getPath");
+        return -1;
+    }
+    jPath = jVal.l;
+
+    jstring     jPathName;
+    const char *cPathName;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jPath, HADOOP_PATH,
+                     "toString", "()Ljava/lang/String;")) { 
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "Path::toString");
+        destroyLocalReference(env, jPath);
+        return -1;
+    }
+    jPathName = jVal.l;
+    cPathName = (const char*) ((*env)->GetStringUTFChars(env, jPathName, NULL));
+    fileInfo->mName = strdup(cPathName);
+    (*env)->ReleaseStringUTFChars(env, jPathName, cPathName);
+    destroyLocalReference(env, jPath);
+    destroyLocalReference(env, jPathName);
+    jstring     jUserName;
+    const char* cUserName;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
+                    "getOwner", "()Ljava/lang/String;")) {
+        fprintf(stderr, "Call to org.apache.hadoop.fs."
+                "FileStatus::getOwner failed!\n");
+        errno = EINTERNAL;
+        return -1;
+    }
+    jUserName = jVal.l;
+    cUserName = (const char*) ((*env)->GetStringUTFChars(env, jUserName, NULL));
+    fileInfo->mOwner = strdup(cUserName);
+    (*env)->ReleaseStringUTFChars(env, jUserName, cUserName);
+    destroyLocalReference(env, jUserName);
+
+    jstring     jGroupName;
+    const char* cGroupName;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
+                    "getGroup", "()Ljava/lang/String;")) {
+        fprintf(stderr, "Call to org.apache.hadoop.fs."
+                "FileStatus::getGroup failed!\n");
+        errno = EINTERNAL;
+        return -1;
+    }
+    jGroupName = jVal.l;
+    cGroupName = (const char*) ((*env)->GetStringUTFChars(env, jGroupName, NULL));
+    fileInfo->mGroup = strdup(cGroupName);
+    (*env)->ReleaseStringUTFChars(env, jGroupName, cGroupName);
+    destroyLocalReference(env, jGroupName);
+
+    jobject jPermission;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
+                     "getPermission", "()Lorg/apache/hadoop/fs/permission/FsPermission;") ||
+            jVal.l == NULL) {
+        fprintf(stderr, "Call to org.apache.hadoop.fs."
+                "FileStatus::getPermission failed!\n");
+        errno = EINTERNAL;
+        return -1;
+    }
+    jPermission = jVal.l;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jPermission, HADOOP_FSPERM,
+                         "toShort", "()S") != 0) {
+            fprintf(stderr, "Call to org.apache.hadoop.fs.permission."
+                    "FsPermission::toShort failed!\n");
+            errno = EINTERNAL;
+            return -1;
+    }
+    fileInfo->mPermissions = jVal.s;
+    destroyLocalReference(env, jPermission);
+
+    return 0;
+}
+
+static int
+getFileInfo(JNIEnv *env, jobject jFS, jobject jPath, hdfsFileInfo *fileInfo)
+{
+    // JAVA EQUIVALENT:
+    //  fs.isDirectory(f)
+    //  fs.getModificationTime()
+    //  fs.getAccessTime()
+    //  fs.getLength(f)
+    //  f.getPath()
+    //  f.getOwner()
+    //  f.getGroup()
+    //  f.getPermission().toShort()
+
+    jobject jStat;
+    jvalue  jVal;
+    jthrowable jExc = NULL;
+
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "exists", JMETHOD1(JPARAM(HADOOP_PATH), "Z"),
+                     jPath) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::exists");
+        return -1;
+    }
+
+    if (jVal.z == 0) {
+      errno = ENOENT;
+      return -1;
+    }
+
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                     "getFileStatus", JMETHOD1(JPARAM(HADOOP_PATH), JPARAM(HADOOP_STAT)),
+                     jPath) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::getFileStatus");
+        return -1;
+    }
+    jStat = jVal.l;
+    int ret =  getFileInfoFromStat(env, jStat, fileInfo); 
+    destroyLocalReference(env, jStat);
+    return ret;
+}
+
+
+
+hdfsFileInfo* hdfsListDirectory(hdfsFS fs, const char* path, int *numEntries)
+{
+    // JAVA EQUIVALENT:
+    //  Path p(path);
+    //  Path []pathList = fs.listPaths(p)
+    //  foreach path in pathList 
+    //    getFileInfo(path)
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return NULL;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+        return NULL;
+    }
+
+    hdfsFileInfo *pathList = 0; 
+
+    jobjectArray jPathList = NULL;
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_DFS, "listStatus",
+                     JMETHOD1(JPARAM(HADOOP_PATH), JARRPARAM(HADOOP_STAT)),
+                     jPath) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::listStatus");
+        destroyLocalReference(env, jPath);
+        return NULL;
+    }
+    jPathList = jVal.l;
+
+    //Figure out no of entries in that directory
+    jsize jPathListSize = (*env)->GetArrayLength(env, jPathList);
+    *numEntries = jPathListSize;
+    if (jPathListSize == 0) {
+        errno = 0;
+        goto done;
+    }
+
+    //Allocate memory
+    pathList = calloc(jPathListSize, sizeof(hdfsFileInfo));
+    if (pathList == NULL) {
+        errno = ENOMEM;
+        goto done;
+    }
+
+    //Save path information in pathList
+    jsize i;
+    jobject tmpStat;
+    for (i=0; i < jPathListSize; ++i) {
+        tmpStat = (*env)->GetObjectArrayElement(env, jPathList, i);
+        if (getFileInfoFromStat(env, tmpStat, &pathList[i])) {
+            hdfsFreeFileInfo(pathList, jPathListSize);
+            destroyLocalReference(env, tmpStat);
+            pathList = NULL;
+            goto done;
+        }
+        destroyLocalReference(env, tmpStat);
+    }
+
+    done:
+
+    //Delete unnecessary local references
+    destroyLocalReference(env, jPath);
+    destroyLocalReference(env, jPathList);
+
+    return pathList;
+}
+
+
+
+/**
+ * Growable byte arena the bulk listing packs its strings into. All
+ * appends return offsets rather than pointers because the arena may
+ * move while it grows; callers fix up pointers once it is final.
+ */
+struct stringArena {
+    char *data;
+    size_t used;
+    size_t cap;
+};
+
+static size_t arenaAppend(struct stringArena *a, const char *s)
+{
+    size_t len = strlen(s) + 1;
+    if (a->used + len > a->cap) {
+        size_t newCap = (a->cap == 0) ? 4096 : a->cap * 2;
+        while (newCap < a->used + len) {
+            newCap *= 2;
+        }
+        char *grown = realloc(a->data, newCap);
+        if (grown == NULL) {
+            return (size_t)-1;
+        }
+        a->data = grown;
+        a->cap = newCap;
+    }
+    memcpy(a->data + a->used, s, len);
+    a->used += len;
+    return a->used - len;
+}
+
+hdfsBulkFileInfo *hdfsListDirectoryBulk(hdfsFS fs, const char* path)
+{
+    // JAVA EQUIVALENT:
+    //  FileStatus[] statuses = fs.listStatus(new Path(path));
+    //  (all entries packed into two allocations)
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return NULL;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    //Create an object of org.apache.hadoop.fs.Path
+    jobject jPath = constructNewObjectOfPath(env, path);
+    if (jPath == NULL) {
+        return NULL;
+    }
+
+    jvalue jVal;
+    jthrowable jExc = NULL;
+    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_DFS, "listStatus",
+                     JMETHOD1(JPARAM(HADOOP_PATH), JARRPARAM(HADOOP_STAT)),
+                     jPath) != 0) {
+        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                   "FileSystem::listStatus");
+        destroyLocalReference(env, jPath);
+        return NULL;
+    }
+    jobjectArray jPathList = jVal.l;
+    destroyLocalReference(env, jPath);
+
+    jsize jPathListSize = (*env)->GetArrayLength(env, jPathList);
+
+    hdfsBulkFileInfo *bulk = calloc(1, sizeof(hdfsBulkFileInfo));
+    if (bulk == NULL) {
+        destroyLocalReference(env, jPathList);
+        errno = ENOMEM;
+        return NULL;
+    }
+    bulk->numEntries = jPathListSize;
+    if (jPathListSize == 0) {
+        destroyLocalReference(env, jPathList);
+        errno = 0;
+        return bulk;
+    }
+
+    bulk->entries = calloc(jPathListSize, sizeof(hdfsFileInfo));
+    if (bulk->entries == NULL) {
+        destroyLocalReference(env, jPathList);
+        free(bulk);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    struct stringArena arena = { NULL, 0, 0 };
+    //most entries of one directory share an owner and group; remember
+    //the previous ones so repeats reuse the same arena bytes
+    size_t prevOwnerOff = (size_t)-1;
+    size_t prevGroupOff = (size_t)-1;
+
+    jsize i;
+    jobject tmpStat;
+    for (i = 0; i < jPathListSize; ++i) {
+        hdfsFileInfo tmpInfo;
+        memset(&tmpInfo, 0, sizeof(tmpInfo));
+
+        tmpStat = (*env)->GetObjectArrayElement(env, jPathList, i);
+        if (getFileInfoFromStat(env, tmpStat, &tmpInfo)) {
+            destroyLocalReference(env, tmpStat);
+            goto fail;
+        }
+        destroyLocalReference(env, tmpStat);
+
+        bulk->entries[i] = tmpInfo;
+
+        size_t nameOff = arenaAppend(&arena, tmpInfo.mName);
+        size_t ownerOff = (prevOwnerOff != (size_t)-1 &&
+                strcmp(arena.data + prevOwnerOff, tmpInfo.mOwner) == 0) ?
+            prevOwnerOff : arenaAppend(&arena, tmpInfo.mOwner);
+        size_t groupOff = (prevGroupOff != (size_t)-1 &&
+                strcmp(arena.data + prevGroupOff, tmpInfo.mGroup) == 0) ?
+            prevGroupOff : arenaAppend(&arena, tmpInfo.mGroup);
+        free(tmpInfo.mName);
+        free(tmpInfo.mOwner);
+        free(tmpInfo.mGroup);
+        if (nameOff == (size_t)-1 || ownerOff == (size_t)-1 ||
+                groupOff == (size_t)-1) {
+            errno = ENOMEM;
+            goto fail;
+        }
+        prevOwnerOff = ownerOff;
+        prevGroupOff = groupOff;
+
+        //store offsets for now; the arena may still move
+        bulk->entries[i].mName = (char*)nameOff;
+        bulk->entries[i].mOwner = (char*)ownerOff;
+        bulk->entries[i].mGroup = (char*)groupOff;
+    }
+    destroyLocalReference(env, jPathList);
+
+    //the arena is final; turn the offsets into pointers
+    for (i = 0; i < jPathListSize; ++i) {
+        bulk->entries[i].mName = arena.data + (size_t)bulk->entries[i].mName;
+        bulk->entries[i].mOwner = arena.data + (size_t)bulk->entries[i].mOwner;
+        bulk->entries[i].mGroup = arena.data + (size_t)bulk->entries[i].mGroup;
+    }
+    bulk->strings = arena.data;
+    return bulk;
+
+    fail:
+    destroyLocalReference(env, jPathList);
+    free(arena.data);
+    free(bulk->entries);
+    free(bulk);
+    return NULL;
+}
+
+void hdfsFreeBulkFileInfo(hdfsBulkFileInfo *bulk)
+{
+    if (bulk == NULL) {
+        return;
+    }
+    free(bulk->strings);
+    free(bulk->entries);
+    free(bulk);
+}
+
+
+
+int hdfsExistsMulti(hdfsFS fs, const char **paths, int numPaths,
+                    int *results)
+{
+    // JAVA EQUIVALENT:
+    //  for (String p : paths) fs.exists(new Path(p));
+
+    int i;
+
+    if (numPaths < 1 || results == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    jobject jFS = (jobject)fs;
+
+    for (i = 0; i < numPaths; ++i) {
+        jobject jPath = constructNewObjectOfPath(env, paths[i]);
+        jvalue jVal;
+        jthrowable jExc = NULL;
 
-    if (fileInfo->mKind == kObjectKindFile) {
-        if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat,
-                         HADOOP_STAT, "getLen", "()J") != 0) {
+        if (jPath == NULL) {
+            return -1;
+        }
+        if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                         "exists", JMETHOD1(JPARAM(HADOOP_PATH), "Z"),
+                         jPath) != 0) {
             errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                       "FileStatus::getLen");
+                                       "FileSystem::exists");
+            destroyLocalReference(env, jPath);
             return -1;
         }
-        fileInfo->mSize = jVal.j;
+        destroyLocalReference(env, jPath);
+        results[i] = jVal.z ? 0 : -1;
     }
 
-    jobject jPath;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
-                     "getPath", "()Lorg/apache/hadoop/fs/Path;") ||
-            jVal.l == NULL) { 
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "Path::getPath");
-        return -1;
-    }
-    jPath = jVal.l;
+    return 0;
+}
 
-    jstring     jPathName;
-    const char *cPathName;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jPath, HADOOP_PATH,
-                     "toString", "()Ljava/lang/String;")) { 
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "Path::toString");
-        destroyLocalReference(env, jPath);
-        return -1;
-    }
-    jPathName = jVal.l;
-    cPathName = (const char*) ((*env)->GetStringUTFChars(env, jPathName, NULL));
-    fileInfo->mName = strdup(cPathName);
-    (*env)->ReleaseStringUTFChars(env, jPathName, cPathName);
-    destroyLocalReference(env, jPath);
-    destroyLocalReference(env, jPathName);
-    jstring     jUserName;
-    const char* cUserName;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
-                    "getOwner", "()Ljava/lang/String;")) {
-        fprintf(stderr, "Call to org.apache.hadoop.fs."
-                "FileStatus::getOwner failed!\n");
-        errno = EINTERNAL;
-        return -1;
+
+
+hdfsBulkFileInfo *hdfsGetPathInfoMulti(hdfsFS fs, const char **paths,
+                                       int numPaths)
+{
+    // JAVA EQUIVALENT:
+    //  for (String p : paths) fs.getFileStatus(new Path(p));
+
+    int i;
+
+    if (numPaths < 1) {
+        errno = EINVAL;
+        return NULL;
     }
-    jUserName = jVal.l;
-    cUserName = (const char*) ((*env)->GetStringUTFChars(env, jUserName, NULL));
-    fileInfo->mOwner = strdup(cUserName);
-    (*env)->ReleaseStringUTFChars(env, jUserName, cUserName);
-    destroyLocalReference(env, jUserName);
 
-    jstring     jGroupName;
-    const char* cGroupName;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
-                    "getGroup", "()Ljava/lang/String;")) {
-        fprintf(stderr, "Call to org.apache.hadoop.fs."
-                "FileStatus::getGroup failed!\n");
-        errno = EINTERNAL;
-        return -1;
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return NULL;
     }
-    jGroupName = jVal.l;
-    cGroupName = (const char*) ((*env)->GetStringUTFChars(env, jGroupName, NULL));
-    fileInfo->mGroup = strdup(cGroupName);
-    (*env)->ReleaseStringUTFChars(env, jGroupName, cGroupName);
-    destroyLocalReference(env, jGroupName);
 
-    jobject jPermission;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jStat, HADOOP_STAT,
-                     "getPermission", "()Lorg/apache/hadoop/fs/permission/FsPermission;") ||
-            jVal.l == NULL) {
-        fprintf(stderr, "Call to org.apache.hadoop.fs."
-                "FileStatus::getPermission failed!\n");
-        errno = EINTERNAL;
-        return -1;
+    jobject jFS = (jobject)fs;
+
+    hdfsBulkFileInfo *bulk = calloc(1, sizeof(hdfsBulkFileInfo));
+    if (bulk == NULL) {
+        errno = ENOMEM;
+        return NULL;
     }
-    jPermission = jVal.l;
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jPermission, HADOOP_FSPERM,
-                         "toShort", "()S") != 0) {
-            fprintf(stderr, "Call to org.apache.hadoop.fs.permission."
-                    "FsPermission::toShort failed!\n");
-            errno = EINTERNAL;
-            return -1;
+    bulk->numEntries = numPaths;
+    bulk->entries = calloc(numPaths, sizeof(hdfsFileInfo));
+    //offsets into the arena while it may still move; (size_t)-1
+    //marks a path that could not be stat'ed, whose entry stays zeroed
+    size_t *offs = malloc(sizeof(size_t) * 3 * numPaths);
+    if (bulk->entries == NULL || offs == NULL) {
+        free(offs);
+        free(bulk->entries);
+        free(bulk);
+        errno = ENOMEM;
+        return NULL;
     }
-    fileInfo->mPermissions = jVal.s;
-    destroyLocalReference(env, jPermission);
 
-    return 0;
+    struct stringArena arena = { NULL, 0, 0 };
+    size_t prevOwnerOff = (size_t)-1;
+    size_t prevGroupOff = (size_t)-1;
+
+    for (i = 0; i < numPaths; ++i) {
+        hdfsFileInfo tmpInfo;
+        memset(&tmpInfo, 0, sizeof(tmpInfo));
+        offs[3*i] = offs[3*i+1] = offs[3*i+2] = (size_t)-1;
+
+        jobject jPath = constructNewObjectOfPath(env, paths[i]);
+        if (jPath == NULL) {
+            goto fail;
+        }
+        if (getFileInfo(env, jFS, jPath, &tmpInfo)) {
+            //leave a zeroed entry for a path that is not there
+            destroyLocalReference(env, jPath);
+            continue;
+        }
+        destroyLocalReference(env, jPath);
+
+        bulk->entries[i] = tmpInfo;
+        offs[3*i] = arenaAppend(&arena, tmpInfo.mName);
+        offs[3*i+1] = (prevOwnerOff != (size_t)-1 &&
+                strcmp(arena.data + prevOwnerOff, tmpInfo.mOwner) == 0) ?
+            prevOwnerOff : arenaAppend(&arena, tmpInfo.mOwner);
+        offs[3*i+2] = (prevGroupOff != (size_t)-1 &&
+                strcmp(arena.data + prevGroupOff, tmpInfo.mGroup) == 0) ?
+            prevGroupOff : arenaAppend(&arena, tmpInfo.mGroup);
+        free(tmpInfo.mName);
+        free(tmpInfo.mOwner);
+        free(tmpInfo.mGroup);
+        bulk->entries[i].mName = NULL;
+        bulk->entries[i].mOwner = NULL;
+        bulk->entries[i].mGroup = NULL;
+        if (offs[3*i] == (size_t)-1 || offs[3*i+1] == (size_t)-1 ||
+                offs[3*i+2] == (size_t)-1) {
+            errno = ENOMEM;
+            goto fail;
+        }
+        prevOwnerOff = offs[3*i+1];
+        prevGroupOff = offs[3*i+2];
+    }
+
+    //the arena is final; turn the offsets into pointers
+    for (i = 0; i < numPaths; ++i) {
+        if (offs[3*i] != (size_t)-1) {
+            bulk->entries[i].mName = arena.data + offs[3*i];
+            bulk->entries[i].mOwner = arena.data + offs[3*i+1];
+            bulk->entries[i].mGroup = arena.data + offs[3*i+2];
+        }
+    }
+    free(offs);
+    bulk->strings = arena.data;
+    errno = 0;
+    return bulk;
+
+    fail:
+    free(offs);
+    free(arena.data);
+    free(bulk->entries);
+    free(bulk);
+    return NULL;
 }
 
-static int
-getFileInfo(JNIEnv *env, jobject jFS, jobject jPath, hdfsFileInfo *fileInfo)
+
+
+int hdfsDeleteMulti(hdfsFS fs, const char **paths, int numPaths,
+                    int recursive, int *results)
 {
     // JAVA EQUIVALENT:
-    //  fs.isDirectory(f)
-    //  fs.getModificationTime()
-    //  fs.getAccessTime()
-    //  fs.getLength(f)
-    //  f.getPath()
-    //  f.getOwner()
-    //  f.getGroup()
-    //  f.getPermission().toShort()
+    //  for (String p : paths) fs.delete(new Path(p), recursive);
 
-    jobject jStat;
-    jvalue  jVal;
-    jthrowable jExc = NULL;
+    int i;
 
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "exists", JMETHOD1(JPARAM(HADOOP_PATH), "Z"),
-                     jPath) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::exists");
+    if (numPaths < 1 || results == NULL) {
+        errno = EINVAL;
         return -1;
     }
 
-    if (jVal.z == 0) {
-      errno = ENOENT;
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
       return -1;
     }
 
-    if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
-                     "getFileStatus", JMETHOD1(JPARAM(HADOOP_PATH), JPARAM(HADOOP_STAT)),
-                     jPath) != 0) {
-        errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
-                                   "FileSystem::getFileStatus");
-        return -1;
+    jobject jFS = (jobject)fs;
+    jboolean jRecursive = recursive;
+
+    for (i = 0; i < numPaths; ++i) {
+        jobject jPath = constructNewObjectOfPath(env, paths[i]);
+        jvalue jVal;
+        jthrowable jExc = NULL;
+
+        if (jPath == NULL) {
+            return -1;
+        }
+        if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_FS,
+                         "delete", "(Lorg/apache/hadoop/fs/Path;Z)Z",
+                         jPath, jRecursive) != 0) {
+            errno = errnoFromException(jExc, env, "org.apache.hadoop.fs."
+                                       "FileSystem::delete");
+            results[i] = -1;
+            destroyLocalReference(env, jPath);
+            continue;
+        }
+        destroyLocalReference(env, jPath);
+        results[i] = (jVal.z) ? 0 : -1;
     }
-    jStat = jVal.l;
-    int ret =  getFileInfoFromStat(env, jStat, fileInfo); 
-    destroyLocalReference(env, jStat);
-    return ret;
+
+    return 0;
 }
 
 
 
-hdfsFileInfo* hdfsListDirectory(hdfsFS fs, const char* path, int *numEntries)
+/**
+ * A directory listing being consumed in pages. The FileStatus[] from
+ * the single listStatus call is pinned with a global reference, and
+ * entries are converted to hdfsFileInfo only as each page is asked
+ * for, so a caller that stops early never pays for the rest.
+ */
+struct hdfsListingInternal {
+    jobject statuses;
+    jsize size;
+    jsize pos;
+};
+
+hdfsListing hdfsOpenListing(hdfsFS fs, const char* path)
 {
     // JAVA EQUIVALENT:
-    //  Path p(path);
-    //  Path []pathList = fs.listPaths(p)
-    //  foreach path in pathList 
-    //    getFileInfo(path)
+    //  FileStatus[] statuses = fs.listStatus(new Path(path));
+    //  (entries converted lazily by hdfsListingNext)
 
     //Get the JNIEnv* corresponding to current thread
     JNIEnv* env = getJNIEnv();
@@ -1965,9 +4352,6 @@ hdfsFileInfo* hdfsListDirectory(hdfsFS fs, const char* path, int *numEntries)
         return NULL;
     }
 
-    hdfsFileInfo *pathList = 0; 
-
-    jobjectArray jPathList = NULL;
     jvalue jVal;
     jthrowable jExc = NULL;
     if (invokeMethod(env, &jVal, &jExc, INSTANCE, jFS, HADOOP_DFS, "listStatus",
@@ -1978,49 +4362,112 @@ hdfsFileInfo* hdfsListDirectory(hdfsFS fs, const char* path, int *numEntries)
         destroyLocalReference(env, jPath);
         return NULL;
     }
-    jPathList = jVal.l;
+    jobjectArray jPathList = jVal.l;
+    destroyLocalReference(env, jPath);
 
-    //Figure out no of entries in that directory
-    jsize jPathListSize = (*env)->GetArrayLength(env, jPathList);
-    *numEntries = jPathListSize;
-    if (jPathListSize == 0) {
+    struct hdfsListingInternal *listing =
+        calloc(1, sizeof(struct hdfsListingInternal));
+    if (listing == NULL) {
+        destroyLocalReference(env, jPathList);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    //Pin the status array across calls; entries are extracted later
+    listing->statuses = (*env)->NewGlobalRef(env, jPathList);
+    listing->size = (*env)->GetArrayLength(env, jPathList);
+    listing->pos = 0;
+    destroyLocalReference(env, jPathList);
+    if (listing->statuses == NULL) {
+        free(listing);
+        errno = EINTERNAL;
+        return NULL;
+    }
+
+    return listing;
+}
+
+
+
+hdfsFileInfo *hdfsListingNext(hdfsListing listing, int maxEntries,
+                              int *numEntries)
+{
+    struct hdfsListingInternal *l = (struct hdfsListingInternal *)listing;
+
+    *numEntries = 0;
+
+    if (l == NULL || maxEntries < 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    //End of the listing
+    if (l->pos >= l->size) {
         errno = 0;
-        goto done;
+        return NULL;
     }
 
-    //Allocate memory
-    pathList = calloc(jPathListSize, sizeof(hdfsFileInfo));
-    if (pathList == NULL) {
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return NULL;
+    }
+
+    jsize count = l->size - l->pos;
+    if (count > maxEntries) {
+        count = maxEntries;
+    }
+
+    hdfsFileInfo *page = calloc(count, sizeof(hdfsFileInfo));
+    if (page == NULL) {
         errno = ENOMEM;
-        goto done;
+        return NULL;
     }
 
-    //Save path information in pathList
     jsize i;
     jobject tmpStat;
-    for (i=0; i < jPathListSize; ++i) {
-        tmpStat = (*env)->GetObjectArrayElement(env, jPathList, i);
-        if (getFileInfoFromStat(env, tmpStat, &pathList[i])) {
-            hdfsFreeFileInfo(pathList, jPathListSize);
+    for (i = 0; i < count; ++i) {
+        tmpStat = (*env)->GetObjectArrayElement(env, l->statuses, l->pos + i);
+        if (getFileInfoFromStat(env, tmpStat, &page[i])) {
+            hdfsFreeFileInfo(page, count);
             destroyLocalReference(env, tmpStat);
-            pathList = NULL;
-            goto done;
+            return NULL;
         }
         destroyLocalReference(env, tmpStat);
     }
 
-    done:
+    l->pos += count;
+    *numEntries = count;
+    return page;
+}
 
-    //Delete unnecessary local references
-    destroyLocalReference(env, jPath);
-    destroyLocalReference(env, jPathList);
 
-    return pathList;
+
+int hdfsCloseListing(hdfsListing listing)
+{
+    struct hdfsListingInternal *l = (struct hdfsListingInternal *)listing;
+
+    if (l == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+
+    //Get the JNIEnv* corresponding to current thread
+    JNIEnv* env = getJNIEnv();
+    if (env == NULL) {
+      errno = EINTERNAL;
+      return -1;
+    }
+
+    (*env)->DeleteGlobalRef(env, l->statuses);
+    free(l);
+    return 0;
 }
 
 
 
-hdfsFileInfo *hdfsGetPathInfo(hdfsFS fs, const char* path)
+static hdfsFileInfo *hdfsGetPathInfoInternal(hdfsFS fs, const char* path)
 {
     // JAVA EQUIVALENT:
     //  File f(path);
@@ -2061,6 +4508,16 @@ hdfsFileInfo *hdfsGetPathInfo(hdfsFS fs, const char* path)
 
 
 
+hdfsFileInfo *hdfsGetPathInfo(hdfsFS fs, const char* path)
+{
+    uint64_t start = statsBegin();
+    hdfsFileInfo *info = hdfsGetPathInfoInternal(fs, path);
+    statsRecord(HDFS_STAT_STAT, start, 0, info == NULL);
+    return info;
+}
+
+
+
 void hdfsFreeFileInfo(hdfsFileInfo *hdfsFileInfo, int numEntries)
 {
     //Free the mName
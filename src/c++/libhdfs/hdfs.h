@@ -21,6 +21,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include <fcntl.h>
 #include <stdio.h>
@@ -87,11 +88,26 @@ extern  "C" {
     struct hdfsFile_internal {
         void* file;
         enum hdfsStreamType type;
+        void* readahead;
+        void* writebuf;
+        int localFd;  /* short-circuit read descriptor, or -1 */
     };
     typedef struct hdfsFile_internal* hdfsFile;
       
 
-    /** 
+    /**
+     * hdfsPrewarm - Start creating the embedded JVM on a background
+     * thread and resolve the classes of the FileSystem stack, so a
+     * later hdfsConnect finds them ready instead of paying the full
+     * JVM startup synchronously. Returns immediately; only the first
+     * call does anything. Entirely optional: without it the JVM is
+     * still created lazily on the first operation, and if the warmup
+     * fails the first operation simply retries synchronously.
+     */
+    void hdfsPrewarm(void);
+
+
+    /**
      * hdfsConnectAsUser - Connect to a hdfs file system as a specific user
      * Connect to the hdfs.
      * @param host A string containing either a host name, or an ip address
@@ -212,7 +228,203 @@ extern  "C" {
                     void* buffer, tSize length);
 
 
-    /** 
+    /**
+     * hdfsReadDirect - Read data from an open file into the caller's
+     * buffer with no intermediate copy. The buffer is wrapped in a
+     * direct ByteBuffer that the Java stream fills in place; when the
+     * stream or JVM cannot read into a ByteBuffer this falls back to
+     * hdfsRead transparently.
+     * @param fs The configured filesystem handle.
+     * @param file The file handle.
+     * @param buffer The buffer to read bytes into.
+     * @param length The length of the buffer.
+     * @return Returns the number of bytes actually read, possibly less
+     * than than length;-1 on error.
+     */
+    tSize hdfsReadDirect(hdfsFS fs, hdfsFile file, void* buffer,
+                         tSize length);
+
+
+    /**
+     * hdfsPreadDirect - Positional counterpart of hdfsReadDirect.
+     * Falls back to hdfsPread when a direct read is not possible.
+     * @param fs The configured filesystem handle.
+     * @param file The file handle.
+     * @param position Position from which to read
+     * @param buffer The buffer to read bytes into.
+     * @param length The length of the buffer.
+     * @return Returns the number of bytes actually read, possibly less than
+     * than length;-1 on error.
+     */
+    tSize hdfsPreadDirect(hdfsFS fs, hdfsFile file, tOffset position,
+                          void* buffer, tSize length);
+
+
+    /**
+     * hdfsFileSetReadahead - Enable or disable background readahead
+     * on an input file. While enabled, a native prefetch thread keeps
+     * bufferCount buffers of bufferSize bytes filled ahead of the
+     * current offset, so sequential hdfsRead calls are usually served
+     * from memory instead of a JNI round trip. Reads that break the
+     * sequential pattern fall through to a positional read and restart
+     * the prefetch from the new offset.
+     * @param fs The configured filesystem handle.
+     * @param file The file handle. Must be an input file.
+     * @param bufferSize Bytes per prefetch buffer; 0 disables readahead.
+     * @param bufferCount Number of buffers to keep ahead.
+     * @return Returns 0 on success, -1 on error.
+     */
+    int hdfsFileSetReadahead(hdfsFS fs, hdfsFile file, tSize bufferSize,
+                             int bufferCount);
+
+
+    /**
+     * hdfsSetShortCircuitLocalRead - Enable or disable short-circuit
+     * reads. While enabled, input files opened on a FileSystem backed
+     * by local disk are read straight from the underlying file with
+     * read/pread, bypassing the Java stream (and its checksum layer)
+     * entirely; files that cannot be opened natively keep the normal
+     * path. Off by default.
+     * @param enable Non-zero enables, 0 disables for files opened
+     * afterwards.
+     */
+    void hdfsSetShortCircuitLocalRead(int enable);
+
+
+    /**
+     * The operations the statistics layer distinguishes.
+     */
+    typedef enum {
+        HDFS_STAT_OPEN  = 0,
+        HDFS_STAT_READ  = 1,
+        HDFS_STAT_PREAD = 2,
+        HDFS_STAT_WRITE = 3,
+        HDFS_STAT_STAT  = 4,
+        HDFS_STAT_NUM_OPS = 5,
+    } hdfsStatOp;
+
+    #define HDFS_STATS_BUCKETS 24
+
+
+    /**
+     * Counters and a latency histogram for one operation. Bucket i of
+     * the histogram holds the calls that took at most 2^i microseconds;
+     * the last bucket also holds everything slower.
+     */
+    typedef struct {
+        uint64_t count;       /* completed calls */
+        uint64_t errors;      /* calls that returned an error */
+        uint64_t bytes;       /* bytes moved by the data operations */
+        uint64_t totalMicros; /* wall time summed over the calls */
+        uint64_t maxMicros;   /* the slowest call */
+        uint64_t latencyBuckets[HDFS_STATS_BUCKETS];
+    } hdfsOpStats;
+
+
+    /**
+     * hdfsSetStatsCollection - Turn the per-operation statistics layer
+     * on or off. While on, every hdfsOpenFile, hdfsRead, hdfsPread,
+     * hdfsWrite and hdfsGetPathInfo call is timed around its JNI
+     * crossing, so a slow stretch can be pinned on the cluster without
+     * attaching a profiler to the embedded JVM. Readahead and async
+     * reader prefetches show up as the preads they issue. Off by
+     * default; the timing itself is one gettimeofday pair per call.
+     * @param mode 0 disables, 1 collects, 2 collects and also dumps
+     * the statistics to stderr on every hdfsDisconnect.
+     */
+    void hdfsSetStatsCollection(int mode);
+
+
+    /**
+     * hdfsGetStats - Copy out the collected statistics, one entry per
+     * hdfsStatOp in enum order.
+     * @param stats An array of at least numOps entries to fill in.
+     * @param numOps The capacity of the array; entries beyond
+     * HDFS_STAT_NUM_OPS are left untouched.
+     * @return Returns the number of entries filled in.
+     */
+    int hdfsGetStats(hdfsOpStats *stats, int numOps);
+
+
+    /**
+     * hdfsResetStats - Zero the collected statistics, for callers that
+     * sample them over an interval.
+     */
+    void hdfsResetStats(void);
+
+
+    /**
+     * The C reflection of a pool of reader threads with a completion
+     * queue; see hdfsAsyncReaderCreate.
+     */
+    typedef void* hdfsAsyncReader;
+
+
+    /**
+     * One completed asynchronous read, delivered by hdfsAsyncWait.
+     */
+    typedef struct {
+        int ticket;       /* the ticket hdfsPreadAsync returned */
+        tSize bytesRead;  /* bytes read into the buffer; -1 on error */
+        int error;        /* errno value when bytesRead is -1 */
+        void* userData;   /* pointer passed to hdfsPreadAsync */
+    } hdfsAsyncResult;
+
+
+    /**
+     * hdfsAsyncReaderCreate - Create a pool of threads that perform
+     * positional reads in the background. The worker threads stay
+     * attached to the JVM, so callers submitting reads never pay a
+     * JNI crossing or block on one; completions are collected with
+     * hdfsAsyncWait.
+     * @param fs The configured filesystem handle.
+     * @param numThreads Number of worker threads.
+     * @return Returns a reader handle; NULL on error.
+     */
+    hdfsAsyncReader hdfsAsyncReaderCreate(hdfsFS fs, int numThreads);
+
+
+    /**
+     * hdfsPreadAsync - Queue a positional read. The buffer must stay
+     * valid until the matching completion has been collected.
+     * @param reader The handle obtained from hdfsAsyncReaderCreate.
+     * @param file The file handle. Must be an input file.
+     * @param position Position from which to read.
+     * @param buffer The buffer to copy read bytes into.
+     * @param length The length of the buffer.
+     * @param userData Opaque pointer handed back in the completion.
+     * @return Returns a non-negative ticket identifying the read;
+     * -1 on error.
+     */
+    int hdfsPreadAsync(hdfsAsyncReader reader, hdfsFile file,
+                       tOffset position, void* buffer, tSize length,
+                       void* userData);
+
+
+    /**
+     * hdfsAsyncWait - Collect one completed read.
+     * @param reader The handle obtained from hdfsAsyncReaderCreate.
+     * @param result Filled in with the completion.
+     * @param timeoutMs How long to wait for a completion: -1 blocks,
+     * 0 polls, otherwise at most timeoutMs milliseconds.
+     * @return Returns 1 when a completion was delivered, 0 when none
+     * was available in time (or nothing is in flight), -1 on error.
+     */
+    int hdfsAsyncWait(hdfsAsyncReader reader, hdfsAsyncResult* result,
+                      int timeoutMs);
+
+
+    /**
+     * hdfsAsyncReaderDestroy - Stop the worker threads and release the
+     * reader. Reads still in flight are completed first; completions
+     * not yet collected are discarded.
+     * @param reader The handle obtained from hdfsAsyncReaderCreate.
+     * @return Returns 0 on success, -1 on error.
+     */
+    int hdfsAsyncReaderDestroy(hdfsAsyncReader reader);
+
+
+    /**
      * hdfsWrite - Write data into an open file.
      * @param fs The configured filesystem handle.
      * @param file The file handle.
@@ -224,6 +436,37 @@ extern  "C" {
                     tSize length);
 
 
+    /**
+     * hdfsWritev - Write the data described by an iovec array with a
+     * single JNI crossing. The segments are gathered natively before
+     * being handed to the stream, so many small segments cost the same
+     * as one large write.
+     * @param fs The configured filesystem handle.
+     * @param file The file handle.
+     * @param iov Array of segments to write, in order.
+     * @param iovcnt The number of segments.
+     * @return Returns the total number of bytes written, -1 on error.
+     */
+    tSize hdfsWritev(hdfsFS fs, hdfsFile file, const struct iovec* iov,
+                     int iovcnt);
+
+
+    /**
+     * hdfsFileSetWriteBuffer - Enable or disable native write
+     * buffering on an output file. While enabled, small hdfsWrite
+     * calls are coalesced in a native buffer and cross JNI only when
+     * bufferSize bytes have accumulated; hdfsFlush and hdfsCloseFile
+     * drain the buffer. Writes at least bufferSize long bypass the
+     * buffer.
+     * @param fs The configured filesystem handle.
+     * @param file The file handle. Must be an output file.
+     * @param bufferSize Bytes to coalesce before writing through; 0
+     * disables buffering after draining anything pending.
+     * @return Returns 0 on success, -1 on error.
+     */
+    int hdfsFileSetWriteBuffer(hdfsFS fs, hdfsFile file, tSize bufferSize);
+
+
     /** 
      * hdfsWrite - Flush the data. 
      * @param fs The configured filesystem handle.
@@ -254,6 +497,40 @@ extern  "C" {
     int hdfsCopy(hdfsFS srcFS, const char* src, hdfsFS dstFS, const char* dst);
 
 
+    /**
+     * Progress callback for hdfsCopyParallel, invoked from the worker
+     * threads after each chunk. Keep it cheap.
+     * @param path The source file being copied.
+     * @param bytesCopied Aggregate bytes copied so far.
+     * @param bytesTotal Aggregate bytes to copy.
+     * @param context The pointer passed to hdfsCopyParallel.
+     */
+    typedef void (*hdfsCopyProgress)(const char* path, tOffset bytesCopied,
+                                     tOffset bytesTotal, void* context);
+
+
+    /**
+     * hdfsCopyParallel - Copy a file or directory tree with several
+     * concurrent streams. The source is enumerated up front,
+     * directories are recreated on the destination, and the files are
+     * then copied by numThreads workers in parallel; a file is the
+     * unit of parallelism since an HDFS output stream only appends.
+     * @param srcFS The handle of source filesystem.
+     * @param src The path of source file or directory.
+     * @param dstFS The handle of destination filesystem.
+     * @param dst The path of destination file or directory.
+     * @param numThreads Number of concurrent copy streams.
+     * @param bytesPerSec Aggregate bandwidth cap; 0 for unthrottled.
+     * @param progress Progress callback; NULL for none.
+     * @param progressContext Opaque pointer handed to the callback.
+     * @return Returns 0 on success, -1 on error.
+     */
+    int hdfsCopyParallel(hdfsFS srcFS, const char* src, hdfsFS dstFS,
+                         const char* dst, int numThreads,
+                         tOffset bytesPerSec, hdfsCopyProgress progress,
+                         void* progressContext);
+
+
     /**
      * hdfsMove - Move file from one filesystem to another.
      * @param srcFS The handle to source filesystem.
@@ -357,7 +634,131 @@ extern  "C" {
                                     int *numEntries);
 
 
-    /** 
+    /**
+     * A whole directory listing packed into two allocations: the
+     * fixed-size records sit in one contiguous array and every string
+     * they point at lives in one shared arena, so the result is built
+     * without per-entry mallocs and released with a single call. The
+     * entries must not be handed to hdfsFreeFileInfo.
+     */
+    typedef struct {
+        hdfsFileInfo *entries;
+        int numEntries;
+        char *strings;  /* arena backing the entry strings */
+    } hdfsBulkFileInfo;
+
+
+    /**
+     * hdfsListDirectoryBulk - Get the list of files/directories for a
+     * given directory-path as one arena-backed object. For very large
+     * directories this is much cheaper to build and to free than the
+     * per-entry allocations of hdfsListDirectory.
+     * hdfsFreeBulkFileInfo should be called on the result.
+     * @param fs The configured filesystem handle.
+     * @param path The path of the directory.
+     * @return Returns a dynamically-allocated hdfsBulkFileInfo object;
+     * NULL on error.
+     */
+    hdfsBulkFileInfo *hdfsListDirectoryBulk(hdfsFS fs, const char* path);
+
+
+    /**
+     * hdfsFreeBulkFileInfo - Free up an hdfsBulkFileInfo and
+     * everything it points at.
+     * @param bulk The object returned by hdfsListDirectoryBulk.
+     */
+    void hdfsFreeBulkFileInfo(hdfsBulkFileInfo *bulk);
+
+
+    /**
+     * hdfsExistsMulti - Checks if many paths exist in one call,
+     * paying the JNI attachment and setup once for the whole batch.
+     * @param fs The configured filesystem handle.
+     * @param paths The paths to check.
+     * @param numPaths The number of paths.
+     * @param results Per path: 0 if it exists, -1 if not.
+     * @return Returns 0 when the whole batch was checked, -1 on error.
+     */
+    int hdfsExistsMulti(hdfsFS fs, const char **paths, int numPaths,
+                        int *results);
+
+
+    /**
+     * hdfsGetPathInfoMulti - Stat many paths in one call. The results
+     * come back in one arena-backed object indexed like the input;
+     * a path that could not be stat'ed leaves its entry zeroed (mName
+     * is NULL). hdfsFreeBulkFileInfo should be called on the result.
+     * @param fs The configured filesystem handle.
+     * @param paths The paths to stat.
+     * @param numPaths The number of paths.
+     * @return Returns a dynamically-allocated hdfsBulkFileInfo with
+     * numPaths entries; NULL on error.
+     */
+    hdfsBulkFileInfo *hdfsGetPathInfoMulti(hdfsFS fs, const char **paths,
+                                           int numPaths);
+
+
+    /**
+     * hdfsDeleteMulti - Delete many paths in one call.
+     * @param fs The configured filesystem handle.
+     * @param paths The paths to delete.
+     * @param numPaths The number of paths.
+     * @param recursive If a path is a directory and set to non-zero,
+     * it is deleted recursively, else an error.
+     * @param results Per path: 0 if deleted, -1 if not.
+     * @return Returns 0 when the whole batch was attempted, -1 on
+     * error.
+     */
+    int hdfsDeleteMulti(hdfsFS fs, const char **paths, int numPaths,
+                        int recursive, int *results);
+
+
+    /**
+     * The C reflection of a directory listing being consumed in pages;
+     * see hdfsOpenListing.
+     */
+    typedef void* hdfsListing;
+
+
+    /**
+     * hdfsOpenListing - Start listing a directory without materializing
+     * the whole listing at once. hdfsListingNext converts the entries
+     * to hdfsFileInfo structs a page at a time, so callers scanning
+     * very large directories bound their memory use and can stop
+     * early. hdfsCloseListing should be called on the returned handle
+     * when done.
+     * @param fs The configured filesystem handle.
+     * @param path The path of the directory.
+     * @return Returns a listing handle; NULL on error.
+     */
+    hdfsListing hdfsOpenListing(hdfsFS fs, const char* path);
+
+
+    /**
+     * hdfsListingNext - Get the next page of entries from a listing.
+     * hdfsFreeFileInfo should be called on each returned page.
+     * @param listing The handle obtained from hdfsOpenListing.
+     * @param maxEntries The most entries to return in this page.
+     * @param numEntries Set to the number of entries returned; 0 once
+     * the listing is exhausted.
+     * @return Returns a dynamically-allocated array of hdfsFileInfo
+     * objects; NULL at the end of the listing or on error (check
+     * *numEntries and errno to distinguish).
+     */
+    hdfsFileInfo *hdfsListingNext(hdfsListing listing, int maxEntries,
+                                  int *numEntries);
+
+
+    /**
+     * hdfsCloseListing - Release a listing handle and any entries not
+     * yet consumed.
+     * @param listing The handle obtained from hdfsOpenListing.
+     * @return Returns 0 on success, -1 on error.
+     */
+    int hdfsCloseListing(hdfsListing listing);
+
+
+    /**
      * hdfsGetPathInfo - Get information about a path as a (dynamically
      * allocated) single hdfsFileInfo struct. hdfsFreeFileInfo should be
      * called when the pointer is no longer needed.
@@ -403,7 +804,55 @@ extern  "C" {
     void hdfsFreeHosts(char ***blockHosts);
 
 
-    /** 
+    /**
+     * hdfsSetHostCacheTTL - Enable caching of hdfsGetHosts answers.
+     * While enabled, repeat queries for the same (path, start, length)
+     * are answered from a native cache instead of going back to the
+     * NameNode, until the entry is ttlSeconds old. The cache is off by
+     * default; pass 0 to turn it off again and discard all entries.
+     * @param ttlSeconds How long a cached answer may be served.
+     */
+    void hdfsSetHostCacheTTL(int ttlSeconds);
+
+
+    /**
+     * hdfsHostCacheInvalidate - Discard cached hdfsGetHosts answers,
+     * e.g. after rewriting a file whose locations were cached.
+     * @param path The file whose entries to drop; NULL drops every
+     * entry.
+     */
+    void hdfsHostCacheInvalidate(const char* path);
+
+
+    /**
+     * hdfsGetHostsBatch - Resolve the hosts of many ranges of one file
+     * at once. The file's status is looked up a single time and cached
+     * ranges are served without any RPC, so this is much cheaper than
+     * calling hdfsGetHosts per range. hdfsFreeHostsBatch should be
+     * called on the result.
+     * @param fs The configured filesystem handle.
+     * @param path The path of the file.
+     * @param starts The start offset of each range.
+     * @param lengths The length of each range.
+     * @param numRanges The number of ranges.
+     * @return Returns a dynamically-allocated array of numRanges
+     * blocks-hosts arrays (each shaped like an hdfsGetHosts result);
+     * NULL on error.
+     */
+    char**** hdfsGetHostsBatch(hdfsFS fs, const char* path,
+            const tOffset* starts, const tOffset* lengths, int numRanges);
+
+
+    /**
+     * hdfsFreeHostsBatch - Free up the structure returned by
+     * hdfsGetHostsBatch.
+     * @param blockHostsBatch The array of blocks-hosts arrays.
+     * @param numRanges The number of ranges it was created with.
+     */
+    void hdfsFreeHostsBatch(char ****blockHostsBatch, int numRanges);
+
+
+    /**
      * hdfsGetDefaultBlockSize - Get the optimum blocksize.
      * @param fs The configured filesystem handle.
      * @return Returns the blocksize; -1 on error. 
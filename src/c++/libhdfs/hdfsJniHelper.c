@@ -49,6 +49,36 @@ static volatile int hashTableInited = 0;
  */
 #define MAX_HASH_TABLE_ELEM 4096
 
+/**
+ * METHOD_CACHE_SLOTS: size of the resolved method ID cache. Must be a
+ * power of two; libhdfs resolves a few dozen distinct methods, so the
+ * table stays sparse.
+ */
+#define METHOD_CACHE_SLOTS 1024
+
+/**
+ * One resolved (class, method) pair. jclass global references and
+ * jmethodIDs are stable for the lifetime of the JVM, so an entry is
+ * immutable once published and can be read without locking.
+ */
+typedef struct {
+    const char *className;
+    const char *methName;
+    const char *methSignature;
+    MethType methType;
+    jclass cls;
+    jmethodID mid;
+} MethodCacheEntry;
+
+/**
+ * Open-addressed slot array. Slots go from NULL to a fully built
+ * entry exactly once and are never reused, so readers probe without
+ * taking methodCacheMutex; only writers serialize on it.
+ */
+static MethodCacheEntry * volatile methodCache[METHOD_CACHE_SLOTS];
+static int methodCacheCount = 0;
+static pthread_mutex_t methodCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
 
 static int validateMethodType(MethType methType)
 {
@@ -120,6 +150,123 @@ static void* searchEntryFromTable(const char *key)
 
 
 
+static unsigned int methodCacheHash(const char *className,
+        const char *methName, const char *methSignature, MethType methType)
+{
+    unsigned int h = 5381 + methType;
+    const char *str;
+    for (str = className; *str; str++) {
+        h = h * 33 + (unsigned char)*str;
+    }
+    for (str = methName; *str; str++) {
+        h = h * 33 + (unsigned char)*str;
+    }
+    for (str = methSignature; *str; str++) {
+        h = h * 33 + (unsigned char)*str;
+    }
+    return h;
+}
+
+/**
+ * Probe the cache without locking. Returns the matching entry, or
+ * NULL with *emptySlot set to the slot where the entry belongs.
+ */
+static MethodCacheEntry* methodCacheLookup(const char *className,
+        const char *methName, const char *methSignature, MethType methType,
+        unsigned int *emptySlot)
+{
+    unsigned int slot = methodCacheHash(className, methName, methSignature,
+            methType) & (METHOD_CACHE_SLOTS - 1);
+    MethodCacheEntry *e;
+    while ((e = methodCache[slot]) != NULL) {
+        if (e->methType == methType &&
+                strcmp(e->methName, methName) == 0 &&
+                strcmp(e->className, className) == 0 &&
+                strcmp(e->methSignature, methSignature) == 0) {
+            return e;
+        }
+        slot = (slot + 1) & (METHOD_CACHE_SLOTS - 1);
+    }
+    *emptySlot = slot;
+    return e;
+}
+
+/**
+ * Look up a resolved (jclass, jmethodID) pair, resolving and caching
+ * it on first use. The hit path is lock-free: IDs never change while
+ * the JVM is up, entries are published with a memory barrier after
+ * they are fully built, and slots are never reused.
+ */
+static MethodCacheEntry* methodCacheGet(JNIEnv *env, const char *className,
+        const char *methName, const char *methSignature, MethType methType)
+{
+    unsigned int slot;
+    MethodCacheEntry *e = methodCacheLookup(className, methName,
+            methSignature, methType, &slot);
+    if (e != NULL) {
+        return e;
+    }
+
+    pthread_mutex_lock(&methodCacheMutex);
+    e = methodCacheLookup(className, methName, methSignature, methType,
+            &slot);
+    if (e != NULL) {
+        pthread_mutex_unlock(&methodCacheMutex);
+        return e;
+    }
+    if (methodCacheCount >= METHOD_CACHE_SLOTS / 2) {
+        //libhdfs resolves a few dozen distinct methods, so this means
+        //something is generating method names
+        fprintf(stderr, "error method cache full adding %s#%s\n",
+                className, methName);
+        pthread_mutex_unlock(&methodCacheMutex);
+        return NULL;
+    }
+
+    jclass cls = globalClassReference(className, env);
+    if (cls == NULL) {
+        pthread_mutex_unlock(&methodCacheMutex);
+        return NULL;
+    }
+    jmethodID mid = NULL;
+    if (methType == STATIC) {
+        mid = (*env)->GetStaticMethodID(env, cls, methName, methSignature);
+    }
+    else if (methType == INSTANCE) {
+        mid = (*env)->GetMethodID(env, cls, methName, methSignature);
+    }
+    if (mid == NULL) {
+        fprintf(stderr, "could not find method %s from class %s with "
+                "signature %s\n", methName, className, methSignature);
+        pthread_mutex_unlock(&methodCacheMutex);
+        return NULL;
+    }
+
+    e = calloc(1, sizeof(MethodCacheEntry));
+    if (e == NULL) {
+        pthread_mutex_unlock(&methodCacheMutex);
+        return NULL;
+    }
+    e->className = strdup(className);
+    e->methName = strdup(methName);
+    e->methSignature = strdup(methSignature);
+    e->methType = methType;
+    e->cls = cls;
+    e->mid = mid;
+    if (e->className == NULL || e->methName == NULL ||
+            e->methSignature == NULL) {
+        pthread_mutex_unlock(&methodCacheMutex);
+        return NULL;
+    }
+    methodCacheCount++;
+    //the entry must be complete before its slot pointer becomes visible
+    __sync_synchronize();
+    methodCache[slot] = e;
+    pthread_mutex_unlock(&methodCacheMutex);
+    return e;
+}
+
+
 int invokeMethod(JNIEnv *env, RetVal *retval, Exc *exc, MethType methType,
                  jobject instObj, const char *className,
                  const char *methName, const char *methSignature, ...)
@@ -134,18 +281,15 @@ int invokeMethod(JNIEnv *env, RetVal *retval, Exc *exc, MethType methType,
     if (! validateMethodType(methType)) {
       return -1;
     }
-    cls = globalClassReference(className, env);
-    if (cls == NULL) {
-      return -2;
-    }
-
-    mid = methodIdFromClass(className, methName, methSignature, 
-                            methType, env);
-    if (mid == NULL) {
+    MethodCacheEntry *entry = methodCacheGet(env, className, methName,
+                                             methSignature, methType);
+    if (entry == NULL) {
         (*env)->ExceptionDescribe(env);
-        return -3;
+        return -2;
     }
-   
+    cls = entry->cls;
+    mid = entry->mid;
+
     str = methSignature;
     while (*str != ')') str++;
     str++;
@@ -256,18 +400,14 @@ jobject constructNewObjectOfClass(JNIEnv *env, Exc *exc, const char *className,
     jobject jobj;
     jthrowable jthr;
 
-    cls = globalClassReference(className, env);
-    if (cls == NULL) {
-        (*env)->ExceptionDescribe(env);
-      return NULL;
-    }
-
-    mid = methodIdFromClass(className, "<init>", ctorSignature, 
-                            INSTANCE, env);
-    if (mid == NULL) {
+    MethodCacheEntry *entry = methodCacheGet(env, className, "<init>",
+                                             ctorSignature, INSTANCE);
+    if (entry == NULL) {
         (*env)->ExceptionDescribe(env);
         return NULL;
-    } 
+    }
+    cls = entry->cls;
+    mid = entry->mid;
     va_start(args, ctorSignature);
     jobj = (*env)->NewObjectV(env, cls, mid, args);
     va_end(args);
@@ -284,32 +424,21 @@ jobject constructNewObjectOfClass(JNIEnv *env, Exc *exc, const char *className,
 
 
 
-jmethodID methodIdFromClass(const char *className, const char *methName, 
-                            const char *methSignature, MethType methType, 
+jmethodID methodIdFromClass(const char *className, const char *methName,
+                            const char *methSignature, MethType methType,
                             JNIEnv *env)
 {
-    jclass cls = globalClassReference(className, env);
-    if (cls == NULL) {
-      fprintf(stderr, "could not find class %s\n", className);
-      return NULL;
-    }
-
-    jmethodID mid = 0;
     if (!validateMethodType(methType)) {
       fprintf(stderr, "invalid method type\n");
       return NULL;
     }
 
-    if (methType == STATIC) {
-        mid = (*env)->GetStaticMethodID(env, cls, methName, methSignature);
-    }
-    else if (methType == INSTANCE) {
-        mid = (*env)->GetMethodID(env, cls, methName, methSignature);
-    }
-    if (mid == NULL) {
-      fprintf(stderr, "could not find method %s from class %s with signature %s\n",methName, className, methSignature);
+    MethodCacheEntry *entry = methodCacheGet(env, className, methName,
+                                             methSignature, methType);
+    if (entry == NULL) {
+      return NULL;
     }
-    return mid;
+    return entry->mid;
 }
 
 
@@ -378,6 +507,30 @@ char *classNameOfObject(jobject jobj, JNIEnv *env) {
 
 
 
+/**
+ * Per-thread cached JNIEnv. A thread pays AttachCurrentThread once,
+ * on its first operation; afterwards getJNIEnv is a plain
+ * pthread_getspecific with no lock. The key destructor detaches the
+ * thread from the JVM when it exits, so short-lived threads do not
+ * leak attachments.
+ */
+static pthread_key_t jniEnvKey;
+static pthread_once_t jniEnvKeyOnce = PTHREAD_ONCE_INIT;
+static JavaVM * volatile cachedJvm = NULL;
+
+static void jniEnvDetach(void *env)
+{
+    JavaVM *vm = cachedJvm;
+    if (vm != NULL) {
+        (*vm)->DetachCurrentThread(vm);
+    }
+}
+
+static void jniEnvKeyCreate(void)
+{
+    pthread_key_create(&jniEnvKey, jniEnvDetach);
+}
+
 /**
  * getJNIEnv: A helper function to get the JNIEnv* for the given thread.
  * If no JVM exists, then one will be created. JVM command line arguments
@@ -390,15 +543,37 @@ JNIEnv* getJNIEnv(void)
 {
 
     const jsize vmBufLength = 1;
-    JavaVM* vmBuf[vmBufLength]; 
+    JavaVM* vmBuf[vmBufLength];
     JNIEnv *env;
-    jint rv = 0; 
+    jint rv = 0;
     jint noVMs = 0;
+    JavaVM *vm;
+
+    pthread_once(&jniEnvKeyOnce, jniEnvKeyCreate);
+
+    //Fast path: this thread already attached and cached its env
+    env = (JNIEnv*)pthread_getspecific(jniEnvKey);
+    if (env != NULL) {
+        return env;
+    }
+
+    vm = cachedJvm;
+    if (vm != NULL) {
+        //JVM already published; attach without the lock
+        goto attach;
+    }
 
     // Only the first thread should create the JVM. The other trheads should
     // just use the JVM created by the first thread.
     LOCK_JVM_MUTEX();
 
+    if (cachedJvm != NULL) {
+        //someone else created it while we waited for the lock
+        vm = cachedJvm;
+        UNLOCK_JVM_MUTEX();
+        goto attach;
+    }
+
     rv = JNI_GetCreatedJavaVMs(&(vmBuf[0]), vmBufLength, &noVMs);
     if (rv != 0) {
         fprintf(stderr, "JNI_GetCreatedJavaVMs failed with error: %d\n", rv);
@@ -447,7 +622,6 @@ JNIEnv* getJNIEnv(void)
 
         //Create the VM
         JavaVMInitArgs vm_args;
-        JavaVM *vm;
         vm_args.version = JNI_VERSION_1_2;
         vm_args.options = options;
         vm_args.nOptions = noArgs; 
@@ -464,17 +638,25 @@ JNIEnv* getJNIEnv(void)
         free(optHadoopClassPath);
     }
     else {
-        //Attach this thread to the VM
-        JavaVM* vm = vmBuf[0];
-        rv = (*vm)->AttachCurrentThread(vm, (void*)&env, 0);
-        if (rv != 0) {
-            fprintf(stderr, "Call to AttachCurrentThread "
-                    "failed with error: %d\n", rv);
-            UNLOCK_JVM_MUTEX();
-            return NULL;
-        }
+        vm = vmBuf[0];
     }
+
+    //Publish only after the VM is fully constructed; later callers
+    //then attach without taking the lock at all
+    __sync_synchronize();
+    cachedJvm = vm;
     UNLOCK_JVM_MUTEX();
 
+    attach:
+    //Attach this thread to the VM (a no-op returning the same env if
+    //this thread just created it) and cache the env for next time
+    rv = (*vm)->AttachCurrentThread(vm, (void*)&env, 0);
+    if (rv != 0) {
+        fprintf(stderr, "Call to AttachCurrentThread "
+                "failed with error: %d\n", rv);
+        return NULL;
+    }
+    pthread_setspecific(jniEnvKey, env);
+
     return env;
 }
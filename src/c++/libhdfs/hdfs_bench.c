@@ -0,0 +1,428 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * hdfs_bench: multithreaded libhdfs benchmark.
+ *
+ * Runs a read, write or pread workload across a number of threads,
+ * each working on its own set of files, and reports aggregate MB/s
+ * plus per-call latency percentiles (p50/p99/p999) derived from a
+ * power-of-two histogram. Results can additionally be dumped as a
+ * single JSON object for scripted comparisons between runs.
+ *
+ * Usage:
+ *   hdfs_bench -o read|write|pread [-t threads] [-n filesPerThread]
+ *              [-s fileSize] [-b bufferSize] [-p pathPrefix]
+ *              [-j jsonFile]
+ *
+ * The read and pread workloads write their input files first; that
+ * setup phase is not timed.
+ */
+
+#include "hdfs.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#define BENCH_BUCKETS 40
+
+struct benchConfig {
+    const char *op;
+    const char *prefix;
+    int threads;
+    int files;
+    long long fileSize;
+    int bufferSize;
+};
+
+struct benchStats {
+    long long calls;
+    long long bytes;
+    long long hist[BENCH_BUCKETS];
+};
+
+struct benchThread {
+    pthread_t thread;
+    int id;
+    const struct benchConfig *conf;
+    struct benchStats stats;
+    int failed;
+};
+
+static long long nowMicros(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+//latencies land in bucket floor(log2(micros)); percentiles are read
+//back as the bucket's upper bound, so they are upper estimates
+static void recordLatency(struct benchStats *stats, long long micros)
+{
+    int b = 0;
+    while (micros > 1 && b < BENCH_BUCKETS - 1) {
+        micros >>= 1;
+        b++;
+    }
+    stats->hist[b]++;
+    stats->calls++;
+}
+
+static long long percentileMicros(const struct benchStats *stats,
+                                  double fraction)
+{
+    long long rank = (long long)(fraction * stats->calls);
+    long long seen = 0;
+    int b;
+    for (b = 0; b < BENCH_BUCKETS; ++b) {
+        seen += stats->hist[b];
+        if (seen > rank) {
+            return 1LL << b;
+        }
+    }
+    return 1LL << (BENCH_BUCKETS - 1);
+}
+
+static void benchPath(char *dest, size_t destLen,
+                      const struct benchConfig *conf, int thread, int file)
+{
+    snprintf(dest, destLen, "%s/bench-t%d-f%d", conf->prefix, thread, file);
+}
+
+//write one file; stats may be NULL for the untimed setup phase
+static int benchWriteFile(hdfsFS fs, const char *path,
+                          const struct benchConfig *conf, char *buffer,
+                          struct benchStats *stats)
+{
+    hdfsFile f = hdfsOpenFile(fs, path, O_WRONLY, conf->bufferSize, 0, 0);
+    if (f == NULL) {
+        fprintf(stderr, "Failed to open %s for writing!\n", path);
+        return -1;
+    }
+
+    long long remaining;
+    for (remaining = conf->fileSize; remaining > 0; ) {
+        tSize curSize = (conf->bufferSize < remaining) ?
+            conf->bufferSize : (tSize)remaining;
+        long long before = nowMicros();
+        tSize written = hdfsWrite(fs, f, buffer, curSize);
+        if (written < 0) {
+            fprintf(stderr, "Failed to write to %s!\n", path);
+            hdfsCloseFile(fs, f);
+            return -1;
+        }
+        if (stats != NULL) {
+            recordLatency(stats, nowMicros() - before);
+            stats->bytes += written;
+        }
+        remaining -= written;
+    }
+
+    hdfsCloseFile(fs, f);
+    return 0;
+}
+
+static int benchReadFile(hdfsFS fs, const char *path,
+                         const struct benchConfig *conf, char *buffer,
+                         struct benchStats *stats)
+{
+    hdfsFile f = hdfsOpenFile(fs, path, O_RDONLY, conf->bufferSize, 0, 0);
+    if (f == NULL) {
+        fprintf(stderr, "Failed to open %s for reading!\n", path);
+        return -1;
+    }
+
+    for (;;) {
+        long long before = nowMicros();
+        tSize n = hdfsRead(fs, f, buffer, conf->bufferSize);
+        if (n < 0) {
+            fprintf(stderr, "Failed to read from %s!\n", path);
+            hdfsCloseFile(fs, f);
+            return -1;
+        }
+        recordLatency(stats, nowMicros() - before);
+        stats->bytes += n;
+        if (n == 0) {
+            break;
+        }
+    }
+
+    hdfsCloseFile(fs, f);
+    return 0;
+}
+
+static int benchPreadFile(hdfsFS fs, const char *path,
+                          const struct benchConfig *conf, char *buffer,
+                          struct benchStats *stats)
+{
+    hdfsFile f = hdfsOpenFile(fs, path, O_RDONLY, conf->bufferSize, 0, 0);
+    if (f == NULL) {
+        fprintf(stderr, "Failed to open %s for reading!\n", path);
+        return -1;
+    }
+
+    tOffset position;
+    for (position = 0; position < conf->fileSize;
+            position += conf->bufferSize) {
+        long long before = nowMicros();
+        tSize n = hdfsPread(fs, f, position, buffer, conf->bufferSize);
+        if (n < 0) {
+            fprintf(stderr, "Failed to pread from %s!\n", path);
+            hdfsCloseFile(fs, f);
+            return -1;
+        }
+        recordLatency(stats, nowMicros() - before);
+        stats->bytes += n;
+    }
+
+    hdfsCloseFile(fs, f);
+    return 0;
+}
+
+static void* benchWorker(void *arg)
+{
+    struct benchThread *bt = arg;
+    const struct benchConfig *conf = bt->conf;
+    char path[4096];
+    int i;
+
+    hdfsFS fs = hdfsConnect("default", 0);
+    if (fs == NULL) {
+        fprintf(stderr, "Oops! Failed to connect to hdfs!\n");
+        bt->failed = 1;
+        return NULL;
+    }
+
+    char *buffer = malloc(conf->bufferSize);
+    if (buffer == NULL) {
+        bt->failed = 1;
+        hdfsDisconnect(fs);
+        return NULL;
+    }
+    for (i = 0; i < conf->bufferSize; ++i) {
+        buffer[i] = 'a' + (i % 26);
+    }
+
+    for (i = 0; i < conf->files; ++i) {
+        benchPath(path, sizeof(path), conf, bt->id, i);
+        int rc;
+        if (strcmp(conf->op, "write") == 0) {
+            rc = benchWriteFile(fs, path, conf, buffer, &bt->stats);
+        }
+        else if (strcmp(conf->op, "read") == 0) {
+            rc = benchReadFile(fs, path, conf, buffer, &bt->stats);
+        }
+        else {
+            rc = benchPreadFile(fs, path, conf, buffer, &bt->stats);
+        }
+        if (rc != 0) {
+            bt->failed = 1;
+            break;
+        }
+    }
+
+    free(buffer);
+    hdfsDisconnect(fs);
+    return NULL;
+}
+
+//read and pread need their input files in place before the clock starts
+static int benchSetup(const struct benchConfig *conf)
+{
+    char path[4096];
+    int t, i;
+
+    hdfsFS fs = hdfsConnect("default", 0);
+    if (fs == NULL) {
+        fprintf(stderr, "Oops! Failed to connect to hdfs!\n");
+        return -1;
+    }
+
+    char *buffer = malloc(conf->bufferSize);
+    if (buffer == NULL) {
+        hdfsDisconnect(fs);
+        return -1;
+    }
+    for (i = 0; i < conf->bufferSize; ++i) {
+        buffer[i] = 'a' + (i % 26);
+    }
+
+    for (t = 0; t < conf->threads; ++t) {
+        for (i = 0; i < conf->files; ++i) {
+            benchPath(path, sizeof(path), conf, t, i);
+            if (benchWriteFile(fs, path, conf, buffer, NULL) != 0) {
+                free(buffer);
+                hdfsDisconnect(fs);
+                return -1;
+            }
+        }
+    }
+
+    free(buffer);
+    hdfsDisconnect(fs);
+    return 0;
+}
+
+static void writeJson(FILE *out, const struct benchConfig *conf,
+                      const struct benchStats *total, double seconds,
+                      double mbPerSec)
+{
+    fprintf(out,
+            "{\"op\": \"%s\", \"threads\": %d, \"files_per_thread\": %d, "
+            "\"file_size\": %lld, \"buffer_size\": %d, "
+            "\"total_bytes\": %lld, \"calls\": %lld, "
+            "\"seconds\": %.3f, \"mb_per_sec\": %.2f, "
+            "\"p50_us\": %lld, \"p99_us\": %lld, \"p999_us\": %lld}\n",
+            conf->op, conf->threads, conf->files, conf->fileSize,
+            conf->bufferSize, total->bytes, total->calls, seconds,
+            mbPerSec, percentileMicros(total, 0.50),
+            percentileMicros(total, 0.99), percentileMicros(total, 0.999));
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: hdfs_bench -o read|write|pread [-t threads] "
+            "[-n filesPerThread]\n"
+            "                  [-s fileSize] [-b bufferSize] "
+            "[-p pathPrefix] [-j jsonFile]\n");
+    exit(-1);
+}
+
+int main(int argc, char **argv)
+{
+    struct benchConfig conf;
+    const char *jsonFile = NULL;
+    int c, i, b;
+
+    conf.op = NULL;
+    conf.prefix = "/tmp/hdfs_bench";
+    conf.threads = 1;
+    conf.files = 1;
+    conf.fileSize = 64 * 1024 * 1024;
+    conf.bufferSize = 65536;
+
+    while ((c = getopt(argc, argv, "o:t:n:s:b:p:j:")) != -1) {
+        switch (c) {
+        case 'o':
+            conf.op = optarg;
+            break;
+        case 't':
+            conf.threads = atoi(optarg);
+            break;
+        case 'n':
+            conf.files = atoi(optarg);
+            break;
+        case 's':
+            conf.fileSize = strtoll(optarg, NULL, 10);
+            break;
+        case 'b':
+            conf.bufferSize = atoi(optarg);
+            break;
+        case 'p':
+            conf.prefix = optarg;
+            break;
+        case 'j':
+            jsonFile = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (conf.op == NULL ||
+            (strcmp(conf.op, "read") != 0 && strcmp(conf.op, "write") != 0 &&
+             strcmp(conf.op, "pread") != 0) ||
+            conf.threads < 1 || conf.files < 1 || conf.fileSize < 1 ||
+            conf.bufferSize < 1) {
+        usage();
+    }
+
+    if (strcmp(conf.op, "write") != 0) {
+        if (benchSetup(&conf) != 0) {
+            exit(-2);
+        }
+    }
+
+    struct benchThread *threads =
+        calloc(conf.threads, sizeof(struct benchThread));
+    if (threads == NULL) {
+        exit(-2);
+    }
+
+    long long started = nowMicros();
+    for (i = 0; i < conf.threads; ++i) {
+        threads[i].id = i;
+        threads[i].conf = &conf;
+        if (pthread_create(&threads[i].thread, NULL, benchWorker,
+                           &threads[i])) {
+            fprintf(stderr, "Failed to create benchmark thread %d!\n", i);
+            exit(-2);
+        }
+    }
+
+    int failed = 0;
+    struct benchStats total;
+    memset(&total, 0, sizeof(total));
+    for (i = 0; i < conf.threads; ++i) {
+        pthread_join(threads[i].thread, NULL);
+        failed |= threads[i].failed;
+        total.calls += threads[i].stats.calls;
+        total.bytes += threads[i].stats.bytes;
+        for (b = 0; b < BENCH_BUCKETS; ++b) {
+            total.hist[b] += threads[i].stats.hist[b];
+        }
+    }
+    double seconds = (nowMicros() - started) / 1000000.0;
+    free(threads);
+
+    if (failed || total.calls == 0) {
+        fprintf(stderr, "Benchmark failed!\n");
+        exit(-3);
+    }
+
+    double mbPerSec = (total.bytes / (1024.0 * 1024.0)) / seconds;
+    fprintf(stderr, "op=%s threads=%d files=%d fileSize=%lld "
+            "bufferSize=%d\n", conf.op, conf.threads, conf.files,
+            conf.fileSize, conf.bufferSize);
+    fprintf(stderr, "bytes=%lld calls=%lld seconds=%.3f MB/s=%.2f\n",
+            total.bytes, total.calls, seconds, mbPerSec);
+    fprintf(stderr, "latency p50=%lldus p99=%lldus p999=%lldus\n",
+            percentileMicros(&total, 0.50), percentileMicros(&total, 0.99),
+            percentileMicros(&total, 0.999));
+
+    if (jsonFile != NULL) {
+        FILE *out = strcmp(jsonFile, "-") == 0 ?
+            stdout : fopen(jsonFile, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Failed to open %s for writing!\n", jsonFile);
+            exit(-3);
+        }
+        writeJson(out, &conf, &total, seconds, mbPerSec);
+        if (out != stdout) {
+            fclose(out);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * vim: ts=4: sw=4: et:
+ */
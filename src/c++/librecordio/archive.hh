@@ -48,24 +48,97 @@ public:
   virtual void deserialize(hadoop::Record& s, const char* tag) {
     s.deserialize(*this, tag);
   }
+  /**
+   * Skip a string or buffer field without handing the value to the
+   * caller. The defaults read into a throwaway; archives that can
+   * compute the field's extent from its encoding override these to
+   * step past the body without materializing it.
+   */
+  virtual void skipString(const char* tag) {
+    std::string t;
+    deserialize(t, tag);
+  }
+  virtual void skipBuffer(const char* tag) {
+    std::string t;
+    size_t len = 0;
+    deserialize(t, len, tag);
+  }
+  /**
+   * Deserialize a whole array of values into the caller's buffer.
+   * The default walks the per-element path; archives with a cheaper
+   * bulk representation override these.
+   */
+  virtual void deserialize(int32_t* values, size_t count, const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      deserialize(values[cur], tag);
+    }
+  }
+  virtual void deserialize(int64_t* values, size_t count, const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      deserialize(values[cur], tag);
+    }
+  }
+  virtual void deserialize(float* values, size_t count, const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      deserialize(values[cur], tag);
+    }
+  }
+  virtual void deserialize(double* values, size_t count, const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      deserialize(values[cur], tag);
+    }
+  }
+  /**
+   * Deserialize into an existing vector, reusing its storage. The
+   * previous contents are replaced, but elements already present are
+   * deserialized into in place, so when one record object is reused
+   * across a scan the element buffers (e.g. string capacity) survive
+   * and steady-state reads allocate nothing.
+   */
   template <typename T>
   void deserialize(std::vector<T>& v, const char* tag) {
+    size_t n = 0;
+    Index* idx = startVector(tag);
+    while (!idx->done()) {
+      if (n == v.size()) {
+        v.resize(n + 1);
+      }
+      deserialize(v[n], tag);
+      n++;
+      idx->incr();
+    }
+    if (n < v.size()) {
+      v.resize(n);
+    }
+    endVector(idx, tag);
+  }
+  // vector<bool> stores packed bits and operator[] returns a proxy,
+  // so its elements cannot be deserialized into in place
+  void deserialize(std::vector<bool>& v, const char* tag) {
+    v.clear();
     Index* idx = startVector(tag);
     while (!idx->done()) {
-      T t;
-      deserialize(t, tag);
-      v.push_back(t);
+      bool b;
+      deserialize(b, tag);
+      v.push_back(b);
       idx->incr();
     }
     endVector(idx, tag);
   }
+  /**
+   * Deserialize into an existing map. The previous contents are
+   * replaced. The key and value scratch variables live outside the
+   * element loop so their buffers are reused across entries; the map
+   * nodes themselves are still allocated per entry.
+   */
   template <typename K, typename V>
   void deserialize(std::map<K,V>& v, const char* tag) {
+    v.clear();
     Index* idx = startMap(tag);
+    K key;
+    V value;
     while (!idx->done()) {
-      K key;
       deserialize(key, tag);
-      V value;
       deserialize(value, tag);
       v[key] = value;
       idx->incr();
@@ -94,6 +167,34 @@ public:
   virtual void serialize(const hadoop::Record& s, const char* tag) {
     s.serialize(*this, tag);
   }
+  /**
+   * Serialize a whole array of values. The default walks the
+   * per-element path; archives with a cheaper bulk representation
+   * override these.
+   */
+  virtual void serialize(const int32_t* values, size_t count,
+                         const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      serialize(values[cur], tag);
+    }
+  }
+  virtual void serialize(const int64_t* values, size_t count,
+                         const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      serialize(values[cur], tag);
+    }
+  }
+  virtual void serialize(const float* values, size_t count, const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      serialize(values[cur], tag);
+    }
+  }
+  virtual void serialize(const double* values, size_t count,
+                         const char* tag) {
+    for (size_t cur = 0; cur < count; cur++) {
+      serialize(values[cur], tag);
+    }
+  }
   template <typename T>
   void serialize(const std::vector<T>& v, const char* tag) {
     startVector(v.size(), tag);
@@ -116,6 +217,11 @@ public:
     }
     endMap(v.size(), tag);
  }
+  /**
+   * Write out anything the archive has buffered. Most archives write
+   * through and have nothing to do.
+   */
+  virtual void flush() {}
   virtual ~OArchive() {}
 };
 }; // end namespace hadoop
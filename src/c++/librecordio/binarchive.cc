@@ -17,6 +17,8 @@
  */
 
 #include "binarchive.hh"
+#include "stringPool.hh"
+#include <string.h>
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
@@ -148,6 +150,83 @@ static void deserializeDouble(double& t, InStream& stream)
   xdr_double(&xdrs, &t);
 }
 
+/**
+ * Encode the value into the buffer in one pass, mirroring
+ * serializeLong but without a stream write per byte. The buffer must
+ * hold at least 9 bytes.
+ * @return the number of bytes written
+ */
+static size_t encodeLong(int64_t t, char* buffer)
+{
+  if (t >= -112 && t <= 127) {
+    buffer[0] = (char) t;
+    return 1;
+  }
+
+  int8_t len = -112;
+  uint64_t value = t;
+  if (t < 0) {
+    value = ~value; // take one's complement
+    len = -120;
+  }
+
+  uint64_t tmp = value;
+  while (tmp != 0) {
+    tmp = tmp >> 8;
+    len--;
+  }
+
+  buffer[0] = (char) len;
+  int bytes = (len < -120) ? -(len + 120) : -(len + 112);
+
+  for (int idx = bytes; idx != 0; idx--) {
+    buffer[bytes - idx + 1] = (char) (value >> ((idx - 1) * 8));
+  }
+  return bytes + 1;
+}
+
+static void serializeLongArray(const int64_t* values, size_t count,
+                               OutStream& stream)
+{
+  char buffer[4096];
+  size_t used = 0;
+  for (size_t cur = 0; cur < count; cur++) {
+    if (used + 9 > sizeof(buffer)) {
+      if (used != (size_t) stream.write(buffer, used)) {
+        throw new IOException("Error serializing data.");
+      }
+      used = 0;
+    }
+    used += encodeLong(values[cur], buffer + used);
+  }
+  if (used > 0) {
+    if (used != (size_t) stream.write(buffer, used)) {
+      throw new IOException("Error serializing data.");
+    }
+  }
+}
+
+static inline uint32_t byteSwap32(uint32_t value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return value;
+#else
+  return ((value & 0xff000000u) >> 24) |
+         ((value & 0x00ff0000u) >>  8) |
+         ((value & 0x0000ff00u) <<  8) |
+         ((value & 0x000000ffu) << 24);
+#endif
+}
+
+static inline uint64_t byteSwap64(uint64_t value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return value;
+#else
+  return (((uint64_t) byteSwap32(value)) << 32) | byteSwap32(value >> 32);
+#endif
+}
+
 static void serializeString(const std::string& t, OutStream& stream)
 {
   ::serializeInt(t.length(), stream);
@@ -211,15 +290,152 @@ void hadoop::IBinArchive::deserialize(double& t, const char* tag)
 
 void hadoop::IBinArchive::deserialize(std::string& t, const char* tag)
 {
-  ::deserializeString(t, stream);
+  if (pool == NULL) {
+    ::deserializeString(t, stream);
+    return;
+  }
+  int32_t len = 0;
+  ::deserializeInt(len, stream);
+  if (len <= 0) {
+    t.clear();
+    return;
+  }
+  if ((size_t) len > StringPool::kMaxLength) {
+    // too long to pool, read straight into the caller's string
+    t.resize(len);
+    if (len != stream.read(&t[0], len)) {
+      throw new IOException("Error deserializing string.");
+    }
+    return;
+  }
+  const char* direct = stream.readDirect(len);
+  if (direct == NULL) {
+    scratch.resize(len);
+    if (len != stream.read(&scratch[0], len)) {
+      throw new IOException("Error deserializing string.");
+    }
+    direct = scratch.data();
+  }
+  pool->intern(direct, len, t);
 }
 
 void hadoop::IBinArchive::deserialize(std::string& t, size_t& len, const char* tag)
 {
-  ::deserializeString(t, stream);
+  deserialize(t, tag);
   len = t.length();
 }
 
+void hadoop::IBinArchive::deserializeView(StringView& t, const char* tag)
+{
+  int32_t len = 0;
+  ::deserializeInt(len, stream);
+  if (len <= 0) {
+    t = StringView("", 0);
+    return;
+  }
+  const char* direct = stream.readDirect(len);
+  if (direct != NULL) {
+    t = StringView(direct, len);
+    return;
+  }
+  scratch.resize(len);
+  if (len != stream.read(&scratch[0], len)) {
+    throw new IOException("Error deserializing string.");
+  }
+  t = StringView(scratch.data(), len);
+}
+
+void hadoop::IBinArchive::skipBytes(size_t len, const char* tag)
+{
+  while (len > 0) {
+    size_t chunk = (len < 4096) ? len : 4096;
+    if (stream.readDirect(chunk) == NULL) {
+      if (scratch.size() < chunk) {
+        scratch.resize(chunk);
+      }
+      if ((ssize_t)chunk != stream.read(&scratch[0], chunk)) {
+        throw new IOException("Error skipping bytes.");
+      }
+    }
+    len -= chunk;
+  }
+}
+
+void hadoop::IBinArchive::skipVInt(const char* tag)
+{
+  int8_t b;
+  if (1 != stream.read(&b, 1)) {
+    throw new IOException("Error deserializing long.");
+  }
+  if (b < -112) {
+    int8_t len = (b < -120) ? -(b + 120) : -(b + 112);
+    skipBytes(len, tag);
+  }
+}
+
+void hadoop::IBinArchive::skipBlob(const char* tag)
+{
+  int64_t len = 0;
+  ::deserializeLong(len, stream);
+  if (len > 0) {
+    skipBytes(len, tag);
+  }
+}
+
+void hadoop::IBinArchive::deserialize(int32_t* values, size_t count,
+                                      const char* tag)
+{
+  for (size_t cur = 0; cur < count; cur++) {
+    deserialize(values[cur], tag);
+  }
+}
+
+void hadoop::IBinArchive::deserialize(int64_t* values, size_t count,
+                                      const char* tag)
+{
+  for (size_t cur = 0; cur < count; cur++) {
+    ::deserializeLong(values[cur], stream);
+  }
+}
+
+void hadoop::IBinArchive::deserialize(float* values, size_t count,
+                                      const char* tag)
+{
+  uint32_t buffer[1024];
+  while (count > 0) {
+    size_t chunk = count < 1024 ? count : 1024;
+    size_t bytes = chunk * sizeof(uint32_t);
+    if (bytes != (size_t) stream.read(buffer, bytes)) {
+      throw new IOException("Error deserializing float array.");
+    }
+    for (size_t cur = 0; cur < chunk; cur++) {
+      buffer[cur] = byteSwap32(buffer[cur]);
+    }
+    memcpy(values, buffer, bytes);
+    values += chunk;
+    count -= chunk;
+  }
+}
+
+void hadoop::IBinArchive::deserialize(double* values, size_t count,
+                                      const char* tag)
+{
+  uint64_t buffer[512];
+  while (count > 0) {
+    size_t chunk = count < 512 ? count : 512;
+    size_t bytes = chunk * sizeof(uint64_t);
+    if (bytes != (size_t) stream.read(buffer, bytes)) {
+      throw new IOException("Error deserializing double array.");
+    }
+    for (size_t cur = 0; cur < chunk; cur++) {
+      buffer[cur] = byteSwap64(buffer[cur]);
+    }
+    memcpy(values, buffer, bytes);
+    values += chunk;
+    count -= chunk;
+  }
+}
+
 void hadoop::IBinArchive::startRecord(Record& s, const char* tag)
 {
 }
@@ -299,6 +515,71 @@ void hadoop::OBinArchive::serialize(const std::string& t, size_t len, const char
   ::serializeString(t, stream);
 }
 
+void hadoop::OBinArchive::serialize(const int32_t* values, size_t count,
+                                    const char* tag)
+{
+  char buffer[4096];
+  size_t used = 0;
+  for (size_t cur = 0; cur < count; cur++) {
+    if (used + 9 > sizeof(buffer)) {
+      if (used != (size_t) stream.write(buffer, used)) {
+        throw new IOException("Error serializing data.");
+      }
+      used = 0;
+    }
+    used += ::encodeLong(values[cur], buffer + used);
+  }
+  if (used > 0) {
+    if (used != (size_t) stream.write(buffer, used)) {
+      throw new IOException("Error serializing data.");
+    }
+  }
+}
+
+void hadoop::OBinArchive::serialize(const int64_t* values, size_t count,
+                                    const char* tag)
+{
+  ::serializeLongArray(values, count, stream);
+}
+
+void hadoop::OBinArchive::serialize(const float* values, size_t count,
+                                    const char* tag)
+{
+  uint32_t buffer[1024];
+  while (count > 0) {
+    size_t chunk = count < 1024 ? count : 1024;
+    size_t bytes = chunk * sizeof(uint32_t);
+    memcpy(buffer, values, bytes);
+    for (size_t cur = 0; cur < chunk; cur++) {
+      buffer[cur] = byteSwap32(buffer[cur]);
+    }
+    if (bytes != (size_t) stream.write(buffer, bytes)) {
+      throw new IOException("Error serializing float array.");
+    }
+    values += chunk;
+    count -= chunk;
+  }
+}
+
+void hadoop::OBinArchive::serialize(const double* values, size_t count,
+                                    const char* tag)
+{
+  uint64_t buffer[512];
+  while (count > 0) {
+    size_t chunk = count < 512 ? count : 512;
+    size_t bytes = chunk * sizeof(uint64_t);
+    memcpy(buffer, values, bytes);
+    for (size_t cur = 0; cur < chunk; cur++) {
+      buffer[cur] = byteSwap64(buffer[cur]);
+    }
+    if (bytes != (size_t) stream.write(buffer, bytes)) {
+      throw new IOException("Error serializing double array.");
+    }
+    values += chunk;
+    count -= chunk;
+  }
+}
+
 void hadoop::OBinArchive::startRecord(const Record& s, const char* tag)
 {
 }
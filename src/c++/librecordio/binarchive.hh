@@ -23,6 +23,8 @@
 
 namespace hadoop {
 
+class StringPool;
+
 class BinIndex : public Index {
 private:
   size_t size;
@@ -33,11 +35,44 @@ public:
   ~BinIndex() {}
 };
   
+/**
+ * A read-only (pointer, length) pair describing the bytes of a string
+ * field. Views handed out by deserializeView point into the stream's
+ * buffer and are only valid until the archive advances, so callers
+ * that keep a field must materialize it first.
+ */
+class StringView {
+private:
+  const char* mData;
+  size_t mLength;
+public:
+  StringView() : mData(NULL), mLength(0) {}
+  StringView(const char* data_, size_t length_)
+    : mData(data_), mLength(length_) {}
+  const char* data() const { return mData; }
+  size_t length() const { return mLength; }
+
+  /**
+   * Copy the viewed bytes into an owned string.
+   */
+  void materialize(std::string& t) const { t.assign(mData, mLength); }
+};
+
 class IBinArchive : public IArchive {
 private:
   InStream& stream;
+  std::string scratch;
+  StringPool* pool;
 public:
-  IBinArchive(InStream& _stream) : stream(_stream) {}
+  IBinArchive(InStream& _stream) : stream(_stream), pool(NULL) {}
+
+  /**
+   * Attach a string interning pool. While a pool is set, short string
+   * fields are deserialized through it so repeated values share the
+   * pooled copies. The pool is borrowed, not owned, and may be shared
+   * by several archives; pass NULL to detach it.
+   */
+  void setStringPool(StringPool* pool_) { pool = pool_; }
   virtual void deserialize(int8_t& t, const char* tag);
   virtual void deserialize(bool& t, const char* tag);
   virtual void deserialize(int32_t& t, const char* tag);
@@ -46,6 +81,38 @@ public:
   virtual void deserialize(double& t, const char* tag);
   virtual void deserialize(std::string& t, const char* tag);
   virtual void deserialize(std::string& t, size_t& len, const char* tag);
+
+  /**
+   * Deserialize a string field as a view instead of a copy. When the
+   * stream can expose its buffer the view points straight into it;
+   * otherwise the bytes are staged in a scratch buffer owned by the
+   * archive. Either way the view is only valid until the archive
+   * advances.
+   */
+  void deserializeView(StringView& t, const char* tag);
+
+  /**
+   * Discard the next len bytes of the stream.
+   */
+  void skipBytes(size_t len, const char* tag);
+
+  /**
+   * Discard the next vint-encoded value without decoding it.
+   */
+  void skipVInt(const char* tag);
+
+  /**
+   * Discard a length-prefixed field (a string or buffer).
+   */
+  void skipBlob(const char* tag);
+
+  // both kinds of blob skip via the length header, no materialization
+  virtual void skipString(const char* tag) { skipBlob(tag); }
+  virtual void skipBuffer(const char* tag) { skipBlob(tag); }
+  virtual void deserialize(int32_t* values, size_t count, const char* tag);
+  virtual void deserialize(int64_t* values, size_t count, const char* tag);
+  virtual void deserialize(float* values, size_t count, const char* tag);
+  virtual void deserialize(double* values, size_t count, const char* tag);
   virtual void startRecord(Record& s, const char* tag);
   virtual void endRecord(Record& s, const char* tag);
   virtual Index* startVector(const char* tag);
@@ -68,6 +135,10 @@ public:
   virtual void serialize(double t, const char* tag);
   virtual void serialize(const std::string& t, const char* tag);
   virtual void serialize(const std::string& t, size_t len, const char* tag);
+  virtual void serialize(const int32_t* values, size_t count, const char* tag);
+  virtual void serialize(const int64_t* values, size_t count, const char* tag);
+  virtual void serialize(const float* values, size_t count, const char* tag);
+  virtual void serialize(const double* values, size_t count, const char* tag);
   virtual void startRecord(const Record& s, const char* tag);
   virtual void endRecord(const Record& s, const char* tag);
   virtual void startVector(size_t len, const char* tag);
@@ -0,0 +1,408 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "blockio.hh"
+#include "binarchive.hh"
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+using namespace hadoop;
+
+static const char BLOCK_MAGIC[4] = { 'H', 'R', 'B', '1' };
+static const char FOOTER_MAGIC[4] = { 'H', 'R', 'B', 'I' };
+
+/**
+ * An OutStream that appends to a string, used to stage the records of
+ * a block so its length is known before anything hits the file.
+ */
+class StringOutStream : public OutStream {
+private:
+  std::string& buffer;
+public:
+  StringOutStream(std::string& buffer_) : buffer(buffer_) {}
+  ssize_t write(const void* buf, size_t len) {
+    buffer.append((const char*) buf, len);
+    return len;
+  }
+};
+
+static void encodeLong(int64_t t, std::string& buffer)
+{
+  if (t >= -112 && t <= 127) {
+    buffer.append(1, (char) t);
+    return;
+  }
+
+  int8_t len = -112;
+  uint64_t value = t;
+  if (t < 0) {
+    value = ~value; // take one's complement
+    len = -120;
+  }
+
+  uint64_t tmp = value;
+  while (tmp != 0) {
+    tmp = tmp >> 8;
+    len--;
+  }
+
+  buffer.append(1, (char) len);
+  int bytes = (len < -120) ? -(len + 120) : -(len + 112);
+
+  for (int idx = bytes; idx != 0; idx--) {
+    buffer.append(1, (char) (value >> ((idx - 1) * 8)));
+  }
+}
+
+static int64_t decodeLong(InStream& stream)
+{
+  int8_t b;
+  if (1 != stream.read(&b, 1)) {
+    throw new IOException("Error reading container length.");
+  }
+  if (b >= -112) {
+    return b;
+  }
+  bool isNegative = (b < -120);
+  int len = isNegative ? -(b + 120) : -(b + 112);
+  int64_t t = 0;
+  for (int idx = 0; idx < len; idx++) {
+    uint8_t byte;
+    if (1 != stream.read(&byte, 1)) {
+      throw new IOException("Error reading container length.");
+    }
+    t = (t << 8) | byte;
+  }
+  if (isNegative) {
+    t ^= 0xFFFFFFFFFFFFFFFFLL;
+  }
+  return t;
+}
+
+hadoop::BlockRecordWriter::BlockRecordWriter(OutStream& stream_,
+                                             size_t blockSize_)
+  : stream(stream_)
+{
+  blockSize = blockSize_;
+  bufferRecords = 0;
+  bytesWritten = 0;
+  finished = false;
+  // derive a per-file sync marker from the clock and the pid
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  uint64_t seed = tv.tv_sec * 1000000ull + tv.tv_usec + getpid();
+  for (int i = 0; i < 16; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    sync[i] = (char) (seed >> 56);
+  }
+  writeRaw(BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+  writeRaw(sync, sizeof(sync));
+}
+
+void hadoop::BlockRecordWriter::writeRaw(const void* data, size_t len)
+{
+  if (len != (size_t) stream.write(data, len)) {
+    throw new IOException("Error writing container data.");
+  }
+  bytesWritten += len;
+}
+
+void hadoop::BlockRecordWriter::write(const hadoop::Record& record)
+{
+  StringOutStream memStream(buffer);
+  OBinArchive archive(memStream);
+  record.serialize(archive, (const char*) NULL);
+  bufferRecords += 1;
+  if (buffer.length() >= blockSize) {
+    flushBlock();
+  }
+}
+
+void hadoop::BlockRecordWriter::flushBlock()
+{
+  if (bufferRecords == 0) {
+    return;
+  }
+  blockOffsets.push_back(bytesWritten);
+  blockRecords.push_back(bufferRecords);
+  std::string header;
+  encodeLong(bufferRecords, header);
+  encodeLong(kCodecRaw, header);
+  encodeLong(buffer.length(), header);
+  writeRaw(sync, sizeof(sync));
+  writeRaw(header.data(), header.length());
+  writeRaw(buffer.data(), buffer.length());
+  buffer.clear();
+  bufferRecords = 0;
+}
+
+void hadoop::BlockRecordWriter::finish()
+{
+  if (finished) {
+    return;
+  }
+  flushBlock();
+  uint64_t footerOffset = bytesWritten;
+  std::string footer;
+  encodeLong(blockOffsets.size(), footer);
+  for (size_t i = 0; i < blockOffsets.size(); i++) {
+    encodeLong(blockOffsets[i], footer);
+    encodeLong(blockRecords[i], footer);
+  }
+  writeRaw(footer.data(), footer.length());
+  char trailer[12];
+  for (int i = 0; i < 8; i++) {
+    trailer[i] = (char) (footerOffset >> ((7 - i) * 8));
+  }
+  memcpy(trailer + 8, FOOTER_MAGIC, 4);
+  writeRaw(trailer, sizeof(trailer));
+  finished = true;
+}
+
+hadoop::BlockRecordWriter::~BlockRecordWriter()
+{
+  if (!finished) {
+    finish();
+  }
+}
+
+hadoop::BlockRecordReader::BlockRecordReader(FileInStream& stream_)
+  : stream(stream_)
+{
+  char magic[4];
+  if (sizeof(magic) != stream.read(magic, sizeof(magic)) ||
+      memcmp(magic, BLOCK_MAGIC, sizeof(magic)) != 0) {
+    throw new IOException("Not a block container file.");
+  }
+  if (sizeof(sync) != stream.read(sync, sizeof(sync))) {
+    throw new IOException("Error reading container sync marker.");
+  }
+  size_t fileLength = stream.length();
+  if (fileLength < 12 || !stream.seekTo(fileLength - 12)) {
+    throw new IOException("Error seeking to container trailer.");
+  }
+  char trailer[12];
+  if (sizeof(trailer) != stream.read(trailer, sizeof(trailer)) ||
+      memcmp(trailer + 8, FOOTER_MAGIC, 4) != 0) {
+    throw new IOException("Missing container footer; file not finished?");
+  }
+  uint64_t footerOffset = 0;
+  for (int i = 0; i < 8; i++) {
+    footerOffset = (footerOffset << 8) | (uint8_t) trailer[i];
+  }
+  if (!stream.seekTo(footerOffset)) {
+    throw new IOException("Error seeking to container footer.");
+  }
+  uint64_t blocks = decodeLong(stream);
+  for (uint64_t i = 0; i < blocks; i++) {
+    blockOffsets.push_back(decodeLong(stream));
+    blockRecords.push_back(decodeLong(stream));
+  }
+  currentBlock = 0;
+  lastBlock = blockOffsets.size();
+  recordsLeft = 0;
+  archive = new IBinArchive(stream);
+}
+
+void hadoop::BlockRecordReader::readBlockHeader()
+{
+  if (!stream.seekTo(blockOffsets[currentBlock])) {
+    throw new IOException("Error seeking to container block.");
+  }
+  char marker[16];
+  if (sizeof(marker) != stream.read(marker, sizeof(marker)) ||
+      memcmp(marker, sync, sizeof(sync)) != 0) {
+    throw new IOException("Sync marker mismatch; container corrupt.");
+  }
+  recordsLeft = decodeLong(stream);
+  int64_t codec = decodeLong(stream);
+  if (codec != kCodecRaw) {
+    throw new IOException("Unknown container block codec.");
+  }
+  decodeLong(stream); // block byte length, implied by the record count
+}
+
+bool hadoop::BlockRecordReader::next(hadoop::Record& record)
+{
+  while (recordsLeft == 0) {
+    if (currentBlock == lastBlock) {
+      return false;
+    }
+    readBlockHeader();
+    currentBlock += 1;
+  }
+  record.deserialize(*archive, (const char*) NULL);
+  recordsLeft -= 1;
+  return true;
+}
+
+uint64_t hadoop::BlockRecordReader::getRecordCount() const
+{
+  uint64_t total = 0;
+  for (size_t i = 0; i < blockRecords.size(); i++) {
+    total += blockRecords[i];
+  }
+  return total;
+}
+
+void hadoop::BlockRecordReader::seekToRecord(uint64_t ordinal,
+                                             hadoop::Record& scratch)
+{
+  uint64_t before = 0;
+  size_t block = 0;
+  while (block < blockRecords.size() &&
+         before + blockRecords[block] <= ordinal) {
+    before += blockRecords[block];
+    block += 1;
+  }
+  if (block == blockRecords.size()) {
+    throw new IOException("Record ordinal past the end of the container.");
+  }
+  currentBlock = block;
+  lastBlock = blockOffsets.size();
+  recordsLeft = 0;
+  for (uint64_t skip = ordinal - before; skip > 0; skip--) {
+    if (!next(scratch)) {
+      throw new IOException("Error skipping to record ordinal.");
+    }
+  }
+}
+
+void hadoop::BlockRecordReader::setRange(uint64_t begin, uint64_t end)
+{
+  currentBlock = 0;
+  while (currentBlock < blockOffsets.size() &&
+         blockOffsets[currentBlock] < begin) {
+    currentBlock += 1;
+  }
+  lastBlock = currentBlock;
+  while (lastBlock < blockOffsets.size() && blockOffsets[lastBlock] < end) {
+    lastBlock += 1;
+  }
+  recordsLeft = 0;
+}
+
+size_t hadoop::BlockRecordReader::getBlockCount() const
+{
+  return blockOffsets.size();
+}
+
+void hadoop::BlockRecordReader::setBlocks(size_t first, size_t last)
+{
+  currentBlock = first < blockOffsets.size() ? first : blockOffsets.size();
+  lastBlock = last < blockOffsets.size() ? last : blockOffsets.size();
+  if (lastBlock < currentBlock) {
+    lastBlock = currentBlock;
+  }
+  recordsLeft = 0;
+}
+
+hadoop::BlockRecordReader::~BlockRecordReader()
+{
+  delete archive;
+}
+
+namespace {
+  struct ReaderWorker {
+    const std::string* path;
+    size_t firstBlock;
+    size_t lastBlock;
+    hadoop::Record* record;
+    hadoop::ParallelRecordReader::RecordHandler* handler;
+    int index;
+    bool failed;
+    std::string error;
+  };
+}
+
+static void* readerWorkerMain(void* ptr)
+{
+  ReaderWorker* worker = (ReaderWorker*) ptr;
+  try {
+    FileInStream in;
+    if (!in.open(*worker->path)) {
+      throw new IOException("Error opening " + *worker->path);
+    }
+    BlockRecordReader reader(in);
+    reader.setBlocks(worker->firstBlock, worker->lastBlock);
+    while (reader.next(*worker->record)) {
+      worker->handler->handle(*worker->record, worker->index);
+    }
+    in.close();
+  } catch (IOException* error) {
+    worker->failed = true;
+    worker->error = error->getMessage();
+    delete error;
+  }
+  return NULL;
+}
+
+hadoop::ParallelRecordReader::ParallelRecordReader(const std::string& path_,
+                                                   int workers_)
+{
+  path = path_;
+  workers = workers_ > 0 ? workers_ : 1;
+}
+
+void hadoop::ParallelRecordReader::read(RecordFactory& factory,
+                                        RecordHandler& handler)
+{
+  size_t blocks;
+  {
+    FileInStream in;
+    if (!in.open(path)) {
+      throw new IOException("Error opening " + path);
+    }
+    BlockRecordReader reader(in);
+    blocks = reader.getBlockCount();
+    in.close();
+  }
+  size_t threads = (size_t) workers < blocks ? workers : blocks;
+  if (threads == 0) {
+    return;
+  }
+  std::vector<ReaderWorker> states(threads);
+  std::vector<pthread_t> ids(threads);
+  for (size_t i = 0; i < threads; i++) {
+    states[i].path = &path;
+    states[i].firstBlock = blocks * i / threads;
+    states[i].lastBlock = blocks * (i + 1) / threads;
+    states[i].record = factory.create();
+    states[i].handler = &handler;
+    states[i].index = (int) i;
+    states[i].failed = false;
+  }
+  for (size_t i = 0; i < threads; i++) {
+    pthread_create(&ids[i], NULL, readerWorkerMain, &states[i]);
+  }
+  std::string firstError;
+  bool anyFailed = false;
+  for (size_t i = 0; i < threads; i++) {
+    pthread_join(ids[i], NULL);
+    if (states[i].failed && !anyFailed) {
+      anyFailed = true;
+      firstError = states[i].error;
+    }
+    delete states[i].record;
+  }
+  if (anyFailed) {
+    throw new IOException(firstError);
+  }
+}
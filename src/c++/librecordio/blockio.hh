@@ -0,0 +1,176 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOCKIO_HH_
+#define BLOCKIO_HH_
+
+#include "recordio.hh"
+#include "filestream.hh"
+
+#include <pthread.h>
+
+namespace hadoop {
+
+/**
+ * The per-block codec. Only raw blocks are written today; the byte is
+ * in the format so compressed blocks can be added without breaking
+ * readers.
+ */
+enum BlockCodec { kCodecRaw = 0 };
+
+/**
+ * Writes records into a splittable block container. Records are
+ * binary-serialized into block-sized groups, each preceded by a
+ * 16-byte sync marker, a record count, a codec byte, and a byte
+ * length, and the file ends with a footer index of block offsets and
+ * record counts so readers can seek by record ordinal or divide the
+ * file by byte range without scanning it. finish() must be called to
+ * write the last block and the footer.
+ */
+class BlockRecordWriter {
+private:
+  OutStream& stream;
+  size_t blockSize;
+  char sync[16];
+  std::string buffer;
+  size_t bufferRecords;
+  size_t bytesWritten;
+  std::vector<uint64_t> blockOffsets;
+  std::vector<uint64_t> blockRecords;
+  bool finished;
+  void flushBlock();
+  void writeRaw(const void* data, size_t len);
+public:
+  BlockRecordWriter(OutStream& stream_, size_t blockSize_ = 1024 * 1024);
+  void write(const hadoop::Record& record);
+
+  /**
+   * Write the pending block and the footer index. No records may be
+   * written afterwards.
+   */
+  void finish();
+  virtual ~BlockRecordWriter();
+};
+
+/**
+ * Reads a container written by BlockRecordWriter. The footer index is
+ * loaded up front, so seeking to a record ordinal or restricting the
+ * reader to a byte range of the file costs one seek. A byte range
+ * covers the blocks whose sync marker starts inside it, so workers
+ * that split a file on arbitrary boundaries each see every record
+ * exactly once.
+ */
+class BlockRecordReader {
+private:
+  FileInStream& stream;
+  char sync[16];
+  std::vector<uint64_t> blockOffsets;
+  std::vector<uint64_t> blockRecords;
+  size_t currentBlock;
+  size_t lastBlock;
+  uint64_t recordsLeft;
+  IArchive* archive;
+  void readBlockHeader();
+public:
+  BlockRecordReader(FileInStream& stream_);
+
+  /**
+   * Read the next record.
+   * @return true if a record was read, false at the end of the range
+   */
+  bool next(hadoop::Record& record);
+
+  /**
+   * The number of records in the file.
+   */
+  uint64_t getRecordCount() const;
+
+  /**
+   * Position the reader on the record with the given ordinal. Records
+   * before it inside the same block are decoded into scratch and
+   * discarded, since the format has no intra-block offsets.
+   */
+  void seekToRecord(uint64_t ordinal, hadoop::Record& scratch);
+
+  /**
+   * Restrict the reader to the blocks whose start lies in
+   * [begin, end) and position it on the first of them.
+   */
+  void setRange(uint64_t begin, uint64_t end);
+
+  /**
+   * The number of blocks in the container.
+   */
+  size_t getBlockCount() const;
+
+  /**
+   * Restrict the reader to blocks [first, last) and position it on
+   * the first of them.
+   */
+  void setBlocks(size_t first, size_t last);
+  virtual ~BlockRecordReader();
+};
+
+/**
+ * Decodes one container file on a pool of threads. The blocks are
+ * divided into contiguous runs, one per worker, and each worker opens
+ * its own stream over the file and delivers its records through the
+ * caller's handler, so an idle many-core box decodes a file at the
+ * speed of its disks instead of one core.
+ */
+class ParallelRecordReader {
+public:
+  /**
+   * Creates the record instance each worker decodes into. Called once
+   * per worker before the threads start.
+   */
+  class RecordFactory {
+  public:
+    virtual hadoop::Record* create() = 0;
+    virtual ~RecordFactory() {}
+  };
+
+  /**
+   * Receives the decoded records. handle is called concurrently from
+   * all workers, each with its own record instance and worker index,
+   * so implementations must either be thread-safe or shard their
+   * state by worker.
+   */
+  class RecordHandler {
+  public:
+    virtual void handle(hadoop::Record& record, int worker) = 0;
+    virtual ~RecordHandler() {}
+  };
+
+  /**
+   * Read the given container file with the given number of workers.
+   */
+  ParallelRecordReader(const std::string& path_, int workers_);
+
+  /**
+   * Decode every record in the file, blocking until all workers are
+   * done. Throws IOException* if any worker fails.
+   */
+  void read(RecordFactory& factory, RecordHandler& handler);
+private:
+  std::string path;
+  int workers;
+};
+
+}
+#endif /*BLOCKIO_HH_*/
@@ -0,0 +1,405 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "colarchive.hh"
+#include "typeIDs.hh"
+
+#include <map>
+
+// per-column encodings in the block format
+static const int8_t COL_ENC_PLAIN = 0;
+static const int8_t COL_ENC_DELTA = 1;
+static const int8_t COL_ENC_DICT  = 2;
+
+hadoop::ColColumn& hadoop::OColArchive::column(int8_t type)
+{
+  if (fieldIndex == columns.size()) {
+    if (rows > 0) {
+      throw new IOException("Columnar records must have a fixed field layout.");
+    }
+    columns.push_back(new ColColumn(type));
+  }
+  ColColumn& c = *columns[fieldIndex];
+  if (c.type != type) {
+    throw new IOException("Columnar records must have a fixed field layout.");
+  }
+  fieldIndex++;
+  return c;
+}
+
+void hadoop::OColArchive::serialize(int8_t t, const char* tag)
+{
+  column(RIOTYPE_BYTE).longs.push_back(t);
+}
+
+void hadoop::OColArchive::serialize(bool t, const char* tag)
+{
+  column(RIOTYPE_BOOL).longs.push_back(t ? 1 : 0);
+}
+
+void hadoop::OColArchive::serialize(int32_t t, const char* tag)
+{
+  column(RIOTYPE_INT).longs.push_back(t);
+}
+
+void hadoop::OColArchive::serialize(int64_t t, const char* tag)
+{
+  column(RIOTYPE_LONG).longs.push_back(t);
+}
+
+void hadoop::OColArchive::serialize(float t, const char* tag)
+{
+  column(RIOTYPE_FLOAT).doubles.push_back(t);
+}
+
+void hadoop::OColArchive::serialize(double t, const char* tag)
+{
+  column(RIOTYPE_DOUBLE).doubles.push_back(t);
+}
+
+void hadoop::OColArchive::serialize(const std::string& t, const char* tag)
+{
+  column(RIOTYPE_STRING).strings.push_back(t);
+}
+
+void hadoop::OColArchive::serialize(const std::string& t, size_t len,
+                                    const char* tag)
+{
+  column(RIOTYPE_BUFFER).strings.push_back(t);
+}
+
+void hadoop::OColArchive::startRecord(const Record& s, const char* tag)
+{
+  if (depth == 0) {
+    fieldIndex = 0;
+  }
+  depth++;
+}
+
+void hadoop::OColArchive::endRecord(const Record& s, const char* tag)
+{
+  depth--;
+  if (depth == 0) {
+    rows++;
+    if (rows >= blockRecords) {
+      flush();
+    }
+  }
+}
+
+void hadoop::OColArchive::startVector(size_t len, const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+void hadoop::OColArchive::endVector(size_t len, const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+void hadoop::OColArchive::startMap(size_t len, const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+void hadoop::OColArchive::endMap(size_t len, const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+void hadoop::OColArchive::writeLongColumn(ColColumn& c)
+{
+  // sorted columns delta-encode down to small vints
+  bool sorted = true;
+  for (size_t idx = 1; idx < c.longs.size(); idx++) {
+    if (c.longs[idx] < c.longs[idx-1]) {
+      sorted = false;
+      break;
+    }
+  }
+  if (sorted && c.longs.size() > 1) {
+    bin.serialize(COL_ENC_DELTA, "enc");
+    bin.serialize(c.longs[0], "v");
+    for (size_t idx = 1; idx < c.longs.size(); idx++) {
+      bin.serialize(c.longs[idx] - c.longs[idx-1], "v");
+    }
+  } else {
+    bin.serialize(COL_ENC_PLAIN, "enc");
+    for (size_t idx = 0; idx < c.longs.size(); idx++) {
+      bin.serialize(c.longs[idx], "v");
+    }
+  }
+}
+
+void hadoop::OColArchive::writeStringColumn(ColColumn& c)
+{
+  // dictionary-encode when the distinct values pay for themselves
+  std::map<std::string, int64_t> dict;
+  for (size_t idx = 0; idx < c.strings.size(); idx++) {
+    dict.insert(std::make_pair(c.strings[idx], (int64_t) dict.size()));
+  }
+  if (dict.size() * 2 <= c.strings.size()) {
+    bin.serialize(COL_ENC_DICT, "enc");
+    bin.serialize((int64_t) dict.size(), "size");
+    // entries go out in insertion order so indexes stay stable
+    std::vector<const std::string*> entries(dict.size());
+    typedef std::map<std::string, int64_t>::const_iterator CI;
+    for (CI cur = dict.begin(); cur != dict.end(); cur++) {
+      entries[cur->second] = &(cur->first);
+    }
+    for (size_t idx = 0; idx < entries.size(); idx++) {
+      bin.serialize(*(entries[idx]), "v");
+    }
+    for (size_t idx = 0; idx < c.strings.size(); idx++) {
+      bin.serialize(dict[c.strings[idx]], "v");
+    }
+  } else {
+    bin.serialize(COL_ENC_PLAIN, "enc");
+    for (size_t idx = 0; idx < c.strings.size(); idx++) {
+      bin.serialize(c.strings[idx], "v");
+    }
+  }
+}
+
+void hadoop::OColArchive::flush()
+{
+  if (rows == 0) {
+    return;
+  }
+  bin.serialize((int64_t) rows, "rows");
+  bin.serialize((int32_t) columns.size(), "cols");
+  for (size_t idx = 0; idx < columns.size(); idx++) {
+    ColColumn& c = *columns[idx];
+    bin.serialize(c.type, "type");
+    switch (c.type) {
+    case RIOTYPE_BOOL:
+    case RIOTYPE_BYTE:
+    case RIOTYPE_INT:
+    case RIOTYPE_LONG:
+      writeLongColumn(c);
+      break;
+    case RIOTYPE_FLOAT:
+      bin.serialize(COL_ENC_PLAIN, "enc");
+      for (size_t row = 0; row < c.doubles.size(); row++) {
+        bin.serialize((float) c.doubles[row], "v");
+      }
+      break;
+    case RIOTYPE_DOUBLE:
+      bin.serialize(COL_ENC_PLAIN, "enc");
+      for (size_t row = 0; row < c.doubles.size(); row++) {
+        bin.serialize(c.doubles[row], "v");
+      }
+      break;
+    case RIOTYPE_STRING:
+    case RIOTYPE_BUFFER:
+      writeStringColumn(c);
+      break;
+    default:
+      throw new IOException("Unknown column type.");
+    }
+    c.longs.clear();
+    c.doubles.clear();
+    c.strings.clear();
+  }
+  rows = 0;
+}
+
+hadoop::OColArchive::~OColArchive()
+{
+  flush();
+  for (size_t idx = 0; idx < columns.size(); idx++) {
+    delete columns[idx];
+  }
+}
+
+void hadoop::IColArchive::loadBlock()
+{
+  int64_t blockRows = 0;
+  bin.deserialize(blockRows, "rows");
+  int32_t cols = 0;
+  bin.deserialize(cols, "cols");
+  if (blockRows <= 0 || cols <= 0) {
+    throw new IOException("Error deserializing columnar block.");
+  }
+  if (columns.size() == 0) {
+    for (int32_t idx = 0; idx < cols; idx++) {
+      columns.push_back(new ColColumn(0));
+    }
+  } else if ((size_t) cols != columns.size()) {
+    throw new IOException("Error deserializing columnar block.");
+  }
+  rows = blockRows;
+  row = 0;
+  for (int32_t idx = 0; idx < cols; idx++) {
+    ColColumn& c = *columns[idx];
+    bin.deserialize(c.type, "type");
+    int8_t enc = 0;
+    bin.deserialize(enc, "enc");
+    switch (c.type) {
+    case RIOTYPE_BOOL:
+    case RIOTYPE_BYTE:
+    case RIOTYPE_INT:
+    case RIOTYPE_LONG:
+      c.longs.resize(rows);
+      bin.deserialize(&c.longs[0], rows, "v");
+      if (enc == COL_ENC_DELTA) {
+        for (size_t cur = 1; cur < rows; cur++) {
+          c.longs[cur] += c.longs[cur-1];
+        }
+      }
+      break;
+    case RIOTYPE_FLOAT:
+      c.doubles.resize(rows);
+      for (size_t cur = 0; cur < rows; cur++) {
+        float f = 0;
+        bin.deserialize(f, "v");
+        c.doubles[cur] = f;
+      }
+      break;
+    case RIOTYPE_DOUBLE:
+      c.doubles.resize(rows);
+      bin.deserialize(&c.doubles[0], rows, "v");
+      break;
+    case RIOTYPE_STRING:
+    case RIOTYPE_BUFFER:
+      if (enc == COL_ENC_DICT) {
+        c.isDict = true;
+        int64_t size = 0;
+        bin.deserialize(size, "size");
+        c.strings.resize(size);
+        for (int64_t cur = 0; cur < size; cur++) {
+          bin.deserialize(c.strings[cur], "v");
+        }
+        c.longs.resize(rows);
+        bin.deserialize(&c.longs[0], rows, "v");
+      } else {
+        c.isDict = false;
+        c.strings.resize(rows);
+        for (size_t cur = 0; cur < rows; cur++) {
+          bin.deserialize(c.strings[cur], "v");
+        }
+      }
+      break;
+    default:
+      throw new IOException("Error deserializing columnar block.");
+    }
+  }
+}
+
+hadoop::ColColumn& hadoop::IColArchive::column(int8_t type)
+{
+  if (fieldIndex >= columns.size()) {
+    throw new IOException("Columnar records must have a fixed field layout.");
+  }
+  ColColumn& c = *columns[fieldIndex];
+  if (c.type != type) {
+    throw new IOException("Field type does not match the column.");
+  }
+  fieldIndex++;
+  return c;
+}
+
+void hadoop::IColArchive::deserialize(int8_t& t, const char* tag)
+{
+  t = (int8_t) column(RIOTYPE_BYTE).longs[row];
+}
+
+void hadoop::IColArchive::deserialize(bool& t, const char* tag)
+{
+  t = (column(RIOTYPE_BOOL).longs[row] != 0);
+}
+
+void hadoop::IColArchive::deserialize(int32_t& t, const char* tag)
+{
+  t = (int32_t) column(RIOTYPE_INT).longs[row];
+}
+
+void hadoop::IColArchive::deserialize(int64_t& t, const char* tag)
+{
+  t = column(RIOTYPE_LONG).longs[row];
+}
+
+void hadoop::IColArchive::deserialize(float& t, const char* tag)
+{
+  t = (float) column(RIOTYPE_FLOAT).doubles[row];
+}
+
+void hadoop::IColArchive::deserialize(double& t, const char* tag)
+{
+  t = column(RIOTYPE_DOUBLE).doubles[row];
+}
+
+void hadoop::IColArchive::deserialize(std::string& t, const char* tag)
+{
+  ColColumn& c = column(RIOTYPE_STRING);
+  t = c.isDict ? c.strings[c.longs[row]] : c.strings[row];
+}
+
+void hadoop::IColArchive::deserialize(std::string& t, size_t& len,
+                                      const char* tag)
+{
+  ColColumn& c = column(RIOTYPE_BUFFER);
+  t = c.isDict ? c.strings[c.longs[row]] : c.strings[row];
+  len = t.length();
+}
+
+void hadoop::IColArchive::startRecord(Record& s, const char* tag)
+{
+  if (depth == 0) {
+    if (row >= rows) {
+      loadBlock();
+    }
+    fieldIndex = 0;
+  }
+  depth++;
+}
+
+void hadoop::IColArchive::endRecord(Record& s, const char* tag)
+{
+  depth--;
+  if (depth == 0) {
+    row++;
+  }
+}
+
+hadoop::Index* hadoop::IColArchive::startVector(const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+void hadoop::IColArchive::endVector(Index* idx, const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+hadoop::Index* hadoop::IColArchive::startMap(const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+void hadoop::IColArchive::endMap(Index* idx, const char* tag)
+{
+  throw new IOException("Columnar records cannot have vector or map fields.");
+}
+
+hadoop::IColArchive::~IColArchive()
+{
+  for (size_t idx = 0; idx < columns.size(); idx++) {
+    delete columns[idx];
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COLARCHIVE_HH_
+#define COLARCHIVE_HH_
+
+#include "recordio.hh"
+#include "binarchive.hh"
+
+namespace hadoop {
+
+/**
+ * Column-major storage shared by the columnar reader and writer. One
+ * column holds every value of one field position across a block of
+ * records; which member vector is live depends on the column's
+ * RIOTYPE_* value.
+ */
+struct ColColumn {
+  int8_t type;
+  std::vector<int64_t> longs;       // BOOL, BYTE, INT, LONG, dict indexes
+  std::vector<double> doubles;      // FLOAT, DOUBLE
+  std::vector<std::string> strings; // STRING, BUFFER, dict entries
+  bool isDict;                      // reader: strings is a dictionary
+                                    // indexed by longs
+  ColColumn(int8_t type_) : type(type_), isDict(false) {}
+};
+
+/**
+ * Writes records field-major: blocks of up to blockRecords records
+ * are buffered in columns, then each block is emitted as all of
+ * field 1's values, then all of field 2's, and so on. Sorted integer
+ * columns are delta-encoded and low-cardinality string columns are
+ * dictionary-encoded, so analytical data commonly comes out smaller
+ * than the row-oriented binary format as well as scanning faster.
+ *
+ * Records must have a fixed layout of scalar and string fields;
+ * vector and map fields are not supported. The writer buffers a
+ * partial block, so callers must flush() before closing the
+ * underlying stream.
+ */
+class OColArchive : public OArchive {
+private:
+  OBinArchive bin;
+  std::vector<ColColumn*> columns;
+  size_t blockRecords;
+  size_t fieldIndex;
+  size_t rows;
+  int depth;
+  ColColumn& column(int8_t type);
+  void writeLongColumn(ColColumn& c);
+  void writeStringColumn(ColColumn& c);
+public:
+  OColArchive(OutStream& _stream, size_t _blockRecords = 1024)
+    : bin(_stream), blockRecords(_blockRecords), fieldIndex(0),
+      rows(0), depth(0) {}
+  virtual void serialize(int8_t t, const char* tag);
+  virtual void serialize(bool t, const char* tag);
+  virtual void serialize(int32_t t, const char* tag);
+  virtual void serialize(int64_t t, const char* tag);
+  virtual void serialize(float t, const char* tag);
+  virtual void serialize(double t, const char* tag);
+  virtual void serialize(const std::string& t, const char* tag);
+  virtual void serialize(const std::string& t, size_t len, const char* tag);
+  virtual void startRecord(const Record& s, const char* tag);
+  virtual void endRecord(const Record& s, const char* tag);
+  virtual void startVector(size_t len, const char* tag);
+  virtual void endVector(size_t len, const char* tag);
+  virtual void startMap(size_t len, const char* tag);
+  virtual void endMap(size_t len, const char* tag);
+  /** Write out the buffered block, if any. */
+  virtual void flush();
+  virtual ~OColArchive();
+};
+
+/**
+ * Reads blocks written by OColArchive, serving each record's fields
+ * from the loaded columns so records deserialize through the usual
+ * Record::deserialize interface.
+ */
+class IColArchive : public IArchive {
+private:
+  IBinArchive bin;
+  std::vector<ColColumn*> columns;
+  size_t fieldIndex;
+  size_t rows;
+  size_t row;
+  int depth;
+  void loadBlock();
+  ColColumn& column(int8_t type);
+public:
+  IColArchive(InStream& _stream)
+    : bin(_stream), fieldIndex(0), rows(0), row(0), depth(0) {}
+  virtual void deserialize(int8_t& t, const char* tag);
+  virtual void deserialize(bool& t, const char* tag);
+  virtual void deserialize(int32_t& t, const char* tag);
+  virtual void deserialize(int64_t& t, const char* tag);
+  virtual void deserialize(float& t, const char* tag);
+  virtual void deserialize(double& t, const char* tag);
+  virtual void deserialize(std::string& t, const char* tag);
+  virtual void deserialize(std::string& t, size_t& len, const char* tag);
+  virtual void startRecord(Record& s, const char* tag);
+  virtual void endRecord(Record& s, const char* tag);
+  virtual Index* startVector(const char* tag);
+  virtual void endVector(Index* idx, const char* tag);
+  virtual Index* startMap(const char* tag);
+  virtual void endMap(Index* idx, const char* tag);
+  virtual ~IColArchive();
+};
+
+}; // end namespace hadoop
+#endif /*COLARCHIVE_HH_*/
@@ -21,121 +21,161 @@
 
 using namespace hadoop;
 
-static std::string readUptoTerminator(PushBackInStream& stream)
+/**
+ * Read the field ending at the next ',', '\n' or '}' into s. The
+ * buffered spans are scanned with memchr and appended whole, instead
+ * of a read and a push_back per character. A ',' terminator is
+ * consumed; the other two are left in the stream, as before.
+ */
+static void readUptoTerminator(PushBackInStream& stream, std::string& s)
 {
-  std::string s;
+  s.clear();
   while (1) {
-    char c;
-    if (1 != stream.read(&c, 1)) {
+    size_t avail;
+    const char* base = stream.peek(avail);
+    if (avail == 0) {
       throw new IOException("Error in deserialization.");
     }
-    if (c == ',' || c == '\n' || c == '}') {
-      if (c != ',') {
-        stream.pushBack(c);
-      }
-      break;
+    // narrow the span to the earliest of the three terminators
+    const char* term = (const char*) memchr(base, ',', avail);
+    size_t span = (term == NULL) ? avail : term - base;
+    const char* other = (const char*) memchr(base, '\n', span);
+    if (other != NULL) {
+      term = other;
+      span = other - base;
+    }
+    other = (const char*) memchr(base, '}', span);
+    if (other != NULL) {
+      term = other;
+      span = other - base;
     }
-    s.push_back(c);
+    if (term == NULL) {
+      s.append(base, avail);
+      stream.consume(avail);
+      continue;
+    }
+    s.append(base, span);
+    stream.consume(span + (*term == ',' ? 1 : 0));
+    return;
   }
-  return s;
 }
 
 void hadoop::ICsvArchive::deserialize(int8_t& t, const char* tag)
 {
-  std::string s = readUptoTerminator(stream);
-  t = (int8_t) strtol(s.c_str(), NULL, 10);
+  readUptoTerminator(stream, scratch);
+  t = (int8_t) strtol(scratch.c_str(), NULL, 10);
 }
 
 void hadoop::ICsvArchive::deserialize(bool& t, const char* tag)
 {
-  std::string s = readUptoTerminator(stream);
-  t = (s == "T") ? true : false;
+  readUptoTerminator(stream, scratch);
+  t = (scratch == "T") ? true : false;
 }
 
 void hadoop::ICsvArchive::deserialize(int32_t& t, const char* tag)
 {
-  std::string s = readUptoTerminator(stream);
-  t = strtol(s.c_str(), NULL, 10);
+  readUptoTerminator(stream, scratch);
+  t = strtol(scratch.c_str(), NULL, 10);
 }
 
 void hadoop::ICsvArchive::deserialize(int64_t& t, const char* tag)
 {
-  std::string s = readUptoTerminator(stream);
-  t = strtoll(s.c_str(), NULL, 10);
+  readUptoTerminator(stream, scratch);
+  t = strtoll(scratch.c_str(), NULL, 10);
 }
 
 void hadoop::ICsvArchive::deserialize(float& t, const char* tag)
 {
-  std::string s = readUptoTerminator(stream);
-  t = strtof(s.c_str(), NULL);
+  readUptoTerminator(stream, scratch);
+  t = strtof(scratch.c_str(), NULL);
 }
 
 void hadoop::ICsvArchive::deserialize(double& t, const char* tag)
 {
-  std::string s = readUptoTerminator(stream);
-  t = strtod(s.c_str(), NULL);
+  readUptoTerminator(stream, scratch);
+  t = strtod(scratch.c_str(), NULL);
 }
 
 void hadoop::ICsvArchive::deserialize(std::string& t, const char* tag)
 {
-  std::string temp = readUptoTerminator(stream);
-  if (temp[0] != '\'') {
+  readUptoTerminator(stream, scratch);
+  if (scratch.length() == 0 || scratch[0] != '\'') {
     throw new IOException("Errror deserializing string.");
   }
   t.clear();
-  // skip first character, replace escaped characters 
-  int len = temp.length();
-  for (int i = 1; i < len; i++) {
-    char c = temp.at(i);
-    if (c == '%') {
-      // since we escape '%', there have to be at least two chars following a '%'
-      char ch1 = temp.at(i+1);
-      char ch2 = temp.at(i+2);
-      i += 2;
-	  if (ch1 == '0' && ch2 == '0') {
-	    t.append(1, '\0');
-	  } else if (ch1 == '0' && ch2 == 'A') {
-	    t.append(1, '\n');
-	  } else if (ch1 == '0' && ch2 == 'D') {
-	    t.append(1, '\r');
-	  } else if (ch1 == '2' && ch2 == 'C') {
-	    t.append(1, ',');
-	  } else if (ch1 == '7' && ch2 == 'D') {
-	    t.append(1, '}');
-	  } else if (ch1 == '2' && ch2 == '5') {
-	    t.append(1, '%');
-	  } else {
-	    throw new IOException("Error deserializing string.");
-	  }
-    } 
-    else {
-      t.append(1, c);
+  // skip first character, copy the spans between escapes whole and
+  // decode the escaped characters
+  const char* cur = scratch.data() + 1;
+  const char* end = scratch.data() + scratch.length();
+  while (cur < end) {
+    const char* escape = (const char*) memchr(cur, '%', end - cur);
+    if (escape == NULL) {
+      t.append(cur, end - cur);
+      break;
+    }
+    t.append(cur, escape - cur);
+    // since we escape '%', there have to be at least two chars following a '%'
+    if (end - escape < 3) {
+      throw new IOException("Error deserializing string.");
+    }
+    char ch1 = escape[1];
+    char ch2 = escape[2];
+    if (ch1 == '0' && ch2 == '0') {
+      t.append(1, '\0');
+    } else if (ch1 == '0' && ch2 == 'A') {
+      t.append(1, '\n');
+    } else if (ch1 == '0' && ch2 == 'D') {
+      t.append(1, '\r');
+    } else if (ch1 == '2' && ch2 == 'C') {
+      t.append(1, ',');
+    } else if (ch1 == '7' && ch2 == 'D') {
+      t.append(1, '}');
+    } else if (ch1 == '2' && ch2 == '5') {
+      t.append(1, '%');
+    } else {
+      throw new IOException("Error deserializing string.");
     }
+    cur = escape + 3;
+  }
+}
+
+/**
+ * The value of a hex digit, or -1 if it isn't one.
+ */
+static int hexValue(char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
   }
+  return -1;
 }
 
 void hadoop::ICsvArchive::deserialize(std::string& t, size_t& len, const char* tag)
 {
-  std::string s = readUptoTerminator(stream);
-  if (s[0] != '#') {
+  readUptoTerminator(stream, scratch);
+  if (scratch.length() == 0 || scratch[0] != '#') {
     throw new IOException("Errror deserializing buffer.");
   }
-  s.erase(0, 1); /// erase first character
-  len = s.length();
+  len = scratch.length() - 1;
   if (len%2 == 1) { // len is guaranteed to be even
     throw new IOException("Errror deserializing buffer.");
   }
   len = len >> 1;
+  const char* cur = scratch.data() + 1;
   for (size_t idx = 0; idx < len; idx++) {
-    char buf[3];
-    buf[0] = s[2*idx];
-    buf[1] = s[2*idx+1];
-    buf[2] = '\0';
-    int i;
-    if (1 != sscanf(buf, "%2x", &i)) {
+    // the writer space-pads single-digit values, as %2x does
+    int hi = (cur[2*idx] == ' ') ? 0 : hexValue(cur[2*idx]);
+    int lo = hexValue(cur[2*idx+1]);
+    if (hi < 0 || lo < 0) {
       throw new IOException("Errror deserializing buffer.");
     }
-    t.push_back((char) i);
+    t.push_back((char) ((hi << 4) | lo));
   }
   len = t.length();
 }
@@ -166,7 +206,7 @@ void hadoop::ICsvArchive::endRecord(Record& s, const char* tag)
   } else if (mark != '}') {
     throw new IOException("Error deserializing record.");
   } else {
-    readUptoTerminator(stream);
+    readUptoTerminator(stream, scratch);
   }
 }
 
@@ -192,7 +232,7 @@ void hadoop::ICsvArchive::endVector(Index* idx, const char* tag)
   if (mark != '}') {
     throw new IOException("Error deserializing vector.");
   }
-  readUptoTerminator(stream);
+  readUptoTerminator(stream, scratch);
 }
 
 Index* hadoop::ICsvArchive::startMap(const char* tag)
@@ -218,7 +258,7 @@ void hadoop::ICsvArchive::endMap(Index* idx, const char* tag)
   if (mark != '}') {
     throw new IOException("Error deserializing map.");
   }
-  readUptoTerminator(stream);
+  readUptoTerminator(stream, scratch);
 }
 
 hadoop::ICsvArchive::~ICsvArchive()
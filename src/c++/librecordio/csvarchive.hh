@@ -21,37 +21,95 @@
 
 #include "recordio.hh"
 
+#include <string.h>
+
 namespace hadoop {
 
+/**
+ * A buffered reader over the archive's stream. Bytes are pulled from
+ * the stream in blocks so the parser can scan whole spans for
+ * terminators instead of reading a character at a time; peek() and
+ * consume() expose the buffered span for that. A single character of
+ * push-back is supported on top.
+ */
 class PushBackInStream {
 private:
   InStream* stream;
   bool isAvail;
   char pbchar;
+  char buffer[8192];
+  size_t pos;
+  size_t limit;
 public:
   void setStream(InStream* stream_) {
     stream = stream_;
     isAvail = false;
     pbchar = 0;
+    pos = 0;
+    limit = 0;
   }
   ssize_t read(void* buf, size_t len) {
+    char* p = (char*) buf;
+    size_t done = 0;
     if (len > 0 && isAvail) {
-      char* p = (char*) buf;
-      *p = pbchar;
+      p[done++] = pbchar;
       isAvail = false;
-      if (len > 1) {
-        ssize_t ret = stream->read((char*)buf + 1, len - 1);
-        return ret + 1;
-      } else {
-        return 1;
+    }
+    while (done < len) {
+      if (pos == limit) {
+        ssize_t got = stream->read(buffer, sizeof(buffer));
+        if (got <= 0) {
+          break;
+        }
+        pos = 0;
+        limit = got;
       }
-    } else {
-      return stream->read(buf, len);
+      size_t chunk = len - done;
+      if (chunk > limit - pos) {
+        chunk = limit - pos;
+      }
+      memcpy(p + done, buffer + pos, chunk);
+      pos += chunk;
+      done += chunk;
     }
+    return done;
   }
   void pushBack(char c) {
-    pbchar = c;
-    isAvail = true;
+    if (pos > 0) {
+      buffer[--pos] = c;
+    } else {
+      pbchar = c;
+      isAvail = true;
+    }
+  }
+
+  /**
+   * The unread bytes currently buffered, filling from the stream if
+   * none are. avail is 0 only at the end of the stream. The span is
+   * valid until the next read, peek or consume.
+   */
+  const char* peek(size_t& avail) {
+    if (isAvail) {
+      // pushBack only takes this path when the buffer is empty
+      buffer[0] = pbchar;
+      pos = 0;
+      limit = 1;
+      isAvail = false;
+    }
+    if (pos == limit) {
+      ssize_t got = stream->read(buffer, sizeof(buffer));
+      pos = 0;
+      limit = (got <= 0) ? 0 : got;
+    }
+    avail = limit - pos;
+    return buffer + pos;
+  }
+
+  /**
+   * Discard the first n bytes of the last peeked span.
+   */
+  void consume(size_t n) {
+    pos += n;
   }
 };
 
@@ -75,6 +133,7 @@ public:
 class ICsvArchive : public IArchive {
 private:
   PushBackInStream stream;
+  std::string scratch;
 public:
   ICsvArchive(InStream& _stream) { stream.setStream(&_stream); }
   virtual void deserialize(int8_t& t, const char* tag);
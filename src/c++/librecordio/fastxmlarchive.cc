@@ -0,0 +1,540 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fastxmlarchive.hh"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace hadoop;
+
+static char hexchars[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+                          'A', 'B', 'C', 'D', 'E', 'F' };
+
+static uint8_t h2b(char ch) {
+  if ((ch >= '0') && (ch <= '9')) {
+    return ch - '0';
+  }
+  if ((ch >= 'a') && (ch <= 'f')) {
+    return ch - 'a' + 10;
+  }
+  if ((ch >= 'A') && (ch <= 'F')) {
+    return ch - 'A' + 10;
+  }
+  return 0;
+}
+
+bool hadoop::IFastXmlArchive::fill()
+{
+  ssize_t got = stream.read(buffer, sizeof(buffer));
+  pos = 0;
+  limit = (got <= 0) ? 0 : got;
+  return limit > 0;
+}
+
+char hadoop::IFastXmlArchive::getChar()
+{
+  if (pos == limit && !fill()) {
+    throw new IOException("Unexpected end of XML stream.");
+  }
+  return buffer[pos++];
+}
+
+/**
+ * Skip whitespace and read the name of the next tag, without its
+ * angle brackets.
+ */
+void hadoop::IFastXmlArchive::readTag(std::string& tag)
+{
+  tag.clear();
+  char c = getChar();
+  while (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+    c = getChar();
+  }
+  if (c != '<') {
+    throw new IOException("Error parsing XML stream.");
+  }
+  while (1) {
+    if (pos == limit && !fill()) {
+      throw new IOException("Unexpected end of XML stream.");
+    }
+    const char* end = (const char*) memchr(buffer + pos, '>', limit - pos);
+    if (end == NULL) {
+      tag.append(buffer + pos, limit - pos);
+      pos = limit;
+      continue;
+    }
+    tag.append(buffer + pos, end - (buffer + pos));
+    pos = (end - buffer) + 1;
+    return;
+  }
+}
+
+/**
+ * Read the element text up to the next tag, which is left in the
+ * stream. Whitespace is preserved.
+ */
+void hadoop::IFastXmlArchive::readText(std::string& text)
+{
+  text.clear();
+  while (1) {
+    if (pos == limit && !fill()) {
+      throw new IOException("Unexpected end of XML stream.");
+    }
+    const char* next = (const char*) memchr(buffer + pos, '<', limit - pos);
+    if (next == NULL) {
+      text.append(buffer + pos, limit - pos);
+      pos = limit;
+      continue;
+    }
+    text.append(buffer + pos, next - (buffer + pos));
+    pos = next - buffer;
+    return;
+  }
+}
+
+/**
+ * Advance to the next structural or value token, stepping over the
+ * member/name/value envelope. Leaves the token's type in curType and
+ * its raw text in curText.
+ */
+void hadoop::IFastXmlArchive::nextToken()
+{
+  while (1) {
+    readTag(curType);
+    if (curType == "member" || curType == "/member" ||
+        curType == "value" || curType == "/value") {
+      continue;
+    }
+    if (curType == "name") {
+      readText(curText);
+      readTag(closeTag);
+      if (closeTag != "/name") {
+        throw new IOException("Error parsing XML stream.");
+      }
+      continue;
+    }
+    if (curType == "struct" || curType == "/struct" ||
+        curType == "array" || curType == "/array") {
+      curText.clear();
+      return;
+    }
+    if (curType == "boolean" || curType == "ex:i1" || curType == "i4" ||
+        curType == "int" || curType == "ex:i8" || curType == "ex:float" ||
+        curType == "double" || curType == "string") {
+      readText(curText);
+      readTag(closeTag);
+      if (closeTag.length() != curType.length() + 1 || closeTag[0] != '/' ||
+          0 != closeTag.compare(1, curType.length(), curType)) {
+        throw new IOException("Error parsing XML stream.");
+      }
+      return;
+    }
+    throw new IOException("Unknown element in XML stream.");
+  }
+}
+
+const std::string& hadoop::IFastXmlArchive::peekType()
+{
+  if (!peeked) {
+    nextToken();
+    peeked = true;
+  }
+  return curType;
+}
+
+void hadoop::IFastXmlArchive::expectToken(const char* type, const char* what)
+{
+  if (peeked) {
+    peeked = false;
+  } else {
+    nextToken();
+  }
+  if (curType != type) {
+    throw new IOException(std::string("Error deserializing ") + what);
+  }
+}
+
+void hadoop::IFastXmlArchive::deserialize(int8_t& t, const char* tag)
+{
+  expectToken("ex:i1", "byte");
+  t = (int8_t) strtol(curText.c_str(), NULL, 10);
+}
+
+void hadoop::IFastXmlArchive::deserialize(bool& t, const char* tag)
+{
+  expectToken("boolean", "boolean");
+  t = (curText == "1");
+}
+
+void hadoop::IFastXmlArchive::deserialize(int32_t& t, const char* tag)
+{
+  if (peeked) {
+    peeked = false;
+  } else {
+    nextToken();
+  }
+  if (curType != "i4" && curType != "int") {
+    throw new IOException("Error deserializing int");
+  }
+  t = (int32_t) strtol(curText.c_str(), NULL, 10);
+}
+
+void hadoop::IFastXmlArchive::deserialize(int64_t& t, const char* tag)
+{
+  expectToken("ex:i8", "long");
+  t = strtoll(curText.c_str(), NULL, 10);
+}
+
+void hadoop::IFastXmlArchive::deserialize(float& t, const char* tag)
+{
+  expectToken("ex:float", "float");
+  t = strtof(curText.c_str(), NULL);
+}
+
+void hadoop::IFastXmlArchive::deserialize(double& t, const char* tag)
+{
+  expectToken("double", "double");
+  t = strtod(curText.c_str(), NULL);
+}
+
+void hadoop::IFastXmlArchive::deserialize(std::string& t, const char* tag)
+{
+  expectToken("string", "string");
+  t.clear();
+  // decode the entities and '%' escapes, copying the clean spans
+  // between them whole
+  const char* cur = curText.data();
+  const char* end = cur + curText.length();
+  while (cur < end) {
+    const char* esc = cur;
+    while (esc < end && *esc != '&' && *esc != '%') {
+      esc++;
+    }
+    t.append(cur, esc - cur);
+    if (esc == end) {
+      break;
+    }
+    if (*esc == '&') {
+      if (end - esc >= 4 && 0 == memcmp(esc, "&lt;", 4)) {
+        t.append(1, '<');
+        cur = esc + 4;
+      } else if (end - esc >= 5 && 0 == memcmp(esc, "&amp;", 5)) {
+        t.append(1, '&');
+        cur = esc + 5;
+      } else {
+        throw new IOException("Error deserializing string");
+      }
+    } else {
+      // '%00' followed by two hex digits
+      if (end - esc < 5) {
+        throw new IOException("Error deserializing string");
+      }
+      t.append(1, (char) (h2b(esc[3])*16 + h2b(esc[4])));
+      cur = esc + 5;
+    }
+  }
+}
+
+void hadoop::IFastXmlArchive::deserialize(std::string& t, size_t& len,
+                                          const char* tag)
+{
+  expectToken("string", "buffer");
+  len = curText.length();
+  if (len%2 == 1) { // len is guaranteed to be even
+    throw new IOException("Errror deserializing buffer.");
+  }
+  len = len >> 1;
+  const char* cur = curText.data();
+  for (size_t idx = 0; idx < len; idx++) {
+    t.push_back((char) (h2b(cur[2*idx])*16 + h2b(cur[2*idx+1])));
+  }
+  len = t.length();
+}
+
+void hadoop::IFastXmlArchive::startRecord(Record& s, const char* tag)
+{
+  expectToken("struct", "record");
+}
+
+void hadoop::IFastXmlArchive::endRecord(Record& s, const char* tag)
+{
+  expectToken("/struct", "record");
+}
+
+Index* hadoop::IFastXmlArchive::startVector(const char* tag)
+{
+  expectToken("array", "vector");
+  return new FastXmlIndex(*this);
+}
+
+void hadoop::IFastXmlArchive::endVector(Index* idx, const char* tag)
+{
+  expectToken("/array", "vector");
+  delete idx;
+}
+
+Index* hadoop::IFastXmlArchive::startMap(const char* tag)
+{
+  expectToken("array", "map");
+  return new FastXmlIndex(*this);
+}
+
+void hadoop::IFastXmlArchive::endMap(Index* idx, const char* tag)
+{
+  expectToken("/array", "map");
+  delete idx;
+}
+
+// the escape for each byte on the write side, or length 0 for bytes
+// written as themselves
+static char escapeText[256][6];
+static uint8_t escapeLength[256];
+static bool escapeTableBuilt = false;
+
+static void buildEscapeTable()
+{
+  memset(escapeLength, 0, sizeof(escapeLength));
+  for (int ch = 0; ch < 0x20; ch++) {
+    escapeText[ch][0] = '%';
+    escapeText[ch][1] = '0';
+    escapeText[ch][2] = '0';
+    escapeText[ch][3] = hexchars[ch/16];
+    escapeText[ch][4] = hexchars[ch%16];
+    escapeLength[ch] = 5;
+  }
+  memcpy(escapeText['<'], "&lt;", 4);
+  escapeLength['<'] = 4;
+  memcpy(escapeText['&'], "&amp;", 5);
+  escapeLength['&'] = 5;
+  memcpy(escapeText['%'], "%0025", 5);
+  escapeLength['%'] = 5;
+  escapeTableBuilt = true;
+}
+
+static const size_t FLUSH_THRESHOLD = 64 * 1024;
+
+hadoop::OFastXmlArchive::OFastXmlArchive(OutStream& _stream)
+  : stream(_stream)
+{
+  if (!escapeTableBuilt) {
+    buildEscapeTable();
+  }
+  buffer.reserve(FLUSH_THRESHOLD + 1024);
+}
+
+void hadoop::OFastXmlArchive::put(const char* s)
+{
+  buffer.append(s);
+}
+
+void hadoop::OFastXmlArchive::putEscaped(const char* data, size_t len)
+{
+  size_t clean = 0;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t ch = data[i];
+    if (escapeLength[ch] != 0) {
+      buffer.append(data + clean, i - clean);
+      buffer.append(escapeText[ch], escapeLength[ch]);
+      clean = i + 1;
+    }
+  }
+  buffer.append(data + clean, len - clean);
+}
+
+void hadoop::OFastXmlArchive::printBeginEnvelope(const char* tag)
+{
+  if (cstack.size() != 0 && cstack.back() == 'r') {
+    put("<member>\n");
+    put("<name>");
+    put(tag);
+    put("</name>\n");
+    put("<value>");
+  } else {
+    put("<value>");
+  }
+}
+
+void hadoop::OFastXmlArchive::printEndEnvelope(const char* tag)
+{
+  if (cstack.size() != 0 && cstack.back() == 'r') {
+    put("</value>\n");
+    put("</member>\n");
+  } else {
+    put("</value>\n");
+  }
+}
+
+void hadoop::OFastXmlArchive::maybeFlush()
+{
+  // flush between top-level values, so nothing is left buffered when
+  // the caller closes the stream out from under us, and inside big
+  // records once enough has accumulated
+  if (cstack.size() == 0 || buffer.length() >= FLUSH_THRESHOLD) {
+    flush();
+  }
+}
+
+void hadoop::OFastXmlArchive::flush()
+{
+  if (buffer.length() > 0) {
+    stream.write(buffer.data(), buffer.length());
+    buffer.clear();
+  }
+}
+
+void hadoop::OFastXmlArchive::serialize(int8_t t, const char* tag)
+{
+  printBeginEnvelope(tag);
+  char sval[32];
+  sprintf(sval, "<ex:i1>%d</ex:i1>", t);
+  put(sval);
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::serialize(bool t, const char* tag)
+{
+  printBeginEnvelope(tag);
+  put(t ? "<boolean>1</boolean>" : "<boolean>0</boolean>");
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::serialize(int32_t t, const char* tag)
+{
+  printBeginEnvelope(tag);
+  char sval[64];
+  sprintf(sval, "<i4>%d</i4>", t);
+  put(sval);
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::serialize(int64_t t, const char* tag)
+{
+  printBeginEnvelope(tag);
+  char sval[64];
+  sprintf(sval, "<ex:i8>%lld</ex:i8>", (long long) t);
+  put(sval);
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::serialize(float t, const char* tag)
+{
+  printBeginEnvelope(tag);
+  char sval[64];
+  sprintf(sval, "<ex:float>%f</ex:float>", t);
+  put(sval);
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::serialize(double t, const char* tag)
+{
+  printBeginEnvelope(tag);
+  char sval[64];
+  sprintf(sval, "<double>%lf</double>", t);
+  put(sval);
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::serialize(const std::string& t, const char* tag)
+{
+  printBeginEnvelope(tag);
+  put("<string>");
+  putEscaped(t.data(), t.length());
+  put("</string>");
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::serialize(const std::string& t, size_t len,
+                                        const char* tag)
+{
+  printBeginEnvelope(tag);
+  put("<string>");
+  for (size_t idx = 0; idx < len; idx++) {
+    uint8_t b = t[idx];
+    buffer.append(1, hexchars[b/16]);
+    buffer.append(1, hexchars[b%16]);
+  }
+  put("</string>");
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::startRecord(const Record& s, const char* tag)
+{
+  printBeginEnvelope(tag);
+  cstack.push_back('r');
+  put("<struct>\n");
+}
+
+void hadoop::OFastXmlArchive::endRecord(const Record& s, const char* tag)
+{
+  put("</struct>\n");
+  if (cstack.size() == 0 || cstack.back() != 'r') {
+    throw new IOException("Error serializing record.");
+  }
+  cstack.pop_back();
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::startVector(size_t len, const char* tag)
+{
+  printBeginEnvelope(tag);
+  cstack.push_back('v');
+  put("<array>\n");
+}
+
+void hadoop::OFastXmlArchive::endVector(size_t len, const char* tag)
+{
+  put("</array>\n");
+  if (cstack.size() == 0 || cstack.back() != 'v') {
+    throw new IOException("Error serializing vector.");
+  }
+  cstack.pop_back();
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+void hadoop::OFastXmlArchive::startMap(size_t len, const char* tag)
+{
+  printBeginEnvelope(tag);
+  cstack.push_back('m');
+  put("<array>\n");
+}
+
+void hadoop::OFastXmlArchive::endMap(size_t len, const char* tag)
+{
+  put("</array>\n");
+  if (cstack.size() == 0 || cstack.back() != 'm') {
+    throw new IOException("Error serializing map.");
+  }
+  cstack.pop_back();
+  printEndEnvelope(tag);
+  maybeFlush();
+}
+
+hadoop::OFastXmlArchive::~OFastXmlArchive()
+{
+  flush();
+}
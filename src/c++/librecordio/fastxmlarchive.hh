@@ -0,0 +1,132 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FASTXMLARCHIVE_HH_
+#define FASTXMLARCHIVE_HH_
+
+#include "recordio.hh"
+
+namespace hadoop {
+
+/**
+ * A fast reader for the XML record format. IXmlArchive parses the
+ * whole stream through a SAX parser up front, transcoding and
+ * allocating a string per element; this one pulls tokens straight off
+ * buffered input, reusing one tag buffer and one text buffer for the
+ * life of the archive. It reads exactly the XML dialect OXmlArchive
+ * and OFastXmlArchive write, which is what the record I/O platform
+ * produces on every platform; it is not a general XML parser.
+ */
+class IFastXmlArchive : public IArchive {
+private:
+  InStream& stream;
+  char buffer[8192];
+  size_t pos;
+  size_t limit;
+  std::string curType;
+  std::string curText;
+  std::string closeTag;
+  bool peeked;
+  bool fill();
+  char getChar();
+  void readTag(std::string& tag);
+  void readText(std::string& text);
+  void nextToken();
+  void expectToken(const char* type, const char* what);
+public:
+  IFastXmlArchive(InStream& _stream) : stream(_stream) {
+    pos = 0;
+    limit = 0;
+    peeked = false;
+  }
+  virtual void deserialize(int8_t& t, const char* tag);
+  virtual void deserialize(bool& t, const char* tag);
+  virtual void deserialize(int32_t& t, const char* tag);
+  virtual void deserialize(int64_t& t, const char* tag);
+  virtual void deserialize(float& t, const char* tag);
+  virtual void deserialize(double& t, const char* tag);
+  virtual void deserialize(std::string& t, const char* tag);
+  virtual void deserialize(std::string& t, size_t& len, const char* tag);
+  virtual void startRecord(Record& s, const char* tag);
+  virtual void endRecord(Record& s, const char* tag);
+  virtual Index* startVector(const char* tag);
+  virtual void endVector(Index* idx, const char* tag);
+  virtual Index* startMap(const char* tag);
+  virtual void endMap(Index* idx, const char* tag);
+
+  /**
+   * The type of the next token without consuming it. Used by the
+   * vector and map indexes to spot the closing tag.
+   */
+  const std::string& peekType();
+  virtual ~IFastXmlArchive() {}
+};
+
+class FastXmlIndex : public Index {
+private:
+  IFastXmlArchive& archive;
+public:
+  FastXmlIndex(IFastXmlArchive& _archive) : archive(_archive) {}
+  bool done() { return archive.peekType() == "/array"; }
+  void incr() {}
+  ~FastXmlIndex() {}
+};
+
+/**
+ * A fast writer for the XML record format. Byte-compatible with
+ * OXmlArchive, but everything is appended into one reusable buffer
+ * that is flushed to the stream in large writes, and strings are
+ * escaped through a per-byte table instead of a branch chain per
+ * character.
+ */
+class OFastXmlArchive : public OArchive {
+private:
+  OutStream& stream;
+  std::string buffer;
+  std::vector<char> cstack;
+  void put(const char* s);
+  void putEscaped(const char* data, size_t len);
+  void printBeginEnvelope(const char* tag);
+  void printEndEnvelope(const char* tag);
+  void maybeFlush();
+public:
+  OFastXmlArchive(OutStream& _stream);
+  virtual void serialize(int8_t t, const char* tag);
+  virtual void serialize(bool t, const char* tag);
+  virtual void serialize(int32_t t, const char* tag);
+  virtual void serialize(int64_t t, const char* tag);
+  virtual void serialize(float t, const char* tag);
+  virtual void serialize(double t, const char* tag);
+  virtual void serialize(const std::string& t, const char* tag);
+  virtual void serialize(const std::string& t, size_t len, const char* tag);
+  virtual void startRecord(const Record& s, const char* tag);
+  virtual void endRecord(const Record& s, const char* tag);
+  virtual void startVector(size_t len, const char* tag);
+  virtual void endVector(size_t len, const char* tag);
+  virtual void startMap(size_t len, const char* tag);
+  virtual void endMap(size_t len, const char* tag);
+
+  /**
+   * Push the buffered bytes to the stream.
+   */
+  void flush();
+  virtual ~OFastXmlArchive();
+};
+
+}
+#endif /*FASTXMLARCHIVE_HH_*/
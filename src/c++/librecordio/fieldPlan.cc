@@ -0,0 +1,121 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fieldPlan.hh"
+#include "binarchive.hh"
+#include "utils.hh"
+
+using namespace hadoop;
+
+/**
+ * The serialized size of a type in a binary archive, or 0 if it isn't
+ * fixed.
+ */
+static size_t fixedSize(int8_t typeVal)
+{
+  switch (typeVal) {
+  case RIOTYPE_BOOL:
+  case RIOTYPE_BYTE:
+    return 1;
+  case RIOTYPE_FLOAT:
+    return 4;
+  case RIOTYPE_DOUBLE:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+FieldPlan::FieldPlan(const RecordTypeInfo& writer,
+                     const RecordTypeInfo& reader, bool binary)
+{
+  const std::vector<FieldTypeInfo*>& writerFields =
+    writer.getFieldTypeInfos();
+  const std::vector<FieldTypeInfo*>& readerFields =
+    reader.getFieldTypeInfos();
+  for (unsigned int i = 0; i < writerFields.size(); i++) {
+    Action action;
+    action.readerField = -1;
+    action.bytes = 0;
+    action.typeID = NULL;
+    // fields are matched by name and type, as in setupRtiFields()
+    for (unsigned int j = 0; j < readerFields.size(); j++) {
+      if (*(writerFields[i]) == *(readerFields[j])) {
+        action.readerField = j;
+        break;
+      }
+    }
+    if (action.readerField >= 0) {
+      action.op = READ_FIELD;
+      actions.push_back(action);
+      continue;
+    }
+    const TypeID* typeID = writerFields[i]->getTypeID();
+    size_t bytes = binary ? fixedSize(typeID->getTypeVal()) : 0;
+    if (bytes > 0) {
+      // merge runs of fixed-size fields into one skip
+      if (!actions.empty() && actions.back().op == SKIP_BYTES) {
+        actions.back().bytes += bytes;
+        continue;
+      }
+      action.op = SKIP_BYTES;
+      action.bytes = bytes;
+    } else if (binary && (RIOTYPE_INT == typeID->getTypeVal() ||
+                          RIOTYPE_LONG == typeID->getTypeVal())) {
+      action.op = SKIP_VINT;
+    } else if (binary && (RIOTYPE_STRING == typeID->getTypeVal() ||
+                          RIOTYPE_BUFFER == typeID->getTypeVal())) {
+      action.op = SKIP_BLOB;
+    } else {
+      action.op = SKIP_GENERIC;
+      action.typeID = typeID->clone();
+    }
+    actions.push_back(action);
+  }
+}
+
+FieldPlan::~FieldPlan()
+{
+  for (unsigned int i = 0; i < actions.size(); i++) {
+    if (NULL != actions[i].typeID) {
+      delete actions[i].typeID;
+    }
+  }
+}
+
+void FieldPlan::skip(IArchive& a, size_t i, const char* tag) const
+{
+  const Action& action = actions[i];
+  switch (action.op) {
+  case SKIP_BYTES:
+    ((IBinArchive&) a).skipBytes(action.bytes, tag);
+    break;
+  case SKIP_VINT:
+    ((IBinArchive&) a).skipVInt(tag);
+    break;
+  case SKIP_BLOB:
+    ((IBinArchive&) a).skipBlob(tag);
+    break;
+  case SKIP_GENERIC:
+    Utils::skip(a, tag, *action.typeID);
+    break;
+  default:
+    // a read action: the caller must deserialize the field itself
+    throw new IOException("FieldPlan::skip called on a read action");
+  }
+}
@@ -0,0 +1,105 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIELDPLAN_HH_
+#define FIELDPLAN_HH_
+
+#include "recordio.hh"
+#include "recordTypeInfo.hh"
+
+namespace hadoop {
+
+/**
+ * A precompiled deserialization plan for versioned records. The
+ * filtered read path matches the writer's fields against the reader's
+ * for every field of every record and skips unknown fields by walking
+ * their TypeID trees through Utils::skip. A FieldPlan does that
+ * matching and classification once, when the writer's RecordTypeInfo
+ * is known, and boils it down to a flat array of actions: read the
+ * writer's next field into reader field j, skip a known number of
+ * bytes, skip a vint, skip a length-prefixed blob, or (for nested
+ * types) fall back to the generic skip. Consecutive fixed-size skips
+ * are merged into a single action. Reading a record then becomes one
+ * pass over the array:
+ *
+ *   for (size_t i = 0; i < plan.size(); i++) {
+ *     int f = plan.readerField(i);
+ *     if (f < 0) {
+ *       plan.skip(archive, i, tag);
+ *     } else {
+ *       // dispatch on f to deserialize the matching member
+ *     }
+ *   }
+ *
+ * The byte-level skip actions are only emitted when the plan is
+ * compiled with binary set, and may then only be executed against an
+ * IBinArchive; for other archives every unmatched field compiles to
+ * the generic skip.
+ */
+class FieldPlan {
+public:
+  /**
+   * Compile a plan from the writer's type info and the reader's.
+   * Fields are matched by name and type, the same rule the generated
+   * filtered read path uses.
+   * @param writer the RecordTypeInfo the data was written with
+   * @param reader the RecordTypeInfo the reader expects
+   * @param binary whether the plan will run against an IBinArchive
+   */
+  FieldPlan(const RecordTypeInfo& writer, const RecordTypeInfo& reader,
+            bool binary);
+  virtual ~FieldPlan();
+
+  /**
+   * The number of actions in the plan. This can be smaller than the
+   * writer's field count since adjacent fixed-size skips are merged.
+   */
+  size_t size() const { return actions.size(); }
+
+  /**
+   * The reader field index action i reads into, or -1 if the action
+   * is a skip. The index counts the reader's fields in declaration
+   * order.
+   */
+  int readerField(size_t i) const { return actions[i].readerField; }
+
+  /**
+   * Execute skip action i against the archive. Must not be called on
+   * a read action.
+   */
+  void skip(IArchive& a, size_t i, const char* tag) const;
+
+private:
+  enum Op {
+    READ_FIELD,
+    SKIP_BYTES,
+    SKIP_VINT,
+    SKIP_BLOB,
+    SKIP_GENERIC
+  };
+  struct Action {
+    Op op;
+    int readerField;      // >= 0 only for READ_FIELD
+    size_t bytes;         // for SKIP_BYTES
+    const TypeID* typeID; // owned, for SKIP_GENERIC
+  };
+  std::vector<Action> actions;
+};
+
+}
+#endif /*FIELDPLAN_HH_*/
@@ -18,31 +18,191 @@
 
 #include "filestream.hh"
 
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 using namespace hadoop;
 
+static const size_t IN_BUFFER_SIZE = 4 * 1024 * 1024;
+
 hadoop::FileInStream::FileInStream()
 {
   mFile = NULL;
+  mBuffer = NULL;
+  mCapacity = 0;
+  mPos = 0;
+  mLimit = 0;
+  mMapped = false;
 }
 
 bool hadoop::FileInStream::open(const std::string& name)
 {
+  return open(name, false);
+}
+
+bool hadoop::FileInStream::open(const std::string& name, bool memoryMapped)
+{
+  if (memoryMapped) {
+    int fd = ::open(name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) < 0) {
+      ::close(fd);
+      return false;
+    }
+    void* base = NULL;
+    if (fileInfo.st_size > 0) {
+      base = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (base == MAP_FAILED) {
+        ::close(fd);
+        return false;
+      }
+      madvise(base, fileInfo.st_size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+    mBuffer = (char*) base;
+    mCapacity = fileInfo.st_size;
+    mLimit = fileInfo.st_size;
+    mPos = 0;
+    mMapped = true;
+    return true;
+  }
   mFile = fopen(name.c_str(), "rb");
-  return (mFile != NULL);
+  if (mFile == NULL) {
+    return false;
+  }
+  mBuffer = new char[IN_BUFFER_SIZE];
+  mCapacity = IN_BUFFER_SIZE;
+  mPos = 0;
+  mLimit = 0;
+  mMapped = false;
+  return true;
+}
+
+bool hadoop::FileInStream::fill()
+{
+  mPos = 0;
+  mLimit = fread(mBuffer, 1, mCapacity, mFile);
+  return mLimit > 0;
 }
 
 ssize_t hadoop::FileInStream::read(void *buf, size_t len)
 {
-  return fread(buf, 1, len, mFile);
+  size_t available = mLimit - mPos;
+  if (len <= available) {
+    memcpy(buf, mBuffer + mPos, len);
+    mPos += len;
+    return len;
+  }
+  char* output = (char*) buf;
+  memcpy(output, mBuffer + mPos, available);
+  mPos = mLimit;
+  size_t copied = available;
+  if (mMapped) {
+    return copied;
+  }
+  size_t wanted = len - copied;
+  if (wanted >= mCapacity) {
+    // too big to bounce through the buffer
+    return copied + fread(output + copied, 1, wanted, mFile);
+  }
+  if (fill()) {
+    size_t chunk = wanted < mLimit ? wanted : mLimit;
+    memcpy(output + copied, mBuffer, chunk);
+    mPos = chunk;
+    copied += chunk;
+  }
+  return copied;
+}
+
+const char* hadoop::FileInStream::readDirect(size_t len)
+{
+  size_t available = mLimit - mPos;
+  if (len > available) {
+    if (mMapped || mBuffer == NULL || len > mCapacity) {
+      return NULL;
+    }
+    // slide the unread tail down and top the buffer up
+    memmove(mBuffer, mBuffer + mPos, available);
+    mPos = 0;
+    mLimit = available + fread(mBuffer + available, 1,
+                               mCapacity - available, mFile);
+    if (len > mLimit) {
+      return NULL;
+    }
+  }
+  const char* result = mBuffer + mPos;
+  mPos += len;
+  return result;
 }
 
 bool hadoop::FileInStream::skip(size_t nbytes)
 {
-  return (0==fseek(mFile, nbytes, SEEK_CUR));
+  size_t available = mLimit - mPos;
+  if (nbytes <= available) {
+    mPos += nbytes;
+    return true;
+  }
+  if (mMapped) {
+    mPos = mLimit;
+    return false;
+  }
+  mPos = mLimit = 0;
+  return (0==fseek(mFile, nbytes - available, SEEK_CUR));
+}
+
+bool hadoop::FileInStream::seekTo(size_t offset)
+{
+  if (mMapped) {
+    if (offset > mCapacity) {
+      return false;
+    }
+    mPos = offset;
+    return true;
+  }
+  mPos = mLimit = 0;
+  return (0==fseek(mFile, offset, SEEK_SET));
+}
+
+size_t hadoop::FileInStream::tell()
+{
+  if (mMapped) {
+    return mPos;
+  }
+  return ftell(mFile) - (mLimit - mPos);
+}
+
+size_t hadoop::FileInStream::length()
+{
+  if (mMapped) {
+    return mCapacity;
+  }
+  long current = ftell(mFile);
+  fseek(mFile, 0, SEEK_END);
+  long size = ftell(mFile);
+  fseek(mFile, current, SEEK_SET);
+  return size;
 }
 
 bool hadoop::FileInStream::close()
 {
+  if (mMapped) {
+    if (mBuffer != NULL && mCapacity > 0) {
+      munmap(mBuffer, mCapacity);
+    }
+    mBuffer = NULL;
+    mCapacity = mPos = mLimit = 0;
+    mMapped = false;
+    return true;
+  }
+  delete[] mBuffer;
+  mBuffer = NULL;
+  mCapacity = mPos = mLimit = 0;
   int ret = fclose(mFile);
   mFile = NULL;
   return (ret==0);
@@ -50,14 +210,24 @@ bool hadoop::FileInStream::close()
 
 hadoop::FileInStream::~FileInStream()
 {
-  if (mFile != NULL) {
+  if (mFile != NULL || mMapped) {
     close();
   }
 }
 
+static const size_t OUT_BUFFER_SIZE = 4 * 1024 * 1024;
+
 hadoop::FileOutStream::FileOutStream()
 {
   mFile = NULL;
+  mBuffer = NULL;
+  mCapacity = 0;
+  mPos = 0;
+  mFlushRecords = 0;
+  mFlushBytes = 0;
+  mSyncOnFlush = false;
+  mRecordsSinceFlush = 0;
+  mBytesSinceFlush = 0;
 }
 
 bool hadoop::FileOutStream::open(const std::string& name, bool overwrite)
@@ -66,28 +236,110 @@ bool hadoop::FileOutStream::open(const std::string& name, bool overwrite)
     mFile = fopen(name.c_str(), "rb");
     if (mFile != NULL) {
       fclose(mFile);
+      mFile = NULL;
       return false;
     }
   }
   mFile = fopen(name.c_str(), "wb");
-  return (mFile != NULL);
+  if (mFile == NULL) {
+    return false;
+  }
+  mBuffer = new char[OUT_BUFFER_SIZE];
+  mCapacity = OUT_BUFFER_SIZE;
+  mPos = 0;
+  mRecordsSinceFlush = 0;
+  mBytesSinceFlush = 0;
+  return true;
+}
+
+bool hadoop::FileOutStream::flushBuffer()
+{
+  if (mPos > 0) {
+    size_t written = fwrite(mBuffer, 1, mPos, mFile);
+    if (written != mPos) {
+      return false;
+    }
+    mPos = 0;
+  }
+  return true;
 }
 
 ssize_t hadoop::FileOutStream::write(const void* buf, size_t len)
 {
-  return fwrite(buf, 1, len, mFile);
+  if (len >= mCapacity) {
+    // too big to bounce through the buffer
+    if (!flushBuffer()) {
+      return -1;
+    }
+    size_t written = fwrite(buf, 1, len, mFile);
+    mBytesSinceFlush += written;
+    return written;
+  }
+  if (mPos + len > mCapacity && !flushBuffer()) {
+    return -1;
+  }
+  memcpy(mBuffer + mPos, buf, len);
+  mPos += len;
+  mBytesSinceFlush += len;
+  return len;
+}
+
+void hadoop::FileOutStream::setFlushPolicy(size_t records, size_t bytes,
+                                           bool sync)
+{
+  mFlushRecords = records;
+  mFlushBytes = bytes;
+  mSyncOnFlush = sync;
+}
+
+bool hadoop::FileOutStream::markRecord()
+{
+  mRecordsSinceFlush += 1;
+  if ((mFlushRecords > 0 && mRecordsSinceFlush >= mFlushRecords) ||
+      (mFlushBytes > 0 && mBytesSinceFlush >= mFlushBytes)) {
+    return flush();
+  }
+  return true;
+}
+
+bool hadoop::FileOutStream::flush()
+{
+  if (!flushBuffer()) {
+    return false;
+  }
+  if (0 != fflush(mFile)) {
+    return false;
+  }
+  if (mSyncOnFlush && 0 != fdatasync(fileno(mFile))) {
+    return false;
+  }
+  mRecordsSinceFlush = 0;
+  mBytesSinceFlush = 0;
+  return true;
 }
 
 bool hadoop::FileOutStream::advance(size_t nbytes)
 {
+  if (!flushBuffer()) {
+    return false;
+  }
   return (0==fseek(mFile, nbytes, SEEK_CUR));
 }
 
+size_t hadoop::FileOutStream::tell()
+{
+  return ftell(mFile) + mPos;
+}
+
 bool hadoop::FileOutStream::close()
 {
+  bool flushed = flushBuffer();
+  delete[] mBuffer;
+  mBuffer = NULL;
+  mCapacity = mPos = 0;
   int ret = fclose(mFile);
   mFile = NULL;
-  return (ret == 0);
+  return (flushed && ret == 0);
 }
 
 hadoop::FileOutStream::~FileOutStream()
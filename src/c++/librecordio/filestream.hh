@@ -29,26 +29,105 @@ namespace hadoop {
 class FileInStream : public InStream {
 public:
   FileInStream();
+
+  /**
+   * Open the file with a read-ahead buffer, so the small reads the
+   * archive deserializers issue are served with pointer arithmetic
+   * instead of one stdio call per primitive.
+   */
   bool open(const std::string& name);
+
+  /**
+   * Open the file memory-mapped, so reads copy straight out of the
+   * page cache with no buffer in between.
+   * @param name the file to open
+   * @param memoryMapped true to map the file, false for buffered stdio
+   */
+  bool open(const std::string& name, bool memoryMapped);
   ssize_t read(void *buf, size_t buflen);
+  const char* readDirect(size_t len);
   bool skip(size_t nbytes);
+
+  /**
+   * Seek to an absolute byte offset in the file.
+   */
+  bool seekTo(size_t offset);
+
+  /**
+   * The current byte offset in the file.
+   */
+  size_t tell();
+
+  /**
+   * The total length of the file in bytes.
+   */
+  size_t length();
   bool close();
   virtual ~FileInStream();
 private:
+  bool fill();
   FILE *mFile;
+  char *mBuffer;
+  size_t mCapacity;
+  size_t mPos;
+  size_t mLimit;
+  bool mMapped;
 };
 
 
 class FileOutStream: public OutStream {
 public:
   FileOutStream();
+
+  /**
+   * Open the file with a write-behind buffer, so the small writes the
+   * archive serializers issue are coalesced into large sequential
+   * writes instead of one stdio call per primitive.
+   */
   bool open(const std::string& name, bool overwrite);
   ssize_t write(const void* buf, size_t len);
   bool advance(size_t nbytes);
+
+  /**
+   * Control when buffered data reaches the file. A flush happens after
+   * every 'records' record boundaries (see markRecord) or whenever
+   * 'bytes' bytes have accumulated since the last flush, whichever
+   * comes first; either limit may be 0 to disable it. With 'sync' set,
+   * each policy flush is also an fdatasync, making record boundaries
+   * durability points. The default is no policy: data leaves the
+   * buffer only when it fills, on flush(), or on close().
+   */
+  void setFlushPolicy(size_t records, size_t bytes, bool sync);
+
+  /**
+   * Mark a record boundary for the flush policy. Call after each
+   * complete record; a policy flush never splits a record.
+   */
+  bool markRecord();
+
+  /**
+   * Write buffered bytes through to the file now, with an fdatasync
+   * when the policy asks for one.
+   */
+  bool flush();
+
+  /**
+   * The current byte offset in the file.
+   */
+  size_t tell();
   bool close();
   virtual ~FileOutStream();
 private:
+  bool flushBuffer();
   FILE *mFile;
+  char *mBuffer;
+  size_t mCapacity;
+  size_t mPos;
+  size_t mFlushRecords;
+  size_t mFlushBytes;
+  bool mSyncOnFlush;
+  size_t mRecordsSinceFlush;
+  size_t mBytesSinceFlush;
 };
 
 }; // end namespace
@@ -0,0 +1,180 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lazyRecord.hh"
+#include "utils.hh"
+
+#include <string.h>
+
+using namespace hadoop;
+
+void hadoop::BufferInStream::reset(const char* data_, size_t length_)
+{
+  data = data_;
+  length = length_;
+  position = 0;
+}
+
+ssize_t hadoop::BufferInStream::read(void* buf, size_t buflen)
+{
+  if (buflen > length - position) {
+    buflen = length - position;
+  }
+  memcpy(buf, data + position, buflen);
+  position += buflen;
+  return buflen;
+}
+
+const char* hadoop::BufferInStream::readDirect(size_t len)
+{
+  if (len > length - position) {
+    return NULL;
+  }
+  const char* result = data + position;
+  position += len;
+  return result;
+}
+
+LazyRecord::LazyRecord(const RecordTypeInfo& type_)
+  : type(type_), archive(stream)
+{
+}
+
+void LazyRecord::reset(const char* data, size_t length)
+{
+  stream.reset(data, length);
+  const std::vector<FieldTypeInfo*>& fields = type.getFieldTypeInfos();
+  offsets.resize(fields.size() + 1);
+  for (unsigned int i = 0; i < fields.size(); i++) {
+    offsets[i] = stream.tell();
+    switch (fields[i]->getTypeID()->getTypeVal()) {
+    case RIOTYPE_BOOL:
+    case RIOTYPE_BYTE:
+      archive.skipBytes(1, "");
+      break;
+    case RIOTYPE_FLOAT:
+      archive.skipBytes(4, "");
+      break;
+    case RIOTYPE_DOUBLE:
+      archive.skipBytes(8, "");
+      break;
+    case RIOTYPE_INT:
+    case RIOTYPE_LONG:
+      archive.skipVInt("");
+      break;
+    case RIOTYPE_STRING:
+    case RIOTYPE_BUFFER:
+      archive.skipBlob("");
+      break;
+    default:
+      Utils::skip(archive, "", *(fields[i]->getTypeID()));
+      break;
+    }
+  }
+  offsets[fields.size()] = stream.tell();
+}
+
+size_t LazyRecord::getFieldCount() const
+{
+  return type.getFieldTypeInfos().size();
+}
+
+size_t LazyRecord::getFieldLength(size_t i) const
+{
+  return offsets[i + 1] - offsets[i];
+}
+
+void LazyRecord::check(size_t i, int8_t typeVal) const
+{
+  if (type.getFieldTypeInfos()[i]->getTypeID()->getTypeVal() != typeVal) {
+    throw new IOException("Field type does not match the getter.");
+  }
+}
+
+void LazyRecord::getField(size_t i, bool& t)
+{
+  check(i, RIOTYPE_BOOL);
+  stream.seekTo(offsets[i]);
+  archive.deserialize(t, "");
+}
+
+void LazyRecord::getField(size_t i, int8_t& t)
+{
+  check(i, RIOTYPE_BYTE);
+  stream.seekTo(offsets[i]);
+  archive.deserialize(t, "");
+}
+
+void LazyRecord::getField(size_t i, int32_t& t)
+{
+  check(i, RIOTYPE_INT);
+  stream.seekTo(offsets[i]);
+  archive.deserialize(t, "");
+}
+
+void LazyRecord::getField(size_t i, int64_t& t)
+{
+  check(i, RIOTYPE_LONG);
+  stream.seekTo(offsets[i]);
+  archive.deserialize(t, "");
+}
+
+void LazyRecord::getField(size_t i, float& t)
+{
+  check(i, RIOTYPE_FLOAT);
+  stream.seekTo(offsets[i]);
+  archive.deserialize(t, "");
+}
+
+void LazyRecord::getField(size_t i, double& t)
+{
+  check(i, RIOTYPE_DOUBLE);
+  stream.seekTo(offsets[i]);
+  archive.deserialize(t, "");
+}
+
+void LazyRecord::getField(size_t i, std::string& t)
+{
+  int8_t typeVal = type.getFieldTypeInfos()[i]->getTypeID()->getTypeVal();
+  if (typeVal != RIOTYPE_STRING && typeVal != RIOTYPE_BUFFER) {
+    throw new IOException("Field type does not match the getter.");
+  }
+  stream.seekTo(offsets[i]);
+  if (typeVal == RIOTYPE_STRING) {
+    archive.deserialize(t, "");
+  } else {
+    size_t len = 0;
+    archive.deserialize(t, len, "");
+  }
+}
+
+void LazyRecord::getField(size_t i, StringView& t)
+{
+  int8_t typeVal = type.getFieldTypeInfos()[i]->getTypeID()->getTypeVal();
+  if (typeVal != RIOTYPE_STRING && typeVal != RIOTYPE_BUFFER) {
+    throw new IOException("Field type does not match the getter.");
+  }
+  stream.seekTo(offsets[i]);
+  archive.deserializeView(t, "");
+}
+
+IArchive& LazyRecord::fieldArchive(size_t i)
+{
+  stream.seekTo(offsets[i]);
+  return archive;
+}
@@ -0,0 +1,118 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LAZYRECORD_HH_
+#define LAZYRECORD_HH_
+
+#include "recordio.hh"
+#include "recordTypeInfo.hh"
+#include "binarchive.hh"
+
+namespace hadoop {
+
+/**
+ * An InStream over a caller-owned byte range, with a position that
+ * can be saved and restored so a record's fields can be revisited in
+ * any order. The stream does not copy or own the bytes.
+ */
+class BufferInStream : public InStream {
+private:
+  const char* data;
+  size_t length;
+  size_t position;
+public:
+  BufferInStream() : data(NULL), length(0), position(0) {}
+
+  /**
+   * Point the stream at a new byte range and rewind it.
+   */
+  void reset(const char* data_, size_t length_);
+  ssize_t read(void* buf, size_t buflen);
+  virtual const char* readDirect(size_t len);
+  void seekTo(size_t pos) { position = pos; }
+  size_t tell() const { return position; }
+};
+
+/**
+ * A lazy view over one binary-serialized record. Instead of
+ * materializing every field the way Record::deserialize does, reset()
+ * makes one cheap structural pass over the bytes that only records
+ * where each top-level field starts -- fixed-size fields are stepped
+ * over, vints and length-prefixed fields are measured without being
+ * decoded, and only nested types fall back to the generic skip. A
+ * field is deserialized when and if it is asked for, so a scan that
+ * filters on two fields of a forty-field record decodes two fields.
+ * The view keeps a pointer into the caller's buffer and a reference
+ * to the type info; both must outlive it, and a view is only valid
+ * until the next reset().
+ */
+class LazyRecord {
+private:
+  const RecordTypeInfo& type;
+  std::vector<size_t> offsets;
+  BufferInStream stream;
+  IBinArchive archive;
+  void check(size_t i, int8_t typeVal) const;
+public:
+  /**
+   * Create a view for records of the given type. The type info is
+   * borrowed, not copied.
+   */
+  LazyRecord(const RecordTypeInfo& type_);
+
+  /**
+   * Index the record serialized in the given bytes. Only field
+   * offsets are recorded; nothing is materialized.
+   */
+  void reset(const char* data, size_t length);
+
+  size_t getFieldCount() const;
+
+  /**
+   * The serialized length of field i in bytes.
+   */
+  size_t getFieldLength(size_t i) const;
+
+  /**
+   * Deserialize field i on demand. The overload must match the
+   * field's declared type or an IOException is thrown.
+   */
+  void getField(size_t i, bool& t);
+  void getField(size_t i, int8_t& t);
+  void getField(size_t i, int32_t& t);
+  void getField(size_t i, int64_t& t);
+  void getField(size_t i, float& t);
+  void getField(size_t i, double& t);
+  void getField(size_t i, std::string& t);
+
+  /**
+   * View a string or buffer field without copying it. The view points
+   * into the caller's buffer and follows its lifetime.
+   */
+  void getField(size_t i, StringView& t);
+
+  /**
+   * An archive positioned at the start of field i, for deserializing
+   * nested types (structs, vectors, maps) the typed getters don't
+   * cover.
+   */
+  IArchive& fieldArchive(size_t i);
+};
+
+}
+#endif /*LAZYRECORD_HH_*/
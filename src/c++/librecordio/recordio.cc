@@ -20,6 +20,8 @@
 #include "binarchive.hh"
 #include "csvarchive.hh"
 #include "xmlarchive.hh"
+#include "fastxmlarchive.hh"
+#include "colarchive.hh"
 
 using namespace hadoop;
 
@@ -35,6 +37,12 @@ hadoop::RecordReader::RecordReader(InStream& stream, RecFormat f)
     case kXML:
       mpArchive = new IXmlArchive(stream);
       break;
+    case kFastXML:
+      mpArchive = new IFastXmlArchive(stream);
+      break;
+    case kColumnar:
+      mpArchive = new IColArchive(stream);
+      break;
   }
 }
 
@@ -48,6 +56,14 @@ void hadoop::RecordReader::read(Record& record)
   record.deserialize(*mpArchive, (const char*) NULL);
 }
 
+void hadoop::RecordReader::readBatch(Record** records, size_t n)
+{
+  IArchive& archive = *mpArchive;
+  for (size_t i = 0; i < n; i++) {
+    records[i]->deserialize(archive, (const char*) NULL);
+  }
+}
+
 hadoop::RecordWriter::RecordWriter(OutStream& stream, RecFormat f)
 {
   switch (f) {
@@ -60,6 +76,12 @@ hadoop::RecordWriter::RecordWriter(OutStream& stream, RecFormat f)
     case kXML:
       mpArchive = new OXmlArchive(stream);
       break;
+    case kFastXML:
+      mpArchive = new OFastXmlArchive(stream);
+      break;
+    case kColumnar:
+      mpArchive = new OColArchive(stream);
+      break;
   }
 }
 
@@ -73,3 +95,16 @@ void hadoop::RecordWriter::write(const Record& record)
   record.serialize(*mpArchive, (const char*) NULL);
 }
 
+void hadoop::RecordWriter::writeBatch(const Record* const* records, size_t n)
+{
+  OArchive& archive = *mpArchive;
+  for (size_t i = 0; i < n; i++) {
+    records[i]->serialize(archive, (const char*) NULL);
+  }
+}
+
+void hadoop::RecordWriter::flush()
+{
+  mpArchive->flush();
+}
+
@@ -33,6 +33,14 @@ namespace hadoop {
 class InStream {
 public:
   virtual ssize_t read(void *buf, size_t buflen) = 0;
+  /**
+   * Consume len bytes and return a pointer to them inside the
+   * stream's own buffer, valid until the next read, skip, or
+   * readDirect. Streams that cannot expose their buffer return NULL
+   * and leave their position unchanged, in which case the caller must
+   * fall back to read().
+   */
+  virtual const char* readDirect(size_t len) { return NULL; }
   virtual ~InStream() {}
 };
 
@@ -54,7 +62,7 @@ public:
   virtual ~Record() {}
 };
 
-enum RecFormat { kBinary, kXML, kCSV };
+enum RecFormat { kBinary, kXML, kCSV, kFastXML, kColumnar };
 
 class RecordReader {
 private:
@@ -62,6 +70,13 @@ private:
 public:
   RecordReader(InStream& stream, RecFormat f);
   virtual void read(hadoop::Record& record);
+
+  /**
+   * Read the next n records into the given records. One call per
+   * batch keeps the archive hot across records and costs one virtual
+   * dispatch per record less than n calls to read().
+   */
+  virtual void readBatch(hadoop::Record** records, size_t n);
   virtual ~RecordReader();
 };
 
@@ -71,6 +86,18 @@ private:
 public:
   RecordWriter(OutStream& stream, RecFormat f);
   virtual void write(const hadoop::Record& record);
+
+  /**
+   * Write the given n records. The batch counterpart of write().
+   */
+  virtual void writeBatch(const hadoop::Record* const* records, size_t n);
+
+  /**
+   * Write out anything the archive has buffered. Formats that batch
+   * records, such as kColumnar, hold a partial block until this is
+   * called; call it before closing the underlying stream.
+   */
+  virtual void flush();
   virtual ~RecordWriter();
 };
 }; // end namspace hadoop
@@ -0,0 +1,42 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stringPool.hh"
+
+#include <string.h>
+
+const size_t hadoop::StringPool::kMaxLength;
+
+void hadoop::StringPool::intern(const char* data, size_t len,
+                                std::string& dest)
+{
+  if (len > kMaxLength) {
+    dest.assign(data, len);
+    return;
+  }
+  // FNV-1a over the bytes picks the bucket
+  size_t hash = 2166136261u;
+  for (size_t idx = 0; idx < len; idx++) {
+    hash = (hash ^ (unsigned char) data[idx]) * 16777619u;
+  }
+  std::string& bucket = table[hash % kBuckets];
+  if (bucket.length() != len || memcmp(bucket.data(), data, len) != 0) {
+    bucket.assign(data, len);
+  }
+  dest = bucket;
+}
@@ -0,0 +1,56 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STRINGPOOL_HH_
+#define STRINGPOOL_HH_
+
+#include <string>
+
+namespace hadoop {
+
+/**
+ * A bounded hash-consing pool for short strings that recur many times
+ * in a stream, such as map keys and enum-like fields drawn from a
+ * small domain. intern() assigns the caller's string from a cached
+ * copy of the bytes, so repeated occurrences of the same value are
+ * served from one pooled buffer instead of each being decoded
+ * separately.
+ *
+ * The pool is a direct-mapped table: each hash bucket caches the last
+ * value stored there, so its memory is bounded by the table size and
+ * colliding values simply replace one another.
+ */
+class StringPool {
+private:
+  static const size_t kBuckets = 1024;
+  std::string table[kBuckets];
+public:
+  /** Strings longer than this bypass the pool. */
+  static const size_t kMaxLength = 64;
+
+  /**
+   * Set dest to the given bytes, going through the pooled copy. A
+   * value that was interned recently is assigned from its bucket
+   * without touching the bucket; a new value replaces whatever its
+   * bucket held before.
+   */
+  void intern(const char* data, size_t len, std::string& dest);
+};
+
+}; // end namespace hadoop
+#endif /*STRINGPOOL_HH_*/
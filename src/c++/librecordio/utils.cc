@@ -24,8 +24,6 @@ using namespace hadoop;
 void Utils::skip(IArchive& a, const char* tag, const TypeID& typeID)
 {
   bool b;
-  size_t len=0;
-  ::std::string str;
   int8_t bt;
   double d;
   float f;
@@ -37,7 +35,7 @@ void Utils::skip(IArchive& a, const char* tag, const TypeID& typeID)
     a.deserialize(b, tag);
     break;
   case RIOTYPE_BUFFER: 
-    a.deserialize(str, len, tag);
+    a.skipBuffer(tag);
     break;
   case RIOTYPE_BYTE: 
     a.deserialize(bt, tag);
@@ -69,7 +67,7 @@ void Utils::skip(IArchive& a, const char* tag, const TypeID& typeID)
     }
     break;
   case RIOTYPE_STRING: 
-    a.deserialize(str, tag);
+    a.skipString(tag);
     break;
   case RIOTYPE_STRUCT: 
     {
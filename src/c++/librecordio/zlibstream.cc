@@ -0,0 +1,163 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "zlibstream.hh"
+
+#include <string.h>
+
+using namespace hadoop;
+
+hadoop::DeflateOutStream::DeflateOutStream(OutStream& stream_, int level,
+                                           size_t bufferSize)
+  : stream(stream_)
+{
+  capacity = bufferSize;
+  buffer = new char[capacity];
+  finished = false;
+  memset(&zstream, 0, sizeof(zstream));
+  if (Z_OK != deflateInit(&zstream, level)) {
+    delete[] buffer;
+    throw new IOException("Error initializing deflate.");
+  }
+  zstream.next_out = (Bytef*) buffer;
+  zstream.avail_out = capacity;
+}
+
+bool hadoop::DeflateOutStream::pump(int flushMode)
+{
+  while (true) {
+    int status = deflate(&zstream, flushMode);
+    if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+      throw new IOException("Error deflating data.");
+    }
+    size_t produced = capacity - zstream.avail_out;
+    if (produced > 0) {
+      if (produced != (size_t) stream.write(buffer, produced)) {
+        return false;
+      }
+      zstream.next_out = (Bytef*) buffer;
+      zstream.avail_out = capacity;
+    }
+    if (status == Z_STREAM_END) {
+      return true;
+    }
+    if (zstream.avail_in == 0 &&
+        (flushMode == Z_NO_FLUSH || status == Z_BUF_ERROR ||
+         produced == 0)) {
+      return true;
+    }
+  }
+}
+
+ssize_t hadoop::DeflateOutStream::write(const void* buf, size_t len)
+{
+  zstream.next_in = (Bytef*) buf;
+  zstream.avail_in = len;
+  if (!pump(Z_NO_FLUSH)) {
+    return -1;
+  }
+  return len;
+}
+
+bool hadoop::DeflateOutStream::flush()
+{
+  zstream.next_in = NULL;
+  zstream.avail_in = 0;
+  return pump(Z_SYNC_FLUSH);
+}
+
+bool hadoop::DeflateOutStream::finish()
+{
+  if (finished) {
+    return true;
+  }
+  zstream.next_in = NULL;
+  zstream.avail_in = 0;
+  bool ok = pump(Z_FINISH);
+  finished = true;
+  return ok;
+}
+
+void hadoop::DeflateOutStream::reset()
+{
+  deflateReset(&zstream);
+  zstream.next_out = (Bytef*) buffer;
+  zstream.avail_out = capacity;
+  finished = false;
+}
+
+hadoop::DeflateOutStream::~DeflateOutStream()
+{
+  if (!finished) {
+    finish();
+  }
+  deflateEnd(&zstream);
+  delete[] buffer;
+}
+
+hadoop::InflateInStream::InflateInStream(InStream& stream_,
+                                         size_t bufferSize)
+  : stream(stream_)
+{
+  capacity = bufferSize;
+  buffer = new char[capacity];
+  ended = false;
+  memset(&zstream, 0, sizeof(zstream));
+  if (Z_OK != inflateInit(&zstream)) {
+    delete[] buffer;
+    throw new IOException("Error initializing inflate.");
+  }
+  zstream.next_in = (Bytef*) buffer;
+  zstream.avail_in = 0;
+}
+
+ssize_t hadoop::InflateInStream::read(void *buf, size_t buflen)
+{
+  zstream.next_out = (Bytef*) buf;
+  zstream.avail_out = buflen;
+  while (zstream.avail_out > 0 && !ended) {
+    if (zstream.avail_in == 0) {
+      ssize_t got = stream.read(buffer, capacity);
+      if (got <= 0) {
+        break;
+      }
+      zstream.next_in = (Bytef*) buffer;
+      zstream.avail_in = got;
+    }
+    int status = inflate(&zstream, Z_NO_FLUSH);
+    if (status == Z_STREAM_END) {
+      ended = true;
+    } else if (status != Z_OK && status != Z_BUF_ERROR) {
+      throw new IOException("Error inflating data.");
+    }
+  }
+  return buflen - zstream.avail_out;
+}
+
+void hadoop::InflateInStream::reset()
+{
+  // keep any compressed bytes already pulled from the wrapped stream
+  inflateReset(&zstream);
+  ended = false;
+}
+
+hadoop::InflateInStream::~InflateInStream()
+{
+  inflateEnd(&zstream);
+  delete[] buffer;
+}
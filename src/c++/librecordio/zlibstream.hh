@@ -0,0 +1,101 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ZLIBSTREAM_HH_
+#define ZLIBSTREAM_HH_
+
+#include "recordio.hh"
+
+#include <zlib.h>
+
+namespace hadoop {
+
+/**
+ * An OutStream that deflate-compresses everything written to it and
+ * hands the compressed bytes to the wrapped stream. The z_stream is
+ * allocated once and lives for the life of the object; reset() starts
+ * a new deflate stream without another deflateInit, so writers that
+ * compress many blocks pay the setup cost once. finish() must be
+ * called to terminate the stream so a reader can decompress it.
+ * Either stream adapter can be handed to RecordWriter/RecordReader
+ * like any other stream.
+ */
+class DeflateOutStream : public OutStream {
+public:
+  /**
+   * Compress onto the given stream.
+   * @param stream the stream for the compressed bytes
+   * @param level the zlib level, Z_DEFAULT_COMPRESSION by default
+   * @param bufferSize the compressed staging buffer size
+   */
+  DeflateOutStream(OutStream& stream_, int level = Z_DEFAULT_COMPRESSION,
+                   size_t bufferSize = 64 * 1024);
+  ssize_t write(const void* buf, size_t len);
+
+  /**
+   * Push everything written so far through to the wrapped stream with
+   * a sync flush, so a reader can decompress it without the stream
+   * being finished.
+   */
+  bool flush();
+
+  /**
+   * Terminate the deflate stream, writing its trailer.
+   */
+  bool finish();
+
+  /**
+   * Start a new deflate stream, reusing the existing z_stream state.
+   * Only valid after finish().
+   */
+  void reset();
+  virtual ~DeflateOutStream();
+private:
+  bool pump(int flushMode);
+  OutStream& stream;
+  z_stream zstream;
+  char* buffer;
+  size_t capacity;
+  bool finished;
+};
+
+/**
+ * The reading side of DeflateOutStream: inflates bytes pulled from
+ * the wrapped stream. reset() prepares for another deflate stream on
+ * the same input without another inflateInit.
+ */
+class InflateInStream : public InStream {
+public:
+  InflateInStream(InStream& stream_, size_t bufferSize = 64 * 1024);
+  ssize_t read(void *buf, size_t buflen);
+
+  /**
+   * Start inflating a new deflate stream, reusing the z_stream state.
+   */
+  void reset();
+  virtual ~InflateInStream();
+private:
+  InStream& stream;
+  z_stream zstream;
+  char* buffer;
+  size_t capacity;
+  bool ended;
+};
+
+}
+#endif /*ZLIBSTREAM_HH_*/
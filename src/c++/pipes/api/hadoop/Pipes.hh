@@ -51,6 +51,25 @@ public:
   virtual ~JobConf() {}
 };
 
+/**
+ * A read-only pointer and length pair describing bytes that are owned by
+ * the framework. Views handed out by the task context point into a
+ * reusable protocol read buffer and are only valid until the task
+ * advances to the next key or value.
+ */
+class ByteView {
+private:
+  const char* data;
+  size_t length;
+public:
+  ByteView(): data(NULL), length(0) {}
+  ByteView(const char* viewData, size_t viewLength)
+    : data(viewData), length(viewLength) {}
+
+  const char* getData() const { return data; }
+  size_t getLength() const { return length; }
+};
+
 /**
  * Task context provides the information about the task and job.
  */
@@ -81,16 +100,49 @@ public:
   virtual const std::string& getInputKey() = 0;
 
   /**
-   * Get the current value. 
+   * Get the current value.
    * @return the current value
    */
   virtual const std::string& getInputValue() = 0;
 
+  /**
+   * Get a zero-copy view of the current key.
+   * The view is only valid until the next record is fetched, so
+   * applications that keep keys around must copy the bytes out.
+   * @return a view of the current key
+   */
+  virtual ByteView getInputKeyView() {
+    const std::string& key = getInputKey();
+    return ByteView(key.data(), key.length());
+  }
+
+  /**
+   * Get a zero-copy view of the current value.
+   * The view is only valid until the next record is fetched, so
+   * applications that keep values around must copy the bytes out.
+   * @return a view of the current value
+   */
+  virtual ByteView getInputValueView() {
+    const std::string& value = getInputValue();
+    return ByteView(value.data(), value.length());
+  }
+
   /**
    * Generate an output record
    */
   virtual void emit(const std::string& key, const std::string& value) = 0;
 
+  /**
+   * Generate an output record, handing the strings over instead of
+   * copying them: the contents of key and value are unspecified after
+   * the call. Mappers that build a fresh string per record save a copy
+   * of each; a string that is still needed afterwards must go through
+   * emit instead.
+   */
+  virtual void emitMove(std::string& key, std::string& value) {
+    emit(key, value);
+  }
+
   /**
    * Mark your task as having made progress without changing the status 
    * message.
@@ -104,8 +156,11 @@ public:
 
   /**
    * Register a counter with the given group and name.
+   * Repeated calls with the same group and name return the same
+   * counter, which stays owned by the framework, so it is safe to call
+   * this inside the record loop.
    */
-  virtual Counter* 
+  virtual Counter*
     getCounter(const std::string& group, const std::string& name) = 0;
 
   /**
@@ -175,6 +230,21 @@ public:
   virtual ~Partitioner() {}
 };
 
+/**
+ * A Partitioner that matches the Java HashPartitioner: the partition is
+ * the Java hash code of the key bytes, masked positive, modulo the
+ * reduce count. The hash is bit-exact with the one Text and
+ * BytesWritable keys produce in Java (and with java.lang.String for
+ * ASCII keys), so a pipes stage partitions identically to a Java stage
+ * of the same job. Applications that need Java-consistent partitioning
+ * should return one of these from Factory::createPartitioner instead of
+ * hand-rolling the hash loop.
+ */
+class HashPartitioner: public Partitioner {
+public:
+  virtual int partition(const std::string& key, int numOfReduces);
+};
+
 /**
  * For applications that want to read the input directly for the map function
  * they can define RecordReaders in C++.
@@ -190,6 +260,42 @@ public:
   virtual float getProgress() = 0;
 };
 
+class LineRecordReaderImpl;
+
+/**
+ * A RecordReader for line-oriented text input that memory-maps the
+ * file of the input split and finds record boundaries with memchr. The
+ * key is the byte offset of the line in the file as a decimal string
+ * and the value is the line without its terminator; a trailing
+ * carriage return is stripped. A split that does not start at the
+ * beginning of the file skips the partial first line, and the last
+ * line of a split is followed past the split end, matching the Java
+ * text input format.
+ *
+ * Applications return one from Factory::createRecordReader (with
+ * hadoop.pipes.java.recordreader set to false) to read their input
+ * directly instead of piping it through the Java parent.
+ */
+class LineRecordReader: public RecordReader {
+private:
+  LineRecordReaderImpl* impl;
+public:
+  LineRecordReader(MapContext& context);
+
+  virtual bool next(std::string& key, std::string& value);
+
+  /**
+   * Advance to the next line without copying it. The view points into
+   * the mapped file and stays valid until the reader is destroyed.
+   * @return true if a line was read
+   */
+  bool nextLineView(ByteView& line);
+
+  virtual float getProgress();
+
+  virtual ~LineRecordReader();
+};
+
 /**
  * An object to write key/value pairs as they are emited from the reduce.
  */
@@ -197,6 +303,16 @@ class RecordWriter: public Closable {
 public:
   virtual void emit(const std::string& key,
                     const std::string& value) = 0;
+
+  /**
+   * Emit a record whose strings the writer may take over; the contents
+   * of key and value are unspecified afterwards. Writers that retain
+   * records can override this to swap the strings in instead of
+   * copying them.
+   */
+  virtual void emitMove(std::string& key, std::string& value) {
+    emit(key, value);
+  }
 };
 
 /**
@@ -212,7 +328,20 @@ public:
    * @return the new combiner or NULL, if one is not needed
    */
   virtual Reducer* createCombiner(MapContext& context) const {
-    return NULL; 
+    return NULL;
+  }
+
+  /**
+   * The number of threads that should run the application's map function.
+   * Returning more than one asserts that the Mapper created by
+   * createMapper may be invoked concurrently from multiple threads. The
+   * framework then distributes batches of input records across a worker
+   * pool and merges the emitted records through per-thread buffers, so
+   * the order of the map output becomes nondeterministic.
+   * @return the number of mapper threads, 1 keeps the classic loop
+   */
+  virtual int getNumberOfMapperThreads(MapContext& context) const {
+    return 1;
   }
 
   /**
@@ -247,12 +376,25 @@ public:
 
 /**
  * Run the assigned task in the framework.
- * The user's main function should set the various functions using the 
+ * The user's main function should set the various functions using the
  * set* functions above and then call this.
  * @return true, if the task succeeded.
  */
 bool runTask(const Factory& factory);
 
+/**
+ * Replay a recorded binary downlink stream into the given factory at
+ * full speed, without a Java parent. Sessions can be recorded with the
+ * hadoop.pipes.downlink.record environment variable or taken from the
+ * "downlink.data" file that hadoop.pipes.command-file.keep saves. The
+ * replay reports records/s, bytes/s, and a latency histogram per
+ * message type on stderr.
+ * @param factory the application factory to drive
+ * @param commandFile the file holding the recorded downlink frames
+ * @return true, if the replay succeeded.
+ */
+bool runBenchmark(const Factory& factory, const std::string& commandFile);
+
 }
 
 #endif
@@ -18,8 +18,162 @@
 #ifndef HADOOP_PIPES_TEMPLATE_FACTORY_HH
 #define HADOOP_PIPES_TEMPLATE_FACTORY_HH
 
+#include "hadoop/SerialUtils.hh"
+
 namespace HadoopPipes {
 
+  /**
+   * Converters between the big-endian binary forms that the Java
+   * Writables (IntWritable, LongWritable, FloatWritable, DoubleWritable,
+   * Text) put on the wire and C++ primitives. Typed mappers and reducers
+   * use them to work on primitives directly instead of parsing and
+   * formatting text representations per record.
+   */
+  template <class T> struct WritableConverter;
+
+  template <> struct WritableConverter<std::string> {
+    static void read(const std::string& bytes, std::string& value) {
+      value = bytes;
+    }
+    static void write(const std::string& value, std::string& bytes) {
+      bytes = value;
+    }
+  };
+
+  template <> struct WritableConverter<int32_t> {
+    static void read(const std::string& bytes, int32_t& value) {
+      HADOOP_ASSERT(bytes.length() == 4, "not an IntWritable");
+      const unsigned char* data = (const unsigned char*) bytes.data();
+      value = ((int32_t) data[0] << 24) | ((int32_t) data[1] << 16) |
+              ((int32_t) data[2] << 8) | (int32_t) data[3];
+    }
+    static void write(int32_t value, std::string& bytes) {
+      bytes.resize(4);
+      for(int i=0; i < 4; ++i) {
+        bytes[i] = (char) (value >> (24 - 8 * i));
+      }
+    }
+  };
+
+  template <> struct WritableConverter<int64_t> {
+    static void read(const std::string& bytes, int64_t& value) {
+      HADOOP_ASSERT(bytes.length() == 8, "not a LongWritable");
+      const unsigned char* data = (const unsigned char*) bytes.data();
+      value = 0;
+      for(int i=0; i < 8; ++i) {
+        value = (value << 8) | data[i];
+      }
+    }
+    static void write(int64_t value, std::string& bytes) {
+      bytes.resize(8);
+      for(int i=0; i < 8; ++i) {
+        bytes[i] = (char) (value >> (56 - 8 * i));
+      }
+    }
+  };
+
+  template <> struct WritableConverter<float> {
+    static void read(const std::string& bytes, float& value) {
+      int32_t bits;
+      WritableConverter<int32_t>::read(bytes, bits);
+      union { int32_t bits; float value; } convert;
+      convert.bits = bits;
+      value = convert.value;
+    }
+    static void write(float value, std::string& bytes) {
+      union { int32_t bits; float value; } convert;
+      convert.value = value;
+      WritableConverter<int32_t>::write(convert.bits, bytes);
+    }
+  };
+
+  template <> struct WritableConverter<double> {
+    static void read(const std::string& bytes, double& value) {
+      int64_t bits;
+      WritableConverter<int64_t>::read(bytes, bits);
+      union { int64_t bits; double value; } convert;
+      convert.bits = bits;
+      value = convert.value;
+    }
+    static void write(double value, std::string& bytes) {
+      union { int64_t bits; double value; } convert;
+      convert.value = value;
+      WritableConverter<int64_t>::write(convert.bits, bytes);
+    }
+  };
+
+  /**
+   * A Mapper that decodes the input key and value into primitives at the
+   * protocol boundary. Applications override the typed map and can emit
+   * typed records with emitTyped; the output types are fixed at compile
+   * time so no text conversion is done per record.
+   */
+  template <class K, class V>
+  class TypedMapper: public Mapper {
+  private:
+    std::string keyBytes;
+    std::string valueBytes;
+  public:
+    virtual void map(MapContext& context) {
+      K key;
+      V value;
+      WritableConverter<K>::read(context.getInputKey(), key);
+      WritableConverter<V>::read(context.getInputValue(), value);
+      map(context, key, value);
+    }
+
+    /**
+     * Process one record with decoded key and value.
+     */
+    virtual void map(MapContext& context, const K& key, const V& value) = 0;
+
+  protected:
+    template <class OK, class OV>
+    void emitTyped(TaskContext& context, const OK& key, const OV& value) {
+      WritableConverter<OK>::write(key, keyBytes);
+      WritableConverter<OV>::write(value, valueBytes);
+      context.emit(keyBytes, valueBytes);
+    }
+  };
+
+  /**
+   * A Reducer that decodes the key once per group and each value on
+   * demand through nextTypedValue.
+   */
+  template <class K, class V>
+  class TypedReducer: public Reducer {
+  private:
+    std::string keyBytes;
+    std::string valueBytes;
+  public:
+    virtual void reduce(ReduceContext& context) {
+      K key;
+      WritableConverter<K>::read(context.getInputKey(), key);
+      reduce(context, key);
+    }
+
+    /**
+     * Process one key group; iterate the values with nextTypedValue.
+     */
+    virtual void reduce(ReduceContext& context, const K& key) = 0;
+
+  protected:
+    bool nextTypedValue(ReduceContext& context, V& value) {
+      if (!context.nextValue()) {
+        return false;
+      }
+      WritableConverter<V>::read(context.getInputValue(), value);
+      return true;
+    }
+
+    template <class OK, class OV>
+    void emitTyped(TaskContext& context, const OK& key, const OV& value) {
+      WritableConverter<OK>::write(key, keyBytes);
+      WritableConverter<OV>::write(value, valueBytes);
+      context.emit(keyBytes, valueBytes);
+    }
+  };
+
   template <class mapper, class reducer>
   class TemplateFactory2: public Factory {
   public:
@@ -17,19 +17,27 @@
  */
 
 #include "hadoop/Pipes.hh"
+#include "hadoop/CompressUtils.hh"
 #include "hadoop/SerialUtils.hh"
 #include "hadoop/StringUtils.hh"
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sched.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <strings.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include <pthread.h>
 
 using std::map;
@@ -40,62 +48,298 @@ using namespace HadoopUtils;
 
 namespace HadoopPipes {
 
+  /**
+   * The job configuration as an open-addressing hash table. Numeric and
+   * boolean values are parsed at most once per key and memoized, so
+   * configuration reads inside record loops are a hash probe and an
+   * array load instead of a tree walk and a reparse.
+   */
   class JobConfImpl: public JobConf {
   private:
-    map<string, string> values;
+    struct Entry {
+      string key;
+      string value;
+      bool intParsed;
+      int32_t intValue;
+      bool floatParsed;
+      float floatValue;
+      bool boolParsed;
+      bool boolValue;
+
+      Entry() {
+        intParsed = false;
+        intValue = 0;
+        floatParsed = false;
+        floatValue = 0.0f;
+        boolParsed = false;
+        boolValue = false;
+      }
+
+      Entry(const string& _key, const string& _value) {
+        key = _key;
+        value = _value;
+        intParsed = false;
+        intValue = 0;
+        floatParsed = false;
+        floatValue = 0.0f;
+        boolParsed = false;
+        boolValue = false;
+      }
+    };
+    vector<Entry*> entries;
+    vector<int32_t> buckets;
+
+    static uint32_t hashKey(const string& key) {
+      // FNV-1a
+      uint32_t result = 2166136261u;
+      for(size_t i=0; i < key.length(); ++i) {
+        result ^= (uint8_t) key[i];
+        result *= 16777619u;
+      }
+      return result;
+    }
+
+    size_t findBucket(const string& key) const {
+      size_t mask = buckets.size() - 1;
+      size_t idx = hashKey(key) & mask;
+      while (buckets[idx] != -1 && entries[buckets[idx]]->key != key) {
+        idx = (idx + 1) & mask;
+      }
+      return idx;
+    }
+
+    void grow() {
+      size_t newSize = buckets.size() * 2;
+      buckets.assign(newSize, -1);
+      size_t mask = newSize - 1;
+      for(size_t i=0; i < entries.size(); ++i) {
+        size_t idx = hashKey(entries[i]->key) & mask;
+        while (buckets[idx] != -1) {
+          idx = (idx + 1) & mask;
+        }
+        buckets[idx] = i;
+      }
+    }
+
+    Entry* find(const string& key) const {
+      size_t idx = findBucket(key);
+      return buckets[idx] == -1 ? NULL : entries[buckets[idx]];
+    }
+
   public:
+    JobConfImpl() {
+      buckets.assign(1024, -1);
+    }
+
     void set(const string& key, const string& value) {
-      values[key] = value;
+      size_t idx = findBucket(key);
+      if (buckets[idx] == -1) {
+        buckets[idx] = entries.size();
+        entries.push_back(new Entry(key, value));
+        if (entries.size() * 4 >= buckets.size() * 3) {
+          grow();
+        }
+      } else {
+        delete entries[buckets[idx]];
+        entries[buckets[idx]] = new Entry(key, value);
+      }
+    }
+
+    /**
+     * Insert an entry by swapping the strings in instead of copying
+     * them; both arguments are left empty.
+     */
+    void adopt(string& key, string& value) {
+      size_t idx = findBucket(key);
+      if (buckets[idx] == -1) {
+        buckets[idx] = entries.size();
+        Entry* entry = new Entry();
+        entry->key.swap(key);
+        entry->value.swap(value);
+        entries.push_back(entry);
+        if (entries.size() * 4 >= buckets.size() * 3) {
+          grow();
+        }
+      } else {
+        Entry* entry = entries[buckets[idx]];
+        string empty;
+        entry->value.swap(value);
+        value.swap(empty);
+        entry->intParsed = false;
+        entry->floatParsed = false;
+        entry->boolParsed = false;
+      }
     }
 
     virtual bool hasKey(const string& key) const {
-      return values.find(key) != values.end();
+      return find(key) != NULL;
     }
 
     virtual const string& get(const string& key) const {
-      map<string,string>::const_iterator itr = values.find(key);
-      if (itr == values.end()) {
+      Entry* entry = find(key);
+      if (entry == NULL) {
         throw Error("Key " + key + " not found in JobConf");
       }
-      return itr->second;
+      return entry->value;
     }
 
     virtual int getInt(const string& key) const {
-      const string& val = get(key);
-      return toInt(val);
+      Entry* entry = find(key);
+      if (entry == NULL) {
+        throw Error("Key " + key + " not found in JobConf");
+      }
+      if (!entry->intParsed) {
+        entry->intValue = toInt(entry->value);
+        entry->intParsed = true;
+      }
+      return entry->intValue;
     }
 
     virtual float getFloat(const string& key) const {
-      const string& val = get(key);
-      return toFloat(val);
+      Entry* entry = find(key);
+      if (entry == NULL) {
+        throw Error("Key " + key + " not found in JobConf");
+      }
+      if (!entry->floatParsed) {
+        entry->floatValue = toFloat(entry->value);
+        entry->floatParsed = true;
+      }
+      return entry->floatValue;
     }
 
     virtual bool getBoolean(const string&key) const {
-      const string& val = get(key);
-      return toBool(val);
+      Entry* entry = find(key);
+      if (entry == NULL) {
+        throw Error("Key " + key + " not found in JobConf");
+      }
+      if (!entry->boolParsed) {
+        entry->boolValue = toBool(entry->value);
+        entry->boolParsed = true;
+      }
+      return entry->boolValue;
+    }
+
+    virtual ~JobConfImpl() {
+      for(size_t i=0; i < entries.size(); ++i) {
+        delete entries[i];
+      }
     }
   };
 
   class DownwardProtocol {
   public:
     virtual void start(int protocol) = 0;
-    virtual void setJobConf(vector<string> values) = 0;
+    /**
+     * Deliver the flattened key/value entries. The handler may swap the
+     * strings out of the vector instead of copying them; the caller
+     * must not rely on the contents afterwards.
+     */
+    virtual void setJobConf(vector<string>& values) = 0;
     virtual void setInputTypes(string keyType, string valueType) = 0;
     virtual void runMap(string inputSplit, int numReduces, bool pipedInput)= 0;
     virtual void mapItem(const string& key, const string& value) = 0;
+    virtual void mapItemBatch(const vector<string>& keys,
+                              const vector<string>& values) = 0;
     virtual void runReduce(int reduce, bool pipedOutput) = 0;
     virtual void reduceKey(const string& key) = 0;
     virtual void reduceValue(const string& value) = 0;
+    virtual void reduceValueBatch(const vector<string>& values) = 0;
     virtual void close() = 0;
     virtual void abort() = 0;
     virtual ~DownwardProtocol() {}
   };
 
+  /**
+   * Assembles a whole uplink message in a reusable buffer so that it
+   * reaches the transport as one write instead of a locked stdio call
+   * per field.
+   */
+  class FrameBuffer: public OutStream {
+  private:
+    vector<char> data;
+  public:
+    void write(const void* buf, size_t len) {
+      const char* bytes = (const char*) buf;
+      data.insert(data.end(), bytes, bytes + len);
+    }
+
+    void flush() {
+    }
+
+    const char* rawData() const {
+      return data.empty() ? NULL : &data[0];
+    }
+
+    size_t size() const {
+      return data.size();
+    }
+
+    void reset() {
+      data.clear();
+    }
+
+    /**
+     * Write the assembled frame to the given stream and reset.
+     */
+    void sendTo(OutStream& stream) {
+      if (!data.empty()) {
+        stream.write(&data[0], data.size());
+        data.clear();
+      }
+    }
+  };
+
   class UpwardProtocol {
   public:
     virtual void output(const string& key, const string& value) = 0;
     virtual void partitionedOutput(int reduce, const string& key,
                                    const string& value) = 0;
+
+    /**
+     * Send a staged run of records that are all bound for one partition.
+     * The buffer holds count serialized key/value pairs and is reset by
+     * the call. The default implementation replays the records one at a
+     * time; protocols that can ship the run as a single frame override
+     * it.
+     */
+    virtual void partitionedOutputBatch(int reduce, int count,
+                                        FrameBuffer& records) {
+      string bytes(records.rawData(), records.size());
+      records.reset();
+      MemoryInStream stream(bytes);
+      string key;
+      string value;
+      for(int i=0; i < count; ++i) {
+        deserializeString(key, stream);
+        deserializeString(value, stream);
+        partitionedOutput(reduce, key, value);
+      }
+    }
+
+    /**
+     * Switch to delta-encoding output keys against the previous emitted
+     * key. Only protocols whose parent can rebuild the keys support
+     * it; the default ignores the request and keeps sending full keys.
+     */
+    virtual void enableKeyDelta() {
+    }
+
+    /**
+     * Grant the parent credit for more downlink record frames. Only
+     * sent when hadoop.pipes.downlink.window.records enables flow
+     * control; transports without backpressure ignore it.
+     */
+    virtual void downlinkCredit(int records) {
+    }
+
+    /**
+     * Forget any per-task uplink state when a reused worker finishes a
+     * task, so the next task starts from the same state a fresh process
+     * would. The default has no per-task state.
+     */
+    virtual void resetTask() {
+    }
+
     virtual void status(const string& message) = 0;
     virtual void progress(float progress) = 0;
     virtual void done() = 0;
@@ -239,8 +483,7 @@ namespace HadoopPipes {
         vector<string> values(len);
         for(int i=0; i < len; ++i) {
           HADOOP_ASSERT(sep == '\t', "Short text protocol command " + command);
-          sep = readUpto(arg, delim);
-          values.push_back(arg);
+          sep = readUpto(values[i], delim);
         }
         HADOOP_ASSERT(sep == '\n', "Long text protocol command " + command);
         handler->setJobConf(values);
@@ -287,33 +530,420 @@ namespace HadoopPipes {
   };
   const char* TextProtocol::delim = "\t\n";
 
-  enum MESSAGE_TYPE {START_MESSAGE, SET_JOB_CONF, SET_INPUT_TYPES, RUN_MAP, 
-                     MAP_ITEM, RUN_REDUCE, REDUCE_KEY, REDUCE_VALUE, 
-                     CLOSE, ABORT, 
+  enum MESSAGE_TYPE {START_MESSAGE, SET_JOB_CONF, SET_INPUT_TYPES, RUN_MAP,
+                     MAP_ITEM, RUN_REDUCE, REDUCE_KEY, REDUCE_VALUE,
+                     CLOSE, ABORT,
+                     MAP_ITEM_BATCH, REDUCE_VALUE_BATCH, COMPRESSED_BLOCK,
                      OUTPUT=50, PARTITIONED_OUTPUT, STATUS, PROGRESS, DONE,
-                     REGISTER_COUNTER, INCREMENT_COUNTER};
+                     REGISTER_COUNTER, INCREMENT_COUNTER,
+                     PARTITIONED_OUTPUT_BATCH, DOWNLINK_CREDIT,
+                     OUTPUT_DELTA, PARTITIONED_OUTPUT_DELTA};
+
+  /**
+   * The protocol version that added MAP_ITEM_BATCH and REDUCE_VALUE_BATCH.
+   * The version is sent by the framework in the START_MESSAGE handshake and
+   * the batched messages are only used when it is at least this value.
+   */
+  const int32_t BATCH_PROTOCOL_VERSION = 1;
+
+  /**
+   * The protocol version that added COMPRESSED_BLOCK framing on the
+   * downlink. The framework only sends it when downlink compression has
+   * been enabled for the job.
+   */
+  const int32_t COMPRESSION_PROTOCOL_VERSION = 2;
+
+  /**
+   * An OutStream that queues the bytes into a single-producer
+   * single-consumer ring buffer and drains them to the wrapped stream on
+   * a dedicated writer thread, so that serialization and socket I/O
+   * overlap. The fast paths on both sides only touch the ring positions;
+   * the mutex and condition variables are used when the ring runs full
+   * or empty.
+   */
+  class AsyncOutStream: public OutStream {
+  private:
+    OutStream* sink;
+    char* ring;
+    size_t capacity;
+    volatile size_t head;
+    volatile size_t tail;
+    volatile bool closed;
+    volatile bool writerIdle;
+    volatile bool producerWaiting;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    pthread_cond_t drained;
+
+    static void* writerMain(void* ptr) {
+      ((AsyncOutStream*) ptr)->run();
+      return NULL;
+    }
+
+    void run() {
+      while (true) {
+        size_t avail = tail - head;
+        if (avail == 0) {
+          if (closed) {
+            break;
+          }
+          pthread_mutex_lock(&lock);
+          pthread_cond_broadcast(&drained);
+          writerIdle = true;
+          if (tail == head && !closed) {
+            timespec deadline;
+            timeval now;
+            gettimeofday(&now, NULL);
+            deadline.tv_sec = now.tv_sec;
+            deadline.tv_nsec = (now.tv_usec + 10000) * 1000;
+            if (deadline.tv_nsec >= 1000000000) {
+              deadline.tv_sec += 1;
+              deadline.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&notEmpty, &lock, &deadline);
+          }
+          writerIdle = false;
+          pthread_mutex_unlock(&lock);
+          continue;
+        }
+        __sync_synchronize();
+        size_t pos = head % capacity;
+        size_t chunk = capacity - pos < avail ? capacity - pos : avail;
+        sink->write(ring + pos, chunk);
+        __sync_synchronize();
+        head += chunk;
+        if (producerWaiting) {
+          pthread_mutex_lock(&lock);
+          pthread_cond_signal(&notFull);
+          pthread_mutex_unlock(&lock);
+        }
+      }
+    }
+
+  public:
+
+    /**
+     * Wrap the given stream and start the writer thread. This stream
+     * takes ownership of the sink.
+     */
+    AsyncOutStream(OutStream* _sink, size_t _capacity) {
+      sink = _sink;
+      capacity = _capacity;
+      ring = new char[capacity];
+      head = 0;
+      tail = 0;
+      closed = false;
+      writerIdle = false;
+      producerWaiting = false;
+      pthread_mutex_init(&lock, NULL);
+      pthread_cond_init(&notEmpty, NULL);
+      pthread_cond_init(&notFull, NULL);
+      pthread_cond_init(&drained, NULL);
+      HADOOP_ASSERT(pthread_create(&writer, NULL, writerMain, this) == 0,
+                    "problem creating uplink writer thread");
+    }
+
+    void write(const void* buf, size_t len) {
+      const char* data = (const char*) buf;
+      while (len > 0) {
+        size_t space = capacity - (tail - head);
+        if (space == 0) {
+          pthread_mutex_lock(&lock);
+          producerWaiting = true;
+          while (tail - head == capacity) {
+            pthread_cond_wait(&notFull, &lock);
+          }
+          producerWaiting = false;
+          pthread_mutex_unlock(&lock);
+          continue;
+        }
+        size_t chunk = space < len ? space : len;
+        size_t pos = tail % capacity;
+        size_t first = capacity - pos < chunk ? capacity - pos : chunk;
+        memcpy(ring + pos, data, first);
+        memcpy(ring, data + first, chunk - first);
+        __sync_synchronize();
+        tail += chunk;
+        if (writerIdle) {
+          pthread_mutex_lock(&lock);
+          pthread_cond_signal(&notEmpty);
+          pthread_mutex_unlock(&lock);
+        }
+        data += chunk;
+        len -= chunk;
+      }
+    }
+
+    /**
+     * Wait until the writer thread has drained the ring and flush the
+     * underlying stream.
+     */
+    void flush() {
+      pthread_mutex_lock(&lock);
+      pthread_cond_signal(&notEmpty);
+      while (tail != head) {
+        pthread_cond_wait(&drained, &lock);
+      }
+      pthread_mutex_unlock(&lock);
+      sink->flush();
+    }
+
+    virtual ~AsyncOutStream() {
+      pthread_mutex_lock(&lock);
+      closed = true;
+      pthread_cond_signal(&notEmpty);
+      pthread_mutex_unlock(&lock);
+      pthread_join(writer, NULL);
+      sink->flush();
+      delete sink;
+      delete[] ring;
+      pthread_mutex_destroy(&lock);
+      pthread_cond_destroy(&notEmpty);
+      pthread_cond_destroy(&notFull);
+      pthread_cond_destroy(&drained);
+    }
+  };
+
+  /**
+   * One direction of the shared memory command channel. The mapping is
+   * split into two of these rings, each starting with the producer and
+   * consumer positions on their own cache lines followed by the data
+   * bytes. Both sides poll the positions with a yield-then-sleep backoff
+   * instead of crossing the kernel socket stack per frame.
+   */
+  class SharedRing {
+  public:
+    volatile uint32_t* producerPos;
+    volatile uint32_t* consumerPos;
+    char* data;
+    size_t capacity;
+
+    void init(char* base, size_t bytes) {
+      producerPos = (volatile uint32_t*) base;
+      consumerPos = (volatile uint32_t*) (base + 64);
+      data = base + 128;
+      // The positions are free-running 32 bit counters, so indices must
+      // be taken with a mask: a modulo by a non-power-of-two capacity
+      // would jump discontinuously when a counter wraps at 2^32. Round
+      // the usable capacity down to the largest power of two that fits.
+      capacity = 1;
+      while (capacity * 2 <= bytes - 128) {
+        capacity *= 2;
+      }
+    }
+
+    static void backoff(int& spins) {
+      spins += 1;
+      if (spins < 1000) {
+        sched_yield();
+      } else {
+        usleep(100);
+      }
+    }
+  };
+
+  class ShmInStream: public InStream {
+  private:
+    SharedRing ring;
+  public:
+    ShmInStream(char* base, size_t bytes) {
+      ring.init(base, bytes);
+    }
+
+    void read(void* buf, size_t len) {
+      char* output = (char*) buf;
+      while (len > 0) {
+        int spins = 0;
+        uint32_t avail;
+        while ((avail = *ring.producerPos - *ring.consumerPos) == 0) {
+          SharedRing::backoff(spins);
+        }
+        __sync_synchronize();
+        size_t chunk = avail < len ? avail : len;
+        size_t pos = *ring.consumerPos & (ring.capacity - 1);
+        size_t first = ring.capacity - pos < chunk ? ring.capacity - pos
+                                                   : chunk;
+        memcpy(output, ring.data + pos, first);
+        memcpy(output + first, ring.data, chunk - first);
+        __sync_synchronize();
+        *ring.consumerPos += chunk;
+        output += chunk;
+        len -= chunk;
+      }
+    }
+  };
+
+  class ShmOutStream: public OutStream {
+  private:
+    SharedRing ring;
+  public:
+    ShmOutStream(char* base, size_t bytes) {
+      ring.init(base, bytes);
+    }
+
+    void write(const void* buf, size_t len) {
+      const char* input = (const char*) buf;
+      while (len > 0) {
+        int spins = 0;
+        uint32_t space;
+        while ((space = ring.capacity -
+                (*ring.producerPos - *ring.consumerPos)) == 0) {
+          SharedRing::backoff(spins);
+        }
+        size_t chunk = space < len ? space : len;
+        size_t pos = *ring.producerPos & (ring.capacity - 1);
+        size_t first = ring.capacity - pos < chunk ? ring.capacity - pos
+                                                   : chunk;
+        memcpy(ring.data + pos, input, first);
+        memcpy(ring.data, input + first, chunk - first);
+        __sync_synchronize();
+        *ring.producerPos += chunk;
+        input += chunk;
+        len -= chunk;
+      }
+    }
+
+    void flush() {
+      // writes are visible to the consumer as soon as the producer
+      // position advances
+    }
+  };
+
+  /**
+   * An InStream that copies everything it reads into a capture file.
+   * Used to record a downlink session for later replay by runBenchmark.
+   */
+  class TeeInStream: public InStream {
+  private:
+    InStream* base;
+    FILE* capture;
+  public:
+    /**
+     * Wrap the given stream, taking ownership of it.
+     */
+    TeeInStream(InStream* _base, const string& captureFile) {
+      base = _base;
+      capture = fopen(captureFile.c_str(), "wb");
+      HADOOP_ASSERT(capture != NULL,
+                    "cannot open downlink capture file " + captureFile);
+    }
+
+    void read(void* buf, size_t len) {
+      base->read(buf, len);
+      fwrite(buf, 1, len, capture);
+    }
+
+    virtual ~TeeInStream() {
+      fclose(capture);
+      delete base;
+    }
+  };
 
   class BinaryUpwardProtocol: public UpwardProtocol {
   private:
-    FileOutStream* stream;
+    OutStream* stream;
+    FrameBuffer frame;
+    bool keyDelta;
+    string lastKey;
+
+    /**
+     * Write the key as the length of the prefix it shares with the
+     * previous key plus the remaining suffix. Sorted runs, like the
+     * combiner's, mostly collapse to a few suffix bytes.
+     */
+    void serializeKeyDelta(const string& key) {
+      size_t limit = key.length() < lastKey.length() ? key.length()
+                                                     : lastKey.length();
+      size_t shared = 0;
+      while (shared < limit && key[shared] == lastKey[shared]) {
+        shared += 1;
+      }
+      serializeInt(shared, frame);
+      serializeInt(key.length() - shared, frame);
+      frame.write(key.data() + shared, key.length() - shared);
+      lastKey = key;
+    }
+
+    /**
+     * Wrap the uplink in the asynchronous writer when it is enabled.
+     */
+    static OutStream* wrapStream(OutStream* raw) {
+      char* async = getenv("hadoop.pipes.async.uplink");
+      if (async != NULL && toBool(async)) {
+        return new AsyncOutStream(raw, 4 * 1024 * 1024);
+      }
+      return raw;
+    }
+
   public:
     BinaryUpwardProtocol(FILE* _stream) {
-      stream = new FileOutStream();
-      HADOOP_ASSERT(stream->open(_stream), "problem opening stream");
+      FileOutStream* raw = new FileOutStream();
+      HADOOP_ASSERT(raw->open(_stream), "problem opening stream");
+      stream = wrapStream(raw);
+      keyDelta = false;
+    }
+
+    /**
+     * Write the uplink frames to the given stream, taking ownership.
+     */
+    BinaryUpwardProtocol(OutStream* _stream) {
+      stream = wrapStream(_stream);
+      keyDelta = false;
     }
 
     virtual void output(const string& key, const string& value) {
-      serializeInt(OUTPUT, *stream);
-      serializeString(key, *stream);
-      serializeString(value, *stream);
+      if (keyDelta) {
+        serializeInt(OUTPUT_DELTA, frame);
+        serializeKeyDelta(key);
+      } else {
+        serializeInt(OUTPUT, frame);
+        serializeString(key, frame);
+      }
+      serializeString(value, frame);
+      frame.sendTo(*stream);
     }
 
     virtual void partitionedOutput(int reduce, const string& key,
                                    const string& value) {
-      serializeInt(PARTITIONED_OUTPUT, *stream);
-      serializeInt(reduce, *stream);
-      serializeString(key, *stream);
-      serializeString(value, *stream);
+      if (keyDelta) {
+        serializeInt(PARTITIONED_OUTPUT_DELTA, frame);
+        serializeInt(reduce, frame);
+        serializeKeyDelta(key);
+      } else {
+        serializeInt(PARTITIONED_OUTPUT, frame);
+        serializeInt(reduce, frame);
+        serializeString(key, frame);
+      }
+      serializeString(value, frame);
+      frame.sendTo(*stream);
+    }
+
+    virtual void enableKeyDelta() {
+      keyDelta = true;
+    }
+
+    virtual void resetTask() {
+      keyDelta = false;
+      lastKey.clear();
+    }
+
+    virtual void partitionedOutputBatch(int reduce, int count,
+                                        FrameBuffer& records) {
+      serializeInt(PARTITIONED_OUTPUT_BATCH, frame);
+      serializeInt(reduce, frame);
+      serializeInt(count, frame);
+      records.sendTo(frame);
+      frame.sendTo(*stream);
+    }
+
+    virtual void downlinkCredit(int records) {
+      serializeInt(DOWNLINK_CREDIT, frame);
+      serializeInt(records, frame);
+      frame.sendTo(*stream);
+      // the parent may be blocked on this grant
+      stream->flush();
     }
 
     virtual void status(const string& message) {
@@ -329,6 +959,9 @@ namespace HadoopPipes {
 
     virtual void done() {
       serializeInt(DONE, *stream);
+      // a reused worker blocks for its next task right after this, so
+      // the parent must see the frame now rather than at process exit
+      stream->flush();
     }
 
     virtual void registerCounter(int id, const string& group, 
@@ -353,18 +986,46 @@ namespace HadoopPipes {
 
   class BinaryProtocol: public Protocol {
   private:
-    FileInStream* downStream;
+    InStream* downStream;
     DownwardProtocol* handler;
     BinaryUpwardProtocol * uplink;
     string key;
     string value;
+    /**
+     * Reusable buffers for batched records. They are only valid until the
+     * next call to nextEvent.
+     */
+    vector<string> batchKeys;
+    vector<string> batchValues;
+    /**
+     * The decoded bytes of the current COMPRESSED_BLOCK; events are
+     * parsed out of blockStream until it drains, then reads fall back
+     * to the socket.
+     */
+    string blockData;
+    string compressedData;
+    MemoryInStream* blockStream;
 
   public:
     BinaryProtocol(FILE* down, DownwardProtocol* _handler, FILE* up) {
-      downStream = new FileInStream();
-      downStream->open(down);
+      FileInStream* fileDown = new FileInStream();
+      fileDown->open(down);
+      downStream = fileDown;
+      uplink = new BinaryUpwardProtocol(up);
+      handler = _handler;
+      blockStream = NULL;
+    }
+
+    /**
+     * Speak the binary protocol over the given streams, taking ownership
+     * of both.
+     */
+    BinaryProtocol(InStream* down, DownwardProtocol* _handler,
+                   OutStream* up) {
+      downStream = down;
       uplink = new BinaryUpwardProtocol(up);
       handler = _handler;
+      blockStream = NULL;
     }
 
     UpwardProtocol* getUplink() {
@@ -372,23 +1033,32 @@ namespace HadoopPipes {
     }
 
     virtual void nextEvent() {
+      // drain the current compressed block before going back to the
+      // socket; the block always ends on a message boundary
+      InStream* in = downStream;
+      if (blockStream != NULL) {
+        if (blockStream->available() > 0) {
+          in = blockStream;
+        } else {
+          delete blockStream;
+          blockStream = NULL;
+        }
+      }
       int32_t cmd;
-      cmd = deserializeInt(*downStream);
+      cmd = deserializeInt(*in);
       switch (cmd) {
       case START_MESSAGE: {
         int32_t prot;
-        prot = deserializeInt(*downStream);
+        prot = deserializeInt(*in);
         handler->start(prot);
         break;
       }
       case SET_JOB_CONF: {
         int32_t entries;
-        entries = deserializeInt(*downStream);
+        entries = deserializeInt(*in);
         vector<string> result(entries);
         for(int i=0; i < entries; ++i) {
-          string item;
-          deserializeString(item, *downStream);
-          result.push_back(item);
+          deserializeString(result[i], *in);
         }
         handler->setJobConf(result);
         break;
@@ -396,8 +1066,8 @@ namespace HadoopPipes {
       case SET_INPUT_TYPES: {
         string keyType;
         string valueType;
-        deserializeString(keyType, *downStream);
-        deserializeString(valueType, *downStream);
+        deserializeString(keyType, *in);
+        deserializeString(valueType, *in);
         handler->setInputTypes(keyType, valueType);
         break;
       }
@@ -405,36 +1075,79 @@ namespace HadoopPipes {
         string split;
         int32_t numReduces;
         int32_t piped;
-        deserializeString(split, *downStream);
-        numReduces = deserializeInt(*downStream);
-        piped = deserializeInt(*downStream);
+        deserializeString(split, *in);
+        numReduces = deserializeInt(*in);
+        piped = deserializeInt(*in);
         handler->runMap(split, numReduces, piped);
         break;
       }
       case MAP_ITEM: {
-        deserializeString(key, *downStream);
-        deserializeString(value, *downStream);
+        deserializeString(key, *in);
+        deserializeString(value, *in);
         handler->mapItem(key, value);
         break;
       }
+      case MAP_ITEM_BATCH: {
+        int32_t records;
+        records = deserializeInt(*in);
+        HADOOP_ASSERT(records > 0, "Empty map item batch");
+        batchKeys.resize(records);
+        batchValues.resize(records);
+        for(int i=0; i < records; ++i) {
+          deserializeString(batchKeys[i], *in);
+          deserializeString(batchValues[i], *in);
+        }
+        handler->mapItemBatch(batchKeys, batchValues);
+        break;
+      }
       case RUN_REDUCE: {
         int32_t reduce;
         int32_t piped;
-        reduce = deserializeInt(*downStream);
-        piped = deserializeInt(*downStream);
+        reduce = deserializeInt(*in);
+        piped = deserializeInt(*in);
         handler->runReduce(reduce, piped);
         break;
       }
       case REDUCE_KEY: {
-        deserializeString(key, *downStream);
+        deserializeString(key, *in);
         handler->reduceKey(key);
         break;
       }
       case REDUCE_VALUE: {
-        deserializeString(value, *downStream);
+        deserializeString(value, *in);
         handler->reduceValue(value);
         break;
       }
+      case REDUCE_VALUE_BATCH: {
+        int32_t records;
+        records = deserializeInt(*in);
+        HADOOP_ASSERT(records > 0, "Empty reduce value batch");
+        batchValues.resize(records);
+        for(int i=0; i < records; ++i) {
+          deserializeString(batchValues[i], *in);
+        }
+        handler->reduceValueBatch(batchValues);
+        break;
+      }
+      case COMPRESSED_BLOCK: {
+        HADOOP_ASSERT(blockStream == NULL,
+                      "Compressed block inside compressed block");
+        int32_t rawLength;
+        int32_t compressedLength;
+        rawLength = deserializeInt(*in);
+        compressedLength = deserializeInt(*in);
+        HADOOP_ASSERT(rawLength > 0 && compressedLength > 0,
+                      "Empty compressed block");
+        compressedData.resize(compressedLength);
+        in->read(&compressedData[0], compressedLength);
+        blockData.resize(rawLength);
+        lzDecompress(&compressedData[0], compressedLength, &blockData[0],
+                     rawLength);
+        blockStream = new MemoryInStream(blockData.data(), rawLength);
+        // deliver the first event framed inside the block
+        nextEvent();
+        break;
+      }
       case CLOSE:
         handler->close();
         break;
@@ -447,82 +1160,909 @@ namespace HadoopPipes {
     }
 
     virtual ~BinaryProtocol() {
+      delete blockStream;
       delete downStream;
       delete uplink;
     }
   };
 
   /**
-   * Define a context object to give to combiners that will let them
-   * go through the values and emit their results correctly.
+   * A Protocol decorator that decodes downlink events ahead of the
+   * consumer on a helper thread into a bounded queue, so socket reads
+   * and deserialization overlap with user compute. nextEvent() replays
+   * the oldest decoded event into the real handler on the caller's
+   * thread; the event that delivered the current record stays alive
+   * until the next one is popped, preserving the lifetime the handlers
+   * rely on.
    */
-  class CombineContext: public ReduceContext {
+  class PrefetchProtocol: public Protocol, public DownwardProtocol {
   private:
-    ReduceContext* baseContext;
-    Partitioner* partitioner;
-    int numReduces;
-    UpwardProtocol* uplink;
-    bool firstKey;
-    bool firstValue;
-    map<string, vector<string> >::iterator keyItr;
-    map<string, vector<string> >::iterator endKeyItr;
-    vector<string>::iterator valueItr;
-    vector<string>::iterator endValueItr;
-
-  public:
-    CombineContext(ReduceContext* _baseContext,
-                   Partitioner* _partitioner,
-                   int _numReduces,
-                   UpwardProtocol* _uplink,
-                   map<string, vector<string> >& data) {
-      baseContext = _baseContext;
-      partitioner = _partitioner;
-      numReduces = _numReduces;
-      uplink = _uplink;
-      keyItr = data.begin();
-      endKeyItr = data.end();
-      firstKey = true;
-      firstValue = true;
-    }
+    struct Event {
+      int type;
+      string key;
+      string value;
+      vector<string> keys;
+      vector<string> values;
+      int intArg;
+      bool boolArg;
+
+      Event(int _type) {
+        type = _type;
+        intArg = 0;
+        boolArg = false;
+      }
+    };
 
-    virtual const JobConf* getJobConf() {
-      return baseContext->getJobConf();
+    Protocol* base;
+    DownwardProtocol* handler;
+    size_t depth;
+    vector<Event*> queue;
+    size_t queueHead;
+    bool sawClose;
+    bool failed;
+    string failure;
+    Event* lastEvent;
+    pthread_t decoder;
+    bool decoderStarted;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+
+    static void* decoderMain(void* ptr) {
+      PrefetchProtocol* self = (PrefetchProtocol*) ptr;
+      try {
+        while (!self->sawClose) {
+          self->base->nextEvent();
+        }
+      } catch (Error& err) {
+        pthread_mutex_lock(&self->lock);
+        self->failed = true;
+        self->failure = err.getMessage();
+        pthread_cond_broadcast(&self->notEmpty);
+        pthread_mutex_unlock(&self->lock);
+      }
+      return NULL;
     }
 
-    virtual const std::string& getInputKey() {
-      return keyItr->first;
+    void push(Event* event) {
+      pthread_mutex_lock(&lock);
+      while (queue.size() - queueHead >= depth) {
+        pthread_cond_wait(&notFull, &lock);
+      }
+      queue.push_back(event);
+      pthread_cond_signal(&notEmpty);
+      pthread_mutex_unlock(&lock);
     }
 
-    virtual const std::string& getInputValue() {
-      return *valueItr;
+    Event* pop() {
+      pthread_mutex_lock(&lock);
+      while (queue.size() == queueHead && !failed) {
+        pthread_cond_wait(&notEmpty, &lock);
+      }
+      if (queue.size() == queueHead) {
+        string message = failure;
+        pthread_mutex_unlock(&lock);
+        throw Error("Prefetch decoder failed: " + message);
+      }
+      Event* result = queue[queueHead];
+      queueHead += 1;
+      if (queueHead == queue.size()) {
+        queue.clear();
+        queueHead = 0;
+      }
+      pthread_cond_signal(&notFull);
+      pthread_mutex_unlock(&lock);
+      return result;
     }
 
-    virtual void emit(const std::string& key, const std::string& value) {
-      if (partitioner != NULL) {
-        uplink->partitionedOutput(partitioner->partition(key, numReduces),
-                                  key, value);
-      } else {
-        uplink->output(key, value);
-      }
+  public:
+    PrefetchProtocol(DownwardProtocol* _handler, int _depth) {
+      base = NULL;
+      handler = _handler;
+      depth = _depth < 2 ? 2 : _depth;
+      queueHead = 0;
+      sawClose = false;
+      failed = false;
+      lastEvent = NULL;
+      decoderStarted = false;
+      pthread_mutex_init(&lock, NULL);
+      pthread_cond_init(&notEmpty, NULL);
+      pthread_cond_init(&notFull, NULL);
     }
 
-    virtual void progress() {
-      baseContext->progress();
+    /**
+     * Attach the protocol that was created with this object as its
+     * handler and start decoding ahead.
+     */
+    void startDecoding(Protocol* _base) {
+      base = _base;
+      HADOOP_ASSERT(pthread_create(&decoder, NULL, decoderMain, this) == 0,
+                    "problem creating prefetch decoder thread");
+      decoderStarted = true;
     }
 
-    virtual void setStatus(const std::string& status) {
-      baseContext->setStatus(status);
+    UpwardProtocol* getUplink() {
+      return base->getUplink();
     }
 
-    bool nextKey() {
-      if (firstKey) {
-        firstKey = false;
-      } else {
-        ++keyItr;
+    virtual void nextEvent() {
+      Event* event = pop();
+      delete lastEvent;
+      lastEvent = event;
+      switch (event->type) {
+      case START_MESSAGE:
+        handler->start(event->intArg);
+        break;
+      case SET_JOB_CONF:
+        handler->setJobConf(event->values);
+        break;
+      case SET_INPUT_TYPES:
+        handler->setInputTypes(event->key, event->value);
+        break;
+      case RUN_MAP:
+        handler->runMap(event->key, event->intArg, event->boolArg);
+        break;
+      case MAP_ITEM:
+        handler->mapItem(event->key, event->value);
+        break;
+      case MAP_ITEM_BATCH:
+        handler->mapItemBatch(event->keys, event->values);
+        break;
+      case RUN_REDUCE:
+        handler->runReduce(event->intArg, event->boolArg);
+        break;
+      case REDUCE_KEY:
+        handler->reduceKey(event->key);
+        break;
+      case REDUCE_VALUE:
+        handler->reduceValue(event->value);
+        break;
+      case REDUCE_VALUE_BATCH:
+        handler->reduceValueBatch(event->values);
+        break;
+      case CLOSE:
+        handler->close();
+        break;
+      case ABORT:
+        handler->abort();
+        break;
+      default:
+        HADOOP_ASSERT(false, "Unknown prefetched event " +
+                      toString(event->type));
+      }
+    }
+
+    virtual void start(int protocol) {
+      Event* event = new Event(START_MESSAGE);
+      event->intArg = protocol;
+      push(event);
+    }
+
+    virtual void setJobConf(vector<string>& values) {
+      Event* event = new Event(SET_JOB_CONF);
+      event->values.swap(values);
+      push(event);
+    }
+
+    virtual void setInputTypes(string keyType, string valueType) {
+      Event* event = new Event(SET_INPUT_TYPES);
+      event->key = keyType;
+      event->value = valueType;
+      push(event);
+    }
+
+    virtual void runMap(string inputSplit, int numReduces, bool pipedInput) {
+      Event* event = new Event(RUN_MAP);
+      event->key = inputSplit;
+      event->intArg = numReduces;
+      event->boolArg = pipedInput;
+      push(event);
+    }
+
+    virtual void mapItem(const string& key, const string& value) {
+      Event* event = new Event(MAP_ITEM);
+      event->key = key;
+      event->value = value;
+      push(event);
+    }
+
+    virtual void mapItemBatch(const vector<string>& keys,
+                              const vector<string>& values) {
+      Event* event = new Event(MAP_ITEM_BATCH);
+      event->keys = keys;
+      event->values = values;
+      push(event);
+    }
+
+    virtual void runReduce(int reduce, bool pipedOutput) {
+      Event* event = new Event(RUN_REDUCE);
+      event->intArg = reduce;
+      event->boolArg = pipedOutput;
+      push(event);
+    }
+
+    virtual void reduceKey(const string& key) {
+      Event* event = new Event(REDUCE_KEY);
+      event->key = key;
+      push(event);
+    }
+
+    virtual void reduceValue(const string& value) {
+      Event* event = new Event(REDUCE_VALUE);
+      event->value = value;
+      push(event);
+    }
+
+    virtual void reduceValueBatch(const vector<string>& values) {
+      Event* event = new Event(REDUCE_VALUE_BATCH);
+      event->values = values;
+      push(event);
+    }
+
+    virtual void close() {
+      sawClose = true;
+      push(new Event(CLOSE));
+    }
+
+    virtual void abort() {
+      sawClose = true;
+      push(new Event(ABORT));
+    }
+
+    virtual ~PrefetchProtocol() {
+      if (decoderStarted) {
+        pthread_join(decoder, NULL);
+      }
+      for(size_t i=queueHead; i < queue.size(); ++i) {
+        delete queue[i];
+      }
+      delete lastEvent;
+      delete base;
+      pthread_mutex_destroy(&lock);
+      pthread_cond_destroy(&notEmpty);
+      pthread_cond_destroy(&notFull);
+    }
+  };
+
+  /**
+   * The mapped file and scan state behind a LineRecordReader.
+   */
+  class LineRecordReaderImpl {
+  public:
+    int fd;
+    char* base;
+    uint64_t fileSize;
+    uint64_t splitStart;
+    uint64_t splitEnd;
+    uint64_t pos;
+  };
+
+  /**
+   * Read the 8 byte big-endian long that Java's DataOutput.writeLong
+   * puts in the serialized FileSplit, which is not the vint encoding
+   * the rest of the protocol uses.
+   */
+  static uint64_t readRawLong(InStream& stream) {
+    unsigned char bytes[8];
+    stream.read(bytes, 8);
+    uint64_t result = 0;
+    for(int i=0; i < 8; ++i) {
+      result = (result << 8) | bytes[i];
+    }
+    return result;
+  }
+
+  LineRecordReader::LineRecordReader(MapContext& context) {
+    impl = new LineRecordReaderImpl();
+    string filename;
+    MemoryInStream stream(context.getInputSplit());
+    deserializeString(filename, stream);
+    uint64_t start = readRawLong(stream);
+    uint64_t length = readRawLong(stream);
+    if (filename.compare(0, 5, "file:") == 0) {
+      filename.erase(0, 5);
+    }
+    impl->fd = open(filename.c_str(), O_RDONLY);
+    HADOOP_ASSERT(impl->fd != -1, "failed to open " + filename);
+    struct stat statResult;
+    HADOOP_ASSERT(fstat(impl->fd, &statResult) == 0,
+                  "failed to stat " + filename);
+    impl->fileSize = statResult.st_size;
+    impl->base = NULL;
+    if (impl->fileSize != 0) {
+      void* mapped = mmap(NULL, impl->fileSize, PROT_READ, MAP_SHARED,
+                          impl->fd, 0);
+      HADOOP_ASSERT(mapped != MAP_FAILED, "failed to map " + filename);
+      impl->base = (char*) mapped;
+      madvise(impl->base, impl->fileSize, MADV_SEQUENTIAL);
+    }
+    if (start > impl->fileSize) {
+      start = impl->fileSize;
+    }
+    impl->splitStart = start;
+    impl->splitEnd = start + length < impl->fileSize ? start + length
+                                                     : impl->fileSize;
+    impl->pos = start;
+    if (start != 0) {
+      // the previous split owns the line straddling the boundary, so
+      // scan for its end starting one byte back in case the split
+      // begins exactly on a line
+      const char* rest = impl->base + start - 1;
+      const char* newline =
+        (const char*) memchr(rest, '\n', impl->fileSize - (start - 1));
+      impl->pos = newline != NULL ? (newline - impl->base) + 1
+                                  : impl->fileSize;
+    }
+  }
+
+  bool LineRecordReader::nextLineView(ByteView& line) {
+    if (impl->pos >= impl->splitEnd) {
+      return false;
+    }
+    const char* lineStart = impl->base + impl->pos;
+    size_t remaining = impl->fileSize - impl->pos;
+    const char* newline = (const char*) memchr(lineStart, '\n', remaining);
+    size_t lineLength = newline != NULL ? (size_t) (newline - lineStart)
+                                        : remaining;
+    impl->pos += lineLength + (newline != NULL ? 1 : 0);
+    if (lineLength > 0 && lineStart[lineLength - 1] == '\r') {
+      lineLength -= 1;
+    }
+    line = ByteView(lineStart, lineLength);
+    return true;
+  }
+
+  bool LineRecordReader::next(string& key, string& value) {
+    uint64_t offset = impl->pos;
+    ByteView line;
+    if (!nextLineView(line)) {
+      return false;
+    }
+    key = toString((int64_t) offset);
+    value.assign(line.getData(), line.getLength());
+    return true;
+  }
+
+  float LineRecordReader::getProgress() {
+    if (impl->splitEnd > impl->splitStart) {
+      float result = (float) (impl->pos - impl->splitStart) /
+        (impl->splitEnd - impl->splitStart);
+      return result < 1.0f ? result : 1.0f;
+    }
+    return 1.0f;
+  }
+
+  LineRecordReader::~LineRecordReader() {
+    if (impl->base != NULL) {
+      munmap(impl->base, impl->fileSize);
+    }
+    ::close(impl->fd);
+    delete impl;
+  }
+
+  /**
+   * The hash WritableComparator.hashBytes computes over the key bytes:
+   * h = h*31 + b for each signed byte, in 32-bit wrapping arithmetic.
+   * The loop is unrolled four bytes per step with the powers of 31
+   * folded into constants, so most of the multiply latency chain
+   * disappears; the result is bit-exact with the byte loop.
+   */
+  static int32_t javaHashBytes(const char* bytes, size_t length) {
+    uint32_t hash = 0;
+    size_t i = 0;
+    for(; i + 4 <= length; i += 4) {
+      hash = hash * 923521u                                   // 31^4
+        + (uint32_t) (int32_t) (signed char) bytes[i] * 29791u  // 31^3
+        + (uint32_t) (int32_t) (signed char) bytes[i + 1] * 961u
+        + (uint32_t) (int32_t) (signed char) bytes[i + 2] * 31u
+        + (uint32_t) (int32_t) (signed char) bytes[i + 3];
+    }
+    for(; i < length; ++i) {
+      hash = hash * 31u + (uint32_t) (int32_t) (signed char) bytes[i];
+    }
+    return (int32_t) hash;
+  }
+
+  int HashPartitioner::partition(const string& key, int numOfReduces) {
+    // mask the sign bit the way the Java HashPartitioner does
+    return (javaHashBytes(key.data(), key.length()) & 0x7fffffff)
+      % numOfReduces;
+  }
+
+  /**
+   * A bump-pointer arena that hands out bytes from large fixed-size blocks
+   * so that buffering a record costs a memcpy instead of a heap allocation.
+   * Allocations larger than a block get a dedicated block of their own.
+   */
+  /**
+   * An open-addressing hash table used to buffer map output for the
+   * combiner. Each distinct key is interned once into the arena and the
+   * values are appended to an arena-backed chain per key, so the steady
+   * state cost of an emit is a hash probe and a memcpy rather than a
+   * red-black tree insert and a string copy.
+   *
+   * A value record in the arena is laid out as a pointer to the next
+   * record of the same key, a uint32_t length, and the value bytes.
+   */
+  class CombineBuffer {
+  private:
+    struct KeyEntry {
+      const char* keyData;
+      uint32_t keyLength;
+      uint32_t hash;
+      char* firstValue;
+      char* lastValue;
+      uint64_t valueBytes;
+    };
+    Arena arena;
+    vector<KeyEntry> entries;
+    vector<int32_t> buckets;
+    size_t valueBytesTotal;
+    /**
+     * When non-empty, maps the iteration position to the entry index so
+     * that a spill can stream the keys in sorted order. It is built once
+     * per spill by sortKeys instead of keeping the buffer totally ordered
+     * on every insert. A partial spill shrinks it to just the selected
+     * keys.
+     */
+    vector<int32_t> order;
+
+    struct KeyOrder {
+      const vector<KeyEntry>* entries;
+      bool operator()(int32_t left, int32_t right) const {
+        const KeyEntry& a = (*entries)[left];
+        const KeyEntry& b = (*entries)[right];
+        size_t minLength = a.keyLength < b.keyLength ? a.keyLength
+                                                     : b.keyLength;
+        int cmp = memcmp(a.keyData, b.keyData, minLength);
+        if (cmp != 0) {
+          return cmp < 0;
+        }
+        return a.keyLength < b.keyLength;
+      }
+    };
+
+    struct SizeOrder {
+      const vector<KeyEntry>* entries;
+      bool operator()(int32_t left, int32_t right) const {
+        const KeyEntry& a = (*entries)[left];
+        const KeyEntry& b = (*entries)[right];
+        if (a.valueBytes != b.valueBytes) {
+          return a.valueBytes > b.valueBytes;
+        }
+        return left < right;
       }
-      if (keyItr != endKeyItr) {
-        valueItr = keyItr->second.begin();
-        endValueItr = keyItr->second.end();
+    };
+
+    static uint32_t hashBytes(const char* data, size_t len) {
+      // FNV-1a
+      uint32_t result = 2166136261u;
+      for(size_t i=0; i < len; ++i) {
+        result ^= (uint8_t) data[i];
+        result *= 16777619u;
+      }
+      return result;
+    }
+
+    size_t findBucket(const char* data, size_t len, uint32_t hash) const {
+      size_t mask = buckets.size() - 1;
+      size_t idx = hash & mask;
+      while (buckets[idx] != -1) {
+        const KeyEntry& entry = entries[buckets[idx]];
+        if (entry.hash == hash && entry.keyLength == len &&
+            memcmp(entry.keyData, data, len) == 0) {
+          break;
+        }
+        idx = (idx + 1) & mask;
+      }
+      return idx;
+    }
+
+    void grow() {
+      size_t newSize = buckets.size() * 2;
+      buckets.assign(newSize, -1);
+      size_t mask = newSize - 1;
+      for(size_t i=0; i < entries.size(); ++i) {
+        size_t idx = entries[i].hash & mask;
+        while (buckets[idx] != -1) {
+          idx = (idx + 1) & mask;
+        }
+        buckets[idx] = i;
+      }
+    }
+
+    char* allocValue(const string& value) {
+      char* record = arena.alloc(sizeof(char*) + sizeof(uint32_t) +
+                                 value.length());
+      char* next = NULL;
+      uint32_t len = value.length();
+      memcpy(record, &next, sizeof(char*));
+      memcpy(record + sizeof(char*), &len, sizeof(uint32_t));
+      memcpy(record + sizeof(char*) + sizeof(uint32_t), value.data(), len);
+      return record;
+    }
+
+  public:
+    CombineBuffer() {
+      valueBytesTotal = 0;
+      buckets.assign(1024, -1);
+    }
+
+    void add(const string& key, const string& value) {
+      uint32_t hash = hashBytes(key.data(), key.length());
+      size_t idx = findBucket(key.data(), key.length(), hash);
+      char* record = allocValue(value);
+      size_t recordBytes = sizeof(char*) + sizeof(uint32_t) + value.length();
+      valueBytesTotal += recordBytes;
+      if (buckets[idx] == -1) {
+        char* keyCopy = arena.alloc(key.length());
+        memcpy(keyCopy, key.data(), key.length());
+        KeyEntry entry;
+        entry.keyData = keyCopy;
+        entry.keyLength = key.length();
+        entry.hash = hash;
+        entry.firstValue = record;
+        entry.lastValue = record;
+        entry.valueBytes = recordBytes;
+        buckets[idx] = entries.size();
+        entries.push_back(entry);
+        if (entries.size() * 4 >= buckets.size() * 3) {
+          grow();
+        }
+      } else {
+        KeyEntry& entry = entries[buckets[idx]];
+        memcpy(entry.lastValue, &record, sizeof(char*));
+        entry.lastValue = record;
+        entry.valueBytes += recordBytes;
+      }
+    }
+
+    /**
+     * The number of keys the next iteration will visit: all of them, or
+     * just the selection from the last selectSpill.
+     */
+    size_t numKeys() const {
+      return order.empty() ? entries.size() : order.size();
+    }
+
+    /**
+     * The value record bytes currently buffered.
+     */
+    size_t valueBytes() const {
+      return valueBytesTotal;
+    }
+
+    /**
+     * The bytes actually allocated for the buffered records: the arena
+     * blocks plus the key table and bucket array. This is what the
+     * spill threshold should compare against, since the payload alone
+     * understates real memory use by the per-record headers and table
+     * overhead.
+     */
+    size_t memoryBytes() const {
+      return arena.allocatedBytes() +
+        entries.capacity() * sizeof(KeyEntry) +
+        buckets.capacity() * sizeof(int32_t) +
+        order.capacity() * sizeof(int32_t);
+    }
+
+    /**
+     * Pick the keys to spill and arrange them in key order for the
+     * combiner. With a zero target every key is selected; otherwise the
+     * keys holding the most value bytes are taken first until at least
+     * targetBytes of buffered data are covered, so a partial spill
+     * frees the most memory while the remaining keys stay warm.
+     * Sorting once per spill is much cheaper than paying for
+     * incremental ordering on every insert.
+     */
+    void selectSpill(size_t targetBytes) {
+      order.resize(entries.size());
+      for(size_t i=0; i < entries.size(); ++i) {
+        order[i] = i;
+      }
+      if (targetBytes != 0 && targetBytes < valueBytesTotal) {
+        SizeOrder bySize;
+        bySize.entries = &entries;
+        std::sort(order.begin(), order.end(), bySize);
+        size_t covered = 0;
+        size_t count = 0;
+        while (count < order.size() && covered < targetBytes) {
+          covered += entries[order[count]].valueBytes;
+          count += 1;
+        }
+        order.resize(count);
+      }
+      KeyOrder byKey;
+      byKey.entries = &entries;
+      std::sort(order.begin(), order.end(), byKey);
+    }
+
+    void getKey(size_t idx, string& key) const {
+      const KeyEntry& entry = entries[order.empty() ? idx : order[idx]];
+      key.assign(entry.keyData, entry.keyLength);
+    }
+
+    const char* getFirstValue(size_t idx) const {
+      return entries[order.empty() ? idx : order[idx]].firstValue;
+    }
+
+    static const char* getNextValue(const char* record) {
+      char* next;
+      memcpy(&next, record, sizeof(char*));
+      return next;
+    }
+
+    static void getValue(const char* record, string& value) {
+      uint32_t len;
+      memcpy(&len, record + sizeof(char*), sizeof(uint32_t));
+      value.assign(record + sizeof(char*) + sizeof(uint32_t), len);
+    }
+
+    /**
+     * Drop the keys chosen by the last selectSpill and copy the
+     * surviving keys and value chains into a fresh arena, so the memory
+     * of the spilled records is actually reclaimed rather than pinned
+     * until the next full flush.
+     */
+    void removeSpilled() {
+      if (order.size() == entries.size()) {
+        clear();
+        return;
+      }
+      vector<bool> spilled(entries.size(), false);
+      for(size_t i=0; i < order.size(); ++i) {
+        spilled[order[i]] = true;
+      }
+      Arena newArena;
+      vector<KeyEntry> newEntries;
+      size_t newValueBytes = 0;
+      for(size_t i=0; i < entries.size(); ++i) {
+        if (spilled[i]) {
+          continue;
+        }
+        KeyEntry entry = entries[i];
+        char* keyCopy = newArena.alloc(entry.keyLength);
+        memcpy(keyCopy, entry.keyData, entry.keyLength);
+        entry.keyData = keyCopy;
+        const char* record = entries[i].firstValue;
+        char* previous = NULL;
+        entry.firstValue = NULL;
+        while (record != NULL) {
+          uint32_t len;
+          memcpy(&len, record + sizeof(char*), sizeof(uint32_t));
+          char* copy = newArena.alloc(sizeof(char*) + sizeof(uint32_t) + len);
+          char* next = NULL;
+          memcpy(copy, &next, sizeof(char*));
+          memcpy(copy + sizeof(char*), record + sizeof(char*),
+                 sizeof(uint32_t) + len);
+          if (previous == NULL) {
+            entry.firstValue = copy;
+          } else {
+            memcpy(previous, &copy, sizeof(char*));
+          }
+          previous = copy;
+          record = getNextValue(record);
+        }
+        entry.lastValue = previous;
+        newValueBytes += entry.valueBytes;
+        newEntries.push_back(entry);
+      }
+      arena.swap(newArena);
+      entries.swap(newEntries);
+      valueBytesTotal = newValueBytes;
+      order.clear();
+      size_t newSize = 1024;
+      while (entries.size() * 4 >= newSize * 3) {
+        newSize *= 2;
+      }
+      buckets.assign(newSize, -1);
+      size_t mask = newSize - 1;
+      for(size_t i=0; i < entries.size(); ++i) {
+        size_t idx = entries[i].hash & mask;
+        while (buckets[idx] != -1) {
+          idx = (idx + 1) & mask;
+        }
+        buckets[idx] = i;
+      }
+    }
+
+    void clear() {
+      arena.clear();
+      entries.clear();
+      order.clear();
+      valueBytesTotal = 0;
+      buckets.assign(1024, -1);
+    }
+  };
+
+  /**
+   * Routes map output through the partitioner and, when a staging
+   * budget is configured, accumulates the serialized records per
+   * partition so they go up as one large frame instead of one frame per
+   * record. The partition of the last key is cached, which makes the
+   * partitioner free for the sorted runs the combiner produces.
+   */
+  class PartitionedOutputStage {
+  private:
+    UpwardProtocol* uplink;
+    Partitioner* partitioner;
+    int numReduces;
+    size_t limit;
+    vector<FrameBuffer*> buffers;
+    vector<int> counts;
+    string lastKey;
+    int lastPartition;
+    bool hasLast;
+
+  public:
+    /**
+     * @param limitBytes the staging budget per partition, 0 sends every
+     *                   record as its own frame
+     */
+    PartitionedOutputStage(UpwardProtocol* _uplink,
+                           Partitioner* _partitioner,
+                           int _numReduces, size_t limitBytes) {
+      uplink = _uplink;
+      partitioner = _partitioner;
+      numReduces = _numReduces;
+      limit = limitBytes;
+      lastPartition = 0;
+      hasLast = false;
+      if (limit != 0) {
+        buffers.resize(numReduces);
+        counts.resize(numReduces, 0);
+        for(int i=0; i < numReduces; ++i) {
+          buffers[i] = new FrameBuffer();
+        }
+      }
+    }
+
+    void emit(const string& key, const string& value) {
+      if (partitioner == NULL) {
+        uplink->output(key, value);
+        return;
+      }
+      bool newKey;
+      int part = partitionFor(key, newKey);
+      send(part, key, value);
+      if (newKey) {
+        lastKey = key;
+      }
+    }
+
+    /**
+     * Emit like emit(), but swap the key into the partition cache
+     * instead of copying it. The contents of key and value are
+     * unspecified afterwards.
+     */
+    void emitMove(string& key, string& value) {
+      if (partitioner == NULL) {
+        uplink->output(key, value);
+        return;
+      }
+      bool newKey;
+      int part = partitionFor(key, newKey);
+      send(part, key, value);
+      if (newKey) {
+        lastKey.swap(key);
+      }
+    }
+
+    /**
+     * Send every staged record up. Must be called before the task
+     * reports done.
+     */
+    void flush() {
+      for(size_t i=0; i < buffers.size(); ++i) {
+        if (counts[i] != 0) {
+          uplink->partitionedOutputBatch(i, counts[i], *buffers[i]);
+          counts[i] = 0;
+        }
+      }
+    }
+
+    ~PartitionedOutputStage() {
+      for(size_t i=0; i < buffers.size(); ++i) {
+        delete buffers[i];
+      }
+    }
+
+  private:
+    /**
+     * The partition for the key, reusing the cached partition when the
+     * key repeats. newKey tells the caller to refresh lastKey once the
+     * record is out.
+     */
+    int partitionFor(const string& key, bool& newKey) {
+      newKey = !(hasLast && key == lastKey);
+      if (newKey) {
+        lastPartition = partitioner->partition(key, numReduces);
+        hasLast = true;
+      }
+      return lastPartition;
+    }
+
+    /**
+     * Send or stage the record for its partition.
+     */
+    void send(int part, const string& key, const string& value) {
+      if (limit == 0) {
+        uplink->partitionedOutput(part, key, value);
+        return;
+      }
+      FrameBuffer& buffer = *buffers[part];
+      serializeString(key, buffer);
+      serializeString(value, buffer);
+      counts[part] += 1;
+      if (buffer.size() >= limit) {
+        uplink->partitionedOutputBatch(part, counts[part], buffer);
+        counts[part] = 0;
+      }
+    }
+  };
+
+  /**
+   * Define a context object to give to combiners that will let them
+   * go through the values and emit their results correctly.
+   */
+  class CombineContext: public ReduceContext {
+  private:
+    ReduceContext* baseContext;
+    RecordWriter* sink;
+    bool firstKey;
+    bool firstValue;
+    CombineBuffer* buffer;
+    size_t keyIndex;
+    const char* valueRecord;
+    string currentKey;
+    string currentValue;
+
+  public:
+    CombineContext(ReduceContext* _baseContext,
+                   RecordWriter* _sink,
+                   CombineBuffer& data) {
+      baseContext = _baseContext;
+      sink = _sink;
+      buffer = &data;
+      keyIndex = 0;
+      valueRecord = NULL;
+      firstKey = true;
+      firstValue = true;
+    }
+
+    virtual const JobConf* getJobConf() {
+      return baseContext->getJobConf();
+    }
+
+    virtual const std::string& getInputKey() {
+      return currentKey;
+    }
+
+    virtual const std::string& getInputValue() {
+      return currentValue;
+    }
+
+    virtual void emit(const std::string& key, const std::string& value) {
+      sink->emit(key, value);
+    }
+
+    virtual void progress() {
+      baseContext->progress();
+    }
+
+    virtual void setStatus(const std::string& status) {
+      baseContext->setStatus(status);
+    }
+
+    bool nextKey() {
+      if (firstKey) {
+        firstKey = false;
+      } else {
+        ++keyIndex;
+      }
+      if (keyIndex < buffer->numKeys()) {
+        buffer->getKey(keyIndex, currentKey);
+        valueRecord = buffer->getFirstValue(keyIndex);
         firstValue = true;
         return true;
       }
@@ -533,9 +2073,13 @@ namespace HadoopPipes {
       if (firstValue) {
         firstValue = false;
       } else {
-        ++valueItr;
+        valueRecord = CombineBuffer::getNextValue(valueRecord);
       }
-      return valueItr != endValueItr;
+      if (valueRecord != NULL) {
+        CombineBuffer::getValue(valueRecord, currentValue);
+        return true;
+      }
+      return false;
     }
     
     virtual Counter* getCounter(const std::string& group, 
@@ -548,65 +2092,729 @@ namespace HadoopPipes {
     }
   };
 
+  /**
+   * Sends combiner output to the partitioned output stage.
+   */
+  class StageWriter: public RecordWriter {
+  private:
+    PartitionedOutputStage* stage;
+  public:
+    StageWriter(PartitionedOutputStage* _stage) {
+      stage = _stage;
+    }
+
+    virtual void emit(const string& key, const string& value) {
+      stage->emit(key, value);
+    }
+
+    virtual void emitMove(string& key, string& value) {
+      stage->emitMove(key, value);
+    }
+  };
+
+  /**
+   * Writes a sorted run of combined records to a local spill file as
+   * serialized key/value pairs.
+   */
+  class SpillRunWriter: public RecordWriter {
+  private:
+    FileOutStream out;
+    uint64_t records;
+  public:
+    SpillRunWriter(const string& filename) {
+      records = 0;
+      HADOOP_ASSERT(out.open(filename, true),
+                    "can't create combiner spill run " + filename);
+    }
+
+    virtual void emit(const string& key, const string& value) {
+      serializeString(key, out);
+      serializeString(value, out);
+      records += 1;
+    }
+
+    uint64_t getRecords() const {
+      return records;
+    }
+
+    virtual void close() {
+      out.close();
+    }
+  };
+
+  /**
+   * A ReduceContext over the values gathered for one key while merging
+   * spill runs, feeding the combiner one last time before the result
+   * goes up.
+   */
+  class MergeContext: public ReduceContext {
+  private:
+    ReduceContext* baseContext;
+    RecordWriter* sink;
+    const string* key;
+    const vector<string>* values;
+    size_t pos;
+  public:
+    MergeContext(ReduceContext* _baseContext, RecordWriter* _sink) {
+      baseContext = _baseContext;
+      sink = _sink;
+      key = NULL;
+      values = NULL;
+      pos = 0;
+    }
+
+    void setGroup(const string& _key, const vector<string>& _values) {
+      key = &_key;
+      values = &_values;
+      pos = 0;
+    }
+
+    virtual const JobConf* getJobConf() {
+      return baseContext->getJobConf();
+    }
+
+    virtual const string& getInputKey() {
+      return *key;
+    }
+
+    virtual const string& getInputValue() {
+      return (*values)[pos - 1];
+    }
+
+    virtual bool nextValue() {
+      if (pos < values->size()) {
+        pos += 1;
+        return true;
+      }
+      return false;
+    }
+
+    virtual void emit(const string& key, const string& value) {
+      sink->emit(key, value);
+    }
+
+    virtual void emitMove(string& key, string& value) {
+      sink->emitMove(key, value);
+    }
+
+    virtual void progress() {
+      baseContext->progress();
+    }
+
+    virtual void setStatus(const string& status) {
+      baseContext->setStatus(status);
+    }
+
+    virtual Counter* getCounter(const string& group, const string& name) {
+      return baseContext->getCounter(group, name);
+    }
+
+    virtual void incrementCounter(const Counter* counter, uint64_t amount) {
+      baseContext->incrementCounter(counter, amount);
+    }
+  };
+
   /**
    * A RecordWriter that will take the map outputs, buffer them up and then
    * combine then when the buffer is full.
    */
   class CombineRunner: public RecordWriter {
   private:
-    map<string, vector<string> > data;
+    CombineBuffer data;
     int64_t spillSize;
-    int64_t numBytes;
     ReduceContext* baseContext;
-    Partitioner* partitioner;
-    int numReduces;
-    UpwardProtocol* uplink;
+    RecordWriter* stageSink;
     Reducer* combiner;
+    uint64_t* spillCounter;
+    /**
+     * The directory for local spill runs; empty when the external sort
+     * is disabled and spills go straight up the uplink.
+     */
+    string spillDir;
+    vector<string> runFiles;
+    vector<uint64_t> runCounts;
+  public:
+    CombineRunner(int64_t _spillSize, ReduceContext* _baseContext,
+                  Reducer* _combiner, PartitionedOutputStage* _stage,
+                  const string& _spillDir,
+                  uint64_t* _spillCounter = NULL) {
+      spillSize = _spillSize;
+      baseContext = _baseContext;
+      stageSink = new StageWriter(_stage);
+      combiner = _combiner;
+      spillDir = _spillDir;
+      spillCounter = _spillCounter;
+    }
+
+    virtual void emit(const std::string& key,
+                      const std::string& value) {
+      data.add(key, value);
+      if ((int64_t) data.memoryBytes() >= spillSize) {
+        // flush the heaviest keys until half of the buffered bytes are
+        // out, so frequent keys keep combining in memory
+        if (spillDir.empty()) {
+          spillTo(stageSink, data.valueBytes() / 2);
+        } else {
+          spillToRun(data.valueBytes() / 2);
+        }
+      }
+    }
+
+    virtual void close() {
+      if (runFiles.empty()) {
+        // everything fit in memory, send it straight up
+        spillTo(stageSink, 0);
+        return;
+      }
+      if (data.valueBytes() != 0) {
+        spillToRun(0);
+      }
+      mergeRuns();
+    }
+
+    virtual ~CombineRunner() {
+      delete stageSink;
+    }
+
+  private:
+    /**
+     * Run the combiner over the selected part of the buffer into the
+     * given sink and reclaim the buffer memory. A zero target flushes
+     * everything.
+     */
+    void spillTo(RecordWriter* sink, size_t targetBytes) {
+      if (data.valueBytes() == 0) {
+        return;
+      }
+      if (spillCounter != NULL) {
+        *spillCounter += 1;
+      }
+      data.selectSpill(targetBytes);
+      CombineContext context(baseContext, sink, data);
+      while (context.nextKey()) {
+        combiner->reduce(context);
+      }
+      data.removeSpilled();
+    }
+
+    /**
+     * Spill a sorted, combined run to a local file instead of the
+     * uplink, so memory pressure costs local disk writes rather than
+     * IPC traffic.
+     */
+    void spillToRun(size_t targetBytes) {
+      string filename = spillDir + "/pipes-combine-run-" +
+        toString((int64_t) runFiles.size());
+      SpillRunWriter run(filename);
+      spillTo(&run, targetBytes);
+      run.close();
+      runFiles.push_back(filename);
+      runCounts.push_back(run.getRecords());
+    }
+
+    /**
+     * Merge the sorted spill runs, re-combining keys that appear in
+     * more than one run, and send the final stream up. The runs are
+     * removed once they are drained.
+     */
+    void mergeRuns() {
+      size_t numRuns = runFiles.size();
+      vector<FileInStream*> runs(numRuns);
+      vector<uint64_t> remaining(runCounts);
+      vector<string> keys(numRuns);
+      vector<string> values(numRuns);
+      vector<bool> active(numRuns, false);
+      for(size_t i=0; i < numRuns; ++i) {
+        runs[i] = new FileInStream();
+        HADOOP_ASSERT(runs[i]->open(runFiles[i]),
+                      "can't reopen combiner spill run " + runFiles[i]);
+        if (remaining[i] != 0) {
+          deserializeString(keys[i], *runs[i]);
+          deserializeString(values[i], *runs[i]);
+          remaining[i] -= 1;
+          active[i] = true;
+        }
+      }
+      string groupKey;
+      vector<string> groupValues;
+      MergeContext context(baseContext, stageSink);
+      while (true) {
+        int min = -1;
+        for(size_t i=0; i < numRuns; ++i) {
+          if (active[i] && (min == -1 || keys[i] < keys[min])) {
+            min = i;
+          }
+        }
+        if (min == -1) {
+          break;
+        }
+        groupKey = keys[min];
+        groupValues.clear();
+        for(size_t i=0; i < numRuns; ++i) {
+          while (active[i] && keys[i] == groupKey) {
+            groupValues.push_back(values[i]);
+            if (remaining[i] != 0) {
+              deserializeString(keys[i], *runs[i]);
+              deserializeString(values[i], *runs[i]);
+              remaining[i] -= 1;
+            } else {
+              active[i] = false;
+            }
+          }
+        }
+        if (groupValues.size() == 1) {
+          // the combiner already ran over this run's records
+          stageSink->emit(groupKey, groupValues[0]);
+        } else {
+          context.setGroup(groupKey, groupValues);
+          combiner->reduce(context);
+        }
+        baseContext->progress();
+      }
+      for(size_t i=0; i < numRuns; ++i) {
+        runs[i]->close();
+        delete runs[i];
+        remove(runFiles[i].c_str());
+      }
+      runFiles.clear();
+      runCounts.clear();
+    }
+  };
+
+  static uint64_t currentMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return ((uint64_t) tv.tv_sec) * 1000000 + tv.tv_usec;
+  }
+
+  /**
+   * An open-addressing hash registry of named counters, so repeated
+   * getCounter calls for the same (group, name) return the existing
+   * counter instead of registering a fresh id over the uplink each
+   * time. The registry owns the counters.
+   */
+  class CounterRegistry {
+  private:
+    struct Entry {
+      string key;
+      uint32_t hash;
+      TaskContext::Counter* counter;
+    };
+    vector<Entry*> entries;
+    vector<int32_t> buckets;
+
+    static uint32_t hashBytes(const char* data, size_t len) {
+      // FNV-1a
+      uint32_t result = 2166136261u;
+      for(size_t i=0; i < len; ++i) {
+        result ^= (uint8_t) data[i];
+        result *= 16777619u;
+      }
+      return result;
+    }
+
+    static string makeKey(const string& group, const string& name) {
+      string key(group);
+      key += '\0';
+      key += name;
+      return key;
+    }
+
+    size_t findBucket(const string& key, uint32_t hash) const {
+      size_t mask = buckets.size() - 1;
+      size_t idx = hash & mask;
+      while (buckets[idx] != -1) {
+        const Entry* entry = entries[buckets[idx]];
+        if (entry->hash == hash && entry->key == key) {
+          break;
+        }
+        idx = (idx + 1) & mask;
+      }
+      return idx;
+    }
+
+    void grow() {
+      size_t newSize = buckets.size() * 2;
+      buckets.assign(newSize, -1);
+      size_t mask = newSize - 1;
+      for(size_t i=0; i < entries.size(); ++i) {
+        size_t idx = entries[i]->hash & mask;
+        while (buckets[idx] != -1) {
+          idx = (idx + 1) & mask;
+        }
+        buckets[idx] = i;
+      }
+    }
+
+  public:
+    CounterRegistry() {
+      buckets.assign(64, -1);
+    }
+
+    TaskContext::Counter* find(const string& group,
+                               const string& name) const {
+      string key = makeKey(group, name);
+      uint32_t hash = hashBytes(key.data(), key.length());
+      size_t idx = findBucket(key, hash);
+      return buckets[idx] == -1 ? NULL : entries[buckets[idx]]->counter;
+    }
+
+    void add(const string& group, const string& name,
+             TaskContext::Counter* counter) {
+      Entry* entry = new Entry();
+      entry->key = makeKey(group, name);
+      entry->hash = hashBytes(entry->key.data(), entry->key.length());
+      entry->counter = counter;
+      size_t idx = findBucket(entry->key, entry->hash);
+      buckets[idx] = entries.size();
+      entries.push_back(entry);
+      if (entries.size() * 4 >= buckets.size() * 3) {
+        grow();
+      }
+    }
+
+    ~CounterRegistry() {
+      for(size_t i=0; i < entries.size(); ++i) {
+        delete entries[i]->counter;
+        delete entries[i];
+      }
+    }
+  };
+
+  /**
+   * Hot-path task metrics, only collected when hadoop.pipes.metrics is
+   * set in the job configuration. The map/reduce time is gross and
+   * includes the protocol stall and emit time measured separately, so
+   * pure user-code time is the difference.
+   */
+  struct TaskMetrics {
+    uint64_t recordsIn;
+    uint64_t bytesIn;
+    uint64_t recordsOut;
+    uint64_t bytesOut;
+    uint64_t emitMicros;
+    uint64_t protocolMicros;
+    uint64_t userMicros;
+    uint64_t combinerSpills;
+
+    TaskMetrics() {
+      recordsIn = 0;
+      bytesIn = 0;
+      recordsOut = 0;
+      bytesOut = 0;
+      emitMicros = 0;
+      protocolMicros = 0;
+      userMicros = 0;
+      combinerSpills = 0;
+    }
+
+    string report() const {
+      char buffer[512];
+      snprintf(buffer, sizeof(buffer),
+               "pipes metrics: records in=%llu bytes in=%llu "
+               "records out=%llu bytes out=%llu emit us=%llu "
+               "protocol stall us=%llu map/reduce us=%llu "
+               "combiner spills=%llu",
+               (unsigned long long) recordsIn,
+               (unsigned long long) bytesIn,
+               (unsigned long long) recordsOut,
+               (unsigned long long) bytesOut,
+               (unsigned long long) emitMicros,
+               (unsigned long long) protocolMicros,
+               (unsigned long long) userMicros,
+               (unsigned long long) combinerSpills);
+      return buffer;
+    }
+  };
+
+  /**
+   * Runs the application's map function on a pool of worker threads.
+   * The protocol thread enqueues batches of input records and each worker
+   * maps them through a private context that buffers the emitted records,
+   * merging them into the shared output path under a lock once per batch.
+   * Only used when the Factory advertises a thread-safe Mapper.
+   */
+  class ParallelMapRunner {
+  private:
+    typedef vector<std::pair<string, string> > Batch;
+    static const size_t BATCH_RECORDS = 64;
+
+    MapContext* baseContext;
+    Mapper* mapper;
+    pthread_mutex_t outputLock;
+    pthread_mutex_t queueLock;
+    pthread_cond_t queueNotEmpty;
+    pthread_cond_t queueNotFull;
+    vector<Batch*> queue;
+    size_t queueHead;
+    size_t queueLimit;
+    bool finished;
+    bool failed;
+    string failure;
+    Batch* pending;
+    vector<pthread_t> threads;
+
+    /**
+     * The per-thread view of the task. Input records are handed to it one
+     * at a time and emitted records are buffered locally, so the shared
+     * output lock is only taken once per output batch.
+     */
+    class WorkerContext: public MapContext {
+    private:
+      ParallelMapRunner* runner;
+      MapContext* base;
+      const string* key;
+      const string* value;
+      Batch output;
+    public:
+      WorkerContext(ParallelMapRunner* _runner) {
+        runner = _runner;
+        base = _runner->baseContext;
+        key = NULL;
+        value = NULL;
+      }
+
+      void setRecord(const string& _key, const string& _value) {
+        key = &_key;
+        value = &_value;
+      }
+
+      void flushOutput() {
+        if (!output.empty()) {
+          pthread_mutex_lock(&runner->outputLock);
+          for(size_t i=0; i < output.size(); ++i) {
+            // the batched strings are dead after the flush, so hand
+            // them over instead of copying them again
+            base->emitMove(output[i].first, output[i].second);
+          }
+          pthread_mutex_unlock(&runner->outputLock);
+          output.clear();
+        }
+      }
+
+      virtual const JobConf* getJobConf() {
+        return base->getJobConf();
+      }
+
+      virtual const string& getInputKey() {
+        return *key;
+      }
+
+      virtual const string& getInputValue() {
+        return *value;
+      }
+
+      virtual void emit(const string& key, const string& value) {
+        output.push_back(std::make_pair(key, value));
+        if (output.size() >= BATCH_RECORDS) {
+          flushOutput();
+        }
+      }
+
+      virtual void emitMove(string& key, string& value) {
+        output.push_back(std::make_pair(string(), string()));
+        output.back().first.swap(key);
+        output.back().second.swap(value);
+        if (output.size() >= BATCH_RECORDS) {
+          flushOutput();
+        }
+      }
+
+      virtual void progress() {
+        pthread_mutex_lock(&runner->outputLock);
+        base->progress();
+        pthread_mutex_unlock(&runner->outputLock);
+      }
+
+      virtual void setStatus(const string& status) {
+        pthread_mutex_lock(&runner->outputLock);
+        base->setStatus(status);
+        pthread_mutex_unlock(&runner->outputLock);
+      }
+
+      virtual Counter* getCounter(const string& group, const string& name) {
+        pthread_mutex_lock(&runner->outputLock);
+        Counter* result = base->getCounter(group, name);
+        pthread_mutex_unlock(&runner->outputLock);
+        return result;
+      }
+
+      virtual void incrementCounter(const Counter* counter, uint64_t amount) {
+        pthread_mutex_lock(&runner->outputLock);
+        base->incrementCounter(counter, amount);
+        pthread_mutex_unlock(&runner->outputLock);
+      }
+
+      virtual const string& getInputSplit() {
+        return base->getInputSplit();
+      }
+
+      virtual const string& getInputKeyClass() {
+        return base->getInputKeyClass();
+      }
+
+      virtual const string& getInputValueClass() {
+        return base->getInputValueClass();
+      }
+    };
+
+    static void* workerMain(void* ptr) {
+      ParallelMapRunner* runner = (ParallelMapRunner*) ptr;
+      WorkerContext context(runner);
+      try {
+        Batch* batch;
+        while ((batch = runner->popBatch()) != NULL) {
+          for(size_t i=0; i < batch->size(); ++i) {
+            context.setRecord((*batch)[i].first, (*batch)[i].second);
+            runner->mapper->map(context);
+          }
+          delete batch;
+        }
+        context.flushOutput();
+      } catch (Error& err) {
+        runner->fail(err.getMessage());
+      }
+      return NULL;
+    }
+
+    void fail(const string& message) {
+      pthread_mutex_lock(&queueLock);
+      if (!failed) {
+        failed = true;
+        failure = message;
+      }
+      pthread_cond_broadcast(&queueNotFull);
+      pthread_cond_broadcast(&queueNotEmpty);
+      pthread_mutex_unlock(&queueLock);
+    }
+
+    void pushBatch(Batch* batch) {
+      pthread_mutex_lock(&queueLock);
+      while (queue.size() - queueHead >= queueLimit && !failed) {
+        pthread_cond_wait(&queueNotFull, &queueLock);
+      }
+      queue.push_back(batch);
+      pthread_cond_signal(&queueNotEmpty);
+      pthread_mutex_unlock(&queueLock);
+    }
+
+    Batch* popBatch() {
+      pthread_mutex_lock(&queueLock);
+      while (queue.size() == queueHead && !finished && !failed) {
+        pthread_cond_wait(&queueNotEmpty, &queueLock);
+      }
+      Batch* result = NULL;
+      if (queue.size() > queueHead && !failed) {
+        result = queue[queueHead];
+        queueHead += 1;
+        if (queueHead == queue.size()) {
+          queue.clear();
+          queueHead = 0;
+        }
+        pthread_cond_signal(&queueNotFull);
+      }
+      pthread_mutex_unlock(&queueLock);
+      return result;
+    }
+
+    void checkFailure() {
+      if (failed) {
+        throw Error("Parallel mapper failed: " + failure);
+      }
+    }
+
   public:
-    CombineRunner(int64_t _spillSize, ReduceContext* _baseContext, 
-                  Reducer* _combiner, UpwardProtocol* _uplink, 
-                  Partitioner* _partitioner, int _numReduces) {
-      numBytes = 0;
-      spillSize = _spillSize;
+    ParallelMapRunner(MapContext* _baseContext, Mapper* _mapper,
+                      int numThreads) {
       baseContext = _baseContext;
-      partitioner = _partitioner;
-      numReduces = _numReduces;
-      uplink = _uplink;
-      combiner = _combiner;
+      mapper = _mapper;
+      queueHead = 0;
+      queueLimit = numThreads * 4;
+      finished = false;
+      failed = false;
+      pending = NULL;
+      pthread_mutexattr_t attr;
+      pthread_mutexattr_init(&attr);
+      pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+      pthread_mutex_init(&outputLock, &attr);
+      pthread_mutexattr_destroy(&attr);
+      pthread_mutex_init(&queueLock, NULL);
+      pthread_cond_init(&queueNotEmpty, NULL);
+      pthread_cond_init(&queueNotFull, NULL);
+      threads.resize(numThreads);
+      for(int i=0; i < numThreads; ++i) {
+        HADOOP_ASSERT(pthread_create(&threads[i], NULL, workerMain,
+                                     this) == 0,
+                      "problem creating mapper worker thread");
+      }
     }
 
-    virtual void emit(const std::string& key,
-                      const std::string& value) {
-      numBytes += key.length() + value.length();
-      data[key].push_back(value);
-      if (numBytes >= spillSize) {
-        spillAll();
+    /**
+     * Hand a record to the worker pool. Called from the protocol thread.
+     */
+    void map(const string& key, const string& value) {
+      checkFailure();
+      if (pending == NULL) {
+        pending = new Batch();
+      }
+      pending->push_back(std::make_pair(key, value));
+      if (pending->size() >= BATCH_RECORDS) {
+        pushBatch(pending);
+        pending = NULL;
       }
     }
 
-    virtual void close() {
-      spillAll();
+    pthread_mutex_t* getOutputLock() {
+      return &outputLock;
     }
 
-  private:
-    void spillAll() {
-      CombineContext context(baseContext, partitioner, numReduces, 
-                             uplink, data);
-      while (context.nextKey()) {
-        combiner->reduce(context);
+    /**
+     * Wait for the workers to drain the queue and shut them down.
+     */
+    void close() {
+      if (pending != NULL) {
+        pushBatch(pending);
+        pending = NULL;
       }
-      data.clear();
+      pthread_mutex_lock(&queueLock);
+      finished = true;
+      pthread_cond_broadcast(&queueNotEmpty);
+      pthread_mutex_unlock(&queueLock);
+      for(size_t i=0; i < threads.size(); ++i) {
+        pthread_join(threads[i], NULL);
+      }
+      checkFailure();
+    }
+
+    ~ParallelMapRunner() {
+      pthread_mutex_destroy(&outputLock);
+      pthread_mutex_destroy(&queueLock);
+      pthread_cond_destroy(&queueNotEmpty);
+      pthread_cond_destroy(&queueNotFull);
     }
   };
 
-  class TaskContextImpl: public MapContext, public ReduceContext, 
+  class TaskContextImpl: public MapContext, public ReduceContext,
                          public DownwardProtocol {
   private:
-    bool done;
+    /**
+     * Set once when the task finishes and read on the per-record hot
+     * path and by the ping thread, so it is a volatile flag instead of a
+     * mutex-protected bool.
+     */
+    volatile bool done;
+    /**
+     * Set once the process will run no more tasks. The done flag goes
+     * back to false when a reused worker resets for its next task, so
+     * the ping thread watches this one instead.
+     */
+    volatile bool finished;
     JobConf* jobConf;
     string key;
+    const string* currentKey;
     const string* newKey;
     const string* value;
+    bool zeroCopyInput;
     bool hasTask;
     bool isNewKey;
     bool isNewValue;
@@ -621,37 +2829,70 @@ namespace HadoopPipes {
     string* inputSplit;
     RecordReader* reader;
     Mapper* mapper;
+    ParallelMapRunner* parallelMap;
     Reducer* reducer;
     RecordWriter* writer;
     Partitioner* partitioner;
+    PartitionedOutputStage* outputStage;
     int numReduces;
     const Factory* factory;
-    pthread_mutex_t mutexDone;
-    std::vector<int> registeredCounterIds;
+    CounterRegistry counters;
+    /**
+     * Locally aggregated counter deltas indexed by counter id. They are
+     * flushed on the progress cadence and at close instead of sending an
+     * uplink frame per increment.
+     */
+    std::vector<uint64_t> counterDeltas;
+    /**
+     * Records from a batched protocol message that have not been consumed
+     * yet. The vectors are owned by the protocol and stay valid until the
+     * next protocol event, which is only read once the batch is drained.
+     */
+    const vector<string>* batchKeys;
+    const vector<string>* batchValues;
+    size_t batchPos;
+    bool metricsEnabled;
+    TaskMetrics metrics;
+    /**
+     * The downlink flow-control window in records, 0 when disabled, and
+     * the records consumed since the last credit grant.
+     */
+    int downlinkWindow;
+    int recordsSinceCredit;
 
   public:
 
     TaskContextImpl(const Factory& _factory) {
       statusSet = false;
       done = false;
+      finished = false;
+      currentKey = &key;
       newKey = NULL;
+      zeroCopyInput = false;
       factory = &_factory;
       jobConf = NULL;
       inputKeyClass = NULL;
       inputValueClass = NULL;
       inputSplit = NULL;
       mapper = NULL;
+      parallelMap = NULL;
       reducer = NULL;
       reader = NULL;
       writer = NULL;
       partitioner = NULL;
+      outputStage = NULL;
       protocol = NULL;
       isNewKey = false;
       isNewValue = false;
       lastProgress = 0;
       progressFloat = 0.0f;
       hasTask = false;
-      pthread_mutex_init(&mutexDone, NULL);
+      batchKeys = NULL;
+      batchValues = NULL;
+      batchPos = 0;
+      metricsEnabled = false;
+      downlinkWindow = 0;
+      recordsSinceCredit = 0;
     }
 
     void setProtocol(Protocol* _protocol, UpwardProtocol* _uplink) {
@@ -661,18 +2902,19 @@ namespace HadoopPipes {
     }
 
     virtual void start(int protocol) {
-      if (protocol != 0) {
-        throw Error("Protocol version " + toString(protocol) + 
+      if (protocol != 0 && protocol != BATCH_PROTOCOL_VERSION &&
+          protocol != COMPRESSION_PROTOCOL_VERSION) {
+        throw Error("Protocol version " + toString(protocol) +
                     " not supported");
       }
     }
 
-    virtual void setJobConf(vector<string> values) {
+    virtual void setJobConf(vector<string>& values) {
       int len = values.size();
       JobConfImpl* result = new JobConfImpl();
       HADOOP_ASSERT(len % 2 == 0, "Odd length of job conf values");
       for(int i=0; i < len; i += 2) {
-        result->set(values[i], values[i+1]);
+        result->adopt(values[i], values[i+1]);
       }
       jobConf = result;
     }
@@ -693,28 +2935,81 @@ namespace HadoopPipes {
       }
       mapper = factory->createMapper(*this);
       numReduces = _numReduces;
+      if (jobConf->hasKey("hadoop.pipes.zerocopy.input")) {
+        zeroCopyInput = jobConf->getBoolean("hadoop.pipes.zerocopy.input");
+      }
+      if (jobConf->hasKey("hadoop.pipes.metrics")) {
+        metricsEnabled = jobConf->getBoolean("hadoop.pipes.metrics");
+      }
+      setupDownlinkWindow();
+      if (jobConf->hasKey("hadoop.pipes.uplink.key.delta") &&
+          jobConf->getBoolean("hadoop.pipes.uplink.key.delta")) {
+        uplink->enableKeyDelta();
+      }
       if (numReduces != 0) { 
         reducer = factory->createCombiner(*this);
         partitioner = factory->createPartitioner(*this);
       }
+      size_t stageBytes = 0;
+      if (partitioner != NULL &&
+          jobConf->hasKey("hadoop.pipes.partition.buffer.kb")) {
+        stageBytes =
+          jobConf->getInt("hadoop.pipes.partition.buffer.kb") * 1024;
+      }
+      outputStage = new PartitionedOutputStage(uplink, partitioner,
+                                               numReduces, stageBytes);
       if (reducer != NULL) {
         int64_t spillSize = 100;
         if (jobConf->hasKey("io.sort.mb")) {
           spillSize = jobConf->getInt("io.sort.mb");
         }
-        writer = new CombineRunner(spillSize * 1024 * 1024, this, reducer, 
-                                   uplink, partitioner, numReduces);
+        string spillDir;
+        if (jobConf->hasKey("hadoop.pipes.combiner.spill.local") &&
+            jobConf->getBoolean("hadoop.pipes.combiner.spill.local")) {
+          // the task runs in its job-local work directory
+          spillDir = jobConf->hasKey("hadoop.pipes.combiner.spill.dir")
+            ? jobConf->get("hadoop.pipes.combiner.spill.dir") : ".";
+        }
+        writer = new CombineRunner(spillSize * 1024 * 1024, this, reducer,
+                                   outputStage, spillDir,
+                                   &metrics.combinerSpills);
+      }
+      int mapperThreads = factory->getNumberOfMapperThreads(*this);
+      if (mapperThreads > 1) {
+        parallelMap = new ParallelMapRunner(this, mapper, mapperThreads);
       }
       hasTask = true;
     }
 
     virtual void mapItem(const string& _key, const string& _value) {
+      consumedRecords(1);
       newKey = &_key;
       value = &_value;
       isNewKey = true;
     }
 
+    virtual void mapItemBatch(const vector<string>& _keys,
+                              const vector<string>& _values) {
+      HADOOP_ASSERT(_keys.size() == _values.size() && !_keys.empty(),
+                    "Malformed map item batch");
+      consumedRecords(_keys.size());
+      batchKeys = &_keys;
+      batchValues = &_values;
+      newKey = &_keys[0];
+      value = &_values[0];
+      batchPos = 1;
+      isNewKey = true;
+    }
+
     virtual void runReduce(int reduce, bool pipedOutput) {
+      if (jobConf != NULL && jobConf->hasKey("hadoop.pipes.metrics")) {
+        metricsEnabled = jobConf->getBoolean("hadoop.pipes.metrics");
+      }
+      setupDownlinkWindow();
+      if (jobConf != NULL && jobConf->hasKey("hadoop.pipes.uplink.key.delta") &&
+          jobConf->getBoolean("hadoop.pipes.uplink.key.delta")) {
+        uplink->enableKeyDelta();
+      }
       reducer = factory->createReducer(*this);
       writer = factory->createRecordWriter(*this);
       HADOOP_ASSERT((writer == NULL) == pipedOutput,
@@ -724,32 +3019,88 @@ namespace HadoopPipes {
     }
 
     virtual void reduceKey(const string& _key) {
+      consumedRecords(1);
       isNewKey = true;
       newKey = &_key;
     }
 
     virtual void reduceValue(const string& _value) {
+      consumedRecords(1);
       isNewValue = true;
       value = &_value;
     }
-    
+
+    virtual void reduceValueBatch(const vector<string>& _values) {
+      HADOOP_ASSERT(!_values.empty(), "Empty reduce value batch");
+      consumedRecords(_values.size());
+      batchKeys = NULL;
+      batchValues = &_values;
+      value = &_values[0];
+      batchPos = 1;
+      isNewValue = true;
+    }
+
     virtual bool isDone() {
-      pthread_mutex_lock(&mutexDone);
-      bool doneCopy = done;
-      pthread_mutex_unlock(&mutexDone);
-      return doneCopy;
+      return done;
+    }
+
+    bool isFinished() {
+      return finished;
+    }
+
+    /**
+     * Mark the process as having run its last task; the ping thread
+     * shuts down on this.
+     */
+    void markFinished() {
+      finished = true;
+      __sync_synchronize();
+    }
+
+    bool hasAssignedTask() {
+      return hasTask;
     }
 
     virtual void close() {
-      pthread_mutex_lock(&mutexDone);
       done = true;
-      pthread_mutex_unlock(&mutexDone);
+      __sync_synchronize();
     }
 
     virtual void abort() {
       throw Error("Aborted by driver");
     }
 
+    /**
+     * Read the downlink flow-control window from the job configuration.
+     * The parent starts with a full window of credit, so only the
+     * replenishments are sent from here.
+     */
+    void setupDownlinkWindow() {
+      if (jobConf != NULL &&
+          jobConf->hasKey("hadoop.pipes.downlink.window.records")) {
+        downlinkWindow = jobConf->getInt("hadoop.pipes.downlink.window.records");
+        if (downlinkWindow > 0 && downlinkWindow < 2) {
+          downlinkWindow = 2;
+        }
+      }
+    }
+
+    /**
+     * Count consumed record frames and grant the parent fresh credit
+     * every half window, so grants stay rare but the parent never runs
+     * dry while we are keeping up.
+     */
+    void consumedRecords(int records) {
+      if (downlinkWindow <= 0) {
+        return;
+      }
+      recordsSinceCredit += records;
+      if (recordsSinceCredit * 2 >= downlinkWindow) {
+        uplink->downlinkCredit(recordsSinceCredit);
+        recordsSinceCredit = 0;
+      }
+    }
+
     void waitForTask() {
       while (!done && !hasTask) {
         protocol->nextEvent();
@@ -764,22 +3115,42 @@ namespace HadoopPipes {
             return false;
           }
         }
-        key = *newKey;
+        if (zeroCopyInput && mapper != NULL) {
+          // leave the key in the protocol read buffer; the reference stays
+          // valid until the next record is fetched
+          currentKey = newKey;
+        } else {
+          key = *newKey;
+          currentKey = &key;
+        }
       } else {
         if (!reader->next(key, const_cast<string&>(*value))) {
-          pthread_mutex_lock(&mutexDone);
           done = true;
-          pthread_mutex_unlock(&mutexDone);
+          __sync_synchronize();
           return false;
         }
         progressFloat = reader->getProgress();
       }
       isNewKey = false;
+      uint64_t userStart = 0;
+      if (metricsEnabled) {
+        metrics.recordsIn += 1;
+        metrics.bytesIn += currentKey->length() +
+          (value != NULL ? value->length() : 0);
+        userStart = currentMicros();
+      }
       if (mapper != NULL) {
-        mapper->map(*this);
+        if (parallelMap != NULL) {
+          parallelMap->map(*currentKey, *value);
+        } else {
+          mapper->map(*this);
+        }
       } else {
         reducer->reduce(*this);
       }
+      if (metricsEnabled) {
+        metrics.userMicros += currentMicros() - userStart;
+      }
       return true;
     }
 
@@ -792,7 +3163,29 @@ namespace HadoopPipes {
       }
       isNewValue = false;
       progress();
-      protocol->nextEvent();
+      if (batchValues != NULL && batchPos < batchValues->size()) {
+        // consume the next record of the current batch before reading
+        // another protocol event
+        if (batchKeys != NULL) {
+          newKey = &(*batchKeys)[batchPos];
+          value = &(*batchValues)[batchPos];
+          isNewKey = true;
+        } else {
+          value = &(*batchValues)[batchPos];
+          isNewValue = true;
+        }
+        batchPos += 1;
+      } else {
+        batchKeys = NULL;
+        batchValues = NULL;
+        if (metricsEnabled) {
+          uint64_t start = currentMicros();
+          protocol->nextEvent();
+          metrics.protocolMicros += currentMicros() - start;
+        } else {
+          protocol->nextEvent();
+        }
+      }
       return isNewValue;
     }
 
@@ -808,7 +3201,7 @@ namespace HadoopPipes {
      * @return the current key or NULL if called before the first map or reduce
      */
     virtual const string& getInputKey() {
-      return key;
+      return *currentKey;
     }
 
     /**
@@ -825,10 +3218,14 @@ namespace HadoopPipes {
      * message.
      */
     virtual void progress() {
+      if (parallelMap != NULL) {
+        pthread_mutex_lock(parallelMap->getOutputLock());
+      }
       if (uplink != 0) {
         uint64_t now = getCurrentMillis();
         if (now - lastProgress > 1000) {
           lastProgress = now;
+          flushCounters();
           if (statusSet) {
             uplink->status(status);
             statusSet = false;
@@ -836,6 +3233,9 @@ namespace HadoopPipes {
           uplink->progress(progressFloat);
         }
       }
+      if (parallelMap != NULL) {
+        pthread_mutex_unlock(parallelMap->getOutputLock());
+      }
     }
 
     /**
@@ -870,38 +3270,90 @@ namespace HadoopPipes {
 
     virtual void emit(const string& key, const string& value) {
       progress();
+      uint64_t emitStart = 0;
+      if (metricsEnabled) {
+        metrics.recordsOut += 1;
+        metrics.bytesOut += key.length() + value.length();
+        emitStart = currentMicros();
+      }
       if (writer != NULL) {
         writer->emit(key, value);
-      } else if (partitioner != NULL) {
-        int part = partitioner->partition(key, numReduces);
-        uplink->partitionedOutput(part, key, value);
+      } else if (outputStage != NULL) {
+        outputStage->emit(key, value);
+      } else {
+        uplink->output(key, value);
+      }
+      if (metricsEnabled) {
+        metrics.emitMicros += currentMicros() - emitStart;
+      }
+    }
+
+    virtual void emitMove(string& key, string& value) {
+      progress();
+      uint64_t emitStart = 0;
+      if (metricsEnabled) {
+        metrics.recordsOut += 1;
+        metrics.bytesOut += key.length() + value.length();
+        emitStart = currentMicros();
+      }
+      if (writer != NULL) {
+        writer->emitMove(key, value);
+      } else if (outputStage != NULL) {
+        outputStage->emitMove(key, value);
       } else {
         uplink->output(key, value);
       }
+      if (metricsEnabled) {
+        metrics.emitMicros += currentMicros() - emitStart;
+      }
     }
 
     /**
      * Register a counter with the given group and name.
      */
-    virtual Counter* getCounter(const std::string& group, 
+    virtual Counter* getCounter(const std::string& group,
                                const std::string& name) {
-      int id = registeredCounterIds.size();
-      registeredCounterIds.push_back(id);
+      Counter* existing = counters.find(group, name);
+      if (existing != NULL) {
+        return existing;
+      }
+      int id = counterDeltas.size();
+      counterDeltas.push_back(0);
       uplink->registerCounter(id, group, name);
-      return new Counter(id);
+      Counter* result = new Counter(id);
+      counters.add(group, name, result);
+      return result;
     }
 
     /**
      * Increment the value of the counter with the given amount.
+     * The delta is aggregated locally and sent with the next counter
+     * flush.
      */
     virtual void incrementCounter(const Counter* counter, uint64_t amount) {
-      uplink->incrementCounter(counter, amount); 
+      counterDeltas[counter->getId()] += amount;
+    }
+
+    /**
+     * Send the aggregated counter deltas up and reset them.
+     */
+    void flushCounters() {
+      for(size_t i=0; i < counterDeltas.size(); ++i) {
+        if (counterDeltas[i] != 0) {
+          Counter counter(i);
+          uplink->incrementCounter(&counter, counterDeltas[i]);
+          counterDeltas[i] = 0;
+        }
+      }
     }
 
     void closeAll() {
       if (reader) {
         reader->close();
       }
+      if (parallelMap) {
+        parallelMap->close();
+      }
       if (mapper) {
         mapper->close();
       }
@@ -911,6 +3363,79 @@ namespace HadoopPipes {
       if (writer) {
         writer->close();
       }
+      if (outputStage) {
+        outputStage->flush();
+      }
+      flushCounters();
+      if (metricsEnabled) {
+        string report = metrics.report();
+        uplink->status(report);
+        fprintf(stderr, "%s\n", report.c_str());
+      }
+    }
+
+    /**
+     * Tear down the finished task and get ready to accept another
+     * SET_JOB_CONF/RUN_MAP or RUN_REDUCE sequence on the same
+     * connection. Counters stay registered, since the parent on the
+     * other end of the connection already knows their ids; everything
+     * else is rebuilt from the next task's job configuration.
+     * @return true if the finished task asked for worker reuse and
+     *    another task should be awaited, false to keep the classic
+     *    one-task process lifecycle
+     */
+    bool resetForNextTask() {
+      if (jobConf == NULL ||
+          !jobConf->hasKey("hadoop.pipes.worker.reuse") ||
+          !jobConf->getBoolean("hadoop.pipes.worker.reuse")) {
+        return false;
+      }
+      delete jobConf;
+      jobConf = NULL;
+      delete inputKeyClass;
+      inputKeyClass = NULL;
+      delete inputValueClass;
+      inputValueClass = NULL;
+      delete inputSplit;
+      inputSplit = NULL;
+      if (reader) {
+        delete value;
+      }
+      delete reader;
+      reader = NULL;
+      delete parallelMap;
+      parallelMap = NULL;
+      delete mapper;
+      mapper = NULL;
+      delete reducer;
+      reducer = NULL;
+      delete writer;
+      writer = NULL;
+      delete outputStage;
+      outputStage = NULL;
+      delete partitioner;
+      partitioner = NULL;
+      key.clear();
+      currentKey = &key;
+      newKey = NULL;
+      value = NULL;
+      zeroCopyInput = false;
+      isNewKey = false;
+      isNewValue = false;
+      statusSet = false;
+      progressFloat = 0.0f;
+      batchKeys = NULL;
+      batchValues = NULL;
+      batchPos = 0;
+      metricsEnabled = false;
+      metrics = TaskMetrics();
+      downlinkWindow = 0;
+      recordsSinceCredit = 0;
+      uplink->resetTask();
+      hasTask = false;
+      done = false;
+      __sync_synchronize();
+      return true;
     }
 
     virtual ~TaskContextImpl() {
@@ -922,59 +3447,80 @@ namespace HadoopPipes {
         delete value;
       }
       delete reader;
+      delete parallelMap;
       delete mapper;
       delete reducer;
       delete writer;
+      delete outputStage;
       delete partitioner;
-      pthread_mutex_destroy(&mutexDone);
     }
   };
 
   /**
-   * Ping the parent every 5 seconds to know if it is alive 
+   * Ping the parent every 5 seconds to know if it is alive.
+   * A single connection is kept open for the lifetime of the task and
+   * polled for errors, instead of paying connect and teardown for every
+   * ping.
    */
   void* ping(void* ptr) {
     TaskContextImpl* context = (TaskContextImpl*) ptr;
     char* portStr = getenv("hadoop.pipes.command.port");
     int MAX_RETRIES = 3;
     int remaining_retries = MAX_RETRIES;
-    while (!context->isDone()) {
+    int sock = -1;
+    while (!context->isFinished()) {
       try{
         sleep(5);
-        int sock = -1;
         if (portStr) {
-          sock = socket(PF_INET, SOCK_STREAM, 0);
-          HADOOP_ASSERT(sock != - 1,
-                        string("problem creating socket: ") + strerror(errno));
-          sockaddr_in addr;
-          addr.sin_family = AF_INET;
-          addr.sin_port = htons(toInt(portStr));
-          addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-          HADOOP_ASSERT(connect(sock, (sockaddr*) &addr, sizeof(addr)) == 0,
-                        string("problem connecting command socket: ") +
-                        strerror(errno));
-
-        }
-        if (sock != -1) {
-          int result = shutdown(sock, SHUT_RDWR);
-          HADOOP_ASSERT(result == 0, "problem shutting socket");
-          result = close(sock);
-          HADOOP_ASSERT(result == 0, "problem closing socket");
+          if (sock == -1) {
+            sock = socket(PF_INET, SOCK_STREAM, 0);
+            HADOOP_ASSERT(sock != - 1,
+                          string("problem creating socket: ") +
+                          strerror(errno));
+            sockaddr_in addr;
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(toInt(portStr));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (connect(sock, (sockaddr*) &addr, sizeof(addr)) != 0) {
+              close(sock);
+              sock = -1;
+              HADOOP_ASSERT(false,
+                            string("problem connecting command socket: ") +
+                            strerror(errno));
+            }
+          }
+          pollfd pfd;
+          pfd.fd = sock;
+          pfd.events = POLLIN;
+          pfd.revents = 0;
+          int result = poll(&pfd, 1, 0);
+          if (result > 0 && (pfd.revents & (POLLERR | POLLHUP)) != 0) {
+            close(sock);
+            sock = -1;
+            HADOOP_ASSERT(false, "ping connection lost");
+          }
         }
         remaining_retries = MAX_RETRIES;
       } catch (Error& err) {
-        if (!context->isDone()) {
-          fprintf(stderr, "Hadoop Pipes Exception: in ping %s\n", 
+        if (!context->isFinished()) {
+          fprintf(stderr, "Hadoop Pipes Exception: in ping %s\n",
                 err.getMessage().c_str());
           remaining_retries -= 1;
           if (remaining_retries == 0) {
             exit(1);
           }
         } else {
+          if (sock != -1) {
+            close(sock);
+          }
           return NULL;
         }
       }
     }
+    if (sock != -1) {
+      shutdown(sock, SHUT_RDWR);
+      close(sock);
+    }
     return NULL;
   }
 
@@ -987,14 +3533,50 @@ namespace HadoopPipes {
   bool runTask(const Factory& factory) {
     try {
       TaskContextImpl* context = new TaskContextImpl(factory);
-      Protocol* connection;
+      Protocol* connection = NULL;
+      DownwardProtocol* handler = context;
+      PrefetchProtocol* prefetch = NULL;
+      char* prefetchStr = getenv("hadoop.pipes.prefetch.depth");
+      if (prefetchStr != NULL) {
+        // decode downlink events ahead on a helper thread
+        prefetch = new PrefetchProtocol(context, toInt(prefetchStr));
+        handler = prefetch;
+      }
       char* portStr = getenv("hadoop.pipes.command.port");
       int sock = -1;
       FILE* stream = NULL;
       FILE* outStream = NULL;
       char *bufin = NULL;
       char *bufout = NULL;
-      if (portStr) {
+      char* shmFile = getenv("hadoop.pipes.shm.file");
+      char* shmSize = getenv("hadoop.pipes.shm.size");
+      if (shmFile != NULL && shmSize != NULL) {
+        // the parent offered a shared memory command channel; fall back
+        // to the socket if the mapping fails
+        int shmFd = open(shmFile, O_RDWR);
+        if (shmFd != -1) {
+          size_t bytes = toInt(shmSize);
+          void* base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                            shmFd, 0);
+          close(shmFd);
+          if (base != MAP_FAILED) {
+            size_t half = bytes / 2;
+            connection =
+              new BinaryProtocol(new ShmInStream((char*) base, half),
+                                 handler,
+                                 new ShmOutStream(((char*) base) + half,
+                                                  half));
+          }
+        }
+        if (connection == NULL) {
+          fprintf(stderr,
+                  "Hadoop Pipes: cannot map %s, falling back to socket\n",
+                  shmFile);
+        }
+      }
+      if (connection != NULL) {
+        // connected through shared memory
+      } else if (portStr) {
         sock = socket(PF_INET, SOCK_STREAM, 0);
         HADOOP_ASSERT(sock != - 1,
                       string("problem creating socket: ") + strerror(errno));
@@ -1021,26 +3603,59 @@ namespace HadoopPipes {
         HADOOP_ASSERT(setbuf == 0, string("problem with setvbuf for outStream: ")
                                      + strerror(errno));
 
-        connection = new BinaryProtocol(stream, context, outStream);
+        char* recordFile = getenv("hadoop.pipes.downlink.record");
+        if (recordFile != NULL) {
+          // capture the downlink bytes for offline replay
+          FileInStream* rawIn = new FileInStream();
+          rawIn->open(stream);
+          FileOutStream* rawOut = new FileOutStream();
+          rawOut->open(outStream);
+          connection = new BinaryProtocol(new TeeInStream(rawIn, recordFile),
+                                          handler, rawOut);
+        } else {
+          connection = new BinaryProtocol(stream, handler, outStream);
+        }
       } else if (getenv("hadoop.pipes.command.file")) {
         char* filename = getenv("hadoop.pipes.command.file");
         string outFilename = filename;
         outFilename += ".out";
-        stream = fopen(filename, "r");
         outStream = fopen(outFilename.c_str(), "w");
-        connection = new BinaryProtocol(stream, context, outStream);
+        FileOutStream* rawOut = new FileOutStream();
+        rawOut->open(outStream);
+        // the command file is complete on disk, map it instead of
+        // streaming it through stdio
+        connection = new BinaryProtocol(new MemoryMappedInStream(filename),
+                                        handler, rawOut);
       } else {
-        connection = new TextProtocol(stdin, context, stdout);
+        connection = new TextProtocol(stdin, handler, stdout);
+      }
+      if (prefetch != NULL) {
+        prefetch->startDecoding(connection);
+        connection = prefetch;
       }
       context->setProtocol(connection, connection->getUplink());
       pthread_t pingThread;
       pthread_create(&pingThread, NULL, ping, (void*)(context));
-      context->waitForTask();
-      while (!context->isDone()) {
-        context->nextKey();
+      bool firstTask = true;
+      bool moreTasks = true;
+      while (moreTasks) {
+        context->waitForTask();
+        if (!firstTask && !context->hasAssignedTask()) {
+          // a reused worker closed while idle: the parent has no more
+          // tasks for it and is not waiting for another done frame
+          break;
+        }
+        while (!context->isDone()) {
+          context->nextKey();
+        }
+        context->closeAll();
+        connection->getUplink()->done();
+        firstTask = false;
+        // a task that set hadoop.pipes.worker.reuse leaves the process
+        // alive to serve the next task sent over the same connection
+        moreTasks = context->resetForNextTask();
       }
-      context->closeAll();
-      connection->getUplink()->done();
+      context->markFinished();
       pthread_join(pingThread,NULL);
       delete context;
       delete connection;
@@ -1067,7 +3682,265 @@ namespace HadoopPipes {
       delete bufout;
       return true;
     } catch (Error& err) {
-      fprintf(stderr, "Hadoop Pipes Exception: %s\n", 
+      fprintf(stderr, "Hadoop Pipes Exception: %s\n",
+              err.getMessage().c_str());
+      return false;
+    }
+  }
+
+  /**
+   * Per-message-type counters and log2 microsecond latency histograms
+   * collected while replaying a recorded downlink session.
+   */
+  class BenchmarkStats {
+  private:
+    static const int NUM_TYPES = 12;
+    static const int NUM_BUCKETS = 24;
+    uint64_t counts[NUM_TYPES];
+    uint64_t totalMicros[NUM_TYPES];
+    uint64_t buckets[NUM_TYPES][NUM_BUCKETS];
+  public:
+    uint64_t records;
+    uint64_t recordBytes;
+
+    BenchmarkStats() {
+      memset(counts, 0, sizeof(counts));
+      memset(totalMicros, 0, sizeof(totalMicros));
+      memset(buckets, 0, sizeof(buckets));
+      records = 0;
+      recordBytes = 0;
+    }
+
+    void add(int type, uint64_t micros) {
+      counts[type] += 1;
+      totalMicros[type] += micros;
+      int bucket = 0;
+      while (micros > 1 && bucket < NUM_BUCKETS - 1) {
+        micros >>= 1;
+        bucket += 1;
+      }
+      buckets[type][bucket] += 1;
+    }
+
+    void print(FILE* out) const {
+      static const char* names[NUM_TYPES] =
+        {"START_MESSAGE", "SET_JOB_CONF", "SET_INPUT_TYPES", "RUN_MAP",
+         "MAP_ITEM", "RUN_REDUCE", "REDUCE_KEY", "REDUCE_VALUE",
+         "CLOSE", "ABORT", "MAP_ITEM_BATCH", "REDUCE_VALUE_BATCH"};
+      for(int type=0; type < NUM_TYPES; ++type) {
+        if (counts[type] == 0) {
+          continue;
+        }
+        fprintf(out, "%s: %llu messages, %llu us total\n", names[type],
+                (unsigned long long) counts[type],
+                (unsigned long long) totalMicros[type]);
+        for(int bucket=0; bucket < NUM_BUCKETS; ++bucket) {
+          if (buckets[type][bucket] != 0) {
+            fprintf(out, "  <= %llu us: %llu\n",
+                    (unsigned long long) (1ull << bucket),
+                    (unsigned long long) buckets[type][bucket]);
+          }
+        }
+      }
+    }
+  };
+
+  /**
+   * Forwards downlink events to the real handler, timing each call and
+   * counting the input records.
+   */
+  class BenchmarkDownwardProtocol: public DownwardProtocol {
+  private:
+    DownwardProtocol* target;
+    BenchmarkStats* stats;
+
+    uint64_t begin() {
+      return currentMicros();
+    }
+
+    void end(int type, uint64_t start) {
+      stats->add(type, currentMicros() - start);
+    }
+
+  public:
+    BenchmarkDownwardProtocol(DownwardProtocol* _target,
+                              BenchmarkStats* _stats) {
+      target = _target;
+      stats = _stats;
+    }
+
+    virtual void start(int protocol) {
+      uint64_t t = begin();
+      target->start(protocol);
+      end(START_MESSAGE, t);
+    }
+
+    virtual void setJobConf(vector<string>& values) {
+      uint64_t t = begin();
+      target->setJobConf(values);
+      end(SET_JOB_CONF, t);
+    }
+
+    virtual void setInputTypes(string keyType, string valueType) {
+      uint64_t t = begin();
+      target->setInputTypes(keyType, valueType);
+      end(SET_INPUT_TYPES, t);
+    }
+
+    virtual void runMap(string inputSplit, int numReduces, bool pipedInput) {
+      uint64_t t = begin();
+      target->runMap(inputSplit, numReduces, pipedInput);
+      end(RUN_MAP, t);
+    }
+
+    virtual void mapItem(const string& key, const string& value) {
+      stats->records += 1;
+      stats->recordBytes += key.length() + value.length();
+      uint64_t t = begin();
+      target->mapItem(key, value);
+      end(MAP_ITEM, t);
+    }
+
+    virtual void mapItemBatch(const vector<string>& keys,
+                              const vector<string>& values) {
+      stats->records += keys.size();
+      for(size_t i=0; i < keys.size(); ++i) {
+        stats->recordBytes += keys[i].length() + values[i].length();
+      }
+      uint64_t t = begin();
+      target->mapItemBatch(keys, values);
+      end(MAP_ITEM_BATCH, t);
+    }
+
+    virtual void runReduce(int reduce, bool pipedOutput) {
+      uint64_t t = begin();
+      target->runReduce(reduce, pipedOutput);
+      end(RUN_REDUCE, t);
+    }
+
+    virtual void reduceKey(const string& key) {
+      uint64_t t = begin();
+      target->reduceKey(key);
+      end(REDUCE_KEY, t);
+    }
+
+    virtual void reduceValue(const string& value) {
+      stats->records += 1;
+      stats->recordBytes += value.length();
+      uint64_t t = begin();
+      target->reduceValue(value);
+      end(REDUCE_VALUE, t);
+    }
+
+    virtual void reduceValueBatch(const vector<string>& values) {
+      stats->records += values.size();
+      for(size_t i=0; i < values.size(); ++i) {
+        stats->recordBytes += values[i].length();
+      }
+      uint64_t t = begin();
+      target->reduceValueBatch(values);
+      end(REDUCE_VALUE_BATCH, t);
+    }
+
+    virtual void close() {
+      target->close();
+    }
+
+    virtual void abort() {
+      target->abort();
+    }
+  };
+
+  /**
+   * An UpwardProtocol that counts the emitted records and bytes and
+   * discards them, so the replay measures only the C++ side.
+   */
+  class BenchmarkUpwardProtocol: public UpwardProtocol {
+  public:
+    uint64_t records;
+    uint64_t recordBytes;
+
+    BenchmarkUpwardProtocol() {
+      records = 0;
+      recordBytes = 0;
+    }
+
+    virtual void output(const string& key, const string& value) {
+      records += 1;
+      recordBytes += key.length() + value.length();
+    }
+
+    virtual void partitionedOutput(int reduce, const string& key,
+                                   const string& value) {
+      records += 1;
+      recordBytes += key.length() + value.length();
+    }
+
+    virtual void status(const string& message) {}
+    virtual void progress(float progress) {}
+    virtual void done() {}
+    virtual void registerCounter(int id, const string& group,
+                                 const string& name) {}
+    virtual void incrementCounter(const TaskContext::Counter* counter,
+                                  uint64_t amount) {}
+  };
+
+  /**
+   * Replay a recorded binary downlink stream into the given factory at
+   * full speed, reporting throughput and per-message-type latency.
+   * @return true, if the replay succeeded.
+   */
+  bool runBenchmark(const Factory& factory, const string& commandFile) {
+    try {
+      TaskContextImpl* context = new TaskContextImpl(factory);
+      FileInStream* downStream = new FileInStream();
+      HADOOP_ASSERT(downStream->open(commandFile),
+                    "cannot open command file " + commandFile);
+      BenchmarkStats stats;
+      BenchmarkUpwardProtocol* uplink = new BenchmarkUpwardProtocol();
+      BenchmarkDownwardProtocol* handler =
+        new BenchmarkDownwardProtocol(context, &stats);
+      Protocol* connection = new BinaryProtocol(downStream, handler,
+                                                new FileOutStream());
+      context->setProtocol(connection, uplink);
+      uint64_t start = currentMicros();
+      bool firstTask = true;
+      bool moreTasks = true;
+      while (moreTasks) {
+        context->waitForTask();
+        if (!firstTask && !context->hasAssignedTask()) {
+          break;
+        }
+        while (!context->isDone()) {
+          context->nextKey();
+        }
+        context->closeAll();
+        firstTask = false;
+        // sessions recorded from a reused worker hold several tasks
+        moreTasks = context->resetForNextTask();
+      }
+      uint64_t elapsed = currentMicros() - start;
+      if (elapsed == 0) {
+        elapsed = 1;
+      }
+      fprintf(stderr, "replayed %llu records (%llu bytes) in %llu us\n",
+              (unsigned long long) stats.records,
+              (unsigned long long) stats.recordBytes,
+              (unsigned long long) elapsed);
+      fprintf(stderr, "%.0f records/s, %.0f bytes/s in, "
+              "%llu records (%llu bytes) out\n",
+              stats.records * 1e6 / elapsed,
+              stats.recordBytes * 1e6 / elapsed,
+              (unsigned long long) uplink->records,
+              (unsigned long long) uplink->recordBytes);
+      stats.print(stderr);
+      delete context;
+      delete connection;
+      delete handler;
+      delete uplink;
+      return true;
+    } catch (Error& err) {
+      fprintf(stderr, "Hadoop Pipes Exception: %s\n",
               err.getMessage().c_str());
       return false;
     }
@@ -18,8 +18,47 @@
 
 #include "configuration.h"
 
+#include <sys/stat.h>
+
 char * hadoop_conf_dir;
 
+//mtime of the config file when it was parsed; lets long-lived callers
+//revalidate cheaply with a stat instead of re-reading every time
+static time_t conf_file_mtime = 0;
+
+//builds the config file path; caller frees
+static char * get_conf_file_name() {
+  int str_len = 0;
+  char *file_name = NULL;
+
+#ifndef HADOOP_CONF_DIR
+  str_len = strlen(CONF_FILE_PATTERN) + strlen(hadoop_conf_dir);
+  file_name = (char *) malloc(sizeof(char) * (str_len + 1));
+#else
+  str_len = strlen(CONF_FILE_PATTERN) + strlen(HADOOP_CONF_DIR);
+  file_name = (char *) malloc(sizeof(char) * (str_len + 1));
+#endif
+
+  if (file_name == NULL) {
+    fprintf(LOGFILE, "Malloc failed :Out of memory \n");
+    return NULL;
+  }
+  memset(file_name,'\0',str_len +1);
+#ifndef HADOOP_CONF_DIR
+  snprintf(file_name,str_len, CONF_FILE_PATTERN, hadoop_conf_dir);
+#else
+  snprintf(file_name, str_len, CONF_FILE_PATTERN, HADOOP_CONF_DIR);
+#endif
+  return file_name;
+}
+
+//comparator for sorting and searching the entries by key
+static int compare_entries(const void *a, const void *b) {
+  const struct confentry *const *first = (const struct confentry *const *) a;
+  const struct confentry *const *second = (const struct confentry *const *) b;
+  return strcmp((*first)->key, (*second)->key);
+}
+
 //clean up method for freeing configuration
 void free_configurations() {
   int i = 0;
@@ -46,27 +85,13 @@ void get_configs() {
   char *temp_equaltok;
   size_t linesize = 1000;
   int size_read = 0;
-  int str_len = 0;
   char *file_name = NULL;
+  struct stat conf_stat;
 
-#ifndef HADOOP_CONF_DIR
-  str_len = strlen(CONF_FILE_PATTERN) + strlen(hadoop_conf_dir);
-  file_name = (char *) malloc(sizeof(char) * (str_len + 1));
-#else
-  str_len = strlen(CONF_FILE_PATTERN) + strlen(HADOOP_CONF_DIR);
-  file_name = (char *) malloc(sizeof(char) * (str_len + 1));
-#endif
-
+  file_name = get_conf_file_name();
   if (file_name == NULL) {
-    fprintf(LOGFILE, "Malloc failed :Out of memory \n");
     return;
   }
-  memset(file_name,'\0',str_len +1);
-#ifndef HADOOP_CONF_DIR
-  snprintf(file_name,str_len, CONF_FILE_PATTERN, hadoop_conf_dir);
-#else
-  snprintf(file_name, str_len, CONF_FILE_PATTERN, HADOOP_CONF_DIR);
-#endif
 
 #ifdef DEBUG
   fprintf(LOGFILE,"get_configs :Conf file name is : %s \n", file_name);
@@ -161,6 +186,14 @@ void get_configs() {
 
   //close the file
   fclose(conf_file);
+  //remember when the file was parsed so refresh_configs can validate
+  //the in-memory copy with a stat instead of re-reading it
+  if (stat(file_name, &conf_stat) == 0) {
+    conf_file_mtime = conf_stat.st_mtime;
+  }
+  //keep the entries sorted by key so lookups can binary search
+  qsort(config.confdetails, config.size, sizeof(struct confentry *),
+      compare_entries);
   //clean up allocated file name
   free(file_name);
   return;
@@ -183,7 +216,9 @@ void get_configs() {
  */
 
 const char * get_value(char* key) {
-  int count;
+  struct confentry lookup;
+  struct confentry *lookup_ptr = &lookup;
+  struct confentry **found;
   if (config.size == 0) {
     get_configs();
   }
@@ -191,11 +226,44 @@ const char * get_value(char* key) {
     fprintf(LOGFILE, "Invalid configuration provided\n");
     return NULL;
   }
-  for (count = 0; count < config.size; count++) {
-    if (strcmp(config.confdetails[count]->key, key) == 0) {
-      return config.confdetails[count]->value;
-    }
+  //entries are kept sorted by get_configs, so binary search them
+  lookup.key = key;
+  found = (struct confentry **) bsearch(&lookup_ptr, config.confdetails,
+      config.size, sizeof(struct confentry *), compare_entries);
+  if (found == NULL) {
+    return NULL;
+  }
+  return (*found)->value;
+}
+
+/*
+ * function used by long running callers to revalidate the in-memory
+ * configuration. Stats the config file and re-parses it only when its
+ * mtime has changed since the last parse, so the common case costs a
+ * single stat call. Returns 1 when the file was reloaded - values
+ * handed out by get_value before that point to freed memory, so the
+ * caller must drop anything it derived from them - and 0 otherwise.
+ */
+int refresh_configs() {
+  struct stat conf_stat;
+  char *file_name;
+  int reloaded = 0;
+  if (config.size == 0) {
+    return 0;
+  }
+  file_name = get_conf_file_name();
+  if (file_name == NULL) {
+    return 0;
   }
-  return NULL;
+  if (stat(file_name, &conf_stat) == 0
+      && conf_stat.st_mtime != conf_file_mtime) {
+    fprintf(LOGFILE, "Configuration file changed, reloading : %s \n",
+        file_name);
+    free_configurations();
+    get_configs();
+    reloaded = 1;
+  }
+  free(file_name);
+  return reloaded;
 }
 
@@ -25,18 +25,12 @@ int main(int argc, char **argv) {
   const char * task_id = NULL;
   const char * tt_root = NULL;
   int exit_code = 0;
-  const char* const short_options = "l:";
-  const struct option long_options[] = { { "log", 1, NULL, 'l' }, { NULL, 0,
-      NULL, 0 } };
+  const char* const short_options = "l:d";
+  const struct option long_options[] = { { "log", 1, NULL, 'l' }, { "daemon",
+      0, NULL, 'd' }, { NULL, 0, NULL, 0 } };
 
   const char* log_file = NULL;
-
-  // when we support additional commands without ttroot, this check
-  // may become command specific.
-  if (argc < 6) {
-    display_usage(stderr);
-    return INVALID_ARGUMENT_NUMBER;
-  }
+  int daemon_mode = 0;
 
 #ifndef HADOOP_CONF_DIR
   hadoop_conf_dir = (char *) malloc (sizeof(char) *
@@ -50,10 +44,20 @@ int main(int argc, char **argv) {
     switch (next_option) {
     case 'l':
       log_file = optarg;
+      break;
+    case 'd':
+      daemon_mode = 1;
     default:
       break;
     }
   } while (next_option != -1);
+
+  // when we support additional commands without ttroot, this check
+  // may become command specific.
+  if (!daemon_mode && argc < 6) {
+    display_usage(stderr);
+    return INVALID_ARGUMENT_NUMBER;
+  }
   if (log_file == NULL) {
     LOGFILE = stderr;
   } else {
@@ -72,6 +76,15 @@ int main(int argc, char **argv) {
       }
     }
   }
+  if (daemon_mode) {
+    //serve operations over the inherited pipe until the tasktracker
+    //closes it; per-operation checks happen inside the loop
+    exit_code = run_daemon(stdin, stdout);
+    fflush(LOGFILE);
+    fclose(LOGFILE);
+    return exit_code;
+  }
+
   //checks done for user name
   //checks done if the user is root or not.
   if (argv[optind] == NULL) {
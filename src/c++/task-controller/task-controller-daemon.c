@@ -0,0 +1,186 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "task-controller.h"
+
+#include <sys/wait.h>
+#include <fcntl.h>
+
+/**
+ * Daemon mode: one long-lived task-controller serving many task
+ * lifecycle operations, so the per-task cost is a fork instead of an
+ * exec of the setuid binary plus a configuration parse.
+ *
+ * The tasktracker starts 'task-controller --daemon' once and keeps the
+ * pipe; requests arrive on stdin, one per line:
+ *
+ *   user command jobid taskid tt-root
+ *
+ * with command the same integer the argv interface takes. Each reply
+ * is one line on stdout:
+ *
+ *   exit-code pid
+ *
+ * where exit-code is the same code the one-shot invocation would have
+ * returned and pid is the forked child for RUN_TASK (0 otherwise).
+ * The channel is the pipe inherited from the invoking tasktracker -
+ * nothing else can ever hold it, which is the same authentication the
+ * argv interface gets from the execute permission on the binary, with
+ * no socket pathname to protect. EOF on stdin shuts the daemon down.
+ *
+ * The configuration is parsed once at startup. Every operation still
+ * goes through exactly the same per-request validation and privilege
+ * transition as the one-shot mode: the irreversible setuid happens in
+ * a forked child, never in the serving process.
+ */
+
+#define DAEMON_MAX_REQUEST 4096
+#define DAEMON_MAX_FIELDS 5
+
+//collect exited children (finished tasks and kill helpers) without blocking
+static void reap_children() {
+  while (waitpid(-1, NULL, WNOHANG) > 0) {
+    continue;
+  }
+}
+
+//point the child's protocol fds at /dev/null so an exec'ed task can
+//never write into the request/response stream
+static void detach_child_stdio() {
+  int fd = open("/dev/null", O_RDWR);
+  if (fd >= 0) {
+    dup2(fd, STDIN_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    if (fd > STDOUT_FILENO) {
+      close(fd);
+    }
+  }
+}
+
+/*
+ * Run one validated operation in a forked child. Returns the code to
+ * report to the tasktracker and fills in the child pid for RUN_TASK.
+ */
+static int serve_operation(int command, const char *user, const char *job_id,
+    const char *task_id, const char *tt_root, int *task_pid) {
+  pid_t child;
+  int status = 0;
+
+  *task_pid = 0;
+  child = fork();
+  if (child < 0) {
+    fprintf(LOGFILE, "daemon : unable to fork : %s\n", strerror(errno));
+    return INVALID_COMMAND_PROVIDED;
+  }
+  if (child == 0) {
+    detach_child_stdio();
+    switch (command) {
+    case RUN_TASK:
+      exit(run_task_as_user(user, job_id, task_id, tt_root));
+    case KILL_TASK:
+      exit(kill_user_task(user, job_id, task_id, tt_root));
+    default:
+      exit(INVALID_COMMAND_PROVIDED);
+    }
+  }
+
+  switch (command) {
+  case RUN_TASK:
+    //the child becomes the task on success; report the launch and let
+    //the reaper collect it when the task ends
+    *task_pid = child;
+    return 0;
+  case KILL_TASK:
+    //kills are quick - report the real exit code
+    if (waitpid(child, &status, 0) < 0) {
+      fprintf(LOGFILE, "daemon : waitpid failed : %s\n", strerror(errno));
+      return UNABLE_TO_KILL_TASK;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : UNABLE_TO_KILL_TASK;
+  default:
+    return INVALID_COMMAND_PROVIDED;
+  }
+}
+
+/*
+ * The daemon loop: validate and serve requests from the request stream
+ * until EOF. Validation per request mirrors main() exactly; a bad
+ * request gets its error code in the reply and the daemon carries on.
+ */
+int run_daemon(FILE *request_stream, FILE *response_stream) {
+  char line[DAEMON_MAX_REQUEST];
+  char *fields[DAEMON_MAX_FIELDS];
+  char *token;
+  char *save;
+  int num_fields;
+  int command;
+  int exit_code;
+  int task_pid;
+
+  //parse the configuration once for the life of the daemon; children
+  //inherit the parsed table through fork
+  get_configs();
+
+  while (fgets(line, sizeof(line), request_stream) != NULL) {
+    reap_children();
+    //pick up taskcontroller.cfg edits; a single stat when unchanged. A
+    //reload frees the old table, so the cached mapred.local.dir
+    //whitelist has to be re-derived from the new contents
+    if (refresh_configs()) {
+      reset_local_dir_cache();
+    }
+
+    line[strcspn(line, "\n")] = '\0';
+    num_fields = 0;
+    save = NULL;
+    token = strtok_r(line, " ", &save);
+    while (token != NULL && num_fields < DAEMON_MAX_FIELDS) {
+      fields[num_fields++] = token;
+      token = strtok_r(NULL, " ", &save);
+    }
+
+    exit_code = 0;
+    task_pid = 0;
+    if (num_fields != DAEMON_MAX_FIELDS || token != NULL) {
+      fprintf(LOGFILE, "daemon : malformed request\n");
+      exit_code = INVALID_ARGUMENT_NUMBER;
+    } else {
+      //fresh user lookup per request - the cached entry belongs to the
+      //previous request's user
+      user_detail = NULL;
+      if (get_user_details(fields[0]) != 0) {
+        exit_code = INVALID_USER_NAME;
+      } else if (user_detail->pw_gid == 0 || user_detail->pw_uid == 0) {
+        fprintf(LOGFILE, "Cannot run tasks as super user\n");
+        exit_code = SUPER_USER_NOT_ALLOWED_TO_RUN_TASKS;
+      } else {
+        command = atoi(fields[1]);
+        exit_code = serve_operation(command, user_detail->pw_name, fields[2],
+            fields[3], fields[4], &task_pid);
+      }
+    }
+
+    fprintf(response_stream, "%d %d\n", exit_code, task_pid);
+    fflush(response_stream);
+    fflush(LOGFILE);
+  }
+
+  //EOF: the tasktracker went away or closed us down
+  reap_children();
+  free_configurations();
+  return 0;
+}
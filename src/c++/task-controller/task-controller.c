@@ -26,11 +26,39 @@ FILE *LOGFILE;
 //hadoop temp dir root which is configured in secure configuration
 const char *mapred_local_dir;
 
+//the configured local dirs split once from the comma separated value;
+//validations scan this array instead of re-tokenizing per call
+static char **local_dir_list = NULL;
+static int num_local_dirs = 0;
+
+//the tt_root which last passed validation; launching and killing the
+//same task resolve against the cache without touching the list
+static const char *last_valid_tt_root = NULL;
+
+//buffer reused by the path building routines, grown on demand
+static char *path_buffer = NULL;
+static size_t path_buffer_size = 0;
+
 //placeholder for global cleanup operations
 void cleanup() {
   free_configurations();
 }
 
+//returns the shared path buffer with room for str_len characters,
+//zeroed; returns NULL if it cannot be grown
+static char * get_path_buffer(size_t str_len) {
+  if (str_len + 1 > path_buffer_size) {
+    char *grown = (char *) realloc(path_buffer, str_len + 1);
+    if (grown == NULL) {
+      return NULL;
+    }
+    path_buffer = grown;
+    path_buffer_size = str_len + 1;
+  }
+  memset(path_buffer, '\0', str_len + 1);
+  return path_buffer;
+}
+
 //change the user to passed user for executing/killing tasks
 int change_user(const char * user) {
   if (get_user_details(user) < 0) {
@@ -74,9 +102,45 @@ int change_user(const char * user) {
 //would return -1 if the configuration is not proper.
 
 int get_mapred_local_dir() {
+  char *dirs;
+  char *token;
+  char *temp_token;
+  char **grown;
 
   if (mapred_local_dir == NULL) {
     mapred_local_dir = get_value(TT_SYS_DIR_KEY);
+    if (mapred_local_dir != NULL) {
+      //split the comma separated list once, on a copy so the cached
+      //configuration value stays intact for later lookups
+      dirs = (char *) malloc(sizeof(char) * (strlen(mapred_local_dir) + 1));
+      if (dirs == NULL) {
+        fprintf(LOGFILE, "unable to allocate memory for local dir list\n");
+        return -1;
+      }
+      strcpy(dirs, mapred_local_dir);
+      token = strtok_r(dirs, ",", &temp_token);
+      while (token != NULL) {
+        grown = (char **) realloc(local_dir_list, sizeof(char *)
+            * (num_local_dirs + 1));
+        if (grown == NULL) {
+          fprintf(LOGFILE, "unable to allocate memory for local dir list\n");
+          free(dirs);
+          return -1;
+        }
+        local_dir_list = grown;
+        local_dir_list[num_local_dirs] = (char *) malloc(sizeof(char)
+            * (strlen(token) + 1));
+        if (local_dir_list[num_local_dirs] == NULL) {
+          fprintf(LOGFILE, "unable to allocate memory for local dir list\n");
+          free(dirs);
+          return -1;
+        }
+        strcpy(local_dir_list[num_local_dirs], token);
+        num_local_dirs++;
+        token = strtok_r(NULL, ",", &temp_token);
+      }
+      free(dirs);
+    }
   }
 
   //after the call it should not be null
@@ -87,15 +151,38 @@ int get_mapred_local_dir() {
   }
 
 }
+
+//drop everything derived from the configuration: mapred_local_dir
+//points into the configuration table that a reload just freed, and the
+//split directory whitelist reflects the old mapred.local.dir. Called by
+//the daemon when refresh_configs reloads the file, so the next
+//validation re-derives the whitelist from the new contents.
+void reset_local_dir_cache() {
+  int i;
+  for (i = 0; i < num_local_dirs; i++) {
+    free(local_dir_list[i]);
+  }
+  free(local_dir_list);
+  local_dir_list = NULL;
+  num_local_dirs = 0;
+  //points into local_dir_list, freed above
+  last_valid_tt_root = NULL;
+  //owned by the configuration table, so only forget it
+  mapred_local_dir = NULL;
+}
 // function to check if the passed tt_root is present in hadoop.tmp.dir
 int check_tt_root(const char *tt_root) {
-  char *token;
-  int found = -1;
+  int i;
 
   if (tt_root == NULL) {
     return -1;
   }
 
+  //launch and kill of the same task pass the same tt_root
+  if (last_valid_tt_root != NULL && strcmp(tt_root, last_valid_tt_root) == 0) {
+    return 0;
+  }
+
   if (mapred_local_dir == NULL) {
     if (get_mapred_local_dir() < 0) {
       fprintf(LOGFILE, "invalid hadoop config\n");
@@ -103,26 +190,14 @@ int check_tt_root(const char *tt_root) {
     }
   }
 
-  token = strtok((char *) mapred_local_dir, ",");
-  if (token == NULL && mapred_local_dir != NULL) {
-#ifdef DEBUG
-    fprintf(LOGFILE,"Single hadoop.tmp.dir configured");
-#endif
-    token = (char *)mapred_local_dir;
-  }
-
-  while (1) {
-    if (strcmp(tt_root, token) == 0) {
-      found = 0;
-      break;
-    }
-    token = strtok(NULL, ",");
-    if (token == NULL) {
-      break;
+  for (i = 0; i < num_local_dirs; i++) {
+    if (strcmp(tt_root, local_dir_list[i]) == 0) {
+      last_valid_tt_root = local_dir_list[i];
+      return 0;
     }
   }
 
-  return found;
+  return -1;
 
 }
 
@@ -131,6 +206,9 @@ int check_tt_root(const char *tt_root) {
  * and killing of the tasks by the user.
  *
  * check TT_SYS_DIR for pattern
+ *
+ * The returned path points into a buffer reused by the next path
+ * building call; callers must not free it.
  */
 void get_pid_path(const char * jobid, const char * taskid, const char *tt_root,
     char ** pid_path) {
@@ -145,13 +223,12 @@ void get_pid_path(const char * jobid, const char * taskid, const char *tt_root,
     }
   }
 
-  *pid_path = (char *) malloc(sizeof(char) * (str_len + 1));
+  *pid_path = get_path_buffer(str_len);
 
   if (*pid_path == NULL) {
     fprintf(LOGFILE, "unable to allocate memory for pid path\n");
     return;
   }
-  memset(*pid_path,'\0',str_len+1);
   snprintf(*pid_path, str_len, TT_SYS_DIR, tt_root, jobid, taskid);
 #ifdef DEBUG
   fprintf(LOGFILE, "get_pid_path : pid path = %s\n", *pid_path);
@@ -164,6 +241,9 @@ void get_pid_path(const char * jobid, const char * taskid, const char *tt_root,
  * function to provide path to the task file which is created by the tt
  *
  *Check TT_LOCAL_TASK_SCRIPT_PATTERN for pattern
+ *
+ * The returned path points into a buffer reused by the next path
+ * building call; callers must not free it.
  */
 void get_task_file_path(const char * jobid, const char * taskid,
     const char * tt_root, char **task_script_path) {
@@ -177,13 +257,12 @@ void get_task_file_path(const char * jobid, const char * taskid,
     }
   }
 
-  *task_script_path = (char *) malloc(sizeof(char) * (str_len + 1));
+  *task_script_path = get_path_buffer(str_len);
   if (*task_script_path == NULL) {
     fprintf(LOGFILE, "Unable to allocate memory for task_script_path \n");
     return;
   }
 
-  memset(*task_script_path,'\0',str_len+1);
   snprintf(*task_script_path, str_len, TT_LOCAL_TASK_SCRIPT_PATTERN, tt_root,
       jobid, taskid);
 #ifdef DEBUG
@@ -197,6 +276,8 @@ void get_task_file_path(const char * jobid, const char * taskid,
 void display_usage(FILE *stream) {
   fprintf(stream,
       "Usage: task-controller [-l logile] user command command-args\n");
+  fprintf(stream,
+      "       task-controller [-l logile] --daemon\n");
 }
 
 //function used to populate and user_details structure.
@@ -318,9 +399,6 @@ int run_task_as_user(const char * user, const char *jobid, const char *taskid,
   }
 
 
-  //free pid_t path which is allocated
-  free(pid_path);
-
   //change the user
   fcloseall();
   fclose(LOGFILE);
@@ -342,19 +420,12 @@ int run_task_as_user(const char * user, const char *jobid, const char *taskid,
   execlp(task_script_path, task_script_path, NULL);
   if (errno != 0) {
     fprintf(LOGFILE, "Error execing script %s", strerror(errno));
-    free(task_script_path);
     exit_code = UNABLE_TO_EXECUTE_TASK_SCRIPT;
   }
 
   return exit_code;
 
 cleanup:
-  if (pid_path != NULL) {
-    free(pid_path);
-  }
-  if (task_script_path != NULL) {
-    free(task_script_path);
-  }
   if (file_handle != NULL) {
     fclose(file_handle);
   }
@@ -405,13 +476,11 @@ int kill_user_task(const char *user, const char *jobid, const char *taskid,
   file_handle = fopen(pid_path, "r");
   if (file_handle == NULL) {
     fprintf(LOGFILE, "unable to open task-pid file :%s \n", pid_path);
-    free(pid_path);
     cleanup();
     return UNABLE_TO_OPEN_PID_FILE_READ_MODE;
   }
   fscanf(file_handle, "%d", &pid);
   fclose(file_handle);
-  free(pid_path);
   if (pid == 0) {
     fprintf(LOGFILE, "Unable to read task-pid from path: %s \n", pid_path);
     cleanup();
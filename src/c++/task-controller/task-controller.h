@@ -90,3 +90,7 @@ int verify_parent();
 int kill_user_task(const char *user, const char *jobid, const char *taskid, const char *tt_root);
 
 int get_user_details(const char *user);
+
+void reset_local_dir_cache();
+
+int run_daemon(FILE *request_stream, FILE *response_stream);
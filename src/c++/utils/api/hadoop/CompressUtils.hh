@@ -0,0 +1,60 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HADOOP_COMPRESS_UTILS_HH
+#define HADOOP_COMPRESS_UTILS_HH
+
+#include <stdint.h>
+#include <string>
+
+namespace HadoopUtils {
+
+  /**
+   * A small LZ codec tuned for speed rather than ratio, used to frame
+   * compressed blocks on the pipes downlink. The format is a stream of
+   * tokens: a control byte below 32 starts a literal run of that many
+   * plus one bytes, anything else is a back-reference whose top three
+   * bits hold the match length (an extra length byte follows when they
+   * are all set) and whose low five bits, with the next byte, hold the
+   * distance minus one. Matches are three bytes or longer, reach back
+   * at most 8192 bytes, and may overlap the output position.
+   */
+
+  /**
+   * Compress a buffer into result, replacing its contents. The output
+   * never grows past the input by more than one byte per 32, plus one.
+   * @param data the bytes to compress
+   * @param length the number of bytes
+   * @param result filled in with the compressed bytes
+   */
+  void lzCompress(const char* data, size_t length, std::string& result);
+
+  /**
+   * Expand a compressed buffer into result, which must be exactly the
+   * original length; the caller learns that length from the framing.
+   * @param data the compressed bytes
+   * @param length the number of compressed bytes
+   * @param result the buffer to fill
+   * @param resultLength the original length of the data
+   * @throws Error if the data does not decode to exactly resultLength
+   */
+  void lzDecompress(const char* data, size_t length, char* result,
+                    size_t resultLength);
+
+}
+
+#endif
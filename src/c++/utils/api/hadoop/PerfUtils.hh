@@ -0,0 +1,126 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HADOOP_PERF_UTILS_HH
+#define HADOOP_PERF_UTILS_HH
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+
+namespace HadoopUtils {
+
+  /**
+   * The current monotonic time in nanoseconds, for measuring
+   * intervals. The value is unrelated to the wall clock.
+   */
+  uint64_t getCurrentNanos();
+
+  /**
+   * A histogram with one bucket per power of two, so values spanning
+   * nanoseconds to seconds fit in a fixed 64-slot table and adding a
+   * sample is a shift and an increment.
+   */
+  class Histogram {
+  public:
+    Histogram();
+
+    /**
+     * Count a sample.
+     */
+    void add(uint64_t value);
+
+    /**
+     * Fold the other histogram's samples into this one.
+     */
+    void merge(const Histogram& other);
+
+    uint64_t getCount() const;
+    uint64_t getSum() const;
+
+    /**
+     * Write a one-line summary and the non-empty buckets.
+     */
+    void report(FILE* out, const char* name) const;
+  private:
+    uint64_t buckets[64];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t minValue;
+    uint64_t maxValue;
+  };
+
+  /**
+   * One instrumented location in the code. Each thread that passes
+   * through the site gets its own histogram, so the hot path is
+   * lock-free; at process exit the per-thread histograms are merged by
+   * name and reported on stderr. Sites are meant to be function-local
+   * statics, which the HADOOP_SCOPED_TIMER macro arranges.
+   */
+  class TimerSite {
+  public:
+    TimerSite(const char* siteName);
+
+    /**
+     * The calling thread's histogram for this site, created and
+     * registered for the exit report on first use.
+     */
+    Histogram* threadHistogram();
+  private:
+    const char* name;
+    pthread_key_t key;
+  };
+
+  /**
+   * Times the enclosing scope and adds the elapsed nanoseconds to the
+   * calling thread's histogram for the site.
+   */
+  class ScopedTimer {
+  public:
+    ScopedTimer(TimerSite& site) {
+      histogram = site.threadHistogram();
+      start = getCurrentNanos();
+    }
+    ~ScopedTimer() {
+      histogram->add(getCurrentNanos() - start);
+    }
+  private:
+    Histogram* histogram;
+    uint64_t start;
+  };
+
+}
+
+/**
+ * Time the rest of the enclosing scope under the given name. Costs two
+ * clock reads and a histogram add per pass; compiles away to nothing
+ * when HADOOP_PERF_DISABLED is defined.
+ */
+#ifdef HADOOP_PERF_DISABLED
+#define HADOOP_SCOPED_TIMER(name)
+#else
+#define HADOOP_PERF_CONCAT2(a, b) a##b
+#define HADOOP_PERF_CONCAT(a, b) HADOOP_PERF_CONCAT2(a, b)
+#define HADOOP_SCOPED_TIMER(name) \
+  static HadoopUtils::TimerSite \
+    HADOOP_PERF_CONCAT(hadoopTimerSite, __LINE__)(name); \
+  HadoopUtils::ScopedTimer \
+    HADOOP_PERF_CONCAT(hadoopScopedTimer, __LINE__) \
+      (HADOOP_PERF_CONCAT(hadoopTimerSite, __LINE__))
+#endif
+
+#endif
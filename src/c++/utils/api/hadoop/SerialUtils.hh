@@ -18,7 +18,11 @@
 #ifndef HADOOP_SERIAL_UTILS_HH
 #define HADOOP_SERIAL_UTILS_HH
 
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
 #include <string>
+#include <vector>
 
 namespace HadoopUtils {
 
@@ -144,6 +148,169 @@ namespace HadoopUtils {
     bool isOwned;
   };
 
+  /**
+   * An InStream that keeps a large read-ahead buffer over another
+   * stream, so the byte-at-a-time reads the deserializers issue become
+   * pointer bumps instead of virtual calls into stdio. When the total
+   * number of bytes in the wrapped stream is known, whole buffers are
+   * read ahead at once; otherwise only the bytes that are asked for are
+   * fetched, since the wrapped stream blocks until a read is complete.
+   */
+  class BufferedInStream: public InStream {
+  public:
+    /**
+     * Buffer the given stream.
+     * @param stream the stream to read from
+     * @param bufferSize the size of the read-ahead buffer
+     * @param streamLength the bytes the stream holds, 0 if unknown
+     * @param own whether this stream should delete the wrapped one
+     */
+    BufferedInStream(InStream* stream, size_t bufferSize = 4 * 1024 * 1024,
+                     uint64_t streamLength = 0, bool own = false);
+    void read(void* buf, size_t len);
+
+    /**
+     * Make at least len bytes available in the buffer and return a
+     * pointer to them without consuming, so a deserializer can decode
+     * in place.
+     */
+    const char* ensure(size_t len);
+
+    /**
+     * Consume len bytes previously returned by ensure.
+     */
+    void consume(size_t len);
+    virtual ~BufferedInStream();
+  private:
+    void fill(size_t atLeast);
+    InStream* base;
+    bool owned;
+    char* data;
+    size_t capacity;
+    size_t pos;
+    size_t limit;
+    uint64_t remaining;
+    bool lengthKnown;
+  };
+
+  /**
+   * An InStream over a memory-mapped file. Reads and skips are pointer
+   * arithmetic over the mapping instead of copies through stdio, and
+   * the mapping is advised for sequential access, so the page cache is
+   * the only buffer between the file and the consumer.
+   */
+  class MemoryMappedInStream: public InStream {
+  public:
+    /**
+     * Map the given file, throwing an Error if it cannot be mapped.
+     * @param name the file to map
+     * @param hugePages whether to ask the kernel for huge pages,
+     *                  silently falling back to normal pages
+     */
+    MemoryMappedInStream(const std::string& name, bool hugePages = false);
+    void read(void* buf, size_t len);
+    bool skip(size_t nbytes);
+
+    /**
+     * A pointer to the unread remainder of the mapping, for consumers
+     * that want to decode without copying.
+     */
+    const char* current() const;
+
+    /**
+     * The bytes left in the mapping.
+     */
+    size_t available() const;
+    virtual ~MemoryMappedInStream();
+  private:
+    char* base;
+    size_t length;
+    size_t pos;
+  };
+
+  /**
+   * An OutStream that accumulates writes in a large buffer and hands
+   * them to the wrapped stream a buffer at a time.
+   */
+  class BufferedOutStream: public OutStream {
+  public:
+    /**
+     * Buffer the given stream.
+     * @param stream the stream to write to
+     * @param bufferSize the size of the write buffer
+     * @param own whether this stream should delete the wrapped one
+     */
+    BufferedOutStream(OutStream* stream, size_t bufferSize = 4 * 1024 * 1024,
+                      bool own = false);
+    void write(const void* buf, size_t len);
+    void flush();
+    virtual ~BufferedOutStream();
+  private:
+    OutStream* base;
+    bool owned;
+    char* data;
+    size_t capacity;
+    size_t used;
+  };
+
+  /**
+   * An OutStream that frames its output into checksummed chunks, so
+   * corruption on the wire or on disk is detected at the reader
+   * instead of surfacing as a garbled frame later. Each chunk is a
+   * length, a CRC32C of the bytes, and the bytes; the reader must
+   * unwrap with ChecksumInStream.
+   */
+  class ChecksumOutStream: public OutStream {
+  public:
+    /**
+     * Checksum the given stream.
+     * @param stream the stream to write to
+     * @param chunkSize the bytes covered by each checksum
+     * @param own whether this stream should delete the wrapped one
+     */
+    ChecksumOutStream(OutStream* stream, size_t chunkSize = 64 * 1024,
+                      bool own = false);
+    void write(const void* buf, size_t len);
+
+    /**
+     * Emit the buffered partial chunk and flush the wrapped stream.
+     */
+    void flush();
+    virtual ~ChecksumOutStream();
+  private:
+    void writeChunk();
+    OutStream* base;
+    bool owned;
+    char* data;
+    size_t capacity;
+    size_t used;
+  };
+
+  /**
+   * The reading side of ChecksumOutStream: unwraps the chunks and
+   * verifies each checksum before handing out any of its bytes,
+   * throwing an Error on a mismatch.
+   */
+  class ChecksumInStream: public InStream {
+  public:
+    /**
+     * Verify the given stream.
+     * @param stream the stream to read from
+     * @param own whether this stream should delete the wrapped one
+     */
+    ChecksumInStream(InStream* stream, bool own = false);
+    void read(void* buf, size_t len);
+    virtual ~ChecksumInStream();
+  private:
+    void readChunk();
+    InStream* base;
+    bool owned;
+    char* data;
+    size_t capacity;
+    size_t pos;
+    size_t limit;
+  };
+
   /**
    * A stream that reads from a string.
    */
@@ -153,15 +320,223 @@ namespace HadoopUtils {
     virtual void read(void *buf, size_t buflen);
   private:
     const std::string& buffer;
-    std::string::const_iterator itr;
+    size_t pos;
+  };
+
+  /**
+   * A stream over memory the caller owns. Nothing is copied at
+   * construction, reads are bounds-checked memcpys, and readDirect
+   * hands out pointers into the caller's buffer so deserializers can
+   * decode without copying at all. The memory must stay alive as long
+   * as the stream is read.
+   */
+  class MemoryInStream: public InStream {
+  public:
+    MemoryInStream(const char* streamData, size_t streamLength);
+
+    /**
+     * View the bytes of a string, which must outlive the stream.
+     */
+    MemoryInStream(const std::string& str);
+    void read(void* buf, size_t len);
+
+    /**
+     * Consume len bytes and return a pointer to them inside the
+     * underlying buffer.
+     */
+    const char* readDirect(size_t len);
+
+    /**
+     * The bytes left in the stream.
+     */
+    size_t available() const;
+  private:
+    const char* data;
+    size_t length;
+    size_t pos;
+  };
+
+  /**
+   * A bump-pointer arena. Allocations carve naturally aligned pieces
+   * out of large blocks, so a record loop pays a pointer bump per
+   * allocation instead of a trip to the global allocator, and the
+   * whole arena is reclaimed at once between batches. Nothing is
+   * freed piecemeal: reset keeps the blocks for reuse and clear
+   * returns them to the heap.
+   */
+  class Arena {
+  public:
+    /**
+     * Create an arena that grows in blocks of the given size.
+     */
+    Arena(size_t blockSize = 1024 * 1024);
+
+    /**
+     * Allocate bytes from the arena, aligned to 8 bytes. Requests
+     * larger than a block get their own allocation.
+     */
+    char* alloc(size_t bytes);
+
+    /**
+     * Forget every allocation but keep the blocks, so the next cycle
+     * allocates out of warm memory.
+     */
+    void reset();
+
+    /**
+     * Free all memory held by the arena.
+     */
+    void clear();
+
+    /**
+     * The bytes this arena has allocated from the heap, including the
+     * unused tails of its blocks.
+     */
+    size_t allocatedBytes() const;
+
+    void swap(Arena& other);
+    ~Arena();
+  private:
+    size_t blockSize;
+    std::vector<char*> blocks;
+    std::vector<char*> oversized;
+    size_t current;
+    size_t used;
+    size_t totalAllocated;
+  };
+
+  /**
+   * A standard-library allocator that draws from an Arena. Containers
+   * built with it allocate with pointer bumps and give their memory
+   * back only when the arena is reset, so deallocate is a no-op. The
+   * arena must outlive every container that uses it.
+   */
+  template <class T>
+  class ArenaAllocator {
+  public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    template <class U> struct rebind { typedef ArenaAllocator<U> other; };
+
+    ArenaAllocator(Arena& backing): arena(&backing) {}
+    template <class U> ArenaAllocator(const ArenaAllocator<U>& other)
+      : arena(other.getArena()) {}
+
+    pointer allocate(size_type n, const void* = 0) {
+      return (pointer) arena->alloc(n * sizeof(T));
+    }
+    void deallocate(pointer, size_type) {
+      // reclaimed in bulk by Arena::reset
+    }
+    size_type max_size() const {
+      return ((size_type) -1) / sizeof(T);
+    }
+    void construct(pointer p, const T& value) {
+      new ((void*) p) T(value);
+    }
+    void destroy(pointer p) {
+      p->~T();
+    }
+    Arena* getArena() const {
+      return arena;
+    }
+  private:
+    Arena* arena;
   };
 
+  template <class T, class U>
+  inline bool operator==(const ArenaAllocator<T>& a,
+                         const ArenaAllocator<U>& b) {
+    return a.getArena() == b.getArena();
+  }
+
+  template <class T, class U>
+  inline bool operator!=(const ArenaAllocator<T>& a,
+                         const ArenaAllocator<U>& b) {
+    return a.getArena() != b.getArena();
+  }
+
+  /**
+   * Update a CRC32C (Castagnoli) checksum with the given bytes, using
+   * the SSE4.2 crc32 instruction when the build targets it. Start
+   * with 0 and feed chunks in sequence.
+   */
+  uint32_t crc32c(uint32_t crc, const void* data, size_t length);
+
   void serializeInt(int32_t t, OutStream& stream);
   int32_t deserializeInt(InStream& stream);
   void serializeLong(int64_t t, OutStream& stream);
   int64_t deserializeLong(InStream& stream);
+
+  /**
+   * The most bytes an encoded long can occupy: a length byte followed
+   * by up to eight payload bytes.
+   */
+  const size_t MAX_LONG_BYTES = 9;
+
+  /**
+   * Encode the value into the caller's buffer in one pass, without
+   * touching a stream. The buffer must hold MAX_LONG_BYTES.
+   * @return the number of bytes written
+   */
+  size_t encodeLong(int64_t t, char* buffer);
+
+  /**
+   * Decode a long from the caller's buffer.
+   * @param width set to the number of bytes consumed
+   * @return the decoded value
+   */
+  int64_t decodeLong(const char* buffer, size_t& width);
+
+  /**
+   * Encode a whole array and hand it to the stream in large writes
+   * instead of one write per value.
+   */
+  void serializeLongArray(const int64_t* values, size_t count,
+                          OutStream& stream);
+
+  /**
+   * Decode count longs from the stream.
+   */
+  void deserializeLongArray(int64_t* values, size_t count, InStream& stream);
+
+  /**
+   * Decode count longs straight out of the stream's buffer, consuming
+   * each value with pointer bumps instead of reads.
+   */
+  void deserializeLongArray(int64_t* values, size_t count,
+                            BufferedInStream& stream);
+
   void serializeFloat(float t, OutStream& stream);
   float deserializeFloat(InStream& stream);
+
+  /**
+   * Write a whole array of floats in big-endian byte order, swapping
+   * in bulk so the stream sees a few large writes.
+   */
+  void serializeFloatArray(const float* values, size_t count,
+                           OutStream& stream);
+
+  /**
+   * Read count big-endian floats from the stream.
+   */
+  void deserializeFloatArray(float* values, size_t count, InStream& stream);
+
+  /**
+   * Write a whole array of doubles in big-endian byte order.
+   */
+  void serializeDoubleArray(const double* values, size_t count,
+                            OutStream& stream);
+
+  /**
+   * Read count big-endian doubles from the stream.
+   */
+  void deserializeDoubleArray(double* values, size_t count, InStream& stream);
   void serializeString(const std::string& t, OutStream& stream);
   void deserializeString(std::string& t, InStream& stream);
 }
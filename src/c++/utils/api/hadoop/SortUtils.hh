@@ -0,0 +1,93 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HADOOP_SORT_UTILS_HH
+#define HADOOP_SORT_UTILS_HH
+
+#include <stdint.h>
+#include <string>
+
+namespace HadoopUtils {
+
+  /**
+   * The consumer of a sorted record stream.
+   */
+  class RecordSink {
+  public:
+    virtual void sorted(const std::string& key, const std::string& value) = 0;
+    virtual ~RecordSink() {}
+  };
+
+  struct ExternalSorterImpl;
+
+  /**
+   * An external merge sorter for byte-string records.
+   *
+   * Records are appended into a flat buffer; when the buffer reaches
+   * the memory budget it is sorted and written as a run file in the
+   * spill directory. sort() merges the run files and the final
+   * in-memory run through a loser tree and delivers every record to
+   * the sink in ascending key order, deleting run files as they drain.
+   *
+   * The in-memory sort compares an inline eight-byte key prefix held
+   * next to the record index, so most comparisons never touch the
+   * record buffer. Keys order by raw byte value, the same order the
+   * Java side's binary comparators use, and records with equal keys
+   * keep their insertion order.
+   *
+   * A sorter accepts no further records once sort() has run.
+   */
+  class ExternalSorter {
+  public:
+    /**
+     * @param memoryLimit the buffered bytes, records and index
+     *                    together, that trigger a spill to disk
+     * @param spillDir the local directory for run files
+     */
+    ExternalSorter(size_t memoryLimit, const std::string& spillDir);
+    ~ExternalSorter();
+
+    /**
+     * Append a record.
+     */
+    void add(const std::string& key, const std::string& value);
+
+    /**
+     * Sort the records and deliver each one to the sink in key order.
+     */
+    void sort(RecordSink& sink);
+
+    /**
+     * The number of records added.
+     */
+    uint64_t getRecords() const;
+
+    /**
+     * The number of runs spilled to disk.
+     */
+    uint64_t getSpills() const;
+
+  private:
+    ExternalSorter(const ExternalSorter&);
+    ExternalSorter& operator=(const ExternalSorter&);
+
+    ExternalSorterImpl* impl;
+  };
+
+}
+
+#endif
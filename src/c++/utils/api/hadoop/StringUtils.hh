@@ -61,6 +61,37 @@ namespace HadoopUtils {
   std::vector<std::string> splitString(const std::string& str,
                                        const char* separator);
 
+  /**
+   * A tokenizer that walks a buffer in place and yields each word as a
+   * pointer and length into the caller's memory, so splitting a line
+   * costs no allocation. Words are separated as in splitString:
+   * runs of separator characters are a single break and zero-length
+   * words are never returned. The buffer must stay alive while the
+   * tokenizer is used.
+   */
+  class StringTokenizer {
+  public:
+    StringTokenizer(const char* data, size_t length, const char* separator);
+
+    /**
+     * Tokenize the bytes of a string, which must outlive the tokenizer.
+     */
+    StringTokenizer(const std::string& str, const char* separator);
+
+    /**
+     * Advance to the next word.
+     * @param word set to the first byte of the word
+     * @param length set to the length of the word
+     * @return true if a word was found
+     */
+    bool next(const char** word, size_t* length);
+  private:
+    void setSeparator(const char* separator);
+    const char* cur;
+    const char* end;
+    bool isSeparator[256];
+  };
+
   /**
    * Quote a string to avoid "\", non-printable characters, and the 
    * deliminators.
@@ -0,0 +1,142 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hadoop/CompressUtils.hh"
+#include "hadoop/SerialUtils.hh"
+
+#include <string.h>
+
+using std::string;
+
+namespace HadoopUtils {
+
+  /* token layout constants; the Java compressor in BinaryProtocol.java
+     emits the same format and must be kept in sync */
+  static const size_t MAX_LITERAL_RUN = 32;
+  static const size_t MAX_DISTANCE = 8192;
+  static const size_t MIN_MATCH = 3;
+  static const size_t MAX_MATCH = 264;
+  static const size_t HASH_SIZE = 8192;
+
+  static size_t hashBytes(const unsigned char* p) {
+    uint32_t triple = ((uint32_t) p[0] << 16) | ((uint32_t) p[1] << 8) | p[2];
+    return (triple * 2654435761u >> 19) & (HASH_SIZE - 1);
+  }
+
+  /**
+   * Append the pending literals as runs of at most MAX_LITERAL_RUN.
+   */
+  static void emitLiterals(const char* data, size_t start, size_t end,
+                           string& result) {
+    while (start < end) {
+      size_t run = end - start;
+      if (run > MAX_LITERAL_RUN) {
+        run = MAX_LITERAL_RUN;
+      }
+      result.push_back((char) (run - 1));
+      result.append(data + start, run);
+      start += run;
+    }
+  }
+
+  void lzCompress(const char* data, size_t length, string& result) {
+    result.clear();
+    if (length == 0) {
+      return;
+    }
+    const unsigned char* bytes = (const unsigned char*) data;
+    size_t table[HASH_SIZE];
+    memset(table, 0, sizeof(table));
+    size_t literalStart = 0;
+    size_t pos = 0;
+    while (pos + MIN_MATCH <= length) {
+      size_t slot = hashBytes(bytes + pos);
+      size_t candidate = table[slot];
+      table[slot] = pos;
+      if (candidate < pos && pos - candidate <= MAX_DISTANCE &&
+          bytes[candidate] == bytes[pos] &&
+          bytes[candidate + 1] == bytes[pos + 1] &&
+          bytes[candidate + 2] == bytes[pos + 2]) {
+        size_t limit = length - pos;
+        if (limit > MAX_MATCH) {
+          limit = MAX_MATCH;
+        }
+        size_t matched = MIN_MATCH;
+        while (matched < limit &&
+               bytes[candidate + matched] == bytes[pos + matched]) {
+          matched += 1;
+        }
+        emitLiterals(data, literalStart, pos, result);
+        size_t distance = pos - candidate - 1;
+        size_t lenBits = matched - 2;
+        if (lenBits < 7) {
+          result.push_back((char) ((lenBits << 5) | (distance >> 8)));
+        } else {
+          result.push_back((char) ((7 << 5) | (distance >> 8)));
+          result.push_back((char) (lenBits - 7));
+        }
+        result.push_back((char) (distance & 0xff));
+        pos += matched;
+        literalStart = pos;
+      } else {
+        pos += 1;
+      }
+    }
+    emitLiterals(data, literalStart, length, result);
+  }
+
+  void lzDecompress(const char* data, size_t length, char* result,
+                    size_t resultLength) {
+    const unsigned char* bytes = (const unsigned char*) data;
+    size_t in = 0;
+    size_t out = 0;
+    while (in < length) {
+      size_t ctrl = bytes[in];
+      in += 1;
+      if (ctrl < MAX_LITERAL_RUN) {
+        size_t run = ctrl + 1;
+        HADOOP_ASSERT(in + run <= length && out + run <= resultLength,
+                      "corrupt compressed block: bad literal run");
+        memcpy(result + out, data + in, run);
+        in += run;
+        out += run;
+      } else {
+        size_t matched = (ctrl >> 5) + 2;
+        if (matched == 9) {
+          HADOOP_ASSERT(in < length,
+                        "corrupt compressed block: truncated match length");
+          matched += bytes[in];
+          in += 1;
+        }
+        HADOOP_ASSERT(in < length,
+                      "corrupt compressed block: truncated distance");
+        size_t distance = (((ctrl & 0x1f) << 8) | bytes[in]) + 1;
+        in += 1;
+        HADOOP_ASSERT(distance <= out && out + matched <= resultLength,
+                      "corrupt compressed block: bad match");
+        // the match may overlap the output position, so copy bytewise
+        const char* src = result + out - distance;
+        for(size_t i=0; i < matched; ++i) {
+          result[out + i] = src[i];
+        }
+        out += matched;
+      }
+    }
+    HADOOP_ASSERT(out == resultLength, "corrupt compressed block: short data");
+  }
+
+}
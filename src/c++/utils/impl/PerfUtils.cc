@@ -0,0 +1,189 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hadoop/PerfUtils.hh"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+namespace HadoopUtils {
+
+  uint64_t getCurrentNanos()
+  {
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+      return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+#endif
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000000ull + tv.tv_usec * 1000ull;
+  }
+
+  Histogram::Histogram()
+  {
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    sum = 0;
+    minValue = 0;
+    maxValue = 0;
+  }
+
+  void Histogram::add(uint64_t value)
+  {
+    int bucket = 0;
+    while ((value >> bucket) > 1) {
+      bucket += 1;
+    }
+    buckets[bucket] += 1;
+    sum += value;
+    if (count == 0 || value < minValue) {
+      minValue = value;
+    }
+    if (value > maxValue) {
+      maxValue = value;
+    }
+    count += 1;
+  }
+
+  void Histogram::merge(const Histogram& other)
+  {
+    if (other.count == 0) {
+      return;
+    }
+    for(int i = 0; i < 64; ++i) {
+      buckets[i] += other.buckets[i];
+    }
+    sum += other.sum;
+    if (count == 0 || other.minValue < minValue) {
+      minValue = other.minValue;
+    }
+    if (other.maxValue > maxValue) {
+      maxValue = other.maxValue;
+    }
+    count += other.count;
+  }
+
+  uint64_t Histogram::getCount() const
+  {
+    return count;
+  }
+
+  uint64_t Histogram::getSum() const
+  {
+    return sum;
+  }
+
+  void Histogram::report(FILE* out, const char* name) const
+  {
+    fprintf(out, "%s: count=%llu sum=%llu avg=%llu min=%llu max=%llu\n",
+            name, (unsigned long long) count, (unsigned long long) sum,
+            (unsigned long long) (count == 0 ? 0 : sum / count),
+            (unsigned long long) minValue, (unsigned long long) maxValue);
+    for(int i = 0; i < 64; ++i) {
+      if (buckets[i] != 0) {
+        fprintf(out, "  [%llu, %llu): %llu\n",
+                (unsigned long long) (i == 0 ? 0 : 1ull << i),
+                (unsigned long long) (1ull << (i + 1)),
+                (unsigned long long) buckets[i]);
+      }
+    }
+  }
+
+  /**
+   * A per-thread histogram registered for the exit report. The
+   * records are kept in a linked list rather than a vector so
+   * registration from many threads only contends on one mutex and
+   * nothing moves once published.
+   */
+  struct TimerRecord {
+    const char* name;
+    Histogram histogram;
+    TimerRecord* next;
+  };
+
+  static TimerRecord* allRecords = NULL;
+  static pthread_mutex_t recordLock = PTHREAD_MUTEX_INITIALIZER;
+  static pthread_once_t reportOnce = PTHREAD_ONCE_INIT;
+
+  static void reportTimers()
+  {
+    pthread_mutex_lock(&recordLock);
+    bool printedHeader = false;
+    // merge the per-thread histograms of each name into the first
+    // record that carries it, then report the merged ones
+    for(TimerRecord* record = allRecords; record != NULL;
+        record = record->next) {
+      bool merged = false;
+      for(TimerRecord* prior = allRecords; prior != record;
+          prior = prior->next) {
+        if (strcmp(prior->name, record->name) == 0) {
+          merged = true;
+          break;
+        }
+      }
+      if (merged) {
+        continue;
+      }
+      for(TimerRecord* other = record->next; other != NULL;
+          other = other->next) {
+        if (strcmp(other->name, record->name) == 0) {
+          record->histogram.merge(other->histogram);
+        }
+      }
+      if (record->histogram.getCount() != 0) {
+        if (!printedHeader) {
+          fprintf(stderr, "Hadoop timers (nanoseconds):\n");
+          printedHeader = true;
+        }
+        record->histogram.report(stderr, record->name);
+      }
+    }
+    pthread_mutex_unlock(&recordLock);
+  }
+
+  static void registerReport()
+  {
+    atexit(reportTimers);
+  }
+
+  TimerSite::TimerSite(const char* siteName)
+  {
+    name = siteName;
+    pthread_key_create(&key, NULL);
+    pthread_once(&reportOnce, registerReport);
+  }
+
+  Histogram* TimerSite::threadHistogram()
+  {
+    TimerRecord* record = (TimerRecord*) pthread_getspecific(key);
+    if (record == NULL) {
+      record = new TimerRecord();
+      record->name = name;
+      pthread_mutex_lock(&recordLock);
+      record->next = allRecords;
+      allRecords = record;
+      pthread_mutex_unlock(&recordLock);
+      pthread_setspecific(key, record);
+    }
+    return &record->histogram;
+  }
+
+}
@@ -18,11 +18,19 @@
 #include "hadoop/SerialUtils.hh"
 #include "hadoop/StringUtils.hh"
 
+#include <algorithm>
 #include <errno.h>
-#include <rpc/types.h>
-#include <rpc/xdr.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <string>
 
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
 using std::string;
 
 namespace HadoopUtils {
@@ -156,56 +164,533 @@ namespace HadoopUtils {
     }
   }
 
+  BufferedInStream::BufferedInStream(InStream* stream, size_t bufferSize,
+                                     uint64_t streamLength, bool own)
+  {
+    base = stream;
+    owned = own;
+    capacity = bufferSize < 1 ? 1 : bufferSize;
+    data = new char[capacity];
+    pos = 0;
+    limit = 0;
+    remaining = streamLength;
+    lengthKnown = streamLength != 0;
+  }
+
+  void BufferedInStream::fill(size_t atLeast)
+  {
+    size_t available = limit - pos;
+    if (available >= atLeast) {
+      return;
+    }
+    HADOOP_ASSERT(atLeast <= capacity, "buffered read larger than buffer");
+    // move the leftover bytes to the front and top the buffer up
+    if (available > 0 && pos > 0) {
+      memmove(data, data + pos, available);
+    }
+    pos = 0;
+    limit = available;
+    size_t wanted = atLeast - available;
+    if (lengthKnown) {
+      // read ahead as much as the stream still holds
+      size_t ahead = capacity - limit;
+      if (ahead > remaining) {
+        ahead = remaining;
+      }
+      HADOOP_ASSERT(ahead >= wanted, "end of buffered stream");
+      base->read(data + limit, ahead);
+      remaining -= ahead;
+      limit += ahead;
+    } else {
+      // the source may block, only fetch what was asked for
+      base->read(data + limit, wanted);
+      limit += wanted;
+    }
+  }
+
+  void BufferedInStream::read(void* buf, size_t len)
+  {
+    if (len <= capacity) {
+      fill(len);
+      memcpy(buf, data + pos, len);
+      pos += len;
+      return;
+    }
+    // oversized read: drain the buffer and go straight to the source
+    size_t available = limit - pos;
+    char* output = (char*) buf;
+    if (available > 0) {
+      memcpy(output, data + pos, available);
+      pos = limit;
+    }
+    base->read(output + available, len - available);
+    if (lengthKnown) {
+      HADOOP_ASSERT(remaining >= len - available, "end of buffered stream");
+      remaining -= len - available;
+    }
+  }
+
+  const char* BufferedInStream::ensure(size_t len)
+  {
+    fill(len);
+    return data + pos;
+  }
+
+  void BufferedInStream::consume(size_t len)
+  {
+    HADOOP_ASSERT(len <= limit - pos, "consuming more than was ensured");
+    pos += len;
+  }
+
+  BufferedInStream::~BufferedInStream()
+  {
+    delete[] data;
+    if (owned) {
+      delete base;
+    }
+  }
+
+  MemoryMappedInStream::MemoryMappedInStream(const std::string& name,
+                                             bool hugePages)
+  {
+    int fd = ::open(name.c_str(), O_RDONLY);
+    HADOOP_ASSERT(fd != -1, "can't open " + name + ": " + strerror(errno));
+    struct stat statResult;
+    HADOOP_ASSERT(fstat(fd, &statResult) == 0,
+                  "can't stat " + name + ": " + strerror(errno));
+    length = statResult.st_size;
+    pos = 0;
+    base = NULL;
+    if (length != 0) {
+      void* mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED) {
+        ::close(fd);
+        HADOOP_ASSERT(false, "can't map " + name + ": " + strerror(errno));
+      }
+      base = (char*) mapped;
+      madvise(base, length, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+      if (hugePages) {
+        madvise(base, length, MADV_HUGEPAGE);
+      }
+#endif
+    }
+    ::close(fd);
+  }
+
+  void MemoryMappedInStream::read(void* buf, size_t len)
+  {
+    HADOOP_ASSERT(len <= length - pos, "end of mapped file");
+    memcpy(buf, base + pos, len);
+    pos += len;
+  }
+
+  bool MemoryMappedInStream::skip(size_t nbytes)
+  {
+    if (nbytes > length - pos) {
+      return false;
+    }
+    pos += nbytes;
+    return true;
+  }
+
+  const char* MemoryMappedInStream::current() const
+  {
+    return base + pos;
+  }
+
+  size_t MemoryMappedInStream::available() const
+  {
+    return length - pos;
+  }
+
+  MemoryMappedInStream::~MemoryMappedInStream()
+  {
+    if (base != NULL) {
+      munmap(base, length);
+    }
+  }
+
+  BufferedOutStream::BufferedOutStream(OutStream* stream, size_t bufferSize,
+                                       bool own)
+  {
+    base = stream;
+    owned = own;
+    capacity = bufferSize < 1 ? 1 : bufferSize;
+    data = new char[capacity];
+    used = 0;
+  }
+
+  void BufferedOutStream::write(const void* buf, size_t len)
+  {
+    if (used + len > capacity) {
+      flush();
+      if (len > capacity) {
+        base->write(buf, len);
+        return;
+      }
+    }
+    memcpy(data + used, buf, len);
+    used += len;
+  }
+
+  void BufferedOutStream::flush()
+  {
+    if (used > 0) {
+      base->write(data, used);
+      used = 0;
+    }
+    base->flush();
+  }
+
+  BufferedOutStream::~BufferedOutStream()
+  {
+    flush();
+    if (owned) {
+      delete base;
+    }
+  }
+
+  uint32_t crc32c(uint32_t crc, const void* data, size_t length)
+  {
+    const unsigned char* bytes = (const unsigned char*) data;
+    crc = crc ^ 0xffffffffu;
+#ifdef __SSE4_2__
+    while (length >= 8) {
+      uint64_t chunk;
+      memcpy(&chunk, bytes, 8);
+      crc = (uint32_t) _mm_crc32_u64(crc, chunk);
+      bytes += 8;
+      length -= 8;
+    }
+    while (length > 0) {
+      crc = _mm_crc32_u8(crc, *bytes);
+      bytes += 1;
+      length -= 1;
+    }
+#else
+    static uint32_t table[256];
+    static bool tableBuilt = false;
+    if (!tableBuilt) {
+      for(uint32_t i = 0; i < 256; ++i) {
+        uint32_t entry = i;
+        for(int bit = 0; bit < 8; ++bit) {
+          entry = (entry >> 1) ^ ((entry & 1) ? 0x82f63b78u : 0);
+        }
+        table[i] = entry;
+      }
+      tableBuilt = true;
+    }
+    while (length > 0) {
+      crc = (crc >> 8) ^ table[(crc ^ *bytes) & 0xff];
+      bytes += 1;
+      length -= 1;
+    }
+#endif
+    return crc ^ 0xffffffffu;
+  }
+
+  ChecksumOutStream::ChecksumOutStream(OutStream* stream, size_t chunkSize,
+                                       bool own)
+  {
+    base = stream;
+    owned = own;
+    capacity = chunkSize;
+    data = new char[capacity];
+    used = 0;
+  }
+
+  void ChecksumOutStream::writeChunk()
+  {
+    serializeInt(used, *base);
+    serializeInt(crc32c(0, data, used), *base);
+    base->write(data, used);
+    used = 0;
+  }
+
+  void ChecksumOutStream::write(const void* buf, size_t len)
+  {
+    const char* bytes = (const char*) buf;
+    while (len > 0) {
+      size_t room = capacity - used;
+      size_t chunk = len < room ? len : room;
+      memcpy(data + used, bytes, chunk);
+      used += chunk;
+      bytes += chunk;
+      len -= chunk;
+      if (used == capacity) {
+        writeChunk();
+      }
+    }
+  }
+
+  void ChecksumOutStream::flush()
+  {
+    if (used > 0) {
+      writeChunk();
+    }
+    base->flush();
+  }
+
+  ChecksumOutStream::~ChecksumOutStream()
+  {
+    if (used > 0) {
+      writeChunk();
+    }
+    delete[] data;
+    if (owned) {
+      delete base;
+    }
+  }
+
+  ChecksumInStream::ChecksumInStream(InStream* stream, bool own)
+  {
+    base = stream;
+    owned = own;
+    capacity = 64 * 1024;
+    data = new char[capacity];
+    pos = 0;
+    limit = 0;
+  }
+
+  void ChecksumInStream::readChunk()
+  {
+    int32_t length = deserializeInt(*base);
+    uint32_t expected = deserializeInt(*base);
+    HADOOP_ASSERT(length > 0, "invalid checksum chunk length");
+    if ((size_t) length > capacity) {
+      delete[] data;
+      capacity = length;
+      data = new char[capacity];
+    }
+    base->read(data, length);
+    HADOOP_ASSERT(crc32c(0, data, length) == expected,
+                  "checksum mismatch in stream");
+    pos = 0;
+    limit = length;
+  }
+
+  void ChecksumInStream::read(void* buf, size_t len)
+  {
+    char* bytes = (char*) buf;
+    while (len > 0) {
+      if (pos == limit) {
+        readChunk();
+      }
+      size_t available = limit - pos;
+      size_t chunk = len < available ? len : available;
+      memcpy(bytes, data + pos, chunk);
+      pos += chunk;
+      bytes += chunk;
+      len -= chunk;
+    }
+  }
+
+  ChecksumInStream::~ChecksumInStream()
+  {
+    delete[] data;
+    if (owned) {
+      delete base;
+    }
+  }
+
   StringInStream::StringInStream(const std::string& str): buffer(str) {
-    itr = buffer.begin();
+    pos = 0;
   }
 
   void StringInStream::read(void *buf, size_t buflen) {
-    size_t bytes = 0;
-    char* output = (char*) buf;
-    std::string::const_iterator end = buffer.end();
-    while (bytes < buflen) {
-      output[bytes++] = *itr;
-      ++itr;
-      if (itr == end) {
-        break;
+    HADOOP_ASSERT(buflen <= buffer.length() - pos,
+                  "unexpected end of string reached");
+    memcpy(buf, buffer.data() + pos, buflen);
+    pos += buflen;
+  }
+
+  MemoryInStream::MemoryInStream(const char* streamData, size_t streamLength)
+  {
+    data = streamData;
+    length = streamLength;
+    pos = 0;
+  }
+
+  MemoryInStream::MemoryInStream(const std::string& str)
+  {
+    data = str.data();
+    length = str.length();
+    pos = 0;
+  }
+
+  void MemoryInStream::read(void* buf, size_t len)
+  {
+    HADOOP_ASSERT(len <= length - pos, "unexpected end of buffer reached");
+    memcpy(buf, data + pos, len);
+    pos += len;
+  }
+
+  const char* MemoryInStream::readDirect(size_t len)
+  {
+    HADOOP_ASSERT(len <= length - pos, "unexpected end of buffer reached");
+    const char* result = data + pos;
+    pos += len;
+    return result;
+  }
+
+  size_t MemoryInStream::available() const
+  {
+    return length - pos;
+  }
+
+  Arena::Arena(size_t _blockSize)
+  {
+    blockSize = _blockSize;
+    current = 0;
+    used = 0;
+    totalAllocated = 0;
+  }
+
+  char* Arena::alloc(size_t bytes)
+  {
+    // keep the stored data naturally aligned
+    bytes = (bytes + 7) & ~((size_t) 7);
+    if (bytes > blockSize) {
+      char* block = new char[bytes];
+      oversized.push_back(block);
+      totalAllocated += bytes;
+      return block;
+    }
+    if (blocks.empty()) {
+      blocks.push_back(new char[blockSize]);
+      totalAllocated += blockSize;
+    } else if (used + bytes > blockSize) {
+      current += 1;
+      if (current == blocks.size()) {
+        blocks.push_back(new char[blockSize]);
+        totalAllocated += blockSize;
       }
+      used = 0;
+    }
+    char* result = blocks[current] + used;
+    used += bytes;
+    return result;
+  }
+
+  void Arena::reset()
+  {
+    for(size_t i = 0; i < oversized.size(); ++i) {
+      delete[] oversized[i];
+    }
+    oversized.clear();
+    totalAllocated = blocks.size() * blockSize;
+    current = 0;
+    used = 0;
+  }
+
+  void Arena::clear()
+  {
+    for(size_t i = 0; i < blocks.size(); ++i) {
+      delete[] blocks[i];
+    }
+    for(size_t i = 0; i < oversized.size(); ++i) {
+      delete[] oversized[i];
     }
-    HADOOP_ASSERT(bytes == buflen, "unexpected end of string reached");
+    blocks.clear();
+    oversized.clear();
+    current = 0;
+    used = 0;
+    totalAllocated = 0;
+  }
+
+  size_t Arena::allocatedBytes() const
+  {
+    return totalAllocated;
+  }
+
+  void Arena::swap(Arena& other)
+  {
+    std::swap(blockSize, other.blockSize);
+    blocks.swap(other.blocks);
+    oversized.swap(other.oversized);
+    std::swap(current, other.current);
+    std::swap(used, other.used);
+    std::swap(totalAllocated, other.totalAllocated);
+  }
+
+  Arena::~Arena()
+  {
+    clear();
   }
 
   void serializeInt(int32_t t, OutStream& stream) {
     serializeLong(t,stream);
   }
 
-  void serializeLong(int64_t t, OutStream& stream)
+  size_t encodeLong(int64_t t, char* buffer)
   {
     if (t >= -112 && t <= 127) {
-      int8_t b = t;
-      stream.write(&b, 1);
-      return;
+      buffer[0] = (char) t;
+      return 1;
     }
-        
+
     int8_t len = -112;
+    uint64_t value = t;
     if (t < 0) {
-      t ^= -1ll; // reset the sign bit
+      value = ~value; // reset the sign bit
       len = -120;
     }
-        
-    uint64_t tmp = t;
+
+    uint64_t tmp = value;
     while (tmp != 0) {
       tmp = tmp >> 8;
       len--;
     }
-  
-    stream.write(&len, 1);      
-    len = (len < -120) ? -(len + 120) : -(len + 112);
-        
-    for (uint32_t idx = len; idx != 0; idx--) {
-      uint32_t shiftbits = (idx - 1) * 8;
-      uint64_t mask = 0xFFll << shiftbits;
-      uint8_t b = (t & mask) >> shiftbits;
-      stream.write(&b, 1);
+
+    buffer[0] = (char) len;
+    int bytes = (len < -120) ? -(len + 120) : -(len + 112);
+
+    for (int idx = bytes; idx != 0; idx--) {
+      buffer[bytes - idx + 1] = (char) (value >> ((idx - 1) * 8));
+    }
+    return bytes + 1;
+  }
+
+  int64_t decodeLong(const char* buffer, size_t& width)
+  {
+    int8_t b = buffer[0];
+    if (b >= -112) {
+      width = 1;
+      return b;
+    }
+    bool negative = b < -120;
+    int len = negative ? -120 - b : -112 - b;
+    uint64_t value = 0;
+    for (int idx = 0; idx < len; idx++) {
+      value = (value << 8) | (uint8_t) buffer[idx + 1];
+    }
+    width = len + 1;
+    int64_t t = value;
+    return negative ? t ^ -1ll : t;
+  }
+
+  void serializeLong(int64_t t, OutStream& stream)
+  {
+    char buffer[MAX_LONG_BYTES];
+    size_t bytes = encodeLong(t, buffer);
+    stream.write(buffer, bytes);
+  }
+
+  void serializeLongArray(const int64_t* values, size_t count,
+                          OutStream& stream)
+  {
+    char buffer[4096];
+    size_t used = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (used + MAX_LONG_BYTES > sizeof(buffer)) {
+        stream.write(buffer, used);
+        used = 0;
+      }
+      used += encodeLong(values[i], buffer + used);
+    }
+    if (used > 0) {
+      stream.write(buffer, used);
     }
   }
 
@@ -215,49 +700,146 @@ namespace HadoopUtils {
 
   int64_t deserializeLong(InStream& stream)
   {
-    int8_t b;
-    stream.read(&b, 1);
+    char buffer[MAX_LONG_BYTES];
+    stream.read(buffer, 1);
+    int8_t b = buffer[0];
     if (b >= -112) {
       return b;
     }
-    bool negative;
-    int len;
-    if (b < -120) {
-      negative = true;
-      len = -120 - b;
-    } else {
-      negative = false;
-      len = -112 - b;
-    }
-    uint8_t barr[len];
-    stream.read(barr, len);
-    int64_t t = 0;
-    for (int idx = 0; idx < len; idx++) {
-      t = t << 8;
-      t |= (barr[idx] & 0xFF);
+    int len = (b < -120) ? -120 - b : -112 - b;
+    stream.read(buffer + 1, len);
+    size_t width;
+    return decodeLong(buffer, width);
+  }
+
+  void deserializeLongArray(int64_t* values, size_t count, InStream& stream)
+  {
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = deserializeLong(stream);
     }
-    if (negative) {
-      t ^= -1ll;
+  }
+
+  void deserializeLongArray(int64_t* values, size_t count,
+                            BufferedInStream& stream)
+  {
+    for (size_t i = 0; i < count; ++i) {
+      const char* buffer = stream.ensure(1);
+      int8_t b = buffer[0];
+      size_t width = 1;
+      if (b < -112) {
+        int len = (b < -120) ? -120 - b : -112 - b;
+        buffer = stream.ensure(len + 1);
+        values[i] = decodeLong(buffer, width);
+      } else {
+        values[i] = b;
+      }
+      stream.consume(width);
     }
-    return t;
+  }
+
+  /**
+   * Reverse the bytes of a 32 bit value on little-endian hosts, so the
+   * result is the big-endian wire representation. Compilers turn the
+   * shifts into a single byte-swap instruction.
+   */
+  static inline uint32_t toBigEndian32(uint32_t value)
+  {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return value;
+#else
+    return ((value & 0xff000000u) >> 24) |
+           ((value & 0x00ff0000u) >>  8) |
+           ((value & 0x0000ff00u) <<  8) |
+           ((value & 0x000000ffu) << 24);
+#endif
+  }
+
+  static inline uint64_t toBigEndian64(uint64_t value)
+  {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return value;
+#else
+    return (((uint64_t) toBigEndian32(value)) << 32) |
+           toBigEndian32(value >> 32);
+#endif
   }
 
   void serializeFloat(float t, OutStream& stream)
   {
-    char buf[sizeof(float)];
-    XDR xdrs;
-    xdrmem_create(&xdrs, buf, sizeof(float), XDR_ENCODE);
-    xdr_float(&xdrs, &t);
-    stream.write(buf, sizeof(float));
+    uint32_t bits;
+    memcpy(&bits, &t, sizeof(bits));
+    bits = toBigEndian32(bits);
+    stream.write(&bits, sizeof(bits));
   }
 
   void deserializeFloat(float& t, InStream& stream)
   {
-    char buf[sizeof(float)];
-    stream.read(buf, sizeof(float));
-    XDR xdrs;
-    xdrmem_create(&xdrs, buf, sizeof(float), XDR_DECODE);
-    xdr_float(&xdrs, &t);
+    uint32_t bits;
+    stream.read(&bits, sizeof(bits));
+    bits = toBigEndian32(bits);
+    memcpy(&t, &bits, sizeof(t));
+  }
+
+  void serializeFloatArray(const float* values, size_t count,
+                           OutStream& stream)
+  {
+    uint32_t buffer[1024];
+    while (count > 0) {
+      size_t chunk = count < 1024 ? count : 1024;
+      memcpy(buffer, values, chunk * sizeof(uint32_t));
+      for (size_t i = 0; i < chunk; ++i) {
+        buffer[i] = toBigEndian32(buffer[i]);
+      }
+      stream.write(buffer, chunk * sizeof(uint32_t));
+      values += chunk;
+      count -= chunk;
+    }
+  }
+
+  void deserializeFloatArray(float* values, size_t count, InStream& stream)
+  {
+    uint32_t buffer[1024];
+    while (count > 0) {
+      size_t chunk = count < 1024 ? count : 1024;
+      stream.read(buffer, chunk * sizeof(uint32_t));
+      for (size_t i = 0; i < chunk; ++i) {
+        buffer[i] = toBigEndian32(buffer[i]);
+      }
+      memcpy(values, buffer, chunk * sizeof(uint32_t));
+      values += chunk;
+      count -= chunk;
+    }
+  }
+
+  void serializeDoubleArray(const double* values, size_t count,
+                            OutStream& stream)
+  {
+    uint64_t buffer[512];
+    while (count > 0) {
+      size_t chunk = count < 512 ? count : 512;
+      memcpy(buffer, values, chunk * sizeof(uint64_t));
+      for (size_t i = 0; i < chunk; ++i) {
+        buffer[i] = toBigEndian64(buffer[i]);
+      }
+      stream.write(buffer, chunk * sizeof(uint64_t));
+      values += chunk;
+      count -= chunk;
+    }
+  }
+
+  void deserializeDoubleArray(double* values, size_t count, InStream& stream)
+  {
+    uint64_t buffer[512];
+    while (count > 0) {
+      size_t chunk = count < 512 ? count : 512;
+      stream.read(buffer, chunk * sizeof(uint64_t));
+      for (size_t i = 0; i < chunk; ++i) {
+        buffer[i] = toBigEndian64(buffer[i]);
+      }
+      memcpy(values, buffer, chunk * sizeof(uint64_t));
+      values += chunk;
+      count -= chunk;
+    }
   }
 
   void serializeString(const std::string& t, OutStream& stream)
@@ -0,0 +1,371 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hadoop/SortUtils.hh"
+#include "hadoop/SerialUtils.hh"
+#include "hadoop/StringUtils.hh"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace HadoopUtils {
+
+  /**
+   * A record in the sort buffer. The first eight key bytes are kept
+   * big-endian in prefix, so prefix comparisons order the same way
+   * memcmp orders the keys and only prefix ties touch the buffer. The
+   * value bytes follow the key bytes at keyOffset.
+   */
+  struct SortEntry {
+    uint64_t prefix;
+    uint64_t keyOffset;
+    uint32_t keyLength;
+    uint32_t valueLength;
+  };
+
+  static uint64_t keyPrefix(const string& key) {
+    uint64_t prefix = 0;
+    size_t bytes = key.length() < 8 ? key.length() : 8;
+    for(size_t i=0; i < bytes; ++i) {
+      prefix |= ((uint64_t) (unsigned char) key[i]) << (56 - 8 * i);
+    }
+    return prefix;
+  }
+
+  /**
+   * Order entries by key bytes, breaking full-key ties by buffer
+   * position so equal keys keep their insertion order within a run.
+   */
+  class SortEntryComparator {
+  private:
+    const char* buffer;
+  public:
+    SortEntryComparator(const char* _buffer): buffer(_buffer) {}
+
+    bool operator()(const SortEntry& left, const SortEntry& right) const {
+      if (left.prefix != right.prefix) {
+        return left.prefix < right.prefix;
+      }
+      uint32_t common = left.keyLength < right.keyLength
+        ? left.keyLength : right.keyLength;
+      int result = memcmp(buffer + left.keyOffset,
+                          buffer + right.keyOffset, common);
+      if (result != 0) {
+        return result < 0;
+      }
+      if (left.keyLength != right.keyLength) {
+        return left.keyLength < right.keyLength;
+      }
+      return left.keyOffset < right.keyOffset;
+    }
+  };
+
+  /**
+   * One sorted sequence feeding the merge: either a spilled run file
+   * or the final in-memory run.
+   */
+  class MergeStream {
+  public:
+    string key;
+    string value;
+
+    /**
+     * Advance to the next record.
+     * @return false when the stream is exhausted
+     */
+    virtual bool next() = 0;
+    virtual ~MergeStream() {}
+  };
+
+  /**
+   * Reads a spilled run file back and removes it once it drains.
+   */
+  class RunFileStream: public MergeStream {
+  private:
+    string filename;
+    FileInStream* file;
+    BufferedInStream* in;
+    uint64_t remaining;
+  public:
+    RunFileStream(const string& _filename, uint64_t bytes)
+      : filename(_filename) {
+      file = new FileInStream();
+      HADOOP_ASSERT(file->open(filename),
+                    "can't reopen sort run " + filename);
+      in = new BufferedInStream(file, 1024 * 1024, bytes);
+      remaining = deserializeLong(*in);
+    }
+
+    virtual bool next() {
+      if (remaining == 0) {
+        return false;
+      }
+      deserializeString(key, *in);
+      deserializeString(value, *in);
+      remaining -= 1;
+      return true;
+    }
+
+    virtual ~RunFileStream() {
+      delete in;
+      file->close();
+      delete file;
+      remove(filename.c_str());
+    }
+  };
+
+  /**
+   * Walks the sorted in-memory entries.
+   */
+  class MemoryRunStream: public MergeStream {
+  private:
+    const char* buffer;
+    const vector<SortEntry>& entries;
+    size_t position;
+  public:
+    MemoryRunStream(const char* _buffer, const vector<SortEntry>& _entries)
+      : buffer(_buffer), entries(_entries), position(0) {
+    }
+
+    virtual bool next() {
+      if (position >= entries.size()) {
+        return false;
+      }
+      const SortEntry& entry = entries[position];
+      key.assign(buffer + entry.keyOffset, entry.keyLength);
+      value.assign(buffer + entry.keyOffset + entry.keyLength,
+                   entry.valueLength);
+      position += 1;
+      return true;
+    }
+  };
+
+  /**
+   * A loser tree over the merge streams: each internal node stores the
+   * stream that lost the match there, so replacing the winner after a
+   * record is consumed replays one comparison per level instead of the
+   * two a heap sifts through. Exhausted streams compare after
+   * everything; stream index breaks key ties, so the earlier run wins
+   * and equal keys stay in insertion order across runs.
+   */
+  class LoserTree {
+  private:
+    vector<MergeStream*>& streams;
+    vector<bool> live;
+    vector<int> losers;
+    int size;
+
+    /**
+     * Does stream left's current record sort before stream right's?
+     */
+    bool beats(int left, int right) const {
+      if (!live[left]) {
+        return false;
+      }
+      if (!live[right]) {
+        return true;
+      }
+      int result = streams[left]->key.compare(streams[right]->key);
+      if (result != 0) {
+        return result < 0;
+      }
+      return left < right;
+    }
+
+    /**
+     * Replay the matches from stream i's leaf to the root. During
+     * construction a stream parks in the first empty node on its path;
+     * afterwards every node holds the loser of the match played there
+     * and losers[0] holds the winner.
+     */
+    void adjust(int i) {
+      int winner = i;
+      for(int node = (size + i) / 2; node >= 1; node /= 2) {
+        if (losers[node] == -1) {
+          losers[node] = winner;
+          return;
+        }
+        if (beats(losers[node], winner)) {
+          int loser = winner;
+          winner = losers[node];
+          losers[node] = loser;
+        }
+      }
+      losers[0] = winner;
+    }
+
+  public:
+    LoserTree(vector<MergeStream*>& _streams): streams(_streams) {
+      size = streams.size();
+      live.resize(size);
+      for(int i=0; i < size; ++i) {
+        live[i] = streams[i]->next();
+      }
+      losers.assign(size < 2 ? 2 : size, -1);
+      for(int i=size-1; i >= 0; --i) {
+        adjust(i);
+      }
+    }
+
+    /**
+     * Deliver every record to the sink in key order.
+     */
+    void drain(RecordSink& sink) {
+      while (true) {
+        int winner = losers[0];
+        if (!live[winner]) {
+          return;
+        }
+        sink.sorted(streams[winner]->key, streams[winner]->value);
+        live[winner] = streams[winner]->next();
+        adjust(winner);
+      }
+    }
+  };
+
+  struct ExternalSorterImpl {
+    size_t memoryLimit;
+    string spillDir;
+    vector<char> buffer;
+    vector<SortEntry> entries;
+    vector<string> runFiles;
+    vector<uint64_t> runBytes;
+    uint64_t records;
+    uint64_t spills;
+    bool sorted;
+  };
+
+  ExternalSorter::ExternalSorter(size_t memoryLimit, const string& spillDir) {
+    impl = new ExternalSorterImpl();
+    impl->memoryLimit = memoryLimit;
+    impl->spillDir = spillDir;
+    impl->records = 0;
+    impl->spills = 0;
+    impl->sorted = false;
+  }
+
+  ExternalSorter::~ExternalSorter() {
+    for(size_t i=0; i < impl->runFiles.size(); ++i) {
+      remove(impl->runFiles[i].c_str());
+    }
+    delete impl;
+  }
+
+  static void sortRun(ExternalSorterImpl& state) {
+    if (state.entries.empty()) {
+      return;
+    }
+    std::sort(state.entries.begin(), state.entries.end(),
+              SortEntryComparator(&state.buffer[0]));
+  }
+
+  /**
+   * Sort the buffered run and write it out: a record count, then the
+   * records in key order.
+   */
+  static void spillRun(ExternalSorterImpl& state) {
+    sortRun(state);
+    string filename = state.spillDir + "/sort-run-" +
+      toString((int64_t) state.runFiles.size());
+    FileOutStream out;
+    HADOOP_ASSERT(out.open(filename, true),
+                  "can't create sort run " + filename);
+    serializeLong(state.entries.size(), out);
+    string key;
+    string value;
+    for(size_t i=0; i < state.entries.size(); ++i) {
+      const SortEntry& entry = state.entries[i];
+      key.assign(&state.buffer[0] + entry.keyOffset, entry.keyLength);
+      value.assign(&state.buffer[0] + entry.keyOffset + entry.keyLength,
+                   entry.valueLength);
+      serializeString(key, out);
+      serializeString(value, out);
+    }
+    out.flush();
+    struct stat fileStat;
+    uint64_t bytes = stat(filename.c_str(), &fileStat) == 0
+      ? (uint64_t) fileStat.st_size : 0;
+    out.close();
+    state.runFiles.push_back(filename);
+    state.runBytes.push_back(bytes);
+    state.spills += 1;
+    state.buffer.clear();
+    state.entries.clear();
+  }
+
+  void ExternalSorter::add(const string& key, const string& value) {
+    HADOOP_ASSERT(!impl->sorted, "add after sort");
+    size_t used = impl->buffer.size() +
+      impl->entries.size() * sizeof(SortEntry);
+    if (used + key.length() + value.length() + sizeof(SortEntry) >
+        impl->memoryLimit && !impl->entries.empty()) {
+      spillRun(*impl);
+    }
+    SortEntry entry;
+    entry.prefix = keyPrefix(key);
+    entry.keyOffset = impl->buffer.size();
+    entry.keyLength = key.length();
+    entry.valueLength = value.length();
+    impl->buffer.insert(impl->buffer.end(), key.begin(), key.end());
+    impl->buffer.insert(impl->buffer.end(), value.begin(), value.end());
+    impl->entries.push_back(entry);
+    impl->records += 1;
+  }
+
+  void ExternalSorter::sort(RecordSink& sink) {
+    HADOOP_ASSERT(!impl->sorted, "sort ran twice");
+    impl->sorted = true;
+    sortRun(*impl);
+    if (impl->runFiles.empty()) {
+      // everything fit in memory; stream the single run straight out
+      const char* buffer = impl->entries.empty() ? NULL : &impl->buffer[0];
+      MemoryRunStream run(buffer, impl->entries);
+      while (run.next()) {
+        sink.sorted(run.key, run.value);
+      }
+      return;
+    }
+    vector<MergeStream*> streams;
+    for(size_t i=0; i < impl->runFiles.size(); ++i) {
+      streams.push_back(new RunFileStream(impl->runFiles[i],
+                                          impl->runBytes[i]));
+    }
+    streams.push_back(new MemoryRunStream(&impl->buffer[0], impl->entries));
+    LoserTree merge(streams);
+    merge.drain(sink);
+    for(size_t i=0; i < streams.size(); ++i) {
+      delete streams[i];
+    }
+    impl->runFiles.clear();
+    impl->runBytes.clear();
+  }
+
+  uint64_t ExternalSorter::getRecords() const {
+    return impl->records;
+  }
+
+  uint64_t ExternalSorter::getSpills() const {
+    return impl->spills;
+  }
+
+}
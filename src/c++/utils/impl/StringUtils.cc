@@ -18,9 +18,12 @@
 #include "hadoop/StringUtils.hh"
 #include "hadoop/SerialUtils.hh"
 
+#include <ctype.h>
 #include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <sys/time.h>
 
@@ -29,26 +32,77 @@ using std::vector;
 
 namespace HadoopUtils {
 
+  /**
+   * Pairs of decimal digits, so formatting consumes two digits per
+   * division instead of one.
+   */
+  static const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
   string toString(int32_t x) {
-    char str[100];
-    sprintf(str, "%d", x);
-    return str;
+    char str[12];
+    char* end = str + sizeof(str);
+    char* cur = end;
+    uint32_t value = x < 0 ? -(uint32_t) x : (uint32_t) x;
+    while (value >= 100) {
+      uint32_t pair = (value % 100) * 2;
+      value /= 100;
+      *--cur = DIGIT_PAIRS[pair + 1];
+      *--cur = DIGIT_PAIRS[pair];
+    }
+    if (value >= 10) {
+      uint32_t pair = value * 2;
+      *--cur = DIGIT_PAIRS[pair + 1];
+      *--cur = DIGIT_PAIRS[pair];
+    } else {
+      *--cur = '0' + value;
+    }
+    if (x < 0) {
+      *--cur = '-';
+    }
+    return string(cur, end - cur);
   }
 
   int toInt(const string& val) {
-    int result;
-    char trash;
-    int num = sscanf(val.c_str(), "%d%c", &result, &trash);
-    HADOOP_ASSERT(num == 1,
+    const char* cur = val.c_str();
+    while (isspace(*cur)) {
+      ++cur;
+    }
+    bool negative = *cur == '-';
+    if (negative || *cur == '+') {
+      ++cur;
+    }
+    const char* digits = cur;
+    int64_t result = 0;
+    while (*cur >= '0' && *cur <= '9') {
+      result = result * 10 + (*cur - '0');
+      HADOOP_ASSERT(result <= (int64_t) 1 << 32,
+                    "Problem converting " + val + " to integer.");
+      ++cur;
+    }
+    if (negative) {
+      result = -result;
+    }
+    HADOOP_ASSERT(cur != digits && *cur == '\0' &&
+                  result >= -2147483648ll && result <= 2147483647ll,
                   "Problem converting " + val + " to integer.");
     return result;
   }
 
   float toFloat(const string& val) {
-    float result;
-    char trash;
-    int num = sscanf(val.c_str(), "%f%c", &result, &trash);
-    HADOOP_ASSERT(num == 1,
+    const char* str = val.c_str();
+    char* end = NULL;
+    float result = strtof(str, &end);
+    HADOOP_ASSERT(end != str && *end == '\0',
                   "Problem converting " + val + " to float.");
     return result;
   }
@@ -75,104 +129,159 @@ namespace HadoopUtils {
     return tv.tv_sec * 1000 + tv.tv_usec / 1000;
   }
 
+  StringTokenizer::StringTokenizer(const char* data, size_t length,
+                                   const char* separator) {
+    cur = data;
+    end = data + length;
+    setSeparator(separator);
+  }
+
+  StringTokenizer::StringTokenizer(const std::string& str,
+                                   const char* separator) {
+    cur = str.data();
+    end = cur + str.length();
+    setSeparator(separator);
+  }
+
+  void StringTokenizer::setSeparator(const char* separator) {
+    memset(isSeparator, 0, sizeof(isSeparator));
+    for(const char* s = separator; *s != '\0'; ++s) {
+      isSeparator[(unsigned char) *s] = true;
+    }
+  }
+
+  bool StringTokenizer::next(const char** word, size_t* length) {
+    while (cur != end && isSeparator[(unsigned char) *cur]) {
+      ++cur;
+    }
+    if (cur == end) {
+      return false;
+    }
+    const char* start = cur;
+    while (cur != end && !isSeparator[(unsigned char) *cur]) {
+      ++cur;
+    }
+    *word = start;
+    *length = cur - start;
+    return true;
+  }
+
   vector<string> splitString(const std::string& str,
 			     const char* separator) {
     vector<string> result;
-    string::size_type prev_pos=0;
-    string::size_type pos=0;
-    while ((pos = str.find_first_of(separator, prev_pos)) != string::npos) {
-      if (prev_pos < pos) {
-	result.push_back(str.substr(prev_pos, pos-prev_pos));
-      }
-      prev_pos = pos + 1;
-    }
-    if (prev_pos < str.size()) {
-      result.push_back(str.substr(prev_pos));
+    StringTokenizer tokenizer(str, separator);
+    const char* word;
+    size_t length;
+    while (tokenizer.next(&word, &length)) {
+      result.push_back(string(word, length));
     }
     return result;
   }
 
   string quoteString(const string& str,
                      const char* deliminators) {
-    
-    string result(str);
-    for(int i=result.length() -1; i >= 0; --i) {
-      char ch = result[i];
-      if (!isprint(ch) ||
-          ch == '\\' || 
-          strchr(deliminators, ch)) {
-        switch (ch) {
-        case '\\':
-          result.replace(i, 1, "\\\\");
-          break;
-        case '\t':
-          result.replace(i, 1, "\\t");
-          break;
-        case '\n':
-          result.replace(i, 1, "\\n");
-          break;
-        case ' ':
-          result.replace(i, 1, "\\s");
-          break;
-        default:
-          char buff[4];
-          sprintf(buff, "\\%02x", static_cast<unsigned char>(result[i]));
-          result.replace(i, 1, buff);
-        }
+    // mark the bytes that need an escape once, then copy the clean
+    // spans between them in bulk instead of editing in place
+    bool escape[256];
+    for(int i=0; i < 256; ++i) {
+      char ch = i;
+      escape[i] = !isprint(ch) || ch == '\\';
+    }
+    for(const char* d = deliminators; *d != '\0'; ++d) {
+      escape[(unsigned char) *d] = true;
+    }
+
+    string result;
+    result.reserve(str.length() + 16);
+    const char* data = str.data();
+    size_t len = str.length();
+    size_t clean = 0;
+    for(size_t i = 0; i < len; ++i) {
+      unsigned char ch = data[i];
+      if (!escape[ch]) {
+        continue;
+      }
+      result.append(data + clean, i - clean);
+      clean = i + 1;
+      switch (ch) {
+      case '\\':
+        result.append("\\\\", 2);
+        break;
+      case '\t':
+        result.append("\\t", 2);
+        break;
+      case '\n':
+        result.append("\\n", 2);
+        break;
+      case ' ':
+        result.append("\\s", 2);
+        break;
+      default:
+        char buff[4];
+        sprintf(buff, "\\%02x", ch);
+        result.append(buff, 3);
       }
     }
+    result.append(data + clean, len - clean);
     return result;
   }
 
   string unquoteString(const string& str) {
-    string result(str);
-    string::size_type current = result.find('\\');
-    while (current != string::npos) {
-      if (current + 1 < result.size()) {
-        char new_ch;
-        int num_chars;
-        if (isxdigit(result[current+1])) {
-          num_chars = 2;
-          HADOOP_ASSERT(current + num_chars < result.size(),
-                     "escape pattern \\<hex><hex> is missing second digit in '"
-                     + str + "'");
-          char sub_str[3];
-          sub_str[0] = result[current+1];
-          sub_str[1] = result[current+2];
-          sub_str[2] = '\0';
-          char* end_ptr = NULL;
-          long int int_val = strtol(sub_str, &end_ptr, 16);
-          HADOOP_ASSERT(*end_ptr == '\0' && int_val >= 0,
-                     "escape pattern \\<hex><hex> is broken in '" + str + "'");
-          new_ch = static_cast<char>(int_val);
-        } else {
-          num_chars = 1;
-          switch(result[current+1]) {
-          case '\\':
-            new_ch = '\\';
-            break;
-          case 't':
-            new_ch = '\t';
-            break;
-          case 'n':
-            new_ch = '\n';
-            break;
-          case 's':
-            new_ch = ' ';
-            break;
-          default:
-            string msg("unknow n escape character '");
-            msg += result[current+1];
-            HADOOP_ASSERT(false, msg + "' found in '" + str + "'");
-          }
-        }
-        result.replace(current, 1 + num_chars, 1, new_ch);
-        current = result.find('\\', current+1);
+    const char* data = str.data();
+    size_t len = str.length();
+    string result;
+    result.reserve(len);
+    size_t clean = 0;
+    while (true) {
+      const char* next = (const char*) memchr(data + clean, '\\',
+                                              len - clean);
+      if (next == NULL) {
+        result.append(data + clean, len - clean);
+        return result;
+      }
+      size_t current = next - data;
+      result.append(data + clean, current - clean);
+      HADOOP_ASSERT(current + 1 < len, "trailing \\ in '" + str + "'");
+      char new_ch;
+      size_t num_chars;
+      if (isxdigit(data[current+1])) {
+        num_chars = 2;
+        HADOOP_ASSERT(current + num_chars < len,
+                   "escape pattern \\<hex><hex> is missing second digit in '"
+                   + str + "'");
+        char sub_str[3];
+        sub_str[0] = data[current+1];
+        sub_str[1] = data[current+2];
+        sub_str[2] = '\0';
+        char* end_ptr = NULL;
+        long int int_val = strtol(sub_str, &end_ptr, 16);
+        HADOOP_ASSERT(*end_ptr == '\0' && int_val >= 0,
+                   "escape pattern \\<hex><hex> is broken in '" + str + "'");
+        new_ch = static_cast<char>(int_val);
       } else {
-        HADOOP_ASSERT(false, "trailing \\ in '" + str + "'");
+        num_chars = 1;
+        switch(data[current+1]) {
+        case '\\':
+          new_ch = '\\';
+          break;
+        case 't':
+          new_ch = '\t';
+          break;
+        case 'n':
+          new_ch = '\n';
+          break;
+        case 's':
+          new_ch = ' ';
+          break;
+        default:
+          string msg("unknow n escape character '");
+          msg += data[current+1];
+          HADOOP_ASSERT(false, msg + "' found in '" + str + "'");
+        }
       }
+      result.append(1, new_ch);
+      clean = current + 1 + num_chars;
     }
-    return result;
   }
 
 }
@@ -0,0 +1,173 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fuse_dfs.h"
+#include "fuse_attr_cache.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ATTR_CACHE_BUCKETS 1024
+// bound per-bucket chains so a huge namespace cannot grow the cache
+// without limit; the oldest entry of a full chain is recycled
+#define ATTR_CACHE_MAX_CHAIN 8
+
+typedef struct attr_entry_struct {
+  char *path;
+  struct stat st;
+  time_t expires;
+  struct attr_entry_struct *next;
+} attr_entry;
+
+static pthread_mutex_t attr_mutex = PTHREAD_MUTEX_INITIALIZER;
+static attr_entry *attr_buckets[ATTR_CACHE_BUCKETS];
+static int attr_timeout = 0;
+
+void dfs_attr_cache_init(int timeout_seconds)
+{
+  attr_timeout = timeout_seconds;
+}
+
+static unsigned int attr_hash(const char *path, size_t len)
+{
+  unsigned int h = 5381;
+  size_t i;
+  for (i = 0; i < len; i++) {
+    h = h * 33 + (unsigned char)path[i];
+  }
+  return h % ATTR_CACHE_BUCKETS;
+}
+
+int dfs_attr_cache_get(const char *path, struct stat *st)
+{
+  int ret = -1;
+
+  if (attr_timeout <= 0) {
+    return -1;
+  }
+
+  assert(path);
+  assert(st);
+
+  pthread_mutex_lock(&attr_mutex);
+  attr_entry **prev = &attr_buckets[attr_hash(path, strlen(path))];
+  attr_entry *e;
+  while (NULL != (e = *prev)) {
+    if (strcmp(e->path, path) == 0) {
+      if (e->expires > time(NULL)) {
+        *st = e->st;
+        ret = 0;
+      } else {
+        *prev = e->next;
+        free(e->path);
+        free(e);
+      }
+      break;
+    }
+    prev = &e->next;
+  }
+  pthread_mutex_unlock(&attr_mutex);
+
+  return ret;
+}
+
+void dfs_attr_cache_put(const char *path, const struct stat *st)
+{
+  if (attr_timeout <= 0) {
+    return;
+  }
+
+  assert(path);
+  assert(st);
+
+  pthread_mutex_lock(&attr_mutex);
+  attr_entry **bucket = &attr_buckets[attr_hash(path, strlen(path))];
+  attr_entry *e;
+  int chain = 0;
+  for (e = *bucket; e != NULL; e = e->next) {
+    if (strcmp(e->path, path) == 0) {
+      e->st = *st;
+      e->expires = time(NULL) + attr_timeout;
+      pthread_mutex_unlock(&attr_mutex);
+      return;
+    }
+    chain++;
+  }
+
+  if (chain >= ATTR_CACHE_MAX_CHAIN) {
+    // recycle the entry at the end of the chain - it is the one that
+    // has gone longest without being re-put
+    attr_entry **prev = bucket;
+    while ((*prev)->next != NULL) {
+      prev = &(*prev)->next;
+    }
+    e = *prev;
+    *prev = NULL;
+    free(e->path);
+  } else {
+    e = (attr_entry*)malloc(sizeof(attr_entry));
+  }
+  if (e != NULL) {
+    e->path = strdup(path);
+    if (e->path == NULL) {
+      free(e);
+    } else {
+      e->st = *st;
+      e->expires = time(NULL) + attr_timeout;
+      e->next = *bucket;
+      *bucket = e;
+    }
+  }
+  pthread_mutex_unlock(&attr_mutex);
+}
+
+// drop the entry whose path is the first len bytes of path, if any
+static void attr_remove(const char *path, size_t len)
+{
+  pthread_mutex_lock(&attr_mutex);
+  attr_entry **prev = &attr_buckets[attr_hash(path, len)];
+  attr_entry *e;
+  while (NULL != (e = *prev)) {
+    if (strlen(e->path) == len && strncmp(e->path, path, len) == 0) {
+      *prev = e->next;
+      free(e->path);
+      free(e);
+      break;
+    }
+    prev = &e->next;
+  }
+  pthread_mutex_unlock(&attr_mutex);
+}
+
+void dfs_attr_cache_invalidate(const char *path)
+{
+  if (attr_timeout <= 0 || path == NULL) {
+    return;
+  }
+
+  attr_remove(path, strlen(path));
+
+  // the parent's mtime and link count just changed too
+  const char *slash = strrchr(path, '/');
+  if (slash != NULL && slash != path) {
+    attr_remove(path, slash - path);
+  } else if (slash == path && path[1] != '\0') {
+    attr_remove("/", 1);
+  }
+}
@@ -0,0 +1,44 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FUSE_ATTR_CACHE_H__
+#define __FUSE_ATTR_CACHE_H__
+
+#include <sys/stat.h>
+
+//
+// TTL cache of path -> struct stat. dfs_readdir stores the attributes
+// of every entry it lists so the getattr storm an `ls -l` causes is
+// answered from memory instead of one hdfsGetPathInfo per file.
+// Anything that changes a path drops its entry and its parent's.
+//
+
+// set up the cache; called once from dfs_init. A timeout of zero or
+// less leaves the cache disabled.
+void dfs_attr_cache_init(int timeout_seconds);
+
+// look up path; fills st and returns 0 on a fresh hit, -1 otherwise
+int dfs_attr_cache_get(const char *path, struct stat *st);
+
+// remember the attributes of path for the next timeout seconds
+void dfs_attr_cache_put(const char *path, const struct stat *st);
+
+// forget path and its parent directory (whose mtime just changed)
+void dfs_attr_cache_invalidate(const char *path);
+
+#endif
@@ -0,0 +1,381 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fuse_dfs.h"
+#include "fuse_block_cache.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+//
+// One cached block. A block shorter than the block size marks EOF at
+// start + length, which is safe because a path's blocks are dropped
+// whenever this mount writes, truncates, removes or renames it.
+//
+typedef struct dfs_cache_block_struct {
+  char *path;    // NULL while the slot is empty
+  off_t start;   // aligned to the block size
+  size_t length; // valid bytes; < block size only at EOF
+  char *data;
+  struct dfs_cache_block_struct *prev; // LRU list; head is most recent
+  struct dfs_cache_block_struct *next;
+} dfs_cache_block;
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static dfs_cache_block *cache_head = NULL;
+static dfs_cache_block *cache_tail = NULL;
+static size_t cache_block_size = 0;
+static int cache_enabled = 0;
+
+//
+// Readahead state - a single background thread prefetches the block
+// after a sequential read so the next foreground read hits memory.
+// Only the newest request is kept; stale ones are simply dropped.
+//
+static pthread_cond_t ra_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t ra_done_cond = PTHREAD_COND_INITIALIZER;
+static struct {
+  hdfsFS fs;
+  hdfsFile f;
+  char *path;
+  off_t start;
+  int valid;
+} ra_pending;
+static hdfsFile ra_inflight = NULL; // handle the worker is reading from
+static int ra_running = 0;
+
+static void *ra_worker(void *arg);
+
+void dfs_block_cache_init(size_t block_size, int num_blocks)
+{
+  int i;
+
+  assert(block_size > 0);
+  assert(num_blocks > 0);
+
+  for (i = 0; i < num_blocks; i++) {
+    dfs_cache_block *b = (dfs_cache_block*)calloc(1, sizeof(dfs_cache_block));
+    if (b == NULL || NULL == (b->data = (char*)malloc(block_size))) {
+      syslog(LOG_ERR, "ERROR: could not allocate all of the dfs block cache %s:%d\n", __FILE__, __LINE__);
+      free(b);
+      break;
+    }
+    b->next = cache_head;
+    if (cache_head != NULL) {
+      cache_head->prev = b;
+    } else {
+      cache_tail = b;
+    }
+    cache_head = b;
+  }
+
+  cache_block_size = block_size;
+  cache_enabled = (cache_head != NULL);
+
+  if (cache_enabled) {
+    // start the readahead thread; the cache works without it if the
+    // scratch buffer or the thread cannot be created
+    char *scratch = (char*)malloc(block_size);
+    pthread_t thread;
+    if (scratch != NULL && pthread_create(&thread, NULL, ra_worker, scratch) == 0) {
+      ra_running = 1;
+    } else {
+      syslog(LOG_ERR, "ERROR: could not start the dfs readahead thread %s:%d\n", __FILE__, __LINE__);
+      free(scratch);
+    }
+  }
+}
+
+int dfs_block_cache_enabled(void)
+{
+  return cache_enabled;
+}
+
+// move a block to the front of the LRU list; cache_mutex held
+static void cache_touch(dfs_cache_block *b)
+{
+  if (b == cache_head) {
+    return;
+  }
+  b->prev->next = b->next;
+  if (b->next != NULL) {
+    b->next->prev = b->prev;
+  } else {
+    cache_tail = b->prev;
+  }
+  b->prev = NULL;
+  b->next = cache_head;
+  cache_head->prev = b;
+  cache_head = b;
+}
+
+// cache_mutex held
+static dfs_cache_block *cache_find(const char *path, off_t start)
+{
+  dfs_cache_block *b;
+  for (b = cache_head; b != NULL; b = b->next) {
+    if (b->path != NULL && b->start == start && strcmp(b->path, path) == 0) {
+      return b;
+    }
+  }
+  return NULL;
+}
+
+// recycle the least recently used slot for a freshly filled block,
+// taking the data buffer from *scratchp and leaving the old slot
+// buffer there for reuse. Returns the block, or NULL if the path
+// could not be copied; cache_mutex held
+static dfs_cache_block *cache_insert(const char *path, off_t start,
+                                     size_t length, char **scratchp)
+{
+  dfs_cache_block *b = cache_tail;
+  char *tmp;
+
+  free(b->path);
+  b->path = strdup(path);
+  if (b->path == NULL) {
+    b->length = 0;
+    return NULL;
+  }
+  b->start = start;
+  b->length = length;
+  tmp = b->data;
+  b->data = *scratchp;
+  *scratchp = tmp;
+  return b;
+}
+
+// read one whole block from dfs into data; returns the number of
+// valid bytes (short at EOF) or -1 on error
+static ssize_t cache_fill(hdfsFS fs, hdfsFile f, off_t start, char *data)
+{
+  tSize num_read = 0;
+  size_t total_read = 0;
+
+  while (cache_block_size - total_read > 0 &&
+         (num_read = hdfsPread(fs, f, start + total_read, data + total_read, cache_block_size - total_read)) > 0) {
+    total_read += num_read;
+  }
+  if (num_read < 0) {
+    return -1;
+  }
+  return total_read;
+}
+
+static void *ra_worker(void *arg)
+{
+  char *scratch = (char*)arg;
+
+  pthread_mutex_lock(&cache_mutex);
+  for (;;) {
+    while (!ra_pending.valid) {
+      pthread_cond_wait(&ra_cond, &cache_mutex);
+    }
+    hdfsFS fs = ra_pending.fs;
+    hdfsFile f = ra_pending.f;
+    char *path = ra_pending.path;
+    off_t start = ra_pending.start;
+    ra_pending.valid = 0;
+
+    if (cache_find(path, start) != NULL) {
+      free(path);
+      continue;
+    }
+    ra_inflight = f;
+    pthread_mutex_unlock(&cache_mutex);
+
+    ssize_t filled = cache_fill(fs, f, start, scratch);
+
+    pthread_mutex_lock(&cache_mutex);
+    if (filled >= 0 && cache_find(path, start) == NULL) {
+      dfs_cache_block *b = cache_insert(path, start, (size_t)filled, &scratch);
+      if (b != NULL) {
+        cache_touch(b);
+      }
+    }
+    ra_inflight = NULL;
+    pthread_cond_broadcast(&ra_done_cond);
+    free(path);
+  }
+  return NULL;
+}
+
+// hand the block at start to the readahead thread; drops the request
+// if it is already cached or the worker is not up
+static void ra_schedule(hdfsFS fs, hdfsFile f, const char *path, off_t start)
+{
+  char *pathCopy;
+
+  pthread_mutex_lock(&cache_mutex);
+  if (!ra_running || cache_find(path, start) != NULL ||
+      NULL == (pathCopy = strdup(path))) {
+    pthread_mutex_unlock(&cache_mutex);
+    return;
+  }
+  if (ra_pending.valid) {
+    // readahead has fallen behind; the newest request wins
+    free(ra_pending.path);
+  }
+  ra_pending.fs = fs;
+  ra_pending.f = f;
+  ra_pending.path = pathCopy;
+  ra_pending.start = start;
+  ra_pending.valid = 1;
+  pthread_cond_signal(&ra_cond);
+  pthread_mutex_unlock(&cache_mutex);
+}
+
+void dfs_block_cache_drain(hdfsFile f)
+{
+  if (!cache_enabled) {
+    return;
+  }
+
+  pthread_mutex_lock(&cache_mutex);
+  if (ra_pending.valid && ra_pending.f == f) {
+    free(ra_pending.path);
+    ra_pending.valid = 0;
+  }
+  while (ra_inflight == f) {
+    pthread_cond_wait(&ra_done_cond, &cache_mutex);
+  }
+  pthread_mutex_unlock(&cache_mutex);
+}
+
+ssize_t dfs_block_cache_read(hdfsFS fs, hdfsFile f, const char *path,
+                             char *buf, size_t size, off_t offset)
+{
+  size_t total = 0;
+  char *scratch = NULL;
+  int seq = 0;
+  int hit_eof = 0;
+  int blocks_touched = 0;
+  off_t last_start = 0;
+
+  assert(cache_enabled);
+  assert(path);
+  assert(buf);
+
+  while (total < size) {
+    const off_t pos = offset + total;
+    const off_t start = pos - (pos % (off_t)cache_block_size);
+    const size_t block_off = pos - start;
+    size_t amount = 0;
+    int at_eof = 0;
+
+    pthread_mutex_lock(&cache_mutex);
+    if (total == 0) {
+      // the read looks sequential if it starts at the front of the
+      // file or right after a block that is still cached
+      seq = (start == 0) ||
+            (cache_find(path, start - (off_t)cache_block_size) != NULL);
+    }
+    last_start = start;
+    blocks_touched++;
+    dfs_cache_block *b = cache_find(path, start);
+    if (b == NULL && block_off == 0 && size - total >= cache_block_size) {
+      // a miss that wants this whole block: read straight into the
+      // caller's buffer and skip the intermediate copy entirely
+      pthread_mutex_unlock(&cache_mutex);
+      ssize_t filled = cache_fill(fs, f, start, buf + total);
+      if (filled < 0) {
+        free(scratch);
+        return -1;
+      }
+      total += (size_t)filled;
+      if ((size_t)filled < cache_block_size) {
+        hit_eof = 1;
+        break;
+      }
+      continue;
+    }
+    if (b == NULL) {
+      // miss: fill a scratch buffer outside the lock so concurrent
+      // readers of other blocks are not held up by the fetch
+      pthread_mutex_unlock(&cache_mutex);
+
+      if (scratch == NULL && NULL == (scratch = (char*)malloc(cache_block_size))) {
+        return -1;
+      }
+      ssize_t filled = cache_fill(fs, f, start, scratch);
+      if (filled < 0) {
+        free(scratch);
+        return -1;
+      }
+
+      pthread_mutex_lock(&cache_mutex);
+      b = cache_find(path, start);
+      if (b == NULL) {
+        // another thread did not beat us to it: recycle the least
+        // recently used slot and swap the scratch buffer in
+        b = cache_insert(path, start, (size_t)filled, &scratch);
+        if (b == NULL) {
+          pthread_mutex_unlock(&cache_mutex);
+          free(scratch);
+          return -1;
+        }
+      }
+    }
+
+    cache_touch(b);
+    if (b->length > block_off) {
+      amount = b->length - block_off;
+      if (amount > size - total) {
+        amount = size - total;
+      }
+      memcpy(buf + total, b->data + block_off, amount);
+    }
+    at_eof = (b->length < cache_block_size);
+    pthread_mutex_unlock(&cache_mutex);
+
+    total += amount;
+    if (at_eof) {
+      hit_eof = 1;
+      break;
+    }
+  }
+
+  free(scratch);
+
+  // a request spanning several blocks is a sequential consumer even if
+  // its earlier blocks bypassed the cache and so were never stored
+  if ((seq || blocks_touched >= 2) && !hit_eof && total > 0) {
+    ra_schedule(fs, f, path, last_start + (off_t)cache_block_size);
+  }
+
+  return total;
+}
+
+void dfs_block_cache_invalidate(const char *path)
+{
+  dfs_cache_block *b;
+
+  if (!cache_enabled || path == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&cache_mutex);
+  for (b = cache_head; b != NULL; b = b->next) {
+    if (b->path != NULL && strcmp(b->path, path) == 0) {
+      free(b->path);
+      b->path = NULL;
+      b->length = 0;
+    }
+  }
+  pthread_mutex_unlock(&cache_mutex);
+}
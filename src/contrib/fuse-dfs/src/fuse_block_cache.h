@@ -0,0 +1,54 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FUSE_BLOCK_CACHE_H__
+#define __FUSE_BLOCK_CACHE_H__
+
+#include <hdfs.h>
+#include <sys/types.h>
+
+//
+// Mount-wide LRU cache of fixed-size file blocks, shared by every
+// open handle. Blocks are keyed by (path, aligned offset), so two
+// handles reading the same hot range of the same file hit the same
+// cached bytes instead of each refetching them from HDFS.
+//
+
+// set up the cache; called once from dfs_init. If the memory cannot
+// be allocated the cache simply stays disabled.
+void dfs_block_cache_init(size_t block_size, int num_blocks);
+
+// whether dfs_block_cache_init succeeded
+int dfs_block_cache_enabled(void);
+
+// copy up to size bytes of path starting at offset into buf, reading
+// missing blocks from dfs with positional reads on the given handle.
+// Returns the number of bytes copied (short only at EOF) or -1 on a
+// read error.
+ssize_t dfs_block_cache_read(hdfsFS fs, hdfsFile f, const char *path,
+                             char *buf, size_t size, off_t offset);
+
+// drop all cached blocks of a path; called when it is written,
+// truncated, removed or renamed.
+void dfs_block_cache_invalidate(const char *path);
+
+// wait until no readahead is using the given handle and discard any
+// queued request for it; must be called before the handle is closed.
+void dfs_block_cache_drain(hdfsFile f);
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fuse_dfs.h"
+#include "fuse_buffer_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+// idle buffers carry their freelist link in their own first bytes, so
+// the pool needs no allocations of its own
+typedef struct free_buf_struct {
+  struct free_buf_struct *next;
+  size_t size;
+} free_buf;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static free_buf *pool_head = NULL;
+static size_t pool_bytes = 0;
+static size_t pool_max_bytes = 0;
+
+void dfs_buffer_pool_init(size_t max_bytes)
+{
+  pool_max_bytes = max_bytes;
+}
+
+char *dfs_buffer_get(size_t size)
+{
+  assert(size > 0);
+
+  pthread_mutex_lock(&pool_mutex);
+  free_buf **prev = &pool_head;
+  free_buf *b;
+  while (NULL != (b = *prev)) {
+    if (b->size == size) {
+      *prev = b->next;
+      pool_bytes -= size;
+      pthread_mutex_unlock(&pool_mutex);
+      return (char*)b;
+    }
+    prev = &b->next;
+  }
+  pthread_mutex_unlock(&pool_mutex);
+
+  // the freelist link must fit in the buffer when it comes back
+  return (char*)malloc(size < sizeof(free_buf) ? sizeof(free_buf) : size);
+}
+
+void dfs_buffer_put(char *buf, size_t size)
+{
+  if (buf == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&pool_mutex);
+  if (pool_bytes + size <= pool_max_bytes) {
+    free_buf *b = (free_buf*)buf;
+    b->size = size;
+    b->next = pool_head;
+    pool_head = b;
+    pool_bytes += size;
+    pthread_mutex_unlock(&pool_mutex);
+    return;
+  }
+  pthread_mutex_unlock(&pool_mutex);
+
+  free(buf);
+}
@@ -0,0 +1,44 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FUSE_BUFFER_POOL_H__
+#define __FUSE_BUFFER_POOL_H__
+
+#include <sys/types.h>
+
+//
+// Bounded pool of I/O buffers. Open/close-heavy workloads used to
+// malloc and free an rdbuffer_size buffer per open file; buffers now
+// cycle through a freelist instead, capped in total bytes so idle
+// buffers cannot pin unlimited memory.
+//
+
+// cap the total bytes the pool may keep on its freelist; called once
+// from dfs_init
+void dfs_buffer_pool_init(size_t max_bytes);
+
+// take a buffer of exactly size bytes, from the pool when one is
+// available and from malloc otherwise; returns NULL only when malloc
+// fails
+char *dfs_buffer_get(size_t size);
+
+// hand a buffer back; kept for reuse while the pool is under its cap
+// and freed otherwise. buf may be NULL.
+void dfs_buffer_put(char *buf, size_t size);
+
+#endif
@@ -20,18 +20,86 @@
 
 #include "fuse_dfs.h"
 #include "fuse_connect.h"
-#include "fuse_users.h" 
+#include "fuse_users.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
 
 #if PERMS
 
-/**
- * Connects to the NN as the current user/group according to FUSE
- *
- */
-hdfsFS doConnectAsUser(const char *hostname, int port) {
-  uid_t uid = fuse_get_context()->uid;
+// uid -> connection table, striped so concurrent operations from
+// different users do not serialize on one lock. A hit skips both the
+// passwd/group resolution and the JNI connect call. Entries that go
+// unused are dropped by a scavenger thread; the connection cache in
+// libhdfs holds them for a grace period after that, so an operation
+// racing with expiry still finds the connection alive and the next
+// lookup simply re-inserts it.
+#define CONNECT_STRIPES 64
+#define CONNECT_IDLE_SECONDS 600
+#define CONNECT_SCAVENGE_SECONDS 60
+
+typedef struct conn_entry_struct {
+  uid_t uid;
+  hdfsFS fs;
+  time_t lastUse;
+  struct conn_entry_struct *next;
+} conn_entry;
+
+static struct {
+  pthread_mutex_t lock;
+  conn_entry *head;
+} conn_table[CONNECT_STRIPES];
+
+static pthread_once_t conn_once = PTHREAD_ONCE_INIT;
 
+static void *conn_scavenger(void *arg)
+{
+  for (;;) {
+    sleep(CONNECT_SCAVENGE_SECONDS);
+    time_t cutoff = time(NULL) - CONNECT_IDLE_SECONDS;
+    int i;
+    for (i = 0; i < CONNECT_STRIPES; i++) {
+      pthread_mutex_lock(&conn_table[i].lock);
+      conn_entry **prev = &conn_table[i].head;
+      conn_entry *e;
+      while (NULL != (e = *prev)) {
+        if (e->lastUse < cutoff) {
+          *prev = e->next;
+          hdfsDisconnect(e->fs);
+          free(e);
+        } else {
+          prev = &e->next;
+        }
+      }
+      pthread_mutex_unlock(&conn_table[i].lock);
+    }
+  }
+  return NULL;
+}
+
+static void conn_init(void)
+{
+  pthread_t thread;
+  int i;
+
+  for (i = 0; i < CONNECT_STRIPES; i++) {
+    pthread_mutex_init(&conn_table[i].lock, NULL);
+    conn_table[i].head = NULL;
+  }
+  if (pthread_create(&thread, NULL, conn_scavenger, NULL) != 0) {
+    // without the scavenger connections just linger, as they always did
+    syslog(LOG_ERR, "ERROR: could not start the connection scavenger %s:%d\n", __FILE__, __LINE__);
+  }
+}
+
+// resolve the fuse caller's user and groups and connect as them; the
+// libhdfs connection cache makes a repeat connect for the same user a
+// reference count bump rather than a new JVM round trip
+static hdfsFS conn_connect_raw(const char *hostname, int port, uid_t uid)
+{
   char *user = getUsername(uid);
   if (NULL == user)
     return NULL;
@@ -39,15 +107,89 @@ hdfsFS doConnectAsUser(const char *hostname, int port) {
   char **groups = getGroups(uid, &numgroups);
   hdfsFS fs = hdfsConnectAsUser(hostname, port, user, (const char **)groups, numgroups);
   freeGroups(groups, numgroups);
-  if (user) 
-    free(user);
+  free(user);
   return fs;
 }
 
+/**
+ * Connects to the NN as the current user/group according to FUSE
+ *
+ */
+hdfsFS doConnectAsUser(const char *hostname, int port) {
+  uid_t uid = fuse_get_context()->uid;
+  int stripe = uid % CONNECT_STRIPES;
+  conn_entry *e;
+
+  pthread_once(&conn_once, conn_init);
+
+  pthread_mutex_lock(&conn_table[stripe].lock);
+  for (e = conn_table[stripe].head; e != NULL; e = e->next) {
+    if (e->uid == uid) {
+      e->lastUse = time(NULL);
+      hdfsFS fs = e->fs;
+      pthread_mutex_unlock(&conn_table[stripe].lock);
+      return fs;
+    }
+  }
+  pthread_mutex_unlock(&conn_table[stripe].lock);
+
+  // miss: resolve the user and connect outside the stripe lock so a
+  // slow first connect does not hold up other users on this stripe
+  hdfsFS fs = conn_connect_raw(hostname, port, uid);
+  if (NULL == fs)
+    return NULL;
+
+  pthread_mutex_lock(&conn_table[stripe].lock);
+  for (e = conn_table[stripe].head; e != NULL; e = e->next) {
+    if (e->uid == uid) {
+      // another thread connected this user first; drop our reference
+      e->lastUse = time(NULL);
+      hdfsFS cached = e->fs;
+      pthread_mutex_unlock(&conn_table[stripe].lock);
+      hdfsDisconnect(fs);
+      return cached;
+    }
+  }
+  e = (conn_entry*)malloc(sizeof(conn_entry));
+  if (e != NULL) {
+    e->uid = uid;
+    e->fs = fs;
+    e->lastUse = time(NULL);
+    e->next = conn_table[stripe].head;
+    conn_table[stripe].head = e;
+  }
+  pthread_mutex_unlock(&conn_table[stripe].lock);
+
+  return fs;
+}
+
+hdfsFS doConnectAsUserPinned(const char *hostname, int port) {
+  // deliberately bypasses the uid table: this reference belongs to the
+  // caller, so the scavenger dropping the table's reference cannot take
+  // the connection away from under state that outlives an operation
+  return conn_connect_raw(hostname, port, fuse_get_context()->uid);
+}
+
+void doDisconnectPinned(hdfsFS fs) {
+  if (NULL != fs) {
+    hdfsDisconnect(fs);
+  }
+}
+
 #else
 
 hdfsFS doConnectAsUser(const char *hostname, int port) {
   return hdfsConnect(hostname, port);
 }
 
+hdfsFS doConnectAsUserPinned(const char *hostname, int port) {
+  return hdfsConnect(hostname, port);
+}
+
+void doDisconnectPinned(hdfsFS fs) {
+  if (NULL != fs) {
+    hdfsDisconnect(fs);
+  }
+}
+
 #endif
@@ -29,4 +29,19 @@
 
 hdfsFS doConnectAsUser(const char *hostname, int port) ;
 
+/**
+ * Like doConnectAsUser, but the returned connection carries a libhdfs
+ * reference owned by the caller, so the idle-connection scavenger can
+ * never invalidate it. Use it for state that outlives one fuse
+ * operation - most importantly an open file handle, which may be held
+ * far longer than the idle window. Must be balanced with
+ * doDisconnectPinned.
+ */
+hdfsFS doConnectAsUserPinned(const char *hostname, int port);
+
+/**
+ * Drops the reference taken by doConnectAsUserPinned.
+ */
+void doDisconnectPinned(hdfsFS fs);
+
 #endif
@@ -79,6 +79,8 @@ int main(int argc, char *argv[])
   options.rdbuffer_size = 10*1024*1024; 
   options.attribute_timeout = 60; 
   options.entry_timeout = 60;
+  options.statfs_timeout = 30;
+  options.max_io_size = 131072;
 
   if (fuse_opt_parse(&args, &options, dfs_opts, dfs_options) == -1)
     /** error parsing options */
@@ -102,6 +104,16 @@ int main(int argc, char *argv[])
 
     snprintf(buf, sizeof buf, "-oentry_timeout=%d",options.entry_timeout);
     fuse_opt_add_arg(&args, buf);
+
+    // let the kernel send large requests so each one maps to a single
+    // buffer operation instead of being split into 4K pieces
+    snprintf(buf, sizeof buf, "-omax_read=%d",(int)options.max_io_size);
+    fuse_opt_add_arg(&args, buf);
+#ifdef FUSE_CAP_BIG_WRITES
+    snprintf(buf, sizeof buf, "-omax_write=%d",(int)options.max_io_size);
+    fuse_opt_add_arg(&args, buf);
+    fuse_opt_add_arg(&args, "-obig_writes");
+#endif
   }
 
   if (options.server == NULL || options.port == 0) {
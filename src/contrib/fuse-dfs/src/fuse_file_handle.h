@@ -39,6 +39,12 @@ typedef struct dfs_fh_struct {
   off_t buffersStartOffset; //where the buffer starts in the file
   hdfsFS fs; // for reads/writes need to access as the real user
   pthread_mutex_t mutex;
+  // write-behind state, protected by the lock in fuse_write_behind.c
+  char *wbuf;       // partially filled write-behind buffer, or NULL
+  size_t wbufLen;   // valid bytes in wbuf
+  off_t wExpected;  // file offset the next write must start at
+  int wPending;     // a background flush of this handle is outstanding
+  int wError;       // sticky error from a background flush
 } dfs_fh;
 
 #endif
@@ -20,6 +20,7 @@
 #include "fuse_impls.h"
 #include "fuse_users.h"
 #include "fuse_connect.h"
+#include "fuse_attr_cache.h"
 
 int dfs_chmod(const char *path, mode_t mode)
 {
@@ -46,5 +47,7 @@ int dfs_chmod(const char *path, mode_t mode)
     return -EIO;
   }
 #endif
+  dfs_attr_cache_invalidate(path);
+
   return 0;
 }
@@ -19,6 +19,7 @@
 #include "fuse_dfs.h"
 #include "fuse_impls.h"
 #include "fuse_file_handle.h"
+#include "fuse_write_behind.h"
 
 int dfs_flush(const char *path, struct fuse_file_info *fi) {
   TRACE1("flush", path)
@@ -45,6 +46,13 @@ int dfs_flush(const char *path, struct fuse_file_info *fi) {
     assert(file_handle);
 
     assert(fh->fs);
+
+    // push any write-behind bytes out before asking hdfs to flush
+    if (dfs_write_behind_drain(fh) != 0) {
+      syslog(LOG_ERR, "ERROR: dfs problem - could not drain write-behind for %s %s:%d\n", path, __FILE__, __LINE__);
+      return -EIO;
+    }
+
     if (hdfsFlush(fh->fs, file_handle) != 0) {
       syslog(LOG_ERR, "ERROR: dfs problem - could not flush file_handle(%lx) for %s %s:%d\n",(long)file_handle,path, __FILE__, __LINE__);
       return -EIO;
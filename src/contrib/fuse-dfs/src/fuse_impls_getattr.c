@@ -19,8 +19,10 @@
 #include "fuse_dfs.h"
 #include "fuse_impls.h"
 #include "fuse_stat_struct.h"
+#include "fuse_attr_cache.h"
+#include "fuse_stats.h"
 
-int dfs_getattr(const char *path, struct stat *st)
+static int dfs_getattr_impl(const char *path, struct stat *st)
 {
   TRACE1("getattr", path)
 
@@ -32,6 +34,12 @@ int dfs_getattr(const char *path, struct stat *st)
   assert(path);
   assert(st);
 
+  // answer from the attribute cache (usually filled by readdir) and
+  // skip the hdfsGetPathInfo round trip
+  if (dfs_attr_cache_get(path, st) == 0) {
+    return 0;
+  }
+
   // if not connected, try to connect and fail out if we can't.
   if (NULL == dfs->fs && NULL == (dfs->fs = hdfsConnect(dfs->nn_hostname,dfs->nn_port))) {
     syslog(LOG_ERR, "ERROR: could not connect to %s:%d %s:%d\n", dfs->nn_hostname, dfs->nn_port,__FILE__, __LINE__);
@@ -64,5 +72,22 @@ int dfs_getattr(const char *path, struct stat *st)
   // free the info pointer
   hdfsFreeFileInfo(info,1);
 
+  dfs_attr_cache_put(path, st);
+
   return 0;
 }
+
+int dfs_getattr(const char *path, struct stat *st)
+{
+  struct timeval start;
+  int ret;
+
+  if (dfs_stats_is_stats_path(path)) {
+    return dfs_stats_getattr(st);
+  }
+
+  gettimeofday(&start, NULL);
+  ret = dfs_getattr_impl(path, st);
+  dfs_stats_record(DFS_STAT_GETATTR, dfs_stats_elapsed(&start));
+  return ret;
+}
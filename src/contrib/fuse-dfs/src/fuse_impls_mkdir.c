@@ -20,6 +20,7 @@
 #include "fuse_impls.h"
 #include "fuse_trash.h"
 #include "fuse_connect.h"
+#include "fuse_attr_cache.h"
 
 int dfs_mkdir(const char *path, mode_t mode)
 {
@@ -63,6 +64,8 @@ int dfs_mkdir(const char *path, mode_t mode)
     return -EIO;
   }
 #endif
+  dfs_attr_cache_invalidate(path);
+
   return 0;
 
 }
@@ -20,8 +20,9 @@
 #include "fuse_impls.h"
 #include "fuse_connect.h"
 #include "fuse_file_handle.h"
+#include "fuse_stats.h"
 
-int dfs_open(const char *path, struct fuse_file_info *fi)
+static int dfs_open_impl(const char *path, struct fuse_file_info *fi)
 {
   TRACE1("open", path)
 
@@ -45,13 +46,19 @@ int dfs_open(const char *path, struct fuse_file_info *fi)
     return -EIO;
   }
 
-  if ((fh->fs = doConnectAsUser(dfs->nn_hostname,dfs->nn_port)) == NULL) {
+  // the handle owns a pinned connection reference so the idle-connection
+  // scavenger cannot free the FileSystem while this file is open, no
+  // matter how long the handle is held; release drops it
+  if ((fh->fs = doConnectAsUserPinned(dfs->nn_hostname,dfs->nn_port)) == NULL) {
     syslog(LOG_ERR, "ERROR: could not connect to dfs %s:%d\n", __FILE__, __LINE__);
+    free(fh);
     return -EIO;
   }
 
   if ((fh->hdfsFH = hdfsOpenFile(fh->fs, path, flags,  0, 3, 0)) == NULL) {
     syslog(LOG_ERR, "ERROR: could not connect open file %s:%d\n", __FILE__, __LINE__);
+    doDisconnectPinned(fh->fs);
+    free(fh);
     return -EIO;
   }
 
@@ -60,19 +67,27 @@ int dfs_open(const char *path, struct fuse_file_info *fi)
   //
   pthread_mutex_init(&fh->mutex, NULL);
 
+  // write-behind state starts empty for every handle so release can
+  // always drain it
+  fh->wbuf = NULL;
+  fh->wbufLen = 0;
+  fh->wExpected = 0;
+  fh->wPending = 0;
+  fh->wError = 0;
+
   if (fi->flags & O_WRONLY || fi->flags & O_CREAT) {
     // write specific initialization
     fh->buf = NULL;
+    fh->wExpected = hdfsTell(fh->fs, fh->hdfsFH);
   } else  {
     // read specific initialization
 
     assert(dfs->rdbuffer_size > 0);
 
-    if (NULL == (fh->buf = (char*)malloc(dfs->rdbuffer_size*sizeof (char)))) {
-      syslog(LOG_ERR, "ERROR: could not allocate memory for file buffer for a read for file %s dfs %s:%d\n", path,__FILE__, __LINE__);
-      ret = -EIO;
-    }
-
+    // the read buffer is taken from the buffer pool on the first
+    // buffered read (and not at all when the block cache serves reads),
+    // so opening a file no longer costs a large malloc
+    fh->buf = NULL;
     fh->buffersStartOffset = 0;
     fh->bufferSize = 0;
   }
@@ -81,3 +96,19 @@ int dfs_open(const char *path, struct fuse_file_info *fi)
 
   return ret;
 }
+
+int dfs_open(const char *path, struct fuse_file_info *fi)
+{
+  struct timeval start;
+  int ret;
+
+  // opening the virtual stats file snapshots and resets the counters
+  if (dfs_stats_is_stats_path(path)) {
+    return dfs_stats_open(fi);
+  }
+
+  gettimeofday(&start, NULL);
+  ret = dfs_open_impl(path, fi);
+  dfs_stats_record(DFS_STAT_OPEN, dfs_stats_elapsed(&start));
+  return ret;
+}
@@ -19,6 +19,10 @@
 #include "fuse_dfs.h"
 #include "fuse_impls.h"
 #include "fuse_file_handle.h"
+#include "fuse_block_cache.h"
+#include "fuse_buffer_pool.h"
+#include "fuse_stats.h"
+#include "fuse_stripe_read.h"
 
 static size_t min(const size_t x, const size_t y) {
   return x < y ? x : y;
@@ -31,8 +35,8 @@ static size_t min(const size_t x, const size_t y) {
  * either the entire read be satisfied or the EOF is hit or direct_io is enabled
  *
  */
-int dfs_read(const char *path, char *buf, size_t size, off_t offset,
-                   struct fuse_file_info *fi)
+static int dfs_read_impl(const char *path, char *buf, size_t size, off_t offset,
+                         struct fuse_file_info *fi)
 {
   TRACE1("read",path)
   
@@ -57,8 +61,29 @@ int dfs_read(const char *path, char *buf, size_t size, off_t offset,
   if (size == 0)
     return 0;
 
+  // Serve from the mount-wide block cache when it is up. A short count
+  // from the cache means EOF, which satisfies the fuse postcondition.
+  if (dfs_block_cache_enabled()) {
+    ssize_t num_read = dfs_block_cache_read(fh->fs, fh->hdfsFH, path, buf, size, offset);
+    if (num_read < 0) {
+      syslog(LOG_ERR, "Read error - block cache read failed for %s %s:%d", path, __FILE__, __LINE__);
+      return -EIO;
+    }
+    return num_read;
+  }
+
   // If size is bigger than the read buffer, then just read right into the user supplied buffer
   if ( size >= dfs->rdbuffer_size) {
+    // fan the read out over the stripe pool when it is up, so one large
+    // reader is not capped by a single datanode stream
+    if (dfs_stripe_read_enabled(size)) {
+      ssize_t num_read = dfs_stripe_read(fh->fs, fh->hdfsFH, buf, size, offset);
+      if (num_read < 0) {
+        syslog(LOG_ERR, "Read error - striped read failed for %s %s:%d", path, __FILE__, __LINE__);
+        return -EIO;
+      }
+      return num_read;
+    }
     int num_read;
     size_t total_read = 0;
     while (size - total_read > 0 && (num_read = hdfsPread(fh->fs, fh->hdfsFH, offset + total_read, buf + total_read, size - total_read)) > 0) {
@@ -85,6 +110,13 @@ int dfs_read(const char *path, char *buf, size_t size, off_t offset,
   int isEOF = 0;
   int ret = 0;
 
+  // the buffer is assigned lazily from the pool on the first buffered read
+  if (fh->buf == NULL && NULL == (fh->buf = dfs_buffer_get(dfs->rdbuffer_size))) {
+    syslog(LOG_ERR, "ERROR: could not allocate memory for file buffer for a read for file %s dfs %s:%d\n", path,__FILE__, __LINE__);
+    pthread_mutex_unlock(&fh->mutex);
+    return -EIO;
+  }
+
   // check if the buffer is empty or
   // the read starts before the buffer starts or
   // the read ends after the buffer ends
@@ -160,3 +192,20 @@ int dfs_read(const char *path, char *buf, size_t size, off_t offset,
 
  return ret;
 }
+
+int dfs_read(const char *path, char *buf, size_t size, off_t offset,
+                   struct fuse_file_info *fi)
+{
+  struct timeval start;
+  int ret;
+
+  // the virtual stats file is served from the snapshot taken at open
+  if (dfs_stats_is_stats_path(path)) {
+    return dfs_stats_read((dfs_fh*)fi->fh, buf, size, offset);
+  }
+
+  gettimeofday(&start, NULL);
+  ret = dfs_read_impl(path, buf, size, offset, fi);
+  dfs_stats_record(DFS_STAT_READ, dfs_stats_elapsed(&start));
+  return ret;
+}
@@ -20,9 +20,11 @@
 #include "fuse_impls.h"
 #include "fuse_stat_struct.h"
 #include "fuse_connect.h"
+#include "fuse_attr_cache.h"
+#include "fuse_stats.h"
 
-int dfs_readdir(const char *path, void *buf, fuse_fill_dir_t filler,
-                       off_t offset, struct fuse_file_info *fi)
+static int dfs_readdir_impl(const char *path, void *buf, fuse_fill_dir_t filler,
+                            off_t offset, struct fuse_file_info *fi)
 {
   TRACE1("readdir",path)
 
@@ -74,6 +76,14 @@ int dfs_readdir(const char *path, void *buf, fuse_fill_dir_t filler,
     // NOTE - this API started returning filenames as full dfs uris
     const char *const str = info[i].mName + dfs->dfs_uri_len + path_len + ((path_len == 1 && *path == '/') ? 0 : 1);
 
+    // remember the attributes so the getattr calls that follow an
+    // `ls -l` of this directory are served from memory
+    char child[4096];
+    if (snprintf(child, sizeof(child), "%s%s%s", path,
+                 (path_len == 1 && *path == '/') ? "" : "/", str) < (int)sizeof(child)) {
+      dfs_attr_cache_put(child, &st);
+    }
+
     // pack this entry into the fuse buffer
     int res = 0;
     if ((res = filler(buf,str,&st,0)) != 0) {
@@ -115,3 +125,15 @@ int dfs_readdir(const char *path, void *buf, fuse_fill_dir_t filler,
   hdfsFreeFileInfo(info,numEntries);
   return 0;
 }
+
+int dfs_readdir(const char *path, void *buf, fuse_fill_dir_t filler,
+                       off_t offset, struct fuse_file_info *fi)
+{
+  struct timeval start;
+  int ret;
+
+  gettimeofday(&start, NULL);
+  ret = dfs_readdir_impl(path, buf, filler, offset, fi);
+  dfs_stats_record(DFS_STAT_READDIR, dfs_stats_elapsed(&start));
+  return ret;
+}
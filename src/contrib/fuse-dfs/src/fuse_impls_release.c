@@ -18,7 +18,12 @@
 
 #include "fuse_dfs.h"
 #include "fuse_impls.h"
+#include "fuse_connect.h"
 #include "fuse_file_handle.h"
+#include "fuse_block_cache.h"
+#include "fuse_write_behind.h"
+#include "fuse_attr_cache.h"
+#include "fuse_buffer_pool.h"
 
 /**
  * This mutex is to protect releasing a file handle in case the user calls close in different threads
@@ -54,6 +59,13 @@ int dfs_release (const char *path, struct fuse_file_info *fi) {
     hdfsFile file_handle = (hdfsFile)fh->hdfsFH;
 
     if (NULL != file_handle) {
+      // make sure no background readahead is still using this handle
+      dfs_block_cache_drain(file_handle);
+      // and that everything buffered for write has reached hdfs
+      if (dfs_write_behind_drain(fh) != 0) {
+        syslog(LOG_ERR, "ERROR: dfs problem - could not drain write-behind for %s %s:%d\n", path, __FILE__, __LINE__);
+        ret = -EIO;
+      }
       if (hdfsCloseFile(fh->fs, file_handle) != 0) {
         syslog(LOG_ERR, "ERROR: dfs problem - could not close file_handle(%ld) for %s %s:%d\n",(long)file_handle,path, __FILE__, __LINE__);
         fprintf(stderr, "ERROR: dfs problem - could not close file_handle(%ld) for %s %s:%d\n",(long)file_handle,path, __FILE__, __LINE__);
@@ -62,14 +74,29 @@ int dfs_release (const char *path, struct fuse_file_info *fi) {
     }
 
     if (fh->buf != NULL) {
-      free(fh->buf);
+      if (NULL == file_handle) {
+        // an in-memory stats handle owns a plain malloc'd report
+        free(fh->buf);
+      } else {
+        dfs_buffer_put(fh->buf, dfs->rdbuffer_size);
+      }
     }
     // this is always created and initialized, so always destroy it. (see dfs_open)
     pthread_mutex_destroy(&fh->mutex);
 
+    // drop the connection reference open() pinned for this handle; the
+    // readahead worker was drained above, so nothing still uses fh->fs.
+    // A stats handle never connected and has no reference to drop.
+    if (NULL != fh->fs) {
+      doDisconnectPinned(fh->fs);
+    }
+
     free(fh);
 
     fi->fh = (uint64_t)0;
+
+    // the close made the file's final size visible
+    dfs_attr_cache_invalidate(path);
   }
 
   pthread_mutex_unlock(&release_mutex);
@@ -20,6 +20,8 @@
 #include "fuse_impls.h"
 #include "fuse_trash.h"
 #include "fuse_connect.h"
+#include "fuse_block_cache.h"
+#include "fuse_attr_cache.h"
 
 int dfs_rename(const char *from, const char *to)
 {
@@ -58,6 +60,11 @@ int dfs_rename(const char *from, const char *to)
     return -EIO;
   }
 
+  dfs_block_cache_invalidate(from);
+  dfs_block_cache_invalidate(to);
+  dfs_attr_cache_invalidate(from);
+  dfs_attr_cache_invalidate(to);
+
   return 0;
 
 }
@@ -20,6 +20,7 @@
 #include "fuse_impls.h"
 #include "fuse_trash.h"
 #include "fuse_connect.h"
+#include "fuse_attr_cache.h"
 
 extern const char *const TrashPrefixDir;
 
@@ -67,5 +68,7 @@ int dfs_rmdir(const char *path)
     return -EIO;
   }
 
+  dfs_attr_cache_invalidate(path);
+
   return 0;
 }
@@ -20,6 +20,17 @@
 #include "fuse_impls.h"
 #include "fuse_connect.h"
 
+#include <pthread.h>
+#include <time.h>
+
+// df, desktops and monitoring agents statfs mounts constantly; cache
+// the three NameNode-touching values for dfs->statfs_timeout seconds
+// (0 disables) so that traffic stays off the NameNode
+static pthread_mutex_t statfs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static long cached_cap = 0;
+static long cached_used = 0;
+static long cached_bsize = 0;
+static time_t statfs_fetched = 0;
 
 int dfs_statfs(const char *path, struct statvfs *st)
 {
@@ -36,16 +47,40 @@ int dfs_statfs(const char *path, struct statvfs *st)
   // init the stat structure
   memset(st,0,sizeof(struct statvfs));
 
-  hdfsFS userFS;
-  // if not connected, try to connect and fail out if we can't.
-  if ((userFS = doConnectAsUser(dfs->nn_hostname,dfs->nn_port))== NULL) {
-    syslog(LOG_ERR, "ERROR: could not connect to dfs %s:%d\n", __FILE__, __LINE__);
-    return -EIO;
+  long cap = 0;
+  long used = 0;
+  long bsize = 0;
+  int fresh = 0;
+
+  pthread_mutex_lock(&statfs_mutex);
+  if (statfs_fetched > 0 &&
+      time(NULL) - statfs_fetched < dfs->statfs_timeout) {
+    cap = cached_cap;
+    used = cached_used;
+    bsize = cached_bsize;
+    fresh = 1;
+  }
+  pthread_mutex_unlock(&statfs_mutex);
+
+  if (!fresh) {
+    hdfsFS userFS;
+    // if not connected, try to connect and fail out if we can't.
+    if ((userFS = doConnectAsUser(dfs->nn_hostname,dfs->nn_port))== NULL) {
+      syslog(LOG_ERR, "ERROR: could not connect to dfs %s:%d\n", __FILE__, __LINE__);
+      return -EIO;
+    }
+
+    cap   = hdfsGetCapacity(userFS);
+    used  = hdfsGetUsed(userFS);
+    bsize = hdfsGetDefaultBlockSize(userFS);
+
+    pthread_mutex_lock(&statfs_mutex);
+    cached_cap = cap;
+    cached_used = used;
+    cached_bsize = bsize;
+    statfs_fetched = time(NULL);
+    pthread_mutex_unlock(&statfs_mutex);
   }
-
-  const long cap   = hdfsGetCapacity(userFS);
-  const long used  = hdfsGetUsed(userFS);
-  const long bsize = hdfsGetDefaultBlockSize(userFS);
 
   // fill in the statvfs structure
 
@@ -19,6 +19,7 @@
 #include "fuse_dfs.h"
 #include "fuse_impls.h"
 #include "fuse_connect.h"
+#include "fuse_attr_cache.h"
 
 /**
  * For now implement truncate here and only for size == 0.
@@ -63,5 +64,7 @@ int dfs_truncate(const char *path, off_t size)
     syslog(LOG_ERR, "ERROR: could not connect close file %s:%d\n", __FILE__, __LINE__);
     return -EIO;
   }
+
+  dfs_attr_cache_invalidate(path);
   return 0;
 }
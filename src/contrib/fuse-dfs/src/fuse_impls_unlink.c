@@ -20,6 +20,8 @@
 #include "fuse_impls.h"
 #include "fuse_connect.h"
 #include "fuse_trash.h"
+#include "fuse_block_cache.h"
+#include "fuse_attr_cache.h"
 extern const char *const TrashPrefixDir;
 
 int dfs_unlink(const char *path)
@@ -57,6 +59,9 @@ int dfs_unlink(const char *path)
     return -EIO;
   }
 
+  dfs_block_cache_invalidate(path);
+  dfs_attr_cache_invalidate(path);
+
   return 0;
 
 }
@@ -19,6 +19,7 @@
 #include "fuse_dfs.h"
 #include "fuse_impls.h"
 #include "fuse_connect.h"
+#include "fuse_attr_cache.h"
 
  int dfs_utimens(const char *path, const struct timespec ts[2])
 {
@@ -48,5 +49,7 @@
     return -EIO;
   }
 #endif  
+  dfs_attr_cache_invalidate(path);
+
   return 0;
 }
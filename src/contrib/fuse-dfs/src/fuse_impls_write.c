@@ -19,9 +19,13 @@
 #include "fuse_dfs.h"
 #include "fuse_impls.h"
 #include "fuse_file_handle.h"
+#include "fuse_block_cache.h"
+#include "fuse_write_behind.h"
+#include "fuse_attr_cache.h"
+#include "fuse_stats.h"
 
-int dfs_write(const char *path, const char *buf, size_t size,
-                     off_t offset, struct fuse_file_info *fi)
+static int dfs_write_impl(const char *path, const char *buf, size_t size,
+                          off_t offset, struct fuse_file_info *fi)
 {
   TRACE1("write", path)
 
@@ -41,6 +45,17 @@ int dfs_write(const char *path, const char *buf, size_t size,
   hdfsFile file_handle = (hdfsFile)fh->hdfsFH;
   assert(file_handle);
 
+  // Coalesce into the handle's write-behind buffer when the flusher is
+  // up; the buffered path does its own sequential-write check.
+  if (dfs_write_behind_enabled()) {
+    if (dfs_write_behind(fh, path, buf, size, offset) != 0) {
+      return -EIO;
+    }
+    dfs_block_cache_invalidate(path);
+    dfs_attr_cache_invalidate(path);
+    return size;
+  }
+
   //
   // Critical section - make the sanity check (tell to see the writes are sequential) and the actual write 
   // (no returns until end)
@@ -71,5 +86,23 @@ int dfs_write(const char *path, const char *buf, size_t size,
 
   pthread_mutex_unlock(&fh->mutex);
 
+  if (length > 0) {
+    // the cached blocks and attributes of this file are stale now
+    dfs_block_cache_invalidate(path);
+    dfs_attr_cache_invalidate(path);
+  }
+
   return ret == 0 ? length : ret;
 }
+
+int dfs_write(const char *path, const char *buf, size_t size,
+                     off_t offset, struct fuse_file_info *fi)
+{
+  struct timeval start;
+  int ret;
+
+  gettimeofday(&start, NULL);
+  ret = dfs_write_impl(path, buf, size, offset, fi);
+  dfs_stats_record(DFS_STAT_WRITE, dfs_stats_elapsed(&start));
+  return ret;
+}
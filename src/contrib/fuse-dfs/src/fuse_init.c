@@ -22,6 +22,11 @@
 #include "fuse_init.h"
 #include "fuse_options.h"
 #include "fuse_context_handle.h"
+#include "fuse_block_cache.h"
+#include "fuse_write_behind.h"
+#include "fuse_attr_cache.h"
+#include "fuse_buffer_pool.h"
+#include "fuse_stripe_read.h"
 
 // Hacked up function to basically do:
 //  protectedpaths = split(options.protected,':');
@@ -110,6 +115,7 @@ void *dfs_init()
   dfs->usetrash              = options.usetrash;
   dfs->protectedpaths        = NULL;
   dfs->rdbuffer_size         = options.rdbuffer_size;
+  dfs->statfs_timeout        = options.statfs_timeout;
   dfs->direct_io             = options.direct_io;
 
   bzero(dfs->dfs_uri,0);
@@ -126,6 +132,29 @@ void *dfs_init()
     syslog(LOG_DEBUG, "WARN: dfs->rdbuffersize <= 0 = %ld %s:%d", dfs->rdbuffer_size, __FILE__, __LINE__);
     dfs->rdbuffer_size = 32768;
   }
+
+  // a kernel request should always fit in one read buffer or block
+  if (dfs->rdbuffer_size < options.max_io_size) {
+    dfs->rdbuffer_size = options.max_io_size;
+  }
+
+  // keep up to 64MB of idle read and write-behind buffers for reuse
+  dfs_buffer_pool_init(64 * 1024 * 1024);
+
+  // blocks the size of the read buffer, shared across all open handles
+  dfs_block_cache_init(dfs->rdbuffer_size, 32);
+
+  // coalesce small sequential writes into 1MB chunks per handle,
+  // never smaller than what the kernel may send in one request
+  dfs_write_behind_init(options.max_io_size > 1048576 ? options.max_io_size : 1048576);
+
+  // cache attributes for as long as the kernel is told to
+  dfs_attr_cache_init(options.attribute_timeout);
+
+  // stripe large reads across parallel pread streams, at least 1MB per
+  // stripe so small requests are not split below a sensible transfer
+  dfs_stripe_read_init(options.read_stripes, 1024 * 1024);
+
   return (void*)dfs;
 }
 
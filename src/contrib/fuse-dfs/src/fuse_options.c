@@ -32,8 +32,11 @@ void print_options() {
   fprintf(stderr, "\tusetrash=%d\n",options.usetrash);
   fprintf(stderr, "\tentry_timeout=%d\n",options.entry_timeout);
   fprintf(stderr, "\tattribute_timeout=%d\n",options.attribute_timeout);
+  fprintf(stderr, "\tstatfs_timeout=%d\n",options.statfs_timeout);
   fprintf(stderr, "\tprivate=%d\n",options.private);
   fprintf(stderr, "\trdbuffer_size=%d (KBs)\n",(int)options.rdbuffer_size/1024);
+  fprintf(stderr, "\tmax_io_size=%d (KBs)\n",(int)options.max_io_size/1024);
+  fprintf(stderr, "\tread_stripes=%d\n",options.read_stripes);
 }
 
 const char *program;  
@@ -44,7 +47,7 @@ const char *program;
 
 void print_usage(const char *pname)
 {
-  fprintf(stdout,"USAGE: %s [debug] [--help] [--version] [-oprotected=<colon_seped_list_of_paths] [rw] [-onotrash] [-ousetrash] [-obig_writes] [-oprivate (single user)] [ro] [-oserver=<hadoop_servername>] [-oport=<hadoop_port>] [-oentry_timeout=<secs>] [-oattribute_timeout=<secs>] [-odirect_io] [-onopoermissions] [-o<other fuse option>] <mntpoint> [fuse options]\n",pname);
+  fprintf(stdout,"USAGE: %s [debug] [--help] [--version] [-oprotected=<colon_seped_list_of_paths] [rw] [-onotrash] [-ousetrash] [-obig_writes] [-oprivate (single user)] [ro] [-oserver=<hadoop_servername>] [-oport=<hadoop_port>] [-oentry_timeout=<secs>] [-oattribute_timeout=<secs>] [-ostatfs_timeout=<secs>] [-odirect_io] [-omax_io_size=<bytes>] [-oread_stripes=<threads>] [-onopoermissions] [-o<other fuse option>] <mntpoint> [fuse options]\n",pname);
   fprintf(stdout,"NOTE: debugging option for fuse is -debug\n");
 }
 
@@ -71,9 +74,12 @@ struct fuse_opt dfs_opts[] =
     DFSFS_OPT_KEY("server=%s", server, 0),
     DFSFS_OPT_KEY("entry_timeout=%d", entry_timeout, 0),
     DFSFS_OPT_KEY("attribute_timeout=%d", attribute_timeout, 0),
+    DFSFS_OPT_KEY("statfs_timeout=%d", statfs_timeout, 0),
     DFSFS_OPT_KEY("protected=%s", protected, 0),
     DFSFS_OPT_KEY("port=%d", port, 0),
     DFSFS_OPT_KEY("rdbuffer=%d", rdbuffer_size,0),
+    DFSFS_OPT_KEY("max_io_size=%d", max_io_size,0),
+    DFSFS_OPT_KEY("read_stripes=%d", read_stripes,0),
 
     FUSE_OPT_KEY("private", KEY_PRIVATE),
     FUSE_OPT_KEY("ro", KEY_RO),
@@ -31,9 +31,12 @@ struct options {
   int usetrash;
   int entry_timeout;
   int attribute_timeout;
+  int statfs_timeout;
   int private;
   size_t rdbuffer_size;
+  size_t max_io_size;
   int direct_io;
+  int read_stripes;
 } options;
 
 extern struct fuse_opt dfs_opts[];
@@ -0,0 +1,209 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fuse_dfs.h"
+#include "fuse_stats.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DFS_STATS_PATH "/.fusedfs_stats"
+
+// bucket i counts operations that took [2^i, 2^(i+1)) microseconds;
+// the last bucket absorbs everything slower (about a minute and up)
+#define STAT_BUCKETS 27
+
+static const char *const stat_names[DFS_STAT_OPS] = {
+  "getattr", "readdir", "open", "read", "write"
+};
+
+typedef struct {
+  unsigned long count;
+  unsigned long long totalMicros;
+  unsigned long maxMicros;
+  unsigned long buckets[STAT_BUCKETS];
+} stat_counter;
+
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static stat_counter stats[DFS_STAT_OPS];
+static time_t stats_since = 0; // when the counters were last reset
+
+int dfs_stats_is_stats_path(const char *path)
+{
+  return path != NULL && strcmp(path, DFS_STATS_PATH) == 0;
+}
+
+long dfs_stats_elapsed(const struct timeval *start)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000000L +
+         (now.tv_usec - start->tv_usec);
+}
+
+void dfs_stats_record(int op, long micros)
+{
+  int bucket = 0;
+  long v = micros;
+
+  assert(op >= 0 && op < DFS_STAT_OPS);
+
+  if (v < 0) {
+    v = 0;
+  }
+  while (v > 1 && bucket < STAT_BUCKETS - 1) {
+    v >>= 1;
+    bucket++;
+  }
+
+  pthread_mutex_lock(&stats_mutex);
+  if (stats_since == 0) {
+    stats_since = time(NULL);
+  }
+  stats[op].count++;
+  stats[op].totalMicros += (unsigned long long)(micros < 0 ? 0 : micros);
+  if (micros > 0 && (unsigned long)micros > stats[op].maxMicros) {
+    stats[op].maxMicros = micros;
+  }
+  stats[op].buckets[bucket]++;
+  pthread_mutex_unlock(&stats_mutex);
+}
+
+// render the counters into a malloc'd string, optionally resetting
+// them; the caller frees the result
+static char *stats_format(int reset)
+{
+  // worst case is a header plus one line per op plus one line per
+  // non-empty bucket, each well under this budget
+  const size_t cap = 256 + DFS_STAT_OPS * (STAT_BUCKETS + 1) * 96;
+  char *text = (char*)malloc(cap);
+  size_t len = 0;
+  int op;
+  int i;
+
+  if (text == NULL) {
+    syslog(LOG_ERR, "ERROR: could not allocate the stats report %s:%d\n", __FILE__, __LINE__);
+    return NULL;
+  }
+
+  pthread_mutex_lock(&stats_mutex);
+
+  len += snprintf(text + len, cap - len,
+                  "fuse_dfs operation stats, %ld seconds%s\n",
+                  stats_since == 0 ? 0L : (long)(time(NULL) - stats_since),
+                  reset ? " (counters reset)" : "");
+
+  for (op = 0; op < DFS_STAT_OPS; op++) {
+    const stat_counter *c = &stats[op];
+    if (c->count == 0) {
+      len += snprintf(text + len, cap - len, "%s: 0 calls\n", stat_names[op]);
+      continue;
+    }
+    len += snprintf(text + len, cap - len,
+                    "%s: %lu calls, avg %llu us, max %lu us\n",
+                    stat_names[op], c->count, c->totalMicros / c->count,
+                    c->maxMicros);
+    for (i = 0; i < STAT_BUCKETS; i++) {
+      if (c->buckets[i] == 0) {
+        continue;
+      }
+      if (i == STAT_BUCKETS - 1) {
+        len += snprintf(text + len, cap - len, "  >=%lu us: %lu\n",
+                        1UL << i, c->buckets[i]);
+      } else {
+        len += snprintf(text + len, cap - len, "  <%lu us: %lu\n",
+                        2UL << i, c->buckets[i]);
+      }
+    }
+  }
+
+  if (reset) {
+    memset(stats, 0, sizeof(stats));
+    stats_since = time(NULL);
+  }
+
+  pthread_mutex_unlock(&stats_mutex);
+  return text;
+}
+
+int dfs_stats_getattr(struct stat *st)
+{
+  // size the virtual file from a snapshot without resetting anything;
+  // a read that then finds slightly less text simply hits EOF early
+  char *text = stats_format(0);
+  if (text == NULL) {
+    return -EIO;
+  }
+
+  memset(st, 0, sizeof(struct stat));
+  st->st_mode    = S_IFREG | 0444;
+  st->st_nlink   = 1;
+  st->st_uid     = fuse_get_context()->uid;
+  st->st_gid     = fuse_get_context()->gid;
+  st->st_size    = strlen(text);
+  st->st_blksize = 512;
+  st->st_blocks  = 1;
+  st->st_atime   = time(NULL);
+  st->st_mtime   = st->st_atime;
+  st->st_ctime   = st->st_atime;
+
+  free(text);
+  return 0;
+}
+
+int dfs_stats_open(struct fuse_file_info *fi)
+{
+  // snapshot-and-reset into an ordinary handle; hdfsFH stays NULL,
+  // which is how dfs_read and dfs_release recognize it
+  dfs_fh *fh = (dfs_fh*)calloc(1, sizeof(dfs_fh));
+  if (fh == NULL) {
+    syslog(LOG_ERR, "ERROR: malloc of new file handle failed %s:%d\n", __FILE__, __LINE__);
+    return -EIO;
+  }
+
+  if (NULL == (fh->buf = stats_format(1))) {
+    free(fh);
+    return -EIO;
+  }
+
+  pthread_mutex_init(&fh->mutex, NULL);
+  fh->bufferSize = strlen(fh->buf);
+
+  fi->fh = (uint64_t)fh;
+  return 0;
+}
+
+int dfs_stats_read(dfs_fh *fh, char *buf, size_t size, off_t offset)
+{
+  size_t amount;
+
+  assert(fh);
+  assert(fh->hdfsFH == NULL);
+  assert(fh->buf);
+
+  if (offset >= (off_t)fh->bufferSize) {
+    return 0;
+  }
+  amount = fh->bufferSize - offset;
+  if (amount > size) {
+    amount = size;
+  }
+  memcpy(buf, fh->buf + offset, amount);
+  return amount;
+}
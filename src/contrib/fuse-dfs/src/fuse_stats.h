@@ -0,0 +1,64 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FUSE_STATS_H__
+#define __FUSE_STATS_H__
+
+#include "fuse_file_handle.h"
+
+#include <sys/stat.h>
+#include <sys/time.h>
+
+struct fuse_file_info;
+
+//
+// Per-operation counters and log-scale latency histograms, readable
+// through the virtual file /.fusedfs_stats inside the mount. Opening
+// the file snapshots the numbers and resets them, so each read shows
+// the activity since the previous one.
+//
+
+enum {
+  DFS_STAT_GETATTR = 0,
+  DFS_STAT_READDIR,
+  DFS_STAT_OPEN,
+  DFS_STAT_READ,
+  DFS_STAT_WRITE,
+  DFS_STAT_OPS
+};
+
+// whether path names the virtual stats file
+int dfs_stats_is_stats_path(const char *path);
+
+// microseconds since start, for feeding dfs_stats_record
+long dfs_stats_elapsed(const struct timeval *start);
+
+// account one completed operation of the given kind
+void dfs_stats_record(int op, long micros);
+
+// fill in attributes for the virtual stats file
+int dfs_stats_getattr(struct stat *st);
+
+// open the stats file: snapshot-and-reset into an in-memory handle
+// (fh->hdfsFH stays NULL, which marks it for read and release)
+int dfs_stats_open(struct fuse_file_info *fi);
+
+// serve a read from an in-memory stats handle
+int dfs_stats_read(dfs_fh *fh, char *buf, size_t size, off_t offset);
+
+#endif
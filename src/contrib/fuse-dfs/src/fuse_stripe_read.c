@@ -0,0 +1,192 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fuse_dfs.h"
+#include "fuse_stripe_read.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+// one read in flight: the workers decrement remaining as stripes finish
+// and the last one wakes the caller
+typedef struct sr_op_struct {
+  int remaining;
+  int error;
+} sr_op;
+
+// one stripe of a read; the workers pread straight into the caller's
+// buffer, so finishing a stripe is lock-free until the bookkeeping
+typedef struct sr_job_struct {
+  hdfsFS fs;
+  hdfsFile file;
+  char *buf;
+  size_t size;
+  off_t offset;
+  ssize_t result;
+  sr_op *op;
+  struct sr_job_struct *next;
+} sr_job;
+
+static pthread_mutex_t sr_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sr_cond = PTHREAD_COND_INITIALIZER;      // worker wakeup
+static pthread_cond_t sr_done_cond = PTHREAD_COND_INITIALIZER; // an op finished
+static sr_job *sr_head = NULL;
+static sr_job *sr_tail = NULL;
+static int sr_threads = 0;
+static size_t sr_min_stripe = 0;
+
+// fill one stripe, looping until it is full or EOF. Each hdfsPread is
+// an independent positional read with its own datanode stream, which is
+// where the parallelism across workers comes from.
+static ssize_t sr_fill(sr_job *job)
+{
+  tSize num_read = 0;
+  size_t total_read = 0;
+  while (job->size - total_read > 0 &&
+         (num_read = hdfsPread(job->fs, job->file, job->offset + total_read,
+                               job->buf + total_read,
+                               job->size - total_read)) > 0) {
+    total_read += num_read;
+  }
+  if (num_read < 0) {
+    return -1;
+  }
+  return total_read;
+}
+
+static void *sr_worker(void *arg)
+{
+  pthread_mutex_lock(&sr_mutex);
+  for (;;) {
+    while (sr_head == NULL) {
+      pthread_cond_wait(&sr_cond, &sr_mutex);
+    }
+    sr_job *job = sr_head;
+    sr_head = job->next;
+    if (sr_head == NULL) {
+      sr_tail = NULL;
+    }
+    pthread_mutex_unlock(&sr_mutex);
+
+    job->result = sr_fill(job);
+
+    pthread_mutex_lock(&sr_mutex);
+    if (job->result < 0) {
+      job->op->error = 1;
+    }
+    job->op->remaining--;
+    if (job->op->remaining == 0) {
+      pthread_cond_broadcast(&sr_done_cond);
+    }
+  }
+  return NULL;
+}
+
+void dfs_stripe_read_init(int threads, size_t min_stripe_size)
+{
+  int i;
+  pthread_t thread;
+
+  assert(min_stripe_size > 0);
+
+  if (threads <= 1) {
+    return;
+  }
+  sr_min_stripe = min_stripe_size;
+  for (i = 0; i < threads; i++) {
+    if (pthread_create(&thread, NULL, sr_worker, NULL) != 0) {
+      syslog(LOG_ERR, "ERROR: could not start dfs read stripe thread %d %s:%d\n", i, __FILE__, __LINE__);
+      break;
+    }
+    sr_threads++;
+  }
+  if (sr_threads < 2) {
+    // one worker is no better than the caller reading itself
+    sr_threads = 0;
+  }
+}
+
+int dfs_stripe_read_enabled(size_t size)
+{
+  return sr_threads > 1 && size >= 2 * sr_min_stripe;
+}
+
+ssize_t dfs_stripe_read(hdfsFS fs, hdfsFile file, char *buf, size_t size,
+                        off_t offset)
+{
+  int stripes = size / sr_min_stripe;
+  if (stripes > sr_threads) {
+    stripes = sr_threads;
+  }
+  assert(stripes >= 2);
+
+  sr_job *jobs = (sr_job*)malloc(stripes * sizeof(sr_job));
+  if (jobs == NULL) {
+    return -1;
+  }
+
+  sr_op op;
+  op.remaining = stripes;
+  op.error = 0;
+
+  // split the read evenly, the first stripes taking the remainder
+  size_t stripe_size = size / stripes;
+  size_t leftover = size % stripes;
+  size_t done = 0;
+  int i;
+  for (i = 0; i < stripes; i++) {
+    jobs[i].fs = fs;
+    jobs[i].file = file;
+    jobs[i].buf = buf + done;
+    jobs[i].size = stripe_size + (i < leftover ? 1 : 0);
+    jobs[i].offset = offset + done;
+    jobs[i].result = 0;
+    jobs[i].op = &op;
+    jobs[i].next = (i + 1 < stripes) ? &jobs[i + 1] : NULL;
+    done += jobs[i].size;
+  }
+
+  pthread_mutex_lock(&sr_mutex);
+  if (sr_tail != NULL) {
+    sr_tail->next = &jobs[0];
+  } else {
+    sr_head = &jobs[0];
+  }
+  sr_tail = &jobs[stripes - 1];
+  pthread_cond_broadcast(&sr_cond);
+  while (op.remaining > 0) {
+    pthread_cond_wait(&sr_done_cond, &sr_mutex);
+  }
+  pthread_mutex_unlock(&sr_mutex);
+
+  ssize_t total = 0;
+  if (op.error) {
+    total = -1;
+  } else {
+    // count the contiguous bytes from the start; a short stripe is EOF
+    // and anything read past it must not be counted
+    for (i = 0; i < stripes; i++) {
+      total += jobs[i].result;
+      if ((size_t)jobs[i].result < jobs[i].size) {
+        break;
+      }
+    }
+  }
+  free(jobs);
+  return total;
+}
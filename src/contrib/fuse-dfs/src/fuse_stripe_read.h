@@ -0,0 +1,49 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FUSE_STRIPE_READ_H__
+#define __FUSE_STRIPE_READ_H__
+
+#include "fuse_dfs.h"
+#include <hdfs.h>
+
+//
+// Striped reads. A large fuse read is split into stripes which a pool
+// of worker threads fetch concurrently with hdfsPread straight into the
+// caller's buffer. The pread offsets are independent and each positional
+// read opens its own datanode stream, so one fuse reader gets the
+// throughput of several parallel streams instead of being capped by a
+// single one.
+//
+
+// start the worker pool; called once from dfs_init. threads <= 1
+// leaves striping disabled, as does a failure to start the workers.
+// Reads are split into stripes no smaller than min_stripe_size bytes.
+void dfs_stripe_read_init(int threads, size_t min_stripe_size);
+
+// whether a read of this size would be striped: the pool is up and the
+// read is big enough for at least two stripes
+int dfs_stripe_read_enabled(size_t size);
+
+// read size bytes of the file at offset into buf across the worker
+// pool. Returns the number of contiguous bytes read from offset, which
+// is only short of size at EOF, or -1 on a read error.
+ssize_t dfs_stripe_read(hdfsFS fs, hdfsFile file, char *buf, size_t size,
+                        off_t offset);
+
+#endif
@@ -21,6 +21,8 @@
 #include <grp.h>
 #include <pwd.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "fuse_dfs.h"
 
@@ -39,10 +41,10 @@ pthread_mutex_t groupstruct_mutex = PTHREAD_MUTEX_INITIALIZER;
 #if PERMS
 
 /**
- * Utility for getting the user making the fuse call in char * form
+ * Resolves the username through nsswitch (passwd/LDAP/...).
  * NOTE: if non-null return, the return must be freed by the caller.
  */
-char *getUsername(uid_t uid)
+static char *lookupUsername(uid_t uid)
 {
   //
   // Critical section - protect from concurrent calls in different threads.
@@ -156,11 +158,11 @@ gid_t getGidUid(uid_t uid) {
 }
 
 /**
- * Utility for getting the groups for the user making the fuse call in char * form
+ * Resolves the user's group list through nsswitch.
  */
-char ** getGroups(uid_t uid, int *num_groups)
+static char **lookupGroups(uid_t uid, int *num_groups)
 {
-  char *user = getUsername(uid);
+  char *user = lookupUsername(uid);
 
   if (user == NULL)
     return NULL;
@@ -218,4 +220,195 @@ char ** getGroups(uid_t uid, int *num_groups)
 #endif
   return groupnames;
 }
+
+//
+// uid -> (username, groups) cache. With nsswitch pointed at LDAP every
+// resolution is a network round trip in the I/O path; the cache makes
+// it a memory lookup and a refresher thread re-resolves aging entries
+// off the critical path. A failed refresh keeps the old entry, so an
+// LDAP hiccup serves slightly stale results instead of stalling the
+// mount. The table is direct mapped by uid, which bounds its size.
+//
+#define USER_CACHE_SIZE 256
+#define USER_CACHE_TTL 300
+#define USER_REFRESH_SECONDS 60
+
+typedef struct user_entry_struct {
+  uid_t uid;
+  char *username;
+  char **groups;     // NULL until getGroups has filled it
+  int numgroups;
+  time_t fetched;
+  int valid;
+} user_entry;
+
+static user_entry user_cache[USER_CACHE_SIZE];
+static pthread_mutex_t user_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t user_cache_once = PTHREAD_ONCE_INIT;
+
+// deep copy a group list so the caller can freeGroups it as always
+static char **groupsCopy(char **groups, int numgroups)
+{
+  char **copy = (char**)malloc(sizeof(char*) * (numgroups + 1));
+  int i;
+  if (copy == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < numgroups; i++) {
+    copy[i] = groups[i] ? strdup(groups[i]) : NULL;
+  }
+  return copy;
+}
+
+// user_cache_mutex held
+static void userEntryClear(user_entry *e)
+{
+  free(e->username);
+  freeGroups(e->groups, e->numgroups);
+  e->username = NULL;
+  e->groups = NULL;
+  e->numgroups = 0;
+  e->valid = 0;
+}
+
+static void *userRefresher(void *arg)
+{
+  int i;
+  for (;;) {
+    sleep(USER_REFRESH_SECONDS);
+    for (i = 0; i < USER_CACHE_SIZE; i++) {
+      pthread_mutex_lock(&user_cache_mutex);
+      if (!user_cache[i].valid ||
+          time(NULL) - user_cache[i].fetched < USER_CACHE_TTL) {
+        pthread_mutex_unlock(&user_cache_mutex);
+        continue;
+      }
+      uid_t uid = user_cache[i].uid;
+      int hadGroups = (user_cache[i].groups != NULL);
+      pthread_mutex_unlock(&user_cache_mutex);
+
+      // resolve outside the lock; LDAP may be slow or down
+      char *username = lookupUsername(uid);
+      char **groups = NULL;
+      int numgroups = 0;
+      if (username != NULL && hadGroups) {
+        groups = lookupGroups(uid, &numgroups);
+      }
+
+      pthread_mutex_lock(&user_cache_mutex);
+      if (username != NULL && user_cache[i].valid && user_cache[i].uid == uid &&
+          (!hadGroups || groups != NULL)) {
+        free(user_cache[i].username);
+        freeGroups(user_cache[i].groups, user_cache[i].numgroups);
+        user_cache[i].username = username;
+        user_cache[i].groups = groups;
+        user_cache[i].numgroups = numgroups;
+        user_cache[i].fetched = time(NULL);
+        username = NULL;
+        groups = NULL;
+      }
+      pthread_mutex_unlock(&user_cache_mutex);
+
+      // a failed or raced refresh: drop what we resolved, keep the old entry
+      free(username);
+      freeGroups(groups, numgroups);
+    }
+  }
+  return NULL;
+}
+
+static void userCacheInit(void)
+{
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, userRefresher, NULL) != 0) {
+    syslog(LOG_ERR, "ERROR: could not start the user cache refresher %s:%d\n", __FILE__, __LINE__);
+  }
+}
+
+/**
+ * Utility for getting the user making the fuse call in char * form
+ * NOTE: if non-null return, the return must be freed by the caller.
+ */
+char *getUsername(uid_t uid)
+{
+  user_entry *e = &user_cache[uid % USER_CACHE_SIZE];
+  char *ret = NULL;
+
+  pthread_once(&user_cache_once, userCacheInit);
+
+  pthread_mutex_lock(&user_cache_mutex);
+  if (e->valid && e->uid == uid && e->username != NULL) {
+    ret = strdup(e->username);
+    pthread_mutex_unlock(&user_cache_mutex);
+    return ret;
+  }
+  pthread_mutex_unlock(&user_cache_mutex);
+
+  ret = lookupUsername(uid);
+  if (ret == NULL) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&user_cache_mutex);
+  if (e->valid && e->uid != uid) {
+    userEntryClear(e);
+  }
+  if (!e->valid || e->username == NULL) {
+    free(e->username);
+    e->username = strdup(ret);
+    if (e->username != NULL) {
+      e->uid = uid;
+      e->fetched = time(NULL);
+      e->valid = 1;
+    }
+  }
+  pthread_mutex_unlock(&user_cache_mutex);
+
+  return ret;
+}
+
+/**
+ * Utility for getting the groups for the user making the fuse call in char * form
+ */
+char ** getGroups(uid_t uid, int *num_groups)
+{
+  user_entry *e = &user_cache[uid % USER_CACHE_SIZE];
+  char **ret;
+
+  pthread_once(&user_cache_once, userCacheInit);
+
+  pthread_mutex_lock(&user_cache_mutex);
+  if (e->valid && e->uid == uid && e->groups != NULL) {
+    ret = groupsCopy(e->groups, e->numgroups);
+    if (ret != NULL) {
+      *num_groups = e->numgroups;
+      pthread_mutex_unlock(&user_cache_mutex);
+      return ret;
+    }
+  }
+  pthread_mutex_unlock(&user_cache_mutex);
+
+  ret = lookupGroups(uid, num_groups);
+  if (ret == NULL) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&user_cache_mutex);
+  if (e->valid && e->uid != uid) {
+    userEntryClear(e);
+  }
+  if (e->groups == NULL) {
+    char **copy = groupsCopy(ret, *num_groups);
+    if (copy != NULL) {
+      e->groups = copy;
+      e->numgroups = *num_groups;
+      e->uid = uid;
+      e->fetched = time(NULL);
+      e->valid = 1;
+    }
+  }
+  pthread_mutex_unlock(&user_cache_mutex);
+
+  return ret;
+}
 #endif
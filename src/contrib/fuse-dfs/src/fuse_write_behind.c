@@ -0,0 +1,202 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fuse_dfs.h"
+#include "fuse_write_behind.h"
+#include "fuse_buffer_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+// a full buffer handed off to the flusher thread; at most one job per
+// handle is outstanding, which keeps each handle's writes in order
+typedef struct wb_job_struct {
+  dfs_fh *fh;
+  char *data;
+  size_t length;
+  struct wb_job_struct *next;
+} wb_job;
+
+static pthread_mutex_t wb_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wb_cond = PTHREAD_COND_INITIALIZER;      // worker wakeup
+static pthread_cond_t wb_done_cond = PTHREAD_COND_INITIALIZER; // a job finished
+static wb_job *wb_head = NULL;
+static wb_job *wb_tail = NULL;
+static size_t wb_buffer_size = 0;
+static int wb_running = 0;
+
+static void *wb_worker(void *arg)
+{
+  pthread_mutex_lock(&wb_mutex);
+  for (;;) {
+    while (wb_head == NULL) {
+      pthread_cond_wait(&wb_cond, &wb_mutex);
+    }
+    wb_job *job = wb_head;
+    wb_head = job->next;
+    if (wb_head == NULL) {
+      wb_tail = NULL;
+    }
+    pthread_mutex_unlock(&wb_mutex);
+
+    tSize num_written = 0;
+    size_t total_written = 0;
+    while (job->length - total_written > 0 &&
+           (num_written = hdfsWrite(job->fh->fs, job->fh->hdfsFH, job->data + total_written, job->length - total_written)) > 0) {
+      total_written += num_written;
+    }
+
+    pthread_mutex_lock(&wb_mutex);
+    if (total_written < job->length) {
+      syslog(LOG_ERR, "ERROR: dfs problem - background flush wrote %d of %d bytes %s:%d\n", (int)total_written, (int)job->length, __FILE__, __LINE__);
+      job->fh->wError = 1;
+    }
+    job->fh->wPending = 0;
+    pthread_cond_broadcast(&wb_done_cond);
+    dfs_buffer_put(job->data, wb_buffer_size);
+    free(job);
+  }
+  return NULL;
+}
+
+void dfs_write_behind_init(size_t buffer_size)
+{
+  pthread_t thread;
+
+  assert(buffer_size > 0);
+
+  wb_buffer_size = buffer_size;
+  if (pthread_create(&thread, NULL, wb_worker, NULL) == 0) {
+    wb_running = 1;
+  } else {
+    syslog(LOG_ERR, "ERROR: could not start the dfs write-behind thread %s:%d\n", __FILE__, __LINE__);
+  }
+}
+
+int dfs_write_behind_enabled(void)
+{
+  return wb_running;
+}
+
+// queue the handle's full buffer for the flusher, waiting first for
+// any outstanding job of the handle; wb_mutex held
+static int wb_submit(dfs_fh *fh)
+{
+  wb_job *job = (wb_job*)malloc(sizeof(wb_job));
+  if (job == NULL) {
+    return -1;
+  }
+
+  while (fh->wPending) {
+    pthread_cond_wait(&wb_done_cond, &wb_mutex);
+  }
+
+  job->fh = fh;
+  job->data = fh->wbuf;
+  job->length = fh->wbufLen;
+  job->next = NULL;
+  fh->wbuf = NULL;
+  fh->wbufLen = 0;
+  fh->wPending = 1;
+
+  if (wb_tail != NULL) {
+    wb_tail->next = job;
+  } else {
+    wb_head = job;
+  }
+  wb_tail = job;
+  pthread_cond_signal(&wb_cond);
+  return 0;
+}
+
+int dfs_write_behind(dfs_fh *fh, const char *path, const char *buf,
+                     size_t size, off_t offset)
+{
+  size_t total = 0;
+
+  assert(wb_running);
+  assert(fh);
+
+  pthread_mutex_lock(&wb_mutex);
+
+  if (fh->wError) {
+    pthread_mutex_unlock(&wb_mutex);
+    return -1;
+  }
+
+  if (offset != fh->wExpected) {
+    syslog(LOG_ERR, "ERROR: user trying to random access write to a file %d!=%d for %s %s:%d\n", (int)fh->wExpected, (int)offset, path, __FILE__, __LINE__);
+    pthread_mutex_unlock(&wb_mutex);
+    return -1;
+  }
+
+  while (total < size) {
+    if (fh->wbuf == NULL &&
+        NULL == (fh->wbuf = dfs_buffer_get(wb_buffer_size))) {
+      syslog(LOG_ERR, "ERROR: could not allocate a write-behind buffer for %s %s:%d\n", path, __FILE__, __LINE__);
+      fh->wError = 1;
+      pthread_mutex_unlock(&wb_mutex);
+      return -1;
+    }
+
+    size_t amount = wb_buffer_size - fh->wbufLen;
+    if (amount > size - total) {
+      amount = size - total;
+    }
+    memcpy(fh->wbuf + fh->wbufLen, buf + total, amount);
+    fh->wbufLen += amount;
+    fh->wExpected += amount;
+    total += amount;
+
+    if (fh->wbufLen == wb_buffer_size && wb_submit(fh) != 0) {
+      fh->wError = 1;
+      pthread_mutex_unlock(&wb_mutex);
+      return -1;
+    }
+  }
+
+  pthread_mutex_unlock(&wb_mutex);
+  return 0;
+}
+
+int dfs_write_behind_drain(dfs_fh *fh)
+{
+  int ret;
+
+  if (!wb_running) {
+    return 0;
+  }
+
+  pthread_mutex_lock(&wb_mutex);
+
+  if (fh->wbuf != NULL && fh->wbufLen > 0 && !fh->wError) {
+    if (wb_submit(fh) != 0) {
+      fh->wError = 1;
+    }
+  }
+  while (fh->wPending) {
+    pthread_cond_wait(&wb_done_cond, &wb_mutex);
+  }
+  dfs_buffer_put(fh->wbuf, wb_buffer_size);
+  fh->wbuf = NULL;
+  fh->wbufLen = 0;
+  ret = fh->wError ? -1 : 0;
+
+  pthread_mutex_unlock(&wb_mutex);
+  return ret;
+}
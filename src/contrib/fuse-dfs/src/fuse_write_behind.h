@@ -0,0 +1,49 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FUSE_WRITE_BEHIND_H__
+#define __FUSE_WRITE_BEHIND_H__
+
+#include "fuse_file_handle.h"
+
+//
+// Per-handle write-behind. Small sequential fuse writes are coalesced
+// into a large per-handle buffer which a background thread pushes to
+// hdfs, so the writing process is not blocked on one JNI round trip
+// per 4K chunk. dfs_flush and dfs_release drain synchronously.
+//
+
+// set up write-behind; called once from dfs_init. If the worker
+// thread cannot be started write-behind simply stays disabled.
+void dfs_write_behind_init(size_t buffer_size);
+
+// whether dfs_write_behind_init succeeded
+int dfs_write_behind_enabled(void);
+
+// buffer size bytes of path at offset; the write must continue where
+// the previous one ended. Returns 0 on success and -1 on an error,
+// including one from an earlier background flush of this handle.
+int dfs_write_behind(dfs_fh *fh, const char *path, const char *buf,
+                     size_t size, off_t offset);
+
+// push any buffered bytes of the handle to hdfs and wait until its
+// outstanding background flush is done. Returns 0, or -1 if any flush
+// of the handle has failed; must be called before the handle is closed.
+int dfs_write_behind_drain(dfs_fh *fh);
+
+#endif
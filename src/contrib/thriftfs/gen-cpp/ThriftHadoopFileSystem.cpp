@@ -1461,6 +1461,258 @@ uint32_t ThriftHadoopFileSystem_read_presult::read(facebook::thrift::protocol::T
   return xfer;
 }
 
+uint32_t ThriftHadoopFileSystem_readChunks_args::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->handle.read(iprot);
+          this->__isset.handle = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case -1:
+        if (ftype == facebook::thrift::protocol::T_I64) {
+          xfer += iprot->readI64(this->offset);
+          this->__isset.offset = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case -2:
+        if (ftype == facebook::thrift::protocol::T_I32) {
+          xfer += iprot->readI32(this->size);
+          this->__isset.size = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case -3:
+        if (ftype == facebook::thrift::protocol::T_I32) {
+          xfer += iprot->readI32(this->chunkSize);
+          this->__isset.chunkSize = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_readChunks_args::write(facebook::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_readChunks_args");
+  xfer += oprot->writeFieldBegin("handle", facebook::thrift::protocol::T_STRUCT, 1);
+  xfer += this->handle.write(oprot);
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldBegin("offset", facebook::thrift::protocol::T_I64, -1);
+  xfer += oprot->writeI64(this->offset);
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldBegin("size", facebook::thrift::protocol::T_I32, -2);
+  xfer += oprot->writeI32(this->size);
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldBegin("chunkSize", facebook::thrift::protocol::T_I32, -3);
+  xfer += oprot->writeI32(this->chunkSize);
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_readChunks_pargs::write(facebook::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_readChunks_pargs");
+  xfer += oprot->writeFieldBegin("handle", facebook::thrift::protocol::T_STRUCT, 1);
+  xfer += (*(this->handle)).write(oprot);
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldBegin("offset", facebook::thrift::protocol::T_I64, -1);
+  xfer += oprot->writeI64((*(this->offset)));
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldBegin("size", facebook::thrift::protocol::T_I32, -2);
+  xfer += oprot->writeI32((*(this->size)));
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldBegin("chunkSize", facebook::thrift::protocol::T_I32, -3);
+  xfer += oprot->writeI32((*(this->chunkSize)));
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_readChunks_result::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            this->success.clear();
+            uint32_t _size34;
+            facebook::thrift::protocol::TType _etype37;
+            iprot->readListBegin(_etype37, _size34);
+            this->success.resize(_size34);
+            uint32_t _i38;
+            for (_i38 = 0; _i38 < _size34; ++_i38)
+            {
+              xfer += iprot->readString(this->success[_i38]);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->ouch.read(iprot);
+          this->__isset.ouch = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_readChunks_result::write(facebook::thrift::protocol::TProtocol* oprot) const {
+
+  uint32_t xfer = 0;
+
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_readChunks_result");
+
+  if (this->__isset.success) {
+    xfer += oprot->writeFieldBegin("success", facebook::thrift::protocol::T_LIST, 0);
+    {
+      xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRING, this->success.size());
+      std::vector<std::string> ::const_iterator _iter39;
+      for (_iter39 = this->success.begin(); _iter39 != this->success.end(); ++_iter39)
+      {
+        xfer += oprot->writeString((*_iter39));
+      }
+      xfer += oprot->writeListEnd();
+    }
+    xfer += oprot->writeFieldEnd();
+  } else if (this->__isset.ouch) {
+    xfer += oprot->writeFieldBegin("ouch", facebook::thrift::protocol::T_STRUCT, 1);
+    xfer += this->ouch.write(oprot);
+    xfer += oprot->writeFieldEnd();
+  }
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_readChunks_presult::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            (*(this->success)).clear();
+            uint32_t _size40;
+            facebook::thrift::protocol::TType _etype43;
+            iprot->readListBegin(_etype43, _size40);
+            (*(this->success)).resize(_size40);
+            uint32_t _i44;
+            for (_i44 = 0; _i44 < _size40; ++_i44)
+            {
+              xfer += iprot->readString((*(this->success))[_i44]);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->ouch.read(iprot);
+          this->__isset.ouch = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
 uint32_t ThriftHadoopFileSystem_close_args::read(facebook::thrift::protocol::TProtocol* iprot) {
 
   uint32_t xfer = 0;
@@ -2557,7 +2809,7 @@ uint32_t ThriftHadoopFileSystem_stat_presult::read(facebook::thrift::protocol::T
   return xfer;
 }
 
-uint32_t ThriftHadoopFileSystem_listStatus_args::read(facebook::thrift::protocol::TProtocol* iprot) {
+uint32_t ThriftHadoopFileSystem_statMulti_args::read(facebook::thrift::protocol::TProtocol* iprot) {
 
   uint32_t xfer = 0;
   std::string fname;
@@ -2578,9 +2830,21 @@ uint32_t ThriftHadoopFileSystem_listStatus_args::read(facebook::thrift::protocol
     switch (fid)
     {
       case 1:
-        if (ftype == facebook::thrift::protocol::T_STRUCT) {
-          xfer += this->path.read(iprot);
-          this->__isset.path = true;
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            this->paths.clear();
+            uint32_t _size45;
+            facebook::thrift::protocol::TType _etype48;
+            iprot->readListBegin(_etype48, _size45);
+            this->paths.resize(_size45);
+            uint32_t _i49;
+            for (_i49 = 0; _i49 < _size45; ++_i49)
+            {
+              xfer += this->paths[_i49].read(iprot);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.paths = true;
         } else {
           xfer += iprot->skip(ftype);
         }
@@ -2597,29 +2861,45 @@ uint32_t ThriftHadoopFileSystem_listStatus_args::read(facebook::thrift::protocol
   return xfer;
 }
 
-uint32_t ThriftHadoopFileSystem_listStatus_args::write(facebook::thrift::protocol::TProtocol* oprot) const {
+uint32_t ThriftHadoopFileSystem_statMulti_args::write(facebook::thrift::protocol::TProtocol* oprot) const {
   uint32_t xfer = 0;
-  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatus_args");
-  xfer += oprot->writeFieldBegin("path", facebook::thrift::protocol::T_STRUCT, 1);
-  xfer += this->path.write(oprot);
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_statMulti_args");
+  xfer += oprot->writeFieldBegin("paths", facebook::thrift::protocol::T_LIST, 1);
+  {
+    xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, this->paths.size());
+    std::vector<Pathname> ::const_iterator _iter50;
+    for (_iter50 = this->paths.begin(); _iter50 != this->paths.end(); ++_iter50)
+    {
+      xfer += (*_iter50).write(oprot);
+    }
+    xfer += oprot->writeListEnd();
+  }
   xfer += oprot->writeFieldEnd();
   xfer += oprot->writeFieldStop();
   xfer += oprot->writeStructEnd();
   return xfer;
 }
 
-uint32_t ThriftHadoopFileSystem_listStatus_pargs::write(facebook::thrift::protocol::TProtocol* oprot) const {
+uint32_t ThriftHadoopFileSystem_statMulti_pargs::write(facebook::thrift::protocol::TProtocol* oprot) const {
   uint32_t xfer = 0;
-  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatus_pargs");
-  xfer += oprot->writeFieldBegin("path", facebook::thrift::protocol::T_STRUCT, 1);
-  xfer += (*(this->path)).write(oprot);
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_statMulti_pargs");
+  xfer += oprot->writeFieldBegin("paths", facebook::thrift::protocol::T_LIST, 1);
+  {
+    xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, (*(this->paths)).size());
+    std::vector<Pathname> ::const_iterator _iter51;
+    for (_iter51 = (*(this->paths)).begin(); _iter51 != (*(this->paths)).end(); ++_iter51)
+    {
+      xfer += (*_iter51).write(oprot);
+    }
+    xfer += oprot->writeListEnd();
+  }
   xfer += oprot->writeFieldEnd();
   xfer += oprot->writeFieldStop();
   xfer += oprot->writeStructEnd();
   return xfer;
 }
 
-uint32_t ThriftHadoopFileSystem_listStatus_result::read(facebook::thrift::protocol::TProtocol* iprot) {
+uint32_t ThriftHadoopFileSystem_statMulti_result::read(facebook::thrift::protocol::TProtocol* iprot) {
 
   uint32_t xfer = 0;
   std::string fname;
@@ -2643,14 +2923,474 @@ uint32_t ThriftHadoopFileSystem_listStatus_result::read(facebook::thrift::protoc
         if (ftype == facebook::thrift::protocol::T_LIST) {
           {
             this->success.clear();
-            uint32_t _size12;
-            facebook::thrift::protocol::TType _etype15;
-            iprot->readListBegin(_etype15, _size12);
-            this->success.resize(_size12);
-            uint32_t _i16;
-            for (_i16 = 0; _i16 < _size12; ++_i16)
+            uint32_t _size52;
+            facebook::thrift::protocol::TType _etype55;
+            iprot->readListBegin(_etype55, _size52);
+            this->success.resize(_size52);
+            uint32_t _i56;
+            for (_i56 = 0; _i56 < _size52; ++_i56)
+            {
+              xfer += this->success[_i56].read(iprot);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->ouch.read(iprot);
+          this->__isset.ouch = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_statMulti_result::write(facebook::thrift::protocol::TProtocol* oprot) const {
+
+  uint32_t xfer = 0;
+
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_statMulti_result");
+
+  if (this->__isset.success) {
+    xfer += oprot->writeFieldBegin("success", facebook::thrift::protocol::T_LIST, 0);
+    {
+      xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, this->success.size());
+      std::vector<FileStatus> ::const_iterator _iter57;
+      for (_iter57 = this->success.begin(); _iter57 != this->success.end(); ++_iter57)
+      {
+        xfer += (*_iter57).write(oprot);
+      }
+      xfer += oprot->writeListEnd();
+    }
+    xfer += oprot->writeFieldEnd();
+  } else if (this->__isset.ouch) {
+    xfer += oprot->writeFieldBegin("ouch", facebook::thrift::protocol::T_STRUCT, 1);
+    xfer += this->ouch.write(oprot);
+    xfer += oprot->writeFieldEnd();
+  }
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_statMulti_presult::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            (*(this->success)).clear();
+            uint32_t _size58;
+            facebook::thrift::protocol::TType _etype61;
+            iprot->readListBegin(_etype61, _size58);
+            (*(this->success)).resize(_size58);
+            uint32_t _i62;
+            for (_i62 = 0; _i62 < _size58; ++_i62)
+            {
+              xfer += (*(this->success))[_i62].read(iprot);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->ouch.read(iprot);
+          this->__isset.ouch = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatus_args::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->path.read(iprot);
+          this->__isset.path = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatus_args::write(facebook::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatus_args");
+  xfer += oprot->writeFieldBegin("path", facebook::thrift::protocol::T_STRUCT, 1);
+  xfer += this->path.write(oprot);
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatus_pargs::write(facebook::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatus_pargs");
+  xfer += oprot->writeFieldBegin("path", facebook::thrift::protocol::T_STRUCT, 1);
+  xfer += (*(this->path)).write(oprot);
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatus_result::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            this->success.clear();
+            uint32_t _size12;
+            facebook::thrift::protocol::TType _etype15;
+            iprot->readListBegin(_etype15, _size12);
+            this->success.resize(_size12);
+            uint32_t _i16;
+            for (_i16 = 0; _i16 < _size12; ++_i16)
+            {
+              xfer += this->success[_i16].read(iprot);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->ouch.read(iprot);
+          this->__isset.ouch = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatus_result::write(facebook::thrift::protocol::TProtocol* oprot) const {
+
+  uint32_t xfer = 0;
+
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatus_result");
+
+  if (this->__isset.success) {
+    xfer += oprot->writeFieldBegin("success", facebook::thrift::protocol::T_LIST, 0);
+    {
+      xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, this->success.size());
+      std::vector<FileStatus> ::const_iterator _iter17;
+      for (_iter17 = this->success.begin(); _iter17 != this->success.end(); ++_iter17)
+      {
+        xfer += (*_iter17).write(oprot);
+      }
+      xfer += oprot->writeListEnd();
+    }
+    xfer += oprot->writeFieldEnd();
+  } else if (this->__isset.ouch) {
+    xfer += oprot->writeFieldBegin("ouch", facebook::thrift::protocol::T_STRUCT, 1);
+    xfer += this->ouch.write(oprot);
+    xfer += oprot->writeFieldEnd();
+  }
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatus_presult::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            (*(this->success)).clear();
+            uint32_t _size18;
+            facebook::thrift::protocol::TType _etype21;
+            iprot->readListBegin(_etype21, _size18);
+            (*(this->success)).resize(_size18);
+            uint32_t _i22;
+            for (_i22 = 0; _i22 < _size18; ++_i22)
+            {
+              xfer += (*(this->success))[_i22].read(iprot);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_STRUCT) {
+          xfer += this->ouch.read(iprot);
+          this->__isset.ouch = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatusMulti_args::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 1:
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            this->paths.clear();
+            uint32_t _size63;
+            facebook::thrift::protocol::TType _etype66;
+            iprot->readListBegin(_etype66, _size63);
+            this->paths.resize(_size63);
+            uint32_t _i67;
+            for (_i67 = 0; _i67 < _size63; ++_i67)
+            {
+              xfer += this->paths[_i67].read(iprot);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.paths = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatusMulti_args::write(facebook::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatusMulti_args");
+  xfer += oprot->writeFieldBegin("paths", facebook::thrift::protocol::T_LIST, 1);
+  {
+    xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, this->paths.size());
+    std::vector<Pathname> ::const_iterator _iter68;
+    for (_iter68 = this->paths.begin(); _iter68 != this->paths.end(); ++_iter68)
+    {
+      xfer += (*_iter68).write(oprot);
+    }
+    xfer += oprot->writeListEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatusMulti_pargs::write(facebook::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatusMulti_pargs");
+  xfer += oprot->writeFieldBegin("paths", facebook::thrift::protocol::T_LIST, 1);
+  {
+    xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, (*(this->paths)).size());
+    std::vector<Pathname> ::const_iterator _iter69;
+    for (_iter69 = (*(this->paths)).begin(); _iter69 != (*(this->paths)).end(); ++_iter69)
+    {
+      xfer += (*_iter69).write(oprot);
+    }
+    xfer += oprot->writeListEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+uint32_t ThriftHadoopFileSystem_listStatusMulti_result::read(facebook::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  facebook::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using facebook::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == facebook::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == facebook::thrift::protocol::T_LIST) {
+          {
+            this->success.clear();
+            uint32_t _size70;
+            facebook::thrift::protocol::TType _etype73;
+            iprot->readListBegin(_etype73, _size70);
+            this->success.resize(_size70);
+            uint32_t _i74;
+            for (_i74 = 0; _i74 < _size70; ++_i74)
             {
-              xfer += this->success[_i16].read(iprot);
+              {
+                this->success[_i74].clear();
+                uint32_t _size75;
+                facebook::thrift::protocol::TType _etype78;
+                iprot->readListBegin(_etype78, _size75);
+                this->success[_i74].resize(_size75);
+                uint32_t _i79;
+                for (_i79 = 0; _i79 < _size75; ++_i79)
+                {
+                  xfer += this->success[_i74][_i79].read(iprot);
+                }
+                iprot->readListEnd();
+              }
             }
             iprot->readListEnd();
           }
@@ -2679,20 +3419,28 @@ uint32_t ThriftHadoopFileSystem_listStatus_result::read(facebook::thrift::protoc
   return xfer;
 }
 
-uint32_t ThriftHadoopFileSystem_listStatus_result::write(facebook::thrift::protocol::TProtocol* oprot) const {
+uint32_t ThriftHadoopFileSystem_listStatusMulti_result::write(facebook::thrift::protocol::TProtocol* oprot) const {
 
   uint32_t xfer = 0;
 
-  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatus_result");
+  xfer += oprot->writeStructBegin("ThriftHadoopFileSystem_listStatusMulti_result");
 
   if (this->__isset.success) {
     xfer += oprot->writeFieldBegin("success", facebook::thrift::protocol::T_LIST, 0);
     {
-      xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, this->success.size());
-      std::vector<FileStatus> ::const_iterator _iter17;
-      for (_iter17 = this->success.begin(); _iter17 != this->success.end(); ++_iter17)
+      xfer += oprot->writeListBegin(facebook::thrift::protocol::T_LIST, this->success.size());
+      std::vector<std::vector<FileStatus> > ::const_iterator _iter80;
+      for (_iter80 = this->success.begin(); _iter80 != this->success.end(); ++_iter80)
       {
-        xfer += (*_iter17).write(oprot);
+        {
+          xfer += oprot->writeListBegin(facebook::thrift::protocol::T_STRUCT, (*_iter80).size());
+          std::vector<FileStatus> ::const_iterator _iter81;
+          for (_iter81 = (*_iter80).begin(); _iter81 != (*_iter80).end(); ++_iter81)
+          {
+            xfer += (*_iter81).write(oprot);
+          }
+          xfer += oprot->writeListEnd();
+        }
       }
       xfer += oprot->writeListEnd();
     }
@@ -2707,7 +3455,7 @@ uint32_t ThriftHadoopFileSystem_listStatus_result::write(facebook::thrift::proto
   return xfer;
 }
 
-uint32_t ThriftHadoopFileSystem_listStatus_presult::read(facebook::thrift::protocol::TProtocol* iprot) {
+uint32_t ThriftHadoopFileSystem_listStatusMulti_presult::read(facebook::thrift::protocol::TProtocol* iprot) {
 
   uint32_t xfer = 0;
   std::string fname;
@@ -2731,14 +3479,26 @@ uint32_t ThriftHadoopFileSystem_listStatus_presult::read(facebook::thrift::proto
         if (ftype == facebook::thrift::protocol::T_LIST) {
           {
             (*(this->success)).clear();
-            uint32_t _size18;
-            facebook::thrift::protocol::TType _etype21;
-            iprot->readListBegin(_etype21, _size18);
-            (*(this->success)).resize(_size18);
-            uint32_t _i22;
-            for (_i22 = 0; _i22 < _size18; ++_i22)
+            uint32_t _size82;
+            facebook::thrift::protocol::TType _etype85;
+            iprot->readListBegin(_etype85, _size82);
+            (*(this->success)).resize(_size82);
+            uint32_t _i86;
+            for (_i86 = 0; _i86 < _size82; ++_i86)
             {
-              xfer += (*(this->success))[_i22].read(iprot);
+              {
+                (*(this->success))[_i86].clear();
+                uint32_t _size87;
+                facebook::thrift::protocol::TType _etype90;
+                iprot->readListBegin(_etype90, _size87);
+                (*(this->success))[_i86].resize(_size87);
+                uint32_t _i91;
+                for (_i91 = 0; _i91 < _size87; ++_i91)
+                {
+                  xfer += (*(this->success))[_i86][_i91].read(iprot);
+                }
+                iprot->readListEnd();
+              }
             }
             iprot->readListEnd();
           }
@@ -4031,6 +4791,72 @@ void ThriftHadoopFileSystemClient::recv_read(std::string& _return)
   throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::MISSING_RESULT, "read failed: unknown result");
 }
 
+void ThriftHadoopFileSystemClient::readChunks(std::vector<std::string> & _return, const ThriftHandle& handle, const int64_t offset, const int32_t size, const int32_t chunkSize)
+{
+  send_readChunks(handle, offset, size, chunkSize);
+  recv_readChunks(_return);
+}
+
+void ThriftHadoopFileSystemClient::send_readChunks(const ThriftHandle& handle, const int64_t offset, const int32_t size, const int32_t chunkSize)
+{
+  int32_t cseqid = 0;
+  oprot_->writeMessageBegin("readChunks", facebook::thrift::protocol::T_CALL, cseqid);
+
+  ThriftHadoopFileSystem_readChunks_pargs args;
+  args.handle = &handle;
+  args.offset = &offset;
+  args.size = &size;
+  args.chunkSize = &chunkSize;
+  args.write(oprot_);
+
+  oprot_->writeMessageEnd();
+  oprot_->getTransport()->flush();
+  oprot_->getTransport()->writeEnd();
+}
+
+void ThriftHadoopFileSystemClient::recv_readChunks(std::vector<std::string> & _return)
+{
+
+  int32_t rseqid = 0;
+  std::string fname;
+  facebook::thrift::protocol::TMessageType mtype;
+
+  iprot_->readMessageBegin(fname, mtype, rseqid);
+  if (mtype == facebook::thrift::protocol::T_EXCEPTION) {
+    facebook::thrift::TApplicationException x;
+    x.read(iprot_);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw x;
+  }
+  if (mtype != facebook::thrift::protocol::T_REPLY) {
+    iprot_->skip(facebook::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::INVALID_MESSAGE_TYPE);
+  }
+  if (fname.compare("readChunks") != 0) {
+    iprot_->skip(facebook::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::WRONG_METHOD_NAME);
+  }
+  ThriftHadoopFileSystem_readChunks_presult result;
+  result.success = &_return;
+  result.read(iprot_);
+  iprot_->readMessageEnd();
+  iprot_->getTransport()->readEnd();
+
+  if (result.__isset.success) {
+    // _return pointer has now been filled
+    return;
+  }
+  if (result.__isset.ouch) {
+    throw result.ouch;
+  }
+  throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::MISSING_RESULT, "readChunks failed: unknown result");
+}
+
 bool ThriftHadoopFileSystemClient::close(const ThriftHandle& out)
 {
   send_close(out);
@@ -4411,6 +5237,69 @@ void ThriftHadoopFileSystemClient::recv_stat(FileStatus& _return)
   throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::MISSING_RESULT, "stat failed: unknown result");
 }
 
+void ThriftHadoopFileSystemClient::statMulti(std::vector<FileStatus> & _return, const std::vector<Pathname> & paths)
+{
+  send_statMulti(paths);
+  recv_statMulti(_return);
+}
+
+void ThriftHadoopFileSystemClient::send_statMulti(const std::vector<Pathname> & paths)
+{
+  int32_t cseqid = 0;
+  oprot_->writeMessageBegin("statMulti", facebook::thrift::protocol::T_CALL, cseqid);
+
+  ThriftHadoopFileSystem_statMulti_pargs args;
+  args.paths = &paths;
+  args.write(oprot_);
+
+  oprot_->writeMessageEnd();
+  oprot_->getTransport()->flush();
+  oprot_->getTransport()->writeEnd();
+}
+
+void ThriftHadoopFileSystemClient::recv_statMulti(std::vector<FileStatus> & _return)
+{
+
+  int32_t rseqid = 0;
+  std::string fname;
+  facebook::thrift::protocol::TMessageType mtype;
+
+  iprot_->readMessageBegin(fname, mtype, rseqid);
+  if (mtype == facebook::thrift::protocol::T_EXCEPTION) {
+    facebook::thrift::TApplicationException x;
+    x.read(iprot_);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw x;
+  }
+  if (mtype != facebook::thrift::protocol::T_REPLY) {
+    iprot_->skip(facebook::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::INVALID_MESSAGE_TYPE);
+  }
+  if (fname.compare("statMulti") != 0) {
+    iprot_->skip(facebook::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::WRONG_METHOD_NAME);
+  }
+  ThriftHadoopFileSystem_statMulti_presult result;
+  result.success = &_return;
+  result.read(iprot_);
+  iprot_->readMessageEnd();
+  iprot_->getTransport()->readEnd();
+
+  if (result.__isset.success) {
+    // _return pointer has now been filled
+    return;
+  }
+  if (result.__isset.ouch) {
+    throw result.ouch;
+  }
+  throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::MISSING_RESULT, "statMulti failed: unknown result");
+}
+
 void ThriftHadoopFileSystemClient::listStatus(std::vector<FileStatus> & _return, const Pathname& path)
 {
   send_listStatus(path);
@@ -4474,6 +5363,69 @@ void ThriftHadoopFileSystemClient::recv_listStatus(std::vector<FileStatus> & _re
   throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::MISSING_RESULT, "listStatus failed: unknown result");
 }
 
+void ThriftHadoopFileSystemClient::listStatusMulti(std::vector<std::vector<FileStatus> > & _return, const std::vector<Pathname> & paths)
+{
+  send_listStatusMulti(paths);
+  recv_listStatusMulti(_return);
+}
+
+void ThriftHadoopFileSystemClient::send_listStatusMulti(const std::vector<Pathname> & paths)
+{
+  int32_t cseqid = 0;
+  oprot_->writeMessageBegin("listStatusMulti", facebook::thrift::protocol::T_CALL, cseqid);
+
+  ThriftHadoopFileSystem_listStatusMulti_pargs args;
+  args.paths = &paths;
+  args.write(oprot_);
+
+  oprot_->writeMessageEnd();
+  oprot_->getTransport()->flush();
+  oprot_->getTransport()->writeEnd();
+}
+
+void ThriftHadoopFileSystemClient::recv_listStatusMulti(std::vector<std::vector<FileStatus> > & _return)
+{
+
+  int32_t rseqid = 0;
+  std::string fname;
+  facebook::thrift::protocol::TMessageType mtype;
+
+  iprot_->readMessageBegin(fname, mtype, rseqid);
+  if (mtype == facebook::thrift::protocol::T_EXCEPTION) {
+    facebook::thrift::TApplicationException x;
+    x.read(iprot_);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw x;
+  }
+  if (mtype != facebook::thrift::protocol::T_REPLY) {
+    iprot_->skip(facebook::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::INVALID_MESSAGE_TYPE);
+  }
+  if (fname.compare("listStatusMulti") != 0) {
+    iprot_->skip(facebook::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::WRONG_METHOD_NAME);
+  }
+  ThriftHadoopFileSystem_listStatusMulti_presult result;
+  result.success = &_return;
+  result.read(iprot_);
+  iprot_->readMessageEnd();
+  iprot_->getTransport()->readEnd();
+
+  if (result.__isset.success) {
+    // _return pointer has now been filled
+    return;
+  }
+  if (result.__isset.ouch) {
+    throw result.ouch;
+  }
+  throw facebook::thrift::TApplicationException(facebook::thrift::TApplicationException::MISSING_RESULT, "listStatusMulti failed: unknown result");
+}
+
 void ThriftHadoopFileSystemClient::chmod(const Pathname& path, const int16_t mode)
 {
   send_chmod(path, mode);
@@ -5002,6 +5954,37 @@ void ThriftHadoopFileSystemProcessor::process_read(int32_t seqid, facebook::thri
   oprot->getTransport()->writeEnd();
 }
 
+void ThriftHadoopFileSystemProcessor::process_readChunks(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot)
+{
+  ThriftHadoopFileSystem_readChunks_args args;
+  args.read(iprot);
+  iprot->readMessageEnd();
+  iprot->getTransport()->readEnd();
+
+  ThriftHadoopFileSystem_readChunks_result result;
+  try {
+    iface_->readChunks(result.success, args.handle, args.offset, args.size, args.chunkSize);
+    result.__isset.success = true;
+  } catch (ThriftIOException &ouch) {
+    result.ouch = ouch;
+    result.__isset.ouch = true;
+  } catch (const std::exception& e) {
+    facebook::thrift::TApplicationException x(e.what());
+    oprot->writeMessageBegin("readChunks", facebook::thrift::protocol::T_EXCEPTION, seqid);
+    x.write(oprot);
+    oprot->writeMessageEnd();
+    oprot->getTransport()->flush();
+    oprot->getTransport()->writeEnd();
+    return;
+  }
+
+  oprot->writeMessageBegin("readChunks", facebook::thrift::protocol::T_REPLY, seqid);
+  result.write(oprot);
+  oprot->writeMessageEnd();
+  oprot->getTransport()->flush();
+  oprot->getTransport()->writeEnd();
+}
+
 void ThriftHadoopFileSystemProcessor::process_close(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot)
 {
   ThriftHadoopFileSystem_close_args args;
@@ -5188,6 +6171,37 @@ void ThriftHadoopFileSystemProcessor::process_stat(int32_t seqid, facebook::thri
   oprot->getTransport()->writeEnd();
 }
 
+void ThriftHadoopFileSystemProcessor::process_statMulti(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot)
+{
+  ThriftHadoopFileSystem_statMulti_args args;
+  args.read(iprot);
+  iprot->readMessageEnd();
+  iprot->getTransport()->readEnd();
+
+  ThriftHadoopFileSystem_statMulti_result result;
+  try {
+    iface_->statMulti(result.success, args.paths);
+    result.__isset.success = true;
+  } catch (ThriftIOException &ouch) {
+    result.ouch = ouch;
+    result.__isset.ouch = true;
+  } catch (const std::exception& e) {
+    facebook::thrift::TApplicationException x(e.what());
+    oprot->writeMessageBegin("statMulti", facebook::thrift::protocol::T_EXCEPTION, seqid);
+    x.write(oprot);
+    oprot->writeMessageEnd();
+    oprot->getTransport()->flush();
+    oprot->getTransport()->writeEnd();
+    return;
+  }
+
+  oprot->writeMessageBegin("statMulti", facebook::thrift::protocol::T_REPLY, seqid);
+  result.write(oprot);
+  oprot->writeMessageEnd();
+  oprot->getTransport()->flush();
+  oprot->getTransport()->writeEnd();
+}
+
 void ThriftHadoopFileSystemProcessor::process_listStatus(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot)
 {
   ThriftHadoopFileSystem_listStatus_args args;
@@ -5219,6 +6233,37 @@ void ThriftHadoopFileSystemProcessor::process_listStatus(int32_t seqid, facebook
   oprot->getTransport()->writeEnd();
 }
 
+void ThriftHadoopFileSystemProcessor::process_listStatusMulti(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot)
+{
+  ThriftHadoopFileSystem_listStatusMulti_args args;
+  args.read(iprot);
+  iprot->readMessageEnd();
+  iprot->getTransport()->readEnd();
+
+  ThriftHadoopFileSystem_listStatusMulti_result result;
+  try {
+    iface_->listStatusMulti(result.success, args.paths);
+    result.__isset.success = true;
+  } catch (ThriftIOException &ouch) {
+    result.ouch = ouch;
+    result.__isset.ouch = true;
+  } catch (const std::exception& e) {
+    facebook::thrift::TApplicationException x(e.what());
+    oprot->writeMessageBegin("listStatusMulti", facebook::thrift::protocol::T_EXCEPTION, seqid);
+    x.write(oprot);
+    oprot->writeMessageEnd();
+    oprot->getTransport()->flush();
+    oprot->getTransport()->writeEnd();
+    return;
+  }
+
+  oprot->writeMessageBegin("listStatusMulti", facebook::thrift::protocol::T_REPLY, seqid);
+  result.write(oprot);
+  oprot->writeMessageEnd();
+  oprot->getTransport()->flush();
+  oprot->getTransport()->writeEnd();
+}
+
 void ThriftHadoopFileSystemProcessor::process_chmod(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot)
 {
   ThriftHadoopFileSystem_chmod_args args;
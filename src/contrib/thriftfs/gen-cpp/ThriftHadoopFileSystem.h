@@ -22,13 +22,16 @@ class ThriftHadoopFileSystemIf {
   virtual void append(ThriftHandle& _return, const Pathname& path) = 0;
   virtual bool write(const ThriftHandle& handle, const std::string& data) = 0;
   virtual void read(std::string& _return, const ThriftHandle& handle, const int64_t offset, const int32_t size) = 0;
+  virtual void readChunks(std::vector<std::string> & _return, const ThriftHandle& handle, const int64_t offset, const int32_t size, const int32_t chunkSize) = 0;
   virtual bool close(const ThriftHandle& out) = 0;
   virtual bool rm(const Pathname& path, const bool recursive) = 0;
   virtual bool rename(const Pathname& path, const Pathname& dest) = 0;
   virtual bool mkdirs(const Pathname& path) = 0;
   virtual bool exists(const Pathname& path) = 0;
   virtual void stat(FileStatus& _return, const Pathname& path) = 0;
+  virtual void statMulti(std::vector<FileStatus> & _return, const std::vector<Pathname> & paths) = 0;
   virtual void listStatus(std::vector<FileStatus> & _return, const Pathname& path) = 0;
+  virtual void listStatusMulti(std::vector<std::vector<FileStatus> > & _return, const std::vector<Pathname> & paths) = 0;
   virtual void chmod(const Pathname& path, const int16_t mode) = 0;
   virtual void chown(const Pathname& path, const std::string& owner, const std::string& group) = 0;
   virtual void setReplication(const Pathname& path, const int16_t replication) = 0;
@@ -63,6 +66,9 @@ class ThriftHadoopFileSystemNull : virtual public ThriftHadoopFileSystemIf {
   void read(std::string& /* _return */, const ThriftHandle& /* handle */, const int64_t /* offset */, const int32_t /* size */) {
     return;
   }
+  void readChunks(std::vector<std::string> & /* _return */, const ThriftHandle& /* handle */, const int64_t /* offset */, const int32_t /* size */, const int32_t /* chunkSize */) {
+    return;
+  }
   bool close(const ThriftHandle& /* out */) {
     bool _return = false;
     return _return;
@@ -86,9 +92,15 @@ class ThriftHadoopFileSystemNull : virtual public ThriftHadoopFileSystemIf {
   void stat(FileStatus& /* _return */, const Pathname& /* path */) {
     return;
   }
+  void statMulti(std::vector<FileStatus> & /* _return */, const std::vector<Pathname> & /* paths */) {
+    return;
+  }
   void listStatus(std::vector<FileStatus> & /* _return */, const Pathname& /* path */) {
     return;
   }
+  void listStatusMulti(std::vector<std::vector<FileStatus> > & /* _return */, const std::vector<Pathname> & /* paths */) {
+    return;
+  }
   void chmod(const Pathname& /* path */, const int16_t /* mode */) {
     return;
   }
@@ -895,6 +907,120 @@ class ThriftHadoopFileSystem_read_presult {
 
 };
 
+class ThriftHadoopFileSystem_readChunks_args {
+ public:
+
+  ThriftHadoopFileSystem_readChunks_args() : offset(0), size(0), chunkSize(0) {
+  }
+
+  virtual ~ThriftHadoopFileSystem_readChunks_args() throw() {}
+
+  ThriftHandle handle;
+  int64_t offset;
+  int32_t size;
+  int32_t chunkSize;
+
+  struct __isset {
+    __isset() : handle(false), offset(false), size(false), chunkSize(false) {}
+    bool handle;
+    bool offset;
+    bool size;
+    bool chunkSize;
+  } __isset;
+
+  bool operator == (const ThriftHadoopFileSystem_readChunks_args & rhs) const
+  {
+    if (!(handle == rhs.handle))
+      return false;
+    if (!(offset == rhs.offset))
+      return false;
+    if (!(size == rhs.size))
+      return false;
+    if (!(chunkSize == rhs.chunkSize))
+      return false;
+    return true;
+  }
+  bool operator != (const ThriftHadoopFileSystem_readChunks_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ThriftHadoopFileSystem_readChunks_args & ) const;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_readChunks_pargs {
+ public:
+
+
+  virtual ~ThriftHadoopFileSystem_readChunks_pargs() throw() {}
+
+  const ThriftHandle* handle;
+  const int64_t* offset;
+  const int32_t* size;
+  const int32_t* chunkSize;
+
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_readChunks_result {
+ public:
+
+  ThriftHadoopFileSystem_readChunks_result() {
+  }
+
+  virtual ~ThriftHadoopFileSystem_readChunks_result() throw() {}
+
+  std::vector<std::string>  success;
+  ThriftIOException ouch;
+
+  struct __isset {
+    __isset() : success(false), ouch(false) {}
+    bool success;
+    bool ouch;
+  } __isset;
+
+  bool operator == (const ThriftHadoopFileSystem_readChunks_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    if (!(ouch == rhs.ouch))
+      return false;
+    return true;
+  }
+  bool operator != (const ThriftHadoopFileSystem_readChunks_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ThriftHadoopFileSystem_readChunks_result & ) const;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_readChunks_presult {
+ public:
+
+
+  virtual ~ThriftHadoopFileSystem_readChunks_presult() throw() {}
+
+  std::vector<std::string> * success;
+  ThriftIOException ouch;
+
+  struct __isset {
+    __isset() : success(false), ouch(false) {}
+    bool success;
+    bool ouch;
+  } __isset;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+
+};
+
 class ThriftHadoopFileSystem_close_args {
  public:
 
@@ -1499,6 +1625,105 @@ class ThriftHadoopFileSystem_stat_presult {
 
 };
 
+class ThriftHadoopFileSystem_statMulti_args {
+ public:
+
+  ThriftHadoopFileSystem_statMulti_args() {
+  }
+
+  virtual ~ThriftHadoopFileSystem_statMulti_args() throw() {}
+
+  std::vector<Pathname>  paths;
+
+  struct __isset {
+    __isset() : paths(false) {}
+    bool paths;
+  } __isset;
+
+  bool operator == (const ThriftHadoopFileSystem_statMulti_args & rhs) const
+  {
+    if (!(paths == rhs.paths))
+      return false;
+    return true;
+  }
+  bool operator != (const ThriftHadoopFileSystem_statMulti_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ThriftHadoopFileSystem_statMulti_args & ) const;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_statMulti_pargs {
+ public:
+
+
+  virtual ~ThriftHadoopFileSystem_statMulti_pargs() throw() {}
+
+  const std::vector<Pathname> * paths;
+
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_statMulti_result {
+ public:
+
+  ThriftHadoopFileSystem_statMulti_result() {
+  }
+
+  virtual ~ThriftHadoopFileSystem_statMulti_result() throw() {}
+
+  std::vector<FileStatus>  success;
+  ThriftIOException ouch;
+
+  struct __isset {
+    __isset() : success(false), ouch(false) {}
+    bool success;
+    bool ouch;
+  } __isset;
+
+  bool operator == (const ThriftHadoopFileSystem_statMulti_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    if (!(ouch == rhs.ouch))
+      return false;
+    return true;
+  }
+  bool operator != (const ThriftHadoopFileSystem_statMulti_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ThriftHadoopFileSystem_statMulti_result & ) const;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_statMulti_presult {
+ public:
+
+
+  virtual ~ThriftHadoopFileSystem_statMulti_presult() throw() {}
+
+  std::vector<FileStatus> * success;
+  ThriftIOException ouch;
+
+  struct __isset {
+    __isset() : success(false), ouch(false) {}
+    bool success;
+    bool ouch;
+  } __isset;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+
+};
+
 class ThriftHadoopFileSystem_listStatus_args {
  public:
 
@@ -1598,6 +1823,105 @@ class ThriftHadoopFileSystem_listStatus_presult {
 
 };
 
+class ThriftHadoopFileSystem_listStatusMulti_args {
+ public:
+
+  ThriftHadoopFileSystem_listStatusMulti_args() {
+  }
+
+  virtual ~ThriftHadoopFileSystem_listStatusMulti_args() throw() {}
+
+  std::vector<Pathname>  paths;
+
+  struct __isset {
+    __isset() : paths(false) {}
+    bool paths;
+  } __isset;
+
+  bool operator == (const ThriftHadoopFileSystem_listStatusMulti_args & rhs) const
+  {
+    if (!(paths == rhs.paths))
+      return false;
+    return true;
+  }
+  bool operator != (const ThriftHadoopFileSystem_listStatusMulti_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ThriftHadoopFileSystem_listStatusMulti_args & ) const;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_listStatusMulti_pargs {
+ public:
+
+
+  virtual ~ThriftHadoopFileSystem_listStatusMulti_pargs() throw() {}
+
+  const std::vector<Pathname> * paths;
+
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_listStatusMulti_result {
+ public:
+
+  ThriftHadoopFileSystem_listStatusMulti_result() {
+  }
+
+  virtual ~ThriftHadoopFileSystem_listStatusMulti_result() throw() {}
+
+  std::vector<std::vector<FileStatus> >  success;
+  ThriftIOException ouch;
+
+  struct __isset {
+    __isset() : success(false), ouch(false) {}
+    bool success;
+    bool ouch;
+  } __isset;
+
+  bool operator == (const ThriftHadoopFileSystem_listStatusMulti_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    if (!(ouch == rhs.ouch))
+      return false;
+    return true;
+  }
+  bool operator != (const ThriftHadoopFileSystem_listStatusMulti_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ThriftHadoopFileSystem_listStatusMulti_result & ) const;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+  uint32_t write(facebook::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+class ThriftHadoopFileSystem_listStatusMulti_presult {
+ public:
+
+
+  virtual ~ThriftHadoopFileSystem_listStatusMulti_presult() throw() {}
+
+  std::vector<std::vector<FileStatus> > * success;
+  ThriftIOException ouch;
+
+  struct __isset {
+    __isset() : success(false), ouch(false) {}
+    bool success;
+    bool ouch;
+  } __isset;
+
+  uint32_t read(facebook::thrift::protocol::TProtocol* iprot);
+
+};
+
 class ThriftHadoopFileSystem_chmod_args {
  public:
 
@@ -2050,6 +2374,9 @@ class ThriftHadoopFileSystemClient : virtual public ThriftHadoopFileSystemIf {
   void read(std::string& _return, const ThriftHandle& handle, const int64_t offset, const int32_t size);
   void send_read(const ThriftHandle& handle, const int64_t offset, const int32_t size);
   void recv_read(std::string& _return);
+  void readChunks(std::vector<std::string> & _return, const ThriftHandle& handle, const int64_t offset, const int32_t size, const int32_t chunkSize);
+  void send_readChunks(const ThriftHandle& handle, const int64_t offset, const int32_t size, const int32_t chunkSize);
+  void recv_readChunks(std::vector<std::string> & _return);
   bool close(const ThriftHandle& out);
   void send_close(const ThriftHandle& out);
   bool recv_close();
@@ -2068,9 +2395,15 @@ class ThriftHadoopFileSystemClient : virtual public ThriftHadoopFileSystemIf {
   void stat(FileStatus& _return, const Pathname& path);
   void send_stat(const Pathname& path);
   void recv_stat(FileStatus& _return);
+  void statMulti(std::vector<FileStatus> & _return, const std::vector<Pathname> & paths);
+  void send_statMulti(const std::vector<Pathname> & paths);
+  void recv_statMulti(std::vector<FileStatus> & _return);
   void listStatus(std::vector<FileStatus> & _return, const Pathname& path);
   void send_listStatus(const Pathname& path);
   void recv_listStatus(std::vector<FileStatus> & _return);
+  void listStatusMulti(std::vector<std::vector<FileStatus> > & _return, const std::vector<Pathname> & paths);
+  void send_listStatusMulti(const std::vector<Pathname> & paths);
+  void recv_listStatusMulti(std::vector<std::vector<FileStatus> > & _return);
   void chmod(const Pathname& path, const int16_t mode);
   void send_chmod(const Pathname& path, const int16_t mode);
   void recv_chmod();
@@ -2104,13 +2437,16 @@ class ThriftHadoopFileSystemProcessor : virtual public facebook::thrift::TProces
   void process_append(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_write(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_read(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
+  void process_readChunks(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_close(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_rm(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_rename(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_mkdirs(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_exists(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_stat(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
+  void process_statMulti(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_listStatus(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
+  void process_listStatusMulti(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_chmod(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_chown(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
   void process_setReplication(int32_t seqid, facebook::thrift::protocol::TProtocol* iprot, facebook::thrift::protocol::TProtocol* oprot);
@@ -2126,13 +2462,16 @@ class ThriftHadoopFileSystemProcessor : virtual public facebook::thrift::TProces
     processMap_["append"] = &ThriftHadoopFileSystemProcessor::process_append;
     processMap_["write"] = &ThriftHadoopFileSystemProcessor::process_write;
     processMap_["read"] = &ThriftHadoopFileSystemProcessor::process_read;
+    processMap_["readChunks"] = &ThriftHadoopFileSystemProcessor::process_readChunks;
     processMap_["close"] = &ThriftHadoopFileSystemProcessor::process_close;
     processMap_["rm"] = &ThriftHadoopFileSystemProcessor::process_rm;
     processMap_["rename"] = &ThriftHadoopFileSystemProcessor::process_rename;
     processMap_["mkdirs"] = &ThriftHadoopFileSystemProcessor::process_mkdirs;
     processMap_["exists"] = &ThriftHadoopFileSystemProcessor::process_exists;
     processMap_["stat"] = &ThriftHadoopFileSystemProcessor::process_stat;
+    processMap_["statMulti"] = &ThriftHadoopFileSystemProcessor::process_statMulti;
     processMap_["listStatus"] = &ThriftHadoopFileSystemProcessor::process_listStatus;
+    processMap_["listStatusMulti"] = &ThriftHadoopFileSystemProcessor::process_listStatusMulti;
     processMap_["chmod"] = &ThriftHadoopFileSystemProcessor::process_chmod;
     processMap_["chown"] = &ThriftHadoopFileSystemProcessor::process_chown;
     processMap_["setReplication"] = &ThriftHadoopFileSystemProcessor::process_setReplication;
@@ -2240,6 +2579,18 @@ class ThriftHadoopFileSystemMultiface : virtual public ThriftHadoopFileSystemIf
     }
   }
 
+  void readChunks(std::vector<std::string> & _return, const ThriftHandle& handle, const int64_t offset, const int32_t size, const int32_t chunkSize) {
+    uint32_t sz = ifaces_.size();
+    for (uint32_t i = 0; i < sz; ++i) {
+      if (i == sz - 1) {
+        ifaces_[i]->readChunks(_return, handle, offset, size, chunkSize);
+        return;
+      } else {
+        ifaces_[i]->readChunks(_return, handle, offset, size, chunkSize);
+      }
+    }
+  }
+
   bool close(const ThriftHandle& out) {
     uint32_t sz = ifaces_.size();
     for (uint32_t i = 0; i < sz; ++i) {
@@ -2307,6 +2658,18 @@ class ThriftHadoopFileSystemMultiface : virtual public ThriftHadoopFileSystemIf
     }
   }
 
+  void statMulti(std::vector<FileStatus> & _return, const std::vector<Pathname> & paths) {
+    uint32_t sz = ifaces_.size();
+    for (uint32_t i = 0; i < sz; ++i) {
+      if (i == sz - 1) {
+        ifaces_[i]->statMulti(_return, paths);
+        return;
+      } else {
+        ifaces_[i]->statMulti(_return, paths);
+      }
+    }
+  }
+
   void listStatus(std::vector<FileStatus> & _return, const Pathname& path) {
     uint32_t sz = ifaces_.size();
     for (uint32_t i = 0; i < sz; ++i) {
@@ -2319,6 +2682,18 @@ class ThriftHadoopFileSystemMultiface : virtual public ThriftHadoopFileSystemIf
     }
   }
 
+  void listStatusMulti(std::vector<std::vector<FileStatus> > & _return, const std::vector<Pathname> & paths) {
+    uint32_t sz = ifaces_.size();
+    for (uint32_t i = 0; i < sz; ++i) {
+      if (i == sz - 1) {
+        ifaces_[i]->listStatusMulti(_return, paths);
+        return;
+      } else {
+        ifaces_[i]->listStatusMulti(_return, paths);
+      }
+    }
+  }
+
   void chmod(const Pathname& path, const int16_t mode) {
     uint32_t sz = ifaces_.size();
     for (uint32_t i = 0; i < sz; ++i) {
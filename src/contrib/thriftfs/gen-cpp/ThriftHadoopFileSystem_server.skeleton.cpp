@@ -60,6 +60,11 @@ class ThriftHadoopFileSystemHandler : virtual public ThriftHadoopFileSystemIf {
     printf("read\n");
   }
 
+  void readChunks(std::vector<std::string> & _return, const ThriftHandle& handle, const int64_t offset, const int32_t size, const int32_t chunkSize) {
+    // Your implementation goes here
+    printf("readChunks\n");
+  }
+
   bool close(const ThriftHandle& out) {
     // Your implementation goes here
     printf("close\n");
@@ -90,11 +95,21 @@ class ThriftHadoopFileSystemHandler : virtual public ThriftHadoopFileSystemIf {
     printf("stat\n");
   }
 
+  void statMulti(std::vector<FileStatus> & _return, const std::vector<Pathname> & paths) {
+    // Your implementation goes here
+    printf("statMulti\n");
+  }
+
   void listStatus(std::vector<FileStatus> & _return, const Pathname& path) {
     // Your implementation goes here
     printf("listStatus\n");
   }
 
+  void listStatusMulti(std::vector<std::vector<FileStatus> > & _return, const std::vector<Pathname> & paths) {
+    // Your implementation goes here
+    printf("listStatusMulti\n");
+  }
+
   void chmod(const Pathname& path, const int16_t mode) {
     // Your implementation goes here
     printf("chmod\n");
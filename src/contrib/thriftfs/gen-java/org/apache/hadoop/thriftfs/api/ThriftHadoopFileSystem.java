@@ -36,6 +36,8 @@ public class ThriftHadoopFileSystem {
 
     public String read(ThriftHandle handle, long offset, int size) throws ThriftIOException, TException;
 
+    public List<String> readChunks(ThriftHandle handle, long offset, int size, int chunkSize) throws ThriftIOException, TException;
+
     public boolean close(ThriftHandle out) throws ThriftIOException, TException;
 
     public boolean rm(Pathname path, boolean recursive) throws ThriftIOException, TException;
@@ -48,8 +50,12 @@ public class ThriftHadoopFileSystem {
 
     public FileStatus stat(Pathname path) throws ThriftIOException, TException;
 
+    public List<FileStatus> statMulti(List<Pathname> paths) throws ThriftIOException, TException;
+
     public List<FileStatus> listStatus(Pathname path) throws ThriftIOException, TException;
 
+    public List<List<FileStatus>> listStatusMulti(List<Pathname> paths) throws ThriftIOException, TException;
+
     public void chmod(Pathname path, short mode) throws ThriftIOException, TException;
 
     public void chown(Pathname path, String owner, String group) throws ThriftIOException, TException;
@@ -371,6 +377,45 @@ public class ThriftHadoopFileSystem {
       throw new TApplicationException(TApplicationException.MISSING_RESULT, "read failed: unknown result");
     }
 
+    public List<String> readChunks(ThriftHandle handle, long offset, int size, int chunkSize) throws ThriftIOException, TException
+    {
+      send_readChunks(handle, offset, size, chunkSize);
+      return recv_readChunks();
+    }
+
+    public void send_readChunks(ThriftHandle handle, long offset, int size, int chunkSize) throws TException
+    {
+      oprot_.writeMessageBegin(new TMessage("readChunks", TMessageType.CALL, seqid_));
+      readChunks_args args = new readChunks_args();
+      args.handle = handle;
+      args.offset = offset;
+      args.size = size;
+      args.chunkSize = chunkSize;
+      args.write(oprot_);
+      oprot_.writeMessageEnd();
+      oprot_.getTransport().flush();
+    }
+
+    public List<String> recv_readChunks() throws ThriftIOException, TException
+    {
+      TMessage msg = iprot_.readMessageBegin();
+      if (msg.type == TMessageType.EXCEPTION) {
+        TApplicationException x = TApplicationException.read(iprot_);
+        iprot_.readMessageEnd();
+        throw x;
+      }
+      readChunks_result result = new readChunks_result();
+      result.read(iprot_);
+      iprot_.readMessageEnd();
+      if (result.__isset.success) {
+        return result.success;
+      }
+      if (result.__isset.ouch) {
+        throw result.ouch;
+      }
+      throw new TApplicationException(TApplicationException.MISSING_RESULT, "readChunks failed: unknown result");
+    }
+
     public boolean close(ThriftHandle out) throws ThriftIOException, TException
     {
       send_close(out);
@@ -589,6 +634,42 @@ public class ThriftHadoopFileSystem {
       throw new TApplicationException(TApplicationException.MISSING_RESULT, "stat failed: unknown result");
     }
 
+    public List<FileStatus> statMulti(List<Pathname> paths) throws ThriftIOException, TException
+    {
+      send_statMulti(paths);
+      return recv_statMulti();
+    }
+
+    public void send_statMulti(List<Pathname> paths) throws TException
+    {
+      oprot_.writeMessageBegin(new TMessage("statMulti", TMessageType.CALL, seqid_));
+      statMulti_args args = new statMulti_args();
+      args.paths = paths;
+      args.write(oprot_);
+      oprot_.writeMessageEnd();
+      oprot_.getTransport().flush();
+    }
+
+    public List<FileStatus> recv_statMulti() throws ThriftIOException, TException
+    {
+      TMessage msg = iprot_.readMessageBegin();
+      if (msg.type == TMessageType.EXCEPTION) {
+        TApplicationException x = TApplicationException.read(iprot_);
+        iprot_.readMessageEnd();
+        throw x;
+      }
+      statMulti_result result = new statMulti_result();
+      result.read(iprot_);
+      iprot_.readMessageEnd();
+      if (result.__isset.success) {
+        return result.success;
+      }
+      if (result.__isset.ouch) {
+        throw result.ouch;
+      }
+      throw new TApplicationException(TApplicationException.MISSING_RESULT, "statMulti failed: unknown result");
+    }
+
     public List<FileStatus> listStatus(Pathname path) throws ThriftIOException, TException
     {
       send_listStatus(path);
@@ -625,6 +706,42 @@ public class ThriftHadoopFileSystem {
       throw new TApplicationException(TApplicationException.MISSING_RESULT, "listStatus failed: unknown result");
     }
 
+    public List<List<FileStatus>> listStatusMulti(List<Pathname> paths) throws ThriftIOException, TException
+    {
+      send_listStatusMulti(paths);
+      return recv_listStatusMulti();
+    }
+
+    public void send_listStatusMulti(List<Pathname> paths) throws TException
+    {
+      oprot_.writeMessageBegin(new TMessage("listStatusMulti", TMessageType.CALL, seqid_));
+      listStatusMulti_args args = new listStatusMulti_args();
+      args.paths = paths;
+      args.write(oprot_);
+      oprot_.writeMessageEnd();
+      oprot_.getTransport().flush();
+    }
+
+    public List<List<FileStatus>> recv_listStatusMulti() throws ThriftIOException, TException
+    {
+      TMessage msg = iprot_.readMessageBegin();
+      if (msg.type == TMessageType.EXCEPTION) {
+        TApplicationException x = TApplicationException.read(iprot_);
+        iprot_.readMessageEnd();
+        throw x;
+      }
+      listStatusMulti_result result = new listStatusMulti_result();
+      result.read(iprot_);
+      iprot_.readMessageEnd();
+      if (result.__isset.success) {
+        return result.success;
+      }
+      if (result.__isset.ouch) {
+        throw result.ouch;
+      }
+      throw new TApplicationException(TApplicationException.MISSING_RESULT, "listStatusMulti failed: unknown result");
+    }
+
     public void chmod(Pathname path, short mode) throws ThriftIOException, TException
     {
       send_chmod(path, mode);
@@ -779,13 +896,16 @@ public class ThriftHadoopFileSystem {
       processMap_.put("append", new append());
       processMap_.put("write", new write());
       processMap_.put("read", new read());
+      processMap_.put("readChunks", new readChunks());
       processMap_.put("close", new close());
       processMap_.put("rm", new rm());
       processMap_.put("rename", new rename());
       processMap_.put("mkdirs", new mkdirs());
       processMap_.put("exists", new exists());
       processMap_.put("stat", new stat());
+      processMap_.put("statMulti", new statMulti());
       processMap_.put("listStatus", new listStatus());
+      processMap_.put("listStatusMulti", new listStatusMulti());
       processMap_.put("chmod", new chmod());
       processMap_.put("chown", new chown());
       processMap_.put("setReplication", new setReplication());
@@ -981,6 +1101,28 @@ public class ThriftHadoopFileSystem {
 
     }
 
+    private class readChunks implements ProcessFunction {
+      public void process(int seqid, TProtocol iprot, TProtocol oprot) throws TException
+      {
+        readChunks_args args = new readChunks_args();
+        args.read(iprot);
+        iprot.readMessageEnd();
+        readChunks_result result = new readChunks_result();
+        try {
+          result.success = iface_.readChunks(args.handle, args.offset, args.size, args.chunkSize);
+          result.__isset.success = true;
+        } catch (ThriftIOException ouch) {
+          result.ouch = ouch;
+          result.__isset.ouch = true;
+        }
+        oprot.writeMessageBegin(new TMessage("readChunks", TMessageType.REPLY, seqid));
+        result.write(oprot);
+        oprot.writeMessageEnd();
+        oprot.getTransport().flush();
+      }
+
+    }
+
     private class close implements ProcessFunction {
       public void process(int seqid, TProtocol iprot, TProtocol oprot) throws TException
       {
@@ -1113,6 +1255,28 @@ public class ThriftHadoopFileSystem {
 
     }
 
+    private class statMulti implements ProcessFunction {
+      public void process(int seqid, TProtocol iprot, TProtocol oprot) throws TException
+      {
+        statMulti_args args = new statMulti_args();
+        args.read(iprot);
+        iprot.readMessageEnd();
+        statMulti_result result = new statMulti_result();
+        try {
+          result.success = iface_.statMulti(args.paths);
+          result.__isset.success = true;
+        } catch (ThriftIOException ouch) {
+          result.ouch = ouch;
+          result.__isset.ouch = true;
+        }
+        oprot.writeMessageBegin(new TMessage("statMulti", TMessageType.REPLY, seqid));
+        result.write(oprot);
+        oprot.writeMessageEnd();
+        oprot.getTransport().flush();
+      }
+
+    }
+
     private class listStatus implements ProcessFunction {
       public void process(int seqid, TProtocol iprot, TProtocol oprot) throws TException
       {
@@ -1135,6 +1299,28 @@ public class ThriftHadoopFileSystem {
 
     }
 
+    private class listStatusMulti implements ProcessFunction {
+      public void process(int seqid, TProtocol iprot, TProtocol oprot) throws TException
+      {
+        listStatusMulti_args args = new listStatusMulti_args();
+        args.read(iprot);
+        iprot.readMessageEnd();
+        listStatusMulti_result result = new listStatusMulti_result();
+        try {
+          result.success = iface_.listStatusMulti(args.paths);
+          result.__isset.success = true;
+        } catch (ThriftIOException ouch) {
+          result.ouch = ouch;
+          result.__isset.ouch = true;
+        }
+        oprot.writeMessageBegin(new TMessage("listStatusMulti", TMessageType.REPLY, seqid));
+        result.write(oprot);
+        oprot.writeMessageEnd();
+        oprot.getTransport().flush();
+      }
+
+    }
+
     private class chmod implements ProcessFunction {
       public void process(int seqid, TProtocol iprot, TProtocol oprot) throws TException
       {
@@ -3222,43 +3408,85 @@ public class ThriftHadoopFileSystem {
 
   }
 
-  public static class close_args implements TBase, java.io.Serializable   {
-    public ThriftHandle out;
+  public static class readChunks_args implements TBase, java.io.Serializable   {
+    public ThriftHandle handle;
+    public long offset;
+    public int size;
+    public int chunkSize;
 
     public final Isset __isset = new Isset();
     public static final class Isset implements java.io.Serializable {
-      public boolean out = false;
+      public boolean handle = false;
+      public boolean offset = false;
+      public boolean size = false;
+      public boolean chunkSize = false;
     }
 
-    public close_args() {
+    public readChunks_args() {
     }
 
-    public close_args(
-      ThriftHandle out)
+    public readChunks_args(
+      ThriftHandle handle,
+      long offset,
+      int size,
+      int chunkSize)
     {
       this();
-      this.out = out;
-      this.__isset.out = true;
+      this.handle = handle;
+      this.__isset.handle = true;
+      this.offset = offset;
+      this.__isset.offset = true;
+      this.size = size;
+      this.__isset.size = true;
+      this.chunkSize = chunkSize;
+      this.__isset.chunkSize = true;
     }
 
     public boolean equals(Object that) {
       if (that == null)
         return false;
-      if (that instanceof close_args)
-        return this.equals((close_args)that);
+      if (that instanceof readChunks_args)
+        return this.equals((readChunks_args)that);
       return false;
     }
 
-    public boolean equals(close_args that) {
+    public boolean equals(readChunks_args that) {
       if (that == null)
         return false;
 
-      boolean this_present_out = true && (this.out != null);
-      boolean that_present_out = true && (that.out != null);
-      if (this_present_out || that_present_out) {
-        if (!(this_present_out && that_present_out))
+      boolean this_present_handle = true && (this.handle != null);
+      boolean that_present_handle = true && (that.handle != null);
+      if (this_present_handle || that_present_handle) {
+        if (!(this_present_handle && that_present_handle))
           return false;
-        if (!this.out.equals(that.out))
+        if (!this.handle.equals(that.handle))
+          return false;
+      }
+
+      boolean this_present_offset = true;
+      boolean that_present_offset = true;
+      if (this_present_offset || that_present_offset) {
+        if (!(this_present_offset && that_present_offset))
+          return false;
+        if (this.offset != that.offset)
+          return false;
+      }
+
+      boolean this_present_size = true;
+      boolean that_present_size = true;
+      if (this_present_size || that_present_size) {
+        if (!(this_present_size && that_present_size))
+          return false;
+        if (this.size != that.size)
+          return false;
+      }
+
+      boolean this_present_chunkSize = true;
+      boolean that_present_chunkSize = true;
+      if (this_present_chunkSize || that_present_chunkSize) {
+        if (!(this_present_chunkSize && that_present_chunkSize))
+          return false;
+        if (this.chunkSize != that.chunkSize)
           return false;
       }
 
@@ -3275,17 +3503,41 @@ public class ThriftHadoopFileSystem {
       while (true)
       {
         field = iprot.readFieldBegin();
-        if (field.type == TType.STOP) { 
+        if (field.type == TType.STOP) {
           break;
         }
         switch (field.id)
         {
           case 1:
             if (field.type == TType.STRUCT) {
-              this.out = new ThriftHandle();
-              this.out.read(iprot);
-              this.__isset.out = true;
-            } else { 
+              this.handle = new ThriftHandle();
+              this.handle.read(iprot);
+              this.__isset.handle = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          case -1:
+            if (field.type == TType.I64) {
+              this.offset = iprot.readI64();
+              this.__isset.offset = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          case -2:
+            if (field.type == TType.I32) {
+              this.size = iprot.readI32();
+              this.__isset.size = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          case -3:
+            if (field.type == TType.I32) {
+              this.chunkSize = iprot.readI32();
+              this.__isset.chunkSize = true;
+            } else {
               TProtocolUtil.skip(iprot, field.type);
             }
             break;
@@ -3299,33 +3551,57 @@ public class ThriftHadoopFileSystem {
     }
 
     public void write(TProtocol oprot) throws TException {
-      TStruct struct = new TStruct("close_args");
+      TStruct struct = new TStruct("readChunks_args");
       oprot.writeStructBegin(struct);
       TField field = new TField();
-      if (this.out != null) {
-        field.name = "out";
+      if (this.handle != null) {
+        field.name = "handle";
         field.type = TType.STRUCT;
         field.id = 1;
         oprot.writeFieldBegin(field);
-        this.out.write(oprot);
+        this.handle.write(oprot);
         oprot.writeFieldEnd();
       }
+      field.name = "offset";
+      field.type = TType.I64;
+      field.id = -1;
+      oprot.writeFieldBegin(field);
+      oprot.writeI64(this.offset);
+      oprot.writeFieldEnd();
+      field.name = "size";
+      field.type = TType.I32;
+      field.id = -2;
+      oprot.writeFieldBegin(field);
+      oprot.writeI32(this.size);
+      oprot.writeFieldEnd();
+      field.name = "chunkSize";
+      field.type = TType.I32;
+      field.id = -3;
+      oprot.writeFieldBegin(field);
+      oprot.writeI32(this.chunkSize);
+      oprot.writeFieldEnd();
       oprot.writeFieldStop();
       oprot.writeStructEnd();
     }
 
     public String toString() {
-      StringBuilder sb = new StringBuilder("close_args(");
-      sb.append("out:");
-      sb.append(this.out);
+      StringBuilder sb = new StringBuilder("readChunks_args(");
+      sb.append("handle:");
+      sb.append(this.handle);
+      sb.append(",offset:");
+      sb.append(this.offset);
+      sb.append(",size:");
+      sb.append(this.size);
+      sb.append(",chunkSize:");
+      sb.append(this.chunkSize);
       sb.append(")");
       return sb.toString();
     }
 
   }
 
-  public static class close_result implements TBase, java.io.Serializable   {
-    public boolean success;
+  public static class readChunks_result implements TBase, java.io.Serializable   {
+    public List<String> success;
     public ThriftIOException ouch;
 
     public final Isset __isset = new Isset();
@@ -3334,11 +3610,11 @@ public class ThriftHadoopFileSystem {
       public boolean ouch = false;
     }
 
-    public close_result() {
+    public readChunks_result() {
     }
 
-    public close_result(
-      boolean success,
+    public readChunks_result(
+      List<String> success,
       ThriftIOException ouch)
     {
       this();
@@ -3351,8 +3627,264 @@ public class ThriftHadoopFileSystem {
     public boolean equals(Object that) {
       if (that == null)
         return false;
-      if (that instanceof close_result)
-        return this.equals((close_result)that);
+      if (that instanceof readChunks_result)
+        return this.equals((readChunks_result)that);
+      return false;
+    }
+
+    public boolean equals(readChunks_result that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_success = true && (this.success != null);
+      boolean that_present_success = true && (that.success != null);
+      if (this_present_success || that_present_success) {
+        if (!(this_present_success && that_present_success))
+          return false;
+        if (!this.success.equals(that.success))
+          return false;
+      }
+
+      boolean this_present_ouch = true && (this.ouch != null);
+      boolean that_present_ouch = true && (that.ouch != null);
+      if (this_present_ouch || that_present_ouch) {
+        if (!(this_present_ouch && that_present_ouch))
+          return false;
+        if (!this.ouch.equals(that.ouch))
+          return false;
+      }
+
+      return true;
+    }
+
+    public int hashCode() {
+      return 0;
+    }
+
+    public void read(TProtocol iprot) throws TException {
+      TField field;
+      iprot.readStructBegin();
+      while (true)
+      {
+        field = iprot.readFieldBegin();
+        if (field.type == TType.STOP) {
+          break;
+        }
+        switch (field.id)
+        {
+          case 0:
+            if (field.type == TType.LIST) {
+              {
+                TList _list16 = iprot.readListBegin();
+                this.success = new ArrayList<String>(_list16.size);
+                for (int _i17 = 0; _i17 < _list16.size; ++_i17)
+                {
+                  String _elem18 = null;
+                  _elem18 = iprot.readString();
+                  this.success.add(_elem18);
+                }
+                iprot.readListEnd();
+              }
+              this.__isset.success = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          case 1:
+            if (field.type == TType.STRUCT) {
+              this.ouch = new ThriftIOException();
+              this.ouch.read(iprot);
+              this.__isset.ouch = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          default:
+            TProtocolUtil.skip(iprot, field.type);
+            break;
+        }
+        iprot.readFieldEnd();
+      }
+      iprot.readStructEnd();
+    }
+
+    public void write(TProtocol oprot) throws TException {
+      TStruct struct = new TStruct("readChunks_result");
+      oprot.writeStructBegin(struct);
+      TField field = new TField();
+
+      if (this.__isset.success) {
+        if (this.success != null) {
+          field.name = "success";
+          field.type = TType.LIST;
+          field.id = 0;
+          oprot.writeFieldBegin(field);
+          {
+            oprot.writeListBegin(new TList(TType.STRING, this.success.size()));
+            for (String _iter19 : this.success)            {
+              oprot.writeString(_iter19);
+            }
+            oprot.writeListEnd();
+          }
+          oprot.writeFieldEnd();
+        }
+      } else if (this.__isset.ouch) {
+        if (this.ouch != null) {
+          field.name = "ouch";
+          field.type = TType.STRUCT;
+          field.id = 1;
+          oprot.writeFieldBegin(field);
+          this.ouch.write(oprot);
+          oprot.writeFieldEnd();
+        }
+      }
+      oprot.writeFieldStop();
+      oprot.writeStructEnd();
+    }
+
+    public String toString() {
+      StringBuilder sb = new StringBuilder("readChunks_result(");
+      sb.append("success:");
+      sb.append(this.success);
+      sb.append(",ouch:");
+      sb.append(this.ouch);
+      sb.append(")");
+      return sb.toString();
+    }
+
+  }
+
+  public static class close_args implements TBase, java.io.Serializable   {
+    public ThriftHandle out;
+
+    public final Isset __isset = new Isset();
+    public static final class Isset implements java.io.Serializable {
+      public boolean out = false;
+    }
+
+    public close_args() {
+    }
+
+    public close_args(
+      ThriftHandle out)
+    {
+      this();
+      this.out = out;
+      this.__isset.out = true;
+    }
+
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof close_args)
+        return this.equals((close_args)that);
+      return false;
+    }
+
+    public boolean equals(close_args that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_out = true && (this.out != null);
+      boolean that_present_out = true && (that.out != null);
+      if (this_present_out || that_present_out) {
+        if (!(this_present_out && that_present_out))
+          return false;
+        if (!this.out.equals(that.out))
+          return false;
+      }
+
+      return true;
+    }
+
+    public int hashCode() {
+      return 0;
+    }
+
+    public void read(TProtocol iprot) throws TException {
+      TField field;
+      iprot.readStructBegin();
+      while (true)
+      {
+        field = iprot.readFieldBegin();
+        if (field.type == TType.STOP) { 
+          break;
+        }
+        switch (field.id)
+        {
+          case 1:
+            if (field.type == TType.STRUCT) {
+              this.out = new ThriftHandle();
+              this.out.read(iprot);
+              this.__isset.out = true;
+            } else { 
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          default:
+            TProtocolUtil.skip(iprot, field.type);
+            break;
+        }
+        iprot.readFieldEnd();
+      }
+      iprot.readStructEnd();
+    }
+
+    public void write(TProtocol oprot) throws TException {
+      TStruct struct = new TStruct("close_args");
+      oprot.writeStructBegin(struct);
+      TField field = new TField();
+      if (this.out != null) {
+        field.name = "out";
+        field.type = TType.STRUCT;
+        field.id = 1;
+        oprot.writeFieldBegin(field);
+        this.out.write(oprot);
+        oprot.writeFieldEnd();
+      }
+      oprot.writeFieldStop();
+      oprot.writeStructEnd();
+    }
+
+    public String toString() {
+      StringBuilder sb = new StringBuilder("close_args(");
+      sb.append("out:");
+      sb.append(this.out);
+      sb.append(")");
+      return sb.toString();
+    }
+
+  }
+
+  public static class close_result implements TBase, java.io.Serializable   {
+    public boolean success;
+    public ThriftIOException ouch;
+
+    public final Isset __isset = new Isset();
+    public static final class Isset implements java.io.Serializable {
+      public boolean success = false;
+      public boolean ouch = false;
+    }
+
+    public close_result() {
+    }
+
+    public close_result(
+      boolean success,
+      ThriftIOException ouch)
+    {
+      this();
+      this.success = success;
+      this.__isset.success = true;
+      this.ouch = ouch;
+      this.__isset.ouch = true;
+    }
+
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof close_result)
+        return this.equals((close_result)that);
       return false;
     }
 
@@ -4716,41 +5248,314 @@ public class ThriftHadoopFileSystem {
 
   }
 
-  public static class listStatus_args implements TBase, java.io.Serializable   {
-    public Pathname path;
+  public static class statMulti_args implements TBase, java.io.Serializable   {
+    public List<Pathname> paths;
 
     public final Isset __isset = new Isset();
     public static final class Isset implements java.io.Serializable {
-      public boolean path = false;
+      public boolean paths = false;
     }
 
-    public listStatus_args() {
+    public statMulti_args() {
     }
 
-    public listStatus_args(
-      Pathname path)
+    public statMulti_args(
+      List<Pathname> paths)
     {
       this();
-      this.path = path;
-      this.__isset.path = true;
+      this.paths = paths;
+      this.__isset.paths = true;
     }
 
     public boolean equals(Object that) {
       if (that == null)
         return false;
-      if (that instanceof listStatus_args)
-        return this.equals((listStatus_args)that);
+      if (that instanceof statMulti_args)
+        return this.equals((statMulti_args)that);
       return false;
     }
 
-    public boolean equals(listStatus_args that) {
+    public boolean equals(statMulti_args that) {
       if (that == null)
         return false;
 
-      boolean this_present_path = true && (this.path != null);
-      boolean that_present_path = true && (that.path != null);
-      if (this_present_path || that_present_path) {
-        if (!(this_present_path && that_present_path))
+      boolean this_present_paths = true && (this.paths != null);
+      boolean that_present_paths = true && (that.paths != null);
+      if (this_present_paths || that_present_paths) {
+        if (!(this_present_paths && that_present_paths))
+          return false;
+        if (!this.paths.equals(that.paths))
+          return false;
+      }
+
+      return true;
+    }
+
+    public int hashCode() {
+      return 0;
+    }
+
+    public void read(TProtocol iprot) throws TException {
+      TField field;
+      iprot.readStructBegin();
+      while (true)
+      {
+        field = iprot.readFieldBegin();
+        if (field.type == TType.STOP) {
+          break;
+        }
+        switch (field.id)
+        {
+          case 1:
+            if (field.type == TType.LIST) {
+              {
+                TList _list20 = iprot.readListBegin();
+                this.paths = new ArrayList<Pathname>(_list20.size);
+                for (int _i21 = 0; _i21 < _list20.size; ++_i21)
+                {
+                  Pathname _elem22 = new Pathname();
+                  _elem22 = new Pathname();
+                  _elem22.read(iprot);
+                  this.paths.add(_elem22);
+                }
+                iprot.readListEnd();
+              }
+              this.__isset.paths = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          default:
+            TProtocolUtil.skip(iprot, field.type);
+            break;
+        }
+        iprot.readFieldEnd();
+      }
+      iprot.readStructEnd();
+    }
+
+    public void write(TProtocol oprot) throws TException {
+      TStruct struct = new TStruct("statMulti_args");
+      oprot.writeStructBegin(struct);
+      TField field = new TField();
+      if (this.paths != null) {
+        field.name = "paths";
+        field.type = TType.LIST;
+        field.id = 1;
+        oprot.writeFieldBegin(field);
+        {
+          oprot.writeListBegin(new TList(TType.STRUCT, this.paths.size()));
+          for (Pathname _iter23 : this.paths)          {
+            _iter23.write(oprot);
+          }
+          oprot.writeListEnd();
+        }
+        oprot.writeFieldEnd();
+      }
+      oprot.writeFieldStop();
+      oprot.writeStructEnd();
+    }
+
+    public String toString() {
+      StringBuilder sb = new StringBuilder("statMulti_args(");
+      sb.append("paths:");
+      sb.append(this.paths);
+      sb.append(")");
+      return sb.toString();
+    }
+
+  }
+
+  public static class statMulti_result implements TBase, java.io.Serializable   {
+    public List<FileStatus> success;
+    public ThriftIOException ouch;
+
+    public final Isset __isset = new Isset();
+    public static final class Isset implements java.io.Serializable {
+      public boolean success = false;
+      public boolean ouch = false;
+    }
+
+    public statMulti_result() {
+    }
+
+    public statMulti_result(
+      List<FileStatus> success,
+      ThriftIOException ouch)
+    {
+      this();
+      this.success = success;
+      this.__isset.success = true;
+      this.ouch = ouch;
+      this.__isset.ouch = true;
+    }
+
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof statMulti_result)
+        return this.equals((statMulti_result)that);
+      return false;
+    }
+
+    public boolean equals(statMulti_result that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_success = true && (this.success != null);
+      boolean that_present_success = true && (that.success != null);
+      if (this_present_success || that_present_success) {
+        if (!(this_present_success && that_present_success))
+          return false;
+        if (!this.success.equals(that.success))
+          return false;
+      }
+
+      boolean this_present_ouch = true && (this.ouch != null);
+      boolean that_present_ouch = true && (that.ouch != null);
+      if (this_present_ouch || that_present_ouch) {
+        if (!(this_present_ouch && that_present_ouch))
+          return false;
+        if (!this.ouch.equals(that.ouch))
+          return false;
+      }
+
+      return true;
+    }
+
+    public int hashCode() {
+      return 0;
+    }
+
+    public void read(TProtocol iprot) throws TException {
+      TField field;
+      iprot.readStructBegin();
+      while (true)
+      {
+        field = iprot.readFieldBegin();
+        if (field.type == TType.STOP) {
+          break;
+        }
+        switch (field.id)
+        {
+          case 0:
+            if (field.type == TType.LIST) {
+              {
+                TList _list24 = iprot.readListBegin();
+                this.success = new ArrayList<FileStatus>(_list24.size);
+                for (int _i25 = 0; _i25 < _list24.size; ++_i25)
+                {
+                  FileStatus _elem26 = new FileStatus();
+                  _elem26 = new FileStatus();
+                  _elem26.read(iprot);
+                  this.success.add(_elem26);
+                }
+                iprot.readListEnd();
+              }
+              this.__isset.success = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          case 1:
+            if (field.type == TType.STRUCT) {
+              this.ouch = new ThriftIOException();
+              this.ouch.read(iprot);
+              this.__isset.ouch = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          default:
+            TProtocolUtil.skip(iprot, field.type);
+            break;
+        }
+        iprot.readFieldEnd();
+      }
+      iprot.readStructEnd();
+    }
+
+    public void write(TProtocol oprot) throws TException {
+      TStruct struct = new TStruct("statMulti_result");
+      oprot.writeStructBegin(struct);
+      TField field = new TField();
+
+      if (this.__isset.success) {
+        if (this.success != null) {
+          field.name = "success";
+          field.type = TType.LIST;
+          field.id = 0;
+          oprot.writeFieldBegin(field);
+          {
+            oprot.writeListBegin(new TList(TType.STRUCT, this.success.size()));
+            for (FileStatus _iter27 : this.success)            {
+              _iter27.write(oprot);
+            }
+            oprot.writeListEnd();
+          }
+          oprot.writeFieldEnd();
+        }
+      } else if (this.__isset.ouch) {
+        if (this.ouch != null) {
+          field.name = "ouch";
+          field.type = TType.STRUCT;
+          field.id = 1;
+          oprot.writeFieldBegin(field);
+          this.ouch.write(oprot);
+          oprot.writeFieldEnd();
+        }
+      }
+      oprot.writeFieldStop();
+      oprot.writeStructEnd();
+    }
+
+    public String toString() {
+      StringBuilder sb = new StringBuilder("statMulti_result(");
+      sb.append("success:");
+      sb.append(this.success);
+      sb.append(",ouch:");
+      sb.append(this.ouch);
+      sb.append(")");
+      return sb.toString();
+    }
+
+  }
+
+  public static class listStatus_args implements TBase, java.io.Serializable   {
+    public Pathname path;
+
+    public final Isset __isset = new Isset();
+    public static final class Isset implements java.io.Serializable {
+      public boolean path = false;
+    }
+
+    public listStatus_args() {
+    }
+
+    public listStatus_args(
+      Pathname path)
+    {
+      this();
+      this.path = path;
+      this.__isset.path = true;
+    }
+
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof listStatus_args)
+        return this.equals((listStatus_args)that);
+      return false;
+    }
+
+    public boolean equals(listStatus_args that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_path = true && (this.path != null);
+      boolean that_present_path = true && (that.path != null);
+      if (this_present_path || that_present_path) {
+        if (!(this_present_path && that_present_path))
           return false;
         if (!this.path.equals(that.path))
           return false;
@@ -4973,6 +5778,295 @@ public class ThriftHadoopFileSystem {
 
   }
 
+  public static class listStatusMulti_args implements TBase, java.io.Serializable   {
+    public List<Pathname> paths;
+
+    public final Isset __isset = new Isset();
+    public static final class Isset implements java.io.Serializable {
+      public boolean paths = false;
+    }
+
+    public listStatusMulti_args() {
+    }
+
+    public listStatusMulti_args(
+      List<Pathname> paths)
+    {
+      this();
+      this.paths = paths;
+      this.__isset.paths = true;
+    }
+
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof listStatusMulti_args)
+        return this.equals((listStatusMulti_args)that);
+      return false;
+    }
+
+    public boolean equals(listStatusMulti_args that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_paths = true && (this.paths != null);
+      boolean that_present_paths = true && (that.paths != null);
+      if (this_present_paths || that_present_paths) {
+        if (!(this_present_paths && that_present_paths))
+          return false;
+        if (!this.paths.equals(that.paths))
+          return false;
+      }
+
+      return true;
+    }
+
+    public int hashCode() {
+      return 0;
+    }
+
+    public void read(TProtocol iprot) throws TException {
+      TField field;
+      iprot.readStructBegin();
+      while (true)
+      {
+        field = iprot.readFieldBegin();
+        if (field.type == TType.STOP) {
+          break;
+        }
+        switch (field.id)
+        {
+          case 1:
+            if (field.type == TType.LIST) {
+              {
+                TList _list28 = iprot.readListBegin();
+                this.paths = new ArrayList<Pathname>(_list28.size);
+                for (int _i29 = 0; _i29 < _list28.size; ++_i29)
+                {
+                  Pathname _elem30 = new Pathname();
+                  _elem30 = new Pathname();
+                  _elem30.read(iprot);
+                  this.paths.add(_elem30);
+                }
+                iprot.readListEnd();
+              }
+              this.__isset.paths = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          default:
+            TProtocolUtil.skip(iprot, field.type);
+            break;
+        }
+        iprot.readFieldEnd();
+      }
+      iprot.readStructEnd();
+    }
+
+    public void write(TProtocol oprot) throws TException {
+      TStruct struct = new TStruct("listStatusMulti_args");
+      oprot.writeStructBegin(struct);
+      TField field = new TField();
+      if (this.paths != null) {
+        field.name = "paths";
+        field.type = TType.LIST;
+        field.id = 1;
+        oprot.writeFieldBegin(field);
+        {
+          oprot.writeListBegin(new TList(TType.STRUCT, this.paths.size()));
+          for (Pathname _iter31 : this.paths)          {
+            _iter31.write(oprot);
+          }
+          oprot.writeListEnd();
+        }
+        oprot.writeFieldEnd();
+      }
+      oprot.writeFieldStop();
+      oprot.writeStructEnd();
+    }
+
+    public String toString() {
+      StringBuilder sb = new StringBuilder("listStatusMulti_args(");
+      sb.append("paths:");
+      sb.append(this.paths);
+      sb.append(")");
+      return sb.toString();
+    }
+
+  }
+
+  public static class listStatusMulti_result implements TBase, java.io.Serializable   {
+    public List<List<FileStatus>> success;
+    public ThriftIOException ouch;
+
+    public final Isset __isset = new Isset();
+    public static final class Isset implements java.io.Serializable {
+      public boolean success = false;
+      public boolean ouch = false;
+    }
+
+    public listStatusMulti_result() {
+    }
+
+    public listStatusMulti_result(
+      List<List<FileStatus>> success,
+      ThriftIOException ouch)
+    {
+      this();
+      this.success = success;
+      this.__isset.success = true;
+      this.ouch = ouch;
+      this.__isset.ouch = true;
+    }
+
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof listStatusMulti_result)
+        return this.equals((listStatusMulti_result)that);
+      return false;
+    }
+
+    public boolean equals(listStatusMulti_result that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_success = true && (this.success != null);
+      boolean that_present_success = true && (that.success != null);
+      if (this_present_success || that_present_success) {
+        if (!(this_present_success && that_present_success))
+          return false;
+        if (!this.success.equals(that.success))
+          return false;
+      }
+
+      boolean this_present_ouch = true && (this.ouch != null);
+      boolean that_present_ouch = true && (that.ouch != null);
+      if (this_present_ouch || that_present_ouch) {
+        if (!(this_present_ouch && that_present_ouch))
+          return false;
+        if (!this.ouch.equals(that.ouch))
+          return false;
+      }
+
+      return true;
+    }
+
+    public int hashCode() {
+      return 0;
+    }
+
+    public void read(TProtocol iprot) throws TException {
+      TField field;
+      iprot.readStructBegin();
+      while (true)
+      {
+        field = iprot.readFieldBegin();
+        if (field.type == TType.STOP) {
+          break;
+        }
+        switch (field.id)
+        {
+          case 0:
+            if (field.type == TType.LIST) {
+              {
+                TList _list32 = iprot.readListBegin();
+                this.success = new ArrayList<List<FileStatus>>(_list32.size);
+                for (int _i33 = 0; _i33 < _list32.size; ++_i33)
+                {
+                  List<FileStatus> _elem34 = new ArrayList<FileStatus>();
+                  {
+                    TList _list35 = iprot.readListBegin();
+                    _elem34 = new ArrayList<FileStatus>(_list35.size);
+                    for (int _i36 = 0; _i36 < _list35.size; ++_i36)
+                    {
+                      FileStatus _elem37 = new FileStatus();
+                      _elem37 = new FileStatus();
+                      _elem37.read(iprot);
+                      _elem34.add(_elem37);
+                    }
+                    iprot.readListEnd();
+                  }
+                  this.success.add(_elem34);
+                }
+                iprot.readListEnd();
+              }
+              this.__isset.success = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          case 1:
+            if (field.type == TType.STRUCT) {
+              this.ouch = new ThriftIOException();
+              this.ouch.read(iprot);
+              this.__isset.ouch = true;
+            } else {
+              TProtocolUtil.skip(iprot, field.type);
+            }
+            break;
+          default:
+            TProtocolUtil.skip(iprot, field.type);
+            break;
+        }
+        iprot.readFieldEnd();
+      }
+      iprot.readStructEnd();
+    }
+
+    public void write(TProtocol oprot) throws TException {
+      TStruct struct = new TStruct("listStatusMulti_result");
+      oprot.writeStructBegin(struct);
+      TField field = new TField();
+
+      if (this.__isset.success) {
+        if (this.success != null) {
+          field.name = "success";
+          field.type = TType.LIST;
+          field.id = 0;
+          oprot.writeFieldBegin(field);
+          {
+            oprot.writeListBegin(new TList(TType.LIST, this.success.size()));
+            for (List<FileStatus> _iter38 : this.success)            {
+              {
+                oprot.writeListBegin(new TList(TType.STRUCT, _iter38.size()));
+                for (FileStatus _iter39 : _iter38)                {
+                  _iter39.write(oprot);
+                }
+                oprot.writeListEnd();
+              }
+            }
+            oprot.writeListEnd();
+          }
+          oprot.writeFieldEnd();
+        }
+      } else if (this.__isset.ouch) {
+        if (this.ouch != null) {
+          field.name = "ouch";
+          field.type = TType.STRUCT;
+          field.id = 1;
+          oprot.writeFieldBegin(field);
+          this.ouch.write(oprot);
+          oprot.writeFieldEnd();
+        }
+      }
+      oprot.writeFieldStop();
+      oprot.writeStructEnd();
+    }
+
+    public String toString() {
+      StringBuilder sb = new StringBuilder("listStatusMulti_result(");
+      sb.append("success:");
+      sb.append(this.success);
+      sb.append(",ouch:");
+      sb.append(this.ouch);
+      sb.append(")");
+      return sb.toString();
+    }
+
+  }
+
   public static class chmod_args implements TBase, java.io.Serializable   {
     public Pathname path;
     public short mode;
@@ -91,6 +91,11 @@ service ThriftHadoopFileSystem
   // read some bytes from the open handle for the file
   string read(1:ThriftHandle handle, i64 offset, i32 size) throws (1:ThriftIOException ouch),
 
+  // read some bytes from the open handle for the file, returned as a list
+  // of chunkSize-sized frames instead of one contiguous string, so large
+  // reads avoid building (and copying) a single giant buffer
+  list<string> readChunks(1:ThriftHandle handle, i64 offset, i32 size, i32 chunkSize) throws (1:ThriftIOException ouch),
+
   // close file
   bool close(1:ThriftHandle out) throws (1:ThriftIOException ouch),
 
@@ -109,9 +114,17 @@ service ThriftHadoopFileSystem
   // Returns status about the path
   FileStatus stat(1:Pathname path) throws (1:ThriftIOException ouch),
 
+  // Returns status about many paths in a single round trip; the result
+  // list is aligned with the input list
+  list<FileStatus> statMulti(1:list<Pathname> paths) throws (1:ThriftIOException ouch),
+
   // If the path is a directory, then returns the list of pathnames in that directory
   list<FileStatus> listStatus(1:Pathname path) throws (1:ThriftIOException ouch),
 
+  // Lists many directories in a single round trip; the result list is
+  // aligned with the input list
+  list<list<FileStatus>> listStatusMulti(1:list<Pathname> paths) throws (1:ThriftIOException ouch),
+
   // Set permission for this file
   void chmod(1:Pathname path, 2:i16 mode) throws (1:ThriftIOException ouch),
 
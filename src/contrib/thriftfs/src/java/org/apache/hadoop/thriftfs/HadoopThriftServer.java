@@ -16,6 +16,8 @@ import org.apache.hadoop.thriftfs.api.ThriftHadoopFileSystem;
 
 import java.io.*;
 import java.util.*;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicLong;
 import java.net.*;
 
 import org.apache.hadoop.fs.*;
@@ -44,9 +46,12 @@ public class HadoopThriftServer extends ThriftHadoopFileSystem {
     Configuration conf;
     FileSystem fs;
         
-    // stucture that maps each Thrift object into an hadoop object
-    private long nextId = new Random().nextLong();
-    private HashMap<Long, Object> hadoopHash = new HashMap<Long, Object>();
+    // stucture that maps each Thrift object into an hadoop object.
+    // a concurrent map and atomic id generator keep handle lookups
+    // from serializing every worker thread on one lock
+    private AtomicLong nextId = new AtomicLong(new Random().nextLong());
+    private ConcurrentHashMap<Long, Object> hadoopHash =
+      new ConcurrentHashMap<Long, Object>();
     private Daemon inactivityThread = null;
 
     // Detect inactive session
@@ -150,23 +155,23 @@ public class HadoopThriftServer extends ThriftHadoopFileSystem {
     /**
      * Lookup a thrift object into a hadoop object
      */
-    private synchronized Object lookup(long id) {
+    private Object lookup(long id) {
       return hadoopHash.get(new Long(id));
     }
 
     /**
      * Insert a thrift object into a hadoop object. Return its id.
      */
-    private synchronized long insert(Object o) {
-      nextId++;
-      hadoopHash.put(nextId, o);
-      return nextId;
+    private long insert(Object o) {
+      long id = nextId.incrementAndGet();
+      hadoopHash.put(id, o);
+      return id;
     }
 
     /**
      * Delete a thrift object from the hadoop store.
      */
-    private synchronized Object remove(long id) {
+    private Object remove(long id) {
       return hadoopHash.remove(new Long(id));
     }
 
@@ -301,7 +306,7 @@ public class HadoopThriftServer extends ThriftHadoopFileSystem {
         if (in.getPos() != offset) {
           in.seek(offset);
         }
-        byte[] tmp = new byte[length];
+        byte[] tmp = getReadBuffer(length);
         int numbytes = in.read(offset, tmp, 0, length);
         HadoopThriftHandler.LOG.debug("read done: " + tout.id);
         return new String(tmp, 0, numbytes, "UTF-8");
@@ -310,6 +315,68 @@ public class HadoopThriftServer extends ThriftHadoopFileSystem {
       }
     }
 
+    // size of the frames handed out by readChunks and the largest
+    // buffer a connection holds on to between calls
+    private static final int DEFAULT_CHUNK_SIZE = 1024 * 1024;
+
+    // per-connection read buffer; the thrift thread pool binds one
+    // thread to each connection, so a thread local gives every
+    // connection its own reusable buffer with no locking at all
+    private static final ThreadLocal<byte[]> readBuffer =
+      new ThreadLocal<byte[]>();
+
+    private static byte[] getReadBuffer(int size) {
+      byte[] buf = readBuffer.get();
+      if (buf == null || buf.length < size) {
+        buf = new byte[size];
+        if (size <= DEFAULT_CHUNK_SIZE) {
+          readBuffer.set(buf);
+        }
+      }
+      return buf;
+    }
+
+    /**
+     * read from a file in fixed size chunks
+     *
+     * Returns the data as a list of frames of at most chunkSize bytes
+     * each rather than one contiguous string, so large reads never
+     * materialize a single buffer of the full request size and every
+     * chunk is read into the connection's reusable buffer.
+     */
+    public List<String> readChunks(ThriftHandle tout, long offset,
+                                   int length, int chunkSize)
+                                   throws ThriftIOException {
+      try {
+        now = now();
+        HadoopThriftHandler.LOG.debug("readChunks: " + tout.id +
+                                     " offset: " + offset +
+                                     " length: " + length +
+                                     " chunkSize: " + chunkSize);
+        if (chunkSize <= 0 || chunkSize > DEFAULT_CHUNK_SIZE) {
+          chunkSize = DEFAULT_CHUNK_SIZE;
+        }
+        FSDataInputStream in = (FSDataInputStream)lookup(tout.id);
+        List<String> chunks = new ArrayList<String>();
+        byte[] tmp = getReadBuffer(chunkSize);
+        int remaining = length;
+        while (remaining > 0) {
+          int request = Math.min(remaining, chunkSize);
+          int numbytes = in.read(offset, tmp, 0, request);
+          if (numbytes <= 0) {
+            break;
+          }
+          chunks.add(new String(tmp, 0, numbytes, "UTF-8"));
+          offset += numbytes;
+          remaining -= numbytes;
+        }
+        HadoopThriftHandler.LOG.debug("readChunks done: " + tout.id);
+        return chunks;
+      } catch (IOException e) {
+        throw new ThriftIOException(e.getMessage());
+      }
+    }
+
     /**
      * Delete a file/directory
      */
@@ -425,6 +492,24 @@ public class HadoopThriftServer extends ThriftHadoopFileSystem {
       }
     }
 
+    /**
+     * Returns status about many pathnames in a single round trip.
+     * The result list is aligned with the input list.
+     */
+    public List<org.apache.hadoop.thriftfs.api.FileStatus> statMulti(
+                            List<Pathname> paths) throws ThriftIOException {
+      now = now();
+      HadoopThriftHandler.LOG.debug("statMulti: " + paths.size() + " paths");
+      List<org.apache.hadoop.thriftfs.api.FileStatus> value =
+        new LinkedList<org.apache.hadoop.thriftfs.api.FileStatus>();
+      for (Pathname path : paths) {
+        value.add(stat(path));
+      }
+      HadoopThriftHandler.LOG.debug("statMulti done: " + paths.size() +
+                                    " paths");
+      return value;
+    }
+
     /**
      * If the specified pathname is a directory, then return the
      * list of pathnames in this directory
@@ -461,6 +546,25 @@ public class HadoopThriftServer extends ThriftHadoopFileSystem {
       }
     }
 
+    /**
+     * Lists many directories in a single round trip. The result list
+     * is aligned with the input list.
+     */
+    public List<List<org.apache.hadoop.thriftfs.api.FileStatus>> listStatusMulti(
+                            List<Pathname> paths) throws ThriftIOException {
+      now = now();
+      HadoopThriftHandler.LOG.debug("listStatusMulti: " + paths.size() +
+                                    " paths");
+      List<List<org.apache.hadoop.thriftfs.api.FileStatus>> value =
+        new LinkedList<List<org.apache.hadoop.thriftfs.api.FileStatus>>();
+      for (Pathname path : paths) {
+        value.add(listStatus(path));
+      }
+      HadoopThriftHandler.LOG.debug("listStatusMulti done: " + paths.size() +
+                                    " paths");
+      return value;
+    }
+
     /**
      * Sets the permission of a pathname
      */
@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.io.compress;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.io.InputStream;
+
+import org.apache.hadoop.conf.Configurable;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.compress.fastlz.FastLzCompressor;
+import org.apache.hadoop.io.compress.fastlz.FastLzDecompressor;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+/**
+ * A block {@link CompressionCodec} for the fast LZ format in the native
+ * library. Trades some compression ratio for considerably less CPU than
+ * {@link DefaultCodec}, which makes it a good fit for shuffle and other
+ * temporary data. Requires the hadoop native library.
+ */
+public class FastLzCodec implements Configurable, CompressionCodec {
+
+  Configuration conf;
+
+  public void setConf(Configuration conf) {
+    this.conf = conf;
+  }
+
+  public Configuration getConf() {
+    return conf;
+  }
+
+  /**
+   * Are the native fastlz libraries loaded &amp; initialized?
+   */
+  public static boolean isNativeFastLzLoaded() {
+    return FastLzCompressor.isNativeFastLzLoaded() &&
+           FastLzDecompressor.isNativeFastLzLoaded();
+  }
+
+  public CompressionOutputStream createOutputStream(OutputStream out)
+  throws IOException {
+    return createOutputStream(out, createCompressor());
+  }
+
+  public CompressionOutputStream createOutputStream(OutputStream out,
+                                                    Compressor compressor)
+  throws IOException {
+    if (!isNativeFastLzLoaded()) {
+      throw new IOException("native-fastlz library not available");
+    }
+    int bufferSize = conf.getInt("io.compression.codec.fastlz.buffersize",
+                                 64*1024);
+    int compressionOverhead =
+      FastLzCompressor.maxCompressedLength(bufferSize) - bufferSize;
+    return new BlockCompressorStream(out, compressor, bufferSize,
+                                     compressionOverhead);
+  }
+
+  public Class<? extends Compressor> getCompressorType() {
+    if (!isNativeFastLzLoaded()) {
+      throw new RuntimeException("native-fastlz library not available");
+    }
+    return FastLzCompressor.class;
+  }
+
+  public Compressor createCompressor() {
+    if (!isNativeFastLzLoaded()) {
+      throw new RuntimeException("native-fastlz library not available");
+    }
+    return new FastLzCompressor(
+        conf.getInt("io.compression.codec.fastlz.buffersize", 64*1024));
+  }
+
+  public CompressionInputStream createInputStream(InputStream in)
+  throws IOException {
+    return createInputStream(in, createDecompressor());
+  }
+
+  public CompressionInputStream createInputStream(InputStream in,
+                                                  Decompressor decompressor)
+  throws IOException {
+    if (!isNativeFastLzLoaded()) {
+      throw new IOException("native-fastlz library not available");
+    }
+    return new BlockDecompressorStream(in, decompressor,
+        conf.getInt("io.compression.codec.fastlz.buffersize", 64*1024));
+  }
+
+  public Class<? extends Decompressor> getDecompressorType() {
+    if (!isNativeFastLzLoaded()) {
+      throw new RuntimeException("native-fastlz library not available");
+    }
+    return FastLzDecompressor.class;
+  }
+
+  public Decompressor createDecompressor() {
+    if (!isNativeFastLzLoaded()) {
+      throw new RuntimeException("native-fastlz library not available");
+    }
+    return new FastLzDecompressor(
+        conf.getInt("io.compression.codec.fastlz.buffersize", 64*1024));
+  }
+
+  public String getDefaultExtension() {
+    return ".flz";
+  }
+
+}
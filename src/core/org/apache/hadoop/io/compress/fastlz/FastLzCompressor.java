@@ -0,0 +1,222 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.io.compress.fastlz;
+
+import java.io.IOException;
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+
+import org.apache.hadoop.io.compress.Compressor;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+/**
+ * A {@link Compressor} based on the fast LZ block format in the native
+ * library. Considerably faster than zlib at a modest loss of ratio,
+ * which is the right trade for shuffle and other temporary data. A
+ * whole block is compressed per native call, so it must be used with
+ * {@link org.apache.hadoop.io.compress.BlockCompressorStream}.
+ */
+public class FastLzCompressor implements Compressor {
+  private static final int DEFAULT_DIRECT_BUFFER_SIZE = 64*1024;
+
+  // HACK - Use this as a global lock in the JNI layer
+  private static Class clazz = FastLzCompressor.class;
+
+  private int directBufferSize;
+  private Buffer uncompressedDirectBuf = null;
+  private int uncompressedDirectBufLen;
+  private Buffer compressedDirectBuf = null;
+  private byte[] userBuf = null;
+  private int userBufOff = 0, userBufLen = 0;
+  private boolean finish, finished;
+  private long bytesRead = 0L;
+  private long bytesWritten = 0L;
+
+  private static boolean nativeFastLzLoaded = false;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        // Initialize the native library
+        initIDs();
+        nativeFastLzLoaded = true;
+      } catch (Throwable t) {
+        // Ignore failure to load/initialize native-fastlz
+      }
+    }
+  }
+
+  static boolean isNativeFastLzLoaded() {
+    return nativeFastLzLoaded;
+  }
+
+  /**
+   * The maximum number of bytes a block of the given size can
+   * compress to, for sizing the framing stream's buffer.
+   */
+  public static int maxCompressedLength(int len) {
+    return len + (len >> 5) + 2;
+  }
+
+  /**
+   * Creates a new compressor with the given block size.
+   */
+  public FastLzCompressor(int directBufferSize) {
+    this.directBufferSize = directBufferSize;
+    uncompressedDirectBuf = ByteBuffer.allocateDirect(directBufferSize);
+    compressedDirectBuf =
+      ByteBuffer.allocateDirect(maxCompressedLength(directBufferSize));
+    compressedDirectBuf.position(maxCompressedLength(directBufferSize));
+  }
+
+  public FastLzCompressor() {
+    this(DEFAULT_DIRECT_BUFFER_SIZE);
+  }
+
+  public synchronized void setInput(byte[] b, int off, int len) {
+    if (b == null) {
+      throw new NullPointerException();
+    }
+    if (off < 0 || len < 0 || off > b.length - len) {
+      throw new ArrayIndexOutOfBoundsException();
+    }
+    finished = false;
+
+    if (len > uncompressedDirectBuf.remaining()) {
+      // save the data; it will be fed to the block buffer as it drains
+      this.userBuf = b;
+      this.userBufOff = off;
+      this.userBufLen = len;
+    } else {
+      ((ByteBuffer)uncompressedDirectBuf).put(b, off, len);
+      uncompressedDirectBufLen = uncompressedDirectBuf.position();
+    }
+
+    bytesRead += len;
+  }
+
+  synchronized void setInputFromSavedData() {
+    if (userBufLen <= 0) {
+      return;
+    }
+
+    int len = Math.min(userBufLen, uncompressedDirectBuf.remaining());
+    ((ByteBuffer)uncompressedDirectBuf).put(userBuf, userBufOff, len);
+    uncompressedDirectBufLen = uncompressedDirectBuf.position();
+    userBufOff += len;
+    userBufLen -= len;
+  }
+
+  public synchronized void setDictionary(byte[] b, int off, int len) {
+    // nothing to do - the format has no preset dictionary
+  }
+
+  public synchronized boolean needsInput() {
+    // still-buffered output, a full block or saved user data all mean no
+    return !(compressedDirectBuf.remaining() > 0 ||
+             uncompressedDirectBuf.remaining() == 0 ||
+             userBufLen > 0);
+  }
+
+  public synchronized void finish() {
+    finish = true;
+  }
+
+  public synchronized boolean finished() {
+    // all input consumed and all output handed out
+    return (finish && finished && compressedDirectBuf.remaining() == 0);
+  }
+
+  public synchronized int compress(byte[] b, int off, int len)
+    throws IOException {
+    if (b == null) {
+      throw new NullPointerException();
+    }
+    if (off < 0 || len < 0 || off > b.length - len) {
+      throw new ArrayIndexOutOfBoundsException();
+    }
+
+    // Check if there is compressed data
+    int n = compressedDirectBuf.remaining();
+    if (n > 0) {
+      n = Math.min(n, len);
+      ((ByteBuffer)compressedDirectBuf).get(b, off, n);
+      bytesWritten += n;
+      return n;
+    }
+
+    // Re-initialize the output direct buffer
+    compressedDirectBuf.rewind();
+    compressedDirectBuf.limit(maxCompressedLength(directBufferSize));
+
+    if (uncompressedDirectBufLen == 0) {
+      setInputFromSavedData();
+      if (uncompressedDirectBufLen == 0) {
+        // no more input to consume
+        finished = true;
+        compressedDirectBuf.limit(0);
+        return 0;
+      }
+    }
+
+    // Compress one whole block
+    n = compressBytesDirect();
+    compressedDirectBuf.limit(n);
+    uncompressedDirectBuf.clear();
+
+    // Get atmost 'len' bytes
+    n = Math.min(n, len);
+    ((ByteBuffer)compressedDirectBuf).get(b, off, n);
+    bytesWritten += n;
+
+    return n;
+  }
+
+  public synchronized void reset() {
+    finish = false;
+    finished = false;
+    uncompressedDirectBuf.clear();
+    uncompressedDirectBufLen = 0;
+    compressedDirectBuf.limit(maxCompressedLength(directBufferSize));
+    compressedDirectBuf.position(maxCompressedLength(directBufferSize));
+    userBufOff = userBufLen = 0;
+    bytesRead = bytesWritten = 0L;
+  }
+
+  /**
+   * Return number of uncompressed bytes input so far; the block
+   * framing stream uses this as the uncompressed length header.
+   */
+  public synchronized long getBytesRead() {
+    return bytesRead;
+  }
+
+  /**
+   * Return number of compressed bytes output so far.
+   */
+  public synchronized long getBytesWritten() {
+    return bytesWritten;
+  }
+
+  public synchronized void end() {
+  }
+
+  private native static void initIDs();
+  private native int compressBytesDirect();
+}
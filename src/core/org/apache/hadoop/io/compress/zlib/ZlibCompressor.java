@@ -259,6 +259,26 @@ public class ZlibCompressor implements Compressor {
     setDictionary(stream, b, off, len);
   }
 
+  /**
+   * Loads a preset dictionary for the lifetime of this compressor.
+   * Unlike {@link #setDictionary(byte[], int, int)}, which only affects
+   * the stream currently in progress, a preset dictionary is kept by the
+   * native side and re-applied after every {@link #reset()}, so a pooled
+   * compressor carries a trained dictionary across the many small blocks
+   * of a shuffle without a per-block dictionary call. The decompressing
+   * side must load the same dictionary via
+   * {@link ZlibDecompressor#setPresetDictionary(byte[], int, int)}.
+   */
+  public synchronized void setPresetDictionary(byte[] b, int off, int len) {
+    if (stream == 0 || b == null) {
+      throw new NullPointerException();
+    }
+    if (off < 0 || len < 0 || off > b.length - len) {
+      throw new ArrayIndexOutOfBoundsException();
+    }
+    setPresetDictionary(stream, b, off, len);
+  }
+
   public boolean needsInput() {
     // Consume remaining compressed data?
     if (compressedDirectBuf.remaining() > 0) {
@@ -370,6 +390,8 @@ public class ZlibCompressor implements Compressor {
   private native static long init(int level, int strategy, int windowBits);
   private native static void setDictionary(long strm, byte[] b, int off,
                                            int len);
+  private native static void setPresetDictionary(long strm, byte[] b, int off,
+                                                 int len);
   private native int deflateBytesDirect();
   private native static long getBytesRead(long strm);
   private native static long getBytesWritten(long strm);
@@ -105,15 +105,34 @@ public class ZlibDecompressor implements Decompressor {
    * Creates a new decompressor.
    */
   public ZlibDecompressor(CompressionHeader header, int directBufferSize) {
+    this(header, directBufferSize, false);
+  }
+
+  /**
+   * Creates a new decompressor, optionally in 'concatenated' mode for
+   * input made of back-to-back gzip members (as produced by appending
+   * gzip'ed files together). In that mode the native side consumes the
+   * next member's header and keeps inflating within the same call when
+   * a member ends with input remaining, instead of requiring a reset
+   * round trip per member; {@link #finished()} only becomes true when
+   * a member ends with no input left over. Only meaningful with
+   * {@link CompressionHeader#GZIP_FORMAT} or
+   * {@link CompressionHeader#AUTODETECT_GZIP_ZLIB}.
+   */
+  public ZlibDecompressor(CompressionHeader header, int directBufferSize,
+                          boolean concatenated) {
     this.header = header;
     this.directBufferSize = directBufferSize;
     compressedDirectBuf = ByteBuffer.allocateDirect(directBufferSize);
     uncompressedDirectBuf = ByteBuffer.allocateDirect(directBufferSize);
     uncompressedDirectBuf.position(directBufferSize);
-    
+
     stream = init(this.header.windowBits());
+    if (concatenated) {
+      setConcatenated(stream, true);
+    }
   }
-  
+
   public ZlibDecompressor() {
     this(CompressionHeader.DEFAULT_HEADER, DEFAULT_DIRECT_BUFFER_SIZE);
   }
@@ -165,6 +184,25 @@ public class ZlibDecompressor implements Decompressor {
     needDict = false;
   }
 
+  /**
+   * Loads a preset dictionary for the lifetime of this decompressor.
+   * The native side keeps a copy and applies it itself whenever a
+   * stream asks for it, so {@link #needsDictionary()} never trips and
+   * inflation continues within the same call; the dictionary also
+   * survives {@link #reset()}. Must match the dictionary loaded on the
+   * compressing side via
+   * {@link ZlibCompressor#setPresetDictionary(byte[], int, int)}.
+   */
+  public synchronized void setPresetDictionary(byte[] b, int off, int len) {
+    if (stream == 0 || b == null) {
+      throw new NullPointerException();
+    }
+    if (off < 0 || len < 0 || off > b.length - len) {
+      throw new ArrayIndexOutOfBoundsException();
+    }
+    setPresetDictionary(stream, b, off, len);
+  }
+
   public synchronized boolean needsInput() {
     // Consume remanining compressed data?
     if (uncompressedDirectBuf.remaining() > 0) {
@@ -227,7 +265,43 @@ public class ZlibDecompressor implements Decompressor {
 
     return n;
   }
-  
+
+  /**
+   * Decompresses into a chain of caller-supplied direct buffers in a
+   * single native call, so a full decompressed block lands where the
+   * reader will consume it with no intermediate copies. Each buffer is
+   * filled from index 0; on return its position is 0 and its limit is
+   * the number of bytes placed in it (0 for untouched buffers). Only
+   * data already fed to the native input buffer via {@link #setInput}
+   * is consumed.
+   *
+   * @param dsts the destination buffers, filled in order
+   * @return the total number of decompressed bytes placed in the chain
+   */
+  public synchronized int decompressDirect(ByteBuffer[] dsts)
+    throws IOException {
+    if (dsts == null) {
+      throw new NullPointerException();
+    }
+    for (int i = 0; i < dsts.length; i++) {
+      if (dsts[i] == null || !dsts[i].isDirect()) {
+        throw new IllegalArgumentException("destination is not a direct buffer");
+      }
+    }
+
+    int n = inflateBytesDirectChain(dsts);
+
+    // the native side fills the segments in order from index 0
+    int remaining = n;
+    for (int i = 0; i < dsts.length; i++) {
+      int filled = Math.min(remaining, dsts[i].capacity());
+      dsts[i].position(0);
+      dsts[i].limit(filled);
+      remaining -= filled;
+    }
+    return n;
+  }
+
   /**
    * Returns the total number of compressed bytes output so far.
    *
@@ -277,9 +351,13 @@ public class ZlibDecompressor implements Decompressor {
   
   private native static void initIDs();
   private native static long init(int windowBits);
+  private native static void setConcatenated(long strm, boolean concatenated);
   private native static void setDictionary(long strm, byte[] b, int off,
                                            int len);
+  private native static void setPresetDictionary(long strm, byte[] b, int off,
+                                                 int len);
   private native int inflateBytesDirect();
+  private native int inflateBytesDirectChain(ByteBuffer[] dsts);
   private native static long getBytesRead(long strm);
   private native static long getBytesWritten(long strm);
   private native static void reset(long strm);
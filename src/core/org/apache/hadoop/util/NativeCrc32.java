@@ -0,0 +1,124 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.util;
+
+import java.nio.ByteBuffer;
+
+import org.apache.hadoop.fs.ChecksumException;
+
+/**
+ * Bulk native checksumming of direct buffers. One call verifies or
+ * calculates the checksums of a whole run of 512-byte (or whatever
+ * bytes-per-sum is in use) chunks, so the per-chunk cost is a table or
+ * hardware CRC rather than a JNI crossing. CRC32C additionally uses
+ * the SSE4.2 crc32 instruction when the CPU provides it.
+ */
+public class NativeCrc32 {
+
+  /** The checksum types understood by the native side. */
+  public static final int CHECKSUM_CRC32 = 0;
+  public static final int CHECKSUM_CRC32C = 1;
+
+  private static final boolean nativeLoaded;
+
+  static {
+    boolean loaded = false;
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        initNative();
+        loaded = true;
+      } catch (Throwable t) {
+        // Ignore failure to load/initialize the native checksummer
+      }
+    }
+    nativeLoaded = loaded;
+  }
+
+  /**
+   * Whether the native checksummer is usable in this process.
+   */
+  public static boolean isAvailable() {
+    return nativeLoaded;
+  }
+
+  /**
+   * Whether CRC32C is computed by the hardware instruction.
+   */
+  public static boolean isHardwareCrc32CAvailable() {
+    return nativeLoaded && isHardwareCrc32C();
+  }
+
+  /**
+   * Verify the checksums of all chunks in the given range of data in
+   * one native call.
+   *
+   * @param bytesPerSum number of data bytes covered by each checksum
+   * @param checksumType one of CHECKSUM_CRC32 and CHECKSUM_CRC32C
+   * @param sums direct buffer of big-endian 4-byte sums, one per chunk
+   * @param sumsOff offset of the first checksum in sums
+   * @param data direct buffer holding the chunk data
+   * @param dataOff offset of the first data byte
+   * @param dataLen number of data bytes (the last chunk may be short)
+   * @param fileName name reported in the exception on a mismatch
+   * @param basePos file position of the first data byte, for reporting
+   * @throws ChecksumException if any chunk fails to verify
+   */
+  public static void verifyChunkedSums(int bytesPerSum, int checksumType,
+      ByteBuffer sums, int sumsOff, ByteBuffer data, int dataOff, int dataLen,
+      String fileName, long basePos) throws ChecksumException {
+    checkBuffers(sums, data);
+    long badChunk = nativeVerifyChunkedSums(bytesPerSum, checksumType,
+        sums, sumsOff, data, dataOff, dataLen);
+    if (badChunk >= 0) {
+      long badPos = basePos + badChunk * bytesPerSum;
+      throw new ChecksumException("Checksum error: " + fileName +
+          " at " + badPos, badPos);
+    }
+  }
+
+  /**
+   * Calculate the checksums of all chunks in the given range of data
+   * in one native call, writing one big-endian 4-byte sum per chunk.
+   */
+  public static void calculateChunkedSums(int bytesPerSum, int checksumType,
+      ByteBuffer sums, int sumsOff, ByteBuffer data, int dataOff,
+      int dataLen) {
+    checkBuffers(sums, data);
+    nativeCalculateChunkedSums(bytesPerSum, checksumType,
+        sums, sumsOff, data, dataOff, dataLen);
+  }
+
+  private static void checkBuffers(ByteBuffer sums, ByteBuffer data) {
+    if (!nativeLoaded) {
+      throw new UnsupportedOperationException(
+          "Native checksumming is not available");
+    }
+    if (!sums.isDirect() || !data.isDirect()) {
+      throw new IllegalArgumentException("not a direct buffer");
+    }
+  }
+
+  private native static void initNative();
+  private native static boolean isHardwareCrc32C();
+  private native static long nativeVerifyChunkedSums(int bytesPerSum,
+      int checksumType, ByteBuffer sums, int sumsOff, ByteBuffer data,
+      int dataOff, int dataLen);
+  private native static void nativeCalculateChunkedSums(int bytesPerSum,
+      int checksumType, ByteBuffer sums, int sumsOff, ByteBuffer data,
+      int dataOff, int dataLen);
+}
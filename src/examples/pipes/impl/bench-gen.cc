@@ -0,0 +1,462 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hadoop/CompressUtils.hh"
+#include "hadoop/SerialUtils.hh"
+#include "hadoop/StringUtils.hh"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+/*
+ * Generate a synthetic binary downlink session for the pipes benchmark
+ * programs (wordcount-bench, pipes-sort-bench). The output file replays
+ * through HadoopPipes::runBenchmark without a Java parent, so every
+ * pipes runtime change can be measured against the same workload.
+ *
+ * Line lengths, key cardinality and key skew are configurable, which
+ * covers the shapes that matter for wordcount (many small records,
+ * repeated keys) and sort (fewer large records, mostly unique keys).
+ */
+
+/**
+ * The downlink message codes. These mirror the BinaryProtocol wire
+ * format in HadoopPipes.cc and must be kept in sync with it.
+ */
+enum MESSAGE_TYPE {START_MESSAGE, SET_JOB_CONF, SET_INPUT_TYPES, RUN_MAP,
+                   MAP_ITEM, RUN_REDUCE, REDUCE_KEY, REDUCE_VALUE,
+                   CLOSE, ABORT,
+                   MAP_ITEM_BATCH, REDUCE_VALUE_BATCH, COMPRESSED_BLOCK};
+
+/**
+ * An OutStream that collects the session into blocks and writes each
+ * one to the file as a COMPRESSED_BLOCK frame. The session writer calls
+ * endMessage after every complete message, so blocks only break at
+ * message boundaries the way the framework's downlink does.
+ */
+class BlockOutStream: public HadoopUtils::OutStream {
+private:
+  static const size_t BLOCK_SIZE = 64 * 1024;
+  HadoopUtils::FileOutStream& file;
+  std::string block;
+  std::string compressed;
+
+  void flushBlock() {
+    if (block.empty()) {
+      return;
+    }
+    HadoopUtils::lzCompress(block.data(), block.length(), compressed);
+    HadoopUtils::serializeInt(COMPRESSED_BLOCK, file);
+    HadoopUtils::serializeInt(block.length(), file);
+    HadoopUtils::serializeInt(compressed.length(), file);
+    file.write(compressed.data(), compressed.length());
+    block.clear();
+  }
+
+public:
+  BlockOutStream(HadoopUtils::FileOutStream& _file): file(_file) {}
+
+  virtual void write(const void* buf, size_t len) {
+    block.append((const char*) buf, len);
+  }
+
+  /** Flush the block once enough message bytes have accumulated. */
+  void endMessage() {
+    if (block.length() >= BLOCK_SIZE) {
+      flushBlock();
+    }
+  }
+
+  virtual void flush() {
+    flushBlock();
+    file.flush();
+  }
+};
+
+/**
+ * A small deterministic generator, so the same seed always produces the
+ * same session regardless of the platform's rand implementation.
+ */
+class Random {
+private:
+  uint64_t state;
+public:
+  Random(uint64_t seed): state(seed ? seed : 1) {}
+
+  uint64_t next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  /** A double uniform in [0.0, 1.0). */
+  double nextDouble() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  /** An int uniform in [lo, hi]. */
+  int nextInt(int lo, int hi) {
+    if (hi <= lo) {
+      return lo;
+    }
+    return lo + (int) (next() % (uint64_t) (hi - lo + 1));
+  }
+};
+
+class SessionWriter {
+private:
+  HadoopUtils::OutStream& out;
+  BlockOutStream* blockOut;
+  Random random;
+  int cardinality;
+  double skew;
+  int minLen;
+  int maxLen;
+  int batch;
+  bool firstTask;
+  std::vector<std::string> batchKeys;
+  std::vector<std::string> batchValues;
+  uint64_t records;
+  uint64_t recordBytes;
+
+  /**
+   * Pick a key rank in [0, cardinality). With skew 0 the ranks are
+   * uniform; larger exponents concentrate the draws on the low ranks,
+   * approximating a zipf-like distribution without the cost of exact
+   * sampling.
+   */
+  int nextRank() {
+    if (skew <= 0) {
+      return random.nextInt(0, cardinality - 1);
+    }
+    return (int) (cardinality * pow(random.nextDouble(), skew + 1));
+  }
+
+  std::string keyForRank(int rank) {
+    return "word-" + HadoopUtils::toString(rank);
+  }
+
+  /** Mark a message boundary, where a compressed block may end. */
+  void endMessage() {
+    if (blockOut != NULL) {
+      blockOut->endMessage();
+    }
+  }
+
+  /**
+   * Build a line of skewed dictionary words whose length falls in
+   * [minLen, maxLen].
+   */
+  std::string nextLine() {
+    int target = random.nextInt(minLen, maxLen);
+    std::string line;
+    while ((int) line.length() < target) {
+      if (!line.empty()) {
+        line += " ";
+      }
+      line += keyForRank(nextRank());
+    }
+    return line;
+  }
+
+  void flushMapBatch() {
+    if (batchKeys.empty()) {
+      return;
+    }
+    HadoopUtils::serializeInt(MAP_ITEM_BATCH, out);
+    HadoopUtils::serializeInt(batchKeys.size(), out);
+    for(unsigned int i=0; i < batchKeys.size(); ++i) {
+      HadoopUtils::serializeString(batchKeys[i], out);
+      HadoopUtils::serializeString(batchValues[i], out);
+    }
+    batchKeys.clear();
+    batchValues.clear();
+    endMessage();
+  }
+
+  void flushReduceBatch() {
+    if (batchValues.empty()) {
+      return;
+    }
+    HadoopUtils::serializeInt(REDUCE_VALUE_BATCH, out);
+    HadoopUtils::serializeInt(batchValues.size(), out);
+    for(unsigned int i=0; i < batchValues.size(); ++i) {
+      HadoopUtils::serializeString(batchValues[i], out);
+    }
+    batchValues.clear();
+    endMessage();
+  }
+
+  void mapItem(const std::string& key, const std::string& value) {
+    records += 1;
+    recordBytes += key.length() + value.length();
+    if (batch > 0) {
+      batchKeys.push_back(key);
+      batchValues.push_back(value);
+      if ((int) batchKeys.size() >= batch) {
+        flushMapBatch();
+      }
+    } else {
+      HadoopUtils::serializeInt(MAP_ITEM, out);
+      HadoopUtils::serializeString(key, out);
+      HadoopUtils::serializeString(value, out);
+      endMessage();
+    }
+  }
+
+  void reduceValue(const std::string& value) {
+    records += 1;
+    recordBytes += value.length();
+    if (batch > 0) {
+      batchValues.push_back(value);
+      if ((int) batchValues.size() >= batch) {
+        flushReduceBatch();
+      }
+    } else {
+      HadoopUtils::serializeInt(REDUCE_VALUE, out);
+      HadoopUtils::serializeString(value, out);
+      endMessage();
+    }
+  }
+
+  void writePreamble(const std::vector<std::string>& conf) {
+    if (firstTask) {
+      // the version is negotiated once per connection; later tasks of a
+      // reused worker begin directly at SET_JOB_CONF
+      int version = 0;
+      if (blockOut != NULL) {
+        version = 2;
+      } else if (batch > 0) {
+        version = 1;
+      }
+      HadoopUtils::serializeInt(START_MESSAGE, out);
+      HadoopUtils::serializeInt(version, out);
+      endMessage();
+      firstTask = false;
+    }
+    HadoopUtils::serializeInt(SET_JOB_CONF, out);
+    HadoopUtils::serializeInt(conf.size(), out);
+    for(unsigned int i=0; i < conf.size(); ++i) {
+      HadoopUtils::serializeString(conf[i], out);
+    }
+    endMessage();
+  }
+
+public:
+  SessionWriter(HadoopUtils::OutStream& _out, BlockOutStream* _blockOut,
+                uint64_t seed, int _cardinality, double _skew, int _minLen,
+                int _maxLen, int _batch)
+    : out(_out), blockOut(_blockOut), random(seed), cardinality(_cardinality),
+      skew(_skew), minLen(_minLen), maxLen(_maxLen), batch(_batch),
+      firstTask(true), records(0), recordBytes(0) {
+  }
+
+  uint64_t getRecords() const { return records; }
+  uint64_t getRecordBytes() const { return recordBytes; }
+
+  /**
+   * Write a map task session: the records arrive as (offset, line)
+   * pairs the way the Java line record reader would deliver them.
+   */
+  void writeMapSession(uint64_t numRecords, int numReduces,
+                       const std::vector<std::string>& conf) {
+    writePreamble(conf);
+    HadoopUtils::serializeInt(SET_INPUT_TYPES, out);
+    HadoopUtils::serializeString("org.apache.hadoop.io.LongWritable", out);
+    HadoopUtils::serializeString("org.apache.hadoop.io.Text", out);
+    endMessage();
+    HadoopUtils::serializeInt(RUN_MAP, out);
+    HadoopUtils::serializeString("synthetic-split", out);
+    HadoopUtils::serializeInt(numReduces, out);
+    HadoopUtils::serializeInt(1, out);
+    endMessage();
+    uint64_t offset = 0;
+    for(uint64_t i=0; i < numRecords; ++i) {
+      std::string value = nextLine();
+      mapItem(HadoopUtils::toString(offset), value);
+      offset += value.length() + 1;
+    }
+    flushMapBatch();
+    HadoopUtils::serializeInt(CLOSE, out);
+    endMessage();
+  }
+
+  /**
+   * Write a reduce task session: the values are grouped under their
+   * keys the way the Java sort delivers them, with the per-key value
+   * counts following the same skew as the map-side keys. A fixed value
+   * may be given for reducers that parse their input, such as the "1"
+   * counts that wordcount sums.
+   */
+  void writeReduceSession(uint64_t numRecords, const std::string& fixedValue,
+                          const std::vector<std::string>& conf) {
+    writePreamble(conf);
+    HadoopUtils::serializeInt(RUN_REDUCE, out);
+    HadoopUtils::serializeInt(0, out);
+    HadoopUtils::serializeInt(1, out);
+    endMessage();
+    // weight the per-key value counts like the key ranks: weight
+    // 1/(rank+1)^skew, scaled so the counts sum to numRecords
+    double totalWeight = 0;
+    std::vector<double> weights(cardinality);
+    for(int rank=0; rank < cardinality; ++rank) {
+      weights[rank] = skew > 0 ? pow(rank + 1.0, -skew) : 1.0;
+      totalWeight += weights[rank];
+    }
+    uint64_t emitted = 0;
+    for(int rank=0; rank < cardinality && emitted < numRecords; ++rank) {
+      uint64_t count = (uint64_t) (numRecords * weights[rank] / totalWeight);
+      if (count == 0 || rank == cardinality - 1) {
+        count = (count == 0) ? 1 : numRecords - emitted;
+      }
+      if (count > numRecords - emitted) {
+        count = numRecords - emitted;
+      }
+      HadoopUtils::serializeInt(REDUCE_KEY, out);
+      HadoopUtils::serializeString(keyForRank(rank), out);
+      endMessage();
+      for(uint64_t i=0; i < count; ++i) {
+        reduceValue(fixedValue.empty() ? nextLine() : fixedValue);
+      }
+      flushReduceBatch();
+      emitted += count;
+    }
+    HadoopUtils::serializeInt(CLOSE, out);
+    endMessage();
+  }
+
+  /**
+   * Close the idle connection after the last task of a reused worker;
+   * the framework exits the reuse loop without another done frame.
+   */
+  void writeShutdown() {
+    HadoopUtils::serializeInt(CLOSE, out);
+    endMessage();
+  }
+};
+
+static void usage(const char* name) {
+  fprintf(stderr,
+          "usage: %s [options] <output-file>\n"
+          "  -p map|reduce  the session phase to generate (default map)\n"
+          "  -n records     the number of records (default 1000000)\n"
+          "  -l length      the minimum line length (default 20)\n"
+          "  -L length      the maximum line length (default 100)\n"
+          "  -k cardinality the number of distinct keys (default 10000)\n"
+          "  -z exponent    the key skew; 0 is uniform (default 0)\n"
+          "  -b records     batch size; 0 sends unbatched items (default 0)\n"
+          "  -c             frame the session into compressed blocks\n"
+          "  -t tasks       tasks per session; more than one records a\n"
+          "                 reused worker serving them back to back\n"
+          "  -r reduces     the number of reduces for map sessions (default 1)\n"
+          "  -v value       a fixed reduce value, such as 1 for wordcount\n"
+          "  -s seed        the random seed (default 42)\n"
+          "  -D key=value   add a job conf entry (repeatable)\n",
+          name);
+}
+
+int main(int argc, char *argv[]) {
+  std::string phase = "map";
+  uint64_t numRecords = 1000000;
+  int minLen = 20;
+  int maxLen = 100;
+  int cardinality = 10000;
+  double skew = 0;
+  int batch = 0;
+  bool compress = false;
+  int tasks = 1;
+  int numReduces = 1;
+  std::string fixedValue;
+  uint64_t seed = 42;
+  std::vector<std::string> conf;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:n:l:L:k:z:b:ct:r:v:s:D:")) != -1) {
+    switch (opt) {
+    case 'p': phase = optarg; break;
+    case 'n': numRecords = strtoull(optarg, NULL, 10); break;
+    case 'l': minLen = atoi(optarg); break;
+    case 'L': maxLen = atoi(optarg); break;
+    case 'k': cardinality = atoi(optarg); break;
+    case 'z': skew = atof(optarg); break;
+    case 'b': batch = atoi(optarg); break;
+    case 'c': compress = true; break;
+    case 't': tasks = atoi(optarg); break;
+    case 'r': numReduces = atoi(optarg); break;
+    case 'v': fixedValue = optarg; break;
+    case 's': seed = strtoull(optarg, NULL, 10); break;
+    case 'D': {
+      std::string entry = optarg;
+      std::string::size_type eq = entry.find('=');
+      if (eq == std::string::npos) {
+        fprintf(stderr, "bad conf entry, expected key=value: %s\n", optarg);
+        return 1;
+      }
+      conf.push_back(entry.substr(0, eq));
+      conf.push_back(entry.substr(eq + 1));
+      break;
+    }
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (optind != argc - 1 || cardinality < 1 || minLen < 1 ||
+      maxLen < minLen || tasks < 1 ||
+      (phase != "map" && phase != "reduce")) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (tasks > 1) {
+    conf.push_back("hadoop.pipes.worker.reuse");
+    conf.push_back("true");
+  }
+  std::string filename = argv[optind];
+  HadoopUtils::FileOutStream out;
+  if (!out.open(filename, true)) {
+    fprintf(stderr, "can't open %s for writing\n", filename.c_str());
+    return 1;
+  }
+  BlockOutStream blockOut(out);
+  SessionWriter writer(compress ? (HadoopUtils::OutStream&) blockOut : out,
+                       compress ? &blockOut : NULL, seed, cardinality, skew,
+                       minLen, maxLen, batch);
+  for(int task=0; task < tasks; ++task) {
+    if (phase == "map") {
+      writer.writeMapSession(numRecords, numReduces, conf);
+    } else {
+      writer.writeReduceSession(numRecords, fixedValue, conf);
+    }
+  }
+  if (tasks > 1) {
+    writer.writeShutdown();
+  }
+  if (compress) {
+    blockOut.flush();
+  }
+  out.close();
+  fprintf(stderr, "wrote %llu %s records (%llu bytes) to %s\n",
+          (unsigned long long) writer.getRecords(), phase.c_str(),
+          (unsigned long long) writer.getRecordBytes(), filename.c_str());
+  return 0;
+}
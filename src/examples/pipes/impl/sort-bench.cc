@@ -0,0 +1,158 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hadoop/Pipes.hh"
+#include "hadoop/TemplateFactory.hh"
+#include "hadoop/SortUtils.hh"
+
+#include <stdio.h>
+
+/*
+ * The pipes-sort pipeline driven by a recorded or generated downlink
+ * session instead of a Java parent, reporting records/s and
+ * per-message-type timings on stderr. The map side sorts through the
+ * external sort engine the way the pipes-sort example does, so this
+ * also measures run generation and the loser-tree merge; size the sort
+ * buffer with -D hadoop.sort.external.mb=<n> and thin the record
+ * stream with -D hadoop.sort.map.keep.percent=<n> when generating
+ * sessions with pipes-bench-gen.
+ */
+
+/**
+ * Emits the sorted stream through the task context.
+ */
+class ContextSink: public HadoopUtils::RecordSink {
+private:
+  HadoopPipes::MapContext* context;
+public:
+  ContextSink(HadoopPipes::MapContext* _context): context(_context) {}
+
+  virtual void sorted(const std::string& key, const std::string& value) {
+    context->emit(key, value);
+  }
+};
+
+class SortMap: public HadoopPipes::Mapper {
+private:
+  /* the fraction 0.0 to 1.0 of records to keep */
+  float keepFraction;
+  /* the number of records kept so far */
+  long long keptRecords;
+  /* the total number of records */
+  long long totalRecords;
+  HadoopUtils::ExternalSorter* sorter;
+  HadoopPipes::MapContext* lastContext;
+  static const std::string MAP_KEEP_PERCENT;
+  static const std::string SORT_MEGABYTES;
+  static const std::string SORT_DIR;
+public:
+  /*
+   * Look in the config to find the fraction of records to keep and
+   * the sort buffer size and spill directory.
+   */
+  SortMap(HadoopPipes::TaskContext& context){
+    const HadoopPipes::JobConf* conf = context.getJobConf();
+    if (conf->hasKey(MAP_KEEP_PERCENT)) {
+      keepFraction = conf->getFloat(MAP_KEEP_PERCENT) / 100.0;
+    } else {
+      keepFraction = 1.0;
+    }
+    keptRecords = 0;
+    totalRecords = 0;
+    int megabytes = conf->hasKey(SORT_MEGABYTES)
+      ? conf->getInt(SORT_MEGABYTES) : 64;
+    std::string dir = conf->hasKey(SORT_DIR) ? conf->get(SORT_DIR) : ".";
+    sorter = new HadoopUtils::ExternalSorter((size_t) megabytes * 1024 * 1024,
+                                             dir);
+    lastContext = NULL;
+  }
+
+  void map(HadoopPipes::MapContext& context) {
+    lastContext = &context;
+    totalRecords += 1;
+    while ((float) keptRecords / totalRecords < keepFraction) {
+      keptRecords += 1;
+      sorter->add(context.getInputKey(), context.getInputValue());
+    }
+  }
+
+  /*
+   * Merge the sorted runs and emit the records in key order.
+   */
+  void close() {
+    if (lastContext != NULL) {
+      ContextSink sink(lastContext);
+      sorter->sort(sink);
+      fprintf(stderr, "sorted %llu records with %llu spills\n",
+              (unsigned long long) sorter->getRecords(),
+              (unsigned long long) sorter->getSpills());
+    }
+  }
+
+  ~SortMap() {
+    delete sorter;
+  }
+};
+
+const std::string SortMap::MAP_KEEP_PERCENT("hadoop.sort.map.keep.percent");
+const std::string SortMap::SORT_MEGABYTES("hadoop.sort.external.mb");
+const std::string SortMap::SORT_DIR("hadoop.sort.external.dir");
+
+class SortReduce: public HadoopPipes::Reducer {
+private:
+  /* the fraction 0.0 to 1.0 of records to keep */
+  float keepFraction;
+  /* the number of records kept so far */
+  long long keptRecords;
+  /* the total number of records */
+  long long totalRecords;
+  static const std::string REDUCE_KEEP_PERCENT;
+public:
+  SortReduce(HadoopPipes::TaskContext& context){
+    const HadoopPipes::JobConf* conf = context.getJobConf();
+    if (conf->hasKey(REDUCE_KEEP_PERCENT)) {
+      keepFraction = conf->getFloat(REDUCE_KEEP_PERCENT) / 100.0;
+    } else {
+      keepFraction = 1.0;
+    }
+    keptRecords = 0;
+    totalRecords = 0;
+  }
+
+  void reduce(HadoopPipes::ReduceContext& context) {
+    while (context.nextValue()) {
+      totalRecords += 1;
+      while ((float) keptRecords / totalRecords < keepFraction) {
+        keptRecords += 1;
+        context.emit(context.getInputKey(), context.getInputValue());
+      }
+    }
+  }
+};
+
+const std::string
+  SortReduce::REDUCE_KEEP_PERCENT("hadoop.sort.reduce.keep.percent");
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <downlink-session-file>\n", argv[0]);
+    return 1;
+  }
+  return !HadoopPipes::runBenchmark(
+           HadoopPipes::TemplateFactory<SortMap, SortReduce>(), argv[1]);
+}
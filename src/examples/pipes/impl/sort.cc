@@ -18,6 +18,30 @@
 
 #include "hadoop/Pipes.hh"
 #include "hadoop/TemplateFactory.hh"
+#include "hadoop/SortUtils.hh"
+
+/*
+ * The mapper sorts its records C++-side with the external sort engine
+ * in libhadooputils: the sampled records are buffered into an
+ * ExternalSorter, which spills sorted runs to local disk when the
+ * buffer fills, and at close the merged stream is emitted in key
+ * order. Each map's output therefore reaches the framework already
+ * sorted, leaving the Java side a pure merge.
+ */
+
+/**
+ * Emits the sorted stream through the task context.
+ */
+class ContextSink: public HadoopUtils::RecordSink {
+private:
+  HadoopPipes::MapContext* context;
+public:
+  ContextSink(HadoopPipes::MapContext* _context): context(_context) {}
+
+  virtual void sorted(const std::string& key, const std::string& value) {
+    context->emit(key, value);
+  }
+};
 
 class SortMap: public HadoopPipes::Mapper {
 private:
@@ -27,10 +51,15 @@ private:
   long long keptRecords;
   /* the total number of records */
   long long totalRecords;
+  HadoopUtils::ExternalSorter* sorter;
+  HadoopPipes::MapContext* lastContext;
   static const std::string MAP_KEEP_PERCENT;
+  static const std::string SORT_MEGABYTES;
+  static const std::string SORT_DIR;
 public:
   /*
-   * Look in the config to find the fraction of records to keep.
+   * Look in the config to find the fraction of records to keep and
+   * the sort buffer size and spill directory.
    */
   SortMap(HadoopPipes::TaskContext& context){
     const HadoopPipes::JobConf* conf = context.getJobConf();
@@ -41,18 +70,41 @@ public:
     }
     keptRecords = 0;
     totalRecords = 0;
+    int megabytes = conf->hasKey(SORT_MEGABYTES)
+      ? conf->getInt(SORT_MEGABYTES) : 64;
+    std::string dir = conf->hasKey(SORT_DIR) ? conf->get(SORT_DIR) : ".";
+    sorter = new HadoopUtils::ExternalSorter((size_t) megabytes * 1024 * 1024,
+                                             dir);
+    lastContext = NULL;
   }
 
   void map(HadoopPipes::MapContext& context) {
+    lastContext = &context;
     totalRecords += 1;
     while ((float) keptRecords / totalRecords < keepFraction) {
       keptRecords += 1;
-      context.emit(context.getInputKey(), context.getInputValue());
+      sorter->add(context.getInputKey(), context.getInputValue());
     }
   }
+
+  /*
+   * Merge the sorted runs and emit the records in key order.
+   */
+  void close() {
+    if (lastContext != NULL) {
+      ContextSink sink(lastContext);
+      sorter->sort(sink);
+    }
+  }
+
+  ~SortMap() {
+    delete sorter;
+  }
 };
 
 const std::string SortMap::MAP_KEEP_PERCENT("hadoop.sort.map.keep.percent");
+const std::string SortMap::SORT_MEGABYTES("hadoop.sort.external.mb");
+const std::string SortMap::SORT_DIR("hadoop.sort.external.dir");
 
 class SortReduce: public HadoopPipes::Reducer {
 private:
@@ -86,11 +138,10 @@ public:
   }
 };
 
-const std::string 
+const std::string
   SortReduce::REDUCE_KEEP_PERCENT("hadoop.sort.reduce.keep.percent");
 
 int main(int argc, char *argv[]) {
   return HadoopPipes::runTask(HadoopPipes::TemplateFactory<SortMap,
                                                            SortReduce>());
 }
-
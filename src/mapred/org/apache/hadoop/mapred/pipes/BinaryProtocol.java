@@ -44,13 +44,45 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
   implements DownwardProtocol<K1, V1> {
   
   public static final int CURRENT_PROTOCOL_VERSION = 0;
+  /**
+   * The protocol version that supports MAP_ITEM_BATCH and REDUCE_VALUE_BATCH
+   * messages. It is only sent in the handshake when record batching has been
+   * enabled for the job.
+   */
+  public static final int BATCH_PROTOCOL_VERSION = 1;
+  /**
+   * The protocol version that supports COMPRESSED_BLOCK framing on the
+   * downlink. It is only sent in the handshake when downlink compression
+   * has been enabled for the job.
+   */
+  public static final int COMPRESSION_PROTOCOL_VERSION = 2;
   /**
    * The buffer size for the command socket
    */
   private static final int BUFFER_SIZE = 128*1024;
+  /**
+   * The uncompressed size a compressed block is flushed at. Blocks only
+   * break at message boundaries, so a large message can exceed this.
+   */
+  private static final int BLOCK_SIZE = 64*1024;
 
   private DataOutputStream stream;
+  /**
+   * Where complete messages are written: the socket stream, or the
+   * block buffer when downlink compression is enabled.
+   */
+  private DataOutput down;
+  private DataOutputBuffer blockBuffer = null;
+  private byte[] compressedBuffer = null;
+  private int[] hashTable = null;
   private DataOutputBuffer buffer = new DataOutputBuffer();
+  private final int batchSize;
+  private DataOutputBuffer batchBuffer = new DataOutputBuffer();
+  private MessageType batchType = null;
+  private int downlinkWindow;
+  private int credits;
+  private final Object creditLock = new Object();
+  private int batchedRecords = 0;
   private static final Log LOG = 
     LogFactory.getLog(BinaryProtocol.class.getName());
   private UplinkReaderThread uplink;
@@ -69,13 +101,20 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
                                     REDUCE_VALUE(7),
                                     CLOSE(8),
                                     ABORT(9),
+                                    MAP_ITEM_BATCH(10),
+                                    REDUCE_VALUE_BATCH(11),
+                                    COMPRESSED_BLOCK(12),
                                     OUTPUT(50),
                                     PARTITIONED_OUTPUT(51),
                                     STATUS(52),
                                     PROGRESS(53),
                                     DONE(54),
                                     REGISTER_COUNTER(55),
-                                    INCREMENT_COUNTER(56);
+                                    INCREMENT_COUNTER(56),
+                                    PARTITIONED_OUTPUT_BATCH(57),
+                                    DOWNLINK_CREDIT(58),
+                                    OUTPUT_DELTA(59),
+                                    PARTITIONED_OUTPUT_DELTA(60);
     final int code;
     MessageType(int code) {
       this.code = code;
@@ -88,14 +127,18 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
     
     private DataInputStream inStream;
     private UpwardProtocol<K2, V2> handler;
+    private BinaryProtocol<?, ?, K2, V2> protocol;
     private K2 key;
     private V2 value;
+    private byte[] prevKeyBytes = new byte[0];
     
     public UplinkReaderThread(InputStream stream,
+                              BinaryProtocol<?, ?, K2, V2> protocol,
                               UpwardProtocol<K2, V2> handler, 
                               K2 key, V2 value) throws IOException{
       inStream = new DataInputStream(new BufferedInputStream(stream, 
                                                              BUFFER_SIZE));
+      this.protocol = protocol;
       this.handler = handler;
       this.key = key;
       this.value = value;
@@ -122,6 +165,23 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
             readObject(key);
             readObject(value);
             handler.partitionedOutput(part, key, value);
+          } else if (cmd == MessageType.OUTPUT_DELTA.code) {
+            readDeltaKey();
+            readObject(value);
+            handler.output(key, value);
+          } else if (cmd == MessageType.PARTITIONED_OUTPUT_DELTA.code) {
+            int part = WritableUtils.readVInt(inStream);
+            readDeltaKey();
+            readObject(value);
+            handler.partitionedOutput(part, key, value);
+          } else if (cmd == MessageType.PARTITIONED_OUTPUT_BATCH.code) {
+            int part = WritableUtils.readVInt(inStream);
+            int count = WritableUtils.readVInt(inStream);
+            for(int i=0; i < count; ++i) {
+              readObject(key);
+              readObject(value);
+              handler.partitionedOutput(part, key, value);
+            }
           } else if (cmd == MessageType.STATUS.code) {
             handler.status(Text.readString(inStream));
           } else if (cmd == MessageType.PROGRESS.code) {
@@ -135,6 +195,9 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
             int id = WritableUtils.readVInt(inStream);
             long amount = WritableUtils.readVLong(inStream);
             handler.incrementCounter(id, amount);
+          } else if (cmd == MessageType.DOWNLINK_CREDIT.code) {
+            int granted = WritableUtils.readVInt(inStream);
+            protocol.grantCredits(granted);
           } else if (cmd == MessageType.DONE.code) {
             LOG.debug("Pipe child done");
             handler.done();
@@ -152,6 +215,26 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
       }
     }
     
+    /**
+     * Read a key that is delta-encoded against the previous key as a
+     * shared prefix length and a suffix, and rebuild the full bytes.
+     */
+    private void readDeltaKey() throws IOException {
+      int shared = WritableUtils.readVInt(inStream);
+      int suffixLength = WritableUtils.readVInt(inStream);
+      byte[] bytes = new byte[shared + suffixLength];
+      System.arraycopy(prevKeyBytes, 0, bytes, 0, shared);
+      inStream.readFully(bytes, shared, suffixLength);
+      prevKeyBytes = bytes;
+      if (key instanceof BytesWritable) {
+        ((BytesWritable) key).set(bytes, 0, bytes.length);
+      } else if (key instanceof Text) {
+        ((Text) key).set(bytes);
+      } else {
+        key.readFields(new DataInputStream(new ByteArrayInputStream(bytes)));
+      }
+    }
+
     private void readObject(Writable obj) throws IOException {
       int numBytes = WritableUtils.readVInt(inStream);
       byte[] buffer;
@@ -224,9 +307,23 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
     if (Submitter.getKeepCommandFile(config)) {
       raw = new TeeOutputStream("downlink.data", raw);
     }
-    stream = new DataOutputStream(new BufferedOutputStream(raw, 
+    stream = new DataOutputStream(new BufferedOutputStream(raw,
                                                            BUFFER_SIZE)) ;
-    uplink = new UplinkReaderThread<K2, V2>(sock.getInputStream(),
+    if (Submitter.getCompressDownlink(config)) {
+      blockBuffer = new DataOutputBuffer();
+      compressedBuffer = new byte[maxCompressedLength(BLOCK_SIZE)];
+      hashTable = new int[HASH_SIZE];
+      down = blockBuffer;
+    } else {
+      down = stream;
+    }
+    batchSize = Submitter.getBatchRecords(config);
+    downlinkWindow = Submitter.getDownlinkWindowRecords(config);
+    if (downlinkWindow > 0 && downlinkWindow < 2) {
+      downlinkWindow = 2;
+    }
+    credits = downlinkWindow;
+    uplink = new UplinkReaderThread<K2, V2>(sock.getInputStream(), this,
                                             handler, key, value);
     uplink.setName("pipe-uplink-handler");
     uplink.start();
@@ -247,75 +344,204 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
 
   public void start() throws IOException {
     LOG.debug("starting downlink");
-    WritableUtils.writeVInt(stream, MessageType.START.code);
-    WritableUtils.writeVInt(stream, CURRENT_PROTOCOL_VERSION);
+    int version = CURRENT_PROTOCOL_VERSION;
+    if (blockBuffer != null) {
+      version = COMPRESSION_PROTOCOL_VERSION;
+    } else if (batchSize > 1) {
+      version = BATCH_PROTOCOL_VERSION;
+    }
+    WritableUtils.writeVInt(down, MessageType.START.code);
+    WritableUtils.writeVInt(down, version);
+    endMessage();
   }
 
   public void setJobConf(JobConf job) throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.SET_JOB_CONF.code);
+    WritableUtils.writeVInt(down, MessageType.SET_JOB_CONF.code);
     List<String> list = new ArrayList<String>();
     for(Map.Entry<String, String> itm: job) {
       list.add(itm.getKey());
       list.add(itm.getValue());
     }
-    WritableUtils.writeVInt(stream, list.size());
+    WritableUtils.writeVInt(down, list.size());
     for(String entry: list){
-      Text.writeString(stream, entry);
+      Text.writeString(down, entry);
     }
+    endMessage();
   }
 
-  public void setInputTypes(String keyType, 
+  public void setInputTypes(String keyType,
                             String valueType) throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.SET_INPUT_TYPES.code);
-    Text.writeString(stream, keyType);
-    Text.writeString(stream, valueType);
+    WritableUtils.writeVInt(down, MessageType.SET_INPUT_TYPES.code);
+    Text.writeString(down, keyType);
+    Text.writeString(down, valueType);
+    endMessage();
   }
 
-  public void runMap(InputSplit split, int numReduces, 
+  public void runMap(InputSplit split, int numReduces,
                      boolean pipedInput) throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.RUN_MAP.code);
+    WritableUtils.writeVInt(down, MessageType.RUN_MAP.code);
     writeObject(split);
-    WritableUtils.writeVInt(stream, numReduces);
-    WritableUtils.writeVInt(stream, pipedInput ? 1 : 0);
+    WritableUtils.writeVInt(down, numReduces);
+    WritableUtils.writeVInt(down, pipedInput ? 1 : 0);
+    endMessage();
   }
 
-  public void mapItem(WritableComparable key, 
+  public void mapItem(WritableComparable key,
                       Writable value) throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.MAP_ITEM.code);
-    writeObject(key);
-    writeObject(value);
+    consumeCredit();
+    if (batchSize > 1) {
+      batchType = MessageType.MAP_ITEM_BATCH;
+      writeObject(key, batchBuffer);
+      writeObject(value, batchBuffer);
+      batchedRecords += 1;
+      if (batchedRecords >= batchSize) {
+        flushBatch();
+      }
+    } else {
+      WritableUtils.writeVInt(down, MessageType.MAP_ITEM.code);
+      writeObject(key);
+      writeObject(value);
+      endMessage();
+    }
   }
 
   public void runReduce(int reduce, boolean pipedOutput) throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.RUN_REDUCE.code);
-    WritableUtils.writeVInt(stream, reduce);
-    WritableUtils.writeVInt(stream, pipedOutput ? 1 : 0);
+    WritableUtils.writeVInt(down, MessageType.RUN_REDUCE.code);
+    WritableUtils.writeVInt(down, reduce);
+    WritableUtils.writeVInt(down, pipedOutput ? 1 : 0);
+    endMessage();
   }
 
   public void reduceKey(WritableComparable key) throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.REDUCE_KEY.code);
+    consumeCredit();
+    flushBatch();
+    WritableUtils.writeVInt(down, MessageType.REDUCE_KEY.code);
     writeObject(key);
+    endMessage();
   }
 
   public void reduceValue(Writable value) throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.REDUCE_VALUE.code);
-    writeObject(value);
+    consumeCredit();
+    if (batchSize > 1) {
+      batchType = MessageType.REDUCE_VALUE_BATCH;
+      writeObject(value, batchBuffer);
+      batchedRecords += 1;
+      if (batchedRecords >= batchSize) {
+        flushBatch();
+      }
+    } else {
+      WritableUtils.writeVInt(down, MessageType.REDUCE_VALUE.code);
+      writeObject(value);
+      endMessage();
+    }
   }
 
   public void endOfInput() throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.CLOSE.code);
+    flushBatch();
+    WritableUtils.writeVInt(down, MessageType.CLOSE.code);
+    flushBlock();
     LOG.debug("Sent close command");
   }
-  
+
   public void abort() throws IOException {
-    WritableUtils.writeVInt(stream, MessageType.ABORT.code);
+    flushBatch();
+    WritableUtils.writeVInt(down, MessageType.ABORT.code);
+    flushBlock();
     LOG.debug("Sent abort command");
   }
 
   public void flush() throws IOException {
+    flushBatch();
+    flushBlock();
     stream.flush();
   }
 
+  /**
+   * Take one record's worth of downlink credit, waiting for the C++
+   * process to grant more once the window is exhausted. Everything
+   * buffered is flushed before waiting, since the child has to drain
+   * those frames before it will grant anything.
+   */
+  private void consumeCredit() throws IOException {
+    if (downlinkWindow <= 0) {
+      return;
+    }
+    synchronized (creditLock) {
+      if (credits == 0) {
+        flush();
+        while (credits == 0) {
+          try {
+            creditLock.wait();
+          } catch (InterruptedException ie) {
+            throw new IOException("Interrupted waiting for downlink credit");
+          }
+        }
+      }
+      credits -= 1;
+    }
+  }
+
+  /**
+   * Add credit granted by the C++ process and wake a blocked writer.
+   */
+  void grantCredits(int granted) {
+    synchronized (creditLock) {
+      credits += granted;
+      creditLock.notifyAll();
+    }
+  }
+
+  /**
+   * Send any batched records downstream as a single framed message that
+   * carries the record count followed by the serialized records.
+   * @throws IOException
+   */
+  private void flushBatch() throws IOException {
+    if (batchedRecords > 0) {
+      WritableUtils.writeVInt(down, batchType.code);
+      WritableUtils.writeVInt(down, batchedRecords);
+      down.write(batchBuffer.getData(), 0, batchBuffer.getLength());
+      batchBuffer.reset();
+      batchedRecords = 0;
+      batchType = null;
+      endMessage();
+    }
+  }
+
+  /**
+   * Called after each complete message; flushes the compressed block
+   * once enough message bytes have accumulated. Blocks only break at
+   * message boundaries so the C++ decoder can parse each one alone.
+   */
+  private void endMessage() throws IOException {
+    if (blockBuffer != null && blockBuffer.getLength() >= BLOCK_SIZE) {
+      flushBlock();
+    }
+  }
+
+  /**
+   * Compress the buffered messages and send them downstream as a single
+   * COMPRESSED_BLOCK frame carrying the uncompressed and compressed
+   * lengths and the compressed bytes.
+   */
+  private void flushBlock() throws IOException {
+    if (blockBuffer == null || blockBuffer.getLength() == 0) {
+      return;
+    }
+    int rawLength = blockBuffer.getLength();
+    int worst = maxCompressedLength(rawLength);
+    if (compressedBuffer.length < worst) {
+      compressedBuffer = new byte[worst];
+    }
+    int compressedLength = compress(blockBuffer.getData(), rawLength,
+                                    compressedBuffer, hashTable);
+    WritableUtils.writeVInt(stream, MessageType.COMPRESSED_BLOCK.code);
+    WritableUtils.writeVInt(stream, rawLength);
+    WritableUtils.writeVInt(stream, compressedLength);
+    stream.write(compressedBuffer, 0, compressedLength);
+    blockBuffer.reset();
+  }
+
   /**
    * Write the given object to the stream. If it is a Text or BytesWritable,
    * write it directly. Otherwise, write it to a buffer and then write the
@@ -324,25 +550,113 @@ class BinaryProtocol<K1 extends WritableComparable, V1 extends Writable,
    * @throws IOException
    */
   private void writeObject(Writable obj) throws IOException {
+    writeObject(obj, down);
+  }
+
+  private void writeObject(Writable obj, DataOutput out
+                           ) throws IOException {
     // For Text and BytesWritable, encode them directly, so that they end up
     // in C++ as the natural translations.
     if (obj instanceof Text) {
       Text t = (Text) obj;
       int len = t.getLength();
-      WritableUtils.writeVInt(stream, len);
-      stream.write(t.getBytes(), 0, len);
+      WritableUtils.writeVInt(out, len);
+      out.write(t.getBytes(), 0, len);
     } else if (obj instanceof BytesWritable) {
       BytesWritable b = (BytesWritable) obj;
       int len = b.getLength();
-      WritableUtils.writeVInt(stream, len);
-      stream.write(b.getBytes(), 0, len);
+      WritableUtils.writeVInt(out, len);
+      out.write(b.getBytes(), 0, len);
     } else {
       buffer.reset();
       obj.write(buffer);
       int length = buffer.getLength();
-      WritableUtils.writeVInt(stream, length);
-      stream.write(buffer.getData(), 0, length);
+      WritableUtils.writeVInt(out, length);
+      out.write(buffer.getData(), 0, length);
     }
   }
-  
+
+  /* LZ token layout; this must match the decoder in the C++
+     CompressUtils.cc or the child will reject every block */
+  private static final int MAX_LITERAL_RUN = 32;
+  private static final int MAX_DISTANCE = 8192;
+  private static final int MIN_MATCH = 3;
+  private static final int MAX_MATCH = 264;
+  private static final int HASH_SIZE = 8192;
+
+  /**
+   * The worst-case compressed size for the given input size: one
+   * control byte per run of 32 literals.
+   */
+  private static int maxCompressedLength(int length) {
+    return length + length / MAX_LITERAL_RUN + 1;
+  }
+
+  private static int hashBytes(byte[] data, int pos) {
+    int triple = ((data[pos] & 0xff) << 16) | ((data[pos + 1] & 0xff) << 8)
+      | (data[pos + 2] & 0xff);
+    return (triple * 0x9E3779B1 >>> 19) & (HASH_SIZE - 1);
+  }
+
+  /**
+   * Append a span of literals as runs of at most MAX_LITERAL_RUN.
+   * @return the output position after the runs
+   */
+  private static int emitLiterals(byte[] in, int start, int end,
+                                  byte[] out, int outPos) {
+    while (start < end) {
+      int run = Math.min(end - start, MAX_LITERAL_RUN);
+      out[outPos++] = (byte) (run - 1);
+      System.arraycopy(in, start, out, outPos, run);
+      outPos += run;
+      start += run;
+    }
+    return outPos;
+  }
+
+  /**
+   * Compress length bytes of in into out, which must hold at least
+   * maxCompressedLength(length) bytes. A back-reference is emitted for
+   * any repeat of three or more bytes within the last 8192; everything
+   * else is copied as literal runs.
+   * @return the number of compressed bytes written
+   */
+  private static int compress(byte[] in, int length, byte[] out,
+                              int[] table) {
+    java.util.Arrays.fill(table, -1);
+    int outPos = 0;
+    int literalStart = 0;
+    int pos = 0;
+    while (pos + MIN_MATCH <= length) {
+      int slot = hashBytes(in, pos);
+      int candidate = table[slot];
+      table[slot] = pos;
+      if (candidate >= 0 && pos - candidate <= MAX_DISTANCE &&
+          in[candidate] == in[pos] &&
+          in[candidate + 1] == in[pos + 1] &&
+          in[candidate + 2] == in[pos + 2]) {
+        int limit = Math.min(length - pos, MAX_MATCH);
+        int matched = MIN_MATCH;
+        while (matched < limit && in[candidate + matched] == in[pos + matched]) {
+          matched += 1;
+        }
+        outPos = emitLiterals(in, literalStart, pos, out, outPos);
+        int distance = pos - candidate - 1;
+        int lenBits = matched - 2;
+        if (lenBits < 7) {
+          out[outPos++] = (byte) ((lenBits << 5) | (distance >> 8));
+        } else {
+          out[outPos++] = (byte) ((7 << 5) | (distance >> 8));
+          out[outPos++] = (byte) (lenBits - 7);
+        }
+        out[outPos++] = (byte) distance;
+        pos += matched;
+        literalStart = pos;
+      } else {
+        pos += 1;
+      }
+    }
+    return emitLiterals(in, literalStart, length, out, outPos);
+  }
+
 }
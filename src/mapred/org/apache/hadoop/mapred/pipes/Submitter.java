@@ -222,6 +222,117 @@ public class Submitter extends Configured implements Tool {
     conf.setBoolean("hadoop.pipes.command-file.keep", keep);
   }
 
+  /**
+   * Get the number of records to batch into a single downlink message.
+   * @param conf the configuration to check
+   * @return the number of records per message, 1 disables batching
+   */
+  public static int getBatchRecords(JobConf conf) {
+    return conf.getInt("hadoop.pipes.batch.records", 1);
+  }
+
+  /**
+   * Set the number of records to batch into a single downlink message.
+   * Batching amortizes the per-message protocol overhead across many
+   * records, but requires the C++ application to be linked against a
+   * pipes library that understands the batched messages.
+   * @param conf the configuration to modify
+   * @param records the number of records per message, 1 disables batching
+   */
+  public static void setBatchRecords(JobConf conf, int records) {
+    conf.setInt("hadoop.pipes.batch.records", records);
+  }
+
+  /**
+   * Get the size of the downlink flow-control window in records.
+   * @param conf the configuration to check
+   * @return the window size, 0 disables flow control
+   */
+  public static int getDownlinkWindowRecords(JobConf conf) {
+    return conf.getInt("hadoop.pipes.downlink.window.records", 0);
+  }
+
+  /**
+   * Set the size of the downlink flow-control window in records.
+   * When set, the parent only sends as many record frames as the C++
+   * process has advertised credit for, so buffered input stays bounded
+   * instead of filling the socket and stdio buffers. Requires a pipes
+   * library that grants credit; older libraries will stall the job.
+   * @param conf the configuration to modify
+   * @param records the window size in records, 0 disables flow control
+   */
+  public static void setDownlinkWindowRecords(JobConf conf, int records) {
+    conf.setInt("hadoop.pipes.downlink.window.records", records);
+  }
+
+  /**
+   * Check whether downlink messages are framed into compressed blocks.
+   * @param conf the configuration to check
+   * @return whether downlink compression is enabled
+   */
+  public static boolean getCompressDownlink(JobConf conf) {
+    return conf.getBoolean("hadoop.pipes.downlink.compress", false);
+  }
+
+  /**
+   * Set whether downlink messages are framed into compressed blocks.
+   * Reduce input in particular is carried uncompressed over the
+   * loopback socket; block compression trades a little CPU for far
+   * fewer bytes through the socket and stdio buffers. Requires the C++
+   * application to be linked against a pipes library that decodes the
+   * compressed frames.
+   * @param conf the configuration to modify
+   * @param compress whether to enable downlink compression
+   */
+  public static void setCompressDownlink(JobConf conf, boolean compress) {
+    conf.setBoolean("hadoop.pipes.downlink.compress", compress);
+  }
+
+  /**
+   * Check whether the C++ process delta-encodes output keys.
+   * @param conf the configuration to check
+   * @return whether delta encoding is enabled
+   */
+  public static boolean getKeyDeltaEncoding(JobConf conf) {
+    return conf.getBoolean("hadoop.pipes.uplink.key.delta", false);
+  }
+
+  /**
+   * Set whether the C++ process delta-encodes output keys against the
+   * previous emitted key as a shared prefix length and a suffix. This
+   * shrinks the uplink substantially for sorted, prefix-heavy keys such
+   * as URLs or paths, but requires a parent new enough to rebuild the
+   * keys.
+   * @param conf the configuration to modify
+   * @param delta whether to enable delta encoding
+   */
+  public static void setKeyDeltaEncoding(JobConf conf, boolean delta) {
+    conf.setBoolean("hadoop.pipes.uplink.key.delta", delta);
+  }
+
+  /**
+   * Check whether the C++ worker process may be reused across tasks.
+   * @param conf the configuration to check
+   * @return whether worker reuse is enabled
+   */
+  public static boolean getWorkerReuse(JobConf conf) {
+    return conf.getBoolean("hadoop.pipes.worker.reuse", false);
+  }
+
+  /**
+   * Set whether the C++ worker process stays alive after reporting done
+   * and accepts further tasks over the same connection, the C++ analog
+   * of JVM reuse. This saves the binary load, dynamic linking and
+   * socket setup per task, which is significant for jobs with many
+   * short tasks. Requires a C++ application linked against a pipes
+   * library with the worker-reuse loop.
+   * @param conf the configuration to modify
+   * @param reuse whether to enable worker reuse
+   */
+  public static void setWorkerReuse(JobConf conf, boolean reuse) {
+    conf.setBoolean("hadoop.pipes.worker.reuse", reuse);
+  }
+
   /**
    * Submit a job to the map/reduce cluster. All of the necessary modifications
    * to the job to run under pipes are made to the configuration.
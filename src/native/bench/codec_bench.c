@@ -0,0 +1,332 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Microbenchmark for the native compression path. Drives the real
+ * deflateBytesDirect/inflateBytesDirect (and the fastlz equivalents)
+ * through the jni_stub harness over generated corpora of varying
+ * entropy, reporting compression and decompression MB/s and the
+ * achieved ratio per codec, level and buffer size.
+ *
+ *   codec_bench [megabytes-per-config]       (default 8)
+ */
+
+#include "jni_stub.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+// The codec entry points, normally called through javah-generated
+// headers; declared by hand here so the benchmark builds standalone
+extern void Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_initIDs(
+	JNIEnv *, jclass);
+extern jlong Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_init(
+	JNIEnv *, jclass, jint, jint, jint);
+extern jint Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_deflateBytesDirect(
+	JNIEnv *, jobject);
+extern void Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_reset(
+	JNIEnv *, jclass, jlong);
+extern void Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_end(
+	JNIEnv *, jclass, jlong);
+
+extern void Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_initIDs(
+	JNIEnv *, jclass);
+extern jlong Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_init(
+	JNIEnv *, jclass, jint);
+extern jint Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_inflateBytesDirect(
+	JNIEnv *, jobject);
+extern void Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_reset(
+	JNIEnv *, jclass, jlong);
+extern void Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_end(
+	JNIEnv *, jclass, jlong);
+
+extern void Java_org_apache_hadoop_io_compress_fastlz_FastLzCompressor_initIDs(
+	JNIEnv *, jclass);
+extern jint Java_org_apache_hadoop_io_compress_fastlz_FastLzCompressor_compressBytesDirect(
+	JNIEnv *, jobject);
+extern void Java_org_apache_hadoop_io_compress_fastlz_FastLzDecompressor_initIDs(
+	JNIEnv *, jclass);
+extern jint Java_org_apache_hadoop_io_compress_fastlz_FastLzDecompressor_decompressBytesDirect(
+	JNIEnv *, jobject);
+
+static double now_seconds(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * Corpora of varying entropy: all-zero, repeated text, an even mix of
+ * repetitive and random runs, and pure noise.
+ */
+static unsigned long rng_state;
+static unsigned rng(void)
+{
+	rng_state = rng_state * 6364136223846793005UL + 1442695040888963407UL;
+	return (unsigned)(rng_state >> 33);
+}
+
+static const char *corpus_names[] = { "zeros", "text", "mixed", "random" };
+#define NUM_CORPORA 4
+
+static void fill_corpus(int corpus, char *buf, size_t len)
+{
+	static const char phrase[] =
+		"the quick brown fox jumps over the lazy dog. ";
+	size_t i;
+
+	rng_state = 42;
+	switch (corpus) {
+		case 0:
+			memset(buf, 0, len);
+			break;
+		case 1:
+			for (i = 0; i < len; i++) {
+				buf[i] = phrase[i % (sizeof(phrase) - 1)];
+			}
+			break;
+		case 2:
+			for (i = 0; i < len; i++) {
+				buf[i] = (i / 1024) % 2 ? (char)rng() : (char)(i % 7);
+			}
+			break;
+		case 3:
+			for (i = 0; i < len; i++) {
+				buf[i] = (char)rng();
+			}
+			break;
+	}
+}
+
+/**
+ * One benchmark configuration: compress the corpus block by block the
+ * way CompressorStream drives the codec (finish and reset per block),
+ * then decompress and verify, timing both directions.
+ */
+typedef struct {
+	const char *codec;		// "zlib" or "fastlz"
+	int level;				// zlib level, -1 for fastlz
+	int corpus;
+	size_t block_size;
+} bench_config;
+
+static JNIEnv *env;
+
+static void run_config(const bench_config *cfg, const char *corpus_buf,
+	size_t corpus_len, char *arena, size_t arena_cap,
+	char *check_buf)
+{
+	bench_jni_object comp, decomp;
+	// worst case a block grows a little; size the direct buffers with
+	// room to spare so every codec's bound fits
+	size_t out_cap = cfg->block_size + (cfg->block_size >> 3) + 64;
+	size_t num_blocks = corpus_len / cfg->block_size;
+	size_t comp_lens_cap = num_blocks + 1;
+	size_t *comp_lens = malloc(comp_lens_cap * sizeof(size_t));
+	size_t total_comp = 0;
+	size_t b;
+	double t0, comp_secs, decomp_secs;
+	int is_zlib = (cfg->level >= 0);
+
+	memset(&comp, 0, sizeof(comp));
+	comp.uncompressed_buf = malloc(cfg->block_size);
+	comp.compressed_buf = malloc(out_cap);
+	comp.buffer_size = (jint)(is_zlib ? out_cap : cfg->block_size);
+
+	if (is_zlib) {
+		comp.stream = Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_init(
+				env, NULL, cfg->level, 0 /*Z_DEFAULT_STRATEGY*/, 15);
+	}
+
+	// --- compress ---
+	t0 = now_seconds();
+	for (b = 0; b < num_blocks; b++) {
+		size_t produced = 0;
+		memcpy(comp.uncompressed_buf,
+			corpus_buf + b * cfg->block_size, cfg->block_size);
+		comp.uncompressed_off = 0;
+		comp.uncompressed_len = (jint)cfg->block_size;
+		comp.finish = JNI_TRUE;
+		comp.finished = JNI_FALSE;
+
+		if (is_zlib) {
+			while (!comp.finished) {
+				jint n = Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_deflateBytesDirect(
+						env, (jobject)&comp);
+				memcpy(arena + total_comp + produced, comp.compressed_buf, n);
+				produced += n;
+			}
+			Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_reset(
+					env, NULL, comp.stream);
+		} else {
+			jint n = Java_org_apache_hadoop_io_compress_fastlz_FastLzCompressor_compressBytesDirect(
+					env, (jobject)&comp);
+			memcpy(arena + total_comp, comp.compressed_buf, n);
+			produced = n;
+		}
+		comp_lens[b] = produced;
+		total_comp += produced;
+		if (total_comp + out_cap > arena_cap) {
+			fprintf(stderr, "codec_bench: arena too small\n");
+			exit(1);
+		}
+	}
+	comp_secs = now_seconds() - t0;
+
+	// --- decompress and verify ---
+	memset(&decomp, 0, sizeof(decomp));
+	decomp.compressed_buf = malloc(out_cap);
+	decomp.uncompressed_buf = malloc(cfg->block_size);
+	decomp.buffer_size = (jint)cfg->block_size;
+
+	if (is_zlib) {
+		decomp.stream = Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_init(
+				env, NULL, 15);
+	}
+
+	t0 = now_seconds();
+	{
+		size_t off = 0;
+		for (b = 0; b < num_blocks; b++) {
+			size_t restored = 0;
+			memcpy(decomp.compressed_buf, arena + off, comp_lens[b]);
+			decomp.compressed_off = 0;
+			decomp.compressed_len = (jint)comp_lens[b];
+			decomp.finished = JNI_FALSE;
+
+			if (is_zlib) {
+				while (!decomp.finished) {
+					jint n = Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_inflateBytesDirect(
+							env, (jobject)&decomp);
+					memcpy(check_buf + restored, decomp.uncompressed_buf, n);
+					restored += n;
+				}
+				Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_reset(
+						env, NULL, decomp.stream);
+			} else {
+				jint n = Java_org_apache_hadoop_io_compress_fastlz_FastLzDecompressor_decompressBytesDirect(
+						env, (jobject)&decomp);
+				memcpy(check_buf, decomp.uncompressed_buf, n);
+				restored = n;
+			}
+
+			if (restored != cfg->block_size ||
+				memcmp(check_buf, corpus_buf + b * cfg->block_size,
+					cfg->block_size) != 0) {
+				fprintf(stderr, "codec_bench: %s round trip mismatch\n",
+					cfg->codec);
+				exit(1);
+			}
+			off += comp_lens[b];
+		}
+	}
+	decomp_secs = now_seconds() - t0;
+
+	{
+		size_t raw = num_blocks * cfg->block_size;
+		printf("%-7s %5d  %-7s %7zuK  %8.1f %8.1f %8.2f\n",
+			cfg->codec, cfg->level, corpus_names[cfg->corpus],
+			cfg->block_size / 1024,
+			raw / (1024.0 * 1024.0) / comp_secs,
+			raw / (1024.0 * 1024.0) / decomp_secs,
+			(double)raw / total_comp);
+	}
+
+	if (is_zlib) {
+		Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_end(
+				env, NULL, comp.stream);
+		Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_end(
+				env, NULL, decomp.stream);
+	}
+	free(comp.uncompressed_buf);
+	free(comp.compressed_buf);
+	free(decomp.compressed_buf);
+	free(decomp.uncompressed_buf);
+	free(comp_lens);
+}
+
+int main(int argc, char **argv)
+{
+	static const int zlib_levels[] = { 1, 6, 9 };
+	static const size_t block_sizes[] = { 64 * 1024, 256 * 1024 };
+	size_t corpus_len = 8 * 1024 * 1024;
+	char *corpus_buf, *arena, *check_buf;
+	size_t arena_cap;
+	int corpus;
+	size_t li, bi;
+
+	if (argc > 1) {
+		corpus_len = (size_t)atoi(argv[1]) * 1024 * 1024;
+		if (corpus_len == 0) {
+			fprintf(stderr, "usage: %s [megabytes-per-config]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	env = bench_jni_env();
+	Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_initIDs(env, NULL);
+	Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_initIDs(env, NULL);
+	Java_org_apache_hadoop_io_compress_fastlz_FastLzCompressor_initIDs(env, NULL);
+	Java_org_apache_hadoop_io_compress_fastlz_FastLzDecompressor_initIDs(env, NULL);
+
+	corpus_buf = malloc(corpus_len);
+	arena_cap = corpus_len + (corpus_len >> 2) + (1 << 20);
+	arena = malloc(arena_cap);
+	check_buf = malloc(block_sizes[sizeof(block_sizes) / sizeof(*block_sizes) - 1]);
+	if (!corpus_buf || !arena || !check_buf) {
+		fprintf(stderr, "codec_bench: out of memory\n");
+		return 1;
+	}
+
+	printf("%zu MB per configuration\n", corpus_len / (1024 * 1024));
+	printf("%-7s %5s  %-7s %8s  %8s %8s %8s\n",
+		"codec", "level", "corpus", "block", "comp", "decomp", "ratio");
+	printf("%-7s %5s  %-7s %8s  %8s %8s %8s\n",
+		"", "", "", "", "MB/s", "MB/s", "");
+
+	for (corpus = 0; corpus < NUM_CORPORA; corpus++) {
+		fill_corpus(corpus, corpus_buf, corpus_len);
+		for (bi = 0; bi < sizeof(block_sizes) / sizeof(*block_sizes); bi++) {
+			bench_config cfg;
+			cfg.corpus = corpus;
+			cfg.block_size = block_sizes[bi];
+			for (li = 0; li < sizeof(zlib_levels) / sizeof(*zlib_levels); li++) {
+				cfg.codec = "zlib";
+				cfg.level = zlib_levels[li];
+				run_config(&cfg, corpus_buf, corpus_len, arena, arena_cap,
+					check_buf);
+			}
+			cfg.codec = "fastlz";
+			cfg.level = -1;
+			run_config(&cfg, corpus_buf, corpus_len, arena, arena_cap,
+				check_buf);
+		}
+	}
+
+	free(corpus_buf);
+	free(arena);
+	free(check_buf);
+	return 0;
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
@@ -0,0 +1,212 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni_stub.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Field ids are small integers naming a slot in bench_jni_object; the
+ * codec natives only ever look fields up by name in initIDs and then
+ * use the returned ids, so a name->slot table is all that is needed.
+ */
+enum {
+	F_CLAZZ = 1,
+	F_STREAM,
+	F_UNCOMPRESSED_BUF,
+	F_UNCOMPRESSED_OFF,
+	F_UNCOMPRESSED_LEN,
+	F_COMPRESSED_BUF,
+	F_COMPRESSED_OFF,
+	F_COMPRESSED_LEN,
+	F_BUFFER_SIZE,
+	F_FINISH,
+	F_FINISHED,
+	F_NEED_DICT
+};
+
+static const struct { const char *name; long id; } field_table[] = {
+	{ "stream", F_STREAM },
+	{ "uncompressedDirectBuf", F_UNCOMPRESSED_BUF },
+	{ "uncompressedDirectBufOff", F_UNCOMPRESSED_OFF },
+	{ "uncompressedDirectBufLen", F_UNCOMPRESSED_LEN },
+	{ "compressedDirectBuf", F_COMPRESSED_BUF },
+	{ "compressedDirectBufOff", F_COMPRESSED_OFF },
+	{ "compressedDirectBufLen", F_COMPRESSED_LEN },
+	{ "directBufferSize", F_BUFFER_SIZE },
+	{ "finish", F_FINISH },
+	{ "finished", F_FINISHED },
+	{ "needDict", F_NEED_DICT },
+	{ NULL, 0 }
+};
+
+static jclass stub_FindClass(JNIEnv *env, const char *name)
+{
+	// the class reference is only ever handed straight to ThrowNew
+	return (jclass)name;
+}
+
+static jint stub_ThrowNew(JNIEnv *env, jclass clazz, const char *msg)
+{
+	fprintf(stderr, "codec_bench: native threw %s: %s\n",
+		(const char *)clazz, msg ? msg : "(no message)");
+	exit(1);
+}
+
+static jfieldID stub_GetFieldID(JNIEnv *env, jclass clazz,
+	const char *name, const char *sig)
+{
+	int i;
+	for (i = 0; field_table[i].name != NULL; i++) {
+		if (strcmp(field_table[i].name, name) == 0) {
+			return (jfieldID)field_table[i].id;
+		}
+	}
+	fprintf(stderr, "codec_bench: unknown field %s\n", name);
+	exit(1);
+}
+
+static jfieldID stub_GetStaticFieldID(JNIEnv *env, jclass clazz,
+	const char *name, const char *sig)
+{
+	return (jfieldID)F_CLAZZ;
+}
+
+static jobject stub_GetStaticObjectField(JNIEnv *env, jobject obj,
+	jfieldID id)
+{
+	// the 'clazz' lock object; the stub's monitor ops ignore it
+	return (jobject)1;
+}
+
+static jobject stub_GetObjectField(JNIEnv *env, jobject obj, jfieldID id)
+{
+	bench_jni_object *o = (bench_jni_object *)obj;
+	switch ((long)id) {
+		case F_UNCOMPRESSED_BUF:
+			return (jobject)o->uncompressed_buf;
+		case F_COMPRESSED_BUF:
+			return (jobject)o->compressed_buf;
+	}
+	fprintf(stderr, "codec_bench: bad object field %ld\n", (long)id);
+	exit(1);
+}
+
+static jint stub_GetIntField(JNIEnv *env, jobject obj, jfieldID id)
+{
+	bench_jni_object *o = (bench_jni_object *)obj;
+	switch ((long)id) {
+		case F_UNCOMPRESSED_OFF: return o->uncompressed_off;
+		case F_UNCOMPRESSED_LEN: return o->uncompressed_len;
+		case F_COMPRESSED_OFF: return o->compressed_off;
+		case F_COMPRESSED_LEN: return o->compressed_len;
+		case F_BUFFER_SIZE: return o->buffer_size;
+	}
+	fprintf(stderr, "codec_bench: bad int field %ld\n", (long)id);
+	exit(1);
+}
+
+static jlong stub_GetLongField(JNIEnv *env, jobject obj, jfieldID id)
+{
+	return ((bench_jni_object *)obj)->stream;
+}
+
+static jboolean stub_GetBooleanField(JNIEnv *env, jobject obj, jfieldID id)
+{
+	bench_jni_object *o = (bench_jni_object *)obj;
+	switch ((long)id) {
+		case F_FINISH: return o->finish;
+		case F_FINISHED: return o->finished;
+		case F_NEED_DICT: return o->need_dict;
+	}
+	fprintf(stderr, "codec_bench: bad boolean field %ld\n", (long)id);
+	exit(1);
+}
+
+static void stub_SetIntField(JNIEnv *env, jobject obj, jfieldID id, jint v)
+{
+	bench_jni_object *o = (bench_jni_object *)obj;
+	switch ((long)id) {
+		case F_UNCOMPRESSED_OFF: o->uncompressed_off = v; return;
+		case F_UNCOMPRESSED_LEN: o->uncompressed_len = v; return;
+		case F_COMPRESSED_OFF: o->compressed_off = v; return;
+		case F_COMPRESSED_LEN: o->compressed_len = v; return;
+	}
+	fprintf(stderr, "codec_bench: bad int field %ld\n", (long)id);
+	exit(1);
+}
+
+static void stub_SetBooleanField(JNIEnv *env, jobject obj, jfieldID id,
+	jboolean v)
+{
+	bench_jni_object *o = (bench_jni_object *)obj;
+	switch ((long)id) {
+		case F_FINISH: o->finish = v; return;
+		case F_FINISHED: o->finished = v; return;
+		case F_NEED_DICT: o->need_dict = v; return;
+	}
+	fprintf(stderr, "codec_bench: bad boolean field %ld\n", (long)id);
+	exit(1);
+}
+
+static jint stub_MonitorEnter(JNIEnv *env, jobject obj)
+{
+	return 0;
+}
+
+static jint stub_MonitorExit(JNIEnv *env, jobject obj)
+{
+	return 0;
+}
+
+static void *stub_GetDirectBufferAddress(JNIEnv *env, jobject buf)
+{
+	// direct buffer objects are represented by their addresses
+	return (void *)buf;
+}
+
+static struct JNINativeInterface_ stub_interface;
+static JNIEnv stub_env;
+
+JNIEnv *bench_jni_env(void)
+{
+	if (stub_env == NULL) {
+		stub_interface.FindClass = stub_FindClass;
+		stub_interface.ThrowNew = stub_ThrowNew;
+		stub_interface.GetFieldID = stub_GetFieldID;
+		stub_interface.GetStaticFieldID = stub_GetStaticFieldID;
+		stub_interface.GetStaticObjectField = stub_GetStaticObjectField;
+		stub_interface.GetObjectField = stub_GetObjectField;
+		stub_interface.GetIntField = stub_GetIntField;
+		stub_interface.GetLongField = stub_GetLongField;
+		stub_interface.GetBooleanField = stub_GetBooleanField;
+		stub_interface.SetIntField = stub_SetIntField;
+		stub_interface.SetBooleanField = stub_SetBooleanField;
+		stub_interface.MonitorEnter = stub_MonitorEnter;
+		stub_interface.MonitorExit = stub_MonitorExit;
+		stub_interface.GetDirectBufferAddress = stub_GetDirectBufferAddress;
+		stub_env = &stub_interface;
+	}
+	return &stub_env;
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
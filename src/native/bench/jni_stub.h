@@ -0,0 +1,53 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined BENCH_JNI_STUB_H
+#define BENCH_JNI_STUB_H
+
+#include <jni.h>
+
+/**
+ * A minimal in-process stand-in for the JVM, just enough to drive the
+ * codec natives from a plain C program: field ids resolve by name into
+ * slots of a bench_jni_object, direct buffer "objects" are the raw
+ * buffer addresses, and any exception thrown aborts the benchmark with
+ * the message. This exercises the exact deflateBytesDirect /
+ * inflateBytesDirect code paths the JVM would, including the per-call
+ * field traffic.
+ */
+typedef struct {
+	jlong stream;				// native stream/session handle
+	void *uncompressed_buf;		// uncompressedDirectBuf address
+	void *compressed_buf;		// compressedDirectBuf address
+	jint uncompressed_off;		// uncompressedDirectBufOff
+	jint uncompressed_len;		// uncompressedDirectBufLen
+	jint compressed_off;		// compressedDirectBufOff
+	jint compressed_len;		// compressedDirectBufLen
+	jint buffer_size;			// directBufferSize
+	jboolean finish;
+	jboolean finished;
+	jboolean need_dict;
+} bench_jni_object;
+
+/**
+ * Returns the stub JNIEnv; pass (jobject)&your_bench_jni_object as the
+ * receiver of the instance natives.
+ */
+JNIEnv *bench_jni_env(void);
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif
+
+#if defined HAVE_STDDEF_H
+  #include <stddef.h>
+#else
+  #error 'stddef.h not found'
+#endif
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_io_compress_fastlz_FastLzCompressor.h"
+#include "fastlz.h"
+
+static jfieldID FastLzCompressor_clazz;
+static jfieldID FastLzCompressor_uncompressedDirectBuf;
+static jfieldID FastLzCompressor_uncompressedDirectBufLen;
+static jfieldID FastLzCompressor_compressedDirectBuf;
+static jfieldID FastLzCompressor_directBufferSize;
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_compress_fastlz_FastLzCompressor_initIDs(
+	JNIEnv *env, jclass class
+	) {
+	// The codec is implemented in this library; there is nothing to
+	// dlopen, only the fieldIds to initialize
+    FastLzCompressor_clazz = (*env)->GetStaticFieldID(env, class, "clazz",
+                                                      "Ljava/lang/Class;");
+    FastLzCompressor_uncompressedDirectBuf = (*env)->GetFieldID(env, class,
+    									"uncompressedDirectBuf",
+    									"Ljava/nio/Buffer;");
+    FastLzCompressor_uncompressedDirectBufLen = (*env)->GetFieldID(env, class,
+    										"uncompressedDirectBufLen", "I");
+    FastLzCompressor_compressedDirectBuf = (*env)->GetFieldID(env, class,
+    									"compressedDirectBuf",
+    									"Ljava/nio/Buffer;");
+    FastLzCompressor_directBufferSize = (*env)->GetFieldID(env, class,
+    										"directBufferSize", "I");
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_compress_fastlz_FastLzCompressor_compressBytesDirect(
+	JNIEnv *env, jobject this
+	) {
+	// Get members of FastLzCompressor
+    jobject clazz = (*env)->GetStaticObjectField(env, this,
+                                                 FastLzCompressor_clazz);
+	jobject uncompressed_direct_buf = (*env)->GetObjectField(env, this,
+									FastLzCompressor_uncompressedDirectBuf);
+	jint uncompressed_direct_buf_len = (*env)->GetIntField(env, this,
+									FastLzCompressor_uncompressedDirectBufLen);
+
+	jobject compressed_direct_buf = (*env)->GetObjectField(env, this,
+									FastLzCompressor_compressedDirectBuf);
+	jint buffer_size = (*env)->GetIntField(env, this,
+									FastLzCompressor_directBufferSize);
+
+    // Get the input direct buffer
+    LOCK_CLASS(env, clazz, "FastLzCompressor");
+	uint8_t *uncompressed_bytes = (*env)->GetDirectBufferAddress(env,
+											uncompressed_direct_buf);
+    UNLOCK_CLASS(env, clazz, "FastLzCompressor");
+
+  	if (uncompressed_bytes == 0) {
+    	return (jint)0;
+	}
+
+    // Get the output direct buffer
+    LOCK_CLASS(env, clazz, "FastLzCompressor");
+	uint8_t *compressed_bytes = (*env)->GetDirectBufferAddress(env,
+										compressed_direct_buf);
+    UNLOCK_CLASS(env, clazz, "FastLzCompressor");
+
+  	if (compressed_bytes == 0) {
+		return (jint)0;
+	}
+
+	if (uncompressed_direct_buf_len == 0) {
+		return (jint)0;
+	}
+
+	// Compress one whole block; the output buffer is sized by the Java
+	// side with FASTLZ_MAX_COMPRESSED_LENGTH so this cannot overflow
+	size_t no_compressed_bytes = fastlz_compress(uncompressed_bytes,
+			(size_t)uncompressed_direct_buf_len, compressed_bytes,
+			(size_t)FASTLZ_MAX_COMPRESSED_LENGTH(buffer_size));
+
+	if (no_compressed_bytes == 0) {
+		THROW(env, "java/lang/InternalError",
+			"fastlz output buffer too small");
+		return (jint)0;
+	}
+
+	(*env)->SetIntField(env, this,
+				FastLzCompressor_uncompressedDirectBufLen, 0);
+
+  	return (jint)no_compressed_bytes;
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
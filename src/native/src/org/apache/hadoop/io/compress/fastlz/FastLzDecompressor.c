@@ -0,0 +1,122 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif
+
+#if defined HAVE_STDDEF_H
+  #include <stddef.h>
+#else
+  #error 'stddef.h not found'
+#endif
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_io_compress_fastlz_FastLzDecompressor.h"
+#include "fastlz.h"
+
+static jfieldID FastLzDecompressor_clazz;
+static jfieldID FastLzDecompressor_compressedDirectBuf;
+static jfieldID FastLzDecompressor_compressedDirectBufLen;
+static jfieldID FastLzDecompressor_uncompressedDirectBuf;
+static jfieldID FastLzDecompressor_directBufferSize;
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_compress_fastlz_FastLzDecompressor_initIDs(
+	JNIEnv *env, jclass class
+	) {
+    FastLzDecompressor_clazz = (*env)->GetStaticFieldID(env, class, "clazz",
+                                                      "Ljava/lang/Class;");
+    FastLzDecompressor_compressedDirectBuf = (*env)->GetFieldID(env, class,
+    									"compressedDirectBuf",
+    									"Ljava/nio/Buffer;");
+    FastLzDecompressor_compressedDirectBufLen = (*env)->GetFieldID(env, class,
+    										"compressedDirectBufLen", "I");
+    FastLzDecompressor_uncompressedDirectBuf = (*env)->GetFieldID(env, class,
+    									"uncompressedDirectBuf",
+    									"Ljava/nio/Buffer;");
+    FastLzDecompressor_directBufferSize = (*env)->GetFieldID(env, class,
+    										"directBufferSize", "I");
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_compress_fastlz_FastLzDecompressor_decompressBytesDirect(
+	JNIEnv *env, jobject this
+	) {
+	// Get members of FastLzDecompressor
+    jobject clazz = (*env)->GetStaticObjectField(env, this,
+                                                 FastLzDecompressor_clazz);
+	jobject compressed_direct_buf = (*env)->GetObjectField(env, this,
+									FastLzDecompressor_compressedDirectBuf);
+	jint compressed_direct_buf_len = (*env)->GetIntField(env, this,
+									FastLzDecompressor_compressedDirectBufLen);
+
+	jobject uncompressed_direct_buf = (*env)->GetObjectField(env, this,
+									FastLzDecompressor_uncompressedDirectBuf);
+	jint buffer_size = (*env)->GetIntField(env, this,
+									FastLzDecompressor_directBufferSize);
+
+    // Get the input direct buffer
+    LOCK_CLASS(env, clazz, "FastLzDecompressor");
+	uint8_t *compressed_bytes = (*env)->GetDirectBufferAddress(env,
+										compressed_direct_buf);
+    UNLOCK_CLASS(env, clazz, "FastLzDecompressor");
+
+	if (compressed_bytes == 0) {
+	    return (jint)0;
+	}
+
+    // Get the output direct buffer
+    LOCK_CLASS(env, clazz, "FastLzDecompressor");
+	uint8_t *uncompressed_bytes = (*env)->GetDirectBufferAddress(env,
+											uncompressed_direct_buf);
+    UNLOCK_CLASS(env, clazz, "FastLzDecompressor");
+
+	if (uncompressed_bytes == 0) {
+	    return (jint)0;
+	}
+
+	if (compressed_direct_buf_len == 0) {
+		return (jint)0;
+	}
+
+	// Decompress one whole block
+	size_t no_decompressed_bytes = fastlz_decompress(compressed_bytes,
+			(size_t)compressed_direct_buf_len, uncompressed_bytes,
+			(size_t)buffer_size);
+
+	if (no_decompressed_bytes == 0) {
+		THROW(env, "java/io/IOException", "corrupt fastlz block");
+		return (jint)0;
+	}
+
+	(*env)->SetIntField(env, this,
+				FastLzDecompressor_compressedDirectBufLen, 0);
+
+	return (jint)no_decompressed_bytes;
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
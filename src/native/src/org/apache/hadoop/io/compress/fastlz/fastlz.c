@@ -0,0 +1,175 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fastlz.h"
+
+#include <string.h>
+
+#define FASTLZ_HASH_LOG 13
+#define FASTLZ_HASH_SIZE (1 << FASTLZ_HASH_LOG)
+#define FASTLZ_MAX_OFFSET 8192
+#define FASTLZ_MAX_LITERAL 32
+#define FASTLZ_MAX_MATCH 264 /* 7 + 255 + 2 */
+#define FASTLZ_MIN_MATCH 3
+
+/* hash the three bytes at p down to FASTLZ_HASH_LOG bits */
+static uint32_t fastlz_hash(const uint8_t *p)
+{
+	uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+	return (v * 2654435761U) >> (32 - FASTLZ_HASH_LOG);
+}
+
+/* emit the pending literal run [anchor, ip); returns NULL on overflow */
+static uint8_t *emit_literals(const uint8_t *anchor, const uint8_t *ip,
+                              uint8_t *op, const uint8_t *out_end)
+{
+	while (ip - anchor > 0) {
+		size_t run = ip - anchor;
+		if (run > FASTLZ_MAX_LITERAL) {
+			run = FASTLZ_MAX_LITERAL;
+		}
+		if (op + 1 + run > out_end) {
+			return NULL;
+		}
+		*op++ = (uint8_t)(run - 1);
+		memcpy(op, anchor, run);
+		op += run;
+		anchor += run;
+	}
+	return op;
+}
+
+size_t fastlz_compress(const uint8_t *in, size_t in_len,
+                       uint8_t *out, size_t out_cap)
+{
+	/* positions + 1 into in; 0 marks an empty slot */
+	uint32_t htab[FASTLZ_HASH_SIZE];
+	const uint8_t *ip = in;
+	const uint8_t *anchor = in;
+	const uint8_t *in_end = in + in_len;
+	uint8_t *op = out;
+	const uint8_t *out_end = out + out_cap;
+
+	memset(htab, 0, sizeof(htab));
+
+	while (ip + FASTLZ_MIN_MATCH <= in_end) {
+		uint32_t h = fastlz_hash(ip);
+		const uint8_t *ref = htab[h] ? in + htab[h] - 1 : NULL;
+		htab[h] = (uint32_t)(ip - in) + 1;
+
+		if (ref != NULL && ip - ref <= FASTLZ_MAX_OFFSET &&
+		    ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2]) {
+			/* extend the match */
+			size_t len = FASTLZ_MIN_MATCH;
+			size_t max = in_end - ip;
+			size_t off = ip - ref;
+			if (max > FASTLZ_MAX_MATCH) {
+				max = FASTLZ_MAX_MATCH;
+			}
+			while (len < max && ref[len] == ip[len]) {
+				len++;
+			}
+
+			op = emit_literals(anchor, ip, op, out_end);
+			if (op == NULL) {
+				return 0;
+			}
+
+			if (len - 2 < 7) {
+				if (op + 2 > out_end) {
+					return 0;
+				}
+				*op++ = (uint8_t)(((len - 2) << 5) | ((off - 1) >> 8));
+			} else {
+				if (op + 3 > out_end) {
+					return 0;
+				}
+				*op++ = (uint8_t)((7 << 5) | ((off - 1) >> 8));
+				*op++ = (uint8_t)(len - 2 - 7);
+			}
+			*op++ = (uint8_t)(off - 1);
+
+			ip += len;
+			anchor = ip;
+			/* seed the table at the match tail so runs keep chaining */
+			if (ip + FASTLZ_MIN_MATCH <= in_end) {
+				htab[fastlz_hash(ip - 1)] = (uint32_t)(ip - 1 - in) + 1;
+			}
+		} else {
+			ip++;
+		}
+	}
+
+	op = emit_literals(anchor, in_end, op, out_end);
+	if (op == NULL) {
+		return 0;
+	}
+	return op - out;
+}
+
+size_t fastlz_decompress(const uint8_t *in, size_t in_len,
+                         uint8_t *out, size_t out_cap)
+{
+	const uint8_t *ip = in;
+	const uint8_t *in_end = in + in_len;
+	uint8_t *op = out;
+	const uint8_t *out_end = out + out_cap;
+
+	while (ip < in_end) {
+		uint32_t ctrl = *ip++;
+
+		if (ctrl < FASTLZ_MAX_LITERAL) {
+			/* literal run */
+			size_t run = ctrl + 1;
+			if (ip + run > in_end || op + run > out_end) {
+				return 0;
+			}
+			memcpy(op, ip, run);
+			ip += run;
+			op += run;
+		} else {
+			/* back reference */
+			size_t len = ctrl >> 5;
+			size_t off;
+			if (len == 7) {
+				if (ip >= in_end) {
+					return 0;
+				}
+				len += *ip++;
+			}
+			len += 2;
+			if (ip >= in_end) {
+				return 0;
+			}
+			off = ((ctrl & 0x1f) << 8 | *ip++) + 1;
+			if (off > (size_t)(op - out) || op + len > out_end) {
+				return 0;
+			}
+			/* byte copy - the source may overlap the destination */
+			const uint8_t *ref = op - off;
+			while (len-- > 0) {
+				*op++ = *ref++;
+			}
+		}
+	}
+	return op - out;
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
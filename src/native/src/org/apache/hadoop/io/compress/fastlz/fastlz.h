@@ -0,0 +1,61 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined ORG_APACHE_HADOOP_IO_COMPRESS_FASTLZ_FASTLZ_H
+#define ORG_APACHE_HADOOP_IO_COMPRESS_FASTLZ_FASTLZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A byte-oriented LZ77 block format built for speed over ratio, for
+ * shuffle and other temporary data where zlib costs more CPU than the
+ * bytes saved are worth. A block is a sequence of ops, each led by a
+ * control byte:
+ *
+ *   000LLLLL              literal run of L+1 bytes (1..32) follows
+ *   LLLooooo oooooooo     back reference: length L+2 (or, when L is 7,
+ *                         an extra length byte follows and the length
+ *                         is 9 plus that byte, up to 264); the 13-bit
+ *                         offset plus 1 (1..8192) counts back from the
+ *                         current output position
+ *
+ * Blocks are self-contained: no state carries across calls, which is
+ * what the BlockCompressorStream framing expects.
+ */
+
+/* worst case growth: one control byte per 32 literals, rounded up */
+#define FASTLZ_MAX_COMPRESSED_LENGTH(len) ((len) + ((len) >> 5) + 2)
+
+/**
+ * Compress one block. Returns the number of bytes written to out, or
+ * 0 if the output would not fit in out_cap (size out with
+ * FASTLZ_MAX_COMPRESSED_LENGTH to make that impossible).
+ */
+size_t fastlz_compress(const uint8_t *in, size_t in_len,
+                       uint8_t *out, size_t out_cap);
+
+/**
+ * Decompress one block. Returns the number of bytes written to out,
+ * or 0 if the input is corrupt or the output would exceed out_cap.
+ * Never reads or writes out of bounds on corrupt input.
+ */
+size_t fastlz_decompress(const uint8_t *in, size_t in_len,
+                         uint8_t *out, size_t out_cap);
+
+#endif
@@ -57,6 +57,32 @@ static jfieldID ZlibCompressor_directBufferSize;
 static jfieldID ZlibCompressor_finish;
 static jfieldID ZlibCompressor_finished;
 
+/**
+ * The native side of a compressor instance. The z_stream must stay the
+ * first member: the jlong handle held in ZlibCompressor.stream is cast
+ * straight to z_stream* by the other natives (ZSTREAM).
+ *
+ * The two direct buffers are allocated once in the ZlibCompressor
+ * constructor and never replaced, so their addresses are resolved on
+ * the first deflateBytesDirect and kept here. That takes the object
+ * field walk, the class lock and the GetDirectBufferAddress calls out
+ * of the per-buffer-full path, which is the hottest JNI crossing of
+ * the native compression codecs.
+ *
+ * A preset dictionary loaded via setPresetDictionary is copied into
+ * the session and re-applied after every deflateReset, so a pooled
+ * compressor keeps its trained dictionary across the many small
+ * blocks it compresses without a per-block dictionary call from Java.
+ */
+typedef struct {
+	z_stream stream;
+	Bytef *uncompressed_bytes;	// address of uncompressedDirectBuf
+	Bytef *compressed_bytes;	// address of compressedDirectBuf
+	jint buffer_size;			// directBufferSize
+	Bytef *dictionary;			// preset dictionary, owned by the session
+	uInt dictionary_len;
+} zlib_session;
+
 static int (*dlsym_deflateInit2_)(z_streamp, int, int, int, int, int, const char *, int);
 static int (*dlsym_deflate)(z_streamp, int);
 static int (*dlsym_deflateSetDictionary)(z_streamp, const Bytef *, uInt);
@@ -106,13 +132,14 @@ JNIEXPORT jlong JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_init(
 	JNIEnv *env, jclass class, jint level, jint strategy, jint windowBits
 	) {
-	// Create a z_stream
-    z_stream *stream = malloc(sizeof(z_stream));
-    if (!stream) {
+	// Create a session holding the z_stream and the cached buffer state
+    zlib_session *session = malloc(sizeof(zlib_session));
+    if (!session) {
 		THROW(env, "java/lang/OutOfMemoryError", NULL);
 		return (jlong)0;
     }
-    memset((void*)stream, 0, sizeof(z_stream));
+    memset((void*)session, 0, sizeof(zlib_session));
+    z_stream *stream = &session->stream;
 
 	// Initialize stream
 	static const int memLevel = 8; 							// See zconf.h
@@ -121,7 +148,7 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_init(
     			
     if (rv != Z_OK) {
 	    // Contingency - Report error by throwing appropriate exceptions
-	    free(stream);
+	    free(session);
 	    stream = NULL;
 	
 		switch (rv) {
@@ -175,63 +202,121 @@ Java_org_apache_hadoop_io_compress_ZlibCompressor_setDictionary(
     }
 }
 
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_setPresetDictionary(
+	JNIEnv *env, jclass class, jlong stream,
+	jarray b, jint off, jint len
+	) {
+    zlib_session *session = (zlib_session *)ZSTREAM(stream);
+
+    // Keep a private copy: the java array is unreachable once this
+    // call returns, but the dictionary is re-applied on every reset
+    Bytef *copy = malloc(len);
+    if (!copy) {
+		THROW(env, "java/lang/OutOfMemoryError", NULL);
+		return;
+    }
+    Bytef *buf = (*env)->GetPrimitiveArrayCritical(env, b, 0);
+    if (!buf) {
+		free(copy);
+        return;
+    }
+    memcpy(copy, buf + off, len);
+    (*env)->ReleasePrimitiveArrayCritical(env, b, buf, 0);
+
+    int rv = dlsym_deflateSetDictionary(&session->stream, copy, len);
+    if (rv != Z_OK) {
+		free(copy);
+	    switch (rv) {
+		    case Z_STREAM_ERROR:
+			{
+		    	THROW(env, "java/lang/IllegalArgumentException", NULL);
+			}
+			break;
+	    	default:
+			{
+				THROW(env, "java/lang/InternalError", session->stream.msg);
+			}
+			break;
+	    }
+	    return;
+    }
+
+    // Only adopted once the stream accepted it
+    if (session->dictionary) {
+		free(session->dictionary);
+    }
+    session->dictionary = copy;
+    session->dictionary_len = len;
+}
+
 JNIEXPORT jint JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_deflateBytesDirect(
 	JNIEnv *env, jobject this
 	) {
-	// Get members of ZlibCompressor
-    z_stream *stream = ZSTREAM(
-    						(*env)->GetLongField(env, this, 
+	// Get the session of this ZlibCompressor
+    zlib_session *session = (zlib_session *)ZSTREAM(
+    						(*env)->GetLongField(env, this,
     									ZlibCompressor_stream)
     					);
-    if (!stream) {
+    if (!session) {
 		THROW(env, "java/lang/NullPointerException", NULL);
 		return (jint)0;
-    } 
-
-    // Get members of ZlibCompressor
-    jobject clazz = (*env)->GetStaticObjectField(env, this, 
-                                                 ZlibCompressor_clazz);
-	jobject uncompressed_direct_buf = (*env)->GetObjectField(env, this, 
-									ZlibCompressor_uncompressedDirectBuf);
-	jint uncompressed_direct_buf_off = (*env)->GetIntField(env, this, 
+    }
+    z_stream *stream = &session->stream;
+
+    if (session->uncompressed_bytes == NULL) {
+		// First crossing for this compressor - resolve the direct buffer
+		// addresses once and keep them in the session; the buffers are
+		// allocated in the constructor and never replaced
+		jobject clazz = (*env)->GetStaticObjectField(env, this,
+	                                                 ZlibCompressor_clazz);
+		jobject uncompressed_direct_buf = (*env)->GetObjectField(env, this,
+										ZlibCompressor_uncompressedDirectBuf);
+		jobject compressed_direct_buf = (*env)->GetObjectField(env, this,
+										ZlibCompressor_compressedDirectBuf);
+
+	    // Get the input direct buffer
+	    LOCK_CLASS(env, clazz, "ZlibCompressor");
+		Bytef* uncompressed_bytes = (*env)->GetDirectBufferAddress(env,
+												uncompressed_direct_buf);
+	    UNLOCK_CLASS(env, clazz, "ZlibCompressor");
+
+	  	if (uncompressed_bytes == 0) {
+	    	return (jint)0;
+		}
+
+	    // Get the output direct buffer
+	    LOCK_CLASS(env, clazz, "ZlibCompressor");
+		Bytef* compressed_bytes = (*env)->GetDirectBufferAddress(env,
+											compressed_direct_buf);
+	    UNLOCK_CLASS(env, clazz, "ZlibCompressor");
+
+	  	if (compressed_bytes == 0) {
+			return (jint)0;
+		}
+
+		session->uncompressed_bytes = uncompressed_bytes;
+		session->compressed_bytes = compressed_bytes;
+		session->buffer_size = (*env)->GetIntField(env, this,
+										ZlibCompressor_directBufferSize);
+    }
+
+	// Only the per-call scalars are fetched on the hot path
+	jint uncompressed_direct_buf_off = (*env)->GetIntField(env, this,
 									ZlibCompressor_uncompressedDirectBufOff);
-	jint uncompressed_direct_buf_len = (*env)->GetIntField(env, this, 
+	jint uncompressed_direct_buf_len = (*env)->GetIntField(env, this,
 									ZlibCompressor_uncompressedDirectBufLen);
-
-	jobject compressed_direct_buf = (*env)->GetObjectField(env, this, 
-									ZlibCompressor_compressedDirectBuf);
-	jint compressed_direct_buf_len = (*env)->GetIntField(env, this, 
-									ZlibCompressor_directBufferSize);
+	jint compressed_direct_buf_len = session->buffer_size;
 
 	jboolean finish = (*env)->GetBooleanField(env, this, ZlibCompressor_finish);
 
-    // Get the input direct buffer
-    LOCK_CLASS(env, clazz, "ZlibCompressor");
-	Bytef* uncompressed_bytes = (*env)->GetDirectBufferAddress(env, 
-											uncompressed_direct_buf);
-    UNLOCK_CLASS(env, clazz, "ZlibCompressor");
-    
-  	if (uncompressed_bytes == 0) {
-    	return (jint)0;
-	}
-	
-    // Get the output direct buffer
-    LOCK_CLASS(env, clazz, "ZlibCompressor");
-	Bytef* compressed_bytes = (*env)->GetDirectBufferAddress(env, 
-										compressed_direct_buf);
-    UNLOCK_CLASS(env, clazz, "ZlibCompressor");
-
-  	if (compressed_bytes == 0) {
-		return (jint)0;
-	}
-	
 	// Re-calibrate the z_stream
-  	stream->next_in = uncompressed_bytes + uncompressed_direct_buf_off;
-  	stream->next_out = compressed_bytes;
+  	stream->next_in = session->uncompressed_bytes + uncompressed_direct_buf_off;
+  	stream->next_out = session->compressed_bytes;
   	stream->avail_in = uncompressed_direct_buf_len;
 	stream->avail_out = compressed_direct_buf_len;
-	
+
 	// Compress
 	int rv = dlsym_deflate(stream, finish ? Z_FINISH : Z_NO_FLUSH);
 
@@ -282,8 +367,17 @@ JNIEXPORT void JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_reset(
 	JNIEnv *env, jclass class, jlong stream
 	) {
-    if (dlsym_deflateReset(ZSTREAM(stream)) != Z_OK) {
+    zlib_session *session = (zlib_session *)ZSTREAM(stream);
+    if (dlsym_deflateReset(&session->stream) != Z_OK) {
 		THROW(env, "java/lang/InternalError", NULL);
+		return;
+    }
+    // deflateReset discards the sliding window, so the session's preset
+    // dictionary has to be loaded again for the next block
+    if (session->dictionary &&
+		dlsym_deflateSetDictionary(&session->stream, session->dictionary,
+					session->dictionary_len) != Z_OK) {
+		THROW(env, "java/lang/InternalError", session->stream.msg);
     }
 }
 
@@ -291,10 +385,14 @@ JNIEXPORT void JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_end(
 	JNIEnv *env, jclass class, jlong stream
 	) {
-    if (dlsym_deflateEnd(ZSTREAM(stream)) == Z_STREAM_ERROR) {
+    zlib_session *session = (zlib_session *)ZSTREAM(stream);
+    if (dlsym_deflateEnd(&session->stream) == Z_STREAM_ERROR) {
 		THROW(env, "java/lang/InternalError", NULL);
     } else {
-		free(ZSTREAM(stream));
+		if (session->dictionary) {
+		    free(session->dictionary);
+		}
+		free(session);
     }
 }
 
@@ -57,6 +57,37 @@ static jfieldID ZlibDecompressor_directBufferSize;
 static jfieldID ZlibDecompressor_needDict;
 static jfieldID ZlibDecompressor_finished;
 
+/**
+ * The native side of a decompressor instance. The z_stream must stay
+ * the first member: the jlong handle held in ZlibDecompressor.stream
+ * is cast straight to z_stream* by the other natives (ZSTREAM).
+ *
+ * The two direct buffers are allocated once in the ZlibDecompressor
+ * constructor and never replaced, so their addresses are resolved on
+ * the first inflate call and kept here, as ZlibCompressor.c does for
+ * the deflate side.
+ *
+ * A preset dictionary loaded via setPresetDictionary is copied into
+ * the session and used to answer Z_NEED_DICT in place: inflate keeps
+ * going within the same call instead of surfacing needsDictionary()
+ * to Java, and the dictionary survives reset() so a pooled
+ * decompressor handles a run of dictionary-compressed blocks without
+ * any per-block dictionary traffic.
+ */
+typedef struct {
+	z_stream stream;
+	Bytef *compressed_bytes;	// address of compressedDirectBuf
+	Bytef *uncompressed_bytes;	// address of uncompressedDirectBuf
+	jint buffer_size;			// directBufferSize
+	int concatenated;			// continue into the next gzip member
+	Bytef *dictionary;			// preset dictionary, owned by the session
+	uInt dictionary_len;
+	// inflateReset zeroes the z_stream totals, so the bytes from the
+	// members already completed on this stream are kept here
+	unsigned long member_total_in;
+	unsigned long member_total_out;
+} zlib_d_session;
+
 static int (*dlsym_inflateInit2_)(z_streamp, int, const char *, int);
 static int (*dlsym_inflate)(z_streamp, int);
 static int (*dlsym_inflateSetDictionary)(z_streamp, const Bytef *, uInt);
@@ -106,19 +137,20 @@ JNIEXPORT jlong JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_init(
 	JNIEnv *env, jclass cls, jint windowBits
 	) {
-    z_stream *stream = malloc(sizeof(z_stream));
-    memset((void*)stream, 0, sizeof(z_stream));
+    zlib_d_session *session = malloc(sizeof(zlib_d_session));
 
-    if (stream == 0) {
+    if (session == 0) {
 		THROW(env, "java/lang/OutOfMemoryError", NULL);
 		return (jlong)0;
-    } 
-    
+    }
+    memset((void*)session, 0, sizeof(zlib_d_session));
+    z_stream *stream = &session->stream;
+
     int rv = dlsym_inflateInit2_(stream, windowBits, ZLIB_VERSION, sizeof(z_stream));
 
 	if (rv != Z_OK) {
 	    // Contingency - Report error by throwing appropriate exceptions
-		free(stream);
+		free(session);
 		stream = NULL;
 		
 		switch (rv) {
@@ -170,64 +202,143 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_setDictionary(
 	}
 }
 
-JNIEXPORT jint JNICALL
-Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_inflateBytesDirect(
-	JNIEnv *env, jobject this
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_setPresetDictionary(
+	JNIEnv *env, jclass cls, jlong stream,
+	jarray b, jint off, jint len
 	) {
-	// Get members of ZlibDecompressor
-    z_stream *stream = ZSTREAM(
-    						(*env)->GetLongField(env, this, 
-    									ZlibDecompressor_stream)
-    					);
-    if (!stream) {
-		THROW(env, "java/lang/NullPointerException", NULL);
-		return (jint)0;
-    } 
+    zlib_d_session *session = (zlib_d_session *)ZSTREAM(stream);
+
+    // Keep a private copy: inflate only asks for the dictionary when it
+    // hits Z_NEED_DICT, which can be long after this call returns
+    Bytef *copy = malloc(len);
+    if (!copy) {
+		THROW(env, "java/lang/OutOfMemoryError", NULL);
+		return;
+    }
+    Bytef *buf = (*env)->GetPrimitiveArrayCritical(env, b, 0);
+    if (!buf) {
+		free(copy);
+		THROW(env, "java/lang/InternalError", NULL);
+        return;
+    }
+    memcpy(copy, buf + off, len);
+    (*env)->ReleasePrimitiveArrayCritical(env, b, buf, 0);
 
-    // Get members of ZlibDecompressor
-    jobject clazz = (*env)->GetStaticObjectField(env, this, 
+    if (session->dictionary) {
+		free(session->dictionary);
+    }
+    session->dictionary = copy;
+    session->dictionary_len = len;
+}
+
+/**
+ * First crossing for this decompressor - resolve the direct buffer
+ * addresses once and keep them in the session; the buffers are
+ * allocated in the constructor and never replaced.
+ * Returns 0 on success, non-zero if an address could not be resolved.
+ */
+static int inflate_cache_buffers(JNIEnv *env, jobject this,
+	zlib_d_session *session
+	) {
+    jobject clazz = (*env)->GetStaticObjectField(env, this,
                                                  ZlibDecompressor_clazz);
-	jarray compressed_direct_buf = (jarray)(*env)->GetObjectField(env, this, 
+	jobject compressed_direct_buf = (*env)->GetObjectField(env, this,
 											ZlibDecompressor_compressedDirectBuf);
-	jint compressed_direct_buf_off = (*env)->GetIntField(env, this, 
-									ZlibDecompressor_compressedDirectBufOff);
-	jint compressed_direct_buf_len = (*env)->GetIntField(env, this, 
-									ZlibDecompressor_compressedDirectBufLen);
-
-	jarray uncompressed_direct_buf = (jarray)(*env)->GetObjectField(env, this, 
+	jobject uncompressed_direct_buf = (*env)->GetObjectField(env, this,
 											ZlibDecompressor_uncompressedDirectBuf);
-	jint uncompressed_direct_buf_len = (*env)->GetIntField(env, this, 
-										ZlibDecompressor_directBufferSize);
 
     // Get the input direct buffer
     LOCK_CLASS(env, clazz, "ZlibDecompressor");
-	Bytef *compressed_bytes = (*env)->GetDirectBufferAddress(env, 
+	Bytef *compressed_bytes = (*env)->GetDirectBufferAddress(env,
 										compressed_direct_buf);
     UNLOCK_CLASS(env, clazz, "ZlibDecompressor");
-    
+
 	if (!compressed_bytes) {
-	    return (jint)0;
+	    return 1;
 	}
-	
+
     // Get the output direct buffer
     LOCK_CLASS(env, clazz, "ZlibDecompressor");
-	Bytef *uncompressed_bytes = (*env)->GetDirectBufferAddress(env, 
+	Bytef *uncompressed_bytes = (*env)->GetDirectBufferAddress(env,
 											uncompressed_direct_buf);
     UNLOCK_CLASS(env, clazz, "ZlibDecompressor");
 
 	if (!uncompressed_bytes) {
-	    return (jint)0;
+	    return 1;
 	}
-	
+
+	session->compressed_bytes = compressed_bytes;
+	session->uncompressed_bytes = uncompressed_bytes;
+	session->buffer_size = (*env)->GetIntField(env, this,
+									ZlibDecompressor_directBufferSize);
+	return 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_inflateBytesDirect(
+	JNIEnv *env, jobject this
+	) {
+	// Get the session of this ZlibDecompressor
+    zlib_d_session *session = (zlib_d_session *)ZSTREAM(
+    						(*env)->GetLongField(env, this,
+    									ZlibDecompressor_stream)
+    					);
+    if (!session) {
+		THROW(env, "java/lang/NullPointerException", NULL);
+		return (jint)0;
+    }
+    z_stream *stream = &session->stream;
+
+    if (session->compressed_bytes == NULL &&
+		inflate_cache_buffers(env, this, session) != 0) {
+	    return (jint)0;
+    }
+
+	// Only the per-call scalars are fetched on the hot path
+	jint compressed_direct_buf_off = (*env)->GetIntField(env, this,
+									ZlibDecompressor_compressedDirectBufOff);
+	jint compressed_direct_buf_len = (*env)->GetIntField(env, this,
+									ZlibDecompressor_compressedDirectBufLen);
+	jint uncompressed_direct_buf_len = session->buffer_size;
+
 	// Re-calibrate the z_stream
-	stream->next_in  = compressed_bytes + compressed_direct_buf_off;
-	stream->next_out = uncompressed_bytes;
+	stream->next_in  = session->compressed_bytes + compressed_direct_buf_off;
+	stream->next_out = session->uncompressed_bytes;
 	stream->avail_in  = compressed_direct_buf_len;
 	stream->avail_out = uncompressed_direct_buf_len;
-	
+
 	// Decompress
 	int rv = dlsym_inflate(stream, Z_PARTIAL_FLUSH);
 
+	// A dictionary loaded on the session answers Z_NEED_DICT in place;
+	// a mismatch (Z_DATA_ERROR) falls through to the error handling
+	if (rv == Z_NEED_DICT && session->dictionary) {
+		rv = dlsym_inflateSetDictionary(stream, session->dictionary,
+					session->dictionary_len);
+		if (rv == Z_OK) {
+			rv = dlsym_inflate(stream, Z_PARTIAL_FLUSH);
+		}
+	}
+
+	// In concatenated mode a member ending with input left over means
+	// another gzip member follows: consume its header and keep going
+	// within this call instead of bouncing back through JNI to reset
+	while (rv == Z_STREAM_END && session->concatenated &&
+			stream->avail_in > 0) {
+		session->member_total_in += stream->total_in;
+		session->member_total_out += stream->total_out;
+		if (dlsym_inflateReset(stream) != Z_OK) {
+			rv = Z_STREAM_ERROR;
+			break;
+		}
+		rv = Z_OK;
+		if (stream->avail_out == 0) {
+			break;
+		}
+		rv = dlsym_inflate(stream, Z_PARTIAL_FLUSH);
+	}
+
 	// Contingency? - Report error by throwing appropriate exceptions
 	int no_decompressed_bytes = 0;	
 	switch (rv) {
@@ -277,37 +388,201 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_inflateBytesDirect(
     return no_decompressed_bytes;
 }
 
+/**
+ * Inflate from compressedDirectBuf into a chain of caller-supplied
+ * destination direct buffers, filling each from index 0 up to its
+ * capacity before moving to the next, all in one JNI crossing. The
+ * segments are filled in order, so only the last one touched can be
+ * partially filled; the Java side recovers the per-segment lengths
+ * from the returned total.
+ */
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_inflateBytesDirectChain(
+	JNIEnv *env, jobject this, jobjectArray dsts
+	) {
+	// Get the session of this ZlibDecompressor
+    zlib_d_session *session = (zlib_d_session *)ZSTREAM(
+    						(*env)->GetLongField(env, this,
+    									ZlibDecompressor_stream)
+    					);
+    if (!session) {
+		THROW(env, "java/lang/NullPointerException", NULL);
+		return (jint)0;
+    }
+    z_stream *stream = &session->stream;
+
+    if (session->compressed_bytes == NULL &&
+		inflate_cache_buffers(env, this, session) != 0) {
+	    return (jint)0;
+    }
+
+	jint compressed_direct_buf_off = (*env)->GetIntField(env, this,
+									ZlibDecompressor_compressedDirectBufOff);
+	jint compressed_direct_buf_len = (*env)->GetIntField(env, this,
+									ZlibDecompressor_compressedDirectBufLen);
+
+	stream->next_in  = session->compressed_bytes + compressed_direct_buf_off;
+	stream->avail_in = compressed_direct_buf_len;
+
+	jsize num_dsts = (*env)->GetArrayLength(env, dsts);
+	jint total_decompressed_bytes = 0;
+	int done = 0;	// stream end, dictionary needed, stall or error
+	int error = 0;
+	jsize i;
+
+	for (i = 0; i < num_dsts && !done; i++) {
+		jobject dst = (*env)->GetObjectArrayElement(env, dsts, i);
+		Bytef *dst_bytes = (*env)->GetDirectBufferAddress(env, dst);
+		jlong dst_capacity = (*env)->GetDirectBufferCapacity(env, dst);
+		(*env)->DeleteLocalRef(env, dst);
+
+		if (!dst_bytes || dst_capacity < 0) {
+			error = 1;
+			break;
+		}
+
+		stream->next_out = dst_bytes;
+		stream->avail_out = (uInt)dst_capacity;
+
+		// Drain into this segment; pending output from the previous
+		// segment boundary is produced even when avail_in is 0
+		while (stream->avail_out > 0 && !done) {
+			uInt avail_out_before = stream->avail_out;
+			int rv = dlsym_inflate(stream, Z_PARTIAL_FLUSH);
+
+			switch (rv) {
+				case Z_STREAM_END:
+				{
+				    // in concatenated mode the next gzip member continues
+				    // in this same crossing
+				    if (session->concatenated && stream->avail_in > 0) {
+						session->member_total_in += stream->total_in;
+						session->member_total_out += stream->total_out;
+						if (dlsym_inflateReset(stream) != Z_OK) {
+						    done = 1;
+						    error = Z_STREAM_ERROR;
+						}
+				    } else {
+						(*env)->SetBooleanField(env, this, ZlibDecompressor_finished, JNI_TRUE);
+						done = 1;
+				    }
+				}
+				break;
+				case Z_OK:
+				{
+				    // no input left and no output produced: come back
+				    // with more input rather than spinning
+				    if (stream->avail_in == 0 &&
+						stream->avail_out == avail_out_before) {
+						done = 1;
+				    }
+				}
+				break;
+				case Z_NEED_DICT:
+				{
+				    // a session dictionary is applied in place and the
+				    // segment keeps filling; without one, bounce the
+				    // request up to Java as needsDictionary()
+				    if (session->dictionary) {
+						int drv = dlsym_inflateSetDictionary(stream,
+									session->dictionary,
+									session->dictionary_len);
+						if (drv != Z_OK) {
+						    done = 1;
+						    error = drv;
+						}
+				    } else {
+						(*env)->SetBooleanField(env, this, ZlibDecompressor_needDict, JNI_TRUE);
+						done = 1;
+				    }
+				}
+				break;
+				case Z_BUF_ERROR:
+				{
+				    done = 1;
+				}
+				break;
+				default:
+				{
+				    done = 1;
+				    error = rv;
+				}
+				break;
+			}
+		}
+
+		total_decompressed_bytes += (jint)dst_capacity - stream->avail_out;
+	}
+
+	// Record how much input was consumed whether or not we then throw
+	compressed_direct_buf_off += compressed_direct_buf_len - stream->avail_in;
+	(*env)->SetIntField(env, this, ZlibDecompressor_compressedDirectBufOff,
+				compressed_direct_buf_off);
+	(*env)->SetIntField(env, this, ZlibDecompressor_compressedDirectBufLen,
+				stream->avail_in);
+
+	if (error == 1) {
+		THROW(env, "java/lang/IllegalArgumentException",
+			"destination is not a direct buffer");
+	} else if (error == Z_DATA_ERROR) {
+		THROW(env, "java/io/IOException", stream->msg);
+	} else if (error == Z_MEM_ERROR) {
+		THROW(env, "java/lang/OutOfMemoryError", NULL);
+	} else if (error != 0) {
+		THROW(env, "java/lang/InternalError", stream->msg);
+	}
+
+	return total_decompressed_bytes;
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_setConcatenated(
+	JNIEnv *env, jclass cls, jlong stream, jboolean concatenated
+	) {
+    ((zlib_d_session *)ZSTREAM(stream))->concatenated = concatenated;
+}
+
 JNIEXPORT jlong JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_getBytesRead(
 	JNIEnv *env, jclass cls, jlong stream
 	) {
-    return (ZSTREAM(stream))->total_in;
+    zlib_d_session *session = (zlib_d_session *)ZSTREAM(stream);
+    return session->member_total_in + session->stream.total_in;
 }
 
 JNIEXPORT jlong JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_getBytesWritten(
 	JNIEnv *env, jclass cls, jlong stream
 	) {
-    return (ZSTREAM(stream))->total_out;
+    zlib_d_session *session = (zlib_d_session *)ZSTREAM(stream);
+    return session->member_total_out + session->stream.total_out;
 }
 
 JNIEXPORT void JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_reset(
 	JNIEnv *env, jclass cls, jlong stream
 	) {
-    if (dlsym_inflateReset(ZSTREAM(stream)) != Z_OK) {
+    zlib_d_session *session = (zlib_d_session *)ZSTREAM(stream);
+    if (dlsym_inflateReset(&session->stream) != Z_OK) {
 		THROW(env, "java/lang/InternalError", 0);
+		return;
     }
+    session->member_total_in = 0;
+    session->member_total_out = 0;
 }
 
 JNIEXPORT void JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_end(
 	JNIEnv *env, jclass cls, jlong stream
 	) {
-    if (dlsym_inflateEnd(ZSTREAM(stream)) == Z_STREAM_ERROR) {
+    zlib_d_session *session = (zlib_d_session *)ZSTREAM(stream);
+    if (dlsym_inflateEnd(&session->stream) == Z_STREAM_ERROR) {
 		THROW(env, "java/lang/InternalError", 0);
     } else {
-		free(ZSTREAM(stream));
+		if (session->dictionary) {
+		    free(session->dictionary);
+		}
+		free(session);
     }
 }
 
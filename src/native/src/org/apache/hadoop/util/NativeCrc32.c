@@ -0,0 +1,92 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDDEF_H
+  #include <stddef.h>
+#else
+  #error 'stddef.h not found'
+#endif
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_util_NativeCrc32.h"
+#include "bulk_crc32.h"
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_util_NativeCrc32_initNative(
+	JNIEnv *env, jclass class
+	) {
+	bulk_crc32_init();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_apache_hadoop_util_NativeCrc32_isHardwareCrc32C(
+	JNIEnv *env, jclass class
+	) {
+	return bulk_crc32c_hardware() ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Verify all the chunks covered by one call; returns the index of the
+ * first bad chunk, or -1 when everything verifies. The Java side turns
+ * a bad index into a ChecksumException with the right file offset.
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_hadoop_util_NativeCrc32_nativeVerifyChunkedSums(
+	JNIEnv *env, jclass class, jint bytes_per_checksum, jint checksum_type,
+	jobject sums_buf, jint sums_off, jobject data_buf, jint data_off,
+	jint data_len
+	) {
+	uint8_t *sums = (*env)->GetDirectBufferAddress(env, sums_buf);
+	uint8_t *data = (*env)->GetDirectBufferAddress(env, data_buf);
+
+	if (!sums || !data) {
+		THROW(env, "java/lang/IllegalArgumentException",
+			"not a direct buffer");
+		return (jlong)-1;
+	}
+
+	return (jlong)bulk_crc32_verify(data + data_off, (size_t)data_len,
+			sums + sums_off, checksum_type, bytes_per_checksum);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_util_NativeCrc32_nativeCalculateChunkedSums(
+	JNIEnv *env, jclass class, jint bytes_per_checksum, jint checksum_type,
+	jobject sums_buf, jint sums_off, jobject data_buf, jint data_off,
+	jint data_len
+	) {
+	uint8_t *sums = (*env)->GetDirectBufferAddress(env, sums_buf);
+	uint8_t *data = (*env)->GetDirectBufferAddress(env, data_buf);
+
+	if (!sums || !data) {
+		THROW(env, "java/lang/IllegalArgumentException",
+			"not a direct buffer");
+		return;
+	}
+
+	bulk_crc32_calculate(data + data_off, (size_t)data_len,
+			sums + sums_off, checksum_type, bytes_per_checksum);
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
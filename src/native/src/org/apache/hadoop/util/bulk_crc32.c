@@ -0,0 +1,218 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Bulk CRC32 and CRC32C kernels for HDFS checksumming. A 512-byte
+ * chunk is far too small to amortize a JNI crossing, so the functions
+ * here checksum a whole run of chunks per call; the JNI layer is in
+ * NativeCrc32.c. CRC32C uses the SSE4.2 crc32 instruction when the
+ * CPU has it, and both algorithms fall back to slice-by-8 tables.
+ */
+
+#include "bulk_crc32.h"
+
+#include <string.h>
+
+#define CRC32_ZLIB_POLY_REV 0xEDB88320U /* reversed 0x04C11DB7 */
+#define CRC32C_POLY_REV     0x82F63B78U /* reversed 0x1EDC6F41 */
+
+/* slice-by-8 tables, one set per polynomial */
+static uint32_t crc_tables[2][8][256];
+static int crc32c_hw = 0;
+static int crc_initialized = 0;
+
+static void build_tables(uint32_t tables[8][256], uint32_t poly)
+{
+	int i, j;
+	for (i = 0; i < 256; i++) {
+		uint32_t crc = (uint32_t)i;
+		for (j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+		}
+		tables[0][i] = crc;
+	}
+	for (i = 0; i < 256; i++) {
+		for (j = 1; j < 8; j++) {
+			tables[j][i] = (tables[j - 1][i] >> 8) ^
+				tables[0][tables[j - 1][i] & 0xff];
+		}
+	}
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+static int probe_sse42(void)
+{
+	uint32_t eax, ebx, ecx, edx;
+	__asm__ __volatile__(
+#if defined(__i386__) && defined(__PIC__)
+		"xchgl %%ebx, %1; cpuid; xchgl %%ebx, %1"
+		: "=a"(eax), "=r"(ebx), "=c"(ecx), "=d"(edx)
+#else
+		"cpuid"
+		: "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+#endif
+		: "a"(1), "c"(0));
+	return (ecx >> 20) & 1; /* SSE4.2 */
+}
+
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *buf, size_t len)
+{
+#if defined(__x86_64__)
+	uint64_t c = crc;
+	while (len >= 8) {
+		uint64_t v;
+		memcpy(&v, buf, 8);
+		__asm__("crc32q %1, %0" : "+r"(c) : "rm"(v));
+		buf += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)c;
+#else
+	while (len >= 4) {
+		uint32_t v;
+		memcpy(&v, buf, 4);
+		__asm__("crc32l %1, %0" : "+r"(crc) : "rm"(v));
+		buf += 4;
+		len -= 4;
+	}
+#endif
+	while (len > 0) {
+		__asm__("crc32b %1, %0" : "+r"(crc) : "rm"(*buf));
+		buf++;
+		len--;
+	}
+	return crc;
+}
+
+#else
+
+static int probe_sse42(void)
+{
+	return 0;
+}
+
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	return crc; /* never reached - crc32c_hw stays 0 */
+}
+
+#endif
+
+void bulk_crc32_init(void)
+{
+	if (crc_initialized) {
+		return;
+	}
+	build_tables(crc_tables[BULK_CRC32_ZLIB], CRC32_ZLIB_POLY_REV);
+	build_tables(crc_tables[BULK_CRC32C], CRC32C_POLY_REV);
+	crc32c_hw = probe_sse42();
+	crc_initialized = 1;
+}
+
+int bulk_crc32c_hardware(void)
+{
+	return crc32c_hw;
+}
+
+static uint32_t crc32_sliced(uint32_t crc, const uint8_t *buf, size_t len,
+                             const uint32_t tables[8][256])
+{
+	/* eight bytes per step off the tables */
+	while (len >= 8) {
+		uint32_t lo, hi;
+		memcpy(&lo, buf, 4);
+		memcpy(&hi, buf + 4, 4);
+		lo ^= crc;
+		crc = tables[7][lo & 0xff] ^
+		      tables[6][(lo >> 8) & 0xff] ^
+		      tables[5][(lo >> 16) & 0xff] ^
+		      tables[4][lo >> 24] ^
+		      tables[3][hi & 0xff] ^
+		      tables[2][(hi >> 8) & 0xff] ^
+		      tables[1][(hi >> 16) & 0xff] ^
+		      tables[0][hi >> 24];
+		buf += 8;
+		len -= 8;
+	}
+	while (len > 0) {
+		crc = (crc >> 8) ^ tables[0][(crc ^ *buf) & 0xff];
+		buf++;
+		len--;
+	}
+	return crc;
+}
+
+uint32_t bulk_crc32_update(uint32_t crc, const uint8_t *buf, size_t len,
+                           int checksum_type)
+{
+	crc = ~crc;
+	if (checksum_type == BULK_CRC32C && crc32c_hw) {
+		crc = crc32c_sse42(crc, buf, len);
+	} else {
+		crc = crc32_sliced(crc, buf, len, crc_tables[checksum_type]);
+	}
+	return ~crc;
+}
+
+long bulk_crc32_verify(const uint8_t *data, size_t data_len,
+                       const uint8_t *sums, int checksum_type,
+                       int bytes_per_checksum)
+{
+	long chunk = 0;
+
+	while (data_len > 0) {
+		size_t len = data_len < (size_t)bytes_per_checksum ?
+			data_len : (size_t)bytes_per_checksum;
+		uint32_t crc = bulk_crc32_update(0, data, len, checksum_type);
+		uint32_t expected = ((uint32_t)sums[0] << 24) |
+		                    ((uint32_t)sums[1] << 16) |
+		                    ((uint32_t)sums[2] << 8) |
+		                    (uint32_t)sums[3];
+		if (crc != expected) {
+			return chunk;
+		}
+		data += len;
+		data_len -= len;
+		sums += 4;
+		chunk++;
+	}
+	return -1;
+}
+
+void bulk_crc32_calculate(const uint8_t *data, size_t data_len,
+                          uint8_t *sums, int checksum_type,
+                          int bytes_per_checksum)
+{
+	while (data_len > 0) {
+		size_t len = data_len < (size_t)bytes_per_checksum ?
+			data_len : (size_t)bytes_per_checksum;
+		uint32_t crc = bulk_crc32_update(0, data, len, checksum_type);
+		sums[0] = (uint8_t)(crc >> 24);
+		sums[1] = (uint8_t)(crc >> 16);
+		sums[2] = (uint8_t)(crc >> 8);
+		sums[3] = (uint8_t)crc;
+		data += len;
+		data_len -= len;
+		sums += 4;
+	}
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
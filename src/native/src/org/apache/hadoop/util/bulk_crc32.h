@@ -0,0 +1,66 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined ORG_APACHE_HADOOP_UTIL_BULK_CRC32_H
+#define ORG_APACHE_HADOOP_UTIL_BULK_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* the checksum algorithms understood by this module */
+#define BULK_CRC32_ZLIB 0 /* the java.util.zip.CRC32 polynomial */
+#define BULK_CRC32C     1 /* the Castagnoli polynomial */
+
+/**
+ * Build the slice-by-8 tables and probe the CPU for the SSE4.2 crc32
+ * instruction. Must be called once before any of the functions below;
+ * additional calls are harmless.
+ */
+void bulk_crc32_init(void);
+
+/**
+ * Whether CRC32C is computed with the hardware instruction.
+ */
+int bulk_crc32c_hardware(void);
+
+/**
+ * Checksum one buffer. crc is the running value (pass 0 to start);
+ * the returned value is final - no post-conditioning is needed.
+ */
+uint32_t bulk_crc32_update(uint32_t crc, const uint8_t *buf, size_t len,
+                           int checksum_type);
+
+/**
+ * Verify a run of chunks in one call. data holds data_len bytes split
+ * into chunks of bytes_per_checksum (the last one may be short); sums
+ * holds one big-endian 4-byte checksum per chunk. Returns -1 if every
+ * chunk verifies, else the index of the first bad chunk.
+ */
+long bulk_crc32_verify(const uint8_t *data, size_t data_len,
+                       const uint8_t *sums, int checksum_type,
+                       int bytes_per_checksum);
+
+/**
+ * Checksum a run of chunks in one call, writing one big-endian 4-byte
+ * checksum per chunk into sums as above.
+ */
+void bulk_crc32_calculate(const uint8_t *data, size_t data_len,
+                          uint8_t *sums, int checksum_type,
+                          int bytes_per_checksum);
+
+#endif